@@ -0,0 +1,83 @@
+/**
+ * CiRA Runtime - Frame Annotator
+ *
+ * Draws detection boxes and labels straight into packed 24-bit frames
+ * (RGB or BGR) with no dependencies. Every primitive is clipped to the
+ * frame once and filled as horizontal row spans; glyphs of the built-in
+ * 5x7 font are pre-split into rectangles (the glyph atlas), so a label is
+ * a handful of span fills. Colours follow the class, so a label keeps
+ * its colour across frames and cameras.
+ *
+ * annotate_collect() snapshots a camera's detections under result_mutex;
+ * annotate_draw() then runs without any lock, on the caller's copy of the
+ * frame (JPEG canvas or video encoder input).
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef ANNOTATOR_H
+#define ANNOTATOR_H
+
+#include "cira_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Longest label text drawn ("<label> <confidence>%") */
+#define ANNOTATION_TEXT_LEN 48
+
+/* One box to draw */
+typedef struct {
+    int x, y, w, h;                     /* Box in pixels (may extend past the frame) */
+    int class_id;                       /* Picks the colour */
+    char text[ANNOTATION_TEXT_LEN];     /* Label, "" for none */
+} annotation_t;
+
+/**
+ * Snapshot the detections to draw on a w x h frame of a camera (the
+ * context's when cam is NULL). Keeps the previous detections for up to 3
+ * frames when the current result is empty, to reduce flicker. Takes
+ * result_mutex.
+ *
+ * @param out Receives up to CIRA_MAX_DETECTIONS annotations
+ * @return Number of annotations
+ */
+int annotate_collect(cira_ctx* ctx, cira_camera_t* cam, int w, int h, annotation_t* out);
+
+/**
+ * Draw annotations into a packed w x h frame.
+ *
+ * @param img       Frame, w*h*3 bytes, modified in place
+ * @param bgr       1 if the frame is BGR, 0 for RGB
+ * @param thickness Box line width in pixels, 0 to scale with the frame
+ */
+void annotate_draw(uint8_t* img, int w, int h, int bgr,
+                   const annotation_t* boxes, int count, int thickness);
+
+/**
+ * annotate_collect() then annotate_draw() with the default style.
+ */
+void annotate_frame(cira_ctx* ctx, cira_camera_t* cam, uint8_t* img, int w, int h, int bgr);
+
+/**
+ * Pixel width of text at a font scale (6 * scale per character).
+ */
+int annotate_text_width(const char* text, int scale);
+
+/**
+ * Colour of a class (packed 0xRRGGBB).
+ */
+uint32_t annotate_class_color(int class_id);
+
+/* Overlays on RGB frames */
+void annotate_detections(uint8_t* img, int w, int h, cira_ctx* ctx,
+                         int thickness, int show_label, int show_confidence);
+void annotate_fps(uint8_t* img, int w, int h, float fps);
+void annotate_timestamp(uint8_t* img, int w, int h, const char* timestamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANNOTATOR_H */
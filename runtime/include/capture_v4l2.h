@@ -0,0 +1,118 @@
+/**
+ * CiRA Runtime - V4L2 Capture
+ *
+ * Native Linux capture from /dev/videoN with driver buffers mapped into
+ * the process (V4L2_MEMORY_MMAP). A dequeued buffer is handed to the
+ * pipeline as is and returned to the driver once the frame has been
+ * converted, so a frame is never copied before its colour conversion:
+ * YUYV is converted straight from the driver buffer into the frame store
+ * slot, MJPEG is decoded straight from it.
+ *
+ * Dequeue and release may be called from different threads.
+ * On other platforms capture_v4l2_open() fails and the camera falls back
+ * to OpenCV capture.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef CAPTURE_V4L2_H
+#define CAPTURE_V4L2_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pixel formats */
+#define CAPTURE_FORMAT_YUYV  0      /* Packed 4:2:2 Y0 U Y1 V */
+#define CAPTURE_FORMAT_MJPEG 1      /* One JPEG image per buffer */
+
+/* Format selection for capture_v4l2_open() */
+#define CAPTURE_PREFER_AUTO  -1     /* YUYV unless only MJPEG reaches the requested size */
+
+/* Driver buffer limits */
+#define CAPTURE_MIN_BUFFERS 2
+#define CAPTURE_MAX_BUFFERS 32
+
+/* Opaque handle */
+typedef struct capture_v4l2 capture_v4l2_t;
+
+/* A frame still owned by the driver mapping */
+typedef struct {
+    int index;                  /* Pass to capture_v4l2_release() */
+    const uint8_t* data;        /* Mapped driver memory */
+    size_t size;                /* Bytes used */
+    int format;                 /* CAPTURE_FORMAT_* */
+    int width;
+    int height;
+    int stride;                 /* Bytes per row (YUYV) */
+    uint64_t timestamp_us;      /* Driver timestamp, CLOCK_MONOTONIC microseconds */
+} capture_buffer_t;
+
+/**
+ * Open a device, negotiate format and size, map and queue its buffers and
+ * start streaming.
+ *
+ * @param device  Device path (e.g. "/dev/video0")
+ * @param width   Requested width (the driver may pick the nearest size)
+ * @param height  Requested height
+ * @param fps     Requested frame rate, 0 for the driver default
+ * @param buffers Driver buffers to request (clamped to MIN-MAX_BUFFERS)
+ * @param format  CAPTURE_FORMAT_* or CAPTURE_PREFER_AUTO
+ * @return        Capture, or NULL (reason on stderr)
+ */
+capture_v4l2_t* capture_v4l2_open(const char* device, int width, int height, int fps,
+                                  int buffers, int format);
+
+/**
+ * Stop streaming and unmap. Buffers not yet released become invalid.
+ */
+void capture_v4l2_close(capture_v4l2_t* cap);
+
+/**
+ * Wait for the next filled buffer.
+ *
+ * @return 1 with buf filled, 0 on timeout (or every buffer is held),
+ *         -1 if the device failed
+ */
+int capture_v4l2_next(capture_v4l2_t* cap, capture_buffer_t* buf, int timeout_ms);
+
+/**
+ * Give a buffer from capture_v4l2_next() back to the driver.
+ */
+void capture_v4l2_release(capture_v4l2_t* cap, int index);
+
+/**
+ * Negotiated format and size.
+ */
+int capture_v4l2_format(const capture_v4l2_t* cap);
+void capture_v4l2_size(const capture_v4l2_t* cap, int* width, int* height);
+
+/**
+ * Driver buffers mapped (the most frames in flight before capture waits).
+ */
+int capture_v4l2_buffers(const capture_v4l2_t* cap);
+
+/**
+ * Name of a CAPTURE_FORMAT_* ("yuyv", "mjpeg").
+ */
+const char* capture_format_name(int format);
+
+/**
+ * Convert packed YUYV (BT.601, limited range) to packed RGB24.
+ *
+ * @param src    YUYV image
+ * @param stride Bytes per source row
+ * @param width  Width in pixels; an odd width reads a padded last pair
+ * @param height Height in rows
+ * @param dst    width * height * 3 bytes
+ */
+void capture_yuyv_to_rgb(const uint8_t* src, int stride, int width, int height, uint8_t* dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAPTURE_V4L2_H */
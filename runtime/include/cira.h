@@ -26,6 +26,7 @@ typedef struct cira_ctx cira_ctx;
 #define CIRA_ERROR_MODEL   -3
 #define CIRA_ERROR_MEMORY  -4
 #define CIRA_ERROR_INPUT   -5
+#define CIRA_PENDING        1       /* Asynchronous request still queued or running */
 
 /* === Context states === */
 #define CIRA_STATUS_READY    0
@@ -52,12 +53,28 @@ cira_ctx* cira_create(void);
  * - A .pkl/.joblib file (scikit-learn)
  * - A model_config.json file
  *
+ * Replacing a loaded model is double-buffered: the new model is loaded and
+ * validated with a warm-up inference while the current one keeps serving,
+ * then swapped in once in-flight inferences finish. If the new model fails,
+ * the current one stays loaded.
+ *
  * @param ctx Context handle
  * @param config_path Path to model config or model directory
  * @return CIRA_OK on success, error code on failure
  */
 int cira_load(cira_ctx* ctx, const char* config_path);
 
+/**
+ * Start cira_load() on a background thread and return immediately.
+ * Progress and the outcome are reported in /api/stats ("model_reload")
+ * and by cira_error().
+ *
+ * @param ctx Context handle
+ * @param config_path Path to model config or model directory
+ * @return CIRA_OK if the load was started, CIRA_ERROR if one is already running
+ */
+int cira_load_async(cira_ctx* ctx, const char* config_path);
+
 /**
  * Destroy context and free resources.
  *
@@ -70,6 +87,9 @@ void cira_destroy(cira_ctx* ctx);
 /**
  * Run inference on an image.
  *
+ * The backend runs one image at a time; result readers (cira_result_*,
+ * camera results and streams) are only held up while the result is stored.
+ *
  * @param ctx Context handle
  * @param data Image data (RGB or BGR, packed)
  * @param w Image width
@@ -92,6 +112,10 @@ int cira_predict_sensor(cira_ctx* ctx, const float* values, int count);
 /**
  * Run batch inference on multiple images.
  *
+ * Backends that support it (ONNX, NCNN) process up to "batch.max_size"
+ * images per call. Per-image results are read back with the
+ * cira_batch_result_* functions; cira_result_* return the last image.
+ *
  * @param ctx Context handle
  * @param images Array of image pointers
  * @param count Number of images
@@ -106,7 +130,8 @@ int cira_predict_batch(cira_ctx* ctx, const uint8_t** images, int count, int w,
 
 /**
  * Get full inference result as JSON string.
- * The string is valid until the next inference call.
+ * The string is built on the first call after each inference and is valid
+ * until the next inference call.
  *
  * @param ctx Context handle
  * @return JSON string with results
@@ -152,6 +177,310 @@ float cira_result_score(cira_ctx* ctx, int index);
  */
 const char* cira_result_label(cira_ctx* ctx, int index);
 
+/* === Binary results === */
+
+#define CIRA_RESULT_MAGIC       0x52524943u   /* "CIRR" */
+#define CIRA_RESULT_VERSION     1
+#define CIRA_RESULT_MAX_RECORDS 256
+
+/* Header of a binary result; count records follow at header_size */
+typedef struct {
+    uint32_t magic;             /* CIRA_RESULT_MAGIC */
+    uint16_t version;           /* CIRA_RESULT_VERSION */
+    uint16_t header_size;       /* sizeof(cira_result_header_t) */
+    uint64_t result_sequence;   /* Results stored by the context so far */
+    uint64_t frame_sequence;    /* Capture sequence (cameras) or frames predicted (API) */
+    int32_t camera;             /* Camera number, -1 for API predictions */
+    uint32_t width;             /* Image size the normalized boxes refer to */
+    uint32_t height;
+    uint32_t count;             /* Records that follow */
+    uint32_t record_size;       /* sizeof(cira_result_record_t) */
+    uint32_t reserved;
+} cira_result_header_t;
+
+/* One detection of a binary result */
+typedef struct {
+    float x, y, w, h;           /* Bounding box, normalized 0-1, top-left origin */
+    float confidence;
+    int32_t label_id;           /* Index into the model labels (cira_label()) */
+} cira_result_record_t;
+
+/* Largest binary result */
+#define CIRA_RESULT_RAW_MAX \
+    (sizeof(cira_result_header_t) + CIRA_RESULT_MAX_RECORDS * sizeof(cira_result_record_t))
+
+/**
+ * Copy the latest result in binary form: a cira_result_header_t followed
+ * by its records, in host byte order. Unlike cira_result_json() this does
+ * no text formatting, and the copy is consistent with concurrent camera
+ * inference.
+ *
+ * @param ctx Context handle
+ * @param camera Camera number, or -1 for the cira_result_json() result
+ * @param buf Output buffer (CIRA_RESULT_RAW_MAX bytes always suffice)
+ * @param size Capacity of buf in bytes
+ * @return Bytes written, CIRA_ERROR_INPUT for a bad camera or buffer,
+ *         CIRA_ERROR_MEMORY if buf is too small
+ */
+int cira_result_raw(cira_ctx* ctx, int camera, void* buf, int size);
+
+/**
+ * Get a label name by label id.
+ *
+ * @param ctx Context handle
+ * @param label_id Label index
+ * @return Label string ("unknown" if out of range)
+ */
+const char* cira_label(cira_ctx* ctx, int label_id);
+
+/**
+ * Get the number of model labels.
+ *
+ * @param ctx Context handle
+ * @return Label count
+ */
+int cira_label_count(cira_ctx* ctx);
+
+/* === Batch result functions === */
+
+/**
+ * Get number of images with results from the last batch.
+ *
+ * @param ctx Context handle
+ * @return Number of images, or 0 if none
+ */
+int cira_batch_count(cira_ctx* ctx);
+
+/**
+ * Get inference result of one batch image as JSON string.
+ * The string is valid until the next batch call.
+ *
+ * @param ctx Context handle
+ * @param image Image index (0 to batch count-1)
+ * @return JSON string with results, or NULL if image invalid
+ */
+const char* cira_batch_result_json(cira_ctx* ctx, int image);
+
+/**
+ * Get number of detections in one batch image.
+ *
+ * @param ctx Context handle
+ * @param image Image index
+ * @return Number of detections, or 0 if none
+ */
+int cira_batch_result_count(cira_ctx* ctx, int image);
+
+/**
+ * Get bounding box for a detection in one batch image.
+ *
+ * @param ctx Context handle
+ * @param image Image index
+ * @param index Detection index
+ * @param x Output: X coordinate (top-left)
+ * @param y Output: Y coordinate (top-left)
+ * @param w Output: Width
+ * @param h Output: Height
+ * @return CIRA_OK on success, CIRA_ERROR if image or index invalid
+ */
+int cira_batch_result_bbox(cira_ctx* ctx, int image, int index,
+                           float* x, float* y, float* w, float* h);
+
+/**
+ * Get confidence score for a detection in one batch image.
+ *
+ * @param ctx Context handle
+ * @param image Image index
+ * @param index Detection index
+ * @return Confidence score (0.0-1.0), or -1 on error
+ */
+float cira_batch_result_score(cira_ctx* ctx, int image, int index);
+
+/**
+ * Get label for a detection in one batch image.
+ *
+ * @param ctx Context handle
+ * @param image Image index
+ * @param index Detection index
+ * @return Label string, or NULL on error
+ */
+const char* cira_batch_result_label(cira_ctx* ctx, int image, int index);
+
+/* === Asynchronous inference === */
+
+/* One queued inference and its result (opaque) */
+typedef struct cira_request cira_request;
+
+/*
+ * Completion callback, called on the context's predict worker thread once
+ * the request has its final status. The next queued request waits for it,
+ * so hand longer work to another thread. It may release the request.
+ */
+typedef void (*cira_request_callback)(cira_request* req, void* user_data);
+
+/**
+ * Queue an image for inference and return at once.
+ *
+ * The image is copied, so the caller may reuse data as soon as this
+ * returns. Requests run in submission order on a worker thread of the
+ * context and each keeps its own result, so several frames can be in
+ * flight while the caller does its own I/O. Each result also becomes the
+ * context result, as with cira_predict_image().
+ *
+ * cira_destroy() completes requests still queued with CIRA_ERROR; after
+ * it, cira_request_release() is the only call allowed on its requests.
+ *
+ * @param ctx Context handle
+ * @param data Image data (RGB or BGR, packed)
+ * @param w Image width
+ * @param h Image height
+ * @param channels Number of channels (3 for RGB/BGR)
+ * @param callback Called when the request completes, or NULL to poll or wait
+ * @param user_data Passed to callback
+ * @return Request handle, or NULL if the image is invalid, no model is
+ *         loaded or "async.queue_depth" requests are already queued
+ *         (see cira_error())
+ */
+cira_request* cira_predict_image_async(cira_ctx* ctx, const uint8_t* data, int w, int h,
+                                       int channels, cira_request_callback callback,
+                                       void* user_data);
+
+/**
+ * Get the status of a request without blocking.
+ *
+ * @param req Request handle
+ * @return CIRA_PENDING, or the final status (CIRA_OK or an error code)
+ */
+int cira_request_status(cira_request* req);
+
+/**
+ * Wait for a request to complete.
+ *
+ * @param req Request handle
+ * @param timeout_ms Longest wait, or -1 to wait until it completes
+ * @return Final status, or CIRA_PENDING if the timeout expired first
+ */
+int cira_request_wait(cira_request* req, int timeout_ms);
+
+/**
+ * Get number of detections of a completed request.
+ *
+ * @param req Request handle
+ * @return Number of detections, or 0 if pending or failed
+ */
+int cira_request_count(cira_request* req);
+
+/**
+ * Get one detection of a completed request.
+ *
+ * @param req Request handle
+ * @param index Detection index (0 to count-1)
+ * @param out Output: box (normalized 0-1), confidence and label id
+ * @return CIRA_OK on success, CIRA_ERROR if pending, failed or index invalid
+ */
+int cira_request_detection(cira_request* req, int index, cira_result_record_t* out);
+
+/**
+ * Get the result of a completed request as JSON (same format as
+ * cira_result_json()). Valid until the request is released.
+ *
+ * @param req Request handle
+ * @return JSON string, or NULL if the request is pending or failed
+ */
+const char* cira_request_json(cira_request* req);
+
+/**
+ * Release a request handle. A request still queued or running completes
+ * in the background (its callback still runs) and is then freed.
+ *
+ * @param req Request handle (NULL is ignored)
+ */
+void cira_request_release(cira_request* req);
+
+/* === Configuration functions === */
+
+/**
+ * Set a runtime option.
+ *
+ * Supported keys:
+ * - "pipeline.queue_depth"  Frames buffered between camera pipeline stages (1-64, default 2)
+ * - "pipeline.drop_policy"  "drop_oldest" (default) or "drop_newest" when a queue is full
+ * - "batch.max_size"        Images per backend call in cira_predict_batch (1-256, default 8)
+ * - "async.queue_depth"     Requests cira_predict_image_async may queue (1-256, default 16)
+ * - "decode.threads"        Threads decoding images of /api/inference/batch: "auto"
+ *                           (default, up to 4) or 1-16
+ * - "model.cache_dir"       Directory for compiled models (optimized ONNX graphs); empty
+ *                           (default) for $XDG_CACHE_HOME/cira or ~/.cache/cira, "off"
+ *                           to compile on every load. Applies to later loads
+ * - "camera.schedule"       "batch" (default) to infer same-size frames of all cameras in
+ *                           one backend call, or "round_robin" for one call per frame
+ * - "camera.backend"        "auto" (default) for V4L2 mmap capture where available, else
+ *                           OpenCV; "v4l2" or "opencv" to force one
+ * - "camera.format"         V4L2 pixel format: "auto" (default), "yuyv" or "mjpeg"
+ * - "camera.width", "camera.height"  Requested capture size (default 1280x720)
+ * - "camera.fps"            Requested capture rate, 0 for the device default
+ * - "jpeg.encoder"          "auto" (default) for the first usable of "nvjpeg", "turbo"
+ *                           (libjpeg-turbo) and "opencv", or one of them by name;
+ *                           process-wide, needs a streaming build
+ * - "camera.N.source"       What camera N captures: a URL (rtsp://..., hardware decoded
+ *                           through GStreamer when available), a device path, "csi:K"
+ *                           for a Jetson CSI sensor, or "gst:<pipeline>" ending in appsink;
+ *                           empty (default) for the device_id passed to start
+ * - "gate.motion_threshold" Mean luma change (0-255) a camera frame needs to be inferred;
+ *                           still frames reuse the last detections. 0 (default) infers all
+ * - "gate.max_skip_ms"      Infer at least this often while gated (default 1000, 0 = never)
+ * - "camera.N.roi"          Regions camera N infers on, "x,y,w,h" normalized, up to 4
+ *                           separated by ';'; empty (default) for the whole frame. Read at start
+ * - "tracker"               "on" to track camera detections (results gain "track_id"),
+ *                           "off" (default). Read at camera start
+ * - "tracker.detect_interval"  With the tracker on, run the detector on every Nth frame
+ *                           (1-30, default 1) and predict the boxes of the others
+ * - "tracker.high_threshold"  Confidence a detection needs to start a track (default 0.5);
+ *                           weaker ones only keep existing tracks alive
+ * - "cpu.affinity"          "auto" to split the CPUs between thread classes (big.LITTLE:
+ *                           inference on big cores, the rest on little ones; 4+ uniform
+ *                           cores: the first one or two for the rest), "off" (default)
+ *                           to pin nothing
+ * - "cpu.capture", "cpu.inference", "cpu.encode", "cpu.http"  CPUs of one thread class:
+ *                           a list like "0-3,6", "all", "big", "little" or "none".
+ *                           Inference applies at the next load, the others when their
+ *                           threads start
+ * - "video.codec"           /stream/video codec: "h264" (default), "h265" or "off".
+ *                           Read at camera start, like the options below
+ * - "video.encoder"         "auto" (default) for the first usable of "nvenc" (Jetson),
+ *                           "mpp" (Rockchip), "v4l2" and "software" (x264/x265), or one
+ *                           by name; needs a streaming build with GStreamer
+ * - "video.bitrate"         Target bitrate in kbit/s (100-50000, default 2000)
+ * - "video.gop"             Frames between keyframes (1-600, default 30)
+ * - "server.mode"           "event" (default) for an epoll/poll loop on a thread pool, where
+ *                           MJPEG viewers waiting for a frame hold no thread, or "threads"
+ *                           for one thread per connection
+ * - "server.threads"        Thread pool size in event mode (1-64, default 4)
+ * - "frame_ring"            "off" (default), "rgb" or "jpeg": publish every camera frame and
+ *                           its detections to a shared-memory ring (see frame_ring.h) instead
+ *                           of the frame file
+ * - "frame_ring.name"       Shared-memory object name (default "cira-frames-<http port>")
+ * - "frame_ring.slots"      Frames held in the ring (2-16, default 4)
+ * - "frame_ring.slot_bytes" Largest frame payload, 0 for 1080p RGB or 2 MB JPEG (default 0)
+ * - "results.history"       Recent results kept for /api/results/range (64-1048576,
+ *                           default 8192), 0 for none (see result_log.h)
+ * - "results.history_sec"   Oldest result kept, in seconds (default 600, 0 = no limit)
+ * - "results.log"           Also append every result to this memory-mapped segment file;
+ *                           empty (default) for memory only
+ * - "results.log_mb"        Segment file size before it rotates to "<file>.1" (1-1024,
+ *                           default 64)
+ *
+ * Pipeline options take effect the next time the camera is started, server
+ * options the next time the server is started. The frame ring is created
+ * when the first camera starts and kept until cira_destroy(). Changing a
+ * results option clears the history; the next result starts a new one.
+ *
+ * @param ctx Context handle
+ * @param key Option name
+ * @param value Option value as a string
+ * @return CIRA_OK on success, CIRA_ERROR_INPUT for unknown keys or bad values
+ */
+int cira_set_option(cira_ctx* ctx, const char* key, const char* value);
+
 /* === Status functions === */
 
 /**
@@ -190,13 +519,53 @@ const char* cira_version(void);
 int cira_start_camera(cira_ctx* ctx, int device_id);
 
 /**
- * Stop camera capture.
+ * Stop camera capture (every camera started on the context).
  *
  * @param ctx Context handle
  * @return CIRA_OK on success
  */
 int cira_stop_camera(cira_ctx* ctx);
 
+/**
+ * Start one of several cameras. Every camera runs its own capture
+ * pipeline and keeps its own results, while frames from all cameras are
+ * inferred by the one loaded model. Camera 0 is the camera of
+ * cira_start_camera() and of the single-camera results and streams.
+ *
+ * @param ctx Context handle
+ * @param camera Camera number (0 to 7)
+ * @param device_id Capture device ID (0, 1, etc.)
+ * @return CIRA_OK on success (or if that camera is already running)
+ */
+int cira_camera_start(cira_ctx* ctx, int camera, int device_id);
+
+/**
+ * Stop one camera.
+ *
+ * @param ctx Context handle
+ * @param camera Camera number
+ * @return CIRA_OK on success
+ */
+int cira_camera_stop(cira_ctx* ctx, int camera);
+
+/**
+ * Get a camera's latest results as JSON (same format as cira_result_json).
+ *
+ * @param ctx Context handle
+ * @param camera Camera number
+ * @return JSON string (valid until that camera's next frame)
+ */
+const char* cira_camera_result_json(cira_ctx* ctx, int camera);
+
+/**
+ * Get a camera's capture FPS.
+ *
+ * @param ctx Context handle
+ * @param camera Camera number
+ * @return Capture FPS, or 0 if not running
+ */
+float cira_camera_fps(cira_ctx* ctx, int camera);
+
 /**
  * Start HTTP streaming server.
  *
@@ -215,7 +584,7 @@ int cira_start_server(cira_ctx* ctx, int port);
 int cira_stop_server(cira_ctx* ctx);
 
 /**
- * Get current FPS (frames per second).
+ * Get current FPS (frames per second) of camera 0.
  *
  * @param ctx Context handle
  * @return Current FPS, or 0 if not running
@@ -12,6 +12,10 @@
 
 #include "cira.h"
 #include "yolo_decoder.h"
+#include "frame_store.h"
+#include "latency_hist.h"
+#include "cpu_affinity.h"
+#include "video_encoder.h"
 #include <pthread.h>
 #include <time.h>
 
@@ -34,6 +38,95 @@ extern "C" {
 /* Maximum JSON result length */
 #define CIRA_MAX_JSON_LEN 65536
 
+/* Frame store slots (buffers are allocated on demand) */
+#define CIRA_FRAME_STORE_SLOTS 24
+
+/* Camera pipeline stages (capture, preprocess, inference, publish) */
+#define CIRA_PIPELINE_STAGES 4
+
+/* Default camera pipeline queue depth (frames between stages) */
+#define CIRA_PIPELINE_DEFAULT_DEPTH 2
+
+/* Maximum cameras per context (all share one loaded model) */
+#define CIRA_MAX_CAMERAS 8
+
+/* Camera latency histograms (/metrics): one per pipeline stage, then
+ * capture to stored result */
+#define CIRA_LATENCY_RESULT      CIRA_PIPELINE_STAGES
+#define CIRA_CAMERA_LATENCIES    (CIRA_PIPELINE_STAGES + 1)
+
+/* Context latency histograms (/metrics) */
+#define CIRA_LATENCY_PREDICT_PREPROCESS  0  /* Backend stages of single-image predicts */
+#define CIRA_LATENCY_PREDICT_INFERENCE   1
+#define CIRA_LATENCY_PREDICT_DECODE      2
+#define CIRA_LATENCY_RESULT_JSON         3  /* Building a result JSON */
+#define CIRA_CTX_LATENCIES               4
+
+/* How the shared inference scheduler services cameras */
+#define CIRA_SCHEDULE_BATCH        0    /* One batch call for same-size frames */
+#define CIRA_SCHEDULE_ROUND_ROBIN  1    /* One predict per frame, camera by camera */
+
+/* Capture backend for device cameras (camera.backend option) */
+#define CIRA_CAPTURE_AUTO    0      /* V4L2 mmap capture where available, else OpenCV */
+#define CIRA_CAPTURE_V4L2    1      /* V4L2 mmap capture only */
+#define CIRA_CAPTURE_OPENCV  2      /* OpenCV VideoCapture */
+
+/* Default capture size and longest camera source (camera.* options) */
+#define CIRA_CAMERA_DEFAULT_WIDTH  1280
+#define CIRA_CAMERA_DEFAULT_HEIGHT 720
+#define CIRA_CAMERA_SOURCE_LEN     512
+
+/* Motion-gated inference (gate.* and camera.N.roi options) */
+#define CIRA_GATE_THUMB_W 64                /* Motion thumbnail size */
+#define CIRA_GATE_THUMB_H 36
+#define CIRA_GATE_DEFAULT_MAX_SKIP_MS 1000  /* Infer at least this often while gated */
+#define CIRA_MAX_ROIS 4
+
+/* Inference region, normalized to the frame (0-1, top-left origin) */
+typedef struct {
+    float x, y, w, h;
+} cira_roi_t;
+
+/* HTTP server threading (server.mode option) */
+#define CIRA_SERVER_EVENT    0      /* epoll/poll loop on a thread pool */
+#define CIRA_SERVER_THREADS  1      /* One thread per connection */
+
+/* Default HTTP thread pool size in event mode (server.threads option) */
+#define CIRA_SERVER_DEFAULT_THREADS 4
+
+/* Maximum HTTP thread pool size */
+#define CIRA_SERVER_MAX_THREADS 64
+
+/* Shared-memory frame ring defaults (frame_ring options) */
+#define CIRA_FRAME_RING_DEFAULT_SLOTS 4
+#define CIRA_FRAME_RING_RGB_BYTES   (1920 * 1080 * 3)   /* Auto slot payload for rgb */
+#define CIRA_FRAME_RING_JPEG_BYTES  (2 * 1024 * 1024)   /* Auto slot payload for jpeg */
+
+/* Result history defaults (results.* options) */
+#define CIRA_RESULT_HISTORY_DEFAULT     8192    /* Results held in memory */
+#define CIRA_RESULT_HISTORY_SEC_DEFAULT 600     /* Oldest result kept, seconds */
+#define CIRA_RESULT_LOG_DEFAULT_MB      64      /* Segment file size */
+
+/* Encoded video defaults and limits (video.* options) */
+#define CIRA_VIDEO_DEFAULT_BITRATE 2000     /* kbit/s */
+#define CIRA_VIDEO_MAX_BITRATE     50000
+#define CIRA_VIDEO_DEFAULT_GOP     30       /* Frames between keyframes */
+#define CIRA_VIDEO_MAX_GOP         600
+
+/* Maximum images per backend batch call (batch.max_size option) */
+#define CIRA_BATCH_MAX_SIZE 256
+
+/* Default images per backend batch call */
+#define CIRA_BATCH_DEFAULT_SIZE 8
+
+/* Queued cira_predict_image_async requests (async.queue_depth option) */
+#define CIRA_ASYNC_DEFAULT_DEPTH 16
+#define CIRA_ASYNC_MAX_DEPTH     256
+
+/* Decode threads of an image batch (decode.threads option; 0 = auto, up to the default) */
+#define CIRA_DECODE_DEFAULT_THREADS 4
+#define CIRA_DECODE_MAX_THREADS     16
+
 /* Model format types (ordered by priority) */
 typedef enum {
     CIRA_FORMAT_UNKNOWN = 0,
@@ -44,6 +137,14 @@ typedef enum {
     CIRA_FORMAT_SKLEARN
 } cira_format_t;
 
+/* Numeric precision a model runs at (manifest "precision") */
+typedef enum {
+    CIRA_PRECISION_AUTO = 0,    /* Not declared: backend default */
+    CIRA_PRECISION_FP32,
+    CIRA_PRECISION_FP16,
+    CIRA_PRECISION_INT8         /* Quantized model (NCNN int8, ONNX QDQ, INT8 engine) */
+} cira_precision_t;
+
 /* Detection result */
 typedef struct {
     float x, y, w, h;       /* Bounding box (normalized 0-1) */
@@ -51,6 +152,86 @@ typedef struct {
     int label_id;           /* Label index */
 } cira_detection_t;
 
+/* Stage times of the last single-image backend predict, milliseconds */
+typedef struct {
+    double preprocess_ms;   /* Resize, normalize, layout (TensorRT: staging and upload) */
+    double inference_ms;    /* Network execution */
+    double decode_ms;       /* Output decode, NMS, conversion to detections */
+} cira_predict_timing_t;
+
+/* Per-image result of cira_predict_batch() */
+typedef struct {
+    cira_detection_t detections[CIRA_MAX_DETECTIONS];
+    int num_detections;
+    int img_w, img_h;       /* Image size the boxes convert to */
+    int json_stale;         /* json not built for these detections yet */
+    char* json;             /* Result JSON (owned, CIRA_MAX_JSON_LEN once built, reused) */
+} cira_batch_result_t;
+
+/* Per-stage camera pipeline statistics (written by the stage thread) */
+typedef struct {
+    const char* name;       /* Stage name */
+    float fps;              /* Frames processed per second */
+    float busy_ms;          /* Average processing time per frame */
+    uint64_t frames;        /* Frames processed since camera start */
+    uint64_t dropped;       /* Frames dropped at this stage's input queue */
+    int queue_depth;        /* Frames waiting in this stage's input queue */
+    int queue_capacity;     /* Input queue capacity (0 for the capture stage) */
+} cira_stage_stats_t;
+
+/* One camera of the context (see camera.cpp). All cameras share the
+ * loaded model; camera 0 also shares the context frame store and JPEG
+ * cache so the single-camera endpoints keep serving it. */
+typedef struct cira_camera {
+    int index;                      /* Camera number (API and ?camera=N) */
+    int running;
+    int device_id;                  /* Capture device, -1 if stopped */
+    char source[CIRA_CAMERA_SOURCE_LEN];   /* URL, device path, "csi:N" or "gst:..."; empty = device_id */
+    const char* capture_backend;    /* "v4l2", "opencv" or "gstreamer" while running */
+    const char* capture_format;     /* Pixel format delivered by the capture ("bgr" for OpenCV) */
+    void* pipeline;                 /* Pipeline state, NULL if stopped */
+    cira_roi_t rois[CIRA_MAX_ROIS]; /* Inference regions, read at start (guarded by camera_mutex) */
+    int num_rois;                   /* 0 = whole frame */
+    float current_fps;              /* Capture FPS */
+    float inference_fps;            /* Inference FPS of this camera's frames */
+    cira_stage_stats_t stage_stats[CIRA_PIPELINE_STAGES];
+
+    /* Latest frame (created on first start, kept until cira_destroy) */
+    frame_store_t* frame_store;
+    struct jpeg_cache* jpeg_cache;
+    video_encoder_t* video;         /* Encoded /stream/video (streaming builds) */
+
+    /* Latest results (guarded by result_mutex) */
+    cira_detection_t detections[CIRA_MAX_DETECTIONS];
+    int num_detections;
+    cira_detection_t prev_detections[CIRA_MAX_DETECTIONS];
+    int prev_num_detections;
+    uint64_t prev_detection_frame;  /* total_frames when prev_detections was set */
+    char* result_json;              /* CIRA_MAX_JSON_LEN bytes, NULL until first start */
+    int result_json_stale;          /* result_json not built for the latest result yet */
+    int result_w, result_h;         /* Image size of the latest result */
+    uint64_t result_frame_seq;      /* Capture sequence of the latest result */
+    int track_ids[CIRA_MAX_DETECTIONS];  /* Track of each detection, when result_tracked */
+    int result_tracked;
+
+    /* Statistics */
+    uint64_t total_frames;          /* Frames inferred */
+    uint64_t total_detections;      /* Detections on this camera */
+    uint64_t gate_passed;           /* Frames the motion gate sent to inference */
+    uint64_t gate_skipped;          /* Frames it skipped, reusing the last detections */
+    float motion_score;             /* Last motion score (mean luma change, 0-255) */
+    uint64_t tracked_frames;        /* Results predicted by the tracker between detector runs */
+    int active_tracks;              /* Live tracks after the last result */
+
+    /* Latency histograms, CIRA_LATENCY_* order (created on first start) */
+    latency_hist_t* latency[CIRA_CAMERA_LATENCIES];
+} cira_camera_t;
+
+/* Called with result_mutex held after each stored result. cam is NULL for
+ * cira_predict_image() results; frame_seq is the camera's capture sequence. */
+typedef void (*cira_result_notify_fn)(void* arg, cira_ctx* ctx, cira_camera_t* cam,
+                                      uint64_t frame_seq);
+
 /* Context structure (internal) */
 struct cira_ctx {
     /* Status */
@@ -75,11 +256,42 @@ struct cira_ctx {
     float confidence_threshold;
     float nms_threshold;
     yolo_version_t yolo_version;    /* YOLO version (from manifest or auto-detect) */
+    int letterbox;                  /* Manifest "letterbox": 1/0, -1 = loader default */
+    cira_precision_t precision;     /* Manifest "precision" */
+    char calibration_path[1024];    /* Manifest "calibration": data the model was quantized with */
+    char model_providers[256];      /* Manifest "execution_providers" (ONNX) */
+    char execution_provider[32];    /* ONNX provider the model runs on, empty for other backends */
+    char onnx_providers[256];       /* "onnx.providers": overrides the manifest's, empty = manifest */
+    char model_cache_dir[512];      /* Compiled-model cache ("model.cache_dir"), empty = default, "off" */
+    cpu_mask_t cpu_masks[CPU_CLASSES];  /* CPUs per thread class ("cpu.*" options), 0 = unpinned */
 
-    /* Results */
+    /* Backend output of the predict in progress (model_mutex). Never read
+     * as a result: it is copied into result_detections when published. */
     cira_detection_t detections[CIRA_MAX_DETECTIONS];
     int num_detections;
-    char result_json[CIRA_MAX_JSON_LEN];
+
+    /* Published result (guarded by result_mutex) */
+    cira_detection_t result_detections[CIRA_MAX_DETECTIONS];
+    int result_num_detections;
+    char result_json[CIRA_MAX_JSON_LEN];   /* Built on first read of a new result */
+    int result_json_stale;          /* result_json not built for result_detections yet */
+    int result_w, result_h;         /* Image size of the current result */
+    int result_camera;              /* Camera of the current result, -1 for API predictions */
+    uint64_t result_frame_seq;      /* Its capture sequence (API: frames predicted) */
+    int track_ids[CIRA_MAX_DETECTIONS];  /* Camera 0 track IDs, when result_tracked */
+    int result_tracked;
+
+    /* Batch results (cira_predict_batch), one entry per image (result_mutex) */
+    cira_batch_result_t* batch_results;
+    int batch_count;                /* Images in the last batch */
+    int batch_capacity;             /* Allocated entries */
+    int batch_max_size;             /* Images per backend call */
+
+    /* Backend output of the batch in progress (model_mutex), copied into
+     * batch_results or camera results when published */
+    cira_batch_result_t* batch_scratch;
+    int batch_scratch_count;
+    int batch_scratch_capacity;
 
     /* Detection persistence (for smooth annotations) */
     cira_detection_t prev_detections[CIRA_MAX_DETECTIONS];
@@ -87,30 +299,99 @@ struct cira_ctx {
     uint64_t prev_detection_frame;  /* Frame number when prev_detections was set */
 
     /* Streaming state */
-    int camera_running;
-    int current_camera;     /* Currently active camera device ID (-1 if none) */
+    int camera_running;     /* Number of cameras running */
+    int current_camera;     /* Device ID of camera 0 (-1 if stopped) */
     int server_running;
     int server_port;
-    pthread_t camera_thread;
+    int server_mode;        /* CIRA_SERVER_EVENT/THREADS, read at server start */
+    int server_threads;     /* Thread pool size in event mode */
     pthread_mutex_t result_mutex;
-    float current_fps;
+    uint64_t result_sequence;                       /* Results stored (cameras and API) */
+    cira_result_notify_fn result_notify;            /* Result push (streaming server), or NULL */
+    void* result_notify_arg;
+    struct result_log* result_log;                  /* Recent results, created with the first one */
+    int result_history;                             /* Results held, 0 = history off */
+    int result_history_sec;                         /* Oldest result held, 0 = no limit */
+    char result_log_path[512];                      /* Segment file, empty = memory only */
+    int result_log_mb;                              /* Segment file size */
 
-    /* Frame buffer for streaming */
-    uint8_t* frame_buffer;
-    int frame_w;
-    int frame_h;
-    int frame_size;
-    pthread_mutex_t frame_mutex;
+    /* Cameras (see camera.cpp) */
+    cira_camera_t cameras[CIRA_MAX_CAMERAS];
+    pthread_mutex_t camera_mutex;                   /* Serializes camera start/stop */
+    void* camera_scheduler;                         /* Shared inference scheduler, NULL if idle */
+    int camera_schedule;                            /* CIRA_SCHEDULE_BATCH/ROUND_ROBIN */
+    int camera_backend;                             /* CIRA_CAPTURE_*, read at camera start */
+    int camera_format;                              /* CAPTURE_FORMAT_* or CAPTURE_PREFER_AUTO */
+    int camera_width, camera_height, camera_fps;    /* Requested capture mode (fps 0 = default) */
+    float gate_threshold;                           /* Motion score to infer on, 0 = gate off */
+    int gate_max_skip_ms;                           /* Longest gated stretch, 0 = unlimited */
+    int tracker_enabled;                            /* Track camera detections, read at start */
+    int tracker_interval;                           /* Run the detector on every Nth frame */
+    float tracker_high_threshold;                   /* Confidence that starts a track */
+    uint64_t scheduler_calls;                       /* Backend calls made by the scheduler */
+    uint64_t scheduler_frames;                      /* Camera frames inferred by the scheduler */
+    int pipeline_queue_depth;                       /* Queue depth between stages */
+    int pipeline_drop_policy;                       /* FRAME_QUEUE_DROP_OLDEST/NEWEST */
+    video_config_t video_config;                    /* "video.*" options, read at camera start */
+
+    /* Latest frame for streaming (lock-free, refcounted slots) */
+    frame_store_t* frame_store;
+    struct jpeg_cache* jpeg_cache;                  /* Encode-once JPEG cache (streaming builds) */
 
     /* Cumulative statistics (for /api/stats endpoint) */
     uint64_t total_detections;                      /* Total detections since startup */
     uint64_t detections_by_label[CIRA_MAX_LABELS];  /* Detections per label */
     uint64_t total_frames;                          /* Total frames processed */
+    uint64_t predict_allocations;                   /* Heap allocations made by backend predict calls */
+    cira_predict_timing_t predict_timing;           /* Last single-image predict (cira_bench, /metrics) */
+    latency_hist_t* latency[CIRA_CTX_LATENCIES];    /* CIRA_LATENCY_PREDICT_* and _RESULT_JSON */
     time_t start_time;                              /* Startup timestamp */
 
-    /* Model swap synchronization (prevents NCNN pool allocator errors) */
-    volatile int model_swapping;                    /* Flag: model is being swapped */
+    /* Model swap synchronization (see cira_load: new models are staged
+     * elsewhere, model_mutex is only held to publish them) */
+    volatile int model_swapping;                    /* Flag: a load is in progress, old model still serving */
     pthread_mutex_t model_mutex;                    /* Mutex for model access */
+    pthread_mutex_t load_mutex;                     /* Serializes cira_load calls */
+
+    /* Background loads (cira_load_async) */
+    pthread_mutex_t load_async_mutex;               /* Guards the fields below */
+    pthread_cond_t load_async_cond;                 /* Signalled when load_pending clears */
+    pthread_t load_thread;
+    int load_thread_started;                        /* load_thread needs joining */
+    int load_pending;                               /* Loader thread queued or running */
+    char load_async_path[1024];                     /* Path the loader thread loads */
+
+    /* Asynchronous predicts (cira_predict_image_async): FIFO and worker */
+    pthread_mutex_t async_mutex;                    /* Guards the fields below */
+    pthread_cond_t async_cond;                      /* Request queued, or stop */
+    struct cira_request* async_head;
+    struct cira_request* async_tail;
+    int async_queued;                               /* Requests waiting */
+    int async_queue_depth;                          /* Most requests waiting */
+    int async_started;                              /* async_thread needs joining */
+    int async_stopping;                             /* cira_destroy: fail what is left */
+    pthread_t async_thread;
+    uint64_t async_completed;                       /* Requests completed (any status) */
+    uint64_t async_rejected;                        /* Submissions refused: queue full */
+    int decode_threads;                             /* Image batch decode threads, 0 = auto */
+
+    /* Reload statistics (for /api/stats endpoint) */
+    uint64_t reload_count;                          /* Successful loads */
+    uint64_t reload_failures;                       /* Rejected loads (old model kept) */
+    double reload_ms;                               /* Last load: build, warm-up and swap */
+    double reload_warmup_ms;                        /* Last load: warm-up inference */
+    double reload_swap_us;                          /* Last load: time model_mutex was held */
+    uint64_t reload_dropped_frames;                 /* Camera frames not inferred during the last load */
+    uint64_t skipped_frames;                        /* Camera frames published without inference */
+
+    /* Shared-memory frame ring for same-host consumers (replaces the frame file) */
+    struct frame_ring* frame_ring;                  /* NULL if disabled or not created yet */
+    int frame_ring_format;                          /* FRAME_RING_FORMAT_*, -1 if disabled */
+    int frame_ring_slots;                           /* Slot count */
+    size_t frame_ring_bytes;                        /* Payload capacity per slot, 0 = auto */
+    char frame_ring_name[64];                       /* Object name, empty = cira-frames-<port> */
+    pthread_mutex_t frame_ring_mutex;               /* Guards ring creation */
+    uint64_t frame_ring_oversize;                   /* Frames too large for a slot */
 
     /* File-based frame transfer (cross-platform alternative to MJPEG) */
     char frame_file_path[512];                      /* Path to current frame file */
@@ -120,11 +401,23 @@ struct cira_ctx {
 
 /* Internal helper functions (defined in cira.c) */
 
+/**
+ * Create the shared-memory frame ring if the frame_ring option enables it
+ * and it does not exist yet (called when a camera starts).
+ *
+ * @return CIRA_OK if the ring exists or is disabled, CIRA_ERROR if creation failed
+ */
+int cira_frame_ring_start(cira_ctx* ctx);
+
+
 /**
  * Set error message on context.
  */
 void cira_set_error(cira_ctx* ctx, const char* fmt, ...);
 
+/* Pin the calling thread to the CPUs of a thread class (no-op if unset) */
+void cira_pin_thread(cira_ctx* ctx, cpu_class_t cls);
+
 /**
  * Add a detection result to the context.
  * Coordinates should be normalized (0-1).
@@ -146,6 +439,27 @@ int cira_add_detection(cira_ctx* ctx, float x, float y, float w, float h,
  */
 void cira_clear_detections(cira_ctx* ctx);
 
+/**
+ * Monotonic clock in milliseconds (stage timing).
+ */
+double cira_time_ms(void);
+
+/**
+ * Model format of a file or model directory, from its extension or the
+ * files it contains.
+ *
+ * @return CIRA_FORMAT_UNKNOWN if nothing matches
+ */
+cira_format_t cira_detect_format(const char* path);
+
+/* "auto", "fp32", "fp16" or "int8" */
+const char* cira_precision_name(cira_precision_t precision);
+
+/**
+ * Short name of a format ("ncnn", "onnx", ...; "unknown").
+ */
+const char* cira_format_name(cira_format_t format);
+
 /**
  * Get the label string for a label ID.
  */
@@ -153,7 +467,8 @@ const char* cira_get_label(cira_ctx* ctx, int label_id);
 
 /**
  * Store frame data in context (for streaming).
- * Makes a copy of the data.
+ * Makes a copy of the data. Producers that can render directly into the
+ * frame store (the camera pipeline) use frame_store_begin_write() instead.
  *
  * @param ctx Context handle
  * @param data Frame data (RGB)
@@ -163,10 +478,105 @@ const char* cira_get_label(cira_ctx* ctx, int label_id);
 void cira_store_frame(cira_ctx* ctx, const uint8_t* data, int w, int h);
 
 /**
- * Get latest frame data (for streaming).
- * Returns pointer to internal buffer - do not free.
+ * Take a reference to the latest frame (for streaming).
+ * The frame stays valid until released with frame_store_release().
+ *
+ * @param ctx Context handle
+ * @param w Output: width
+ * @param h Output: height
+ * @param seq Output: frame sequence number (may be NULL)
+ * @param slot Output: slot to release
+ * @return RGB pixel data, or NULL if no frame is available
+ */
+const uint8_t* cira_acquire_frame(cira_ctx* ctx, int* w, int* h, uint64_t* seq,
+                                  frame_slot_t** slot);
+
+/**
+ * Run the loaded backend on an image, filling ctx->detections (scratch:
+ * publish it with cira_result_changed() or a store call).
+ * Caller must hold model_mutex (or otherwise exclude model swaps).
+ *
+ * @return CIRA_OK on success, CIRA_ERROR_MODEL if no backend matches
+ */
+int cira_backend_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
+
+/**
+ * Run count same-size images through the backend batch path (or one at a
+ * time when the backend has none), chunked by batch_max_size. Results land
+ * in ctx->batch_scratch[0..batch_scratch_count), which readers never see:
+ * the caller publishes what it needs under result_mutex.
+ * Caller must hold model_mutex.
+ *
+ * @return CIRA_OK on success, CIRA_ERROR_MEMORY if results cannot be reserved
+ */
+int cira_backend_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                               int w, int h, int channels);
+
+/**
+ * Store detections as a camera's latest result and rebuild its JSON.
+ * Camera 0 also updates the context result (cira_result_json()).
+ * Caller must hold result_mutex.
+ *
+ * @param img_w Image width used to convert boxes to pixels
+ * @param img_h Image height used to convert boxes to pixels
+ * @param frame_seq Capture sequence of the inferred frame (reported to result_notify)
+ */
+void cira_camera_store_result(cira_ctx* ctx, cira_camera_t* cam,
+                              const cira_detection_t* dets, int count, int img_w, int img_h,
+                              uint64_t frame_seq);
+
+/**
+ * Store tracked boxes as a camera's latest result (see tracker.h).
+ * Caller must hold result_mutex.
+ *
+ * @param track_ids Track ID of each box
+ * @param inferred 1 if the detector saw this frame (counted in total_frames
+ *                 and total_detections), 0 for a tracker prediction
+ * (other parameters as cira_camera_store_result())
+ */
+void cira_camera_store_tracks(cira_ctx* ctx, cira_camera_t* cam,
+                              const cira_detection_t* dets, const int* track_ids, int count,
+                              int img_w, int img_h, uint64_t frame_seq, int inferred);
+
+/**
+ * Publish ctx->detections as the context's new result (an API prediction):
+ * they are copied, so the next predict cannot disturb readers. Its JSON is
+ * built on the next read, not here.
+ * Caller must hold model_mutex and result_mutex.
+ *
+ * @param img_w Image width used to convert boxes to pixels
+ * @param img_h Image height used to convert boxes to pixels
+ */
+void cira_result_changed(cira_ctx* ctx, int img_w, int img_h);
+
+/**
+ * Latest result JSON of a camera, built first if a newer result was stored.
+ * Caller must hold result_mutex; the string is valid while it is held.
+ *
+ * @param camera Camera number, or -1 for the context result
+ */
+const char* cira_result_json_locked(cira_ctx* ctx, int camera);
+
+/**
+ * Latest result of a camera in binary form (see cira_result_raw()).
+ * Caller must hold result_mutex.
+ *
+ * @param camera Camera number, or -1 for the context result
+ * @return Bytes written, CIRA_ERROR_MEMORY if size is too small
+ */
+int cira_result_raw_locked(cira_ctx* ctx, int camera, void* buf, int size);
+
+/**
+ * Store ctx->detections as the next image of the current batch, in
+ * ctx->batch_scratch. Batch-capable loaders call this after decoding each
+ * image.
+ * Caller must hold model_mutex.
+ *
+ * @param img_w Image width used to convert boxes to pixels
+ * @param img_h Image height used to convert boxes to pixels
+ * @return 1 if stored, 0 if the batch result array is full
  */
-const uint8_t* cira_get_frame(cira_ctx* ctx, int* w, int* h);
+int cira_batch_store(cira_ctx* ctx, int img_w, int img_h);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,110 @@
+/**
+ * CiRA Runtime - CPU Affinity
+ *
+ * Splits the CPU between classes of runtime threads (capture, inference,
+ * encode, HTTP) so viewers and encoders cannot take cores from the
+ * backend's inference threads. The topology is read from sysfs: on
+ * big.LITTLE parts such as the RK3588 the cores with the lowest capacity
+ * are "little" and the rest "big"; uniform parts (Orin) are all big. Runtime
+ * threads pin themselves to their class when they start; backend pools
+ * (ONNX Runtime intra-op threads, NCNN's OpenMP team, NCNN batch
+ * workers, HTTP pool threads) are created by a thread pinned to their
+ * class and inherit its mask. Pinning is Linux only; elsewhere it is a
+ * no-op.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CPUs a mask can name */
+#define CPU_AFFINITY_MAX_CPUS 64
+
+/* Set of CPUs, bit i = CPU i; 0 = not pinned */
+typedef uint64_t cpu_mask_t;
+
+/* Classes of runtime threads */
+typedef enum {
+    CPU_CLASS_CAPTURE = 0,      /* Camera capture and preprocess stages */
+    CPU_CLASS_INFERENCE,        /* Inference scheduler, async worker, backend thread pools */
+    CPU_CLASS_ENCODE,           /* Camera publish stage: annotation, JPEG encode */
+    CPU_CLASS_HTTP,             /* HTTP server threads (snapshots, streams, API) */
+    CPU_CLASSES
+} cpu_class_t;
+
+/* CPU topology */
+typedef struct {
+    int num_cpus;               /* Online CPUs, at most CPU_AFFINITY_MAX_CPUS */
+    cpu_mask_t all;
+    cpu_mask_t big;             /* Fast cores (every core on a uniform CPU) */
+    cpu_mask_t little;          /* Slow cores, 0 on a uniform CPU */
+} cpu_topology_t;
+
+/**
+ * Read the topology of this machine (cached after the first call).
+ */
+const cpu_topology_t* cpu_topology(void);
+
+/**
+ * Build a topology from per-CPU capacities (sysfs cpu_capacity or maximum
+ * frequency, 0 if unknown). Cores with the lowest capacity are little,
+ * unless every core has the same.
+ */
+void cpu_topology_from_capacity(cpu_topology_t* topo, const int* capacity, int num_cpus);
+
+/**
+ * Default split of the topology between the thread classes. big.LITTLE:
+ * inference on the big cores, everything else on the little ones.
+ * Uniform with 4+ cores: the first core (first two with 8+) for capture,
+ * encode and HTTP, the rest for inference. Fewer cores: nothing pinned.
+ */
+void cpu_affinity_plan(const cpu_topology_t* topo, cpu_mask_t masks[CPU_CLASSES]);
+
+/**
+ * Parse a CPU set: a list like "0-3,6", "all", "big", "little", or ""
+ * / "none" for not pinned (0).
+ *
+ * @return 0 on success, -1 if invalid or outside the topology
+ */
+int cpu_mask_parse(const char* spec, const cpu_topology_t* topo, cpu_mask_t* mask);
+
+/**
+ * Format a mask as a list ("0-3,6"; "" for 0).
+ */
+void cpu_mask_format(cpu_mask_t mask, char* out, size_t out_size);
+
+/**
+ * Number of CPUs in a mask.
+ */
+int cpu_mask_count(cpu_mask_t mask);
+
+/**
+ * Pin the calling thread to mask (0 leaves it alone).
+ *
+ * @return 0 on success or no-op, -1 if the system refused
+ */
+int cpu_affinity_set_self(cpu_mask_t mask);
+
+/**
+ * CPUs the calling thread may run on (0 if unknown).
+ */
+cpu_mask_t cpu_affinity_get_self(void);
+
+/**
+ * "capture", "inference", "encode" or "http".
+ */
+const char* cpu_class_name(cpu_class_t cls);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPU_AFFINITY_H */
@@ -0,0 +1,117 @@
+/**
+ * CiRA Runtime - Fragmented MP4 Muxer
+ *
+ * Wraps an H.264 or H.265 elementary stream (Annex-B access units, as
+ * hardware and software encoders emit them) into fragmented MP4, the
+ * container browsers play through Media Source Extensions: one init
+ * segment (ftyp + moov with the avcC / hvcC decoder configuration),
+ * then one moof + mdat fragment per frame. A viewer that joins late
+ * gets the init segment and starts at the next keyframe fragment, so
+ * every viewer can share the same encoded fragments.
+ *
+ * Single video track, timescale 90 kHz, 4-byte NAL lengths. Parameter
+ * sets travel in the init segment only; they and access unit delimiters
+ * are dropped from the samples.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef FMP4_H
+#define FMP4_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Track timescale (ticks per second) */
+#define FMP4_TIMESCALE 90000
+
+/* Largest parameter set kept */
+#define FMP4_MAX_PARAM_SET 256
+
+typedef enum {
+    FMP4_CODEC_H264 = 0,
+    FMP4_CODEC_H265
+} fmp4_codec_t;
+
+/* What the init segment describes */
+typedef struct {
+    fmp4_codec_t codec;
+    int width;
+    int height;
+    uint8_t vps[FMP4_MAX_PARAM_SET];    /* H.265 only */
+    size_t vps_size;
+    uint8_t sps[FMP4_MAX_PARAM_SET];
+    size_t sps_size;
+    uint8_t pps[FMP4_MAX_PARAM_SET];
+    size_t pps_size;
+} fmp4_track_t;
+
+/**
+ * Initialize a track for w x h frames of codec.
+ */
+void fmp4_track_init(fmp4_track_t* track, fmp4_codec_t codec, int width, int height);
+
+/**
+ * Take the parameter sets (SPS, PPS, and VPS for H.265) carried by an
+ * Annex-B access unit, as encoders send them ahead of each keyframe.
+ *
+ * @return 1 if they differ from what the track held (a new init segment
+ *         is needed), 0 if unchanged or the access unit carries none
+ */
+int fmp4_track_update(fmp4_track_t* track, const uint8_t* au, size_t au_size);
+
+/**
+ * 1 once the track has every parameter set its codec needs.
+ */
+int fmp4_track_ready(const fmp4_track_t* track);
+
+/**
+ * RFC 6381 codec string, e.g. "avc1.42E01F" or "hvc1.1.6.L93.B0", for
+ * MediaSource.isTypeSupported() and the SourceBuffer type.
+ */
+void fmp4_codec_string(const fmp4_track_t* track, char* out, size_t out_size);
+
+/**
+ * 1 if an Annex-B access unit holds a keyframe (IDR, or IRAP for H.265).
+ */
+int fmp4_is_keyframe(fmp4_codec_t codec, const uint8_t* au, size_t au_size);
+
+/**
+ * Write the init segment (ftyp + moov) of a ready track.
+ *
+ * @return Bytes written, 0 if the track is not ready or out is too small
+ */
+size_t fmp4_init_segment(const fmp4_track_t* track, uint8_t* out, size_t out_size);
+
+/**
+ * Largest fragment fmp4_fragment() writes for an access unit of au_size.
+ */
+size_t fmp4_fragment_bound(size_t au_size);
+
+/**
+ * Write one frame as a fragment (moof + mdat).
+ *
+ * @param track       Track the frame belongs to
+ * @param sequence    Fragment number (starts at 1, increases by one)
+ * @param decode_time Frame time in FMP4_TIMESCALE ticks
+ * @param duration    Frame duration in ticks
+ * @param keyframe    1 if the frame can be decoded on its own
+ * @param au          Annex-B access unit
+ * @param au_size     Its size
+ * @param out         Receives the fragment
+ * @param out_size    Size of out (fmp4_fragment_bound() is always enough)
+ * @return Bytes written, 0 if the access unit has no picture data or out is too small
+ */
+size_t fmp4_fragment(const fmp4_track_t* track, uint32_t sequence, uint64_t decode_time,
+                     uint32_t duration, int keyframe, const uint8_t* au, size_t au_size,
+                     uint8_t* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FMP4_H */
@@ -0,0 +1,96 @@
+/**
+ * CiRA Runtime - Bounded SPSC Frame Queue
+ *
+ * Lock-free single-producer/single-consumer ring used to connect the
+ * camera pipeline stages. Items are opaque pointers owned by the caller.
+ *
+ * When the queue is full the producer either evicts the oldest item
+ * (FRAME_QUEUE_DROP_OLDEST, keeps latency bounded) or rejects the new one
+ * (FRAME_QUEUE_DROP_NEWEST). Either way the producer never blocks.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum queue capacity */
+#define FRAME_QUEUE_MAX_CAPACITY 64
+
+/* Full-queue policies */
+#define FRAME_QUEUE_DROP_OLDEST  0
+#define FRAME_QUEUE_DROP_NEWEST  1
+
+/* Opaque queue type */
+typedef struct frame_queue frame_queue_t;
+
+/**
+ * Create a queue.
+ *
+ * @param capacity Number of slots (1 to FRAME_QUEUE_MAX_CAPACITY)
+ * @param policy   FRAME_QUEUE_DROP_OLDEST or FRAME_QUEUE_DROP_NEWEST
+ * @return         New queue, or NULL on failure
+ */
+frame_queue_t* frame_queue_create(int capacity, int policy);
+
+/**
+ * Destroy a queue. Items still queued are not freed.
+ */
+void frame_queue_destroy(frame_queue_t* q);
+
+/**
+ * Push an item (producer thread only).
+ *
+ * @param q       Queue
+ * @param item    Item to enqueue (must not be NULL)
+ * @param dropped Output: item evicted or rejected because the queue was
+ *                full, or NULL if nothing was dropped. The caller owns it.
+ * @return        1 if item was enqueued, 0 if it was rejected
+ */
+int frame_queue_push(frame_queue_t* q, void* item, void** dropped);
+
+/**
+ * Pop the oldest item without blocking (consumer thread only).
+ *
+ * @return Item, or NULL if the queue is empty
+ */
+void* frame_queue_pop(frame_queue_t* q);
+
+/**
+ * Pop the oldest item, waiting up to timeout_ms for one to arrive.
+ *
+ * @return Item, or NULL on timeout or after frame_queue_wake()
+ */
+void* frame_queue_pop_wait(frame_queue_t* q, int timeout_ms);
+
+/**
+ * Wake a consumer blocked in frame_queue_pop_wait() (used on shutdown).
+ */
+void frame_queue_wake(frame_queue_t* q);
+
+/**
+ * Current number of queued items.
+ */
+int frame_queue_depth(frame_queue_t* q);
+
+/**
+ * Queue capacity.
+ */
+int frame_queue_capacity(frame_queue_t* q);
+
+/**
+ * Total items dropped because the queue was full.
+ */
+uint64_t frame_queue_dropped(frame_queue_t* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_QUEUE_H */
@@ -0,0 +1,177 @@
+/**
+ * CiRA Runtime - Shared-Memory Frame Ring
+ *
+ * Publishes camera frames (raw RGB24 or JPEG) and their detections into a
+ * POSIX shared-memory object (/dev/shm/<name> on Linux) so consumers on
+ * the same host, such as the Node gateway, map it read-only instead of
+ * fetching frames over HTTP or through the frame file.
+ *
+ * Layout (all fields little-endian, native alignment):
+ *
+ *   offset 0            frame_ring_header_t (64 bytes)
+ *   header_size         slot 0
+ *   + i * slot_size     slot i:
+ *                         frame_ring_slot_t (64 bytes)
+ *                         frame_ring_detection_t[FRAME_RING_MAX_DETECTIONS]
+ *                         payload (payload_capacity bytes)
+ *
+ * Frame n (sequence numbers start at 1) lives in slot (n - 1) % slot_count,
+ * and header.write_seq is the last frame published. Each slot is guarded
+ * by a seqlock: the writer makes slot.lock odd, fills the slot, then makes
+ * it even again. A reader copies the slot and accepts the copy only if
+ * lock was even and unchanged before and after, and slot.seq is the frame
+ * it wanted; otherwise it retries.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_RING_MAGIC    0x46524943u   /* "CIRF" */
+#define FRAME_RING_VERSION  1
+
+/* Payload formats */
+#define FRAME_RING_FORMAT_RGB24 0
+#define FRAME_RING_FORMAT_JPEG  1
+
+/* Detection records reserved per slot */
+#define FRAME_RING_MAX_DETECTIONS 256
+
+/* Slot count limits */
+#define FRAME_RING_MIN_SLOTS 2
+#define FRAME_RING_MAX_SLOTS 16
+
+/* Ring header at offset 0 */
+typedef struct {
+    uint32_t magic;             /* FRAME_RING_MAGIC once the ring is initialized */
+    uint32_t version;           /* FRAME_RING_VERSION */
+    uint32_t header_size;       /* Offset of slot 0 */
+    uint32_t slot_count;
+    uint64_t slot_size;         /* Bytes per slot, headers included */
+    uint64_t payload_capacity;  /* Largest payload a slot holds */
+    uint64_t write_seq;         /* Last published frame, 0 if none */
+    uint32_t writer_pid;
+    uint32_t reserved[5];
+} frame_ring_header_t;
+
+/* Slot header */
+typedef struct {
+    uint64_t lock;              /* Seqlock: odd while the writer fills the slot */
+    uint64_t seq;               /* Frame sequence number */
+    uint64_t timestamp_us;      /* Capture publish time, CLOCK_REALTIME microseconds */
+    uint32_t camera;            /* Camera number */
+    uint32_t format;            /* FRAME_RING_FORMAT_* */
+    uint32_t width;
+    uint32_t height;
+    uint32_t payload_size;      /* Bytes of payload */
+    uint32_t detection_count;   /* Valid detection records */
+    uint32_t reserved[4];
+} frame_ring_slot_t;
+
+/* Detection record (same layout as cira_detection_t) */
+typedef struct {
+    float x, y, w, h;           /* Bounding box, normalized 0-1, top-left origin */
+    float confidence;
+    int32_t label_id;
+} frame_ring_detection_t;
+
+/* Offset of the payload inside a slot */
+#define FRAME_RING_PAYLOAD_OFFSET \
+    (sizeof(frame_ring_slot_t) + FRAME_RING_MAX_DETECTIONS * sizeof(frame_ring_detection_t))
+
+/* Opaque handle (writer or reader mapping) */
+typedef struct frame_ring frame_ring_t;
+
+/* Frame copied out by frame_ring_read_latest() */
+typedef struct {
+    uint64_t seq;
+    uint64_t timestamp_us;
+    int camera;
+    int format;
+    int width;
+    int height;
+    size_t payload_size;
+    int detection_count;
+    frame_ring_detection_t detections[FRAME_RING_MAX_DETECTIONS];
+} frame_ring_frame_t;
+
+/* === Writer === */
+
+/**
+ * Create (or replace) a ring and map it read-write.
+ *
+ * @param name             Shared-memory object name, without the leading '/'
+ * @param slots            Slot count (clamped to FRAME_RING_MIN_SLOTS-MAX_SLOTS)
+ * @param payload_capacity Largest frame payload in bytes
+ * @return                 Ring, or NULL on failure (or where POSIX shm is unavailable)
+ */
+frame_ring_t* frame_ring_create(const char* name, int slots, size_t payload_capacity);
+
+/**
+ * Unmap a ring. The writer also unlinks the shared-memory object.
+ */
+void frame_ring_destroy(frame_ring_t* ring);
+
+/**
+ * Publish one frame. Safe to call from several threads.
+ *
+ * @param ring       Ring from frame_ring_create()
+ * @param camera     Camera number
+ * @param format     FRAME_RING_FORMAT_*
+ * @param w          Frame width
+ * @param h          Frame height
+ * @param data       Payload (w*h*3 RGB bytes or a JPEG file)
+ * @param size       Payload bytes
+ * @param dets       Detections (may be NULL if count is 0)
+ * @param count      Detection count (clamped to FRAME_RING_MAX_DETECTIONS)
+ * @return           Sequence number of the frame, or 0 if the payload does not fit
+ */
+uint64_t frame_ring_publish(frame_ring_t* ring, int camera, int format, int w, int h,
+                            const void* data, size_t size,
+                            const frame_ring_detection_t* dets, int count);
+
+/* === Reader === */
+
+/**
+ * Map an existing ring read-only.
+ *
+ * @return Ring, or NULL if it does not exist or is not a valid ring
+ */
+frame_ring_t* frame_ring_open(const char* name);
+
+/**
+ * Copy the newest frame of a camera.
+ *
+ * @param ring     Ring from frame_ring_open() or frame_ring_create()
+ * @param camera   Camera number, or -1 for the newest frame of any camera
+ * @param frame    Output: frame metadata and detections
+ * @param buf      Output: payload
+ * @param buf_size Capacity of buf
+ * @return         1 on success, 0 if no frame is available or buf is too small
+ */
+int frame_ring_read_latest(const frame_ring_t* ring, int camera, frame_ring_frame_t* frame,
+                           void* buf, size_t buf_size);
+
+/**
+ * Sequence number of the last published frame (0 if none).
+ */
+uint64_t frame_ring_sequence(const frame_ring_t* ring);
+
+/**
+ * Shared-memory object name of the ring.
+ */
+const char* frame_ring_name(const frame_ring_t* ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_RING_H */
@@ -0,0 +1,144 @@
+/**
+ * CiRA Runtime - Latest-Frame Store
+ *
+ * Publishes the most recent camera frame to any number of readers without
+ * locks. Frames live in reference-counted slots: the writer fills a free
+ * slot and publishes it with a single atomic pointer swap, readers take a
+ * reference to whatever was published last. A slot is only reused once
+ * every reader has released it, so readers never see a torn frame and the
+ * writer never waits for them.
+ *
+ * Slot buffers are allocated lazily, so memory grows only to the number of
+ * frames actually held at once.
+ *
+ * Readers that want every new frame can block in frame_store_wait() or
+ * register a notify callback, instead of polling the sequence number.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef FRAME_STORE_H
+#define FRAME_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of slots */
+#define FRAME_STORE_MAX_SLOTS 32
+
+/* Opaque types */
+typedef struct frame_store frame_store_t;
+typedef struct frame_slot frame_slot_t;
+
+/**
+ * Create a frame store.
+ *
+ * @param num_slots Number of slots (3 to FRAME_STORE_MAX_SLOTS)
+ * @return          New store, or NULL on failure
+ */
+frame_store_t* frame_store_create(int num_slots);
+
+/**
+ * Destroy a frame store. All slots must have been released.
+ */
+void frame_store_destroy(frame_store_t* store);
+
+/* === Writer === */
+
+/**
+ * Claim a free slot for a w x h RGB frame.
+ *
+ * @param store Frame store
+ * @param w     Frame width
+ * @param h     Frame height
+ * @param slot  Output: claimed slot, pass to commit or cancel
+ * @return      Buffer of w*h*3 bytes to fill, or NULL if every slot is
+ *              held by readers (the frame should be dropped)
+ */
+uint8_t* frame_store_begin_write(frame_store_t* store, int w, int h, frame_slot_t** slot);
+
+/**
+ * Publish a filled slot as the latest frame.
+ *
+ * @param store    Frame store
+ * @param slot     Slot from frame_store_begin_write()
+ * @param keep_ref Non-zero to keep a reference for the writer, which must
+ *                 later be dropped with frame_store_release()
+ * @return         Sequence number assigned to the frame (starts at 1)
+ */
+uint64_t frame_store_commit(frame_store_t* store, frame_slot_t* slot, int keep_ref);
+
+/**
+ * Return a claimed slot without publishing it.
+ */
+void frame_store_cancel(frame_store_t* store, frame_slot_t* slot);
+
+/* === Reader === */
+
+/**
+ * Take a reference to the latest published frame.
+ *
+ * @return Slot, or NULL if nothing has been published yet
+ */
+frame_slot_t* frame_store_acquire(frame_store_t* store);
+
+/**
+ * Drop a reference taken by frame_store_acquire() or commit(keep_ref).
+ */
+void frame_store_release(frame_slot_t* slot);
+
+/**
+ * Get frame data from a referenced slot. Valid until the slot is released.
+ *
+ * @param slot Referenced slot
+ * @param w    Output: width (may be NULL)
+ * @param h    Output: height (may be NULL)
+ * @param seq  Output: sequence number (may be NULL)
+ * @return     RGB pixel data
+ */
+const uint8_t* frame_slot_data(const frame_slot_t* slot, int* w, int* h, uint64_t* seq);
+
+/**
+ * Sequence number of the latest published frame (0 if none).
+ */
+uint64_t frame_store_sequence(frame_store_t* store);
+
+/**
+ * Frames dropped because no slot was free.
+ */
+uint64_t frame_store_dropped(frame_store_t* store);
+
+/* === Notification === */
+
+/**
+ * Called by the writer after each commit, on the writer's thread.
+ * Must not block or call back into the store's notification functions.
+ */
+typedef void (*frame_store_notify_fn)(void* arg, frame_store_t* store, uint64_t seq);
+
+/**
+ * Wait until a frame newer than after_seq is published.
+ *
+ * @param store      Frame store
+ * @param after_seq  Last sequence number the caller has seen
+ * @param timeout_ms Maximum wait in milliseconds
+ * @return           Latest sequence number (after_seq on timeout)
+ */
+uint64_t frame_store_wait(frame_store_t* store, uint64_t after_seq, int timeout_ms);
+
+/**
+ * Set the commit callback (one per store, NULL to clear). Once this
+ * returns the previous callback is no longer running and will not be
+ * called again.
+ */
+void frame_store_set_notify(frame_store_t* store, frame_store_notify_fn fn, void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_STORE_H */
@@ -0,0 +1,105 @@
+/**
+ * CiRA Runtime - Stored-Image Batches
+ *
+ * Runs inference over a list of image files (/api/inference/batch) at the
+ * rate of the slower of decoding and the device. A small pool of decode
+ * threads ("decode.threads") reads and decodes files at the reduced size
+ * the model needs (image_decoder.h) and queues them on the context's
+ * asynchronous predict path, keeping up to "async.queue_depth" images in
+ * flight so the backend never waits for a decode. Each image's result is
+ * appended as one JSON line (NDJSON) as soon as it completes, so results
+ * stream in completion order; a summary line ends the output.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef IMAGE_BATCH_H
+#define IMAGE_BATCH_H
+
+#include "cira_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Most images in one batch (paths or directory entries) */
+#define IMAGE_BATCH_MAX_IMAGES 100000
+
+typedef struct image_batch image_batch_t;
+
+/**
+ * Called when new output is ready or the batch finished, on a decode or
+ * predict worker thread. Must not block or call back into the batch.
+ */
+typedef void (*image_batch_notify_fn)(void* arg, image_batch_t* batch);
+
+/**
+ * Start decoding and inferring a list of files.
+ *
+ * @param paths   count file paths; the batch takes ownership of the array
+ *                and the strings (allocated with malloc) even on failure
+ * @param threads Decode threads, 0 for the "decode.threads" setting
+ * @param notify  Output callback, or NULL to use image_batch_wait()
+ * @return Batch, or NULL (out of memory, or no decode thread started)
+ */
+image_batch_t* image_batch_start(cira_ctx* ctx, char** paths, int count, int threads,
+                                 image_batch_notify_fn notify, void* arg);
+
+/**
+ * Copy the output not read yet.
+ *
+ * @return Bytes copied; 0 if nothing is pending yet; -1 when the batch has
+ *         finished and all its output was read
+ */
+int image_batch_read(image_batch_t* batch, char* buf, size_t max);
+
+/**
+ * Wait until output is pending or the batch has finished.
+ */
+void image_batch_wait(image_batch_t* batch, int timeout_ms);
+
+/**
+ * 1 if output is pending or everything was read, i.e. image_batch_read()
+ * would not return 0.
+ */
+int image_batch_readable(image_batch_t* batch);
+
+/**
+ * Stop decoding, wait for the images in flight and free the batch.
+ */
+void image_batch_destroy(image_batch_t* batch);
+
+/**
+ * List the JPEG and PNG files of a directory (by extension, sorted by
+ * name, not recursive).
+ *
+ * @param limit Most files to return, 0 for IMAGE_BATCH_MAX_IMAGES
+ * @param count Receives the number of paths
+ * @return malloc'd array of malloc'd paths (for image_batch_start()), or
+ *         NULL if the directory cannot be read or has no images
+ */
+char** image_batch_list_dir(const char* dir, int limit, int* count);
+
+/**
+ * Write a completed request's detections as JSON members
+ * ("detections":[...],"count":n), with boxes in src_w x src_h pixels
+ * (the image's size in its file, not the decoded size).
+ *
+ * @return Length written (truncated to out_size - 1)
+ */
+int image_result_members(cira_ctx* ctx, cira_request* req, int src_w, int src_h,
+                         char* out, size_t out_size);
+
+/**
+ * Write s as the body of a JSON string (quotes and control characters
+ * escaped).
+ *
+ * @return Length written (truncated to out_size - 1)
+ */
+int image_json_escape(const char* s, char* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMAGE_BATCH_H */
@@ -0,0 +1,99 @@
+/**
+ * CiRA Runtime - Image Decoder
+ *
+ * Decodes JPEG and PNG files to packed RGB for inference on stored
+ * images (/api/inference/image, /api/inference/batch). JPEG goes through
+ * libjpeg-turbo, which can run the inverse DCT at 1/2, 1/4 or 1/8 size:
+ * a 12 MP photo bound for a 640x640 model is decoded straight to 1000x750,
+ * skipping most of the IDCT and colour conversion work and the resize
+ * that would follow. PNG (libpng) is always decoded at full size.
+ *
+ * Each format needs its library at build time (CIRA_LIBJPEG_ENABLED,
+ * CIRA_LIBPNG_ENABLED); without it the format is reported unsupported.
+ * Decoding keeps no shared state, so any number of threads may decode at
+ * once.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest image accepted (pixels in the file, before scaling) */
+#define IMAGE_MAX_PIXELS (100 * 1000 * 1000)
+
+/* Largest file image_decode_file() reads */
+#define IMAGE_MAX_FILE_SIZE (64 * 1024 * 1024)
+
+typedef enum {
+    IMAGE_FORMAT_UNKNOWN = 0,
+    IMAGE_FORMAT_JPEG,
+    IMAGE_FORMAT_PNG
+} image_format_t;
+
+/* A decoded image */
+typedef struct {
+    uint8_t* pixels;        /* Packed RGB, w*h*3 bytes (free with image_free()) */
+    int w, h;               /* Decoded size */
+    int src_w, src_h;       /* Size stored in the file */
+    image_format_t format;
+} decoded_image_t;
+
+/**
+ * Identify an image from its first bytes.
+ */
+image_format_t image_format_detect(const uint8_t* data, size_t size);
+
+/**
+ * 1 if this build can decode the format.
+ */
+int image_format_supported(image_format_t format);
+
+/**
+ * Reduced JPEG decode size for a target: the smallest of 1/8, 1/4, 1/2
+ * and 1 (libjpeg-turbo has SIMD IDCTs for these) that keeps the image at
+ * least min_w x min_h, so the model's resize never upsamples.
+ *
+ * @param min_w, min_h Target size, 0 for full size
+ * @return Numerator over 8 (1, 2, 4 or 8)
+ */
+int image_scale_eighths(int src_w, int src_h, int min_w, int min_h);
+
+/**
+ * Decode an image in memory to RGB.
+ *
+ * @param min_w, min_h Smallest useful size (the model input), 0 for full
+ *                     size; JPEGs are decoded at the reduced scale above
+ * @param out          Receives the image; pixels is NULL on failure
+ * @param err          Receives a message on failure (may be NULL)
+ * @return CIRA_OK, CIRA_ERROR_INPUT for data that is not a supported,
+ *         intact image, CIRA_ERROR_MEMORY
+ */
+int image_decode(const uint8_t* data, size_t size, int min_w, int min_h,
+                 decoded_image_t* out, char* err, size_t err_size);
+
+/**
+ * Read and decode an image file (as image_decode()).
+ *
+ * @return As image_decode(), or CIRA_ERROR_FILE if the file cannot be read
+ */
+int image_decode_file(const char* path, int min_w, int min_h,
+                      decoded_image_t* out, char* err, size_t err_size);
+
+/**
+ * Free a decoded image's pixels (safe on a failed or freed image).
+ */
+void image_free(decoded_image_t* img);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IMAGE_DECODER_H */
@@ -0,0 +1,87 @@
+/**
+ * CiRA Runtime - Encode-Once JPEG Cache
+ *
+ * Caches encoded JPEGs keyed by (frame sequence, annotated, quality) so
+ * each frame is encoded at most once per variant no matter how many MJPEG
+ * clients, snapshots or frame-file writers ask for it. Encoded buffers are
+ * reference counted and can be handed to libmicrohttpd without copying.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef JPEG_CACHE_H
+#define JPEG_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "frame_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of cached variants (frames x annotated x quality) */
+#define JPEG_CACHE_ENTRIES 8
+
+/* Opaque types */
+typedef struct jpeg_cache jpeg_cache_t;
+typedef struct jpeg_buf jpeg_buf_t;
+
+struct cira_ctx;
+struct cira_camera;
+
+/**
+ * Create / destroy a cache. Buffers still referenced by callers stay
+ * valid after destroy until they are released.
+ */
+jpeg_cache_t* jpeg_cache_create(void);
+void jpeg_cache_destroy(jpeg_cache_t* cache);
+
+/**
+ * Get the JPEG for a frame, encoding it if no other caller has yet.
+ * Concurrent callers asking for the same variant wait for the first
+ * encode instead of encoding again.
+ *
+ * @param cache     Cache
+ * @param ctx       Context (labels, and detections when cam is NULL)
+ * @param cam       Camera whose detections annotate the frame, or NULL
+ * @param slot      Referenced frame store slot to encode
+ * @param annotated 1 to draw detections, 0 for raw
+ * @param quality   JPEG quality (1-100)
+ * @return          Referenced buffer (release with jpeg_buf_release), or
+ *                  NULL if encoding failed
+ */
+jpeg_buf_t* jpeg_cache_get(jpeg_cache_t* cache, struct cira_ctx* ctx, struct cira_camera* cam,
+                           frame_slot_t* slot, int annotated, int quality);
+
+/**
+ * Encoded data of a referenced buffer.
+ */
+const uint8_t* jpeg_buf_data(const jpeg_buf_t* buf, size_t* size);
+
+/**
+ * Frame sequence the buffer was encoded from.
+ */
+uint64_t jpeg_buf_sequence(const jpeg_buf_t* buf);
+
+/**
+ * Drop a reference.
+ */
+void jpeg_buf_release(jpeg_buf_t* buf);
+
+/**
+ * Drop a reference given the pointer returned by jpeg_buf_data().
+ * Matches MHD_ContentReaderFreeCallback for zero-copy responses.
+ */
+void jpeg_buf_release_data(void* data);
+
+/**
+ * Cache counters: lookups served from cache and encodes performed.
+ */
+void jpeg_cache_stats(jpeg_cache_t* cache, uint64_t* hits, uint64_t* encodes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JPEG_CACHE_H */
@@ -0,0 +1,112 @@
+/**
+ * CiRA Runtime - JPEG Encoder
+ *
+ * Encodes packed RGB frames with the best backend this build and machine
+ * offer. Backends are compiled in by CMake options and probed once at
+ * first use:
+ *
+ *   nvjpeg  CUDA nvJPEG (discrete GPUs, Jetson Orin)   CIRA_ENABLE_NVJPEG
+ *   turbo   libjpeg-turbo, RGB input, no conversion    CIRA_ENABLE_TURBOJPEG
+ *   opencv  cv::imencode after RGB->BGR                CIRA_ENABLE_OPENCV
+ *
+ * "auto" takes the first usable backend in that order; the "jpeg.encoder"
+ * option picks one by name. Output goes to a per-thread buffer, so
+ * encoders on different threads run in parallel without a lock.
+ * Callers normally go through the encode-once cache (jpeg_cache.c).
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef JPEG_ENCODER_H
+#define JPEG_ENCODER_H
+
+#include "cira_internal.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One encoder implementation */
+typedef struct {
+    const char* name;
+
+    /* 1 if the backend works on this machine (called once) */
+    int (*probe)(void);
+
+    /*
+     * Encode packed 3-channel pixels (bgr selects the channel order).
+     * The output stays valid until this thread encodes again.
+     */
+    int (*encode)(const uint8_t* pixels, int bgr, int width, int height, int quality,
+                  uint8_t** out_data, size_t* out_size);
+} jpeg_backend_t;
+
+#ifdef CIRA_NVJPEG_ENABLED
+extern const jpeg_backend_t jpeg_backend_nvjpeg;
+#endif
+#ifdef CIRA_TURBOJPEG_ENABLED
+extern const jpeg_backend_t jpeg_backend_turbo;
+#endif
+
+/**
+ * Encode RGB frame to JPEG.
+ *
+ * @param rgb_data RGB pixel data
+ * @param width Frame width
+ * @param height Frame height
+ * @param quality JPEG quality (1-100)
+ * @param out_data Output pointer (per-thread buffer, valid until this thread encodes again)
+ * @param out_size Output size in bytes
+ * @return CIRA_OK on success
+ */
+int jpeg_encode(const uint8_t* rgb_data, int width, int height,
+                int quality, uint8_t** out_data, size_t* out_size);
+
+/**
+ * Encode RGB frame with detection annotations overlaid.
+ *
+ * @param ctx Context (labels, and detections when cam is NULL)
+ * @param cam Camera whose detections to draw, or NULL
+ * @return CIRA_OK on success (other parameters as jpeg_encode())
+ */
+int jpeg_encode_annotated(cira_ctx* ctx, cira_camera_t* cam, const uint8_t* rgb_data,
+                          int width, int height, int quality,
+                          uint8_t** out_data, size_t* out_size);
+
+/**
+ * Copy an RGB frame with detection annotations drawn on it, e.g. as a
+ * video encoder's input.
+ *
+ * @param out Receives width*height*3 bytes of RGB
+ * @return CIRA_OK on success
+ */
+int frame_annotate(cira_ctx* ctx, cira_camera_t* cam, const uint8_t* rgb_data,
+                   int width, int height, uint8_t* out);
+
+/**
+ * Choose the backend: "auto", "nvjpeg", "turbo" or "opencv".
+ *
+ * @return CIRA_OK, CIRA_ERROR_INPUT for an unknown name, or CIRA_ERROR if
+ *         the backend is not built in or not usable here
+ */
+int jpeg_encoder_select(const char* name);
+
+/**
+ * Name of the backend in use ("none" if nothing can encode).
+ */
+const char* jpeg_encoder_name(void);
+
+/**
+ * Encode times of every frame encoded in this process (/metrics).
+ *
+ * @return Histogram, or NULL if it could not be allocated
+ */
+latency_hist_t* jpeg_encoder_latency(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JPEG_ENCODER_H */
@@ -0,0 +1,69 @@
+/**
+ * CiRA Runtime - Latency Histogram
+ *
+ * HDR-style log-linear histogram of durations: microsecond values land in
+ * power-of-two ranges split into 16 linear buckets each, so any quantile
+ * read back is within about 3% of the recorded value from 1 us to over an
+ * hour, in a fixed 3.7 KB. Recording is a few relaxed atomic adds and
+ * never takes a lock, so hot-path threads (each pipeline stage records
+ * into histograms of its own) pay next to nothing; readers summarize
+ * concurrently without stopping them.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Opaque histogram type */
+typedef struct latency_hist latency_hist_t;
+
+/* Summary of a histogram, milliseconds */
+typedef struct {
+    uint64_t count;         /* Values recorded */
+    double sum_ms;          /* Their total */
+    double max_ms;          /* Largest value */
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+} latency_summary_t;
+
+/**
+ * Create an empty histogram.
+ *
+ * @return New histogram, or NULL on allocation failure
+ */
+latency_hist_t* latency_hist_create(void);
+
+/**
+ * Destroy a histogram (NULL is ignored).
+ */
+void latency_hist_destroy(latency_hist_t* h);
+
+/**
+ * Record one duration. Lock-free and safe from any thread; a NULL
+ * histogram records nothing. Negative values count as 0.
+ */
+void latency_hist_record(latency_hist_t* h, double ms);
+
+/**
+ * Value at quantile q (0-1), milliseconds; 0 if nothing was recorded.
+ */
+double latency_hist_quantile(const latency_hist_t* h, double q);
+
+/**
+ * Count, sum, max and p50/p90/p99 in one pass (all zero for NULL).
+ */
+void latency_hist_summary(const latency_hist_t* h, latency_summary_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_HIST_H */
@@ -0,0 +1,70 @@
+/**
+ * CiRA Runtime - Model Files
+ *
+ * Read-only memory mapping of model files, so backends read weights
+ * straight from the page cache instead of copying them into the heap
+ * first, and an on-disk cache for what a backend compiles from a model
+ * (an optimized ONNX Runtime graph, for one). Cache entries are named by
+ * a hash of the model's contents and of a backend-supplied hardware tag
+ * (runtime version, CPU architecture, GPU), so a changed model or a
+ * different device never picks up a stale entry.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef MODEL_FILE_H
+#define MODEL_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A mapped (or, where mmap is unavailable, read) model file */
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    int mapped;                 /* 1 if data is an mmap, 0 if heap */
+} model_file_t;
+
+/**
+ * Map a whole file read-only.
+ *
+ * @param path File to map
+ * @param file Receives the mapping
+ * @return 0 on success, -1 if the file is missing, empty or unreadable
+ */
+int model_file_map(const char* path, model_file_t* file);
+
+/**
+ * Release a mapping (an empty model_file_t is ignored).
+ */
+void model_file_unmap(model_file_t* file);
+
+/**
+ * 64-bit hash of a file's contents (not cryptographic; for cache keys).
+ */
+uint64_t model_file_hash(const model_file_t* file);
+
+/**
+ * Path of a cache entry, creating the cache directory if needed.
+ *
+ * @param cache_dir Configured directory; empty for $XDG_CACHE_HOME/cira
+ *                  (or ~/.cache/cira), "off" to disable caching
+ * @param model_hash model_file_hash() of the source model
+ * @param hw_tag Backend and hardware the entry is only valid for
+ * @param ext Entry extension, e.g. ".ort"
+ * @param out Receives the path
+ * @param out_size Size of out
+ * @return 1 if out holds a path, 0 if caching is off or unavailable
+ */
+int model_cache_path(const char* cache_dir, uint64_t model_hash, const char* hw_tag,
+                     const char* ext, char* out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODEL_FILE_H */
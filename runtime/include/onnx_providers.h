@@ -0,0 +1,111 @@
+/**
+ * CiRA Runtime - ONNX Execution Providers
+ *
+ * Parses the execution-provider preference of an ONNX model: the
+ * providers ONNX Runtime should try, best first, each with its own
+ * options. The same spec comes from the manifest ("execution_providers")
+ * or the "onnx.providers" option:
+ *
+ *   tensorrt(trt_fp16_enable=1);cuda(device_id=0);cpu
+ *
+ * Providers are separated by ';', options by ','. Two options belong to
+ * the runtime rather than the provider: "opt" (graph optimization level:
+ * disable, basic, extended, all) and "arena" (CPU memory arena, 0/1),
+ * which apply to the session when that provider is the one chosen.
+ * Everything else is handed to the provider as is. cpu is always the last
+ * resort: it is appended when missing and may not come earlier.
+ *
+ * No ONNX Runtime types here, so the parser builds (and is tested)
+ * without ONNX Runtime.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef ONNX_PROVIDERS_H
+#define ONNX_PROVIDERS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Execution providers the loader knows how to append */
+typedef enum {
+    ONNX_EP_CPU = 0,
+    ONNX_EP_CUDA,
+    ONNX_EP_TENSORRT,
+    ONNX_EP_OPENVINO,
+    ONNX_EP_XNNPACK,
+    ONNX_EP_COUNT
+} onnx_ep_t;
+
+/* Graph optimization levels ("opt"), in ORT's order */
+typedef enum {
+    ONNX_OPT_DISABLE = 0,
+    ONNX_OPT_BASIC,
+    ONNX_OPT_EXTENDED,
+    ONNX_OPT_ALL
+} onnx_opt_level_t;
+
+/* Provider options passed through, per provider */
+#define ONNX_PROVIDER_MAX_OPTIONS 8
+#define ONNX_PROVIDER_KEY_LEN     48
+#define ONNX_PROVIDER_VALUE_LEN   128
+
+/* One provider of a spec */
+typedef struct {
+    onnx_ep_t ep;
+    onnx_opt_level_t opt_level;     /* "opt", else the provider's default */
+    int arena;                      /* "arena", else the provider's default */
+    int num_options;
+    char keys[ONNX_PROVIDER_MAX_OPTIONS][ONNX_PROVIDER_KEY_LEN];
+    char values[ONNX_PROVIDER_MAX_OPTIONS][ONNX_PROVIDER_VALUE_LEN];
+} onnx_provider_t;
+
+/* Providers in order of preference; the last is always cpu */
+typedef struct {
+    onnx_provider_t providers[ONNX_EP_COUNT];
+    int count;
+} onnx_provider_list_t;
+
+/**
+ * Parse a spec. An empty (or NULL) spec is cpu alone.
+ *
+ * Defaults: extended optimization (it fuses int8 QDQ pairs) and the
+ * arena on, except OpenVINO, which compiles the graph itself and
+ * allocates its own memory: no ORT optimization, no arena.
+ *
+ * @param err Receives why a spec was rejected (may be NULL)
+ * @return 0 on success, -1 on an unknown or repeated provider, cpu before
+ *         the end, a malformed option or too many options
+ */
+int onnx_providers_parse(const char* spec, onnx_provider_list_t* list,
+                         char* err, size_t err_size);
+
+/**
+ * Format a list back into a spec, runtime options included only where
+ * they differ from the provider's default.
+ */
+void onnx_providers_format(const onnx_provider_list_t* list, char* out, size_t out_size);
+
+/**
+ * Value of a pass-through option, NULL if not given.
+ */
+const char* onnx_provider_option(const onnx_provider_t* provider, const char* key);
+
+/**
+ * "cpu", "cuda", "tensorrt", "openvino" or "xnnpack".
+ */
+const char* onnx_provider_name(onnx_ep_t ep);
+
+/**
+ * "disable", "basic", "extended" or "all".
+ */
+const char* onnx_opt_level_name(onnx_opt_level_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ONNX_PROVIDERS_H */
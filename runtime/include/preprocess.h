@@ -0,0 +1,125 @@
+/**
+ * CiRA Runtime - Image Preprocessing
+ *
+ * Shared CPU preprocessing for the loaders: packed RGB/BGR uint8 frame in,
+ * resized (stretch or letterbox), 0-1 normalized fp32 or fp16 tensor out,
+ * NCHW or NHWC, in a single call. Row blending, normalization and fp16
+ * conversion use AVX2/F16C on x86 (selected at runtime) and NEON on ARM.
+ *
+ * A plan owns all working memory, sized at preprocess_init() for the
+ * destination, so preprocess_run() never allocates. One plan per thread.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef PREPROCESS_H
+#define PREPROCESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Source channel order */
+#define PREPROCESS_RGB 0
+#define PREPROCESS_BGR 1
+
+/* Destination layout */
+#define PREPROCESS_NCHW 0
+#define PREPROCESS_NHWC 1
+
+/* Letterbox padding (Ultralytics gray 114) */
+#define PREPROCESS_PAD_VALUE (114.0f / 255.0f)
+
+/* Where the image landed inside the destination */
+typedef struct {
+    float scale_x;      /* Resized width / source width */
+    float scale_y;      /* Resized height / source height */
+    int pad_x;          /* Left padding in destination pixels */
+    int pad_y;          /* Top padding in destination pixels */
+    int new_w;          /* Resized image size inside the destination */
+    int new_h;
+} preprocess_geom_t;
+
+typedef struct {
+    /* Destination, fixed at init */
+    int dst_w;
+    int dst_h;
+    int layout;             /* PREPROCESS_NCHW or PREPROCESS_NHWC */
+    int fp16;               /* 1 to write IEEE half instead of float */
+    int letterbox;          /* 1 to keep aspect ratio and pad, 0 to stretch */
+
+    /* Per-run settings, may be changed between runs */
+    int order;              /* PREPROCESS_RGB or PREPROCESS_BGR */
+    size_t plane_stride;    /* NCHW elements between channel planes (0 = dst_w * dst_h) */
+    int use_simd;           /* Set at init when supported; clear to force scalar */
+
+    /* Geometry of the last run */
+    preprocess_geom_t geom;
+
+    /* Working memory (owned) */
+    int src_w;              /* Source size the tables were built for */
+    int src_h;
+    int* x_lo;              /* Per resized column: left/right source pixel */
+    int* x_hi;
+    float* x_wt;            /* Per resized column: weight of the right pixel */
+    float* rows[2];         /* Horizontally resampled source rows, 0-1 */
+    int row_y[2];           /* Source row held in rows[i], -1 if none */
+} preprocess_plan_t;
+
+/**
+ * Prepare a plan for a destination tensor.
+ *
+ * @param plan      Plan to initialize
+ * @param dst_w     Destination width (model input width)
+ * @param dst_h     Destination height (model input height)
+ * @param layout    PREPROCESS_NCHW or PREPROCESS_NHWC
+ * @param fp16      1 for a half precision destination
+ * @param letterbox 1 to letterbox, 0 to stretch
+ * @return          CIRA_OK, or CIRA_ERROR_MEMORY
+ */
+int preprocess_init(preprocess_plan_t* plan, int dst_w, int dst_h, int layout,
+                    int fp16, int letterbox);
+
+/**
+ * Free the plan's working memory.
+ */
+void preprocess_free(preprocess_plan_t* plan);
+
+/**
+ * Resize, normalize and lay out one image. Writes every destination
+ * element (padding included) and fills plan->geom.
+ *
+ * @param plan  Initialized plan
+ * @param src   Packed 3-channel uint8 image, row-major
+ * @param src_w Source width
+ * @param src_h Source height
+ * @param dst   Destination tensor for one image (float* or uint16_t*)
+ * @return      CIRA_OK, or CIRA_ERROR_INPUT
+ */
+int preprocess_run(preprocess_plan_t* plan, const uint8_t* src, int src_w, int src_h,
+                   void* dst);
+
+/**
+ * Name of the vector unit preprocess_run() uses ("avx2", "neon" or "scalar").
+ */
+const char* preprocess_simd_name(void);
+
+/**
+ * IEEE half precision conversion with round-to-nearest-even.
+ */
+uint16_t preprocess_float_to_half(float value);
+
+/**
+ * Convert IEEE half precision values to float (exact), vectorized where
+ * the CPU allows. Used on float16 model outputs.
+ */
+void preprocess_half_to_float(const uint16_t* src, float* dst, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PREPROCESS_H */
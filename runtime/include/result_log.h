@@ -0,0 +1,180 @@
+/**
+ * CiRA Runtime - Result History
+ *
+ * Keeps the last results the context stored (sequence, wall-clock time,
+ * camera, image size and compact detections) in fixed memory, so a client
+ * that reconnects or polls rarely asks for everything after the last
+ * result_sequence it saw (/api/results/range?since=N) instead of sampling
+ * /api/results. The history is a ring of columns: per-result fields in
+ * one array each, detections in a second ring of columns. Range queries
+ * binary-search the sequence or timestamp column and copy contiguous
+ * runs, and appends touch one slot per column.
+ *
+ * A result leaves the history when the result ring or the detection ring
+ * wraps over it, or when it is older than the age limit.
+ *
+ * Optionally every result is also appended to a memory-mapped segment
+ * file on disk. Layout (little-endian, native alignment):
+ *
+ *   offset 0            result_log_file_header_t (64 bytes)
+ *   header_size         records, back to back, up to write_offset:
+ *                         result_log_record_t (40 bytes)
+ *                         cira_result_record_t[detection_count]
+ *
+ * write_offset is stored after a record is complete, so a reader that
+ * maps the file sees whole records only. A full segment is renamed to
+ * "<path>.1" (replacing the previous one) and a new one started; a
+ * segment left by an earlier run is moved aside the same way.
+ *
+ * Not thread-safe: the context guards its history with result_mutex.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef RESULT_LOG_H
+#define RESULT_LOG_H
+
+#include "cira.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RESULT_LOG_MAGIC    0x4C524943u   /* "CIRL" */
+#define RESULT_LOG_VERSION  1
+
+/* Results held in memory */
+#define RESULT_LOG_MIN_RESULTS 64
+#define RESULT_LOG_MAX_RESULTS (1024 * 1024)
+
+/* Detection ring size per result slot (average detections kept per result) */
+#define RESULT_LOG_DETECTIONS_PER_RESULT 8
+
+/* Segment file size limits */
+#define RESULT_LOG_MIN_SEGMENT (1024 * 1024)
+#define RESULT_LOG_MAX_SEGMENT ((size_t)1024 * 1024 * 1024)
+
+/* Segment file header at offset 0 */
+typedef struct {
+    uint32_t magic;             /* RESULT_LOG_MAGIC */
+    uint32_t version;           /* RESULT_LOG_VERSION */
+    uint32_t header_size;       /* Offset of the first record */
+    uint32_t record_size;       /* sizeof(result_log_record_t) */
+    uint32_t detection_size;    /* sizeof(cira_result_record_t) */
+    uint32_t writer_pid;
+    uint64_t write_offset;      /* End of the last complete record */
+    uint64_t segment_size;      /* File size */
+    int64_t created_ms;         /* CLOCK_REALTIME milliseconds */
+    uint32_t reserved[4];
+} result_log_file_header_t;
+
+/* Segment file record; detection_count cira_result_record_t follow */
+typedef struct {
+    uint64_t sequence;          /* Context result_sequence */
+    uint64_t frame_sequence;    /* Capture sequence (cameras) or frames predicted (API) */
+    int64_t timestamp_ms;       /* CLOCK_REALTIME milliseconds when stored */
+    int32_t camera;             /* Camera number, -1 for API predictions */
+    uint16_t width;             /* Image size the normalized boxes refer to */
+    uint16_t height;
+    uint32_t detection_count;
+    uint32_t reserved;
+} result_log_record_t;
+
+/* One result copied out by result_log_range() */
+typedef struct {
+    uint64_t sequence;
+    uint64_t frame_sequence;
+    int64_t timestamp_ms;
+    int camera;
+    int width;
+    int height;
+    int first_detection;        /* Index into result_range_t.detections */
+    int detection_count;
+} result_log_entry_t;
+
+/* Results copied out by result_log_range() (free with result_range_free()) */
+typedef struct {
+    result_log_entry_t* entries;
+    int count;
+    cira_result_record_t* detections;
+    int num_detections;
+    uint64_t oldest;            /* Oldest sequence held, 0 if the history is empty */
+    uint64_t latest;            /* Newest sequence held, 0 if the history is empty */
+    int more;                   /* Matching results after the last one copied */
+} result_range_t;
+
+typedef struct result_log result_log_t;
+
+/**
+ * Create an empty history.
+ *
+ * @param max_results Results held (clamped to RESULT_LOG_MIN-MAX_RESULTS)
+ * @param max_age_sec Drop results older than this, 0 for no age limit
+ * @return History, or NULL if out of memory
+ */
+result_log_t* result_log_create(int max_results, int max_age_sec);
+
+/**
+ * Free a history and unmap its segment file.
+ */
+void result_log_destroy(result_log_t* log);
+
+/**
+ * Also append every result to a segment file.
+ *
+ * @param size Segment size (clamped to RESULT_LOG_MIN-MAX_SEGMENT)
+ * @return CIRA_OK, CIRA_ERROR_FILE if the file cannot be created or mapped
+ *         (or where mmap is unavailable)
+ */
+int result_log_open_segment(result_log_t* log, const char* path, size_t size);
+
+/**
+ * Append a result. Sequences must increase.
+ *
+ * @param dets  Detections, boxes normalized (cira_detection_t has this
+ *              layout; may be NULL if count is 0)
+ * @param count Detection count (clamped to CIRA_RESULT_MAX_RECORDS)
+ */
+void result_log_append(result_log_t* log, uint64_t sequence, int64_t timestamp_ms,
+                       int camera, uint64_t frame_sequence, int width, int height,
+                       const cira_result_record_t* dets, int count);
+
+/**
+ * Copy results with a sequence above since and a timestamp at or after
+ * from_ms, oldest first.
+ *
+ * @param camera Results of this camera only, -1 for all
+ * @param limit  Most results to copy
+ * @param out    Receives the results
+ * @return CIRA_OK, CIRA_ERROR_MEMORY
+ */
+int result_log_range(const result_log_t* log, uint64_t since, int64_t from_ms,
+                     int camera, int limit, result_range_t* out);
+
+/**
+ * Free the arrays of a range (safe on a zeroed or freed range).
+ */
+void result_range_free(result_range_t* range);
+
+/**
+ * Results currently held.
+ */
+int result_log_count(const result_log_t* log);
+
+/**
+ * Bytes the segment file holds, 0 without one.
+ */
+uint64_t result_log_segment_bytes(const result_log_t* log);
+
+/**
+ * Current CLOCK_REALTIME time in milliseconds (the timestamps above).
+ */
+int64_t result_log_now_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESULT_LOG_H */
@@ -0,0 +1,95 @@
+/**
+ * CiRA Runtime - Multi-Object Tracker
+ *
+ * SORT/ByteTrack-style tracking of detections across frames. Each track
+ * keeps a constant-velocity Kalman filter on its box centre and size;
+ * detections are associated to the tracks' predicted boxes by IoU, same
+ * label only, greedily from the best overlap down. As in ByteTrack,
+ * confident detections are matched first and the rest are only used to
+ * keep existing tracks alive, never to start new ones.
+ *
+ * Between detector runs tracker_predict() moves every track along its
+ * velocity, so boxes (with stable IDs) can be reported at camera rate
+ * while the detector runs on every Nth frame.
+ *
+ * A tracker is not thread-safe; callers serialize access.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include "cira_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Opaque handle */
+typedef struct tracker tracker_t;
+
+/* Tracker configuration */
+typedef struct {
+    float high_threshold;   /* Confidence to start a track or take the first pass (0.5) */
+    float match_iou;        /* Least IoU between a track and its detection (0.3) */
+    int max_misses;         /* Detector runs a track may go unmatched before it is dropped (3) */
+    int min_hits;           /* Matches before a track is reported (2) */
+} tracker_config_t;
+
+/**
+ * Fill a configuration with the defaults above.
+ */
+void tracker_default_config(tracker_config_t* config);
+
+/**
+ * Create a tracker.
+ *
+ * @param config Configuration, or NULL for the defaults
+ * @return Tracker, or NULL on allocation failure
+ */
+tracker_t* tracker_create(const tracker_config_t* config);
+
+/**
+ * Destroy a tracker.
+ */
+void tracker_destroy(tracker_t* tracker);
+
+/**
+ * Drop every track (IDs keep counting up).
+ */
+void tracker_reset(tracker_t* tracker);
+
+/**
+ * Feed one detector result.
+ *
+ * @param dets     Detections, boxes normalized 0-1
+ * @param count    Number of detections
+ * @param time_ms  Capture time of the frame (any monotonic clock)
+ * @param out      Output: confirmed tracks matched in this update
+ * @param ids      Output: track ID of each output box (IDs start at 1)
+ * @param max_out  Capacity of out and ids
+ * @return Number of boxes written
+ */
+int tracker_update(tracker_t* tracker, const cira_detection_t* dets, int count, double time_ms,
+                   cira_detection_t* out, int* ids, int max_out);
+
+/**
+ * Move tracks to a frame the detector did not see.
+ *
+ * @return Number of boxes written: confirmed tracks matched by the last
+ *         update, at their predicted position (parameters as tracker_update())
+ */
+int tracker_predict(tracker_t* tracker, double time_ms, cira_detection_t* out, int* ids,
+                    int max_out);
+
+/**
+ * Number of live tracks, confirmed or not.
+ */
+int tracker_count(const tracker_t* tracker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACKER_H */
@@ -0,0 +1,179 @@
+/**
+ * CiRA Runtime - Encoded Video Streams
+ *
+ * One H.264 / H.265 encoder per camera whose output every viewer of
+ * /stream/video shares. The camera publish stage draws the annotations
+ * once into the encoder's input frame; a GStreamer pipeline encodes it
+ * with the first usable backend:
+ *
+ *   nvenc     Jetson NVENC (nvv4l2h264enc / nvv4l2h265enc)
+ *   mpp       Rockchip MPP (mpph264enc / mpph265enc, RK3588)
+ *   v4l2      V4L2 memory-to-memory encoder (v4l2h264enc / v4l2h265enc)
+ *   software  x264enc / x265enc
+ *
+ * and each access unit is muxed into a fragmented MP4 fragment (fmp4.h)
+ * kept in a short reference-counted history. Viewers get the init
+ * segment, then fragments from the next keyframe on; a viewer joining
+ * asks the encoder for a keyframe so it starts at once. Frames are only
+ * encoded while someone watches, and dropped rather than queued when the
+ * encoder falls behind.
+ *
+ * Encoding needs a build with GStreamer (CIRA_GSTREAMER_ENABLED);
+ * without it the encoder never starts and viewers get nothing.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifndef VIDEO_ENCODER_H
+#define VIDEO_ENCODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fragments kept for viewers that fall behind (about 2 s at 30 fps) */
+#define VIDEO_HISTORY 64
+
+typedef enum {
+    VIDEO_CODEC_OFF = 0,
+    VIDEO_CODEC_H264,
+    VIDEO_CODEC_H265
+} video_codec_t;
+
+/* Encoder settings ("video.*" options) */
+typedef struct {
+    video_codec_t codec;
+    char backend[16];           /* "auto", "nvenc", "mpp", "v4l2" or "software" */
+    int bitrate_kbps;
+    int gop;                    /* Frames between keyframes */
+} video_config_t;
+
+/* Counters for /api/stats */
+typedef struct {
+    int running;                /* Pipeline encoding */
+    const char* backend;        /* Backend in use, "" if not running */
+    char codec[48];             /* RFC 6381 codec string, "" before the first keyframe */
+    int width, height;
+    int viewers;
+    uint64_t frames;            /* Fragments produced */
+    uint64_t keyframes;
+    uint64_t bytes;             /* Fragment bytes produced (each sent once per viewer) */
+    uint64_t dropped;           /* Frames dropped because the encoder was behind */
+} video_encoder_stats_t;
+
+/* Opaque types */
+typedef struct video_encoder video_encoder_t;
+typedef struct video_segment video_segment_t;
+
+/**
+ * Create / destroy an encoder. No pipeline runs until the first frame.
+ * Segments still referenced by callers stay valid after destroy until
+ * they are released.
+ */
+video_encoder_t* video_encoder_create(void);
+void video_encoder_destroy(video_encoder_t* enc);
+
+/**
+ * Check a backend name: "auto", "nvenc", "mpp", "v4l2" or "software".
+ */
+int video_backend_known(const char* name);
+
+/* === Writer (camera publish stage) === */
+
+/**
+ * 1 if anyone is watching, i.e. frames should be annotated and encoded.
+ */
+int video_encoder_wanted(video_encoder_t* enc);
+
+/**
+ * Get the input buffer for a w x h RGB frame (even sizes only), starting
+ * (or restarting, when the size or config changed) the pipeline.
+ *
+ * @return w*h*3 bytes to fill and pass to video_encoder_end_frame(), or
+ *         NULL to skip this frame (encoder behind, or no usable backend)
+ */
+uint8_t* video_encoder_begin_frame(video_encoder_t* enc, const video_config_t* config,
+                                   int w, int h);
+
+/**
+ * Encode the frame filled since video_encoder_begin_frame().
+ *
+ * @param capture_ms When the frame was captured (ms, monotonic)
+ */
+void video_encoder_end_frame(video_encoder_t* enc, double capture_ms);
+
+/**
+ * Stop the pipeline (camera stopped). Viewers keep waiting; the next
+ * pipeline starts a new init segment, which ends their streams.
+ */
+void video_encoder_stop(video_encoder_t* enc);
+
+/* === Viewers === */
+
+/**
+ * Count a viewer in or out. Subscribing asks for a keyframe.
+ *
+ * @return Sequence to start from (pass to video_encoder_next())
+ */
+uint64_t video_encoder_subscribe(video_encoder_t* enc);
+void video_encoder_unsubscribe(video_encoder_t* enc);
+
+/**
+ * Take a reference to the current init segment (NULL until the encoder
+ * has produced one).
+ */
+video_segment_t* video_encoder_init_segment(video_encoder_t* enc);
+
+/**
+ * Take a reference to the fragment after *cursor. With need_keyframe
+ * (and whenever fragments after *cursor were already overwritten, which
+ * would break decoding) delta fragments are skipped.
+ *
+ * @param cursor In: last fragment sent. Out: the fragment returned, or
+ *               the last one looked at
+ * @return Fragment, or NULL if none is ready yet
+ */
+video_segment_t* video_encoder_next(video_encoder_t* enc, uint64_t* cursor, int need_keyframe);
+
+/**
+ * Sequence of the newest fragment (0 if none). Lock-free.
+ */
+uint64_t video_encoder_sequence(video_encoder_t* enc);
+
+/**
+ * Wait until a fragment newer than after_seq is published.
+ *
+ * @return Newest sequence (after_seq on timeout)
+ */
+uint64_t video_encoder_wait(video_encoder_t* enc, uint64_t after_seq, int timeout_ms);
+
+/**
+ * Called after each new fragment, on the encoder's thread. Must not
+ * block or call back into the encoder. One per encoder, NULL to clear;
+ * once this returns the previous callback is no longer running.
+ */
+typedef void (*video_encoder_notify_fn)(void* arg, video_encoder_t* enc);
+void video_encoder_set_notify(video_encoder_t* enc, video_encoder_notify_fn fn, void* arg);
+
+/**
+ * Current counters.
+ */
+void video_encoder_stats(video_encoder_t* enc, video_encoder_stats_t* stats);
+
+/* === Segments === */
+
+const uint8_t* video_segment_data(const video_segment_t* seg, size_t* size);
+
+/* Init segment a fragment belongs to; a different one means the stream restarted */
+uint64_t video_segment_generation(const video_segment_t* seg);
+
+void video_segment_release(video_segment_t* seg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VIDEO_ENCODER_H */
@@ -21,7 +21,7 @@ typedef enum {
     YOLO_VERSION_AUTO = 0,  /* Auto-detect from output shape */
     YOLO_VERSION_V4,        /* YOLOv3/v4: per-scale anchors, sigmoid */
     YOLO_VERSION_V5,        /* YOLOv5/v7: concatenated, pre-decoded */
-    YOLO_VERSION_V8,        /* YOLOv8/v9/v11: transposed, no objectness */
+    YOLO_VERSION_V8,        /* YOLOv8/v9/v11: transposed, no objectness (or raw DFL rows) */
     YOLO_VERSION_V10        /* YOLOv10: NMS-free, [1,300,6] */
 } yolo_version_t;
 
@@ -40,11 +40,15 @@ typedef struct {
     float conf_threshold;   /* Confidence threshold */
     float nms_threshold;    /* NMS IoU threshold */
     int max_detections;     /* Maximum detections to return */
+    int verbose;            /* Print per-call debug information */
 } yolo_decode_config_t;
 
 /**
  * Decode YOLO model output to detections.
  *
+ * Pixel coordinates are in model input space. When more than max_dets
+ * candidates pass the threshold, the highest scoring ones are kept.
+ *
  * @param output        Raw model output tensor
  * @param output_shape  Output tensor shape (up to 4 dims)
  * @param num_dims      Number of dimensions in output_shape
@@ -67,6 +71,18 @@ int yolo_decode(const float* output, const int64_t* output_shape, int num_dims,
  */
 int yolo_nms(yolo_detection_t* detections, int count, float nms_threshold);
 
+/**
+ * Class-aware NMS that stops once max_keep boxes are kept. Survivors are
+ * returned in descending score order.
+ *
+ * @param detections    Array of detections (modified in-place)
+ * @param count         Number of detections
+ * @param nms_threshold IoU threshold for suppression
+ * @param max_keep      Maximum detections to keep (<= 0 for all)
+ * @return              Number of detections after NMS
+ */
+int yolo_nms_topk(yolo_detection_t* detections, int count, float nms_threshold, int max_keep);
+
 /**
  * Parse YOLO version string from manifest.
  *
@@ -1,312 +1,415 @@
 /**
- * CiRA Runtime - Image Annotator
+ * CiRA Runtime - Frame Annotator
  *
- * This file implements drawing bounding boxes, labels, and confidence
- * scores on frames. It uses simple pixel-level operations to avoid
- * external dependencies.
+ * Boxes and labels drawn as clipped row spans (see annotator.h). A span
+ * is filled by writing one pixel and doubling it with memcpy, and a
+ * rectangle copies its first row down, so the cost follows the pixels
+ * that change rather than the frame size. Glyphs are split once into
+ * the rectangles of their runs, merged down identical rows, so a
+ * character is a few fills at any scale.
  *
  * (c) CiRA Robotics / KMITL 2026
  */
 
+#include "annotator.h"
 #include "cira.h"
-#include "cira_internal.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
-
-#ifdef CIRA_STREAMING_ENABLED
-
-/* Color palette for different classes (BGR format) */
-static const uint8_t class_colors[][3] = {
-    {0, 255, 0},     /* Green */
-    {255, 0, 0},     /* Blue */
-    {0, 0, 255},     /* Red */
-    {255, 255, 0},   /* Cyan */
-    {255, 0, 255},   /* Magenta */
-    {0, 255, 255},   /* Yellow */
-    {128, 0, 255},   /* Orange */
-    {255, 128, 0},   /* Light blue */
-    {0, 128, 255},   /* Light orange */
-    {128, 255, 0},   /* Light green */
+#include <pthread.h>
+
+/* 5x7 font covering printable ASCII; lowercase draws as uppercase and
+ * characters without a glyph as blanks. Bit 4 is the leftmost column. */
+#define FONT_FIRST  32
+#define FONT_GLYPHS 96
+#define FONT_W      5
+#define FONT_H      7
+#define FONT_ADVANCE (FONT_W + 1)
+
+static const uint8_t font_5x7[FONT_GLYPHS][FONT_H] = {
+    [' ' - FONT_FIRST] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    ['!' - FONT_FIRST] = { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },
+    ['#' - FONT_FIRST] = { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A },
+    ['%' - FONT_FIRST] = { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },
+    ['(' - FONT_FIRST] = { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },
+    [')' - FONT_FIRST] = { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },
+    ['+' - FONT_FIRST] = { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },
+    [',' - FONT_FIRST] = { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },
+    ['-' - FONT_FIRST] = { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },
+    ['.' - FONT_FIRST] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },
+    ['/' - FONT_FIRST] = { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },
+    ['0' - FONT_FIRST] = { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },
+    ['1' - FONT_FIRST] = { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },
+    ['2' - FONT_FIRST] = { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },
+    ['3' - FONT_FIRST] = { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },
+    ['4' - FONT_FIRST] = { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },
+    ['5' - FONT_FIRST] = { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },
+    ['6' - FONT_FIRST] = { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },
+    ['7' - FONT_FIRST] = { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },
+    ['8' - FONT_FIRST] = { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },
+    ['9' - FONT_FIRST] = { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },
+    [':' - FONT_FIRST] = { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },
+    ['=' - FONT_FIRST] = { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },
+    ['?' - FONT_FIRST] = { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },
+    ['A' - FONT_FIRST] = { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },
+    ['B' - FONT_FIRST] = { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },
+    ['C' - FONT_FIRST] = { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },
+    ['D' - FONT_FIRST] = { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },
+    ['E' - FONT_FIRST] = { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },
+    ['F' - FONT_FIRST] = { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },
+    ['G' - FONT_FIRST] = { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },
+    ['H' - FONT_FIRST] = { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },
+    ['I' - FONT_FIRST] = { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },
+    ['J' - FONT_FIRST] = { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },
+    ['K' - FONT_FIRST] = { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },
+    ['L' - FONT_FIRST] = { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },
+    ['M' - FONT_FIRST] = { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },
+    ['N' - FONT_FIRST] = { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },
+    ['O' - FONT_FIRST] = { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },
+    ['P' - FONT_FIRST] = { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },
+    ['Q' - FONT_FIRST] = { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },
+    ['R' - FONT_FIRST] = { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },
+    ['S' - FONT_FIRST] = { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },
+    ['T' - FONT_FIRST] = { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },
+    ['U' - FONT_FIRST] = { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },
+    ['V' - FONT_FIRST] = { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },
+    ['W' - FONT_FIRST] = { 0x11, 0x11, 0x11, 0x15, 0x15, 0x1B, 0x11 },
+    ['X' - FONT_FIRST] = { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },
+    ['Y' - FONT_FIRST] = { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 },
+    ['Z' - FONT_FIRST] = { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },
+    ['_' - FONT_FIRST] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F },
 };
-#define NUM_COLORS (sizeof(class_colors) / sizeof(class_colors[0]))
-
-/* Simple 5x7 font for labels */
-/* Each character is a 5-wide, 7-tall bitmap */
-static const uint8_t font_5x7[][7] = {
-    /* Space (32) */
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
-    /* 0-9 (48-57) */
-    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, /* 0 */
-    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, /* 1 */
-    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, /* 2 */
-    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, /* 3 */
-    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, /* 4 */
-    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, /* 5 */
-    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, /* 6 */
-    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, /* 7 */
-    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, /* 8 */
-    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, /* 9 */
-    /* A-Z (65-90) */
-    {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, /* A */
-    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, /* B */
-    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, /* C */
-    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, /* D */
-    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, /* E */
-    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, /* F */
-    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, /* G */
-    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, /* H */
-    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, /* I */
-    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, /* J */
-    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, /* K */
-    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, /* L */
-    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, /* M */
-    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, /* N */
-    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, /* O */
-    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, /* P */
-    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, /* Q */
-    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, /* R */
-    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, /* S */
-    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, /* T */
-    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, /* U */
-    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, /* V */
-    {0x11, 0x11, 0x11, 0x15, 0x15, 0x1B, 0x11}, /* W */
-    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, /* X */
-    {0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04}, /* Y */
-    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, /* Z */
+
+/* Glyph atlas: each glyph as rectangles in font units */
+typedef struct {
+    uint8_t x, y, w, h;
+} glyph_rect_t;
+
+typedef struct {
+    glyph_rect_t rects[FONT_H * 3];     /* At most 3 runs per row */
+    int count;
+} glyph_t;
+
+static glyph_t g_atlas[FONT_GLYPHS];
+static pthread_once_t g_atlas_once = PTHREAD_ONCE_INIT;
+
+static void atlas_build(void) {
+    for (int g = 0; g < FONT_GLYPHS; g++) {
+        glyph_t* glyph = &g_atlas[g];
+        for (int row = 0; row < FONT_H; row++) {
+            uint8_t bits = font_5x7[g][row];
+            int col = 0;
+            while (col < FONT_W) {
+                if (!(bits & (0x10 >> col))) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < FONT_W && (bits & (0x10 >> col))) col++;
+
+                /* Extend the same run from the row above, else start a rectangle */
+                int merged = 0;
+                for (int i = 0; i < glyph->count; i++) {
+                    glyph_rect_t* r = &glyph->rects[i];
+                    if (r->x == start && r->w == col - start && r->y + r->h == row) {
+                        r->h++;
+                        merged = 1;
+                        break;
+                    }
+                }
+                if (!merged) {
+                    glyph_rect_t r = { (uint8_t)start, (uint8_t)row, (uint8_t)(col - start), 1 };
+                    glyph->rects[glyph->count++] = r;
+                }
+            }
+        }
+    }
+}
+
+static const glyph_t* glyph_for(char c) {
+    int i = (unsigned char)c;
+    if (i >= 'a' && i <= 'z') i += 'A' - 'a';
+    if (i < FONT_FIRST || i >= FONT_FIRST + FONT_GLYPHS) i = ' ';
+    return &g_atlas[i - FONT_FIRST];
+}
+
+/* Class colours (RGB); class 0 keeps the green the stream always used */
+static const uint32_t class_colors[] = {
+    0x00FF00,   /* Green */
+    0xFF3838,   /* Red */
+    0x3B82F6,   /* Blue */
+    0xFFB21D,   /* Amber */
+    0xCF00FF,   /* Magenta */
+    0x00D4BB,   /* Teal */
+    0xFF9D97,   /* Pink */
+    0x48F90A,   /* Lime */
+    0x3DDBFF,   /* Cyan */
+    0xFF701F,   /* Orange */
 };
+#define NUM_COLORS ((int)(sizeof(class_colors) / sizeof(class_colors[0])))
 
-/**
- * Get font bitmap for a character.
- */
-static const uint8_t* get_char_bitmap(char c) {
-    if (c == ' ') return font_5x7[0];
-    if (c >= '0' && c <= '9') return font_5x7[1 + (c - '0')];
-    if (c >= 'A' && c <= 'Z') return font_5x7[11 + (c - 'A')];
-    if (c >= 'a' && c <= 'z') return font_5x7[11 + (c - 'a')];  /* Use uppercase */
-    return font_5x7[0];  /* Default to space */
+uint32_t annotate_class_color(int class_id) {
+    if (class_id < 0) class_id = -class_id;
+    return class_colors[class_id % NUM_COLORS];
 }
 
-/**
- * Draw a pixel on RGB image.
- */
-static void draw_pixel(uint8_t* img, int w, int h, int x, int y,
-                        uint8_t r, uint8_t g, uint8_t b) {
-    if (x < 0 || x >= w || y < 0 || y >= h) return;
-    int idx = (y * w + x) * 3;
-    img[idx + 0] = r;
-    img[idx + 1] = g;
-    img[idx + 2] = b;
+/* === Rasterizer === */
+
+typedef struct {
+    uint8_t* img;
+    int w, h;
+    int bgr;
+} canvas_t;
+
+typedef struct {
+    uint8_t c[3];       /* In the canvas's channel order */
+} pixel_t;
+
+static pixel_t canvas_pixel(const canvas_t* cv, uint32_t rgb) {
+    pixel_t px;
+    uint8_t r = (uint8_t)(rgb >> 16), g = (uint8_t)(rgb >> 8), b = (uint8_t)rgb;
+    px.c[0] = cv->bgr ? b : r;
+    px.c[1] = g;
+    px.c[2] = cv->bgr ? r : b;
+    return px;
 }
 
-/**
- * Draw a horizontal line.
- */
-static void draw_hline(uint8_t* img, int w, int h, int x1, int x2, int y,
-                        int thickness, uint8_t r, uint8_t g, uint8_t b) {
-    if (x1 > x2) { int t = x1; x1 = x2; x2 = t; }
-    for (int dy = -thickness/2; dy <= thickness/2; dy++) {
-        for (int x = x1; x <= x2; x++) {
-            draw_pixel(img, w, h, x, y + dy, r, g, b);
-        }
+/* Fill n pixels from p: one pixel, then doubling copies */
+static void fill_span(uint8_t* p, int n, pixel_t px) {
+    size_t total = (size_t)n * 3;
+    size_t done = 3;
+    memcpy(p, px.c, 3);
+    while (done < total) {
+        size_t chunk = done < total - done ? done : total - done;
+        memcpy(p + done, p, chunk);
+        done += chunk;
     }
 }
 
-/**
- * Draw a vertical line.
- */
-static void draw_vline(uint8_t* img, int w, int h, int x, int y1, int y2,
-                        int thickness, uint8_t r, uint8_t g, uint8_t b) {
-    if (y1 > y2) { int t = y1; y1 = y2; y2 = t; }
-    for (int dx = -thickness/2; dx <= thickness/2; dx++) {
-        for (int y = y1; y <= y2; y++) {
-            draw_pixel(img, w, h, x + dx, y, r, g, b);
-        }
+/* Fill [x0, x1) x [y0, y1), clipped to the canvas */
+static void fill_rect(const canvas_t* cv, int x0, int y0, int x1, int y1, pixel_t px) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > cv->w) x1 = cv->w;
+    if (y1 > cv->h) y1 = cv->h;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    size_t stride = (size_t)cv->w * 3;
+    uint8_t* first = cv->img + (size_t)y0 * stride + (size_t)x0 * 3;
+    fill_span(first, x1 - x0, px);
+    size_t bytes = (size_t)(x1 - x0) * 3;
+    for (int y = y0 + 1; y < y1; y++) {
+        memcpy(first + (size_t)(y - y0) * stride, first, bytes);
     }
 }
 
-/**
- * Draw a rectangle.
- */
-static void draw_rect(uint8_t* img, int w, int h,
-                       int x, int y, int rect_w, int rect_h,
-                       int thickness, uint8_t r, uint8_t g, uint8_t b) {
-    draw_hline(img, w, h, x, x + rect_w, y, thickness, r, g, b);
-    draw_hline(img, w, h, x, x + rect_w, y + rect_h, thickness, r, g, b);
-    draw_vline(img, w, h, x, y, y + rect_h, thickness, r, g, b);
-    draw_vline(img, w, h, x + rect_w, y, y + rect_h, thickness, r, g, b);
+/* Box outline of width t, inside [x0, x1) x [y0, y1) */
+static void draw_box(const canvas_t* cv, int x0, int y0, int x1, int y1, int t, pixel_t px) {
+    if (x1 - x0 <= 2 * t || y1 - y0 <= 2 * t) {
+        fill_rect(cv, x0, y0, x1, y1, px);
+        return;
+    }
+    fill_rect(cv, x0, y0, x1, y0 + t, px);
+    fill_rect(cv, x0, y1 - t, x1, y1, px);
+    fill_rect(cv, x0, y0 + t, x0 + t, y1 - t, px);
+    fill_rect(cv, x1 - t, y0 + t, x1, y1 - t, px);
 }
 
-/**
- * Draw a filled rectangle (for label background).
- */
-static void draw_filled_rect(uint8_t* img, int w, int h,
-                              int x, int y, int rect_w, int rect_h,
-                              uint8_t r, uint8_t g, uint8_t b) {
-    for (int dy = 0; dy < rect_h; dy++) {
-        for (int dx = 0; dx < rect_w; dx++) {
-            draw_pixel(img, w, h, x + dx, y + dy, r, g, b);
+static void draw_text(const canvas_t* cv, int x, int y, const char* text, int scale, pixel_t px) {
+    if (y >= cv->h || y + FONT_H * scale <= 0) return;
+    for (; *text && x < cv->w; text++, x += FONT_ADVANCE * scale) {
+        if (x + FONT_W * scale <= 0) continue;
+        const glyph_t* glyph = glyph_for(*text);
+        for (int i = 0; i < glyph->count; i++) {
+            const glyph_rect_t* r = &glyph->rects[i];
+            fill_rect(cv, x + r->x * scale, y + r->y * scale,
+                      x + (r->x + r->w) * scale, y + (r->y + r->h) * scale, px);
         }
     }
 }
 
-/**
- * Draw a character at position.
- */
-static void draw_char(uint8_t* img, int w, int h,
-                       int x, int y, char c, int scale,
-                       uint8_t r, uint8_t g, uint8_t b) {
-    const uint8_t* bitmap = get_char_bitmap(c);
-
-    for (int row = 0; row < 7; row++) {
-        for (int col = 0; col < 5; col++) {
-            if (bitmap[row] & (1 << (4 - col))) {
-                for (int sy = 0; sy < scale; sy++) {
-                    for (int sx = 0; sx < scale; sx++) {
-                        draw_pixel(img, w, h,
-                                   x + col * scale + sx,
-                                   y + row * scale + sy,
-                                   r, g, b);
-                    }
-                }
-            }
-        }
+/* Text on a filled background, pad pixels around it */
+static void draw_label(const canvas_t* cv, int x, int y, const char* text, int scale,
+                       int pad, pixel_t bg, pixel_t fg) {
+    int tw = annotate_text_width(text, scale) - scale;   /* No gap after the last glyph */
+    fill_rect(cv, x, y, x + tw + 2 * pad, y + FONT_H * scale + 2 * pad, bg);
+    draw_text(cv, x + pad, y + pad, text, scale, fg);
+}
+
+int annotate_text_width(const char* text, int scale) {
+    return (int)strlen(text) * FONT_ADVANCE * scale;
+}
+
+/* Font scale and default line width for a frame height */
+static int style_scale(int h) {
+    return h >= 720 ? h / 360 : 1;
+}
+
+static int style_thickness(int h) {
+    return h >= 480 ? h / 240 : 2;
+}
+
+/* === Annotations === */
+
+void annotate_draw(uint8_t* img, int w, int h, int bgr,
+                   const annotation_t* boxes, int count, int thickness) {
+    if (!img || w <= 0 || h <= 0 || !boxes) return;
+    pthread_once(&g_atlas_once, atlas_build);
+
+    canvas_t cv = { img, w, h, bgr };
+    int scale = style_scale(h);
+    int pad = scale + 1;
+    int t = thickness > 0 ? thickness : style_thickness(h);
+
+    for (int i = 0; i < count; i++) {
+        const annotation_t* a = &boxes[i];
+        uint32_t rgb = annotate_class_color(a->class_id);
+        pixel_t px = canvas_pixel(&cv, rgb);
+
+        draw_box(&cv, a->x, a->y, a->x + a->w, a->y + a->h, t, px);
+        if (a->text[0] == '\0') continue;
+
+        /* Label above the box, or inside its top edge at the top of the frame;
+         * kept inside the frame horizontally */
+        int lw = annotate_text_width(a->text, scale) - scale + 2 * pad;
+        int lh = FONT_H * scale + 2 * pad;
+        int lx = a->x;
+        if (lx + lw > w) lx = w - lw;
+        if (lx < 0) lx = 0;
+        int ly = a->y - lh;
+        if (ly < 0) ly = a->y < 0 ? 0 : a->y;
+
+        /* Dark text on light colours */
+        int luma = (299 * ((rgb >> 16) & 0xFF) + 587 * ((rgb >> 8) & 0xFF) + 114 * (rgb & 0xFF)) / 1000;
+        pixel_t fg = canvas_pixel(&cv, luma > 140 ? 0x000000 : 0xFFFFFF);
+        draw_label(&cv, lx, ly, a->text, scale, pad, px, fg);
     }
 }
 
-/**
- * Draw text string.
- */
-static void draw_text(uint8_t* img, int w, int h,
-                       int x, int y, const char* text, int scale,
-                       uint8_t r, uint8_t g, uint8_t b) {
-    int char_w = 6 * scale;  /* 5 pixels + 1 space */
-
-    while (*text) {
-        draw_char(img, w, h, x, y, *text, scale, r, g, b);
-        x += char_w;
-        text++;
+int annotate_collect(cira_ctx* ctx, cira_camera_t* cam, int w, int h, annotation_t* out) {
+    if (!ctx || !out) return 0;
+
+    pthread_mutex_lock(&ctx->result_mutex);
+
+    /* A camera's own results (counted in inferred frames), else the context's */
+    cira_detection_t* cur = cam ? cam->detections : ctx->result_detections;
+    cira_detection_t* prev = cam ? cam->prev_detections : ctx->prev_detections;
+    int* prev_num = cam ? &cam->prev_num_detections : &ctx->prev_num_detections;
+    uint64_t* prev_frame = cam ? &cam->prev_detection_frame : &ctx->prev_detection_frame;
+    uint64_t frame = cam ? cam->total_frames : ctx->frame_sequence;
+
+    /* Use current detections, or fall back to previous if current is empty */
+    cira_detection_t* dets = cur;
+    int num_dets = cam ? cam->num_detections : ctx->result_num_detections;
+
+    if (num_dets > 0) {
+        /* Save current detections for persistence */
+        memcpy(prev, cur, num_dets * sizeof(cira_detection_t));
+        *prev_num = num_dets;
+        *prev_frame = frame;
+    } else if (*prev_num > 0 && (frame - *prev_frame) <= 3) {
+        /* Use previous detections if within 3 frames */
+        dets = prev;
+        num_dets = *prev_num;
+    }
+
+    for (int i = 0; i < num_dets; i++) {
+        const cira_detection_t* det = &dets[i];
+        annotation_t* a = &out[i];
+
+        /* Convert normalized coords to pixel coords */
+        a->x = (int)(det->x * w);
+        a->y = (int)(det->y * h);
+        a->w = (int)(det->w * w);
+        a->h = (int)(det->h * h);
+        a->class_id = det->label_id;
+        snprintf(a->text, sizeof(a->text), "%s %.0f%%",
+                 cira_get_label(ctx, det->label_id), det->confidence * 100);
     }
+
+    pthread_mutex_unlock(&ctx->result_mutex);
+    return num_dets;
+}
+
+void annotate_frame(cira_ctx* ctx, cira_camera_t* cam, uint8_t* img, int w, int h, int bgr) {
+    annotation_t boxes[CIRA_MAX_DETECTIONS];
+    int count = annotate_collect(ctx, cam, w, h, boxes);
+    annotate_draw(img, w, h, bgr, boxes, count, 0);
 }
 
+/* === Overlays === */
+
 /**
- * Annotate an image with detection results.
+ * Annotate an RGB image with the context's detection results.
  *
  * @param img RGB image data (will be modified)
  * @param w Image width
  * @param h Image height
  * @param ctx Context with detection results
- * @param thickness Line thickness (default 2)
+ * @param thickness Line thickness, 0 to scale with the image
  * @param show_label Whether to show labels
  * @param show_confidence Whether to show confidence scores
  */
 void annotate_detections(uint8_t* img, int w, int h, cira_ctx* ctx,
-                          int thickness, int show_label, int show_confidence) {
+                         int thickness, int show_label, int show_confidence) {
     if (!img || !ctx) return;
 
-    int count = cira_result_count(ctx);
-
+    annotation_t boxes[CIRA_MAX_DETECTIONS];
+    pthread_mutex_lock(&ctx->result_mutex);
+    int count = ctx->result_num_detections;
     for (int i = 0; i < count; i++) {
-        float bx, by, bw, bh;
-        if (cira_result_bbox(ctx, i, &bx, &by, &bw, &bh) != CIRA_OK) continue;
-
-        float score = cira_result_score(ctx, i);
-        const char* label = cira_result_label(ctx, i);
-
-        /* Convert normalized coords to pixels */
-        int px = (int)(bx * w);
-        int py = (int)(by * h);
-        int pw = (int)(bw * w);
-        int ph = (int)(bh * h);
-
-        /* Get color for this detection */
-        int color_idx = i % NUM_COLORS;
-        uint8_t r = class_colors[color_idx][2];  /* Convert BGR to RGB */
-        uint8_t g = class_colors[color_idx][1];
-        uint8_t b = class_colors[color_idx][0];
-
-        /* Draw bounding box */
-        draw_rect(img, w, h, px, py, pw, ph, thickness, r, g, b);
-
-        /* Draw label */
-        if (show_label || show_confidence) {
-            char label_text[64];
-            if (show_label && show_confidence) {
-                snprintf(label_text, sizeof(label_text), "%s %.0f%%",
-                         label ? label : "?", score * 100);
-            } else if (show_label) {
-                snprintf(label_text, sizeof(label_text), "%s",
-                         label ? label : "?");
-            } else {
-                snprintf(label_text, sizeof(label_text), "%.0f%%", score * 100);
-            }
-
-            int text_len = strlen(label_text);
-            int text_w = text_len * 6 + 4;  /* 5 pixels per char + padding */
-            int text_h = 10;
-
-            /* Draw label background */
-            int label_y = py - text_h - 2;
-            if (label_y < 0) label_y = py + ph + 2;
-
-            draw_filled_rect(img, w, h, px, label_y, text_w, text_h, r, g, b);
-
-            /* Draw label text in white */
-            draw_text(img, w, h, px + 2, label_y + 1, label_text, 1,
-                      255, 255, 255);
+        const cira_detection_t* det = &ctx->result_detections[i];
+        annotation_t* a = &boxes[i];
+        a->x = (int)(det->x * w);
+        a->y = (int)(det->y * h);
+        a->w = (int)(det->w * w);
+        a->h = (int)(det->h * h);
+        a->class_id = det->label_id;
+
+        const char* label = cira_get_label(ctx, det->label_id);
+        if (show_label && show_confidence) {
+            snprintf(a->text, sizeof(a->text), "%s %.0f%%", label, det->confidence * 100);
+        } else if (show_label) {
+            snprintf(a->text, sizeof(a->text), "%s", label);
+        } else if (show_confidence) {
+            snprintf(a->text, sizeof(a->text), "%.0f%%", det->confidence * 100);
+        } else {
+            a->text[0] = '\0';
         }
     }
+    pthread_mutex_unlock(&ctx->result_mutex);
+
+    annotate_draw(img, w, h, 0, boxes, count, thickness);
 }
 
 /**
- * Draw FPS counter on image.
+ * Draw FPS counter on an RGB image (top-left).
  */
 void annotate_fps(uint8_t* img, int w, int h, float fps) {
+    if (!img || w <= 0 || h <= 0) return;
+    pthread_once(&g_atlas_once, atlas_build);
+
     char text[32];
     snprintf(text, sizeof(text), "FPS: %.1f", fps);
 
-    /* Draw background */
-    draw_filled_rect(img, w, h, 5, 5, 60, 12, 0, 0, 0);
-
-    /* Draw text */
-    draw_text(img, w, h, 8, 7, text, 1, 0, 255, 0);
+    canvas_t cv = { img, w, h, 0 };
+    int scale = style_scale(h);
+    draw_label(&cv, 5, 5, text, scale, scale + 1,
+               canvas_pixel(&cv, 0x000000), canvas_pixel(&cv, 0x00FF00));
 }
 
 /**
- * Draw timestamp on image.
+ * Draw timestamp on an RGB image (bottom-right).
  */
 void annotate_timestamp(uint8_t* img, int w, int h, const char* timestamp) {
-    if (!timestamp) return;
-
-    int text_len = strlen(timestamp);
-    int text_w = text_len * 6 + 4;
-
-    /* Draw at bottom-right */
-    int x = w - text_w - 5;
-    int y = h - 15;
-
-    /* Draw background */
-    draw_filled_rect(img, w, h, x, y, text_w, 12, 0, 0, 0);
-
-    /* Draw text */
-    draw_text(img, w, h, x + 2, y + 2, timestamp, 1, 255, 255, 255);
+    if (!img || !timestamp || w <= 0 || h <= 0) return;
+    pthread_once(&g_atlas_once, atlas_build);
+
+    canvas_t cv = { img, w, h, 0 };
+    int scale = style_scale(h);
+    int pad = scale + 1;
+    int lw = annotate_text_width(timestamp, scale) - scale + 2 * pad;
+    int lh = FONT_H * scale + 2 * pad;
+    draw_label(&cv, w - lw - 5, h - lh - 5, timestamp, scale, pad,
+               canvas_pixel(&cv, 0x000000), canvas_pixel(&cv, 0xFFFFFF));
 }
-
-#else /* CIRA_STREAMING_ENABLED */
-
-void annotate_detections(uint8_t* img, int w, int h, cira_ctx* ctx,
-                          int thickness, int show_label, int show_confidence) {
-    (void)img; (void)w; (void)h; (void)ctx;
-    (void)thickness; (void)show_label; (void)show_confidence;
-}
-
-void annotate_fps(uint8_t* img, int w, int h, float fps) {
-    (void)img; (void)w; (void)h; (void)fps;
-}
-
-void annotate_timestamp(uint8_t* img, int w, int h, const char* timestamp) {
-    (void)img; (void)w; (void)h; (void)timestamp;
-}
-
-#endif /* CIRA_STREAMING_ENABLED */
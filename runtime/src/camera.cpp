@@ -1,17 +1,65 @@
 /**
- * CiRA Runtime - Camera Capture (OpenCV)
+ * CiRA Runtime - Camera Capture
  *
- * Cross-platform video capture using OpenCV VideoCapture.
- * Works on Windows (DirectShow), Linux (V4L2), and macOS (AVFoundation).
+ * Device cameras on Linux are captured natively through V4L2 with mmap'd
+ * driver buffers (capture_v4l2.h): the capture stage hands the driver
+ * buffer itself down the pipeline and the preprocess stage converts it
+ * straight into the frame store slot, so a YUYV frame is touched once
+ * before inference. Elsewhere, and for cameras V4L2 cannot drive, OpenCV
+ * VideoCapture is used (DirectShow on Windows, AVFoundation on macOS).
+ *
+ * Network streams (RTSP/HTTP) and Jetson CSI cameras run as GStreamer
+ * pipelines through OpenCV, decoding with the hardware decoder GStreamer
+ * picks (nvv4l2decoder on Jetson, whose NVMM output nvvidconv converts),
+ * and fall back to OpenCV's own URL capture.
+ *
+ * Each camera's frames flow through a four-stage pipeline:
+ *
+ *   capture -> preprocess -> inference -> publish
+ *
+ * Stages are connected by bounded SPSC queues (frame_queue.h). When a
+ * queue is full the oldest frame is dropped by default, so capture keeps
+ * running at sensor rate while inference runs as fast as the backend allows.
+ * Every frame takes every stage in order: each queue has exactly one
+ * producer thread, and publish sees a camera's frames in capture order.
+ *
+ * Capture, preprocess and publish run on threads of their own per camera.
+ * The inference stage is one scheduler thread shared by every camera of
+ * the context: it takes the next frame of each camera in turn and runs
+ * them through the one loaded model, as a single batch call for frames of
+ * the same size (camera.schedule "batch") or one predict per frame
+ * ("round_robin"). Results, streams and stats stay per camera.
+ *
+ * With gate.motion_threshold set, the preprocess stage scores each frame
+ * against the last one sent to inference on a small luma thumbnail and
+ * marks still frames no-infer. The scheduler passes those on to publish
+ * untouched, so the camera keeps streaming with its last detections and
+ * inference time goes to cameras with something to look at.
+ * gate.max_skip_ms bounds how long a result may stand. camera.N.roi
+ * limits inference (and the motion score) to regions of the frame, each
+ * cropped out and inferred on its own.
+ *
+ * With the tracker on, every result goes through a per-camera tracker
+ * (tracker.h) and carries track IDs. tracker.detect_interval N runs the
+ * detector on every Nth frame only; the frames in between pass inference
+ * as no-infer frames and take the tracks' predicted boxes in the publish
+ * stage, so results, annotations and result events keep the camera rate
+ * at 1/N of the inference load.
  *
  * (c) CiRA Robotics / KMITL 2026
  */
 
 #include "cira.h"
 #include "cira_internal.h"
+#include "frame_queue.h"
+#include "jpeg_cache.h"
+#include "jpeg_encoder.h"
+#include "capture_v4l2.h"
+#include "tracker.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
 #include <pthread.h>
 
 #ifdef _WIN32
@@ -25,38 +73,132 @@
 #ifdef CIRA_STREAMING_ENABLED
 #ifdef CIRA_OPENCV_ENABLED
 
+#include <algorithm>
 #include <opencv2/core.hpp>
 #include <opencv2/videoio.hpp>
 #include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+/* Stage wait timeout (lets threads notice camera_stop) */
+#define STAGE_WAIT_MS 100
+
+/* Minimum interval between frame file writes (~10 FPS) */
+#define FRAME_FILE_INTERVAL_MS 100.0
+
+/* Pipeline stage indices */
+enum {
+    STAGE_CAPTURE = 0,
+    STAGE_PREPROCESS,
+    STAGE_INFERENCE,
+    STAGE_PUBLISH
+};
 
-/* Default capture settings */
-#define DEFAULT_WIDTH 1280
-#define DEFAULT_HEIGHT 720
+static const char* g_stage_names[CIRA_PIPELINE_STAGES] = {
+    "capture", "preprocess", "inference", "publish"
+};
+
+/* A frame travelling through the pipeline. Mats are reused across frames
+ * so steady-state capture does not allocate. */
+struct pipeline_frame_t {
+    cv::Mat bgr;            /* Captured (OpenCV) or decoded (MJPEG) frame */
+    cv::Mat rgb;            /* Converted frame: view of `slot` or of rgb_buf */
+    cv::Mat rgb_buf;        /* Fallback when the frame store has no free slot */
+    frame_slot_t* slot;     /* Frame store reference held by this frame */
+    capture_buffer_t raw;   /* V4L2 driver buffer, valid while raw_held */
+    int raw_held;
+    uint64_t seq;           /* Capture sequence number */
+    double capture_ms;      /* When capture returned it */
+    double glass_ms;        /* When the sensor delivered it (driver timestamp, else capture_ms) */
+    int no_infer;           /* Passes the inference stage untouched (gate hold, track_only) */
+    int track_only;         /* Skips the detector; the tracker predicts its result */
+};
+
+struct camera_scheduler_t;
+
+/* Per-stage FPS / busy-time meter */
+struct stage_meter_t {
+    cira_stage_stats_t* stats;
+    latency_hist_t* latency;    /* Busy time histogram (capture records its own) */
+    frame_queue_t* input;
+    double window_start;
+    double window_busy;
+    int window_frames;
+};
 
-/* Internal camera state */
-struct camera_state_t {
-    cv::VideoCapture* cap;
+/* Camera pipeline state (hung off cam->pipeline) */
+struct camera_pipeline_t {
+    cira_ctx* ctx;
+    cira_camera_t* cam;
+    camera_scheduler_t* sched;
+    cv::VideoCapture* cap;  /* OpenCV or GStreamer capture, or NULL */
+    capture_v4l2_t* v4l2;   /* Native V4L2 capture, or NULL */
     int device_id;
     int width;
     int height;
+
+    /* Frame pool */
+    pipeline_frame_t* frames;
+    int num_frames;
+    pipeline_frame_t** free_list;
+    int free_count;
+    pthread_mutex_t pool_mutex;
+
+    /* queues[i] is the input queue of stage i (queues[STAGE_CAPTURE] unused) */
+    frame_queue_t* queues[CIRA_PIPELINE_STAGES];
+    pthread_t threads[CIRA_PIPELINE_STAGES];
+    int num_threads;
+
+    /* Inference stage meter (used by the scheduler thread) */
+    stage_meter_t infer_meter;
+
+    /* Motion gate (preprocess stage) */
+    uint8_t gate_ref[CIRA_GATE_THUMB_W * CIRA_GATE_THUMB_H];   /* Last frame inferred */
+    uint8_t gate_mask[CIRA_GATE_THUMB_W * CIRA_GATE_THUMB_H];  /* Cells inside the regions */
+    int gate_cells;
+    int gate_have_ref;
+    double gate_last_pass;
+    int infer_evicted;      /* A frame due for inference was dropped at the inference queue */
+
+    /* Inference regions, copied from the camera at start */
+    cira_roi_t rois[CIRA_MAX_ROIS];
+    int num_rois;
+
+    /* Tracker (guarded by result_mutex), NULL if off */
+    tracker_t* tracker;
+    int detect_interval;
+    int detect_phase;       /* Frames passed to the detector or tracker since its last run */
+
+    /* Encoded video settings, copied from the context at start */
+    video_config_t video_config;
 };
 
-/* Forward declarations for predict functions (extern "C" linkage) */
-#ifdef CIRA_DARKNET_ENABLED
-extern "C" int darknet_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
-#endif
-#ifdef CIRA_NCNN_ENABLED
-extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
-#endif
-#ifdef CIRA_ONNX_ENABLED
-extern "C" int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
-#endif
-#ifdef CIRA_TRT_ENABLED
-extern "C" int trt_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
-#endif
+/* Shared inference stage (hung off ctx->camera_scheduler) */
+struct camera_scheduler_t {
+    cira_ctx* ctx;
+    pthread_t thread;
+    volatile int running;
 
-/* Forward declaration for frame file writing */
-extern "C" int cira_write_frame_file(cira_ctx* ctx, int annotated);
+    /* Preprocess stages signal here after queueing a frame */
+    pthread_mutex_t wake_mutex;
+    pthread_cond_t wake_cond;
+    int pending;
+
+    /* Cameras serviced, indexed by camera number. Held for a whole sweep,
+     * so camera_stop() cannot pull a pipeline out from under inference. */
+    pthread_mutex_t members_mutex;
+    camera_pipeline_t* members[CIRA_MAX_CAMERAS];
+    int next;               /* Camera that goes first in the next sweep */
+    int err_count;
+    cv::Mat crop;           /* Region being inferred (infer_rois) */
+};
+
+/* Forward declarations for frame file writing */
+extern "C" int cira_write_frame_file_slot(cira_ctx* ctx, cira_camera_t* cam, frame_slot_t* slot,
+                                          int annotated);
+extern "C" int cira_write_frame_file_rgb(cira_ctx* ctx, cira_camera_t* cam, const uint8_t* data,
+                                         int w, int h, int annotated);
+extern "C" int cira_publish_frame_ring(cira_ctx* ctx, cira_camera_t* cam, frame_slot_t* slot,
+                                       const uint8_t* rgb, int w, int h);
 
 /* Timing helper */
 static double get_time_ms(void) {
@@ -72,247 +214,1206 @@ static double get_time_ms(void) {
 #endif
 }
 
-/* Store VideoCapture pointer - using a simple global for now */
-/* TODO: Better approach would be to extend cira_ctx with a void* camera_handle */
-static cv::VideoCapture* g_capture = NULL;
-static camera_state_t g_cam_state = {NULL, 0, 0, 0};
+/* When the sensor delivered a frame: the V4L2 driver timestamp (same
+ * monotonic clock) if it is plausible, else when capture returned it */
+static double frame_glass_ms(const pipeline_frame_t* f) {
+    if (f->raw_held && f->raw.timestamp_us > 0) {
+        double t = f->raw.timestamp_us / 1000.0;
+        if (t <= f->capture_ms && f->capture_ms - t < 10000.0) return t;
+    }
+    return f->capture_ms;
+}
+
+/* === Frame pool === */
 
-/**
- * Camera capture thread (actual implementation).
- */
-static void* camera_thread_func_impl(void* arg) {
-    cira_ctx* ctx = static_cast<cira_ctx*>(arg);
+static pipeline_frame_t* pool_acquire(camera_pipeline_t* pl) {
+    pipeline_frame_t* f = NULL;
+    pthread_mutex_lock(&pl->pool_mutex);
+    if (pl->free_count > 0) {
+        f = pl->free_list[--pl->free_count];
+    }
+    pthread_mutex_unlock(&pl->pool_mutex);
+    return f;
+}
 
-    if (!g_capture || !g_capture->isOpened()) {
-        fprintf(stderr, "Camera not opened in thread\n");
-        return NULL;
+/* Hand a V4L2 buffer back to the driver once the frame no longer needs it */
+static void raw_release(camera_pipeline_t* pl, pipeline_frame_t* f) {
+    if (f->raw_held) {
+        capture_v4l2_release(pl->v4l2, f->raw.index);
+        f->raw_held = 0;
+    }
+}
+
+static void pool_release(camera_pipeline_t* pl, pipeline_frame_t* f) {
+    if (!f) return;
+
+    /* Frames dropped before preprocess still hold a driver buffer */
+    raw_release(pl, f);
+
+    /* Drop the view before the slot can be recycled by the frame store */
+    f->rgb = cv::Mat();
+    if (f->slot) {
+        frame_store_release(f->slot);
+        f->slot = NULL;
     }
 
-    cv::Mat frame, rgb;
-    double last_time = get_time_ms();
-    int frame_count = 0;
+    pthread_mutex_lock(&pl->pool_mutex);
+    pl->free_list[pl->free_count++] = f;
+    pthread_mutex_unlock(&pl->pool_mutex);
+}
+
+/* Push to the next stage, recycling whatever the queue dropped */
+static void stage_forward(camera_pipeline_t* pl, int next_stage, pipeline_frame_t* f) {
+    void* dropped = NULL;
+    frame_queue_push(pl->queues[next_stage], f, &dropped);
+    if (dropped) {
+        pool_release(pl, static_cast<pipeline_frame_t*>(dropped));
+    }
+}
+
+/* === Stage statistics === */
+
+static void meter_init(stage_meter_t* m, camera_pipeline_t* pl, int stage) {
+    m->stats = &pl->cam->stage_stats[stage];
+    m->latency = stage == STAGE_CAPTURE ? NULL : pl->cam->latency[stage];
+    m->input = pl->queues[stage];
+    m->window_start = get_time_ms();
+    m->window_busy = 0.0;
+    m->window_frames = 0;
+
+    memset(m->stats, 0, sizeof(*m->stats));
+    m->stats->name = g_stage_names[stage];
+    m->stats->queue_capacity = m->input ? frame_queue_capacity(m->input) : 0;
+}
+
+/* Record one processed frame; returns 1 when the 1s window rolled over */
+static int meter_tick(stage_meter_t* m, double busy_ms) {
+    m->stats->frames++;
+    m->window_frames++;
+    m->window_busy += busy_ms;
+    latency_hist_record(m->latency, busy_ms);
+
+    if (m->input) {
+        m->stats->queue_depth = frame_queue_depth(m->input);
+        m->stats->dropped = frame_queue_dropped(m->input);
+    }
+
+    double now = get_time_ms();
+    double elapsed = now - m->window_start;
+    if (elapsed < 1000.0) return 0;
+
+    m->stats->fps = (float)(m->window_frames * 1000.0 / elapsed);
+    m->stats->busy_ms = (float)(m->window_busy / m->window_frames);
+    m->window_start = now;
+    m->window_busy = 0.0;
+    m->window_frames = 0;
+    return 1;
+}
+
+/* Decay FPS to zero when a stage is starved */
+static void meter_idle(stage_meter_t* m) {
+    if (m->input) {
+        m->stats->queue_depth = frame_queue_depth(m->input);
+    }
+    if (get_time_ms() - m->window_start >= 1000.0 && m->window_frames == 0) {
+        m->stats->fps = 0.0f;
+        m->window_start = get_time_ms();
+    }
+}
+
+/* === Pipeline stages === */
+
+/**
+ * Capture stage: read frames at sensor rate into pooled buffers.
+ */
+static void* capture_stage(void* arg) {
+    camera_pipeline_t* pl = static_cast<camera_pipeline_t*>(arg);
+    cira_camera_t* cam = pl->cam;
+    cira_pin_thread(pl->ctx, CPU_CLASS_CAPTURE);
+    stage_meter_t meter;
+    meter_init(&meter, pl, STAGE_CAPTURE);
+    uint64_t seq = 0;
 
-    fprintf(stderr, "Camera capture thread started (device %d, %dx%d)\n",
-            g_cam_state.device_id, g_cam_state.width, g_cam_state.height);
+    fprintf(stderr, "Camera %d capture thread started (device %d, %dx%d)\n",
+            cam->index, pl->device_id, pl->width, pl->height);
 
-    while (ctx->camera_running) {
-        /* Capture frame */
-        if (!g_capture->read(frame)) {
-            fprintf(stderr, "Failed to read frame\n");
+    while (cam->running) {
+        pipeline_frame_t* f = pool_acquire(pl);
+        if (!f) {
+            /* Every frame is in flight - downstream is saturated */
+            usleep(1000);
+            continue;
+        }
+
+        double t0 = get_time_ms();
+        if (pl->v4l2) {
+            /* The driver buffer travels to preprocess without a copy */
+            int r = capture_v4l2_next(pl->v4l2, &f->raw, STAGE_WAIT_MS);
+            if (r <= 0) {
+                if (r < 0) fprintf(stderr, "Camera %d: failed to read frame\n", cam->index);
+                pool_release(pl, f);
+                usleep(r < 0 ? 10000 : 1000);
+                continue;
+            }
+            f->raw_held = 1;
+        } else if (!pl->cap->read(f->bgr)) {
+            fprintf(stderr, "Camera %d: failed to read frame\n", cam->index);
+            pool_release(pl, f);
             usleep(10000);
             continue;
         }
 
-        if (frame.empty()) {
+        if (!f->raw_held && f->bgr.empty()) {
+            pool_release(pl, f);
             usleep(1000);
             continue;
         }
 
-        /* Convert BGR to RGB */
-        cv::cvtColor(frame, rgb, cv::COLOR_BGR2RGB);
+        f->seq = ++seq;
+        f->capture_ms = get_time_ms();
+        f->glass_ms = frame_glass_ms(f);
+        f->no_infer = 0;
+        f->track_only = 0;
+
+        /* Driver to user space for V4L2, the read call for OpenCV */
+        latency_hist_record(cam->latency[STAGE_CAPTURE],
+                            f->glass_ms < f->capture_ms ? f->capture_ms - f->glass_ms
+                                                        : f->capture_ms - t0);
+        stage_forward(pl, STAGE_PREPROCESS, f);
 
-        /* Store frame for streaming server */
-        cira_store_frame(ctx, rgb.data, rgb.cols, rgb.rows);
+        if (meter_tick(&meter, get_time_ms() - t0)) {
+            cam->current_fps = meter.stats->fps;
 
-        /* Write frame to temp file periodically for file-based transfer */
-        /* Write every 3 frames (~10 FPS at 30 FPS capture) to reduce disk I/O */
-        static int write_counter = 0;
-        if (++write_counter >= 3) {
-            write_counter = 0;
-            cira_write_frame_file(ctx, 1);  /* 1 = annotated */
+            /* Log FPS periodically */
+            fprintf(stderr, "Camera %d FPS: %.1f, Inference FPS: %.1f, Detections: %d\n",
+                    cam->index, cam->current_fps, cam->inference_fps, cam->num_detections);
         }
+    }
 
-        /* Run inference if model is loaded and not being swapped */
-        if (ctx->format != CIRA_FORMAT_UNKNOWN && ctx->model_handle != NULL && !ctx->model_swapping) {
-            /* Lock model mutex to prevent model unload during inference */
-            if (pthread_mutex_trylock(&ctx->model_mutex) == 0) {
-                /* Double-check after acquiring lock */
-                if (ctx->model_handle != NULL && !ctx->model_swapping) {
-                    /* Call predict with RGB data */
-                    int result = CIRA_ERROR;
+    fprintf(stderr, "Camera %d capture thread stopped\n", cam->index);
+    return NULL;
+}
 
-                    switch (ctx->format) {
-#ifdef CIRA_DARKNET_ENABLED
-                        case CIRA_FORMAT_DARKNET:
-                            result = darknet_predict(ctx, rgb.data, rgb.cols, rgb.rows, 3);
-                            break;
-#endif
-#ifdef CIRA_NCNN_ENABLED
-                        case CIRA_FORMAT_NCNN:
-                            result = ncnn_predict(ctx, rgb.data, rgb.cols, rgb.rows, 3);
-                            break;
-#endif
-#ifdef CIRA_ONNX_ENABLED
-                        case CIRA_FORMAT_ONNX:
-                            result = onnx_predict(ctx, rgb.data, rgb.cols, rgb.rows, 3);
-                            break;
-#endif
-#ifdef CIRA_TRT_ENABLED
-                        case CIRA_FORMAT_TENSORRT:
-                            result = trt_predict(ctx, rgb.data, rgb.cols, rgb.rows, 3);
-                            break;
-#endif
-                        default:
-                            break;
-                    }
+/* Tell the scheduler a frame is waiting */
+static void scheduler_notify(camera_scheduler_t* s) {
+    pthread_mutex_lock(&s->wake_mutex);
+    s->pending = 1;
+    pthread_cond_signal(&s->wake_cond);
+    pthread_mutex_unlock(&s->wake_mutex);
+}
 
-                    if (result == CIRA_OK) {
-                        /* Increment total frames for stats */
-                        ctx->total_frames++;
-                    } else if (result != CIRA_ERROR) {
-                        /* Log inference errors occasionally */
-                        static int err_count = 0;
-                        if (++err_count % 100 == 1) {
-                            fprintf(stderr, "Inference error: %d\n", result);
-                        }
-                    }
+/* Decode an MJPEG driver buffer into f->bgr and give the buffer back */
+static bool decode_mjpeg(camera_pipeline_t* pl, pipeline_frame_t* f) {
+    cv::Mat jpeg(1, static_cast<int>(f->raw.size), CV_8UC1, const_cast<uint8_t*>(f->raw.data));
+    try {
+        cv::imdecode(jpeg, cv::IMREAD_COLOR, &f->bgr);
+    } catch (const cv::Exception&) {
+        f->bgr.release();
+    }
+    raw_release(pl, f);
+    return !f->bgr.empty();
+}
+
+/* === Motion gate === */
+
+/* Which thumbnail cells the score covers: those centred in a region, or all */
+static void gate_init(camera_pipeline_t* pl) {
+    pl->gate_cells = 0;
+    for (int cy = 0; cy < CIRA_GATE_THUMB_H; cy++) {
+        for (int cx = 0; cx < CIRA_GATE_THUMB_W; cx++) {
+            float x = (cx + 0.5f) / CIRA_GATE_THUMB_W;
+            float y = (cy + 0.5f) / CIRA_GATE_THUMB_H;
+            int in = pl->num_rois == 0;
+            for (int r = 0; r < pl->num_rois && !in; r++) {
+                const cira_roi_t* roi = &pl->rois[r];
+                in = x >= roi->x && x < roi->x + roi->w && y >= roi->y && y < roi->y + roi->h;
+            }
+            pl->gate_mask[cy * CIRA_GATE_THUMB_W + cx] = (uint8_t)in;
+            pl->gate_cells += in;
+        }
+    }
+    pl->gate_have_ref = 0;
+}
+
+/* Luma thumbnail, each cell the mean of four samples */
+static void gate_thumbnail(const cv::Mat& rgb, uint8_t* thumb) {
+    const int tw = CIRA_GATE_THUMB_W;
+    const int th = CIRA_GATE_THUMB_H;
+    for (int cy = 0; cy < th; cy++) {
+        const uint8_t* rows[2] = {
+            rgb.ptr<uint8_t>(((4 * cy + 1) * rgb.rows) / (4 * th)),
+            rgb.ptr<uint8_t>(((4 * cy + 3) * rgb.rows) / (4 * th))
+        };
+        for (int cx = 0; cx < tw; cx++) {
+            int xs[2] = { ((4 * cx + 1) * rgb.cols) / (4 * tw), ((4 * cx + 3) * rgb.cols) / (4 * tw) };
+            int sum = 0;
+            for (int i = 0; i < 2; i++) {
+                for (int j = 0; j < 2; j++) {
+                    const uint8_t* p = rows[i] + xs[j] * 3;
+                    sum += p[0] + 2 * p[1] + p[2];
                 }
-                pthread_mutex_unlock(&ctx->model_mutex);
             }
-            /* If trylock fails, model is being swapped - skip this frame */
+            thumb[cy * tw + cx] = (uint8_t)(sum / 16);
         }
+    }
+}
 
-        /* Calculate FPS */
-        frame_count++;
-        double now = get_time_ms();
-        double elapsed = now - last_time;
+/* True if the frame should be inferred: it moved, the last result is too
+ * old, or the gate is off. Counts the decision on the camera. */
+static bool gate_pass(camera_pipeline_t* pl, const cv::Mat& rgb, double now) {
+    cira_ctx* ctx = pl->ctx;
+    cira_camera_t* cam = pl->cam;
+    float threshold = ctx->gate_threshold;
 
-        if (elapsed >= 1000.0) {
-            ctx->current_fps = (float)(frame_count * 1000.0 / elapsed);
-            frame_count = 0;
-            last_time = now;
+    if (threshold <= 0.0f || pl->gate_cells == 0) {
+        cam->gate_passed++;
+        return true;
+    }
 
-            /* Log FPS periodically */
-            fprintf(stderr, "Camera FPS: %.1f, Detections: %d\n",
-                    ctx->current_fps, ctx->num_detections);
+    uint8_t thumb[CIRA_GATE_THUMB_W * CIRA_GATE_THUMB_H];
+    gate_thumbnail(rgb, thumb);
+
+    float score = 255.0f;
+    if (pl->gate_have_ref) {
+        int total = 0;
+        for (int i = 0; i < CIRA_GATE_THUMB_W * CIRA_GATE_THUMB_H; i++) {
+            if (pl->gate_mask[i]) total += abs(thumb[i] - pl->gate_ref[i]);
+        }
+        score = (float)total / pl->gate_cells;
+    }
+    cam->motion_score = score;
+
+    int max_skip = ctx->gate_max_skip_ms;
+    if (score < threshold && (max_skip == 0 || now - pl->gate_last_pass < max_skip)) {
+        cam->gate_skipped++;
+        return false;
+    }
+
+    /* Later frames are scored against this one, so slow drift still adds up */
+    memcpy(pl->gate_ref, thumb, sizeof(thumb));
+    pl->gate_have_ref = 1;
+    pl->gate_last_pass = now;
+    cam->gate_passed++;
+    return true;
+}
+
+/**
+ * Preprocess stage: colour conversion to RGB and publish the frame for
+ * streaming.
+ *
+ * The conversion writes straight into a frame store slot, which is then
+ * shared by streaming readers and the later stages without a copy. V4L2
+ * YUYV frames are converted from the driver buffer itself, MJPEG frames
+ * decoded from it. Frames the motion gate holds back, and those between
+ * detector runs, go on to the scheduler marked no-infer: only the
+ * scheduler feeds the publish queue.
+ */
+static void* preprocess_stage(void* arg) {
+    camera_pipeline_t* pl = static_cast<camera_pipeline_t*>(arg);
+    cira_camera_t* cam = pl->cam;
+    cira_pin_thread(pl->ctx, CPU_CLASS_CAPTURE);
+    stage_meter_t meter;
+    meter_init(&meter, pl, STAGE_PREPROCESS);
+
+    while (cam->running) {
+        pipeline_frame_t* f = static_cast<pipeline_frame_t*>(
+            frame_queue_pop_wait(pl->queues[STAGE_PREPROCESS], STAGE_WAIT_MS));
+        if (!f) {
+            meter_idle(&meter);
+            continue;
+        }
+
+        double t0 = get_time_ms();
+
+        if (f->raw_held && f->raw.format == CAPTURE_FORMAT_MJPEG && !decode_mjpeg(pl, f)) {
+            pool_release(pl, f);
+            meter_idle(&meter);
+            continue;
+        }
+        int w = f->raw_held ? f->raw.width : f->bgr.cols;
+        int h = f->raw_held ? f->raw.height : f->bgr.rows;
+
+        frame_slot_t* slot;
+        uint8_t* buf = frame_store_begin_write(cam->frame_store, w, h, &slot);
+        if (buf) {
+            f->rgb = cv::Mat(h, w, CV_8UC3, buf);
+        } else {
+            /* Every slot is held by readers - convert privately, skip publishing */
+            f->rgb_buf.create(h, w, CV_8UC3);
+            f->rgb = f->rgb_buf;
+        }
+
+        if (f->raw_held) {
+            capture_yuyv_to_rgb(f->raw.data, f->raw.stride, w, h, f->rgb.data);
+            raw_release(pl, f);
+        } else {
+            cv::cvtColor(f->bgr, f->rgb, cv::COLOR_BGR2RGB);
+        }
+
+        if (buf) {
+            /* Publish for streaming (sensor rate), keeping a reference for inference */
+            frame_store_commit(cam->frame_store, slot, 1);
+            f->slot = slot;
+        }
+
+        /* A frame due for inference was evicted by later ones: infer this
+         * one instead, whatever the gate and the detect interval say */
+        if (pl->infer_evicted) {
+            pl->infer_evicted = 0;
+            pl->gate_have_ref = 0;
+            pl->detect_phase = 0;
+        }
+
+        if (!gate_pass(pl, f->rgb, t0)) {
+            f->no_infer = 1;
+        } else if (pl->detect_interval > 1 && pl->detect_phase++ % pl->detect_interval != 0) {
+            f->no_infer = 1;
+            f->track_only = 1;
+        }
+
+        void* dropped = NULL;
+        frame_queue_push(pl->queues[STAGE_INFERENCE], f, &dropped);
+        if (dropped) {
+            pipeline_frame_t* d = static_cast<pipeline_frame_t*>(dropped);
+            if (!d->no_infer) pl->infer_evicted = 1;
+            pool_release(pl, d);
+        }
+        scheduler_notify(pl->sched);
+        meter_tick(&meter, get_time_ms() - t0);
+    }
+
+    return NULL;
+}
+
+/* === Shared inference scheduler === */
+
+/* Log inference errors occasionally */
+static void scheduler_error(camera_scheduler_t* s, int result) {
+    if (result != CIRA_ERROR && ++s->err_count % 100 == 1) {
+        fprintf(stderr, "Inference error: %d\n", result);
+    }
+}
+
+/* Store a detector result, through the tracker when on (caller holds result_mutex) */
+static void store_result(cira_ctx* ctx, camera_pipeline_t* pl, const cira_detection_t* dets,
+                         int count, int w, int h, const pipeline_frame_t* f) {
+    latency_hist_record(pl->cam->latency[CIRA_LATENCY_RESULT], get_time_ms() - f->glass_ms);
+    if (!pl->tracker) {
+        cira_camera_store_result(ctx, pl->cam, dets, count, w, h, f->seq);
+        return;
+    }
+
+    cira_detection_t tracked[CIRA_MAX_DETECTIONS];
+    int ids[CIRA_MAX_DETECTIONS];
+    int n = tracker_update(pl->tracker, dets, count, f->capture_ms,
+                           tracked, ids, CIRA_MAX_DETECTIONS);
+    cira_camera_store_tracks(ctx, pl->cam, tracked, ids, n, w, h, f->seq, 1);
+    pl->cam->active_tracks = tracker_count(pl->tracker);
+}
+
+/* One predict per inference region, boxes mapped back onto the whole
+ * frame and stored as one result (caller holds model_mutex) */
+static void infer_rois(camera_scheduler_t* s, camera_pipeline_t* pl, pipeline_frame_t* f) {
+    cira_ctx* ctx = s->ctx;
+    const cv::Mat& rgb = f->rgb;
+    cira_detection_t dets[CIRA_MAX_DETECTIONS];
+    int count = 0;
+    bool ok = false;
+
+    for (int r = 0; r < pl->num_rois; r++) {
+        const cira_roi_t* roi = &pl->rois[r];
+        int x0 = (int)(roi->x * rgb.cols);
+        int y0 = (int)(roi->y * rgb.rows);
+        int x1 = std::min(rgb.cols, (int)((roi->x + roi->w) * rgb.cols + 0.5f));
+        int y1 = std::min(rgb.rows, (int)((roi->y + roi->h) * rgb.rows + 0.5f));
+        if (x1 - x0 < 2 || y1 - y0 < 2) continue;
+
+        /* Backends take packed rows, so the region is copied out */
+        cv::Rect rect(x0, y0, x1 - x0, y1 - y0);
+        rgb(rect).copyTo(s->crop);
+
+        ctx->num_detections = 0;
+        int result = cira_backend_predict(ctx, s->crop.data, rect.width, rect.height, 3);
+        ctx->scheduler_calls++;
+        if (result != CIRA_OK) {
+            scheduler_error(s, result);
+            continue;
+        }
+        ok = true;
+
+        float sx = (float)rect.width / rgb.cols;
+        float sy = (float)rect.height / rgb.rows;
+        for (int i = 0; i < ctx->num_detections && count < CIRA_MAX_DETECTIONS; i++) {
+            cira_detection_t d = ctx->detections[i];
+            d.x = (float)x0 / rgb.cols + d.x * sx;
+            d.y = (float)y0 / rgb.rows + d.y * sy;
+            d.w *= sx;
+            d.h *= sy;
+            dets[count++] = d;
+        }
+    }
+    if (!ok) return;
+
+    pthread_mutex_lock(&ctx->result_mutex);
+    store_result(ctx, pl, dets, count, rgb.cols, rgb.rows, f);
+    pthread_mutex_unlock(&ctx->result_mutex);
+
+    ctx->total_frames++;
+    ctx->scheduler_frames++;
+}
+
+/* One predict call for one camera frame (caller holds model_mutex) */
+static void infer_one(camera_scheduler_t* s, camera_pipeline_t* pl, pipeline_frame_t* f) {
+    cira_ctx* ctx = s->ctx;
+
+    if (pl->num_rois > 0) {
+        infer_rois(s, pl, f);
+        return;
+    }
+
+    ctx->num_detections = 0;
+    int result = cira_backend_predict(ctx, f->rgb.data, f->rgb.cols, f->rgb.rows, 3);
+    ctx->scheduler_calls++;
+    if (result != CIRA_OK) {
+        scheduler_error(s, result);
+        return;
+    }
+
+    pthread_mutex_lock(&ctx->result_mutex);
+    store_result(ctx, pl, ctx->detections, ctx->num_detections,
+                 f->rgb.cols, f->rgb.rows, f);
+    pthread_mutex_unlock(&ctx->result_mutex);
+
+    ctx->total_frames++;
+    ctx->scheduler_frames++;
+}
+
+/* One batch call per group of same-size frames (caller holds model_mutex) */
+static void infer_batched(camera_scheduler_t* s, pipeline_frame_t** frames,
+                          camera_pipeline_t** owners, int n) {
+    cira_ctx* ctx = s->ctx;
+    const uint8_t* images[CIRA_MAX_CAMERAS];
+    int group[CIRA_MAX_CAMERAS];
+    int done[CIRA_MAX_CAMERAS] = {0};
+
+    for (int i = 0; i < n; i++) {
+        if (done[i]) continue;
+
+        /* Region crops differ in size, so those cameras infer on their own */
+        if (owners[i]->num_rois > 0) {
+            done[i] = 1;
+            infer_one(s, owners[i], frames[i]);
+            continue;
+        }
+
+        int w = frames[i]->rgb.cols;
+        int h = frames[i]->rgb.rows;
+        int m = 0;
+        for (int j = i; j < n; j++) {
+            if (!done[j] && owners[j]->num_rois == 0 &&
+                frames[j]->rgb.cols == w && frames[j]->rgb.rows == h) {
+                images[m] = frames[j]->rgb.data;
+                group[m++] = j;
+                done[j] = 1;
+            }
+        }
+
+        if (m == 1) {
+            infer_one(s, owners[i], frames[i]);
+            continue;
+        }
+
+        /* The batch runs into scratch under model_mutex alone; readers
+         * wait only for the results to be stored */
+        int result = cira_backend_predict_batch(ctx, images, m, w, h, 3);
+        int stored = std::min(ctx->batch_scratch_count, m);
+
+        pthread_mutex_lock(&ctx->result_mutex);
+        for (int k = 0; k < stored; k++) {
+            const cira_batch_result_t* r = &ctx->batch_scratch[k];
+            store_result(ctx, owners[group[k]], r->detections, r->num_detections,
+                         w, h, frames[group[k]]);
+        }
+        pthread_mutex_unlock(&ctx->result_mutex);
+
+        ctx->total_frames += stored;
+        ctx->scheduler_frames += stored;
+
+        ctx->scheduler_calls++;
+        if (result != CIRA_OK) {
+            scheduler_error(s, result);
+        }
+    }
+}
+
+/* Take the next frame to infer of every camera, starting at s->next, and
+ * pass no-infer frames queued ahead of it on to publish (caller holds
+ * members_mutex) */
+static int scheduler_collect(camera_scheduler_t* s, pipeline_frame_t** frames,
+                             camera_pipeline_t** owners) {
+    int n = 0;
+    for (int k = 0; k < CIRA_MAX_CAMERAS; k++) {
+        camera_pipeline_t* pl = s->members[(s->next + k) % CIRA_MAX_CAMERAS];
+        if (!pl) continue;
+
+        pipeline_frame_t* f;
+        while ((f = static_cast<pipeline_frame_t*>(
+                    frame_queue_pop(pl->queues[STAGE_INFERENCE]))) != NULL && f->no_infer) {
+            stage_forward(pl, STAGE_PUBLISH, f);
+        }
+        if (f) {
+            frames[n] = f;
+            owners[n] = pl;
+            n++;
+        } else {
+            meter_idle(&pl->infer_meter);
+            pl->cam->inference_fps = pl->infer_meter.stats->fps;
+        }
+    }
+
+    /* Rotate who goes first so no camera is always served last */
+    s->next = (s->next + 1) % CIRA_MAX_CAMERAS;
+    return n;
+}
+
+/**
+ * Inference stage: run frames from every camera through the loaded model.
+ */
+static void* scheduler_thread(void* arg) {
+    camera_scheduler_t* s = static_cast<camera_scheduler_t*>(arg);
+    cira_ctx* ctx = s->ctx;
+    cira_pin_thread(ctx, CPU_CLASS_INFERENCE);
+    pipeline_frame_t* frames[CIRA_MAX_CAMERAS];
+    camera_pipeline_t* owners[CIRA_MAX_CAMERAS];
+    int idle = 1;
+
+    fprintf(stderr, "Inference scheduler started (%s)\n",
+            ctx->camera_schedule == CIRA_SCHEDULE_ROUND_ROBIN ? "round_robin" : "batch");
+
+    while (s->running) {
+        if (idle) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += STAGE_WAIT_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            pthread_mutex_lock(&s->wake_mutex);
+            while (!s->pending && s->running) {
+                if (pthread_cond_timedwait(&s->wake_cond, &s->wake_mutex, &deadline) == ETIMEDOUT) {
+                    break;
+                }
+            }
+            s->pending = 0;
+            pthread_mutex_unlock(&s->wake_mutex);
+        }
+
+        pthread_mutex_lock(&s->members_mutex);
+
+        int n = scheduler_collect(s, frames, owners);
+        idle = (n == 0);
+        if (idle) {
+            pthread_mutex_unlock(&s->members_mutex);
+            continue;
+        }
+
+        double t0 = get_time_ms();
+
+        /* Run inference if a model is loaded. Reloads build the new model
+         * aside and hold model_mutex only to publish it (or an API predict
+         * holds it for one call), so wait for the lock rather than skip. */
+        bool inferred = false;
+        if (ctx->format != CIRA_FORMAT_UNKNOWN && ctx->model_handle != NULL) {
+            pthread_mutex_lock(&ctx->model_mutex);
+            if (ctx->model_handle != NULL) {
+                if (ctx->camera_schedule == CIRA_SCHEDULE_BATCH && n > 1) {
+                    infer_batched(s, frames, owners, n);
+                } else {
+                    for (int i = 0; i < n; i++) {
+                        infer_one(s, owners[i], frames[i]);
+                    }
+                }
+                inferred = true;
+            }
+            pthread_mutex_unlock(&ctx->model_mutex);
+        }
+        if (!inferred) {
+            ctx->skipped_frames += n;
         }
 
-        /* Small sleep to prevent CPU spinning */
-        usleep(1000);  /* 1ms */
+        /* Shared calls are charged evenly to the cameras they served */
+        double busy = (get_time_ms() - t0) / n;
+        for (int i = 0; i < n; i++) {
+            camera_pipeline_t* pl = owners[i];
+            stage_forward(pl, STAGE_PUBLISH, frames[i]);
+            if (meter_tick(&pl->infer_meter, busy)) {
+                pl->cam->inference_fps = pl->infer_meter.stats->fps;
+            }
+        }
+
+        pthread_mutex_unlock(&s->members_mutex);
     }
 
-    fprintf(stderr, "Camera capture thread stopped\n");
+    fprintf(stderr, "Inference scheduler stopped\n");
     return NULL;
 }
 
 /**
- * Start camera capture.
+ * Publish stage: store tracker predictions for frames the detector
+ * skipped, feed the annotated frame to the video encoder while anyone
+ * watches /stream/video, then encode the annotated frame file for
+ * file-based transfer.
+ * The frame file belongs to the context, so only camera 0 writes it. With
+ * the frame ring on, every camera publishes every frame there instead.
  */
-extern "C" int camera_start(cira_ctx* ctx, int device_id) {
-    if (!ctx) return CIRA_ERROR_INPUT;
+static void* publish_stage(void* arg) {
+    camera_pipeline_t* pl = static_cast<camera_pipeline_t*>(arg);
+    cira_ctx* ctx = pl->ctx;
+    cira_camera_t* cam = pl->cam;
+    cira_pin_thread(ctx, CPU_CLASS_ENCODE);
+    stage_meter_t meter;
+    meter_init(&meter, pl, STAGE_PUBLISH);
+    double last_write = 0.0;
 
-    /* Check if already running */
-    if (ctx->camera_running) {
-        fprintf(stderr, "Camera already running\n");
-        return CIRA_OK;
+    while (cam->running) {
+        pipeline_frame_t* f = static_cast<pipeline_frame_t*>(
+            frame_queue_pop_wait(pl->queues[STAGE_PUBLISH], STAGE_WAIT_MS));
+        if (!f) {
+            meter_idle(&meter);
+            continue;
+        }
+
+        double t0 = get_time_ms();
+
+        /* Frames the detector skipped take the tracks' predicted boxes,
+         * unless a later frame's result is already in */
+        if (f->track_only && pl->tracker) {
+            cira_detection_t boxes[CIRA_MAX_DETECTIONS];
+            int ids[CIRA_MAX_DETECTIONS];
+            pthread_mutex_lock(&ctx->result_mutex);
+            if (f->seq > cam->result_frame_seq) {
+                int n = tracker_predict(pl->tracker, f->capture_ms, boxes, ids,
+                                        CIRA_MAX_DETECTIONS);
+                cira_camera_store_tracks(ctx, cam, boxes, ids, n, f->rgb.cols, f->rgb.rows,
+                                         f->seq, 0);
+                cam->tracked_frames++;
+                latency_hist_record(cam->latency[CIRA_LATENCY_RESULT], t0 - f->glass_ms);
+            }
+            pthread_mutex_unlock(&ctx->result_mutex);
+        }
+
+        /* Annotate once into the encoder's input; every viewer shares the bitstream */
+        if (video_encoder_wanted(cam->video)) {
+            uint8_t* dst = video_encoder_begin_frame(cam->video, &pl->video_config,
+                                                     f->rgb.cols, f->rgb.rows);
+            if (dst) {
+                frame_annotate(ctx, cam, f->rgb.data, f->rgb.cols, f->rgb.rows, dst);
+                video_encoder_end_frame(cam->video, f->capture_ms);
+            }
+        }
+
+        if (ctx->frame_ring) {
+            cira_publish_frame_ring(ctx, cam, f->slot, f->rgb.data, f->rgb.cols, f->rgb.rows);
+        } else if (cam->index == 0 && t0 - last_write >= FRAME_FILE_INTERVAL_MS) {
+            /* Rate-limit file writes to reduce disk I/O */
+            last_write = t0;
+            if (f->slot) {
+                /* Shares the encode with any viewer asking for the same variant */
+                cira_write_frame_file_slot(ctx, cam, f->slot, 1);
+            } else {
+                cira_write_frame_file_rgb(ctx, cam, f->rgb.data, f->rgb.cols, f->rgb.rows, 1);
+            }
+        }
+
+        pool_release(pl, f);
+        meter_tick(&meter, get_time_ms() - t0);
     }
 
-    fprintf(stderr, "Opening camera %d...\n", device_id);
+    video_encoder_stop(cam->video);
+    return NULL;
+}
 
-    /* Create VideoCapture */
-    g_capture = new cv::VideoCapture();
+/* === Scheduler lifecycle (caller holds camera_mutex) === */
 
-    /* Open camera - OpenCV auto-selects backend (DirectShow on Windows, V4L2 on Linux) */
-#ifdef _WIN32
-    /* On Windows, use DirectShow backend explicitly for better compatibility */
-    if (!g_capture->open(device_id, cv::CAP_DSHOW)) {
-        /* Fall back to default backend */
-        if (!g_capture->open(device_id)) {
-            fprintf(stderr, "Failed to open camera %d\n", device_id);
-            delete g_capture;
-            g_capture = NULL;
-            return CIRA_ERROR;
+static camera_scheduler_t* scheduler_acquire(cira_ctx* ctx) {
+    if (ctx->camera_scheduler) {
+        return static_cast<camera_scheduler_t*>(ctx->camera_scheduler);
+    }
+
+    camera_scheduler_t* s = new camera_scheduler_t();
+    s->ctx = ctx;
+    s->running = 1;
+    pthread_mutex_init(&s->wake_mutex, NULL);
+    pthread_cond_init(&s->wake_cond, NULL);
+    pthread_mutex_init(&s->members_mutex, NULL);
+
+    int ret = pthread_create(&s->thread, NULL, scheduler_thread, s);
+    if (ret != 0) {
+        fprintf(stderr, "Failed to create inference scheduler thread: %d\n", ret);
+        pthread_mutex_destroy(&s->wake_mutex);
+        pthread_cond_destroy(&s->wake_cond);
+        pthread_mutex_destroy(&s->members_mutex);
+        delete s;
+        return NULL;
+    }
+
+    ctx->camera_scheduler = s;
+    return s;
+}
+
+/* Stop the scheduler once no camera is left */
+static void scheduler_release(cira_ctx* ctx) {
+    camera_scheduler_t* s = static_cast<camera_scheduler_t*>(ctx->camera_scheduler);
+    if (!s || ctx->camera_running > 0) return;
+
+    pthread_mutex_lock(&s->wake_mutex);
+    s->running = 0;
+    pthread_cond_signal(&s->wake_cond);
+    pthread_mutex_unlock(&s->wake_mutex);
+    pthread_join(s->thread, NULL);
+
+    pthread_mutex_destroy(&s->wake_mutex);
+    pthread_cond_destroy(&s->wake_cond);
+    pthread_mutex_destroy(&s->members_mutex);
+    delete s;
+    ctx->camera_scheduler = NULL;
+}
+
+static void scheduler_set_member(camera_scheduler_t* s, int camera, camera_pipeline_t* pl) {
+    /* Waits for an in-flight sweep, which may be holding this camera's frames */
+    pthread_mutex_lock(&s->members_mutex);
+    s->members[camera] = pl;
+    pthread_mutex_unlock(&s->members_mutex);
+}
+
+/* === Pipeline lifecycle === */
+
+static void pipeline_destroy(camera_pipeline_t* pl) {
+    if (!pl) return;
+
+    for (int i = 0; i < CIRA_PIPELINE_STAGES; i++) {
+        if (!pl->queues[i]) continue;
+        /* Frames still queued hold frame store references */
+        void* f;
+        while ((f = frame_queue_pop(pl->queues[i])) != NULL) {
+            pool_release(pl, static_cast<pipeline_frame_t*>(f));
+        }
+        frame_queue_destroy(pl->queues[i]);
+    }
+
+    delete[] pl->frames;
+    free(pl->free_list);
+    pthread_mutex_destroy(&pl->pool_mutex);
+
+    if (pl->cap) {
+        pl->cap->release();
+        delete pl->cap;
+    }
+    capture_v4l2_close(pl->v4l2);
+    tracker_destroy(pl->tracker);
+
+    delete pl;
+}
+
+static camera_pipeline_t* pipeline_create(cira_ctx* ctx, cira_camera_t* cam, int depth, int policy) {
+    camera_pipeline_t* pl = new camera_pipeline_t();
+    pl->ctx = ctx;
+    pl->cam = cam;
+    pl->video_config = ctx->video_config;
+    pthread_mutex_init(&pl->pool_mutex, NULL);
+
+    for (int i = STAGE_PREPROCESS; i < CIRA_PIPELINE_STAGES; i++) {
+        pl->queues[i] = frame_queue_create(depth, policy);
+        if (!pl->queues[i]) {
+            pipeline_destroy(pl);
+            return NULL;
+        }
+    }
+
+    /* Enough frames to fill every queue plus one in hand per stage */
+    pl->num_frames = depth * (CIRA_PIPELINE_STAGES - 1) + CIRA_PIPELINE_STAGES + 1;
+    pl->frames = new pipeline_frame_t[pl->num_frames];
+    pl->free_list = (pipeline_frame_t**)malloc(pl->num_frames * sizeof(pipeline_frame_t*));
+    if (!pl->free_list) {
+        pipeline_destroy(pl);
+        return NULL;
+    }
+    for (int i = 0; i < pl->num_frames; i++) {
+        pl->free_list[i] = &pl->frames[i];
+    }
+    pl->free_count = pl->num_frames;
+
+    return pl;
+}
+
+/* Stop and join stage threads (caller clears cam->running first) */
+static void pipeline_join(camera_pipeline_t* pl) {
+    for (int i = 0; i < CIRA_PIPELINE_STAGES; i++) {
+        frame_queue_wake(pl->queues[i]);
+    }
+    for (int i = 0; i < pl->num_threads; i++) {
+        pthread_join(pl->threads[i], NULL);
+    }
+    pl->num_threads = 0;
+}
+
+/* Allocate what a camera keeps between runs (camera 0 has the context's store) */
+static int camera_prepare(cira_camera_t* cam) {
+    if (!cam->frame_store) {
+        cam->frame_store = frame_store_create(CIRA_FRAME_STORE_SLOTS);
+        if (!cam->frame_store) return CIRA_ERROR_MEMORY;
+    }
+    if (!cam->jpeg_cache) {
+        cam->jpeg_cache = jpeg_cache_create();
+        if (!cam->jpeg_cache) return CIRA_ERROR_MEMORY;
+    }
+    if (!cam->video) {
+        cam->video = video_encoder_create();
+        if (!cam->video) return CIRA_ERROR_MEMORY;
+    }
+    if (!cam->result_json) {
+        cam->result_json = (char*)malloc(CIRA_MAX_JSON_LEN);
+        if (!cam->result_json) return CIRA_ERROR_MEMORY;
+        strcpy(cam->result_json, "{\"detections\":[],\"count\":0}");
+    }
+    for (int i = 0; i < CIRA_CAMERA_LATENCIES; i++) {
+        if (!cam->latency[i]) {
+            cam->latency[i] = latency_hist_create();
+            if (!cam->latency[i]) return CIRA_ERROR_MEMORY;
+        }
+    }
+    return CIRA_OK;
+}
+
+/* Stop one running camera (caller holds camera_mutex) */
+static void camera_stop_one(cira_ctx* ctx, cira_camera_t* cam) {
+    fprintf(stderr, "Stopping camera %d...\n", cam->index);
+
+    /* Signal threads to stop */
+    cam->running = 0;
+
+    /* Detach from the scheduler, then wait for stage threads to finish and
+     * release VideoCapture and frames */
+    camera_pipeline_t* pl = static_cast<camera_pipeline_t*>(cam->pipeline);
+    cam->pipeline = NULL;
+    if (pl) {
+        if (pl->sched) {
+            scheduler_set_member(pl->sched, cam->index, NULL);
         }
+        pipeline_join(pl);
+        pipeline_destroy(pl);
+    }
+
+    /* Clear state */
+    cam->device_id = -1;
+    cam->capture_backend = NULL;
+    cam->capture_format = NULL;
+    cam->current_fps = 0.0f;
+    cam->inference_fps = 0.0f;
+    for (int i = 0; i < CIRA_PIPELINE_STAGES; i++) {
+        cam->stage_stats[i].fps = 0.0f;
+        cam->stage_stats[i].queue_depth = 0;
     }
+
+    ctx->camera_running--;
+    if (cam->index == 0) {
+        ctx->current_camera = -1;
+    }
+
+    fprintf(stderr, "Camera %d stopped\n", cam->index);
+}
+
+/* === Capture sources === */
+
+/* OpenCV appsink tail: BGR into system memory, never queueing stale frames */
+#define GST_APPSINK "videoconvert ! video/x-raw,format=BGR ! appsink drop=true max-buffers=2 sync=false"
+
+/* Jetson decoders and cameras output NVMM buffers that nvvidconv brings to system memory */
+#define GST_FROM_NVMM "nvvidconv ! video/x-raw,format=BGRx ! "
+
+static bool is_jetson(void) {
+#ifdef _WIN32
+    return false;
 #else
-    if (!g_capture->open(device_id)) {
-        fprintf(stderr, "Failed to open camera %d\n", device_id);
-        delete g_capture;
-        g_capture = NULL;
-        return CIRA_ERROR;
+    return access("/etc/nv_tegra_release", F_OK) == 0;
+#endif
+}
+
+/* Open a GStreamer pipeline through OpenCV */
+static bool open_gstreamer(camera_pipeline_t* pl, const char* pipeline) {
+    fprintf(stderr, "GStreamer pipeline: %s\n", pipeline);
+    if (!pl->cap) pl->cap = new cv::VideoCapture();
+    try {
+        return pl->cap->open(pipeline, cv::CAP_GSTREAMER) && pl->cap->isOpened();
+    } catch (const cv::Exception&) {
+        return false;
     }
+}
+
+/* Open a device camera or URL with OpenCV's default backends */
+static bool open_opencv(camera_pipeline_t* pl, const char* source, int device_id) {
+    if (!pl->cap) pl->cap = new cv::VideoCapture();
+    if (source[0]) {
+        return pl->cap->open(source);
+    }
+#ifdef _WIN32
+    /* On Windows, use DirectShow backend explicitly for better compatibility */
+    if (pl->cap->open(device_id, cv::CAP_DSHOW)) return true;
 #endif
+    return pl->cap->open(device_id);
+}
 
-    /* Set resolution to 1280x720 */
-    g_capture->set(cv::CAP_PROP_FRAME_WIDTH, DEFAULT_WIDTH);
-    g_capture->set(cv::CAP_PROP_FRAME_HEIGHT, DEFAULT_HEIGHT);
+/**
+ * Open a camera's capture (caller holds camera_mutex). cam->source picks
+ * the kind: "gst:<pipeline>", "csi:N" (Jetson), a URL, or a device path;
+ * empty means device_id. Fills pl->width/height and the capture fields
+ * of cam.
+ */
+static int capture_open(cira_ctx* ctx, cira_camera_t* cam, camera_pipeline_t* pl, int device_id) {
+    const char* source = cam->source;
+    char pipeline[CIRA_CAMERA_SOURCE_LEN + 512];
+    int w = ctx->camera_width;
+    int h = ctx->camera_height;
+    int fps = ctx->camera_fps > 0 ? ctx->camera_fps : 30;
+    bool opened = false;
 
-    /* Get actual resolution (may differ from requested) */
-    g_cam_state.width = static_cast<int>(g_capture->get(cv::CAP_PROP_FRAME_WIDTH));
-    g_cam_state.height = static_cast<int>(g_capture->get(cv::CAP_PROP_FRAME_HEIGHT));
-    g_cam_state.device_id = device_id;
-    g_cam_state.cap = g_capture;
+    fprintf(stderr, "Opening camera %d (%s)...\n", cam->index,
+            source[0] ? source : "device");
+    cam->capture_backend = "gstreamer";
+    cam->capture_format = "bgr";
 
-    fprintf(stderr, "Camera opened: device %d, resolution %dx%d\n",
-            device_id, g_cam_state.width, g_cam_state.height);
+    if (strncmp(source, "gst:", 4) == 0) {
+        opened = open_gstreamer(pl, source + 4);
+    } else if (strncmp(source, "csi:", 4) == 0) {
+        snprintf(pipeline, sizeof(pipeline),
+                 "nvarguscamerasrc sensor-id=%d ! "
+                 "video/x-raw(memory:NVMM),width=%d,height=%d,framerate=%d/1 ! "
+                 GST_FROM_NVMM GST_APPSINK, atoi(source + 4), w, h, fps);
+        opened = open_gstreamer(pl, pipeline);
+    } else if (strstr(source, "://")) {
+        /* decodebin picks a hardware decoder by rank when one is installed */
+        const char* nvmm = is_jetson() ? GST_FROM_NVMM : "";
+        if (strncmp(source, "rtsp://", 7) == 0) {
+            snprintf(pipeline, sizeof(pipeline),
+                     "rtspsrc location=%s latency=100 ! decodebin ! %s" GST_APPSINK, source, nvmm);
+        } else {
+            snprintf(pipeline, sizeof(pipeline),
+                     "uridecodebin uri=%s ! %s" GST_APPSINK, source, nvmm);
+        }
+        opened = open_gstreamer(pl, pipeline);
+        if (!opened) {
+            cam->capture_backend = "opencv";
+            opened = open_opencv(pl, source, device_id);
+        }
+    } else {
+        char device[CIRA_CAMERA_SOURCE_LEN];
+        if (source[0]) {
+            snprintf(device, sizeof(device), "%s", source);
+        } else {
+            snprintf(device, sizeof(device), "/dev/video%d", device_id);
+        }
 
-    /* Start capture thread */
-    ctx->camera_running = 1;
-    ctx->current_camera = device_id;
+        /* USB MJPEG on Jetson: decode on the NVJPG engine */
+        if (is_jetson() && ctx->camera_backend == CIRA_CAPTURE_AUTO &&
+            ctx->camera_format == CAPTURE_FORMAT_MJPEG) {
+            snprintf(pipeline, sizeof(pipeline),
+                     "v4l2src device=%s io-mode=2 ! image/jpeg,width=%d,height=%d ! "
+                     "nvv4l2decoder mjpeg=1 ! " GST_FROM_NVMM GST_APPSINK, device, w, h);
+            opened = open_gstreamer(pl, pipeline);
+        }
 
-    int ret = pthread_create(&ctx->camera_thread, NULL, camera_thread_func_impl, ctx);
-    if (ret != 0) {
-        fprintf(stderr, "Failed to create camera thread: %d\n", ret);
-        ctx->camera_running = 0;
-        g_capture->release();
-        delete g_capture;
-        g_capture = NULL;
-        return CIRA_ERROR;
+        if (!opened && ctx->camera_backend != CIRA_CAPTURE_OPENCV) {
+            /* Enough driver buffers to fill the preprocess queue plus one in hand each side */
+            int buffers = ctx->pipeline_queue_depth + 3;
+            pl->v4l2 = capture_v4l2_open(device, w, h, ctx->camera_fps, buffers, ctx->camera_format);
+            if (pl->v4l2) {
+                capture_v4l2_size(pl->v4l2, &pl->width, &pl->height);
+                cam->capture_backend = "v4l2";
+                cam->capture_format = capture_format_name(capture_v4l2_format(pl->v4l2));
+            } else if (ctx->camera_backend == CIRA_CAPTURE_V4L2) {
+                fprintf(stderr, "Failed to open %s with V4L2\n", device);
+                return CIRA_ERROR;
+            }
+        }
+
+        if (!opened && !pl->v4l2) {
+            cam->capture_backend = "opencv";
+            opened = open_opencv(pl, source, device_id);
+            if (opened) {
+                pl->cap->set(cv::CAP_PROP_FRAME_WIDTH, w);
+                pl->cap->set(cv::CAP_PROP_FRAME_HEIGHT, h);
+                if (ctx->camera_fps > 0) pl->cap->set(cv::CAP_PROP_FPS, ctx->camera_fps);
+            }
+        }
     }
 
-    fprintf(stderr, "Camera capture started\n");
+    if (!pl->v4l2) {
+        if (!opened) {
+            fprintf(stderr, "Failed to open camera %d (%s)\n", cam->index,
+                    source[0] ? source : "device");
+            return CIRA_ERROR;
+        }
+
+        /* Get actual resolution (may differ from requested) */
+        pl->width = static_cast<int>(pl->cap->get(cv::CAP_PROP_FRAME_WIDTH));
+        pl->height = static_cast<int>(pl->cap->get(cv::CAP_PROP_FRAME_HEIGHT));
+    }
+    pl->device_id = device_id;
+
+    fprintf(stderr, "Camera %d opened: %s capture, %s %dx%d\n",
+            cam->index, cam->capture_backend, cam->capture_format, pl->width, pl->height);
     return CIRA_OK;
 }
 
 /**
- * Stop camera capture.
+ * Start capture on one camera of the context.
  */
-extern "C" int camera_stop(cira_ctx* ctx) {
-    if (!ctx) return CIRA_ERROR_INPUT;
+extern "C" int camera_start(cira_ctx* ctx, int camera, int device_id) {
+    if (!ctx || camera < 0 || camera >= CIRA_MAX_CAMERAS) return CIRA_ERROR_INPUT;
 
-    if (!ctx->camera_running) {
-        fprintf(stderr, "Camera not running\n");
+    pthread_mutex_lock(&ctx->camera_mutex);
+    cira_camera_t* cam = &ctx->cameras[camera];
+
+    /* Check if already running */
+    if (cam->running) {
+        pthread_mutex_unlock(&ctx->camera_mutex);
+        fprintf(stderr, "Camera %d already running\n", camera);
         return CIRA_OK;
     }
 
-    fprintf(stderr, "Stopping camera...\n");
+    if (cira_frame_ring_start(ctx) != CIRA_OK) {
+        fprintf(stderr, "%s, falling back to the frame file\n", cira_error(ctx));
+    }
 
-    /* Signal thread to stop */
-    ctx->camera_running = 0;
-    ctx->current_camera = -1;
+    camera_pipeline_t* pl = NULL;
+    if (camera_prepare(cam) == CIRA_OK) {
+        pl = pipeline_create(ctx, cam, ctx->pipeline_queue_depth, ctx->pipeline_drop_policy);
+    }
+    if (!pl) {
+        pthread_mutex_unlock(&ctx->camera_mutex);
+        fprintf(stderr, "Failed to create camera pipeline\n");
+        return CIRA_ERROR_MEMORY;
+    }
 
-    /* Wait for thread to finish */
-    pthread_join(ctx->camera_thread, NULL);
+    if (capture_open(ctx, cam, pl, device_id) != CIRA_OK) {
+        pipeline_destroy(pl);
+        pthread_mutex_unlock(&ctx->camera_mutex);
+        return CIRA_ERROR;
+    }
 
-    /* Release VideoCapture */
-    if (g_capture) {
-        g_capture->release();
-        delete g_capture;
-        g_capture = NULL;
+    /* Join the shared inference stage */
+    pl->sched = scheduler_acquire(ctx);
+    if (!pl->sched) {
+        pipeline_destroy(pl);
+        pthread_mutex_unlock(&ctx->camera_mutex);
+        return CIRA_ERROR;
     }
 
-    /* Clear state */
-    g_cam_state.cap = NULL;
-    g_cam_state.device_id = 0;
-    g_cam_state.width = 0;
-    g_cam_state.height = 0;
+    cam->running = 1;
+    cam->device_id = device_id;
+    cam->current_fps = 0.0f;
+    cam->inference_fps = 0.0f;
+    ctx->camera_running++;
+    if (camera == 0) {
+        ctx->current_camera = device_id;
+    }
+
+    memcpy(pl->rois, cam->rois, sizeof(pl->rois));
+    pl->num_rois = cam->num_rois;
+    cam->gate_passed = 0;
+    cam->gate_skipped = 0;
+    cam->motion_score = 0.0f;
+    gate_init(pl);
+
+    pl->detect_interval = 1;
+    cam->tracked_frames = 0;
+    cam->active_tracks = 0;
+    if (ctx->tracker_enabled) {
+        tracker_config_t config;
+        tracker_default_config(&config);
+        config.high_threshold = ctx->tracker_high_threshold;
+        pl->tracker = tracker_create(&config);
+        if (pl->tracker) {
+            pl->detect_interval = ctx->tracker_interval;
+        } else {
+            fprintf(stderr, "Camera %d: failed to create tracker, running without\n", camera);
+        }
+    }
+
+    meter_init(&pl->infer_meter, pl, STAGE_INFERENCE);
+    scheduler_set_member(pl->sched, camera, pl);
+
+    /* Start stage threads (inference runs on the scheduler) */
+    void* (*stage_funcs[CIRA_PIPELINE_STAGES])(void*) = {
+        capture_stage, preprocess_stage, NULL, publish_stage
+    };
+
+    for (int i = 0; i < CIRA_PIPELINE_STAGES; i++) {
+        if (!stage_funcs[i]) continue;
+        int ret = pthread_create(&pl->threads[pl->num_threads], NULL, stage_funcs[i], pl);
+        if (ret != 0) {
+            fprintf(stderr, "Failed to create camera %s thread: %d\n", g_stage_names[i], ret);
+            cam->pipeline = pl;
+            camera_stop_one(ctx, cam);
+            scheduler_release(ctx);
+            pthread_mutex_unlock(&ctx->camera_mutex);
+            return CIRA_ERROR;
+        }
+        pl->num_threads++;
+    }
+
+    cam->pipeline = pl;
+    pthread_mutex_unlock(&ctx->camera_mutex);
+
+    fprintf(stderr, "Camera %d capture started (queue depth %d, %s)\n",
+            camera, ctx->pipeline_queue_depth,
+            ctx->pipeline_drop_policy == FRAME_QUEUE_DROP_NEWEST ? "drop_newest" : "drop_oldest");
+    return CIRA_OK;
+}
+
+/**
+ * Stop capture on one camera, or on every camera when camera is -1.
+ */
+extern "C" int camera_stop(cira_ctx* ctx, int camera) {
+    if (!ctx || camera < -1 || camera >= CIRA_MAX_CAMERAS) return CIRA_ERROR_INPUT;
+
+    pthread_mutex_lock(&ctx->camera_mutex);
+
+    if (camera >= 0 && !ctx->cameras[camera].running) {
+        pthread_mutex_unlock(&ctx->camera_mutex);
+        fprintf(stderr, "Camera %d not running\n", camera);
+        return CIRA_OK;
+    }
+
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        if ((camera < 0 || i == camera) && ctx->cameras[i].running) {
+            camera_stop_one(ctx, &ctx->cameras[i]);
+        }
+    }
+
+    /* Last camera out stops the scheduler */
+    scheduler_release(ctx);
 
-    fprintf(stderr, "Camera stopped\n");
+    pthread_mutex_unlock(&ctx->camera_mutex);
     return CIRA_OK;
 }
 
 #else /* CIRA_OPENCV_ENABLED */
 
 /* Stubs when OpenCV is not enabled */
-extern "C" int camera_start(cira_ctx* ctx, int device_id) {
+extern "C" int camera_start(cira_ctx* ctx, int camera, int device_id) {
     (void)ctx;
+    (void)camera;
     (void)device_id;
     fprintf(stderr, "OpenCV camera support not enabled in this build\n");
     return CIRA_ERROR;
 }
 
-extern "C" int camera_stop(cira_ctx* ctx) {
+extern "C" int camera_stop(cira_ctx* ctx, int camera) {
     (void)ctx;
+    (void)camera;
     return CIRA_ERROR;
 }
 
@@ -321,15 +1422,17 @@ extern "C" int camera_stop(cira_ctx* ctx) {
 #else /* CIRA_STREAMING_ENABLED */
 
 /* Stubs when streaming is not enabled */
-extern "C" int camera_start(cira_ctx* ctx, int device_id) {
+extern "C" int camera_start(cira_ctx* ctx, int camera, int device_id) {
     (void)ctx;
+    (void)camera;
     (void)device_id;
     fprintf(stderr, "Streaming not enabled in this build\n");
     return CIRA_ERROR;
 }
 
-extern "C" int camera_stop(cira_ctx* ctx) {
+extern "C" int camera_stop(cira_ctx* ctx, int camera) {
     (void)ctx;
+    (void)camera;
     return CIRA_ERROR;
 }
 
@@ -0,0 +1,382 @@
+/**
+ * CiRA Runtime - V4L2 Capture
+ *
+ * Single-planar V4L2 streaming I/O with mmap'd driver buffers. Every
+ * buffer is queued at start; capture_v4l2_next() dequeues one and
+ * capture_v4l2_release() queues it again. The count of buffers held by
+ * the pipeline is tracked so capture waits instead of polling a device
+ * with an empty queue.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "capture_v4l2.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+const char* capture_format_name(int format) {
+    switch (format) {
+        case CAPTURE_FORMAT_YUYV:  return "yuyv";
+        case CAPTURE_FORMAT_MJPEG: return "mjpeg";
+        default:                   return "unknown";
+    }
+}
+
+static inline uint8_t clamp_u8(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+void capture_yuyv_to_rgb(const uint8_t* src, int stride, int width, int height, uint8_t* dst) {
+    for (int y = 0; y < height; y++) {
+        const uint8_t* s = src + (size_t)y * stride;
+        uint8_t* d = dst + (size_t)y * width * 3;
+
+        /* Two pixels share one U/V pair; integer BT.601 limited range */
+        for (int x = 0; x + 1 < width; x += 2, s += 4, d += 6) {
+            int c0 = 298 * (s[0] - 16);
+            int c1 = 298 * (s[2] - 16);
+            int u = s[1] - 128;
+            int v = s[3] - 128;
+            int r = 409 * v + 128;
+            int g = -100 * u - 208 * v + 128;
+            int b = 516 * u + 128;
+
+            d[0] = clamp_u8((c0 + r) >> 8);
+            d[1] = clamp_u8((c0 + g) >> 8);
+            d[2] = clamp_u8((c0 + b) >> 8);
+            d[3] = clamp_u8((c1 + r) >> 8);
+            d[4] = clamp_u8((c1 + g) >> 8);
+            d[5] = clamp_u8((c1 + b) >> 8);
+        }
+
+        /* Odd width: the last pixel is the first half of a padded pair */
+        if (width & 1) {
+            int c0 = 298 * (s[0] - 16);
+            int u = s[1] - 128;
+            int v = s[3] - 128;
+            d[0] = clamp_u8((c0 + 409 * v + 128) >> 8);
+            d[1] = clamp_u8((c0 - 100 * u - 208 * v + 128) >> 8);
+            d[2] = clamp_u8((c0 + 516 * u + 128) >> 8);
+        }
+    }
+}
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+struct capture_v4l2 {
+    int fd;
+    char device[64];
+    int format;                 /* CAPTURE_FORMAT_* */
+    int width;
+    int height;
+    int stride;
+    int num_buffers;
+    int held;                   /* Buffers dequeued and not yet released (atomic) */
+    struct {
+        uint8_t* data;
+        size_t length;
+    } buffers[CAPTURE_MAX_BUFFERS];
+};
+
+/* ioctl retried across signals */
+static int xioctl(int fd, unsigned long request, void* arg) {
+    int r;
+    do {
+        r = ioctl(fd, request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+}
+
+static uint32_t format_fourcc(int format) {
+    return format == CAPTURE_FORMAT_MJPEG ? V4L2_PIX_FMT_MJPEG : V4L2_PIX_FMT_YUYV;
+}
+
+/* Ask for a format; returns 1 if the driver accepted the pixel format */
+static int set_format(int fd, int format, int width, int height, struct v4l2_format* fmt) {
+    memset(fmt, 0, sizeof(*fmt));
+    fmt->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt->fmt.pix.width = (uint32_t)width;
+    fmt->fmt.pix.height = (uint32_t)height;
+    fmt->fmt.pix.pixelformat = format_fourcc(format);
+    fmt->fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(fd, VIDIOC_S_FMT, fmt) == -1) return 0;
+    return fmt->fmt.pix.pixelformat == format_fourcc(format);
+}
+
+/* Pick YUYV (no decode) unless the driver shrinks it below what MJPEG gives */
+static int negotiate_format(int fd, int width, int height, int format, struct v4l2_format* fmt) {
+    if (format != CAPTURE_PREFER_AUTO) {
+        return set_format(fd, format, width, height, fmt) ? format : -1;
+    }
+
+    struct v4l2_format yuyv;
+    int have_yuyv = set_format(fd, CAPTURE_FORMAT_YUYV, width, height, &yuyv);
+    if (have_yuyv && (int)yuyv.fmt.pix.width >= width && (int)yuyv.fmt.pix.height >= height) {
+        *fmt = yuyv;
+        return CAPTURE_FORMAT_YUYV;
+    }
+
+    struct v4l2_format mjpeg;
+    if (set_format(fd, CAPTURE_FORMAT_MJPEG, width, height, &mjpeg) &&
+        (!have_yuyv || mjpeg.fmt.pix.width * mjpeg.fmt.pix.height >
+                       yuyv.fmt.pix.width * yuyv.fmt.pix.height)) {
+        *fmt = mjpeg;
+        return CAPTURE_FORMAT_MJPEG;
+    }
+
+    if (have_yuyv && set_format(fd, CAPTURE_FORMAT_YUYV, width, height, fmt)) {
+        return CAPTURE_FORMAT_YUYV;
+    }
+    return -1;
+}
+
+static void unmap_buffers(capture_v4l2_t* cap) {
+    for (int i = 0; i < cap->num_buffers; i++) {
+        if (cap->buffers[i].data) {
+            munmap(cap->buffers[i].data, cap->buffers[i].length);
+            cap->buffers[i].data = NULL;
+        }
+    }
+    cap->num_buffers = 0;
+}
+
+capture_v4l2_t* capture_v4l2_open(const char* device, int width, int height, int fps,
+                                  int buffers, int format) {
+    if (!device || width <= 0 || height <= 0) return NULL;
+
+    int fd = open(device, O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        fprintf(stderr, "V4L2: cannot open %s: %s\n", device, strerror(errno));
+        return NULL;
+    }
+
+    struct v4l2_capability caps;
+    memset(&caps, 0, sizeof(caps));
+    if (xioctl(fd, VIDIOC_QUERYCAP, &caps) == -1) {
+        fprintf(stderr, "V4L2: %s is not a V4L2 device\n", device);
+        close(fd);
+        return NULL;
+    }
+    uint32_t dev_caps = (caps.capabilities & V4L2_CAP_DEVICE_CAPS) ? caps.device_caps
+                                                                   : caps.capabilities;
+    if (!(dev_caps & V4L2_CAP_VIDEO_CAPTURE) || !(dev_caps & V4L2_CAP_STREAMING)) {
+        fprintf(stderr, "V4L2: %s has no single-planar streaming capture\n", device);
+        close(fd);
+        return NULL;
+    }
+
+    struct v4l2_format fmt;
+    int chosen = negotiate_format(fd, width, height, format, &fmt);
+    if (chosen < 0) {
+        fprintf(stderr, "V4L2: %s supports neither YUYV nor MJPEG at %dx%d\n",
+                device, width, height);
+        close(fd);
+        return NULL;
+    }
+
+    if (fps > 0) {
+        struct v4l2_streamparm parm;
+        memset(&parm, 0, sizeof(parm));
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        parm.parm.capture.timeperframe.numerator = 1;
+        parm.parm.capture.timeperframe.denominator = (uint32_t)fps;
+        xioctl(fd, VIDIOC_S_PARM, &parm);   /* Best effort: keep the default rate */
+    }
+
+    if (buffers < CAPTURE_MIN_BUFFERS) buffers = CAPTURE_MIN_BUFFERS;
+    if (buffers > CAPTURE_MAX_BUFFERS) buffers = CAPTURE_MAX_BUFFERS;
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = (uint32_t)buffers;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_REQBUFS, &req) == -1 || req.count < CAPTURE_MIN_BUFFERS) {
+        fprintf(stderr, "V4L2: %s cannot allocate mmap buffers\n", device);
+        close(fd);
+        return NULL;
+    }
+    if (req.count > CAPTURE_MAX_BUFFERS) req.count = CAPTURE_MAX_BUFFERS;
+
+    capture_v4l2_t* cap = (capture_v4l2_t*)calloc(1, sizeof(capture_v4l2_t));
+    if (!cap) {
+        close(fd);
+        return NULL;
+    }
+    cap->fd = fd;
+    snprintf(cap->device, sizeof(cap->device), "%s", device);
+    cap->format = chosen;
+    cap->width = (int)fmt.fmt.pix.width;
+    cap->height = (int)fmt.fmt.pix.height;
+    cap->stride = fmt.fmt.pix.bytesperline ? (int)fmt.fmt.pix.bytesperline : cap->width * 2;
+
+    int queued = 0;
+    for (uint32_t i = 0; i < req.count; i++) {
+        struct v4l2_buffer b;
+        memset(&b, 0, sizeof(b));
+        b.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        b.memory = V4L2_MEMORY_MMAP;
+        b.index = i;
+        if (xioctl(fd, VIDIOC_QUERYBUF, &b) == -1) break;
+
+        void* data = mmap(NULL, b.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, b.m.offset);
+        if (data == MAP_FAILED) break;
+        cap->buffers[i].data = (uint8_t*)data;
+        cap->buffers[i].length = b.length;
+        cap->num_buffers++;     /* Mapped, so unmapped on failure */
+
+        if (xioctl(fd, VIDIOC_QBUF, &b) == -1) break;
+        queued++;
+    }
+
+    /* Every buffer must be both mapped and queued before streaming */
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (queued != (int)req.count || xioctl(fd, VIDIOC_STREAMON, &type) == -1) {
+        fprintf(stderr, "V4L2: %s failed to start streaming: %s\n", device, strerror(errno));
+        unmap_buffers(cap);
+        close(fd);
+        free(cap);
+        return NULL;
+    }
+
+    fprintf(stderr, "V4L2: %s streaming %s %dx%d, %d mmap buffers\n",
+            device, capture_format_name(cap->format), cap->width, cap->height, cap->num_buffers);
+    return cap;
+}
+
+void capture_v4l2_close(capture_v4l2_t* cap) {
+    if (!cap) return;
+
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(cap->fd, VIDIOC_STREAMOFF, &type);
+    unmap_buffers(cap);
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(cap->fd, VIDIOC_REQBUFS, &req);
+
+    close(cap->fd);
+    free(cap);
+}
+
+int capture_v4l2_next(capture_v4l2_t* cap, capture_buffer_t* buf, int timeout_ms) {
+    if (!cap || !buf) return -1;
+
+    /* With nothing queued the driver would report an error, not wait */
+    if (__atomic_load_n(&cap->held, __ATOMIC_ACQUIRE) >= cap->num_buffers) return 0;
+
+    struct pollfd pfd = { cap->fd, POLLIN, 0 };
+    int r = poll(&pfd, 1, timeout_ms);
+    if (r == 0 || (r < 0 && errno == EINTR)) return 0;
+    if (r < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+        /* Every buffer may have been taken between the check and the poll */
+        if (__atomic_load_n(&cap->held, __ATOMIC_ACQUIRE) >= cap->num_buffers) return 0;
+        return -1;
+    }
+
+    struct v4l2_buffer b;
+    memset(&b, 0, sizeof(b));
+    b.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    b.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(cap->fd, VIDIOC_DQBUF, &b) == -1) {
+        return errno == EAGAIN ? 0 : -1;
+    }
+    if (b.index >= (uint32_t)cap->num_buffers) return -1;
+
+    /* Corrupt or empty frames go straight back */
+    if ((b.flags & V4L2_BUF_FLAG_ERROR) || b.bytesused == 0) {
+        xioctl(cap->fd, VIDIOC_QBUF, &b);
+        return 0;
+    }
+
+    __atomic_add_fetch(&cap->held, 1, __ATOMIC_ACQ_REL);
+    buf->index = (int)b.index;
+    buf->data = cap->buffers[b.index].data;
+    buf->size = b.bytesused;
+    buf->format = cap->format;
+    buf->width = cap->width;
+    buf->height = cap->height;
+    buf->stride = cap->stride;
+    buf->timestamp_us = (uint64_t)b.timestamp.tv_sec * 1000000ULL + (uint64_t)b.timestamp.tv_usec;
+    return 1;
+}
+
+void capture_v4l2_release(capture_v4l2_t* cap, int index) {
+    if (!cap || index < 0 || index >= cap->num_buffers) return;
+
+    struct v4l2_buffer b;
+    memset(&b, 0, sizeof(b));
+    b.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    b.memory = V4L2_MEMORY_MMAP;
+    b.index = (uint32_t)index;
+    if (xioctl(cap->fd, VIDIOC_QBUF, &b) == -1) {
+        fprintf(stderr, "V4L2: %s failed to requeue buffer %d: %s\n",
+                cap->device, index, strerror(errno));
+    }
+    __atomic_sub_fetch(&cap->held, 1, __ATOMIC_ACQ_REL);
+}
+
+int capture_v4l2_format(const capture_v4l2_t* cap) {
+    return cap ? cap->format : -1;
+}
+
+void capture_v4l2_size(const capture_v4l2_t* cap, int* width, int* height) {
+    if (width) *width = cap ? cap->width : 0;
+    if (height) *height = cap ? cap->height : 0;
+}
+
+int capture_v4l2_buffers(const capture_v4l2_t* cap) {
+    return cap ? cap->num_buffers : 0;
+}
+
+#else /* __linux__ */
+
+/* No V4L2: cameras use OpenCV capture */
+
+capture_v4l2_t* capture_v4l2_open(const char* device, int width, int height, int fps,
+                                  int buffers, int format) {
+    (void)device; (void)width; (void)height; (void)fps; (void)buffers; (void)format;
+    return NULL;
+}
+
+void capture_v4l2_close(capture_v4l2_t* cap) {
+    (void)cap;
+}
+
+int capture_v4l2_next(capture_v4l2_t* cap, capture_buffer_t* buf, int timeout_ms) {
+    (void)cap; (void)buf; (void)timeout_ms;
+    return -1;
+}
+
+void capture_v4l2_release(capture_v4l2_t* cap, int index) {
+    (void)cap; (void)index;
+}
+
+int capture_v4l2_format(const capture_v4l2_t* cap) {
+    (void)cap;
+    return -1;
+}
+
+void capture_v4l2_size(const capture_v4l2_t* cap, int* width, int* height) {
+    (void)cap;
+    if (width) *width = 0;
+    if (height) *height = 0;
+}
+
+int capture_v4l2_buffers(const capture_v4l2_t* cap) {
+    (void)cap;
+    return 0;
+}
+
+#endif /* __linux__ */
@@ -9,6 +9,11 @@
 
 #include "cira.h"
 #include "cira_internal.h"
+#include "frame_queue.h"
+#include "frame_ring.h"
+#include "result_log.h"
+#include "onnx_providers.h"
+#include "capture_v4l2.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -18,6 +23,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <time.h>
+#include <errno.h>
 
 /* Version string */
 #define CIRA_VERSION_STRING "1.0.0"
@@ -33,23 +39,31 @@ extern int darknet_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int
 extern int onnx_load(cira_ctx* ctx, const char* model_path);
 extern void onnx_unload(cira_ctx* ctx);
 extern int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
+extern int onnx_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                              int w, int h, int channels);
 #endif
 
 #ifdef CIRA_TRT_ENABLED
 extern int trt_load(cira_ctx* ctx, const char* model_path);
 extern void trt_unload(cira_ctx* ctx);
 extern int trt_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
+extern int trt_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                             int w, int h, int channels);
 #endif
 
 #ifdef CIRA_NCNN_ENABLED
 extern int ncnn_load(cira_ctx* ctx, const char* model_path);
 extern void ncnn_unload(cira_ctx* ctx);
 extern int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels);
+extern int ncnn_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                              int w, int h, int channels);
 #endif
 
 #ifdef CIRA_STREAMING_ENABLED
-extern int camera_start(cira_ctx* ctx, int device_id);
-extern int camera_stop(cira_ctx* ctx);
+#include "jpeg_cache.h"
+#include "jpeg_encoder.h"
+extern int camera_start(cira_ctx* ctx, int camera, int device_id);
+extern int camera_stop(cira_ctx* ctx, int camera);
 extern int server_start(cira_ctx* ctx, int port);
 extern int server_stop(cira_ctx* ctx);
 #endif
@@ -65,6 +79,15 @@ void cira_set_error(cira_ctx* ctx, const char* fmt, ...) {
     ctx->status = CIRA_STATUS_ERROR;
 }
 
+void cira_pin_thread(cira_ctx* ctx, cpu_class_t cls) {
+    cpu_mask_t mask = ctx->cpu_masks[cls];
+    if (cpu_affinity_set_self(mask) != 0) {
+        char cpus[128];
+        cpu_mask_format(mask, cpus, sizeof(cpus));
+        fprintf(stderr, "CPU: cannot pin %s thread to %s\n", cpu_class_name(cls), cpus);
+    }
+}
+
 int cira_add_detection(cira_ctx* ctx, float x, float y, float w, float h,
                         float confidence, int label_id) {
     if (!ctx || ctx->num_detections >= CIRA_MAX_DETECTIONS) return 0;
@@ -102,38 +125,26 @@ const char* cira_get_label(cira_ctx* ctx, int label_id) {
 void cira_store_frame(cira_ctx* ctx, const uint8_t* data, int w, int h) {
     if (!ctx || !data) return;
 
-    pthread_mutex_lock(&ctx->frame_mutex);
-
-    int size = w * h * 3;
-
-    /* Reallocate if size changed */
-    if (ctx->frame_size != size) {
-        if (ctx->frame_buffer) {
-            free(ctx->frame_buffer);
-        }
-        ctx->frame_buffer = (uint8_t*)malloc(size);
-        ctx->frame_size = size;
-    }
-
-    if (ctx->frame_buffer) {
-        memcpy(ctx->frame_buffer, data, size);
-        ctx->frame_w = w;
-        ctx->frame_h = h;
-    }
+    /* Never blocks: if every slot is held by readers the frame is dropped */
+    frame_slot_t* slot;
+    uint8_t* buf = frame_store_begin_write(ctx->frame_store, w, h, &slot);
+    if (!buf) return;
 
-    pthread_mutex_unlock(&ctx->frame_mutex);
+    memcpy(buf, data, (size_t)w * h * 3);
+    frame_store_commit(ctx->frame_store, slot, 0);
 }
 
-const uint8_t* cira_get_frame(cira_ctx* ctx, int* w, int* h) {
-    if (!ctx || !ctx->frame_buffer) {
+const uint8_t* cira_acquire_frame(cira_ctx* ctx, int* w, int* h, uint64_t* seq,
+                                  frame_slot_t** slot) {
+    frame_slot_t* s = ctx ? frame_store_acquire(ctx->frame_store) : NULL;
+    if (slot) *slot = s;
+    if (!s) {
         if (w) *w = 0;
         if (h) *h = 0;
+        if (seq) *seq = 0;
         return NULL;
     }
-
-    if (w) *w = ctx->frame_w;
-    if (h) *h = ctx->frame_h;
-    return ctx->frame_buffer;
+    return frame_slot_data(s, w, h, seq);
 }
 
 /* === Private Helper Functions === */
@@ -235,6 +246,26 @@ static int json_get_int(const char* json, const char* key, int* out) {
     return 1;
 }
 
+static int json_get_bool(const char* json, const char* key, int* out) {
+    char pattern[128];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+
+    const char* pos = strstr(json, pattern);
+    if (!pos) return 0;
+
+    pos += strlen(pattern);
+    while (*pos && (*pos == ' ' || *pos == ':' || *pos == '\t')) pos++;
+
+    if (strncmp(pos, "true", 4) == 0) {
+        *out = 1;
+    } else if (strncmp(pos, "false", 5) == 0) {
+        *out = 0;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
 static int json_get_float(const char* json, const char* key, float* out) {
     char pattern[128];
     snprintf(pattern, sizeof(pattern), "\"%s\"", key);
@@ -322,6 +353,59 @@ static int load_model_manifest(cira_ctx* ctx, const char* model_dir) {
         fprintf(stderr, "Manifest: nms_threshold=%.2f\n", nms);
     }
 
+    int letterbox = 0;
+    if (json_get_bool(json, "letterbox", &letterbox)) {
+        ctx->letterbox = letterbox;
+        fprintf(stderr, "Manifest: letterbox=%s\n", letterbox ? "true" : "false");
+    }
+
+    char precision[16] = {0};
+    if (json_get_string(json, "precision", precision, sizeof(precision))) {
+        if (strcmp(precision, "fp32") == 0) {
+            ctx->precision = CIRA_PRECISION_FP32;
+        } else if (strcmp(precision, "fp16") == 0) {
+            ctx->precision = CIRA_PRECISION_FP16;
+        } else if (strcmp(precision, "int8") == 0) {
+            ctx->precision = CIRA_PRECISION_INT8;
+        } else if (strcmp(precision, "auto") != 0) {
+            fprintf(stderr, "Manifest: unknown precision '%s', using backend default\n", precision);
+        }
+        fprintf(stderr, "Manifest: precision=%s\n", cira_precision_name(ctx->precision));
+    }
+
+    /* Calibration data is recorded, not used: quantized models arrive
+     * calibrated (ncnn2int8 table, ONNX QDQ scales, INT8 engines) */
+    char calibration[512] = {0};
+    if (json_get_string(json, "calibration", calibration, sizeof(calibration)) && calibration[0]) {
+        if (calibration[0] == '/') {
+            snprintf(ctx->calibration_path, sizeof(ctx->calibration_path), "%s", calibration);
+        } else {
+            snprintf(ctx->calibration_path, sizeof(ctx->calibration_path), "%s/%s",
+                     model_dir, calibration);
+        }
+        fprintf(stderr, "Manifest: calibration=%s%s\n", ctx->calibration_path,
+                file_exists(ctx->calibration_path) ? "" : " (missing)");
+        if (ctx->precision == CIRA_PRECISION_FP32 || ctx->precision == CIRA_PRECISION_FP16) {
+            fprintf(stderr, "Manifest: calibration given for a %s model\n",
+                    cira_precision_name(ctx->precision));
+        }
+    }
+
+    /* ONNX execution providers, best first: a spec string, since the
+     * manifest reader has no arrays (see onnx_providers.h) */
+    char providers[256] = {0};
+    if (json_get_string(json, "execution_providers", providers, sizeof(providers)) &&
+        providers[0]) {
+        onnx_provider_list_t list;
+        char err[128];
+        if (onnx_providers_parse(providers, &list, err, sizeof(err)) == 0) {
+            onnx_providers_format(&list, ctx->model_providers, sizeof(ctx->model_providers));
+            fprintf(stderr, "Manifest: execution_providers=%s\n", ctx->model_providers);
+        } else {
+            fprintf(stderr, "Manifest: execution_providers ignored: %s\n", err);
+        }
+    }
+
     int num_classes = 0;
     if (json_get_int(json, "num_classes", &num_classes) && num_classes > 0) {
         fprintf(stderr, "Manifest: num_classes=%d\n", num_classes);
@@ -332,8 +416,17 @@ static int load_model_manifest(cira_ctx* ctx, const char* model_dir) {
     return 1;
 }
 
-/* Detect model format from path */
-static cira_format_t detect_format(const char* path) {
+const char* cira_precision_name(cira_precision_t precision) {
+    switch (precision) {
+        case CIRA_PRECISION_FP32: return "fp32";
+        case CIRA_PRECISION_FP16: return "fp16";
+        case CIRA_PRECISION_INT8: return "int8";
+        default: return "auto";
+    }
+}
+
+/* Detect model format from path (exported via cira_internal.h) */
+cira_format_t cira_detect_format(const char* path) {
     if (is_directory(path)) {
         /* Check for Darknet files in directory */
         char buf[1024];
@@ -380,15 +473,28 @@ static cira_format_t detect_format(const char* path) {
     return CIRA_FORMAT_UNKNOWN;
 }
 
-/* Build JSON result string */
-static void build_result_json(cira_ctx* ctx, int img_w, int img_h) {
-    char* p = ctx->result_json;
-    char* end = ctx->result_json + CIRA_MAX_JSON_LEN;
+/* Format name (exported via cira_internal.h) */
+const char* cira_format_name(cira_format_t format) {
+    switch (format) {
+        case CIRA_FORMAT_DARKNET:  return "darknet";
+        case CIRA_FORMAT_NCNN:     return "ncnn";
+        case CIRA_FORMAT_ONNX:     return "onnx";
+        case CIRA_FORMAT_TENSORRT: return "tensorrt";
+        case CIRA_FORMAT_SKLEARN:  return "sklearn";
+        default:                   return "unknown";
+    }
+}
+
+/* Build a result JSON string into a CIRA_MAX_JSON_LEN buffer */
+static void build_result_json(cira_ctx* ctx, const cira_detection_t* dets, const int* track_ids,
+                              int count, int img_w, int img_h, char* out) {
+    char* p = out;
+    char* end = out + CIRA_MAX_JSON_LEN;
 
     p += snprintf(p, end - p, "{\"detections\":[");
 
-    for (int i = 0; i < ctx->num_detections && p < end - 256; i++) {
-        cira_detection_t* det = &ctx->detections[i];
+    for (int i = 0; i < count && p < end - 256; i++) {
+        const cira_detection_t* det = &dets[i];
 
         /* Convert normalized coords to pixel coords */
         int px = (int)(det->x * img_w);
@@ -402,11 +508,538 @@ static void build_result_json(cira_ctx* ctx, int img_w, int img_h) {
 
         if (i > 0) p += snprintf(p, end - p, ",");
         p += snprintf(p, end - p,
-            "{\"label\":\"%s\",\"confidence\":%.3f,\"bbox\":[%d,%d,%d,%d]}",
+            "{\"label\":\"%s\",\"confidence\":%.3f,\"bbox\":[%d,%d,%d,%d]",
             label, det->confidence, px, py, pw, ph);
+        if (track_ids) {
+            p += snprintf(p, end - p, ",\"track_id\":%d", track_ids[i]);
+        }
+        p += snprintf(p, end - p, "}");
+    }
+
+    p += snprintf(p, end - p, "],\"count\":%d}", count);
+}
+
+/* Copy detections in as the context result (caller holds result_mutex) */
+static void publish_result(cira_ctx* ctx, const cira_detection_t* dets, int count,
+                           int img_w, int img_h) {
+    memcpy(ctx->result_detections, dets, count * sizeof(cira_detection_t));
+    ctx->result_num_detections = count;
+    ctx->result_w = img_w;
+    ctx->result_h = img_h;
+    ctx->result_camera = -1;
+    ctx->result_frame_seq = ctx->total_frames;
+    ctx->result_json_stale = 1;
+    ctx->result_tracked = 0;
+}
+
+/* Publish the backend's detections as the context result (exported via cira_internal.h) */
+void cira_result_changed(cira_ctx* ctx, int img_w, int img_h) {
+    publish_result(ctx, ctx->detections, ctx->num_detections, img_w, img_h);
+}
+
+/* Latest result JSON, built on demand (exported via cira_internal.h) */
+const char* cira_result_json_locked(cira_ctx* ctx, int camera) {
+    if (camera < 0) {
+        if (ctx->result_json_stale) {
+            double t0 = cira_time_ms();
+            build_result_json(ctx, ctx->result_detections,
+                              ctx->result_tracked ? ctx->track_ids : NULL,
+                              ctx->result_num_detections,
+                              ctx->result_w, ctx->result_h, ctx->result_json);
+            ctx->result_json_stale = 0;
+            latency_hist_record(ctx->latency[CIRA_LATENCY_RESULT_JSON], cira_time_ms() - t0);
+        }
+        return ctx->result_json;
+    }
+
+    cira_camera_t* cam = &ctx->cameras[camera];
+    if (!cam->result_json) return "{\"detections\":[],\"count\":0}";
+    if (cam->result_json_stale) {
+        double t0 = cira_time_ms();
+        build_result_json(ctx, cam->detections, cam->result_tracked ? cam->track_ids : NULL,
+                          cam->num_detections, cam->result_w, cam->result_h, cam->result_json);
+        cam->result_json_stale = 0;
+        latency_hist_record(ctx->latency[CIRA_LATENCY_RESULT_JSON], cira_time_ms() - t0);
+    }
+    return cam->result_json;
+}
+
+/* Latest result in binary form (exported via cira_internal.h) */
+int cira_result_raw_locked(cira_ctx* ctx, int camera, void* buf, int size) {
+    const cira_detection_t* dets = ctx->result_detections;
+    int count = ctx->result_num_detections;
+    cira_result_header_t hdr;
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.camera = ctx->result_camera;
+    hdr.width = (uint32_t)ctx->result_w;
+    hdr.height = (uint32_t)ctx->result_h;
+    hdr.frame_sequence = ctx->result_frame_seq;
+    if (camera >= 0) {
+        const cira_camera_t* cam = &ctx->cameras[camera];
+        dets = cam->detections;
+        count = cam->num_detections;
+        hdr.camera = camera;
+        hdr.width = (uint32_t)cam->result_w;
+        hdr.height = (uint32_t)cam->result_h;
+        hdr.frame_sequence = cam->result_frame_seq;
+    }
+
+    size_t need = sizeof(hdr) + (size_t)count * sizeof(cira_result_record_t);
+    if (!buf || size < 0 || (size_t)size < need) return CIRA_ERROR_MEMORY;
+
+    hdr.magic = CIRA_RESULT_MAGIC;
+    hdr.version = CIRA_RESULT_VERSION;
+    hdr.header_size = (uint16_t)sizeof(hdr);
+    hdr.result_sequence = ctx->result_sequence;
+    hdr.count = (uint32_t)count;
+    hdr.record_size = (uint32_t)sizeof(cira_result_record_t);
+    memcpy(buf, &hdr, sizeof(hdr));
+
+    /* cira_detection_t has the record layout */
+    memcpy((uint8_t*)buf + sizeof(hdr), dets, (size_t)count * sizeof(cira_result_record_t));
+    return (int)need;
+}
+
+/* The binary records are copied straight from the detection arrays */
+_Static_assert(sizeof(cira_result_record_t) == sizeof(cira_detection_t),
+               "cira_result_record_t must match cira_detection_t");
+_Static_assert(CIRA_RESULT_MAX_RECORDS == CIRA_MAX_DETECTIONS,
+               "CIRA_RESULT_MAX_RECORDS must match CIRA_MAX_DETECTIONS");
+_Static_assert(sizeof(cira_result_header_t) == 48, "cira_result_header_t layout");
+
+/* Add the newest result to the history (caller holds result_mutex) */
+static void history_append(cira_ctx* ctx, cira_camera_t* cam, uint64_t frame_seq) {
+    if (ctx->result_history <= 0) return;
+
+    if (!ctx->result_log) {
+        ctx->result_log = result_log_create(ctx->result_history, ctx->result_history_sec);
+        if (!ctx->result_log) {
+            fprintf(stderr, "Result history: out of memory, disabled\n");
+            ctx->result_history = 0;
+            return;
+        }
+        if (ctx->result_log_path[0]) {
+            result_log_open_segment(ctx->result_log, ctx->result_log_path,
+                                    (size_t)ctx->result_log_mb * 1024 * 1024);
+        }
+    }
+
+    /* cira_detection_t has the record layout */
+    const cira_detection_t* dets = cam ? cam->detections : ctx->result_detections;
+    result_log_append(ctx->result_log, ctx->result_sequence, result_log_now_ms(),
+                      cam ? cam->index : -1, frame_seq,
+                      cam ? cam->result_w : ctx->result_w, cam ? cam->result_h : ctx->result_h,
+                      (const cira_result_record_t*)dets,
+                      cam ? cam->num_detections : ctx->result_num_detections);
+}
+
+/* Count a new result and push it to subscribers (caller holds result_mutex) */
+static void notify_result(cira_ctx* ctx, cira_camera_t* cam, uint64_t frame_seq) {
+    ctx->result_sequence++;
+    history_append(ctx, cam, frame_seq);
+    if (ctx->result_notify) {
+        ctx->result_notify(ctx->result_notify_arg, ctx, cam, frame_seq);
+    }
+}
+
+/* Store a camera's latest result (exported via cira_internal.h) */
+void cira_camera_store_result(cira_ctx* ctx, cira_camera_t* cam,
+                              const cira_detection_t* dets, int count, int img_w, int img_h,
+                              uint64_t frame_seq) {
+    cira_camera_store_tracks(ctx, cam, dets, NULL, count, img_w, img_h, frame_seq, 1);
+}
+
+/* Store a camera result, with track IDs or without (exported via cira_internal.h) */
+void cira_camera_store_tracks(cira_ctx* ctx, cira_camera_t* cam,
+                              const cira_detection_t* dets, const int* track_ids, int count,
+                              int img_w, int img_h, uint64_t frame_seq, int inferred) {
+    if (dets != cam->detections) {
+        memcpy(cam->detections, dets, count * sizeof(cira_detection_t));
+    }
+    cam->num_detections = count;
+    if (track_ids) {
+        memcpy(cam->track_ids, track_ids, count * sizeof(int));
+    }
+    cam->result_tracked = track_ids != NULL;
+    if (inferred) {
+        cam->total_frames++;
+        cam->total_detections += count;
+    }
+
+    /* JSON is built when someone reads it (cira_result_json_locked) */
+    cam->result_w = img_w;
+    cam->result_h = img_h;
+    cam->result_frame_seq = frame_seq;
+    cam->result_json_stale = 1;
+
+    /* Camera 0 is the context's single-camera result */
+    if (cam->index == 0) {
+        memcpy(ctx->result_detections, dets, count * sizeof(cira_detection_t));
+        ctx->result_num_detections = count;
+        if (track_ids) {
+            memcpy(ctx->track_ids, track_ids, count * sizeof(int));
+        }
+        ctx->result_tracked = track_ids != NULL;
+        ctx->result_w = img_w;
+        ctx->result_h = img_h;
+        ctx->result_camera = 0;
+        ctx->result_frame_seq = frame_seq;
+        ctx->result_json_stale = 1;
+    }
+
+    notify_result(ctx, cam, frame_seq);
+}
+
+/* Store the current detections as the next batch image (exported via cira_internal.h) */
+int cira_batch_store(cira_ctx* ctx, int img_w, int img_h) {
+    if (!ctx || ctx->batch_scratch_count >= ctx->batch_scratch_capacity) return 0;
+
+    cira_batch_result_t* r = &ctx->batch_scratch[ctx->batch_scratch_count];
+    memcpy(r->detections, ctx->detections, ctx->num_detections * sizeof(cira_detection_t));
+    r->num_detections = ctx->num_detections;
+    r->img_w = img_w;
+    r->img_h = img_h;
+
+    ctx->batch_scratch_count++;
+    return 1;
+}
+
+/* Grow a batch result array to hold count images */
+static int reserve_batch_results(cira_batch_result_t** results, int* capacity, int count) {
+    if (count <= *capacity) return CIRA_OK;
+
+    cira_batch_result_t* grown = (cira_batch_result_t*)realloc(
+        *results, count * sizeof(cira_batch_result_t));
+    if (!grown) return CIRA_ERROR_MEMORY;
+
+    memset(grown + *capacity, 0, (count - *capacity) * sizeof(cira_batch_result_t));
+    *results = grown;
+    *capacity = count;
+    return CIRA_OK;
+}
+
+/* Copy the scratch batch into the cira_batch_*() results; the last image
+ * becomes the context result (caller holds model_mutex and result_mutex) */
+static int publish_batch(cira_ctx* ctx) {
+    int count = ctx->batch_scratch_count;
+    ctx->batch_count = 0;
+    if (reserve_batch_results(&ctx->batch_results, &ctx->batch_capacity, count) != CIRA_OK) {
+        return CIRA_ERROR_MEMORY;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const cira_batch_result_t* src = &ctx->batch_scratch[i];
+        cira_batch_result_t* r = &ctx->batch_results[i];
+        memcpy(r->detections, src->detections, src->num_detections * sizeof(cira_detection_t));
+        r->num_detections = src->num_detections;
+        r->img_w = src->img_w;
+        r->img_h = src->img_h;
+        r->json_stale = 1;      /* r->json keeps its buffer */
+    }
+    ctx->batch_count = count;
+
+    if (count > 0) {
+        const cira_batch_result_t* last = &ctx->batch_scratch[count - 1];
+        publish_result(ctx, last->detections, last->num_detections, last->img_w, last->img_h);
+    }
+    return CIRA_OK;
+}
+
+static cira_batch_result_t* get_batch_result(cira_ctx* ctx, int image) {
+    if (!ctx || image < 0 || image >= ctx->batch_count) return NULL;
+    return &ctx->batch_results[image];
+}
+
+/* === Asynchronous predicts === */
+
+/* A cira_predict_image_async() call */
+struct cira_request {
+    cira_ctx* ctx;
+    struct cira_request* next;      /* Queue link (async_mutex) */
+    uint8_t* image;                 /* Copy of the caller's frame, freed once inferred */
+    int w, h, channels;
+    cira_request_callback callback;
+    void* user_data;
+
+    pthread_mutex_t mutex;          /* Guards status, refs and json */
+    pthread_cond_t done_cond;
+    int status;                     /* CIRA_PENDING until complete */
+    int refs;                       /* Caller's handle and the queue's */
+    cira_detection_t detections[CIRA_MAX_DETECTIONS];   /* Set before status, then fixed */
+    int num_detections;
+    char* json;                     /* Built on first cira_request_json() */
+};
+
+/*
+ * Run one API image and store it as the context result. Backends reuse
+ * preallocated buffers, so one predict at a time under model_mutex. The
+ * backend decodes into ctx->detections, which is scratch: readers only see
+ * the copy cira_result_changed() publishes under result_mutex (same lock
+ * order as the camera inference stage: model, then result), so the lock
+ * readers take is held for the copy, not the predict. The detections are
+ * also copied to req when given.
+ */
+static int predict_publish(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels,
+                           cira_request* req) {
+    pthread_mutex_lock(&ctx->model_mutex);
+    if (ctx->format == CIRA_FORMAT_UNKNOWN || !ctx->model_handle) {
+        pthread_mutex_unlock(&ctx->model_mutex);
+        return CIRA_ERROR_MODEL;
+    }
+
+    ctx->num_detections = 0;
+    int result = cira_backend_predict(ctx, data, w, h, channels);
+
+    if (result == CIRA_OK) {
+        if (req) {
+            memcpy(req->detections, ctx->detections,
+                   ctx->num_detections * sizeof(cira_detection_t));
+            req->num_detections = ctx->num_detections;
+        }
+
+        pthread_mutex_lock(&ctx->result_mutex);
+        ctx->total_frames++;
+        cira_result_changed(ctx, w, h);
+        notify_result(ctx, NULL, ctx->total_frames);
+        pthread_mutex_unlock(&ctx->result_mutex);
+    }
+
+    pthread_mutex_unlock(&ctx->model_mutex);
+    return result;
+}
+
+static void request_unref(cira_request* req) {
+    pthread_mutex_lock(&req->mutex);
+    int refs = --req->refs;
+    pthread_mutex_unlock(&req->mutex);
+    if (refs > 0) return;
+
+    pthread_mutex_destroy(&req->mutex);
+    pthread_cond_destroy(&req->done_cond);
+    free(req->image);
+    free(req->json);
+    free(req);
+}
+
+/* Publish the final status, run the callback and drop the queue's reference */
+static void request_complete(cira_request* req, int status) {
+    free(req->image);
+    req->image = NULL;
+
+    pthread_mutex_lock(&req->mutex);
+    req->status = status;
+    pthread_cond_broadcast(&req->done_cond);
+    pthread_mutex_unlock(&req->mutex);
+
+    if (req->callback) {
+        req->callback(req, req->user_data);
     }
+    request_unref(req);
+}
+
+/* Runs queued requests in order; on stop, fails whatever is still queued */
+static void* predict_async_thread(void* arg) {
+    cira_ctx* ctx = (cira_ctx*)arg;
+    cira_pin_thread(ctx, CPU_CLASS_INFERENCE);
+
+    pthread_mutex_lock(&ctx->async_mutex);
+    for (;;) {
+        while (!ctx->async_head && !ctx->async_stopping) {
+            pthread_cond_wait(&ctx->async_cond, &ctx->async_mutex);
+        }
+        cira_request* req = ctx->async_head;
+        if (!req) break;
+
+        ctx->async_head = req->next;
+        if (!ctx->async_head) ctx->async_tail = NULL;
+        ctx->async_queued--;
+        int stopping = ctx->async_stopping;
+        pthread_mutex_unlock(&ctx->async_mutex);
+
+        int result = stopping ? CIRA_ERROR
+                              : predict_publish(ctx, req->image, req->w, req->h, req->channels, req);
+        request_complete(req, result);
+
+        pthread_mutex_lock(&ctx->async_mutex);
+        ctx->async_completed++;
+    }
+    pthread_mutex_unlock(&ctx->async_mutex);
+    return NULL;
+}
+
+/* Fail queued requests and join the worker (cira_destroy) */
+static void predict_async_stop(cira_ctx* ctx) {
+    pthread_mutex_lock(&ctx->async_mutex);
+    ctx->async_stopping = 1;
+    pthread_cond_signal(&ctx->async_cond);
+    int started = ctx->async_started;
+    ctx->async_started = 0;
+    pthread_mutex_unlock(&ctx->async_mutex);
+
+    if (started) {
+        pthread_join(ctx->async_thread, NULL);
+    }
+}
+
+cira_request* cira_predict_image_async(cira_ctx* ctx, const uint8_t* data, int w, int h,
+                                       int channels, cira_request_callback callback,
+                                       void* user_data) {
+    if (!ctx) return NULL;
+
+    /* Refusals are transient, so they leave the context status alone */
+    if (!data || w <= 0 || h <= 0 || channels != 3) {
+        snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                 "Async predict needs a 3-channel image of positive size");
+        return NULL;
+    }
+    if (ctx->status != CIRA_STATUS_READY) {
+        snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "Runtime not ready");
+        return NULL;
+    }
+    if (ctx->format == CIRA_FORMAT_UNKNOWN || !ctx->model_handle) {
+        snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "No model loaded");
+        return NULL;
+    }
+
+    size_t bytes = (size_t)w * h * channels;
+    cira_request* req = (cira_request*)calloc(1, sizeof(cira_request));
+    uint8_t* image = (uint8_t*)malloc(bytes);
+    if (!req || !image) {
+        free(req);
+        free(image);
+        snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "Out of memory for async predict");
+        return NULL;
+    }
+    memcpy(image, data, bytes);
+
+    req->ctx = ctx;
+    req->image = image;
+    req->w = w;
+    req->h = h;
+    req->channels = channels;
+    req->callback = callback;
+    req->user_data = user_data;
+    req->status = CIRA_PENDING;
+    req->refs = 2;
+    pthread_mutex_init(&req->mutex, NULL);
+    pthread_cond_init(&req->done_cond, NULL);
+
+    const char* refused = NULL;
+    pthread_mutex_lock(&ctx->async_mutex);
+    if (ctx->async_stopping) {
+        refused = "Context is being destroyed";
+    } else if (ctx->async_queued >= ctx->async_queue_depth) {
+        ctx->async_rejected++;
+        refused = "Async predict queue full";
+    } else if (!ctx->async_started) {
+        /* Worker starts with the first request */
+        if (pthread_create(&ctx->async_thread, NULL, predict_async_thread, ctx) == 0) {
+            ctx->async_started = 1;
+        } else {
+            refused = "Failed to start the async predict worker";
+        }
+    }
+    if (!refused) {
+        if (ctx->async_tail) {
+            ctx->async_tail->next = req;
+        } else {
+            ctx->async_head = req;
+        }
+        ctx->async_tail = req;
+        ctx->async_queued++;
+        pthread_cond_signal(&ctx->async_cond);
+    }
+    pthread_mutex_unlock(&ctx->async_mutex);
+
+    if (refused) {
+        snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "%s", refused);
+        req->refs = 1;
+        request_unref(req);
+        return NULL;
+    }
+    return req;
+}
+
+int cira_request_status(cira_request* req) {
+    if (!req) return CIRA_ERROR_INPUT;
+    pthread_mutex_lock(&req->mutex);
+    int status = req->status;
+    pthread_mutex_unlock(&req->mutex);
+    return status;
+}
+
+int cira_request_wait(cira_request* req, int timeout_ms) {
+    if (!req) return CIRA_ERROR_INPUT;
+
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&req->mutex);
+    while (req->status == CIRA_PENDING) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&req->done_cond, &req->mutex);
+        } else if (pthread_cond_timedwait(&req->done_cond, &req->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    int status = req->status;
+    pthread_mutex_unlock(&req->mutex);
+    return status;
+}
+
+int cira_request_count(cira_request* req) {
+    if (cira_request_status(req) != CIRA_OK) return 0;
+    return req->num_detections;
+}
+
+int cira_request_detection(cira_request* req, int index, cira_result_record_t* out) {
+    if (!out || cira_request_status(req) != CIRA_OK) return CIRA_ERROR;
+    if (index < 0 || index >= req->num_detections) return CIRA_ERROR;
+
+    const cira_detection_t* det = &req->detections[index];
+    out->x = det->x;
+    out->y = det->y;
+    out->w = det->w;
+    out->h = det->h;
+    out->confidence = det->confidence;
+    out->label_id = det->label_id;
+    return CIRA_OK;
+}
 
-    p += snprintf(p, end - p, "],\"count\":%d}", ctx->num_detections);
+const char* cira_request_json(cira_request* req) {
+    if (!req) return NULL;
+
+    pthread_mutex_lock(&req->mutex);
+    if (req->status == CIRA_OK && !req->json) {
+        char* json = (char*)malloc(CIRA_MAX_JSON_LEN);
+        if (json) {
+            /* Labels only change under result_mutex */
+            pthread_mutex_lock(&req->ctx->result_mutex);
+            build_result_json(req->ctx, req->detections, NULL, req->num_detections,
+                              req->w, req->h, json);
+            pthread_mutex_unlock(&req->ctx->result_mutex);
+
+            /* Keep only what the result needs */
+            char* shrunk = (char*)realloc(json, strlen(json) + 1);
+            req->json = shrunk ? shrunk : json;
+        }
+    }
+    const char* json = req->json;
+    pthread_mutex_unlock(&req->mutex);
+    return json;
+}
+
+void cira_request_release(cira_request* req) {
+    if (req) request_unref(req);
 }
 
 /* === Public API Implementation === */
@@ -419,25 +1052,86 @@ cira_ctx* cira_create(void) {
     cira_ctx* ctx = (cira_ctx*)calloc(1, sizeof(cira_ctx));
     if (!ctx) return NULL;
 
+    ctx->frame_store = frame_store_create(CIRA_FRAME_STORE_SLOTS);
+    if (!ctx->frame_store) {
+        free(ctx);
+        return NULL;
+    }
+
+#ifdef CIRA_STREAMING_ENABLED
+    ctx->jpeg_cache = jpeg_cache_create();
+    if (!ctx->jpeg_cache) {
+        frame_store_destroy(ctx->frame_store);
+        free(ctx);
+        return NULL;
+    }
+#endif
+
+    /* Metrics only: a histogram that failed to allocate records nothing */
+    for (int i = 0; i < CIRA_CTX_LATENCIES; i++) {
+        ctx->latency[i] = latency_hist_create();
+    }
+
     ctx->status = CIRA_STATUS_READY;
     ctx->format = CIRA_FORMAT_UNKNOWN;
     ctx->confidence_threshold = 0.5f;
     ctx->nms_threshold = 0.4f;
     ctx->yolo_version = YOLO_VERSION_AUTO;
+    ctx->letterbox = -1;
     ctx->input_w = 416;
     ctx->input_h = 416;
 
     pthread_mutex_init(&ctx->result_mutex, NULL);
-    pthread_mutex_init(&ctx->frame_mutex, NULL);
     pthread_mutex_init(&ctx->model_mutex, NULL);
+    pthread_mutex_init(&ctx->load_mutex, NULL);
+    pthread_mutex_init(&ctx->load_async_mutex, NULL);
+    pthread_cond_init(&ctx->load_async_cond, NULL);
     pthread_mutex_init(&ctx->frame_file_mutex, NULL);
     ctx->model_swapping = 0;
+    pthread_mutex_init(&ctx->camera_mutex, NULL);
     ctx->current_camera = -1;  /* No camera active initially */
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        ctx->cameras[i].index = i;
+        ctx->cameras[i].device_id = -1;
+    }
+    /* Camera 0 streams through the context store (single-camera endpoints) */
+    ctx->cameras[0].frame_store = ctx->frame_store;
+    ctx->cameras[0].jpeg_cache = ctx->jpeg_cache;
+    ctx->camera_schedule = CIRA_SCHEDULE_BATCH;
+    ctx->camera_backend = CIRA_CAPTURE_AUTO;
+    ctx->camera_format = CAPTURE_PREFER_AUTO;
+    ctx->camera_width = CIRA_CAMERA_DEFAULT_WIDTH;
+    ctx->camera_height = CIRA_CAMERA_DEFAULT_HEIGHT;
+    ctx->camera_fps = 0;
+    ctx->gate_threshold = 0.0f;
+    ctx->gate_max_skip_ms = CIRA_GATE_DEFAULT_MAX_SKIP_MS;
+    ctx->tracker_enabled = 0;
+    ctx->tracker_interval = 1;
+    ctx->tracker_high_threshold = 0.5f;
+    ctx->pipeline_queue_depth = CIRA_PIPELINE_DEFAULT_DEPTH;
+    ctx->pipeline_drop_policy = FRAME_QUEUE_DROP_OLDEST;
+    ctx->video_config.codec = VIDEO_CODEC_H264;
+    strcpy(ctx->video_config.backend, "auto");
+    ctx->video_config.bitrate_kbps = CIRA_VIDEO_DEFAULT_BITRATE;
+    ctx->video_config.gop = CIRA_VIDEO_DEFAULT_GOP;
+    ctx->batch_max_size = CIRA_BATCH_DEFAULT_SIZE;
+    pthread_mutex_init(&ctx->async_mutex, NULL);
+    pthread_cond_init(&ctx->async_cond, NULL);
+    ctx->async_queue_depth = CIRA_ASYNC_DEFAULT_DEPTH;
+    ctx->server_mode = CIRA_SERVER_EVENT;
+    ctx->server_threads = CIRA_SERVER_DEFAULT_THREADS;
+    ctx->frame_ring_format = -1;
+    ctx->frame_ring_slots = CIRA_FRAME_RING_DEFAULT_SLOTS;
+    pthread_mutex_init(&ctx->frame_ring_mutex, NULL);
+    ctx->result_history = CIRA_RESULT_HISTORY_DEFAULT;
+    ctx->result_history_sec = CIRA_RESULT_HISTORY_SEC_DEFAULT;
+    ctx->result_log_mb = CIRA_RESULT_LOG_DEFAULT_MB;
     ctx->frame_sequence = 0;
     ctx->frame_file_path[0] = '\0';
 
     /* Initialize empty result JSON */
     strcpy(ctx->result_json, "{\"detections\":[],\"count\":0}");
+    ctx->result_camera = -1;
 
     /* Initialize cumulative statistics */
     ctx->total_detections = 0;
@@ -448,22 +1142,8 @@ cira_ctx* cira_create(void) {
     return ctx;
 }
 
-void cira_destroy(cira_ctx* ctx) {
-    if (!ctx) return;
-
-    /* Stop streaming if running */
-    if (ctx->camera_running) {
-#ifdef CIRA_STREAMING_ENABLED
-        camera_stop(ctx);
-#endif
-    }
-    if (ctx->server_running) {
-#ifdef CIRA_STREAMING_ENABLED
-        server_stop(ctx);
-#endif
-    }
-
-    /* Unload model */
+/* Unload whatever model the context holds */
+static void unload_backend(cira_ctx* ctx) {
     switch (ctx->format) {
 #ifdef CIRA_DARKNET_ENABLED
         case CIRA_FORMAT_DARKNET:
@@ -488,15 +1168,86 @@ void cira_destroy(cira_ctx* ctx) {
         default:
             break;
     }
+    ctx->format = CIRA_FORMAT_UNKNOWN;
+    ctx->model_handle = NULL;
+}
+
+void cira_destroy(cira_ctx* ctx) {
+    if (!ctx) return;
+
+    /* Let a background load finish before tearing anything down */
+    pthread_mutex_lock(&ctx->load_async_mutex);
+    while (ctx->load_pending) {
+        pthread_cond_wait(&ctx->load_async_cond, &ctx->load_async_mutex);
+    }
+    if (ctx->load_thread_started) {
+        pthread_join(ctx->load_thread, NULL);
+        ctx->load_thread_started = 0;
+    }
+    pthread_mutex_unlock(&ctx->load_async_mutex);
+
+    /* Fail queued async predicts while the model is still loaded */
+    predict_async_stop(ctx);
+
+    /* Stop streaming if running */
+    if (ctx->camera_running) {
+#ifdef CIRA_STREAMING_ENABLED
+        camera_stop(ctx, -1);
+#endif
+    }
+    if (ctx->server_running) {
+#ifdef CIRA_STREAMING_ENABLED
+        server_stop(ctx);
+#endif
+    }
+
+    /* Unload model */
+    unload_backend(ctx);
+
+    /* Cameras are stopped, so nothing publishes any more */
+    frame_ring_destroy(ctx->frame_ring);
+    pthread_mutex_destroy(&ctx->frame_ring_mutex);
+    result_log_destroy(ctx->result_log);
+
+    /* Cameras 1+ own their stores; camera 0 uses the context's */
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        cira_camera_t* cam = &ctx->cameras[i];
+        if (i > 0) {
+#ifdef CIRA_STREAMING_ENABLED
+            jpeg_cache_destroy(cam->jpeg_cache);
+#endif
+            frame_store_destroy(cam->frame_store);
+        }
+        video_encoder_destroy(cam->video);
+        free(cam->result_json);
+        for (int j = 0; j < CIRA_CAMERA_LATENCIES; j++) {
+            latency_hist_destroy(cam->latency[j]);
+        }
+    }
+    for (int i = 0; i < CIRA_CTX_LATENCIES; i++) {
+        latency_hist_destroy(ctx->latency[i]);
+    }
 
-    if (ctx->frame_buffer) {
-        free(ctx->frame_buffer);
+#ifdef CIRA_STREAMING_ENABLED
+    jpeg_cache_destroy(ctx->jpeg_cache);
+#endif
+    frame_store_destroy(ctx->frame_store);
+
+    for (int i = 0; i < ctx->batch_capacity; i++) {
+        free(ctx->batch_results[i].json);
     }
+    free(ctx->batch_results);
+    free(ctx->batch_scratch);
 
     pthread_mutex_destroy(&ctx->result_mutex);
-    pthread_mutex_destroy(&ctx->frame_mutex);
     pthread_mutex_destroy(&ctx->model_mutex);
+    pthread_mutex_destroy(&ctx->load_mutex);
+    pthread_mutex_destroy(&ctx->load_async_mutex);
+    pthread_cond_destroy(&ctx->load_async_cond);
+    pthread_mutex_destroy(&ctx->async_mutex);
+    pthread_cond_destroy(&ctx->async_cond);
     pthread_mutex_destroy(&ctx->frame_file_mutex);
+    pthread_mutex_destroy(&ctx->camera_mutex);
 
     /* Clean up temp frame file */
     if (ctx->frame_file_path[0] != '\0') {
@@ -506,60 +1257,32 @@ void cira_destroy(cira_ctx* ctx) {
     free(ctx);
 }
 
-int cira_load(cira_ctx* ctx, const char* config_path) {
-    if (!ctx || !config_path) return CIRA_ERROR_INPUT;
+/* Monotonic milliseconds (exported via cira_internal.h) */
+double cira_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
 
-    ctx->status = CIRA_STATUS_LOADING;
+/* Read manifest and labels, then run the format-specific loader on ctx */
+static int load_backend(cira_ctx* ctx, const char* config_path) {
+    /* Detect model format */
+    cira_format_t format = cira_detect_format(config_path);
+    if (format == CIRA_FORMAT_UNKNOWN) {
+        cira_set_error(ctx, "Unknown model format: %s", config_path);
+        return CIRA_ERROR_MODEL;
+    }
 
-    /* Signal that model swap is in progress (camera thread will pause inference) */
-    ctx->model_swapping = 1;
+    strncpy(ctx->model_path, config_path, sizeof(ctx->model_path) - 1);
+    ctx->model_name[0] = '\0';  /* Reset model name before loading manifest */
 
-    /* Lock model mutex to wait for any in-progress inference to complete */
-    pthread_mutex_lock(&ctx->model_mutex);
-
-    /* If already loaded, unload first */
-    if (ctx->format != CIRA_FORMAT_UNKNOWN) {
-        fprintf(stderr, "Unloading previous model before loading new one...\n");
-        switch (ctx->format) {
-#ifdef CIRA_DARKNET_ENABLED
-            case CIRA_FORMAT_DARKNET:
-                darknet_unload(ctx);
-                break;
-#endif
-#ifdef CIRA_ONNX_ENABLED
-            case CIRA_FORMAT_ONNX:
-                onnx_unload(ctx);
-                break;
-#endif
-#ifdef CIRA_TRT_ENABLED
-            case CIRA_FORMAT_TENSORRT:
-                trt_unload(ctx);
-                break;
-#endif
-#ifdef CIRA_NCNN_ENABLED
-            case CIRA_FORMAT_NCNN:
-                ncnn_unload(ctx);
-                break;
-#endif
-            default:
-                break;
-        }
-        ctx->format = CIRA_FORMAT_UNKNOWN;
-        ctx->model_handle = NULL;
-    }
-
-    /* Detect model format */
-    cira_format_t format = detect_format(config_path);
-    if (format == CIRA_FORMAT_UNKNOWN) {
-        cira_set_error(ctx, "Unknown model format: %s", config_path);
-        return CIRA_ERROR_MODEL;
-    }
-
-    strncpy(ctx->model_path, config_path, sizeof(ctx->model_path) - 1);
-    ctx->model_name[0] = '\0';  /* Reset model name before loading manifest */
-
-    /* Initialize YOLO version to auto-detect */
-    ctx->yolo_version = YOLO_VERSION_AUTO;
+    /* Initialize YOLO version to auto-detect */
+    ctx->yolo_version = YOLO_VERSION_AUTO;
+    ctx->letterbox = -1;
+    ctx->precision = CIRA_PRECISION_AUTO;
+    ctx->calibration_path[0] = '\0';
+    ctx->model_providers[0] = '\0';
+    ctx->execution_provider[0] = '\0';
 
     /* Try to load manifest and labels */
     if (is_directory(config_path)) {
@@ -606,34 +1329,247 @@ int cira_load(cira_ctx* ctx, const char* config_path) {
 
     if (result == CIRA_OK) {
         ctx->format = format;
-        ctx->status = CIRA_STATUS_READY;
     }
+    return result;
+}
 
-    /* Unlock and clear swapping flag (inference can resume) */
-    pthread_mutex_unlock(&ctx->model_mutex);
-    ctx->model_swapping = 0;
+/* Validate a freshly loaded model with one inference on a gray frame.
+ * Also pays the backend's first-run costs (lazy allocation, kernel
+ * selection) before the model serves real frames. */
+static int warm_up_model(cira_ctx* ctx) {
+    if (!ctx->model_handle || ctx->input_w <= 0 || ctx->input_h <= 0) {
+        cira_set_error(ctx, "Model loaded without a usable input size");
+        return CIRA_ERROR_MODEL;
+    }
 
-    fprintf(stderr, "Model swap complete, inference can resume\n");
+    size_t bytes = (size_t)ctx->input_w * ctx->input_h * 3;
+    uint8_t* image = (uint8_t*)malloc(bytes);
+    if (!image) {
+        cira_set_error(ctx, "Failed to allocate warm-up frame");
+        return CIRA_ERROR_MEMORY;
+    }
+    memset(image, 114, bytes);
+
+    ctx->num_detections = 0;
+    ctx->error_msg[0] = '\0';
+    int result = cira_backend_predict(ctx, image, ctx->input_w, ctx->input_h, 3);
+    free(image);
+
+    if (result != CIRA_OK) {
+        char reason[CIRA_MAX_ERROR_LEN];
+        snprintf(reason, sizeof(reason), "%s", ctx->error_msg[0] ? ctx->error_msg : "backend error");
+        cira_set_error(ctx, "Warm-up inference failed: %.400s", reason);
+    }
     return result;
 }
 
-int cira_predict_image(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
-    if (!ctx || !data) return CIRA_ERROR_INPUT;
-    if (ctx->status != CIRA_STATUS_READY) return CIRA_ERROR;
-    if (channels != 3) {
-        cira_set_error(ctx, "Only 3-channel images supported");
-        return CIRA_ERROR_INPUT;
+static void swap_bytes(void* a, void* b, size_t n) {
+    uint8_t* pa = (uint8_t*)a;
+    uint8_t* pb = (uint8_t*)b;
+    uint8_t tmp[256];
+    while (n > 0) {
+        size_t chunk = n < sizeof(tmp) ? n : sizeof(tmp);
+        memcpy(tmp, pa, chunk);
+        memcpy(pa, pb, chunk);
+        memcpy(pb, tmp, chunk);
+        pa += chunk;
+        pb += chunk;
+        n -= chunk;
     }
-    if (ctx->format == CIRA_FORMAT_UNKNOWN || !ctx->model_handle) {
-        cira_set_error(ctx, "No model loaded");
-        return CIRA_ERROR_MODEL;
+}
+
+/* Format pending result JSON with the labels of the model that produced
+ * it (caller holds result_mutex) */
+static void build_stale_results(cira_ctx* ctx) {
+    cira_result_json_locked(ctx, -1);
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        cira_result_json_locked(ctx, i);
+    }
+    for (int i = 0; i < ctx->batch_count; i++) {
+        cira_batch_result_t* r = &ctx->batch_results[i];
+        if (r->json_stale && r->json) {
+            build_result_json(ctx, r->detections, NULL, r->num_detections, r->img_w, r->img_h, r->json);
+            r->json_stale = 0;
+        }
     }
+}
 
-    pthread_mutex_lock(&ctx->result_mutex);
+/* Exchange the loaded model and everything read with it (manifest, labels,
+ * input size) between two contexts. Keep in sync with the model fields of
+ * struct cira_ctx. */
+static void swap_model_state(cira_ctx* a, cira_ctx* b) {
+#define SWAP_MEMBER(m) swap_bytes(&a->m, &b->m, sizeof(a->m))
+    SWAP_MEMBER(format);
+    SWAP_MEMBER(model_path);
+    SWAP_MEMBER(model_name);
+    SWAP_MEMBER(model_handle);
+    SWAP_MEMBER(labels);
+    SWAP_MEMBER(num_labels);
+    SWAP_MEMBER(input_w);
+    SWAP_MEMBER(input_h);
+    SWAP_MEMBER(confidence_threshold);
+    SWAP_MEMBER(nms_threshold);
+    SWAP_MEMBER(yolo_version);
+    SWAP_MEMBER(letterbox);
+    SWAP_MEMBER(precision);
+    SWAP_MEMBER(calibration_path);
+    SWAP_MEMBER(model_providers);
+    SWAP_MEMBER(execution_provider);
+#undef SWAP_MEMBER
+}
 
-    ctx->num_detections = 0;
+/* Camera frames that went without inference so far (skipped or dropped at a queue) */
+static uint64_t frames_not_inferred(const cira_ctx* ctx) {
+    uint64_t total = ctx->skipped_frames;
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        for (int s = 0; s < CIRA_PIPELINE_STAGES; s++) {
+            total += ctx->cameras[i].stage_stats[s].dropped;
+        }
+    }
+    return total;
+}
+
+/*
+ * Loads are double-buffered: the new model is built and warmed up in a
+ * loader-only context while the current one keeps serving, then the two
+ * swap their model state under model_mutex. Every inference holds
+ * model_mutex, so taking it waits for in-flight work on the old model to
+ * drain; once released nothing can reach the old model and it is unloaded
+ * outside the lock.
+ */
+int cira_load(cira_ctx* ctx, const char* config_path) {
+    if (!ctx || !config_path) return CIRA_ERROR_INPUT;
+
+    /* One load at a time */
+    pthread_mutex_lock(&ctx->load_mutex);
+
+    int prev_status = ctx->status;
+    if (ctx->format == CIRA_FORMAT_UNKNOWN) {
+        ctx->status = CIRA_STATUS_LOADING;
+    }
+    ctx->model_swapping = 1;
+    uint64_t missed_before = frames_not_inferred(ctx);
+    double t0 = cira_time_ms();
+
+    /* Staging context: settings only, no mutexes, cameras or stores */
+    cira_ctx* stage = (cira_ctx*)calloc(1, sizeof(cira_ctx));
+    int result;
+    if (!stage) {
+        cira_set_error(ctx, "Failed to allocate model staging context");
+        result = CIRA_ERROR_MEMORY;
+    } else {
+        stage->status = CIRA_STATUS_LOADING;
+        stage->format = CIRA_FORMAT_UNKNOWN;
+        stage->confidence_threshold = ctx->confidence_threshold;
+        stage->nms_threshold = ctx->nms_threshold;
+        stage->input_w = ctx->input_w;
+        stage->input_h = ctx->input_h;
+        stage->batch_max_size = ctx->batch_max_size;
+        memcpy(stage->model_cache_dir, ctx->model_cache_dir, sizeof(stage->model_cache_dir));
+        memcpy(stage->cpu_masks, ctx->cpu_masks, sizeof(stage->cpu_masks));
+        memcpy(stage->onnx_providers, ctx->onnx_providers, sizeof(stage->onnx_providers));
+
+        fprintf(stderr, "Staging model %s (current model keeps serving)\n", config_path);
+
+        /* Load on the inference CPUs: backend thread pools created now
+         * (ONNX Runtime intra-op threads, NCNN's OpenMP team) inherit them */
+        cpu_mask_t caller_mask = cpu_affinity_get_self();
+        cira_pin_thread(ctx, CPU_CLASS_INFERENCE);
+        result = load_backend(stage, config_path);
+        double t_loaded = cira_time_ms();
+        if (result == CIRA_OK) {
+            result = warm_up_model(stage);
+        }
+        ctx->reload_warmup_ms = cira_time_ms() - t_loaded;
+        if (ctx->cpu_masks[CPU_CLASS_INFERENCE]) {
+            cpu_affinity_set_self(caller_mask);
+        }
+
+        if (result == CIRA_OK) {
+            /* Publish: same lock order as the inference paths */
+            double t_swap = cira_time_ms();
+            pthread_mutex_lock(&ctx->model_mutex);
+            pthread_mutex_lock(&ctx->result_mutex);
+            build_stale_results(ctx);
+            swap_model_state(ctx, stage);
+            ctx->status = CIRA_STATUS_READY;
+            pthread_mutex_unlock(&ctx->result_mutex);
+            pthread_mutex_unlock(&ctx->model_mutex);
+            ctx->reload_swap_us = (cira_time_ms() - t_swap) * 1000.0;
+
+            if (stage->format != CIRA_FORMAT_UNKNOWN) {
+                fprintf(stderr, "Retiring previous model %s\n", stage->model_path);
+            }
+        } else {
+            cira_set_error(ctx, "%s", stage->error_msg);
+            ctx->status = prev_status;
+        }
+
+        /* The old model after a swap, or the rejected new one */
+        unload_backend(stage);
+        free(stage);
+    }
+
+    ctx->reload_ms = cira_time_ms() - t0;
+    uint64_t missed = frames_not_inferred(ctx);
+    ctx->reload_dropped_frames = missed > missed_before ? missed - missed_before : 0;
+    if (result == CIRA_OK) {
+        ctx->reload_count++;
+        fprintf(stderr, "Model swap complete: %.0f ms load, %.0f us swap, %llu frames dropped\n",
+                ctx->reload_ms, ctx->reload_swap_us,
+                (unsigned long long)ctx->reload_dropped_frames);
+    } else {
+        ctx->reload_failures++;
+        fprintf(stderr, "Model load failed, keeping current model: %s\n", ctx->error_msg);
+    }
+    ctx->model_swapping = 0;
+
+    pthread_mutex_unlock(&ctx->load_mutex);
+    return result;
+}
+
+static void* load_async_thread(void* arg) {
+    cira_ctx* ctx = (cira_ctx*)arg;
+    cira_load(ctx, ctx->load_async_path);
+
+    pthread_mutex_lock(&ctx->load_async_mutex);
+    ctx->load_pending = 0;
+    pthread_cond_broadcast(&ctx->load_async_cond);
+    pthread_mutex_unlock(&ctx->load_async_mutex);
+    return NULL;
+}
+
+int cira_load_async(cira_ctx* ctx, const char* config_path) {
+    if (!ctx || !config_path) return CIRA_ERROR_INPUT;
+
+    pthread_mutex_lock(&ctx->load_async_mutex);
+    if (ctx->load_pending) {
+        pthread_mutex_unlock(&ctx->load_async_mutex);
+        cira_set_error(ctx, "A model load is already in progress");
+        return CIRA_ERROR;
+    }
+    if (ctx->load_thread_started) {
+        pthread_join(ctx->load_thread, NULL);
+        ctx->load_thread_started = 0;
+    }
 
+    snprintf(ctx->load_async_path, sizeof(ctx->load_async_path), "%s", config_path);
+    ctx->load_pending = 1;
+    if (pthread_create(&ctx->load_thread, NULL, load_async_thread, ctx) != 0) {
+        ctx->load_pending = 0;
+        pthread_mutex_unlock(&ctx->load_async_mutex);
+        cira_set_error(ctx, "Failed to start model loader thread");
+        return CIRA_ERROR;
+    }
+    ctx->load_thread_started = 1;
+    pthread_mutex_unlock(&ctx->load_async_mutex);
+    return CIRA_OK;
+}
+
+/* Dispatch to format-specific predict (exported via cira_internal.h) */
+int cira_backend_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
     int result;
+    memset(&ctx->predict_timing, 0, sizeof(ctx->predict_timing));
     switch (ctx->format) {
 #ifdef CIRA_DARKNET_ENABLED
         case CIRA_FORMAT_DARKNET:
@@ -656,16 +1592,85 @@ int cira_predict_image(cira_ctx* ctx, const uint8_t* data, int w, int h, int cha
             break;
 #endif
         default:
+            (void)data; (void)w; (void)h; (void)channels;
             result = CIRA_ERROR_MODEL;
             break;
     }
 
-    if (result == CIRA_OK) {
-        build_result_json(ctx, w, h);
-        ctx->total_frames++;
+    /* Loaders that time their stages fill predict_timing */
+    const cira_predict_timing_t* t = &ctx->predict_timing;
+    if (result == CIRA_OK && t->inference_ms > 0.0) {
+        latency_hist_record(ctx->latency[CIRA_LATENCY_PREDICT_PREPROCESS], t->preprocess_ms);
+        latency_hist_record(ctx->latency[CIRA_LATENCY_PREDICT_INFERENCE], t->inference_ms);
+        latency_hist_record(ctx->latency[CIRA_LATENCY_PREDICT_DECODE], t->decode_ms);
     }
+    return result;
+}
 
-    pthread_mutex_unlock(&ctx->result_mutex);
+/* Run one backend batch call, storing a result per image */
+static int backend_call_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                                 int w, int h, int channels) {
+    switch (ctx->format) {
+#ifdef CIRA_ONNX_ENABLED
+        case CIRA_FORMAT_ONNX:
+            return onnx_predict_batch(ctx, images, count, w, h, channels);
+#endif
+#ifdef CIRA_TRT_ENABLED
+        case CIRA_FORMAT_TENSORRT:
+            return trt_predict_batch(ctx, images, count, w, h, channels);
+#endif
+#ifdef CIRA_NCNN_ENABLED
+        case CIRA_FORMAT_NCNN:
+            return ncnn_predict_batch(ctx, images, count, w, h, channels);
+#endif
+        default:
+            break;
+    }
+
+    /* No batch path: run the images one at a time */
+    for (int i = 0; i < count; i++) {
+        ctx->num_detections = 0;
+        int result = cira_backend_predict(ctx, images[i], w, h, channels);
+        if (result != CIRA_OK) return result;
+        cira_batch_store(ctx, w, h);
+    }
+    return CIRA_OK;
+}
+
+/* Batch predict for library and camera callers (exported via cira_internal.h) */
+int cira_backend_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                               int w, int h, int channels) {
+    ctx->batch_scratch_count = 0;
+    if (reserve_batch_results(&ctx->batch_scratch, &ctx->batch_scratch_capacity,
+                              count) != CIRA_OK) {
+        return CIRA_ERROR_MEMORY;
+    }
+
+    int result = CIRA_OK;
+    for (int start = 0; start < count && result == CIRA_OK; start += ctx->batch_max_size) {
+        int n = count - start;
+        if (n > ctx->batch_max_size) n = ctx->batch_max_size;
+        result = backend_call_batch(ctx, images + start, n, w, h, channels);
+    }
+    return result;
+}
+
+int cira_predict_image(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
+    if (!ctx || !data) return CIRA_ERROR_INPUT;
+    if (ctx->status != CIRA_STATUS_READY) return CIRA_ERROR;
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel images supported");
+        return CIRA_ERROR_INPUT;
+    }
+    if (ctx->format == CIRA_FORMAT_UNKNOWN || !ctx->model_handle) {
+        cira_set_error(ctx, "No model loaded");
+        return CIRA_ERROR_MODEL;
+    }
+
+    int result = predict_publish(ctx, data, w, h, channels, NULL);
+    if (result == CIRA_ERROR_MODEL) {
+        cira_set_error(ctx, "No model loaded");
+    }
     return result;
 }
 
@@ -685,31 +1690,140 @@ int cira_predict_sensor(cira_ctx* ctx, const float* values, int count) {
 
 int cira_predict_batch(cira_ctx* ctx, const uint8_t** images, int count, int w, int h, int channels) {
     if (!ctx || !images || count <= 0) return CIRA_ERROR_INPUT;
-
-    /* For now, just process images one by one */
-    /* TODO: Implement true batch processing for supported backends */
     for (int i = 0; i < count; i++) {
-        int result = cira_predict_image(ctx, images[i], w, h, channels);
-        if (result != CIRA_OK) return result;
+        if (!images[i]) return CIRA_ERROR_INPUT;
+    }
+    if (ctx->status != CIRA_STATUS_READY) return CIRA_ERROR;
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel images supported");
+        return CIRA_ERROR_INPUT;
+    }
+    if (ctx->format == CIRA_FORMAT_UNKNOWN || !ctx->model_handle) {
+        cira_set_error(ctx, "No model loaded");
+        return CIRA_ERROR_MODEL;
     }
 
-    return CIRA_OK;
+    /* Readers wait for the copy, not the batch */
+    pthread_mutex_lock(&ctx->model_mutex);
+    int result = cira_backend_predict_batch(ctx, images, count, w, h, channels);
+
+    pthread_mutex_lock(&ctx->result_mutex);
+    ctx->total_frames += ctx->batch_scratch_count;
+    if (publish_batch(ctx) != CIRA_OK) {
+        result = CIRA_ERROR_MEMORY;
+    }
+    pthread_mutex_unlock(&ctx->result_mutex);
+    pthread_mutex_unlock(&ctx->model_mutex);
+
+    if (result == CIRA_ERROR_MEMORY) {
+        cira_set_error(ctx, "Failed to allocate batch results");
+    }
+    return result;
 }
 
 const char* cira_result_json(cira_ctx* ctx) {
     if (!ctx) return "{\"detections\":[],\"count\":0}";
-    return ctx->result_json;
+    pthread_mutex_lock(&ctx->result_mutex);
+    const char* json = cira_result_json_locked(ctx, -1);
+    pthread_mutex_unlock(&ctx->result_mutex);
+    return json;
+}
+
+int cira_result_raw(cira_ctx* ctx, int camera, void* buf, int size) {
+    if (!ctx || !buf || camera < -1 || camera >= CIRA_MAX_CAMERAS) return CIRA_ERROR_INPUT;
+    pthread_mutex_lock(&ctx->result_mutex);
+    int n = cira_result_raw_locked(ctx, camera, buf, size);
+    pthread_mutex_unlock(&ctx->result_mutex);
+    return n;
+}
+
+const char* cira_label(cira_ctx* ctx, int label_id) {
+    return cira_get_label(ctx, label_id);
+}
+
+int cira_label_count(cira_ctx* ctx) {
+    return ctx ? ctx->num_labels : 0;
+}
+
+/* Copy of the published detection at index (result_mutex taken here) */
+static int published_detection(cira_ctx* ctx, int index, cira_detection_t* det) {
+    pthread_mutex_lock(&ctx->result_mutex);
+    int ok = index >= 0 && index < ctx->result_num_detections;
+    if (ok) *det = ctx->result_detections[index];
+    pthread_mutex_unlock(&ctx->result_mutex);
+    return ok;
 }
 
 int cira_result_count(cira_ctx* ctx) {
     if (!ctx) return 0;
-    return ctx->num_detections;
+    pthread_mutex_lock(&ctx->result_mutex);
+    int count = ctx->result_num_detections;
+    pthread_mutex_unlock(&ctx->result_mutex);
+    return count;
 }
 
 int cira_result_bbox(cira_ctx* ctx, int index, float* x, float* y, float* w, float* h) {
-    if (!ctx || index < 0 || index >= ctx->num_detections) return CIRA_ERROR;
+    cira_detection_t det;
+    if (!ctx || !published_detection(ctx, index, &det)) return CIRA_ERROR;
+
+    if (x) *x = det.x;
+    if (y) *y = det.y;
+    if (w) *w = det.w;
+    if (h) *h = det.h;
+
+    return CIRA_OK;
+}
+
+float cira_result_score(cira_ctx* ctx, int index) {
+    cira_detection_t det;
+    if (!ctx || !published_detection(ctx, index, &det)) return -1.0f;
+    return det.confidence;
+}
 
-    cira_detection_t* det = &ctx->detections[index];
+const char* cira_result_label(cira_ctx* ctx, int index) {
+    cira_detection_t det;
+    if (!ctx || !published_detection(ctx, index, &det)) return NULL;
+
+    if (det.label_id >= 0 && det.label_id < ctx->num_labels) {
+        return ctx->labels[det.label_id];
+    }
+    return "unknown";
+}
+
+int cira_batch_count(cira_ctx* ctx) {
+    if (!ctx) return 0;
+    return ctx->batch_count;
+}
+
+const char* cira_batch_result_json(cira_ctx* ctx, int image) {
+    cira_batch_result_t* r = get_batch_result(ctx, image);
+    if (!r) return NULL;
+
+    /* Built on first read; the buffer is kept for later batches */
+    pthread_mutex_lock(&ctx->result_mutex);
+    if (r->json_stale || !r->json) {
+        if (!r->json) r->json = (char*)malloc(CIRA_MAX_JSON_LEN);
+        if (r->json) {
+            build_result_json(ctx, r->detections, NULL, r->num_detections, r->img_w, r->img_h, r->json);
+            r->json_stale = 0;
+        }
+    }
+    pthread_mutex_unlock(&ctx->result_mutex);
+    return r->json;
+}
+
+int cira_batch_result_count(cira_ctx* ctx, int image) {
+    cira_batch_result_t* r = get_batch_result(ctx, image);
+    if (!r) return 0;
+    return r->num_detections;
+}
+
+int cira_batch_result_bbox(cira_ctx* ctx, int image, int index,
+                           float* x, float* y, float* w, float* h) {
+    cira_batch_result_t* r = get_batch_result(ctx, image);
+    if (!r || index < 0 || index >= r->num_detections) return CIRA_ERROR;
+
+    cira_detection_t* det = &r->detections[index];
     if (x) *x = det->x;
     if (y) *y = det->y;
     if (w) *w = det->w;
@@ -718,21 +1832,552 @@ int cira_result_bbox(cira_ctx* ctx, int index, float* x, float* y, float* w, flo
     return CIRA_OK;
 }
 
-float cira_result_score(cira_ctx* ctx, int index) {
-    if (!ctx || index < 0 || index >= ctx->num_detections) return -1.0f;
-    return ctx->detections[index].confidence;
+float cira_batch_result_score(cira_ctx* ctx, int image, int index) {
+    cira_batch_result_t* r = get_batch_result(ctx, image);
+    if (!r || index < 0 || index >= r->num_detections) return -1.0f;
+    return r->detections[index].confidence;
 }
 
-const char* cira_result_label(cira_ctx* ctx, int index) {
-    if (!ctx || index < 0 || index >= ctx->num_detections) return NULL;
+const char* cira_batch_result_label(cira_ctx* ctx, int image, int index) {
+    cira_batch_result_t* r = get_batch_result(ctx, image);
+    if (!r || index < 0 || index >= r->num_detections) return NULL;
 
-    int label_id = ctx->detections[index].label_id;
+    int label_id = r->detections[index].label_id;
     if (label_id >= 0 && label_id < ctx->num_labels) {
         return ctx->labels[label_id];
     }
     return "unknown";
 }
 
+/* === Configuration === */
+
+/* Parse "x,y,w,h;..." into rois; returns the count, or -1 if malformed */
+static int parse_rois(const char* value, cira_roi_t* rois) {
+    int count = 0;
+    const char* p = value;
+    while (*p) {
+        cira_roi_t r;
+        int consumed = 0;
+        if (count >= CIRA_MAX_ROIS ||
+            sscanf(p, " %f , %f , %f , %f %n", &r.x, &r.y, &r.w, &r.h, &consumed) != 4) {
+            return -1;
+        }
+        if (r.x < 0.0f || r.y < 0.0f || r.w <= 0.0f || r.h <= 0.0f ||
+            r.x + r.w > 1.0001f || r.y + r.h > 1.0001f) {
+            return -1;
+        }
+        rois[count++] = r;
+        p += consumed;
+        if (*p == ';') {
+            p++;
+        } else if (*p) {
+            return -1;
+        }
+    }
+    return count;
+}
+
+/* Invalid options are reported via cira_error() without putting the
+ * context into the error state. */
+int cira_set_option(cira_ctx* ctx, const char* key, const char* value) {
+    if (!ctx || !key || !value) return CIRA_ERROR_INPUT;
+
+    if (strcmp(key, "pipeline.queue_depth") == 0) {
+        int depth = atoi(value);
+        if (depth < 1 || depth > FRAME_QUEUE_MAX_CAPACITY) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "pipeline.queue_depth must be 1-%d", FRAME_QUEUE_MAX_CAPACITY);
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->pipeline_queue_depth = depth;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "pipeline.drop_policy") == 0) {
+        if (strcmp(value, "drop_oldest") == 0) {
+            ctx->pipeline_drop_policy = FRAME_QUEUE_DROP_OLDEST;
+        } else if (strcmp(value, "drop_newest") == 0) {
+            ctx->pipeline_drop_policy = FRAME_QUEUE_DROP_NEWEST;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "pipeline.drop_policy must be drop_oldest or drop_newest");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "video.codec") == 0) {
+        if (strcmp(value, "h264") == 0) {
+            ctx->video_config.codec = VIDEO_CODEC_H264;
+        } else if (strcmp(value, "h265") == 0) {
+            ctx->video_config.codec = VIDEO_CODEC_H265;
+        } else if (strcmp(value, "off") == 0) {
+            ctx->video_config.codec = VIDEO_CODEC_OFF;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "video.codec must be h264, h265 or off");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "video.encoder") == 0) {
+        if (!video_backend_known(value)) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "video.encoder must be auto, nvenc, mpp, v4l2 or software");
+            return CIRA_ERROR_INPUT;
+        }
+        snprintf(ctx->video_config.backend, sizeof(ctx->video_config.backend), "%s", value);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "video.bitrate") == 0) {
+        int kbps = atoi(value);
+        if (kbps < 100 || kbps > CIRA_VIDEO_MAX_BITRATE) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "video.bitrate must be 100-%d (kbit/s)", CIRA_VIDEO_MAX_BITRATE);
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->video_config.bitrate_kbps = kbps;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "video.gop") == 0) {
+        int gop = atoi(value);
+        if (gop < 1 || gop > CIRA_VIDEO_MAX_GOP) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "video.gop must be 1-%d", CIRA_VIDEO_MAX_GOP);
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->video_config.gop = gop;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "batch.max_size") == 0) {
+        int size = atoi(value);
+        if (size < 1 || size > CIRA_BATCH_MAX_SIZE) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "batch.max_size must be 1-%d", CIRA_BATCH_MAX_SIZE);
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->batch_max_size = size;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "async.queue_depth") == 0) {
+        int depth = atoi(value);
+        if (depth < 1 || depth > CIRA_ASYNC_MAX_DEPTH) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "async.queue_depth must be 1-%d", CIRA_ASYNC_MAX_DEPTH);
+            return CIRA_ERROR_INPUT;
+        }
+        pthread_mutex_lock(&ctx->async_mutex);
+        ctx->async_queue_depth = depth;
+        pthread_mutex_unlock(&ctx->async_mutex);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "decode.threads") == 0) {
+        int automatic = strcmp(value, "auto") == 0;
+        int threads = automatic ? 0 : atoi(value);
+        if (!automatic && (threads < 1 || threads > CIRA_DECODE_MAX_THREADS)) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "decode.threads must be \"auto\" or 1-%d", CIRA_DECODE_MAX_THREADS);
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->decode_threads = threads;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "model.cache_dir") == 0) {
+        if (strlen(value) >= sizeof(ctx->model_cache_dir)) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "model.cache_dir must be under %d characters",
+                     (int)sizeof(ctx->model_cache_dir));
+            return CIRA_ERROR_INPUT;
+        }
+        strcpy(ctx->model_cache_dir, value);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "onnx.providers") == 0) {
+        onnx_provider_list_t list;
+        char err[128];
+        if (strlen(value) >= sizeof(ctx->onnx_providers)) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "onnx.providers must be under %d characters",
+                     (int)sizeof(ctx->onnx_providers));
+            return CIRA_ERROR_INPUT;
+        }
+        if (onnx_providers_parse(value, &list, err, sizeof(err)) != 0) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "onnx.providers: %s", err);
+            return CIRA_ERROR_INPUT;
+        }
+        /* Empty goes back to the manifest's list */
+        if (value[0]) {
+            onnx_providers_format(&list, ctx->onnx_providers, sizeof(ctx->onnx_providers));
+        } else {
+            ctx->onnx_providers[0] = '\0';
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "cpu.affinity") == 0) {
+        if (strcmp(value, "off") == 0) {
+            memset(ctx->cpu_masks, 0, sizeof(ctx->cpu_masks));
+        } else if (strcmp(value, "auto") == 0) {
+            const cpu_topology_t* topo = cpu_topology();
+            cpu_affinity_plan(topo, ctx->cpu_masks);
+            char big[128], little[128];
+            cpu_mask_format(topo->big, big, sizeof(big));
+            cpu_mask_format(topo->little, little, sizeof(little));
+            fprintf(stderr, "CPU: %d cores, big %s, little %s\n", topo->num_cpus, big,
+                    little[0] ? little : "none");
+            for (int i = 0; i < CPU_CLASSES; i++) {
+                char cpus[128];
+                cpu_mask_format(ctx->cpu_masks[i], cpus, sizeof(cpus));
+                fprintf(stderr, "CPU: %s threads on %s\n", cpu_class_name((cpu_class_t)i),
+                        cpus[0] ? cpus : "any core");
+            }
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "cpu.affinity must be off or auto");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    for (int i = 0; i < CPU_CLASSES; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "cpu.%s", cpu_class_name((cpu_class_t)i));
+        if (strcmp(key, name) != 0) continue;
+
+        if (cpu_mask_parse(value, cpu_topology(), &ctx->cpu_masks[i]) != 0) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "%s must be a CPU list (e.g. 0-3,6), all, big, little or none "
+                     "(%d CPUs)", name, cpu_topology()->num_cpus);
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "server.mode") == 0) {
+        if (strcmp(value, "event") == 0 || strcmp(value, "epoll") == 0) {
+            ctx->server_mode = CIRA_SERVER_EVENT;
+        } else if (strcmp(value, "threads") == 0) {
+            ctx->server_mode = CIRA_SERVER_THREADS;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "server.mode must be event or threads");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "server.threads") == 0) {
+        int threads = atoi(value);
+        if (threads < 1 || threads > CIRA_SERVER_MAX_THREADS) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "server.threads must be 1-%d", CIRA_SERVER_MAX_THREADS);
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->server_threads = threads;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "frame_ring") == 0) {
+        if (strcmp(value, "off") == 0) {
+            ctx->frame_ring_format = -1;
+        } else if (strcmp(value, "rgb") == 0) {
+            ctx->frame_ring_format = FRAME_RING_FORMAT_RGB24;
+        } else if (strcmp(value, "jpeg") == 0) {
+            ctx->frame_ring_format = FRAME_RING_FORMAT_JPEG;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "frame_ring must be off, rgb or jpeg");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "frame_ring.name") == 0) {
+        if (strlen(value) >= sizeof(ctx->frame_ring_name) || strchr(value, '/')) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "frame_ring.name must be under %d characters without '/'",
+                     (int)sizeof(ctx->frame_ring_name));
+            return CIRA_ERROR_INPUT;
+        }
+        strcpy(ctx->frame_ring_name, value);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "frame_ring.slots") == 0) {
+        int slots = atoi(value);
+        if (slots < FRAME_RING_MIN_SLOTS || slots > FRAME_RING_MAX_SLOTS) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "frame_ring.slots must be %d-%d", FRAME_RING_MIN_SLOTS, FRAME_RING_MAX_SLOTS);
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->frame_ring_slots = slots;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "frame_ring.slot_bytes") == 0) {
+        long bytes = atol(value);
+        if (bytes < 0 || bytes > 64L * 1024 * 1024) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "frame_ring.slot_bytes must be 0 (auto) to 64 MB");
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->frame_ring_bytes = (size_t)bytes;
+        return CIRA_OK;
+    }
+
+    /* A new history (and segment file) starts with the next result */
+    if (strcmp(key, "results.history") == 0) {
+        int results = atoi(value);
+        if (strcmp(value, "0") != 0 &&
+            (results < RESULT_LOG_MIN_RESULTS || results > RESULT_LOG_MAX_RESULTS)) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "results.history must be 0 (off) or %d-%d",
+                     RESULT_LOG_MIN_RESULTS, RESULT_LOG_MAX_RESULTS);
+            return CIRA_ERROR_INPUT;
+        }
+        pthread_mutex_lock(&ctx->result_mutex);
+        ctx->result_history = results;
+        result_log_destroy(ctx->result_log);
+        ctx->result_log = NULL;
+        pthread_mutex_unlock(&ctx->result_mutex);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "results.history_sec") == 0) {
+        int seconds = atoi(value);
+        if (seconds < 0 || seconds > 7 * 24 * 3600) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "results.history_sec must be 0 (no limit) to 604800");
+            return CIRA_ERROR_INPUT;
+        }
+        pthread_mutex_lock(&ctx->result_mutex);
+        ctx->result_history_sec = seconds;
+        result_log_destroy(ctx->result_log);
+        ctx->result_log = NULL;
+        pthread_mutex_unlock(&ctx->result_mutex);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "results.log") == 0) {
+        if (strlen(value) >= sizeof(ctx->result_log_path)) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "results.log must be under %d characters",
+                     (int)sizeof(ctx->result_log_path));
+            return CIRA_ERROR_INPUT;
+        }
+        pthread_mutex_lock(&ctx->result_mutex);
+        strcpy(ctx->result_log_path, value);
+        result_log_destroy(ctx->result_log);
+        ctx->result_log = NULL;
+        pthread_mutex_unlock(&ctx->result_mutex);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "results.log_mb") == 0) {
+        int mb = atoi(value);
+        if (mb < 1 || mb > 1024) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "results.log_mb must be 1-1024");
+            return CIRA_ERROR_INPUT;
+        }
+        pthread_mutex_lock(&ctx->result_mutex);
+        ctx->result_log_mb = mb;
+        result_log_destroy(ctx->result_log);
+        ctx->result_log = NULL;
+        pthread_mutex_unlock(&ctx->result_mutex);
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "camera.schedule") == 0) {
+        if (strcmp(value, "batch") == 0) {
+            ctx->camera_schedule = CIRA_SCHEDULE_BATCH;
+        } else if (strcmp(value, "round_robin") == 0) {
+            ctx->camera_schedule = CIRA_SCHEDULE_ROUND_ROBIN;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "camera.schedule must be batch or round_robin");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "camera.backend") == 0) {
+        if (strcmp(value, "auto") == 0) {
+            ctx->camera_backend = CIRA_CAPTURE_AUTO;
+        } else if (strcmp(value, "v4l2") == 0) {
+            ctx->camera_backend = CIRA_CAPTURE_V4L2;
+        } else if (strcmp(value, "opencv") == 0) {
+            ctx->camera_backend = CIRA_CAPTURE_OPENCV;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "camera.backend must be auto, v4l2 or opencv");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "camera.format") == 0) {
+        if (strcmp(value, "auto") == 0) {
+            ctx->camera_format = CAPTURE_PREFER_AUTO;
+        } else if (strcmp(value, "yuyv") == 0) {
+            ctx->camera_format = CAPTURE_FORMAT_YUYV;
+        } else if (strcmp(value, "mjpeg") == 0) {
+            ctx->camera_format = CAPTURE_FORMAT_MJPEG;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "camera.format must be auto, yuyv or mjpeg");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "camera.width") == 0 || strcmp(key, "camera.height") == 0) {
+        int size = atoi(value);
+        if (size < 16 || size > 8192) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "%s must be 16-8192", key);
+            return CIRA_ERROR_INPUT;
+        }
+        if (key[7] == 'w') {
+            ctx->camera_width = size;
+        } else {
+            ctx->camera_height = size;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "camera.fps") == 0) {
+        int fps = atoi(value);
+        if (fps < 0 || fps > 240) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "camera.fps must be 0 (default) to 240");
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->camera_fps = fps;
+        return CIRA_OK;
+    }
+
+#ifdef CIRA_STREAMING_ENABLED
+    if (strcmp(key, "jpeg.encoder") == 0) {
+        int result = jpeg_encoder_select(value);
+        if (result == CIRA_ERROR_INPUT) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "jpeg.encoder must be auto, nvjpeg, turbo or opencv");
+        } else if (result != CIRA_OK) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "JPEG encoder %s is not available in this build or on this machine", value);
+        }
+        return result;
+    }
+#endif
+
+    if (strcmp(key, "gate.motion_threshold") == 0) {
+        float threshold = (float)atof(value);
+        if (threshold < 0.0f || threshold > 255.0f) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "gate.motion_threshold must be 0 (off) to 255");
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->gate_threshold = threshold;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "gate.max_skip_ms") == 0) {
+        int ms = atoi(value);
+        if (ms < 0 || ms > 3600000) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "gate.max_skip_ms must be 0 (unlimited) to 3600000");
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->gate_max_skip_ms = ms;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "tracker") == 0) {
+        if (strcmp(value, "on") == 0) {
+            ctx->tracker_enabled = 1;
+        } else if (strcmp(value, "off") == 0) {
+            ctx->tracker_enabled = 0;
+        } else {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "tracker must be on or off");
+            return CIRA_ERROR_INPUT;
+        }
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "tracker.detect_interval") == 0) {
+        int interval = atoi(value);
+        if (interval < 1 || interval > 30) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "tracker.detect_interval must be 1-30");
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->tracker_interval = interval;
+        return CIRA_OK;
+    }
+
+    if (strcmp(key, "tracker.high_threshold") == 0) {
+        float threshold = (float)atof(value);
+        if (threshold <= 0.0f || threshold > 1.0f) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "tracker.high_threshold must be in (0, 1]");
+            return CIRA_ERROR_INPUT;
+        }
+        ctx->tracker_high_threshold = threshold;
+        return CIRA_OK;
+    }
+
+    int camera;
+    int consumed = 0;
+
+    /* camera.N.roi: "x,y,w,h[;x,y,w,h...]" normalized, empty for the whole frame */
+    if (sscanf(key, "camera.%d.roi%n", &camera, &consumed) == 1 && key[consumed] == '\0') {
+        if (camera < 0 || camera >= CIRA_MAX_CAMERAS) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "camera number must be 0-%d", CIRA_MAX_CAMERAS - 1);
+            return CIRA_ERROR_INPUT;
+        }
+        cira_roi_t rois[CIRA_MAX_ROIS];
+        int count = parse_rois(value, rois);
+        if (count < 0) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "camera.N.roi must be up to %d \"x,y,w,h\" boxes within 0-1, separated by ';'",
+                     CIRA_MAX_ROIS);
+            return CIRA_ERROR_INPUT;
+        }
+        pthread_mutex_lock(&ctx->camera_mutex);
+        memcpy(ctx->cameras[camera].rois, rois, sizeof(rois));
+        ctx->cameras[camera].num_rois = count;
+        pthread_mutex_unlock(&ctx->camera_mutex);
+        return CIRA_OK;
+    }
+
+    /* camera.N.source: used by the next start of camera N */
+    if (sscanf(key, "camera.%d.source%n", &camera, &consumed) == 1 && key[consumed] == '\0') {
+        if (camera < 0 || camera >= CIRA_MAX_CAMERAS) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "camera number must be 0-%d", CIRA_MAX_CAMERAS - 1);
+            return CIRA_ERROR_INPUT;
+        }
+        if (strlen(value) >= CIRA_CAMERA_SOURCE_LEN) {
+            snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN,
+                     "camera source must be under %d characters", CIRA_CAMERA_SOURCE_LEN);
+            return CIRA_ERROR_INPUT;
+        }
+        pthread_mutex_lock(&ctx->camera_mutex);
+        strcpy(ctx->cameras[camera].source, value);
+        pthread_mutex_unlock(&ctx->camera_mutex);
+        return CIRA_OK;
+    }
+
+    snprintf(ctx->error_msg, CIRA_MAX_ERROR_LEN, "Unknown option: %s", key);
+    return CIRA_ERROR_INPUT;
+}
+
 int cira_status(cira_ctx* ctx) {
     if (!ctx) return CIRA_STATUS_ERROR;
     return ctx->status;
@@ -746,11 +2391,40 @@ const char* cira_error(cira_ctx* ctx) {
 
 /* === Streaming API === */
 
+/* Create the frame ring on first camera start (exported via cira_internal.h) */
+int cira_frame_ring_start(cira_ctx* ctx) {
+    if (ctx->frame_ring_format < 0) return CIRA_OK;
+
+    pthread_mutex_lock(&ctx->frame_ring_mutex);
+    if (!ctx->frame_ring) {
+        char name[64];
+        if (ctx->frame_ring_name[0]) {
+            snprintf(name, sizeof(name), "%s", ctx->frame_ring_name);
+        } else {
+            /* Consumers find the ring by the runtime's HTTP port */
+            snprintf(name, sizeof(name), "cira-frames-%d",
+                     ctx->server_port > 0 ? ctx->server_port : (int)getpid());
+        }
+        size_t bytes = ctx->frame_ring_bytes;
+        if (bytes == 0) {
+            bytes = ctx->frame_ring_format == FRAME_RING_FORMAT_RGB24 ?
+                    CIRA_FRAME_RING_RGB_BYTES : CIRA_FRAME_RING_JPEG_BYTES;
+        }
+        ctx->frame_ring = frame_ring_create(name, ctx->frame_ring_slots, bytes);
+        if (!ctx->frame_ring) {
+            cira_set_error(ctx, "Failed to create frame ring %s", name);
+        }
+    }
+    pthread_mutex_unlock(&ctx->frame_ring_mutex);
+
+    return ctx->frame_ring ? CIRA_OK : CIRA_ERROR;
+}
+
 int cira_start_camera(cira_ctx* ctx, int device_id) {
 #ifdef CIRA_STREAMING_ENABLED
     if (!ctx) return CIRA_ERROR_INPUT;
-    if (ctx->camera_running) return CIRA_OK;
-    return camera_start(ctx, device_id);
+    if (ctx->cameras[0].running) return CIRA_OK;
+    return camera_start(ctx, 0, device_id);
 #else
     (void)ctx;
     (void)device_id;
@@ -762,13 +2436,51 @@ int cira_stop_camera(cira_ctx* ctx) {
 #ifdef CIRA_STREAMING_ENABLED
     if (!ctx) return CIRA_ERROR_INPUT;
     if (!ctx->camera_running) return CIRA_OK;
-    return camera_stop(ctx);
+    return camera_stop(ctx, -1);
 #else
     (void)ctx;
     return CIRA_ERROR;
 #endif
 }
 
+int cira_camera_start(cira_ctx* ctx, int camera, int device_id) {
+#ifdef CIRA_STREAMING_ENABLED
+    if (!ctx || camera < 0 || camera >= CIRA_MAX_CAMERAS) return CIRA_ERROR_INPUT;
+    return camera_start(ctx, camera, device_id);
+#else
+    (void)ctx;
+    (void)camera;
+    (void)device_id;
+    return CIRA_ERROR;
+#endif
+}
+
+int cira_camera_stop(cira_ctx* ctx, int camera) {
+#ifdef CIRA_STREAMING_ENABLED
+    if (!ctx || camera < 0 || camera >= CIRA_MAX_CAMERAS) return CIRA_ERROR_INPUT;
+    return camera_stop(ctx, camera);
+#else
+    (void)ctx;
+    (void)camera;
+    return CIRA_ERROR;
+#endif
+}
+
+const char* cira_camera_result_json(cira_ctx* ctx, int camera) {
+    if (!ctx || camera < 0 || camera >= CIRA_MAX_CAMERAS) {
+        return "{\"detections\":[],\"count\":0}";
+    }
+    pthread_mutex_lock(&ctx->result_mutex);
+    const char* json = cira_result_json_locked(ctx, camera);
+    pthread_mutex_unlock(&ctx->result_mutex);
+    return json;
+}
+
+float cira_camera_fps(cira_ctx* ctx, int camera) {
+    if (!ctx || camera < 0 || camera >= CIRA_MAX_CAMERAS) return 0.0f;
+    return ctx->cameras[camera].current_fps;
+}
+
 int cira_start_server(cira_ctx* ctx, int port) {
 #ifdef CIRA_STREAMING_ENABLED
     if (!ctx) return CIRA_ERROR_INPUT;
@@ -794,5 +2506,5 @@ int cira_stop_server(cira_ctx* ctx) {
 
 float cira_get_fps(cira_ctx* ctx) {
     if (!ctx) return 0.0f;
-    return ctx->current_fps;
+    return ctx->cameras[0].current_fps;
 }
@@ -0,0 +1,239 @@
+/**
+ * CiRA Runtime - CPU Affinity
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "cpu_affinity.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+int cpu_mask_count(cpu_mask_t mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+}
+
+static cpu_mask_t mask_of_cpus(int num_cpus) {
+    return num_cpus >= CPU_AFFINITY_MAX_CPUS ? ~(cpu_mask_t)0
+                                             : (((cpu_mask_t)1 << num_cpus) - 1);
+}
+
+void cpu_topology_from_capacity(cpu_topology_t* topo, const int* capacity, int num_cpus) {
+    if (num_cpus < 1) num_cpus = 1;
+    if (num_cpus > CPU_AFFINITY_MAX_CPUS) num_cpus = CPU_AFFINITY_MAX_CPUS;
+
+    topo->num_cpus = num_cpus;
+    topo->all = mask_of_cpus(num_cpus);
+    topo->big = topo->all;
+    topo->little = 0;
+
+    int lo = capacity[0], hi = capacity[0];
+    for (int i = 1; i < num_cpus; i++) {
+        if (capacity[i] < lo) lo = capacity[i];
+        if (capacity[i] > hi) hi = capacity[i];
+    }
+    if (lo <= 0 || lo == hi) return;
+
+    for (int i = 0; i < num_cpus; i++) {
+        if (capacity[i] == lo) topo->little |= (cpu_mask_t)1 << i;
+    }
+    topo->big = topo->all & ~topo->little;
+}
+
+#ifdef __linux__
+/* First integer in a sysfs file, 0 if missing */
+static int read_sysfs_int(const char* fmt, int cpu) {
+    char path[128];
+    snprintf(path, sizeof(path), fmt, cpu);
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    int value = 0;
+    if (fscanf(f, "%d", &value) != 1) value = 0;
+    fclose(f);
+    return value;
+}
+#endif
+
+static cpu_topology_t g_topology;
+static pthread_once_t g_topology_once = PTHREAD_ONCE_INIT;
+
+static void detect_topology(void) {
+    int capacity[CPU_AFFINITY_MAX_CPUS] = {0};
+    int num_cpus = 1;
+#ifndef _WIN32
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) num_cpus = n > CPU_AFFINITY_MAX_CPUS ? CPU_AFFINITY_MAX_CPUS : (int)n;
+#endif
+#ifdef __linux__
+    for (int i = 0; i < num_cpus; i++) {
+        /* Scheduler capacity where the kernel has it (ARM), else top frequency */
+        capacity[i] = read_sysfs_int("/sys/devices/system/cpu/cpu%d/cpu_capacity", i);
+        if (capacity[i] == 0) {
+            capacity[i] = read_sysfs_int("/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", i);
+        }
+    }
+#endif
+
+    cpu_topology_from_capacity(&g_topology, capacity, num_cpus);
+}
+
+const cpu_topology_t* cpu_topology(void) {
+    pthread_once(&g_topology_once, detect_topology);
+    return &g_topology;
+}
+
+void cpu_affinity_plan(const cpu_topology_t* topo, cpu_mask_t masks[CPU_CLASSES]) {
+    for (int i = 0; i < CPU_CLASSES; i++) {
+        masks[i] = 0;
+    }
+
+    cpu_mask_t service;
+    if (topo->little) {
+        masks[CPU_CLASS_INFERENCE] = topo->big;
+        service = topo->little;
+    } else if (topo->num_cpus >= 4) {
+        int reserved = topo->num_cpus >= 8 ? 2 : 1;
+        service = mask_of_cpus(reserved);
+        masks[CPU_CLASS_INFERENCE] = topo->all & ~service;
+    } else {
+        return;
+    }
+
+    masks[CPU_CLASS_CAPTURE] = service;
+    masks[CPU_CLASS_ENCODE] = service;
+    masks[CPU_CLASS_HTTP] = service;
+}
+
+int cpu_mask_parse(const char* spec, const cpu_topology_t* topo, cpu_mask_t* mask) {
+    if (strcmp(spec, "") == 0 || strcmp(spec, "none") == 0) {
+        *mask = 0;
+        return 0;
+    }
+    if (strcmp(spec, "all") == 0) {
+        *mask = topo->all;
+        return 0;
+    }
+    if (strcmp(spec, "big") == 0) {
+        *mask = topo->big;
+        return 0;
+    }
+    if (strcmp(spec, "little") == 0) {
+        if (!topo->little) return -1;
+        *mask = topo->little;
+        return 0;
+    }
+
+    cpu_mask_t result = 0;
+    const char* p = spec;
+    while (*p) {
+        if (!isdigit((unsigned char)*p)) return -1;
+        char* end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            if (!isdigit((unsigned char)*p)) return -1;
+            last = strtol(p, &end, 10);
+            p = end;
+        }
+        if (first < 0 || last < first || last >= topo->num_cpus) return -1;
+        for (long c = first; c <= last; c++) {
+            result |= (cpu_mask_t)1 << c;
+        }
+        if (*p == ',') {
+            p++;
+            if (!*p) return -1;
+        } else if (*p) {
+            return -1;
+        }
+    }
+
+    *mask = result;
+    return 0;
+}
+
+void cpu_mask_format(cpu_mask_t mask, char* out, size_t out_size) {
+    size_t len = 0;
+    if (out_size == 0) return;
+    out[0] = '\0';
+
+    for (int c = 0; c < CPU_AFFINITY_MAX_CPUS; c++) {
+        if (!(mask & ((cpu_mask_t)1 << c))) continue;
+        int last = c;
+        while (last + 1 < CPU_AFFINITY_MAX_CPUS && (mask & ((cpu_mask_t)1 << (last + 1)))) {
+            last++;
+        }
+
+        int n = last > c
+            ? snprintf(out + len, out_size - len, "%s%d-%d", len ? "," : "", c, last)
+            : snprintf(out + len, out_size - len, "%s%d", len ? "," : "", c);
+        if (n < 0 || (size_t)n >= out_size - len) return;
+        len += (size_t)n;
+        c = last;
+    }
+}
+
+#ifdef __linux__
+
+int cpu_affinity_set_self(cpu_mask_t mask) {
+    if (!mask) return 0;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c = 0; c < CPU_AFFINITY_MAX_CPUS; c++) {
+        if (mask & ((cpu_mask_t)1 << c)) CPU_SET(c, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+cpu_mask_t cpu_affinity_get_self(void) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) return 0;
+
+    cpu_mask_t mask = 0;
+    for (int c = 0; c < CPU_AFFINITY_MAX_CPUS; c++) {
+        if (CPU_ISSET(c, &set)) mask |= (cpu_mask_t)1 << c;
+    }
+    return mask;
+}
+
+#else /* !__linux__ */
+
+/* No thread affinity API used here: threads float */
+int cpu_affinity_set_self(cpu_mask_t mask) {
+    (void)mask;
+    return 0;
+}
+
+cpu_mask_t cpu_affinity_get_self(void) {
+    return 0;
+}
+
+#endif /* __linux__ */
+
+const char* cpu_class_name(cpu_class_t cls) {
+    switch (cls) {
+        case CPU_CLASS_CAPTURE: return "capture";
+        case CPU_CLASS_INFERENCE: return "inference";
+        case CPU_CLASS_ENCODE: return "encode";
+        case CPU_CLASS_HTTP: return "http";
+        default: return "unknown";
+    }
+}
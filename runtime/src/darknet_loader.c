@@ -17,6 +17,7 @@
 
 #include "cira.h"
 #include "cira_internal.h"
+#include "preprocess.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -53,9 +54,6 @@ extern detection *get_network_boxes(network *net, int w, int h, float thresh,
                                      int *num, int letter);
 extern void free_detections(detection *dets, int n);
 extern void do_nms_sort(detection *dets, int total, int classes, float thresh);
-extern image make_image(int w, int h, int c);
-extern void free_image(image m);
-extern image resize_image(image im, int w, int h);
 extern int network_width(network *net);
 extern int network_height(network *net);
 
@@ -65,6 +63,8 @@ typedef struct {
     int input_w;
     int input_h;
     int num_classes;
+    preprocess_plan_t plan;   /* Resize/normalize into input */
+    float* input;             /* Network input, CHW 0-1 */
 } darknet_model_t;
 
 /* Helper: Check if path is a directory */
@@ -96,24 +96,6 @@ static int find_file_ext(const char* dir, const char* ext, char* out, size_t out
     return 0;
 }
 
-/* Helper: Convert uint8 RGB to Darknet float image format (CHW) */
-static image make_image_from_bytes(const uint8_t* data, int w, int h, int c) {
-    image im = make_image(w, h, c);
-
-    /* Convert from packed RGB (HWC) to planar (CHW) and normalize to 0-1 */
-    for (int k = 0; k < c; k++) {
-        for (int j = 0; j < h; j++) {
-            for (int i = 0; i < w; i++) {
-                int src_idx = j * w * c + i * c + k;
-                int dst_idx = k * h * w + j * w + i;
-                im.data[dst_idx] = (float)data[src_idx] / 255.0f;
-            }
-        }
-    }
-
-    return im;
-}
-
 /**
  * Load a Darknet model from a directory.
  *
@@ -170,6 +152,18 @@ int darknet_load(cira_ctx* ctx, const char* model_path) {
     model->input_h = network_height(model->net);
     model->num_classes = ctx->num_labels;  /* Use labels loaded by cira_load() */
 
+    /* Darknet resizes by stretching; boxes come back relative to the input */
+    model->input = (float*)malloc((size_t)model->input_w * model->input_h * 3 * sizeof(float));
+    if (!model->input ||
+        preprocess_init(&model->plan, model->input_w, model->input_h,
+                        PREPROCESS_NCHW, 0, 0) != CIRA_OK) {
+        cira_set_error(ctx, "Failed to allocate network input");
+        free(model->input);
+        free_network(model->net);
+        free(model);
+        return CIRA_ERROR_MEMORY;
+    }
+
     /* Update context with model dimensions */
     ctx->input_w = model->input_w;
     ctx->input_h = model->input_h;
@@ -196,6 +190,8 @@ void darknet_unload(cira_ctx* ctx) {
         free_network(model->net);
     }
 
+    preprocess_free(&model->plan);
+    free(model->input);
     free(model);
     ctx->model_handle = NULL;
 
@@ -227,14 +223,14 @@ int darknet_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channe
     /* Clear previous detections */
     cira_clear_detections(ctx);
 
-    /* Convert input image to Darknet format (CHW, float, 0-1) */
-    image im = make_image_from_bytes(data, w, h, channels);
-
-    /* Resize to network input size */
-    image resized = resize_image(im, model->input_w, model->input_h);
+    /* Resize and convert to Darknet format (CHW, float, 0-1) in one pass */
+    double t0 = cira_time_ms();
+    preprocess_run(&model->plan, data, w, h, model->input);
 
     /* Run inference */
-    network_predict(model->net, resized.data);
+    double t1 = cira_time_ms();
+    network_predict(model->net, model->input);
+    double t2 = cira_time_ms();
 
     /* Get detections */
     int nboxes = 0;
@@ -283,8 +279,10 @@ int darknet_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channe
 
     /* Cleanup */
     free_detections(dets, nboxes);
-    free_image(resized);
-    free_image(im);
+
+    ctx->predict_timing.preprocess_ms = t1 - t0;
+    ctx->predict_timing.inference_ms = t2 - t1;
+    ctx->predict_timing.decode_ms = cira_time_ms() - t2;
 
     fprintf(stderr, "Darknet inference: %d detections\n", ctx->num_detections);
     return CIRA_OK;
@@ -0,0 +1,514 @@
+/**
+ * CiRA Runtime - Fragmented MP4 Muxer
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "fmp4.h"
+#include <stdio.h>
+#include <string.h>
+
+/* NAL unit types */
+#define H264_NAL_IDR 5
+#define H264_NAL_SPS 7
+#define H264_NAL_PPS 8
+#define H264_NAL_AUD 9
+#define H265_NAL_IRAP_FIRST 16
+#define H265_NAL_IRAP_LAST 23
+#define H265_NAL_VCL_LAST 31
+#define H265_NAL_VPS 32
+#define H265_NAL_SPS 33
+#define H265_NAL_PPS 34
+#define H265_NAL_AUD 35
+
+/* trun sample flags: sync sample / depends on others and not sync */
+#define SAMPLE_FLAGS_SYNC 0x02000000u
+#define SAMPLE_FLAGS_DELTA 0x01010000u
+
+/* Next NAL unit of an Annex-B stream at or after *pos (NULL at the end) */
+static const uint8_t* next_nal(const uint8_t** pos, const uint8_t* end, size_t* size) {
+    const uint8_t* p = *pos;
+    while (p + 3 <= end && !(p[0] == 0 && p[1] == 0 && p[2] == 1)) p++;
+    if (p + 3 > end) {
+        *pos = end;
+        return NULL;
+    }
+
+    const uint8_t* nal = p + 3;
+    const uint8_t* q = nal;
+    while (q + 3 <= end && !(q[0] == 0 && q[1] == 0 && q[2] == 1)) q++;
+    if (q + 3 > end) q = end;
+    *pos = q;
+
+    /* The zero of a 4-byte start code (and trailing zeros) are not payload */
+    const uint8_t* e = q;
+    while (e > nal && e[-1] == 0) e--;
+    *size = (size_t)(e - nal);
+    return nal;
+}
+
+static int nal_type(fmp4_codec_t codec, const uint8_t* nal) {
+    return codec == FMP4_CODEC_H265 ? (nal[0] >> 1) & 0x3F : nal[0] & 0x1F;
+}
+
+static int is_vcl(fmp4_codec_t codec, int type) {
+    return codec == FMP4_CODEC_H265 ? type <= H265_NAL_VCL_LAST : (type >= 1 && type <= H264_NAL_IDR);
+}
+
+/* Parameter sets and delimiters live in the init segment, not in samples */
+static int is_out_of_band(fmp4_codec_t codec, int type) {
+    if (codec == FMP4_CODEC_H265) {
+        return type >= H265_NAL_VPS && type <= H265_NAL_AUD;
+    }
+    return type >= H264_NAL_SPS && type <= H264_NAL_AUD;
+}
+
+void fmp4_track_init(fmp4_track_t* track, fmp4_codec_t codec, int width, int height) {
+    memset(track, 0, sizeof(*track));
+    track->codec = codec;
+    track->width = width;
+    track->height = height;
+}
+
+static int take_param_set(uint8_t* dst, size_t* dst_size, const uint8_t* nal, size_t size) {
+    if (size > FMP4_MAX_PARAM_SET) return 0;
+    if (*dst_size == size && memcmp(dst, nal, size) == 0) return 0;
+    memcpy(dst, nal, size);
+    *dst_size = size;
+    return 1;
+}
+
+int fmp4_track_update(fmp4_track_t* track, const uint8_t* au, size_t au_size) {
+    const uint8_t* pos = au;
+    const uint8_t* end = au + au_size;
+    const uint8_t* nal;
+    size_t size;
+    int changed = 0;
+
+    while ((nal = next_nal(&pos, end, &size)) != NULL) {
+        if (size == 0) continue;
+        int type = nal_type(track->codec, nal);
+        if (track->codec == FMP4_CODEC_H265) {
+            if (type == H265_NAL_VPS) changed |= take_param_set(track->vps, &track->vps_size, nal, size);
+            if (type == H265_NAL_SPS) changed |= take_param_set(track->sps, &track->sps_size, nal, size);
+            if (type == H265_NAL_PPS) changed |= take_param_set(track->pps, &track->pps_size, nal, size);
+        } else {
+            if (type == H264_NAL_SPS) changed |= take_param_set(track->sps, &track->sps_size, nal, size);
+            if (type == H264_NAL_PPS) changed |= take_param_set(track->pps, &track->pps_size, nal, size);
+        }
+    }
+    return changed;
+}
+
+/*
+ * First bytes of an H.265 SPS after its NAL header, emulation prevention
+ * removed: [0] VPS id / sub-layers / nesting, [1] profile space, tier and
+ * profile, [2-5] compatibility flags, [6-11] constraint flags, [12] level.
+ */
+#define H265_PTL_BYTES 13
+
+static size_t h265_sps_ptl(const fmp4_track_t* track, uint8_t* ptl) {
+    size_t n = 0;
+    int zeros = 0;
+    for (size_t i = 2; i < track->sps_size && n < H265_PTL_BYTES; i++) {
+        uint8_t b = track->sps[i];
+        if (zeros >= 2 && b == 3) {
+            zeros = 0;
+            continue;
+        }
+        zeros = b == 0 ? zeros + 1 : 0;
+        ptl[n++] = b;
+    }
+    return n;
+}
+
+int fmp4_track_ready(const fmp4_track_t* track) {
+    if (track->width <= 0 || track->height <= 0 || track->pps_size == 0) return 0;
+    if (track->codec == FMP4_CODEC_H265) {
+        uint8_t ptl[H265_PTL_BYTES];
+        return track->vps_size > 0 && h265_sps_ptl(track, ptl) == H265_PTL_BYTES;
+    }
+    return track->sps_size >= 4;
+}
+
+void fmp4_codec_string(const fmp4_track_t* track, char* out, size_t out_size) {
+    if (out_size == 0) return;
+    out[0] = '\0';
+    if (!fmp4_track_ready(track)) return;
+
+    if (track->codec == FMP4_CODEC_H264) {
+        snprintf(out, out_size, "avc1.%02X%02X%02X", track->sps[1], track->sps[2], track->sps[3]);
+        return;
+    }
+
+    uint8_t ptl[H265_PTL_BYTES];
+    h265_sps_ptl(track, ptl);
+
+    static const char* const spaces[] = { "", "A", "B", "C" };
+    uint32_t compat = ((uint32_t)ptl[2] << 24) | ((uint32_t)ptl[3] << 16) |
+                      ((uint32_t)ptl[4] << 8) | ptl[5];
+    uint32_t reversed = 0;
+    for (int i = 0; i < 32; i++) {
+        reversed |= ((compat >> i) & 1u) << (31 - i);
+    }
+
+    /* Constraint bytes up to the last non-zero one */
+    char constraints[32] = "";
+    int last = -1;
+    for (int i = 0; i < 6; i++) {
+        if (ptl[6 + i]) last = i;
+    }
+    for (int i = 0; i <= last; i++) {
+        size_t len = strlen(constraints);
+        snprintf(constraints + len, sizeof(constraints) - len, ".%02X", ptl[6 + i]);
+    }
+
+    snprintf(out, out_size, "hvc1.%s%d.%X.%c%d%s",
+             spaces[ptl[1] >> 6], ptl[1] & 0x1F, (unsigned)reversed,
+             (ptl[1] & 0x20) ? 'H' : 'L', ptl[12], constraints);
+}
+
+int fmp4_is_keyframe(fmp4_codec_t codec, const uint8_t* au, size_t au_size) {
+    const uint8_t* pos = au;
+    const uint8_t* end = au + au_size;
+    const uint8_t* nal;
+    size_t size;
+
+    while ((nal = next_nal(&pos, end, &size)) != NULL) {
+        if (size == 0) continue;
+        int type = nal_type(codec, nal);
+        if (codec == FMP4_CODEC_H265) {
+            if (type >= H265_NAL_IRAP_FIRST && type <= H265_NAL_IRAP_LAST) return 1;
+        } else if (type == H264_NAL_IDR) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* === Box writer === */
+
+typedef struct {
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+    int overflow;
+} writer_t;
+
+static void put_bytes(writer_t* w, const void* data, size_t n) {
+    if (w->overflow || n > w->cap - w->len) {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->buf + w->len, data, n);
+    w->len += n;
+}
+
+static void put_be(writer_t* w, uint64_t v, int bytes) {
+    uint8_t b[8];
+    for (int i = 0; i < bytes; i++) {
+        b[i] = (uint8_t)(v >> (8 * (bytes - 1 - i)));
+    }
+    put_bytes(w, b, (size_t)bytes);
+}
+
+static void put8(writer_t* w, uint32_t v) { put_be(w, v, 1); }
+static void put16(writer_t* w, uint32_t v) { put_be(w, v, 2); }
+static void put24(writer_t* w, uint32_t v) { put_be(w, v, 3); }
+static void put32(writer_t* w, uint32_t v) { put_be(w, v, 4); }
+static void put64(writer_t* w, uint64_t v) { put_be(w, v, 8); }
+
+static void put_zeros(writer_t* w, size_t n) {
+    static const uint8_t zeros[32];
+    while (n > 0) {
+        size_t chunk = n < sizeof(zeros) ? n : sizeof(zeros);
+        put_bytes(w, zeros, chunk);
+        n -= chunk;
+    }
+}
+
+/* Patch a big-endian 32-bit value written earlier */
+static void patch32(writer_t* w, size_t at, uint32_t v) {
+    if (w->overflow) return;
+    w->buf[at] = (uint8_t)(v >> 24);
+    w->buf[at + 1] = (uint8_t)(v >> 16);
+    w->buf[at + 2] = (uint8_t)(v >> 8);
+    w->buf[at + 3] = (uint8_t)v;
+}
+
+static size_t box_begin(writer_t* w, const char* type) {
+    size_t at = w->len;
+    put32(w, 0);
+    put_bytes(w, type, 4);
+    return at;
+}
+
+static size_t full_box_begin(writer_t* w, const char* type, int version, uint32_t flags) {
+    size_t at = box_begin(w, type);
+    put8(w, (uint32_t)version);
+    put24(w, flags);
+    return at;
+}
+
+static void box_end(writer_t* w, size_t at) {
+    patch32(w, at, (uint32_t)(w->len - at));
+}
+
+/* Unity transformation matrix of mvhd / tkhd */
+static void put_matrix(writer_t* w) {
+    static const uint32_t matrix[9] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+    for (int i = 0; i < 9; i++) put32(w, matrix[i]);
+}
+
+static void put_avcc(writer_t* w, const fmp4_track_t* track) {
+    size_t box = box_begin(w, "avcC");
+    put8(w, 1);                         /* configurationVersion */
+    put8(w, track->sps[1]);             /* AVCProfileIndication */
+    put8(w, track->sps[2]);             /* profile_compatibility */
+    put8(w, track->sps[3]);             /* AVCLevelIndication */
+    put8(w, 0xFC | 3);                  /* lengthSizeMinusOne */
+    put8(w, 0xE0 | 1);                  /* numOfSequenceParameterSets */
+    put16(w, (uint32_t)track->sps_size);
+    put_bytes(w, track->sps, track->sps_size);
+    put8(w, 1);                         /* numOfPictureParameterSets */
+    put16(w, (uint32_t)track->pps_size);
+    put_bytes(w, track->pps, track->pps_size);
+
+    /* High profiles: 4:2:0, 8 bits (what the encoder pipelines produce) */
+    int profile = track->sps[1];
+    if (profile == 100 || profile == 110 || profile == 122 || profile == 144) {
+        put8(w, 0xFC | 1);              /* chroma_format */
+        put8(w, 0xF8);                  /* bit_depth_luma_minus8 */
+        put8(w, 0xF8);                  /* bit_depth_chroma_minus8 */
+        put8(w, 0);                     /* numOfSequenceParameterSetExt */
+    }
+    box_end(w, box);
+}
+
+static void put_hvcc_array(writer_t* w, int type, const uint8_t* nal, size_t size) {
+    put8(w, 0x80 | (uint32_t)type);     /* array_completeness, NAL_unit_type */
+    put16(w, 1);                        /* numNalus */
+    put16(w, (uint32_t)size);
+    put_bytes(w, nal, size);
+}
+
+static void put_hvcc(writer_t* w, const fmp4_track_t* track) {
+    uint8_t ptl[H265_PTL_BYTES];
+    h265_sps_ptl(track, ptl);
+    int sub_layers = ((ptl[0] >> 1) & 0x07) + 1;
+    int nested = ptl[0] & 1;
+
+    size_t box = box_begin(w, "hvcC");
+    put8(w, 1);                         /* configurationVersion */
+    put_bytes(w, ptl + 1, 12);          /* profile, compatibility, constraints, level */
+    put16(w, 0xF000);                   /* min_spatial_segmentation_idc */
+    put8(w, 0xFC);                      /* parallelismType */
+    put8(w, 0xFC | 1);                  /* chromaFormat 4:2:0 */
+    put8(w, 0xF8);                      /* bitDepthLumaMinus8 */
+    put8(w, 0xF8);                      /* bitDepthChromaMinus8 */
+    put16(w, 0);                        /* avgFrameRate */
+    put8(w, ((uint32_t)sub_layers << 3) | ((uint32_t)nested << 2) | 3);
+    put8(w, 3);                         /* numOfArrays */
+    put_hvcc_array(w, H265_NAL_VPS, track->vps, track->vps_size);
+    put_hvcc_array(w, H265_NAL_SPS, track->sps, track->sps_size);
+    put_hvcc_array(w, H265_NAL_PPS, track->pps, track->pps_size);
+    box_end(w, box);
+}
+
+static void put_empty_table(writer_t* w, const char* type) {
+    size_t box = full_box_begin(w, type, 0, 0);
+    put32(w, 0);                        /* entry_count */
+    box_end(w, box);
+}
+
+size_t fmp4_init_segment(const fmp4_track_t* track, uint8_t* out, size_t out_size) {
+    if (!fmp4_track_ready(track)) return 0;
+    writer_t w = { out, out_size, 0, 0 };
+
+    size_t ftyp = box_begin(&w, "ftyp");
+    put_bytes(&w, "isom", 4);
+    put32(&w, 0x200);
+    put_bytes(&w, "isomiso6iso5mp41", 16);
+    box_end(&w, ftyp);
+
+    size_t moov = box_begin(&w, "moov");
+
+    size_t mvhd = full_box_begin(&w, "mvhd", 0, 0);
+    put32(&w, 0);                       /* creation_time */
+    put32(&w, 0);                       /* modification_time */
+    put32(&w, 1000);                    /* timescale */
+    put32(&w, 0);                       /* duration: fragmented */
+    put32(&w, 0x00010000);              /* rate */
+    put16(&w, 0x0100);                  /* volume */
+    put_zeros(&w, 10);
+    put_matrix(&w);
+    put_zeros(&w, 24);                  /* pre_defined */
+    put32(&w, 2);                       /* next_track_ID */
+    box_end(&w, mvhd);
+
+    size_t trak = box_begin(&w, "trak");
+
+    size_t tkhd = full_box_begin(&w, "tkhd", 0, 3);     /* enabled, in movie */
+    put32(&w, 0);
+    put32(&w, 0);
+    put32(&w, 1);                       /* track_ID */
+    put32(&w, 0);
+    put32(&w, 0);                       /* duration */
+    put_zeros(&w, 8);
+    put16(&w, 0);                       /* layer */
+    put16(&w, 0);                       /* alternate_group */
+    put16(&w, 0);                       /* volume */
+    put16(&w, 0);
+    put_matrix(&w);
+    put32(&w, (uint32_t)track->width << 16);
+    put32(&w, (uint32_t)track->height << 16);
+    box_end(&w, tkhd);
+
+    size_t mdia = box_begin(&w, "mdia");
+
+    size_t mdhd = full_box_begin(&w, "mdhd", 0, 0);
+    put32(&w, 0);
+    put32(&w, 0);
+    put32(&w, FMP4_TIMESCALE);
+    put32(&w, 0);
+    put16(&w, 0x55C4);                  /* language "und" */
+    put16(&w, 0);
+    box_end(&w, mdhd);
+
+    size_t hdlr = full_box_begin(&w, "hdlr", 0, 0);
+    put32(&w, 0);
+    put_bytes(&w, "vide", 4);
+    put_zeros(&w, 12);
+    put_bytes(&w, "VideoHandler", 13);
+    box_end(&w, hdlr);
+
+    size_t minf = box_begin(&w, "minf");
+
+    size_t vmhd = full_box_begin(&w, "vmhd", 0, 1);
+    put_zeros(&w, 8);                   /* graphicsmode, opcolor */
+    box_end(&w, vmhd);
+
+    size_t dinf = box_begin(&w, "dinf");
+    size_t dref = full_box_begin(&w, "dref", 0, 0);
+    put32(&w, 1);
+    size_t url = full_box_begin(&w, "url ", 0, 1);      /* media in this file */
+    box_end(&w, url);
+    box_end(&w, dref);
+    box_end(&w, dinf);
+
+    size_t stbl = box_begin(&w, "stbl");
+
+    size_t stsd = full_box_begin(&w, "stsd", 0, 0);
+    put32(&w, 1);
+    size_t entry = box_begin(&w, track->codec == FMP4_CODEC_H265 ? "hvc1" : "avc1");
+    put_zeros(&w, 6);
+    put16(&w, 1);                       /* data_reference_index */
+    put_zeros(&w, 16);                  /* pre_defined, reserved */
+    put16(&w, (uint32_t)track->width);
+    put16(&w, (uint32_t)track->height);
+    put32(&w, 0x00480000);              /* 72 dpi */
+    put32(&w, 0x00480000);
+    put32(&w, 0);
+    put16(&w, 1);                       /* frame_count */
+    put_zeros(&w, 32);                  /* compressorname */
+    put16(&w, 0x0018);                  /* depth */
+    put16(&w, 0xFFFF);                  /* pre_defined = -1 */
+    if (track->codec == FMP4_CODEC_H265) {
+        put_hvcc(&w, track);
+    } else {
+        put_avcc(&w, track);
+    }
+    box_end(&w, entry);
+    box_end(&w, stsd);
+
+    /* Samples are all in fragments */
+    put_empty_table(&w, "stts");
+    put_empty_table(&w, "stsc");
+    size_t stsz = full_box_begin(&w, "stsz", 0, 0);
+    put32(&w, 0);                       /* sample_size */
+    put32(&w, 0);                       /* sample_count */
+    box_end(&w, stsz);
+    put_empty_table(&w, "stco");
+
+    box_end(&w, stbl);
+    box_end(&w, minf);
+    box_end(&w, mdia);
+    box_end(&w, trak);
+
+    size_t mvex = box_begin(&w, "mvex");
+    size_t trex = full_box_begin(&w, "trex", 0, 0);
+    put32(&w, 1);                       /* track_ID */
+    put32(&w, 1);                       /* default_sample_description_index */
+    put32(&w, 0);
+    put32(&w, 0);
+    put32(&w, 0);
+    box_end(&w, trex);
+    box_end(&w, mvex);
+
+    box_end(&w, moov);
+    return w.overflow ? 0 : w.len;
+}
+
+size_t fmp4_fragment_bound(size_t au_size) {
+    /* A 3-byte start code becomes a 4-byte length: at most one byte more
+     * per 4-byte NAL, plus the boxes */
+    return au_size + au_size / 4 + 256;
+}
+
+size_t fmp4_fragment(const fmp4_track_t* track, uint32_t sequence, uint64_t decode_time,
+                     uint32_t duration, int keyframe, const uint8_t* au, size_t au_size,
+                     uint8_t* out, size_t out_size) {
+    writer_t w = { out, out_size, 0, 0 };
+
+    size_t moof = box_begin(&w, "moof");
+
+    size_t mfhd = full_box_begin(&w, "mfhd", 0, 0);
+    put32(&w, sequence);
+    box_end(&w, mfhd);
+
+    size_t traf = box_begin(&w, "traf");
+
+    size_t tfhd = full_box_begin(&w, "tfhd", 0, 0x020000);     /* default-base-is-moof */
+    put32(&w, 1);
+    box_end(&w, tfhd);
+
+    size_t tfdt = full_box_begin(&w, "tfdt", 1, 0);
+    put64(&w, decode_time);
+    box_end(&w, tfdt);
+
+    /* One sample: data offset, duration, size and flags present */
+    size_t trun = full_box_begin(&w, "trun", 0, 0x000701);
+    put32(&w, 1);
+    size_t data_offset_at = w.len;
+    put32(&w, 0);
+    put32(&w, duration);
+    size_t sample_size_at = w.len;
+    put32(&w, 0);
+    put32(&w, keyframe ? SAMPLE_FLAGS_SYNC : SAMPLE_FLAGS_DELTA);
+    box_end(&w, trun);
+
+    box_end(&w, traf);
+    box_end(&w, moof);
+
+    size_t mdat = box_begin(&w, "mdat");
+    const uint8_t* pos = au;
+    const uint8_t* end = au + au_size;
+    const uint8_t* nal;
+    size_t size;
+    int pictures = 0;
+
+    while ((nal = next_nal(&pos, end, &size)) != NULL) {
+        if (size == 0) continue;
+        int type = nal_type(track->codec, nal);
+        if (is_out_of_band(track->codec, type)) continue;
+        pictures += is_vcl(track->codec, type);
+        put32(&w, (uint32_t)size);
+        put_bytes(&w, nal, size);
+    }
+    box_end(&w, mdat);
+
+    if (w.overflow || pictures == 0) return 0;
+    patch32(&w, data_offset_at, (uint32_t)(mdat + 8 - moof));
+    patch32(&w, sample_size_at, (uint32_t)(w.len - mdat - 8));
+    return w.len;
+}
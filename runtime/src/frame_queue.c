@@ -0,0 +1,182 @@
+/**
+ * CiRA Runtime - Bounded SPSC Frame Queue
+ *
+ * The fast path is lock-free: the producer owns `head`, the consumer
+ * advances `tail`. With FRAME_QUEUE_DROP_OLDEST the producer may also
+ * advance `tail` to evict the oldest item, so both sides claim items with
+ * a compare-and-swap on `tail`. Indices are 64-bit and never wrap, which
+ * rules out ABA. A mutex/condvar pair is used only to park an idle
+ * consumer; it is never taken while items are flowing.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "frame_queue.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+struct frame_queue {
+    int capacity;
+    int policy;
+
+    _Atomic uint64_t head;      /* Next slot to write (producer) */
+    _Atomic uint64_t tail;      /* Next slot to read (consumer, or producer on drop) */
+    _Atomic uint64_t dropped;   /* Items dropped because the queue was full */
+
+    /* Consumer parking */
+    _Atomic int waiting;
+    _Atomic int woken;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    void* _Atomic slots[FRAME_QUEUE_MAX_CAPACITY];
+};
+
+frame_queue_t* frame_queue_create(int capacity, int policy) {
+    if (capacity < 1) capacity = 1;
+    if (capacity > FRAME_QUEUE_MAX_CAPACITY) capacity = FRAME_QUEUE_MAX_CAPACITY;
+
+    frame_queue_t* q = (frame_queue_t*)calloc(1, sizeof(frame_queue_t));
+    if (!q) return NULL;
+
+    q->capacity = capacity;
+    q->policy = (policy == FRAME_QUEUE_DROP_NEWEST) ? FRAME_QUEUE_DROP_NEWEST
+                                                    : FRAME_QUEUE_DROP_OLDEST;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->dropped, 0);
+    atomic_init(&q->waiting, 0);
+    atomic_init(&q->woken, 0);
+    for (int i = 0; i < FRAME_QUEUE_MAX_CAPACITY; i++) {
+        atomic_init(&q->slots[i], NULL);
+    }
+
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->cond, NULL);
+
+    return q;
+}
+
+void frame_queue_destroy(frame_queue_t* q) {
+    if (!q) return;
+    pthread_mutex_destroy(&q->mutex);
+    pthread_cond_destroy(&q->cond);
+    free(q);
+}
+
+int frame_queue_push(frame_queue_t* q, void* item, void** dropped) {
+    if (dropped) *dropped = NULL;
+    if (!q || !item) return 0;
+
+    uint64_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    for (;;) {
+        uint64_t t = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (h - t < (uint64_t)q->capacity) break;
+
+        if (q->policy == FRAME_QUEUE_DROP_NEWEST) {
+            atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+            if (dropped) *dropped = item;
+            return 0;
+        }
+
+        /* Evict the oldest item; if the consumer claims it first, retry */
+        void* oldest = atomic_load_explicit(&q->slots[t % q->capacity], memory_order_acquire);
+        if (atomic_compare_exchange_weak_explicit(&q->tail, &t, t + 1,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+            if (dropped) *dropped = oldest;
+            break;
+        }
+    }
+
+    atomic_store_explicit(&q->slots[h % q->capacity], item, memory_order_release);
+    atomic_store_explicit(&q->head, h + 1, memory_order_seq_cst);
+
+    /* Wake a parked consumer (only pays for the mutex when someone waits) */
+    if (atomic_load_explicit(&q->waiting, memory_order_seq_cst)) {
+        pthread_mutex_lock(&q->mutex);
+        pthread_cond_signal(&q->cond);
+        pthread_mutex_unlock(&q->mutex);
+    }
+
+    return 1;
+}
+
+void* frame_queue_pop(frame_queue_t* q) {
+    if (!q) return NULL;
+
+    for (;;) {
+        uint64_t t = atomic_load_explicit(&q->tail, memory_order_acquire);
+        uint64_t h = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (t == h) return NULL;
+
+        void* item = atomic_load_explicit(&q->slots[t % q->capacity], memory_order_acquire);
+        if (atomic_compare_exchange_weak_explicit(&q->tail, &t, t + 1,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            return item;
+        }
+        /* Producer evicted this item - try the next one */
+    }
+}
+
+void* frame_queue_pop_wait(frame_queue_t* q, int timeout_ms) {
+    if (!q) return NULL;
+
+    void* item = frame_queue_pop(q);
+    if (item || timeout_ms <= 0) return item;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&q->mutex);
+    atomic_store_explicit(&q->waiting, 1, memory_order_seq_cst);
+
+    while (!atomic_load(&q->woken) &&
+           atomic_load_explicit(&q->head, memory_order_seq_cst) ==
+           atomic_load_explicit(&q->tail, memory_order_acquire)) {
+        if (pthread_cond_timedwait(&q->cond, &q->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+
+    atomic_store_explicit(&q->waiting, 0, memory_order_seq_cst);
+    atomic_store(&q->woken, 0);
+    pthread_mutex_unlock(&q->mutex);
+
+    return frame_queue_pop(q);
+}
+
+void frame_queue_wake(frame_queue_t* q) {
+    if (!q) return;
+    pthread_mutex_lock(&q->mutex);
+    atomic_store(&q->woken, 1);
+    pthread_cond_broadcast(&q->cond);
+    pthread_mutex_unlock(&q->mutex);
+}
+
+int frame_queue_depth(frame_queue_t* q) {
+    if (!q) return 0;
+    uint64_t t = atomic_load_explicit(&q->tail, memory_order_acquire);
+    uint64_t h = atomic_load_explicit(&q->head, memory_order_acquire);
+    return (h > t) ? (int)(h - t) : 0;
+}
+
+int frame_queue_capacity(frame_queue_t* q) {
+    return q ? q->capacity : 0;
+}
+
+uint64_t frame_queue_dropped(frame_queue_t* q) {
+    return q ? atomic_load_explicit(&q->dropped, memory_order_relaxed) : 0;
+}
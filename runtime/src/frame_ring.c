@@ -0,0 +1,323 @@
+/**
+ * CiRA Runtime - Shared-Memory Frame Ring
+ *
+ * One writer process maps the ring read-write; readers map it read-only,
+ * so a reader can never disturb the writer. Shared fields are plain
+ * integers (the layout is read from other languages) accessed with the
+ * compiler's __atomic builtins. Writers in this process are serialized by
+ * a mutex, so the seqlock only has to order one writer against readers.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "frame_ring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/* Layout is shared with other processes and languages */
+_Static_assert(sizeof(frame_ring_header_t) == 64, "frame ring header must be 64 bytes");
+_Static_assert(sizeof(frame_ring_slot_t) == 64, "frame ring slot header must be 64 bytes");
+_Static_assert(sizeof(frame_ring_detection_t) == 24, "frame ring detection must be 24 bytes");
+
+#ifndef _WIN32
+
+#include <pthread.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct frame_ring {
+    char name[64];
+    int writer;                 /* 1 if created (and unlinked on destroy) by us */
+    uint8_t* base;
+    size_t size;
+    frame_ring_header_t* header;
+    pthread_mutex_t write_mutex;
+};
+
+static frame_ring_slot_t* slot_at(const frame_ring_t* ring, uint32_t index) {
+    return (frame_ring_slot_t*)(ring->base + ring->header->header_size +
+                                (size_t)index * ring->header->slot_size);
+}
+
+static frame_ring_detection_t* slot_detections(frame_ring_slot_t* slot) {
+    return (frame_ring_detection_t*)((uint8_t*)slot + sizeof(frame_ring_slot_t));
+}
+
+static uint8_t* slot_payload(frame_ring_slot_t* slot) {
+    return (uint8_t*)slot + FRAME_RING_PAYLOAD_OFFSET;
+}
+
+/* shm_open wants a leading slash */
+static void shm_path(const char* name, char* out, size_t out_size) {
+    snprintf(out, out_size, "/%s", name[0] == '/' ? name + 1 : name);
+}
+
+frame_ring_t* frame_ring_create(const char* name, int slots, size_t payload_capacity) {
+    if (!name || !name[0] || payload_capacity == 0) return NULL;
+    if (slots < FRAME_RING_MIN_SLOTS) slots = FRAME_RING_MIN_SLOTS;
+    if (slots > FRAME_RING_MAX_SLOTS) slots = FRAME_RING_MAX_SLOTS;
+
+    frame_ring_t* ring = (frame_ring_t*)calloc(1, sizeof(frame_ring_t));
+    if (!ring) return NULL;
+    snprintf(ring->name, sizeof(ring->name), "%s", name[0] == '/' ? name + 1 : name);
+    ring->writer = 1;
+
+    /* Slots are cache-line aligned */
+    size_t slot_size = (FRAME_RING_PAYLOAD_OFFSET + payload_capacity + 63) & ~(size_t)63;
+    ring->size = sizeof(frame_ring_header_t) + (size_t)slots * slot_size;
+
+    /* Replace a ring left behind by a previous run */
+    char path[80];
+    shm_path(ring->name, path, sizeof(path));
+    shm_unlink(path);
+
+    int fd = shm_open(path, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Frame ring: cannot create %s\n", path);
+        free(ring);
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)ring->size) != 0) {
+        fprintf(stderr, "Frame ring: cannot size %s to %zu bytes\n", path, ring->size);
+        close(fd);
+        shm_unlink(path);
+        free(ring);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(path);
+        free(ring);
+        return NULL;
+    }
+    ring->base = (uint8_t*)base;
+    ring->header = (frame_ring_header_t*)base;
+
+    /* ftruncate zero-fills, so every slot starts unlocked and empty */
+    frame_ring_header_t* hdr = ring->header;
+    hdr->version = FRAME_RING_VERSION;
+    hdr->header_size = sizeof(frame_ring_header_t);
+    hdr->slot_count = (uint32_t)slots;
+    hdr->slot_size = slot_size;
+    hdr->payload_capacity = slot_size - FRAME_RING_PAYLOAD_OFFSET;
+    hdr->writer_pid = (uint32_t)getpid();
+    __atomic_store_n(&hdr->magic, FRAME_RING_MAGIC, __ATOMIC_RELEASE);
+
+    pthread_mutex_init(&ring->write_mutex, NULL);
+    fprintf(stderr, "Frame ring: %s, %d slots of %.1f MB\n",
+            path, slots, slot_size / (1024.0 * 1024.0));
+    return ring;
+}
+
+void frame_ring_destroy(frame_ring_t* ring) {
+    if (!ring) return;
+    munmap(ring->base, ring->size);
+    if (ring->writer) {
+        char path[80];
+        shm_path(ring->name, path, sizeof(path));
+        shm_unlink(path);
+        pthread_mutex_destroy(&ring->write_mutex);
+    }
+    free(ring);
+}
+
+uint64_t frame_ring_publish(frame_ring_t* ring, int camera, int format, int w, int h,
+                            const void* data, size_t size,
+                            const frame_ring_detection_t* dets, int count) {
+    if (!ring || !ring->writer || !data) return 0;
+
+    frame_ring_header_t* hdr = ring->header;
+    if (size > hdr->payload_capacity) return 0;
+    if (count < 0 || !dets) count = 0;
+    if (count > FRAME_RING_MAX_DETECTIONS) count = FRAME_RING_MAX_DETECTIONS;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    pthread_mutex_lock(&ring->write_mutex);
+
+    uint64_t seq = hdr->write_seq + 1;
+    frame_ring_slot_t* slot = slot_at(ring, (uint32_t)((seq - 1) % hdr->slot_count));
+
+    /* Odd lock before any data changes */
+    uint64_t lock = slot->lock;
+    __atomic_store_n(&slot->lock, lock + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->seq = seq;
+    slot->timestamp_us = (uint64_t)ts.tv_sec * 1000000u + (uint64_t)(ts.tv_nsec / 1000);
+    slot->camera = (uint32_t)camera;
+    slot->format = (uint32_t)format;
+    slot->width = (uint32_t)w;
+    slot->height = (uint32_t)h;
+    slot->payload_size = (uint32_t)size;
+    slot->detection_count = (uint32_t)count;
+    if (count > 0) {
+        memcpy(slot_detections(slot), dets, (size_t)count * sizeof(frame_ring_detection_t));
+    }
+    memcpy(slot_payload(slot), data, size);
+
+    /* Even again: slot complete, then advertise it */
+    __atomic_store_n(&slot->lock, lock + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&hdr->write_seq, seq, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&ring->write_mutex);
+    return seq;
+}
+
+frame_ring_t* frame_ring_open(const char* name) {
+    if (!name || !name[0]) return NULL;
+
+    char path[80];
+    shm_path(name, path, sizeof(path));
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(frame_ring_header_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    /* Reject anything that is not a complete ring of this version */
+    const frame_ring_header_t* hdr = (const frame_ring_header_t*)base;
+    if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != FRAME_RING_MAGIC ||
+        hdr->version != FRAME_RING_VERSION || hdr->slot_count == 0 ||
+        hdr->slot_size < FRAME_RING_PAYLOAD_OFFSET ||
+        hdr->header_size + (uint64_t)hdr->slot_count * hdr->slot_size > (uint64_t)st.st_size) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+
+    frame_ring_t* ring = (frame_ring_t*)calloc(1, sizeof(frame_ring_t));
+    if (!ring) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    snprintf(ring->name, sizeof(ring->name), "%s", name[0] == '/' ? name + 1 : name);
+    ring->base = (uint8_t*)base;
+    ring->size = (size_t)st.st_size;
+    ring->header = (frame_ring_header_t*)base;
+    return ring;
+}
+
+/* Copy one slot; 1 if the copy is consistent, 0 if torn, -1 if buf is too small */
+static int copy_slot(frame_ring_slot_t* slot, frame_ring_frame_t* frame, void* buf, size_t buf_size) {
+    uint64_t lock = __atomic_load_n(&slot->lock, __ATOMIC_ACQUIRE);
+    if (lock & 1) return 0;
+
+    frame->seq = slot->seq;
+    frame->timestamp_us = slot->timestamp_us;
+    frame->camera = (int)slot->camera;
+    frame->format = (int)slot->format;
+    frame->width = (int)slot->width;
+    frame->height = (int)slot->height;
+    frame->payload_size = slot->payload_size;
+    frame->detection_count = (int)slot->detection_count;
+    if (frame->detection_count > FRAME_RING_MAX_DETECTIONS) return 0;
+
+    int fits = frame->payload_size <= buf_size;
+    memcpy(frame->detections, slot_detections(slot),
+           (size_t)frame->detection_count * sizeof(frame_ring_detection_t));
+    if (fits) {
+        memcpy(buf, slot_payload(slot), frame->payload_size);
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->lock, __ATOMIC_RELAXED) != lock) return 0;
+    return fits ? 1 : -1;
+}
+
+int frame_ring_read_latest(const frame_ring_t* ring, int camera, frame_ring_frame_t* frame,
+                           void* buf, size_t buf_size) {
+    if (!ring || !frame || !buf) return 0;
+    const frame_ring_header_t* hdr = ring->header;
+
+    /* The writer laps a slot only after slot_count newer frames, so a few
+     * retries always succeed unless the reader is descheduled for that long */
+    for (int attempt = 0; attempt < 8; attempt++) {
+        uint64_t latest = __atomic_load_n(&hdr->write_seq, __ATOMIC_ACQUIRE);
+        if (latest == 0) return 0;
+
+        /* Newest slot holding this camera */
+        frame_ring_slot_t* best = NULL;
+        uint64_t best_seq = 0;
+        for (uint32_t i = 0; i < hdr->slot_count; i++) {
+            frame_ring_slot_t* slot = slot_at(ring, i);
+            uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+            if (seq > best_seq && (camera < 0 || (int)slot->camera == camera)) {
+                best = slot;
+                best_seq = seq;
+            }
+        }
+        if (!best) return 0;
+
+        int r = copy_slot(best, frame, buf, buf_size);
+        if (r != 0 && frame->seq != best_seq) continue;  /* Lapped since it was picked */
+        if (r < 0) return 0;
+        if (r > 0 && (camera < 0 || frame->camera == camera)) return 1;
+    }
+    return 0;
+}
+
+uint64_t frame_ring_sequence(const frame_ring_t* ring) {
+    return ring ? __atomic_load_n(&ring->header->write_seq, __ATOMIC_ACQUIRE) : 0;
+}
+
+const char* frame_ring_name(const frame_ring_t* ring) {
+    return ring ? ring->name : "";
+}
+
+#else /* _WIN32 */
+
+/* No POSIX shared memory: the ring is unavailable */
+frame_ring_t* frame_ring_create(const char* name, int slots, size_t payload_capacity) {
+    (void)name; (void)slots; (void)payload_capacity;
+    fprintf(stderr, "Frame ring: shared memory not supported on this platform\n");
+    return NULL;
+}
+
+void frame_ring_destroy(frame_ring_t* ring) {
+    (void)ring;
+}
+
+uint64_t frame_ring_publish(frame_ring_t* ring, int camera, int format, int w, int h,
+                            const void* data, size_t size,
+                            const frame_ring_detection_t* dets, int count) {
+    (void)ring; (void)camera; (void)format; (void)w; (void)h;
+    (void)data; (void)size; (void)dets; (void)count;
+    return 0;
+}
+
+frame_ring_t* frame_ring_open(const char* name) {
+    (void)name;
+    return NULL;
+}
+
+int frame_ring_read_latest(const frame_ring_t* ring, int camera, frame_ring_frame_t* frame,
+                           void* buf, size_t buf_size) {
+    (void)ring; (void)camera; (void)frame; (void)buf; (void)buf_size;
+    return 0;
+}
+
+uint64_t frame_ring_sequence(const frame_ring_t* ring) {
+    (void)ring;
+    return 0;
+}
+
+const char* frame_ring_name(const frame_ring_t* ring) {
+    (void)ring;
+    return "";
+}
+
+#endif /* _WIN32 */
@@ -0,0 +1,244 @@
+/**
+ * CiRA Runtime - Latest-Frame Store
+ *
+ * Each slot carries an atomic reference count. The store itself holds one
+ * reference on the published slot; readers add one each. SLOT_WRITING marks
+ * a slot claimed by the writer, which may only claim slots whose count is
+ * zero. Readers only increment a count that is already non-zero, so once a
+ * reader holds a reference the slot cannot be claimed for writing.
+ *
+ * Notification is the only locked part: commit takes the wait mutex only
+ * when a reader is blocked in frame_store_wait() or a callback is set, so
+ * a store nobody waits on stays lock-free.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "frame_store.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+/* Refcount flag: slot is being written */
+#define SLOT_WRITING 0x40000000
+
+struct frame_slot {
+    _Atomic int refcount;
+    uint8_t* data;
+    size_t capacity;
+    int w;
+    int h;
+    uint64_t seq;
+};
+
+struct frame_store {
+    int num_slots;
+    frame_slot_t slots[FRAME_STORE_MAX_SLOTS];
+    frame_slot_t* _Atomic latest;
+    _Atomic uint64_t sequence;
+    _Atomic uint64_t dropped;
+
+    /* New-frame notification */
+    pthread_mutex_t wait_mutex;
+    pthread_cond_t wait_cond;
+    _Atomic int waiters;                /* Readers in frame_store_wait() */
+    _Atomic int has_notify;             /* notify_fn is set */
+    frame_store_notify_fn notify_fn;    /* Guarded by wait_mutex */
+    void* notify_arg;
+};
+
+frame_store_t* frame_store_create(int num_slots) {
+    if (num_slots < 3) num_slots = 3;
+    if (num_slots > FRAME_STORE_MAX_SLOTS) num_slots = FRAME_STORE_MAX_SLOTS;
+
+    frame_store_t* store = (frame_store_t*)calloc(1, sizeof(frame_store_t));
+    if (!store) return NULL;
+
+    store->num_slots = num_slots;
+    for (int i = 0; i < FRAME_STORE_MAX_SLOTS; i++) {
+        atomic_init(&store->slots[i].refcount, 0);
+    }
+    atomic_init(&store->latest, NULL);
+    atomic_init(&store->sequence, 0);
+    atomic_init(&store->dropped, 0);
+    atomic_init(&store->waiters, 0);
+    atomic_init(&store->has_notify, 0);
+    pthread_mutex_init(&store->wait_mutex, NULL);
+    pthread_cond_init(&store->wait_cond, NULL);
+
+    return store;
+}
+
+void frame_store_destroy(frame_store_t* store) {
+    if (!store) return;
+    for (int i = 0; i < store->num_slots; i++) {
+        free(store->slots[i].data);
+    }
+    pthread_cond_destroy(&store->wait_cond);
+    pthread_mutex_destroy(&store->wait_mutex);
+    free(store);
+}
+
+/* Claim a free slot: prefer one whose buffer is already big enough */
+static frame_slot_t* claim_slot(frame_store_t* store, size_t need) {
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < store->num_slots; i++) {
+            frame_slot_t* s = &store->slots[i];
+            if (pass == 0 && s->capacity < need) continue;
+
+            int expected = 0;
+            if (atomic_load_explicit(&s->refcount, memory_order_relaxed) == 0 &&
+                atomic_compare_exchange_strong_explicit(&s->refcount, &expected, SLOT_WRITING,
+                                                        memory_order_acq_rel,
+                                                        memory_order_relaxed)) {
+                return s;
+            }
+        }
+    }
+    return NULL;
+}
+
+uint8_t* frame_store_begin_write(frame_store_t* store, int w, int h, frame_slot_t** slot) {
+    if (slot) *slot = NULL;
+    if (!store || !slot || w <= 0 || h <= 0) return NULL;
+
+    size_t need = (size_t)w * (size_t)h * 3;
+    frame_slot_t* s = claim_slot(store, need);
+    if (!s) {
+        atomic_fetch_add_explicit(&store->dropped, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    /* Only the writer touches a claimed slot, so resizing is safe */
+    if (s->capacity < need) {
+        free(s->data);
+        s->data = (uint8_t*)malloc(need);
+        s->capacity = s->data ? need : 0;
+        if (!s->data) {
+            atomic_store_explicit(&s->refcount, 0, memory_order_release);
+            return NULL;
+        }
+    }
+
+    s->w = w;
+    s->h = h;
+    *slot = s;
+    return s->data;
+}
+
+uint64_t frame_store_commit(frame_store_t* store, frame_slot_t* slot, int keep_ref) {
+    if (!store || !slot) return 0;
+
+    slot->seq = atomic_fetch_add_explicit(&store->sequence, 1, memory_order_relaxed) + 1;
+    uint64_t seq = slot->seq;
+
+    /* One reference for the store, plus one for the writer if requested */
+    atomic_store_explicit(&slot->refcount, keep_ref ? 2 : 1, memory_order_release);
+
+    frame_slot_t* old = atomic_exchange_explicit(&store->latest, slot, memory_order_acq_rel);
+    if (old) {
+        frame_store_release(old);
+    }
+
+    if (atomic_load_explicit(&store->waiters, memory_order_seq_cst) > 0 ||
+        atomic_load_explicit(&store->has_notify, memory_order_relaxed)) {
+        pthread_mutex_lock(&store->wait_mutex);
+        pthread_cond_broadcast(&store->wait_cond);
+        if (store->notify_fn) {
+            store->notify_fn(store->notify_arg, store, seq);
+        }
+        pthread_mutex_unlock(&store->wait_mutex);
+    }
+
+    return seq;
+}
+
+void frame_store_cancel(frame_store_t* store, frame_slot_t* slot) {
+    (void)store;
+    if (!slot) return;
+    atomic_store_explicit(&slot->refcount, 0, memory_order_release);
+}
+
+frame_slot_t* frame_store_acquire(frame_store_t* store) {
+    if (!store) return NULL;
+
+    for (;;) {
+        frame_slot_t* s = atomic_load_explicit(&store->latest, memory_order_acquire);
+        if (!s) return NULL;
+
+        int v = atomic_load_explicit(&s->refcount, memory_order_acquire);
+        while (v > 0 && !(v & SLOT_WRITING)) {
+            if (atomic_compare_exchange_weak_explicit(&s->refcount, &v, v + 1,
+                                                      memory_order_acq_rel,
+                                                      memory_order_acquire)) {
+                return s;
+            }
+        }
+        /* Slot was unpublished and recycled under us - latest has moved on */
+    }
+}
+
+void frame_store_release(frame_slot_t* slot) {
+    if (!slot) return;
+    atomic_fetch_sub_explicit(&slot->refcount, 1, memory_order_acq_rel);
+}
+
+const uint8_t* frame_slot_data(const frame_slot_t* slot, int* w, int* h, uint64_t* seq) {
+    if (!slot) {
+        if (w) *w = 0;
+        if (h) *h = 0;
+        if (seq) *seq = 0;
+        return NULL;
+    }
+    if (w) *w = slot->w;
+    if (h) *h = slot->h;
+    if (seq) *seq = slot->seq;
+    return slot->data;
+}
+
+uint64_t frame_store_sequence(frame_store_t* store) {
+    return store ? atomic_load_explicit(&store->sequence, memory_order_relaxed) : 0;
+}
+
+uint64_t frame_store_dropped(frame_store_t* store) {
+    return store ? atomic_load_explicit(&store->dropped, memory_order_relaxed) : 0;
+}
+
+uint64_t frame_store_wait(frame_store_t* store, uint64_t after_seq, int timeout_ms) {
+    if (!store) return after_seq;
+
+    uint64_t seq = atomic_load_explicit(&store->sequence, memory_order_acquire);
+    if (seq != after_seq || timeout_ms <= 0) return seq;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    /* Register before re-checking, so a commit in between sees the waiter */
+    pthread_mutex_lock(&store->wait_mutex);
+    atomic_fetch_add_explicit(&store->waiters, 1, memory_order_seq_cst);
+    while ((seq = atomic_load_explicit(&store->sequence, memory_order_seq_cst)) == after_seq) {
+        if (pthread_cond_timedwait(&store->wait_cond, &store->wait_mutex, &deadline) != 0) {
+            seq = atomic_load_explicit(&store->sequence, memory_order_acquire);
+            break;
+        }
+    }
+    atomic_fetch_sub_explicit(&store->waiters, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&store->wait_mutex);
+    return seq;
+}
+
+void frame_store_set_notify(frame_store_t* store, frame_store_notify_fn fn, void* arg) {
+    if (!store) return;
+    pthread_mutex_lock(&store->wait_mutex);
+    store->notify_fn = fn;
+    store->notify_arg = arg;
+    atomic_store_explicit(&store->has_notify, fn != NULL, memory_order_relaxed);
+    pthread_mutex_unlock(&store->wait_mutex);
+}
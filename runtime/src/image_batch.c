@@ -0,0 +1,520 @@
+/**
+ * CiRA Runtime - Stored-Image Batches
+ *
+ * Decode threads take the next path, decode it, then wait for a slot in
+ * the in-flight window before queueing it with
+ * cira_predict_image_async(). The completion callback, on the predict
+ * worker, formats the result line and frees the slot. Once every decode
+ * thread has run out of paths and the last image completed, the summary
+ * line is appended and the batch is finished.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "image_batch.h"
+#include "image_decoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <strings.h>
+#endif
+
+/* Room for a result line beyond its detections */
+#define LINE_HEADROOM 10240
+
+/* One image between decode and its result */
+typedef struct {
+    image_batch_t* batch;
+    int index;
+    int src_w, src_h;       /* Size in the file */
+    int w, h;               /* Decoded size */
+    double decode_ms;
+    double submit_ms;
+} batch_item_t;
+
+struct image_batch {
+    cira_ctx* ctx;
+    char** paths;
+    int count;
+    image_batch_notify_fn notify;
+    void* notify_arg;
+    pthread_t threads[CIRA_DECODE_MAX_THREADS];
+    int num_threads;
+    double start_ms;
+
+    pthread_mutex_t mutex;      /* Guards the fields below */
+    pthread_cond_t slot_cond;   /* An image in flight completed, or cancel */
+    pthread_cond_t out_cond;    /* Output appended, or finished */
+    int next;                   /* Next path to decode */
+    int window;                 /* Most images in flight */
+    int in_flight;              /* Queued for inference, not completed */
+    int callbacks;              /* Completions still to return from notify */
+    int decoders;               /* Decode threads still taking paths */
+    int succeeded;
+    int failed;
+    int cancelled;
+    int finished;               /* Summary line appended */
+    char* out;                  /* Output not read yet: out[out_pos..out_len) */
+    size_t out_len, out_pos, out_cap;
+};
+
+int image_json_escape(const char* s, char* out, size_t out_size) {
+    if (out_size == 0) return 0;
+    size_t n = 0;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        char esc[8];
+        size_t len;
+        if (c == '"' || c == '\\') {
+            esc[0] = '\\';
+            esc[1] = (char)c;
+            len = 2;
+        } else if (c < 0x20) {
+            len = (size_t)snprintf(esc, sizeof(esc), "\\u%04x", c);
+        } else {
+            esc[0] = (char)c;
+            len = 1;
+        }
+        if (n + len >= out_size) break;
+        memcpy(out + n, esc, len);
+        n += len;
+    }
+    out[n] = '\0';
+    return (int)n;
+}
+
+int image_result_members(cira_ctx* ctx, cira_request* req, int src_w, int src_h,
+                         char* out, size_t out_size) {
+    if (out_size == 0) return 0;
+    char* p = out;
+    char* end = out + out_size;
+    int count = cira_request_count(req);
+
+    p += snprintf(p, end - p, "\"detections\":[");
+    int written = 0;
+    for (int i = 0; i < count && p < end - 256; i++) {
+        cira_result_record_t r;
+        if (cira_request_detection(req, i, &r) != CIRA_OK) continue;
+        p += snprintf(p, end - p,
+            "%s{\"label\":\"%s\",\"confidence\":%.3f,\"bbox\":[%d,%d,%d,%d]}",
+            written ? "," : "", cira_get_label(ctx, r.label_id), r.confidence,
+            (int)(r.x * src_w), (int)(r.y * src_h), (int)(r.w * src_w), (int)(r.h * src_h));
+        written++;
+    }
+    if (p < end) p += snprintf(p, end - p, "],\"count\":%d", written);
+    return p < end ? (int)(p - out) : (int)out_size - 1;
+}
+
+/* Append one line of output. Caller holds mutex. */
+static void append_locked(image_batch_t* b, const char* line, size_t len) {
+    if (b->out_pos == b->out_len) {
+        b->out_pos = b->out_len = 0;
+    }
+    if (b->out_len + len + 1 > b->out_cap) {
+        size_t cap = b->out_cap ? b->out_cap : 65536;
+        while (cap < b->out_len + len + 1) cap *= 2;
+        char* grown = (char*)realloc(b->out, cap);
+        if (!grown) return;     /* The line is lost; the summary still counts it */
+        b->out = grown;
+        b->out_cap = cap;
+    }
+    memcpy(b->out + b->out_len, line, len);
+    b->out_len += len;
+    b->out[b->out_len++] = '\n';
+    pthread_cond_broadcast(&b->out_cond);
+}
+
+/* Append the summary once nothing is left to decode or infer. Caller holds mutex. */
+static int finish_locked(image_batch_t* b) {
+    if (b->finished || b->decoders > 0 || b->in_flight > 0) return 0;
+
+    double elapsed = cira_time_ms() - b->start_ms;
+    int images = b->succeeded + b->failed;
+    char line[256];
+    int len = snprintf(line, sizeof(line),
+        "{\"done\":true,\"images\":%d,\"succeeded\":%d,\"failed\":%d,"
+        "\"elapsed_ms\":%.1f,\"images_per_sec\":%.1f}",
+        images, b->succeeded, b->failed, elapsed,
+        elapsed > 0 ? images * 1000.0 / elapsed : 0.0);
+    append_locked(b, line, (size_t)len);
+    b->finished = 1;
+    pthread_cond_broadcast(&b->out_cond);
+    return 1;
+}
+
+/* Result line of an image that failed before or during inference */
+static void fail_image(image_batch_t* b, int index, const char* error) {
+    char path[2048];
+    char err[512];
+    char line[3072];
+    image_json_escape(b->paths[index], path, sizeof(path));
+    image_json_escape(error, err, sizeof(err));
+    int len = snprintf(line, sizeof(line),
+        "{\"index\":%d,\"path\":\"%s\",\"success\":false,\"error\":\"%s\"}", index, path, err);
+    if (len >= (int)sizeof(line)) len = (int)sizeof(line) - 1;
+
+    pthread_mutex_lock(&b->mutex);
+    append_locked(b, line, (size_t)len);
+    b->failed++;
+    pthread_mutex_unlock(&b->mutex);
+    if (b->notify) b->notify(b->notify_arg, b);
+}
+
+/* Request completion, on the predict worker: format the line and free the slot */
+static void image_done(cira_request* req, void* user_data) {
+    batch_item_t* item = (batch_item_t*)user_data;
+    image_batch_t* b = item->batch;
+    double latency = cira_time_ms() - item->submit_ms;
+    int status = cira_request_status(req);
+
+    size_t size = CIRA_MAX_JSON_LEN + LINE_HEADROOM;
+    char* line = (char*)malloc(size);
+    int len = 0;
+    if (line) {
+        char path[2048];
+        image_json_escape(b->paths[item->index], path, sizeof(path));
+        len = snprintf(line, size,
+            "{\"index\":%d,\"path\":\"%s\",\"success\":%s,\"width\":%d,\"height\":%d,"
+            "\"decoded_width\":%d,\"decoded_height\":%d,\"decode_ms\":%.2f,\"latency_ms\":%.2f,",
+            item->index, path, status == CIRA_OK ? "true" : "false",
+            item->src_w, item->src_h, item->w, item->h, item->decode_ms, latency);
+        if (status == CIRA_OK) {
+            len += image_result_members(b->ctx, req, item->src_w, item->src_h,
+                                        line + len, size - len - 1);
+        } else {
+            len += snprintf(line + len, size - len - 1, "\"error\":\"Inference failed (%d)\"", status);
+        }
+        line[len++] = '}';
+    }
+
+    pthread_mutex_lock(&b->mutex);
+    if (line) append_locked(b, line, (size_t)len);
+    if (status == CIRA_OK) {
+        b->succeeded++;
+    } else {
+        b->failed++;
+    }
+    b->in_flight--;
+    b->callbacks++;
+    finish_locked(b);
+    pthread_cond_broadcast(&b->slot_cond);
+    pthread_mutex_unlock(&b->mutex);
+
+    free(line);
+    free(item);
+    if (b->notify) b->notify(b->notify_arg, b);
+
+    /* Only now may image_batch_destroy() free the batch */
+    pthread_mutex_lock(&b->mutex);
+    b->callbacks--;
+    pthread_cond_broadcast(&b->slot_cond);
+    pthread_mutex_unlock(&b->mutex);
+}
+
+/*
+ * Queue a decoded image, waiting for a slot. A refusal while our own
+ * images are in flight is taken as the async queue being full (shared
+ * with other callers) and retried after one of them completes.
+ */
+static void submit_image(image_batch_t* b, batch_item_t* item, const decoded_image_t* img) {
+    pthread_mutex_lock(&b->mutex);
+    for (;;) {
+        while (b->in_flight >= b->window && !b->cancelled) {
+            pthread_cond_wait(&b->slot_cond, &b->mutex);
+        }
+        if (b->cancelled) break;
+
+        b->in_flight++;
+        pthread_mutex_unlock(&b->mutex);
+
+        item->submit_ms = cira_time_ms();
+        cira_request* req = cira_predict_image_async(b->ctx, img->pixels, img->w, img->h, 3,
+                                                     image_done, item);
+        if (req) {
+            cira_request_release(req);      /* The callback still runs */
+            return;
+        }
+
+        pthread_mutex_lock(&b->mutex);
+        b->in_flight--;
+        if (b->in_flight == 0) break;
+        /* Wait for one of ours to complete, then retry */
+        int before = b->succeeded + b->failed;
+        while (b->succeeded + b->failed == before && b->in_flight > 0 && !b->cancelled) {
+            pthread_cond_wait(&b->slot_cond, &b->mutex);
+        }
+    }
+    int cancelled = b->cancelled;
+    pthread_mutex_unlock(&b->mutex);
+
+    if (!cancelled) {
+        const char* error = cira_error(b->ctx);
+        fail_image(b, item->index, error && error[0] ? error : "Inference refused");
+    }
+    free(item);
+}
+
+static void* decode_thread(void* arg) {
+    image_batch_t* b = (image_batch_t*)arg;
+    cira_pin_thread(b->ctx, CPU_CLASS_ENCODE);
+
+    for (;;) {
+        pthread_mutex_lock(&b->mutex);
+        if (b->cancelled || b->next >= b->count) {
+            pthread_mutex_unlock(&b->mutex);
+            break;
+        }
+        int index = b->next++;
+        pthread_mutex_unlock(&b->mutex);
+
+        double t0 = cira_time_ms();
+        decoded_image_t img;
+        char err[256] = "";
+        int result = image_decode_file(b->paths[index], b->ctx->input_w, b->ctx->input_h,
+                                       &img, err, sizeof(err));
+        if (result != CIRA_OK) {
+            fail_image(b, index, err);
+            continue;
+        }
+
+        batch_item_t* item = (batch_item_t*)calloc(1, sizeof(batch_item_t));
+        if (!item) {
+            image_free(&img);
+            fail_image(b, index, "Out of memory");
+            continue;
+        }
+        item->batch = b;
+        item->index = index;
+        item->src_w = img.src_w;
+        item->src_h = img.src_h;
+        item->w = img.w;
+        item->h = img.h;
+        item->decode_ms = cira_time_ms() - t0;
+
+        submit_image(b, item, &img);
+        image_free(&img);
+    }
+
+    pthread_mutex_lock(&b->mutex);
+    b->decoders--;
+    int finished = finish_locked(b);
+    pthread_mutex_unlock(&b->mutex);
+    if (finished && b->notify) b->notify(b->notify_arg, b);
+    return NULL;
+}
+
+static void free_paths(char** paths, int count) {
+    if (!paths) return;
+    for (int i = 0; i < count; i++) free(paths[i]);
+    free(paths);
+}
+
+image_batch_t* image_batch_start(cira_ctx* ctx, char** paths, int count, int threads,
+                                 image_batch_notify_fn notify, void* arg) {
+    if (!ctx || !paths || count <= 0) {
+        free_paths(paths, count);
+        return NULL;
+    }
+    image_batch_t* b = (image_batch_t*)calloc(1, sizeof(image_batch_t));
+    if (!b) {
+        free_paths(paths, count);
+        return NULL;
+    }
+
+    if (threads <= 0) threads = ctx->decode_threads;
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 && cpus < CIRA_DECODE_DEFAULT_THREADS ? (int)cpus
+                                                                 : CIRA_DECODE_DEFAULT_THREADS;
+    }
+    if (threads > CIRA_DECODE_MAX_THREADS) threads = CIRA_DECODE_MAX_THREADS;
+    if (threads > count) threads = count;
+
+    b->ctx = ctx;
+    b->paths = paths;
+    b->count = count;
+    b->notify = notify;
+    b->notify_arg = arg;
+    pthread_mutex_lock(&ctx->async_mutex);
+    b->window = ctx->async_queue_depth;
+    pthread_mutex_unlock(&ctx->async_mutex);
+    b->start_ms = cira_time_ms();
+    pthread_mutex_init(&b->mutex, NULL);
+    pthread_cond_init(&b->slot_cond, NULL);
+    pthread_cond_init(&b->out_cond, NULL);
+
+    /* Counted before any thread can finish, so none appends the summary early */
+    b->decoders = threads;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&b->threads[b->num_threads], NULL, decode_thread, b) != 0) {
+            pthread_mutex_lock(&b->mutex);
+            b->decoders -= threads - i;
+            finish_locked(b);
+            pthread_mutex_unlock(&b->mutex);
+            break;
+        }
+        b->num_threads++;
+    }
+    if (b->num_threads == 0) {
+        fprintf(stderr, "Image batch: failed to start decode threads\n");
+        image_batch_destroy(b);
+        return NULL;
+    }
+
+    fprintf(stderr, "Image batch: %d images, %d decode threads, %d in flight\n",
+            count, b->num_threads, b->window);
+    return b;
+}
+
+int image_batch_read(image_batch_t* b, char* buf, size_t max) {
+    if (!b || !buf) return -1;
+    pthread_mutex_lock(&b->mutex);
+    int n = 0;
+    if (b->out_pos < b->out_len) {
+        size_t avail = b->out_len - b->out_pos;
+        size_t take = avail < max ? avail : max;
+        memcpy(buf, b->out + b->out_pos, take);
+        b->out_pos += take;
+        n = (int)take;
+    } else if (b->finished) {
+        n = -1;
+    }
+    pthread_mutex_unlock(&b->mutex);
+    return n;
+}
+
+int image_batch_readable(image_batch_t* b) {
+    if (!b) return 1;
+    pthread_mutex_lock(&b->mutex);
+    int readable = b->out_pos < b->out_len || b->finished;
+    pthread_mutex_unlock(&b->mutex);
+    return readable;
+}
+
+void image_batch_wait(image_batch_t* b, int timeout_ms) {
+    if (!b) return;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&b->mutex);
+    while (b->out_pos == b->out_len && !b->finished) {
+        if (pthread_cond_timedwait(&b->out_cond, &b->mutex, &deadline) != 0) break;
+    }
+    pthread_mutex_unlock(&b->mutex);
+}
+
+void image_batch_destroy(image_batch_t* b) {
+    if (!b) return;
+
+    pthread_mutex_lock(&b->mutex);
+    b->cancelled = 1;
+    pthread_cond_broadcast(&b->slot_cond);
+    pthread_mutex_unlock(&b->mutex);
+
+    for (int i = 0; i < b->num_threads; i++) {
+        pthread_join(b->threads[i], NULL);
+    }
+
+    /* Queued images still complete (or fail) on the predict worker */
+    pthread_mutex_lock(&b->mutex);
+    while (b->in_flight > 0 || b->callbacks > 0) {
+        pthread_cond_wait(&b->slot_cond, &b->mutex);
+    }
+    pthread_mutex_unlock(&b->mutex);
+
+    pthread_mutex_destroy(&b->mutex);
+    pthread_cond_destroy(&b->slot_cond);
+    pthread_cond_destroy(&b->out_cond);
+    free_paths(b->paths, b->count);
+    free(b->out);
+    free(b);
+}
+
+#ifndef _WIN32
+static int is_image_name(const char* name) {
+    const char* dot = strrchr(name, '.');
+    return dot && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0 ||
+                   strcasecmp(dot, ".png") == 0);
+}
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+#endif
+
+char** image_batch_list_dir(const char* dir, int limit, int* count) {
+    *count = 0;
+#ifdef _WIN32
+    (void)dir;
+    (void)limit;
+    return NULL;
+#else
+    if (limit <= 0 || limit > IMAGE_BATCH_MAX_IMAGES) limit = IMAGE_BATCH_MAX_IMAGES;
+
+    DIR* d = opendir(dir);
+    if (!d) return NULL;
+
+    int n = 0, cap = 0;
+    char** names = NULL;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] == '.' || !is_image_name(entry->d_name)) continue;
+        if (n == IMAGE_BATCH_MAX_IMAGES) break;
+        if (n == cap) {
+            cap = cap ? cap * 2 : 256;
+            char** grown = (char**)realloc(names, cap * sizeof(char*));
+            if (!grown) break;
+            names = grown;
+        }
+        names[n] = strdup(entry->d_name);
+        if (names[n]) n++;
+    }
+    closedir(d);
+    if (n == 0) {
+        free(names);
+        return NULL;
+    }
+    qsort(names, n, sizeof(char*), compare_names);
+
+    /* Names to full paths, keeping regular files only */
+    char** paths = (char**)malloc(n * sizeof(char*));
+    int kept = 0;
+    size_t dir_len = strlen(dir);
+    const char* sep = dir_len > 0 && dir[dir_len - 1] == '/' ? "" : "/";
+    for (int i = 0; i < n; i++) {
+        if (paths && kept < limit) {
+            size_t size = dir_len + strlen(sep) + strlen(names[i]) + 1;
+            char* path = (char*)malloc(size);
+            struct stat st;
+            if (path) {
+                snprintf(path, size, "%s%s%s", dir, sep, names[i]);
+                if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+                    paths[kept++] = path;
+                } else {
+                    free(path);
+                }
+            }
+        }
+        free(names[i]);
+    }
+    free(names);
+    if (kept == 0) {
+        free(paths);
+        return NULL;
+    }
+    *count = kept;
+    return paths;
+#endif
+}
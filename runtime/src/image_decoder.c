@@ -0,0 +1,290 @@
+/**
+ * CiRA Runtime - Image Decoder
+ *
+ * JPEG through the libjpeg API of libjpeg-turbo (scaled IDCT, fast
+ * integer DCT, merged upsampling), PNG through libpng's simplified API.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "image_decoder.h"
+#include "cira.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CIRA_LIBJPEG_ENABLED
+#include <setjmp.h>
+#include <jpeglib.h>
+#endif
+
+#ifdef CIRA_LIBPNG_ENABLED
+#include <png.h>
+#endif
+
+static void set_error(char* err, size_t err_size, const char* fmt, ...) {
+    if (!err || err_size == 0) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(err, err_size, fmt, ap);
+    va_end(ap);
+}
+
+#if defined(CIRA_LIBJPEG_ENABLED) || defined(CIRA_LIBPNG_ENABLED)
+static int size_allowed(int w, int h) {
+    return w > 0 && h > 0 && (int64_t)w * h <= IMAGE_MAX_PIXELS;
+}
+#endif
+
+image_format_t image_format_detect(const uint8_t* data, size_t size) {
+    static const uint8_t png_sig[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    if (!data) return IMAGE_FORMAT_UNKNOWN;
+    if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF) {
+        return IMAGE_FORMAT_JPEG;
+    }
+    if (size >= sizeof(png_sig) && memcmp(data, png_sig, sizeof(png_sig)) == 0) {
+        return IMAGE_FORMAT_PNG;
+    }
+    return IMAGE_FORMAT_UNKNOWN;
+}
+
+int image_format_supported(image_format_t format) {
+    switch (format) {
+#ifdef CIRA_LIBJPEG_ENABLED
+    case IMAGE_FORMAT_JPEG: return 1;
+#endif
+#ifdef CIRA_LIBPNG_ENABLED
+    case IMAGE_FORMAT_PNG: return 1;
+#endif
+    default: return 0;
+    }
+}
+
+int image_scale_eighths(int src_w, int src_h, int min_w, int min_h) {
+    if (min_w <= 0 || min_h <= 0) return 8;
+
+    /* Decoded size is ceil(src * n / 8); n * src >= 8 * min keeps it >= min */
+    for (int n = 1; n < 8; n *= 2) {
+        if ((int64_t)n * src_w >= (int64_t)8 * min_w &&
+            (int64_t)n * src_h >= (int64_t)8 * min_h) {
+            return n;
+        }
+    }
+    return 8;
+}
+
+void image_free(decoded_image_t* img) {
+    if (!img) return;
+    free(img->pixels);
+    img->pixels = NULL;
+}
+
+/* === JPEG === */
+
+#ifdef CIRA_LIBJPEG_ENABLED
+
+/* libjpeg reports fatal errors through error_exit, which must not return */
+typedef struct {
+    struct jpeg_error_mgr mgr;
+    jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+} jpeg_error_t;
+
+static void jpeg_error_exit(j_common_ptr cinfo) {
+    jpeg_error_t* e = (jpeg_error_t*)cinfo->err;
+    e->mgr.format_message(cinfo, e->message);
+    longjmp(e->jump, 1);
+}
+
+/* Corrupt-data warnings would go to stderr once per image; drop them */
+static void jpeg_quiet(j_common_ptr cinfo, int level) {
+    (void)cinfo;
+    (void)level;
+}
+
+static int decode_jpeg(const uint8_t* data, size_t size, int min_w, int min_h,
+                       decoded_image_t* out, char* err, size_t err_size) {
+    struct jpeg_decompress_struct cinfo;
+    jpeg_error_t jerr;
+
+    cinfo.err = jpeg_std_error(&jerr.mgr);
+    jerr.mgr.error_exit = jpeg_error_exit;
+    jerr.mgr.emit_message = jpeg_quiet;
+    jerr.message[0] = '\0';
+
+    /* out->pixels lives in memory, so it survives the longjmp */
+    if (setjmp(jerr.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        image_free(out);
+        set_error(err, err_size, "Invalid JPEG: %s", jerr.message);
+        return CIRA_ERROR_INPUT;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char*)data, (unsigned long)size);
+    jpeg_read_header(&cinfo, TRUE);
+
+    if (!size_allowed((int)cinfo.image_width, (int)cinfo.image_height)) {
+        set_error(err, err_size, "JPEG too large (%ux%u)", cinfo.image_width, cinfo.image_height);
+        jpeg_destroy_decompress(&cinfo);
+        return CIRA_ERROR_INPUT;
+    }
+    if (cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+        set_error(err, err_size, "CMYK JPEGs are not supported");
+        jpeg_destroy_decompress(&cinfo);
+        return CIRA_ERROR_INPUT;
+    }
+
+    out->src_w = (int)cinfo.image_width;
+    out->src_h = (int)cinfo.image_height;
+    cinfo.scale_num = (unsigned int)image_scale_eighths(out->src_w, out->src_h, min_w, min_h);
+    cinfo.scale_denom = 8;
+    cinfo.out_color_space = JCS_RGB;
+    cinfo.dct_method = JDCT_IFAST;
+    cinfo.do_fancy_upsampling = FALSE;
+
+    jpeg_start_decompress(&cinfo);
+    out->w = (int)cinfo.output_width;
+    out->h = (int)cinfo.output_height;
+
+    size_t stride = (size_t)out->w * 3;
+    out->pixels = (uint8_t*)malloc(stride * out->h);
+    if (!out->pixels) {
+        jpeg_destroy_decompress(&cinfo);
+        set_error(err, err_size, "Out of memory for a %dx%d image", out->w, out->h);
+        return CIRA_ERROR_MEMORY;
+    }
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW rows[4];
+        int n = 0;
+        for (; n < 4 && cinfo.output_scanline + n < cinfo.output_height; n++) {
+            rows[n] = out->pixels + (cinfo.output_scanline + n) * stride;
+        }
+        jpeg_read_scanlines(&cinfo, rows, (JDIMENSION)n);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return CIRA_OK;
+}
+
+#endif /* CIRA_LIBJPEG_ENABLED */
+
+/* === PNG === */
+
+#ifdef CIRA_LIBPNG_ENABLED
+
+static int decode_png(const uint8_t* data, size_t size, decoded_image_t* out,
+                      char* err, size_t err_size) {
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_memory(&image, data, size)) {
+        set_error(err, err_size, "Invalid PNG: %s", image.message);
+        png_image_free(&image);
+        return CIRA_ERROR_INPUT;
+    }
+    if (!size_allowed((int)image.width, (int)image.height)) {
+        set_error(err, err_size, "PNG too large (%ux%u)", image.width, image.height);
+        png_image_free(&image);
+        return CIRA_ERROR_INPUT;
+    }
+
+    out->src_w = out->w = (int)image.width;
+    out->src_h = out->h = (int)image.height;
+    image.format = PNG_FORMAT_RGB;
+    out->pixels = (uint8_t*)malloc(PNG_IMAGE_SIZE(image));
+    if (!out->pixels) {
+        png_image_free(&image);
+        set_error(err, err_size, "Out of memory for a %dx%d image", out->w, out->h);
+        return CIRA_ERROR_MEMORY;
+    }
+
+    /* Transparent pixels are composited onto black */
+    png_color background = { 0, 0, 0 };
+    if (!png_image_finish_read(&image, &background, out->pixels, 0, NULL)) {
+        set_error(err, err_size, "Invalid PNG: %s", image.message);
+        png_image_free(&image);
+        image_free(out);
+        return CIRA_ERROR_INPUT;
+    }
+    return CIRA_OK;
+}
+
+#endif /* CIRA_LIBPNG_ENABLED */
+
+int image_decode(const uint8_t* data, size_t size, int min_w, int min_h,
+                 decoded_image_t* out, char* err, size_t err_size) {
+    if (!out) return CIRA_ERROR_INPUT;
+    memset(out, 0, sizeof(*out));
+
+    out->format = image_format_detect(data, size);
+    if (out->format == IMAGE_FORMAT_UNKNOWN) {
+        set_error(err, err_size, "Not a JPEG or PNG image");
+        return CIRA_ERROR_INPUT;
+    }
+    if (!image_format_supported(out->format)) {
+        set_error(err, err_size, "%s decoding is not built in",
+                  out->format == IMAGE_FORMAT_JPEG ? "JPEG" : "PNG");
+        return CIRA_ERROR_INPUT;
+    }
+
+#ifdef CIRA_LIBJPEG_ENABLED
+    if (out->format == IMAGE_FORMAT_JPEG) {
+        return decode_jpeg(data, size, min_w, min_h, out, err, err_size);
+    }
+#endif
+#ifdef CIRA_LIBPNG_ENABLED
+    if (out->format == IMAGE_FORMAT_PNG) {
+        return decode_png(data, size, out, err, err_size);
+    }
+#endif
+    (void)min_w;
+    (void)min_h;
+    return CIRA_ERROR_INPUT;
+}
+
+int image_decode_file(const char* path, int min_w, int min_h,
+                      decoded_image_t* out, char* err, size_t err_size) {
+    if (!path || !out) return CIRA_ERROR_INPUT;
+    memset(out, 0, sizeof(*out));
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        set_error(err, err_size, "Cannot open image file");
+        return CIRA_ERROR_FILE;
+    }
+
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        size = ftell(f);
+        rewind(f);
+    }
+    if (size <= 0 || size > IMAGE_MAX_FILE_SIZE) {
+        fclose(f);
+        set_error(err, err_size, size <= 0 ? "Empty or unreadable image file"
+                                           : "Image file too large");
+        return size <= 0 ? CIRA_ERROR_FILE : CIRA_ERROR_INPUT;
+    }
+
+    uint8_t* data = (uint8_t*)malloc((size_t)size);
+    if (!data) {
+        fclose(f);
+        set_error(err, err_size, "Out of memory reading image file");
+        return CIRA_ERROR_MEMORY;
+    }
+    size_t got = fread(data, 1, (size_t)size, f);
+    fclose(f);
+    if (got != (size_t)size) {
+        free(data);
+        set_error(err, err_size, "Failed to read image file");
+        return CIRA_ERROR_FILE;
+    }
+
+    int result = image_decode(data, got, min_w, min_h, out, err, err_size);
+    free(data);
+    return result;
+}
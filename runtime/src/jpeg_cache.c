@@ -0,0 +1,201 @@
+/**
+ * CiRA Runtime - Encode-Once JPEG Cache
+ *
+ * A small table of variants guarded by one mutex. Encoding happens outside
+ * the lock; a "pending" entry makes concurrent requests for the same
+ * variant wait on a condvar for the first encoder. The cache holds one
+ * reference on each buffer and drops it on eviction, so buffers still
+ * being streamed survive until their last reader lets go.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "jpeg_cache.h"
+#include "jpeg_encoder.h"
+#include "cira.h"
+#include "cira_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+struct jpeg_buf {
+    _Atomic int refcount;
+    uint64_t seq;
+    size_t size;
+    uint8_t data[];
+};
+
+typedef struct {
+    int used;
+    int pending;            /* Being encoded by another caller */
+    uint64_t seq;
+    int annotated;
+    int quality;
+    jpeg_buf_t* buf;
+} cache_entry_t;
+
+struct jpeg_cache {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    cache_entry_t entries[JPEG_CACHE_ENTRIES];
+    uint64_t hits;
+    uint64_t encodes;
+};
+
+jpeg_cache_t* jpeg_cache_create(void) {
+    jpeg_cache_t* cache = (jpeg_cache_t*)calloc(1, sizeof(jpeg_cache_t));
+    if (!cache) return NULL;
+    pthread_mutex_init(&cache->mutex, NULL);
+    pthread_cond_init(&cache->cond, NULL);
+    return cache;
+}
+
+void jpeg_cache_destroy(jpeg_cache_t* cache) {
+    if (!cache) return;
+    for (int i = 0; i < JPEG_CACHE_ENTRIES; i++) {
+        if (cache->entries[i].used && cache->entries[i].buf) {
+            jpeg_buf_release(cache->entries[i].buf);
+        }
+    }
+    pthread_mutex_destroy(&cache->mutex);
+    pthread_cond_destroy(&cache->cond);
+    free(cache);
+}
+
+static cache_entry_t* find_entry(jpeg_cache_t* cache, uint64_t seq, int annotated, int quality) {
+    for (int i = 0; i < JPEG_CACHE_ENTRIES; i++) {
+        cache_entry_t* e = &cache->entries[i];
+        if (e->used && e->seq == seq && e->annotated == annotated && e->quality == quality) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/* Free entry, else evict the oldest finished one. NULL if all are pending. */
+static cache_entry_t* alloc_entry(jpeg_cache_t* cache) {
+    cache_entry_t* victim = NULL;
+    for (int i = 0; i < JPEG_CACHE_ENTRIES; i++) {
+        cache_entry_t* e = &cache->entries[i];
+        if (!e->used) return e;
+        if (!e->pending && (!victim || e->seq < victim->seq)) {
+            victim = e;
+        }
+    }
+    if (victim) {
+        jpeg_buf_release(victim->buf);
+        memset(victim, 0, sizeof(*victim));
+    }
+    return victim;
+}
+
+/* Encode into a new refcounted buffer (refcount 1) */
+static jpeg_buf_t* encode_frame(cira_ctx* ctx, cira_camera_t* cam, const uint8_t* rgb,
+                                int w, int h, uint64_t seq, int annotated, int quality) {
+    uint8_t* jpeg = NULL;
+    size_t size = 0;
+    int ret = annotated
+        ? jpeg_encode_annotated(ctx, cam, rgb, w, h, quality, &jpeg, &size)
+        : jpeg_encode(rgb, w, h, quality, &jpeg, &size);
+    if (ret != CIRA_OK || !jpeg || size == 0) return NULL;
+
+    jpeg_buf_t* buf = (jpeg_buf_t*)malloc(sizeof(jpeg_buf_t) + size);
+    if (!buf) return NULL;
+
+    atomic_init(&buf->refcount, 1);
+    buf->seq = seq;
+    buf->size = size;
+    memcpy(buf->data, jpeg, size);
+    return buf;
+}
+
+jpeg_buf_t* jpeg_cache_get(jpeg_cache_t* cache, cira_ctx* ctx, cira_camera_t* cam,
+                           frame_slot_t* slot, int annotated, int quality) {
+    int w, h;
+    uint64_t seq;
+    const uint8_t* rgb = frame_slot_data(slot, &w, &h, &seq);
+    if (!cache || !rgb || w <= 0 || h <= 0) return NULL;
+
+    pthread_mutex_lock(&cache->mutex);
+
+    cache_entry_t* e;
+    while ((e = find_entry(cache, seq, annotated, quality)) != NULL && e->pending) {
+        pthread_cond_wait(&cache->cond, &cache->mutex);
+    }
+
+    if (e) {
+        jpeg_buf_t* buf = e->buf;
+        atomic_fetch_add_explicit(&buf->refcount, 1, memory_order_relaxed);
+        cache->hits++;
+        pthread_mutex_unlock(&cache->mutex);
+        return buf;
+    }
+
+    /* Miss: reserve the entry so others wait for us, then encode unlocked */
+    e = alloc_entry(cache);
+    if (e) {
+        e->used = 1;
+        e->pending = 1;
+        e->seq = seq;
+        e->annotated = annotated;
+        e->quality = quality;
+    }
+    cache->encodes++;
+    pthread_mutex_unlock(&cache->mutex);
+
+    jpeg_buf_t* buf = encode_frame(ctx, cam, rgb, w, h, seq, annotated, quality);
+
+    if (e) {
+        pthread_mutex_lock(&cache->mutex);
+        if (buf) {
+            /* One reference for the cache, one for the caller */
+            atomic_fetch_add_explicit(&buf->refcount, 1, memory_order_relaxed);
+            e->buf = buf;
+            e->pending = 0;
+        } else {
+            memset(e, 0, sizeof(*e));
+        }
+        pthread_cond_broadcast(&cache->cond);
+        pthread_mutex_unlock(&cache->mutex);
+    }
+
+    return buf;
+}
+
+const uint8_t* jpeg_buf_data(const jpeg_buf_t* buf, size_t* size) {
+    if (!buf) {
+        if (size) *size = 0;
+        return NULL;
+    }
+    if (size) *size = buf->size;
+    return buf->data;
+}
+
+uint64_t jpeg_buf_sequence(const jpeg_buf_t* buf) {
+    return buf ? buf->seq : 0;
+}
+
+void jpeg_buf_release(jpeg_buf_t* buf) {
+    if (!buf) return;
+    if (atomic_fetch_sub_explicit(&buf->refcount, 1, memory_order_acq_rel) == 1) {
+        free(buf);
+    }
+}
+
+void jpeg_buf_release_data(void* data) {
+    if (!data) return;
+    jpeg_buf_release((jpeg_buf_t*)((uint8_t*)data - offsetof(jpeg_buf_t, data)));
+}
+
+void jpeg_cache_stats(jpeg_cache_t* cache, uint64_t* hits, uint64_t* encodes) {
+    if (!cache) {
+        if (hits) *hits = 0;
+        if (encodes) *encodes = 0;
+        return;
+    }
+    pthread_mutex_lock(&cache->mutex);
+    if (hits) *hits = cache->hits;
+    if (encodes) *encodes = cache->encodes;
+    pthread_mutex_unlock(&cache->mutex);
+}
@@ -1,26 +1,175 @@
 /**
  * CiRA Runtime - JPEG Encoder
  *
- * Uses OpenCV to encode RGB frames to JPEG format.
+ * Backend selection, and the OpenCV backend (see jpeg_encoder.h).
+ * Annotations are drawn by the annotator (annotator.h) onto a per-thread
+ * copy of the frame in the channel order the chosen backend takes, so
+ * only the OpenCV backend pays for an RGB->BGR conversion, and builds
+ * without OpenCV annotate too.
  *
  * (c) CiRA Robotics / KMITL 2026
  */
 
 #include "cira.h"
 #include "cira_internal.h"
+#include "jpeg_encoder.h"
+#include "annotator.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <atomic>
+#include <vector>
 
 #ifdef CIRA_STREAMING_ENABLED
+
 #ifdef CIRA_OPENCV_ENABLED
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
-/* Static buffer for encoded JPEG */
-static std::vector<uchar> g_jpeg_buffer;
-static pthread_mutex_t g_jpeg_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Per-thread buffers: encoders on different threads run in parallel,
+ * and steady-state encoding reuses the same allocations. */
+static thread_local std::vector<uchar> t_jpeg_buffer;
+static thread_local cv::Mat t_bgr;
+
+static int opencv_probe(void) {
+    return 1;
+}
+
+static int opencv_encode(const uint8_t* pixels, int bgr, int width, int height, int quality,
+                         uint8_t** out_data, size_t* out_size) {
+    cv::Mat src(height, width, CV_8UC3, (void*)pixels);
+
+    /* OpenCV encodes BGR */
+    if (!bgr) {
+        cv::cvtColor(src, t_bgr, cv::COLOR_RGB2BGR);
+        src = t_bgr;
+    }
+
+    std::vector<int> params;
+    params.push_back(cv::IMWRITE_JPEG_QUALITY);
+    params.push_back(quality);
+
+    t_jpeg_buffer.clear();
+    if (!cv::imencode(".jpg", src, t_jpeg_buffer, params)) {
+        return CIRA_ERROR;
+    }
+
+    *out_data = t_jpeg_buffer.data();
+    *out_size = t_jpeg_buffer.size();
+    return CIRA_OK;
+}
+
+static const jpeg_backend_t jpeg_backend_opencv = { "opencv", opencv_probe, opencv_encode };
+
+#endif /* CIRA_OPENCV_ENABLED */
+
+/* === Backend selection === */
+
+/* Candidates in "auto" order */
+static const jpeg_backend_t* const g_backends[] = {
+#ifdef CIRA_NVJPEG_ENABLED
+    &jpeg_backend_nvjpeg,
+#endif
+#ifdef CIRA_TURBOJPEG_ENABLED
+    &jpeg_backend_turbo,
+#endif
+#ifdef CIRA_OPENCV_ENABLED
+    &jpeg_backend_opencv,
+#endif
+    NULL
+};
+
+static pthread_mutex_t g_select_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int g_probe_result[sizeof(g_backends) / sizeof(g_backends[0])];  /* 0 = not probed, 1 = usable, -1 = not */
+static std::atomic<const jpeg_backend_t*> g_backend(nullptr);
+static std::atomic<bool> g_selected(false);     /* A choice was made (or auto found nothing) */
+
+/* Probe once per process (caller holds g_select_mutex) */
+static bool backend_usable(size_t i) {
+    if (g_probe_result[i] == 0) {
+        g_probe_result[i] = g_backends[i]->probe() ? 1 : -1;
+        if (g_probe_result[i] < 0) {
+            fprintf(stderr, "JPEG encoder %s not usable on this machine\n", g_backends[i]->name);
+        }
+    }
+    return g_probe_result[i] > 0;
+}
+
+static const char* const g_known_backends[] = { "nvjpeg", "turbo", "opencv" };
+
+extern "C" int jpeg_encoder_select(const char* name) {
+    if (!name) return CIRA_ERROR_INPUT;
+
+    bool known = strcmp(name, "auto") == 0;
+    for (size_t i = 0; i < sizeof(g_known_backends) / sizeof(g_known_backends[0]); i++) {
+        if (strcmp(name, g_known_backends[i]) == 0) known = true;
+    }
+    if (!known) return CIRA_ERROR_INPUT;
+
+    int result = CIRA_ERROR;
+    pthread_mutex_lock(&g_select_mutex);
+    for (size_t i = 0; g_backends[i]; i++) {
+        bool wanted = strcmp(name, "auto") == 0 || strcmp(name, g_backends[i]->name) == 0;
+        if (wanted && backend_usable(i)) {
+            g_backend.store(g_backends[i]);
+            fprintf(stderr, "JPEG encoder: %s\n", g_backends[i]->name);
+            result = CIRA_OK;
+            break;
+        }
+    }
+    /* A failed explicit choice keeps the current backend */
+    if (result == CIRA_OK || strcmp(name, "auto") == 0) {
+        g_selected.store(true);
+    }
+    pthread_mutex_unlock(&g_select_mutex);
+    return result;
+}
+
+/* Backend in use, choosing one on first use */
+static const jpeg_backend_t* current_backend(void) {
+    if (!g_selected.load()) {
+        jpeg_encoder_select("auto");
+    }
+    return g_backend.load();
+}
+
+extern "C" const char* jpeg_encoder_name(void) {
+    const jpeg_backend_t* backend = current_backend();
+    return backend ? backend->name : "none";
+}
+
+/* Encode times of every backend call (created on first use, never freed) */
+static std::atomic<latency_hist_t*> g_latency(nullptr);
+
+extern "C" latency_hist_t* jpeg_encoder_latency(void) {
+    latency_hist_t* h = g_latency.load();
+    if (!h) {
+        latency_hist_t* created = latency_hist_create();
+        if (g_latency.compare_exchange_strong(h, created)) {
+            h = created;
+        } else {
+            latency_hist_destroy(created);
+        }
+    }
+    return h;
+}
+
+static int timed_encode(const jpeg_backend_t* backend, const uint8_t* pixels, int bgr,
+                        int width, int height, int quality,
+                        uint8_t** out_data, size_t* out_size) {
+    double t0 = cira_time_ms();
+    int result = backend->encode(pixels, bgr, width, height, quality, out_data, out_size);
+    if (result == CIRA_OK) {
+        latency_hist_record(jpeg_encoder_latency(), cira_time_ms() - t0);
+    }
+    return result;
+}
+
+/* Per-thread annotation canvas, reused across frames */
+static thread_local std::vector<uint8_t> t_canvas;
 
 extern "C" {
 
@@ -31,7 +180,7 @@ extern "C" {
  * @param width Frame width
  * @param height Frame height
  * @param quality JPEG quality (1-100)
- * @param out_data Output pointer (set to internal buffer - do not free)
+ * @param out_data Output pointer (per-thread buffer, valid until this thread encodes again)
  * @param out_size Output size in bytes
  * @return CIRA_OK on success
  */
@@ -41,156 +190,78 @@ int jpeg_encode(const uint8_t* rgb_data, int width, int height,
         return CIRA_ERROR_INPUT;
     }
 
-    pthread_mutex_lock(&g_jpeg_mutex);
-
-    /* Create cv::Mat from RGB data */
-    cv::Mat rgb(height, width, CV_8UC3, (void*)rgb_data);
-
-    /* Convert RGB to BGR (OpenCV uses BGR) */
-    cv::Mat bgr;
-    cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
-
-    /* Encode to JPEG */
-    std::vector<int> params;
-    params.push_back(cv::IMWRITE_JPEG_QUALITY);
-    params.push_back(quality);
-
-    g_jpeg_buffer.clear();
-    if (!cv::imencode(".jpg", bgr, g_jpeg_buffer, params)) {
-        pthread_mutex_unlock(&g_jpeg_mutex);
-        return CIRA_ERROR;
-    }
-
-    *out_data = g_jpeg_buffer.data();
-    *out_size = g_jpeg_buffer.size();
-
-    pthread_mutex_unlock(&g_jpeg_mutex);
-    return CIRA_OK;
+    const jpeg_backend_t* backend = current_backend();
+    if (!backend) return CIRA_ERROR;
+    return timed_encode(backend, rgb_data, 0, width, height, quality, out_data, out_size);
 }
 
 /**
  * Encode RGB frame with detection annotations overlaid.
  *
- * @param ctx Context with detections
+ * @param ctx Context (labels, and detections when cam is NULL)
+ * @param cam Camera whose detections to draw, or NULL
  * @param rgb_data RGB pixel data
  * @param width Frame width
  * @param height Frame height
  * @param quality JPEG quality (1-100)
- * @param out_data Output pointer (set to internal buffer - do not free)
+ * @param out_data Output pointer (per-thread buffer, valid until this thread encodes again)
  * @param out_size Output size in bytes
  * @return CIRA_OK on success
  */
-int jpeg_encode_annotated(cira_ctx* ctx, const uint8_t* rgb_data, int width, int height,
-                          int quality, uint8_t** out_data, size_t* out_size) {
+int jpeg_encode_annotated(cira_ctx* ctx, cira_camera_t* cam, const uint8_t* rgb_data,
+                          int width, int height, int quality,
+                          uint8_t** out_data, size_t* out_size) {
     if (!ctx || !rgb_data || !out_data || !out_size || width <= 0 || height <= 0) {
         return CIRA_ERROR_INPUT;
     }
 
-    pthread_mutex_lock(&g_jpeg_mutex);
-
-    /* Create cv::Mat from RGB data */
-    cv::Mat rgb(height, width, CV_8UC3, (void*)rgb_data);
-
-    /* Convert RGB to BGR (OpenCV uses BGR) */
-    cv::Mat bgr;
-    cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
-
-    /* Draw detections with persistence (reduce flickering) */
-    pthread_mutex_lock(&ctx->result_mutex);
-
-    /* Use current detections, or fall back to previous if current is empty */
-    cira_detection_t* dets = ctx->detections;
-    int num_dets = ctx->num_detections;
-
-    if (num_dets > 0) {
-        /* Save current detections for persistence */
-        memcpy(ctx->prev_detections, ctx->detections,
-               ctx->num_detections * sizeof(cira_detection_t));
-        ctx->prev_num_detections = ctx->num_detections;
-        ctx->prev_detection_frame = ctx->frame_sequence;
-    } else if (ctx->prev_num_detections > 0 &&
-               (ctx->frame_sequence - ctx->prev_detection_frame) <= 3) {
-        /* Use previous detections if within 3 frames */
-        dets = ctx->prev_detections;
-        num_dets = ctx->prev_num_detections;
-    }
+    const jpeg_backend_t* backend = current_backend();
+    if (!backend) return CIRA_ERROR;
 
-    for (int i = 0; i < num_dets; i++) {
-        cira_detection_t* det = &dets[i];
-
-        /* Convert normalized coords to pixel coords */
-        int x = (int)(det->x * width);
-        int y = (int)(det->y * height);
-        int w = (int)(det->w * width);
-        int h = (int)(det->h * height);
-
-        /* Draw bounding box (green, thicker line) */
-        cv::rectangle(bgr,
-                      cv::Point(x, y),
-                      cv::Point(x + w, y + h),
-                      cv::Scalar(0, 255, 0), 3);
-
-        /* Draw label background */
-        const char* label = cira_get_label(ctx, det->label_id);
-        char text[128];
-        snprintf(text, sizeof(text), "%s %.0f%%", label, det->confidence * 100);
-
-        int baseline;
-        cv::Size text_size = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, 0.7, 2, &baseline);
-
-        cv::rectangle(bgr,
-                      cv::Point(x, y - text_size.height - 8),
-                      cv::Point(x + text_size.width + 8, y),
-                      cv::Scalar(0, 255, 0), cv::FILLED);
-
-        /* Draw label text (black on green, bigger font) */
-        cv::putText(bgr, text,
-                    cv::Point(x + 4, y - 4),
-                    cv::FONT_HERSHEY_SIMPLEX, 0.7,
-                    cv::Scalar(0, 0, 0), 2);
+    /* Draw on a copy in the order the backend encodes */
+    size_t bytes = (size_t)width * height * 3;
+    t_canvas.resize(bytes);
+    uint8_t* canvas = t_canvas.data();
+    int is_bgr = 0;
+#ifdef CIRA_OPENCV_ENABLED
+    if (backend == &jpeg_backend_opencv) {
+        cv::Mat rgb(height, width, CV_8UC3, (void*)rgb_data);
+        cv::Mat bgr(height, width, CV_8UC3, canvas);
+        cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
+        is_bgr = 1;
     }
-
-    pthread_mutex_unlock(&ctx->result_mutex);
-
-    /* Encode to JPEG */
-    std::vector<int> params;
-    params.push_back(cv::IMWRITE_JPEG_QUALITY);
-    params.push_back(quality);
-
-    g_jpeg_buffer.clear();
-    if (!cv::imencode(".jpg", bgr, g_jpeg_buffer, params)) {
-        pthread_mutex_unlock(&g_jpeg_mutex);
-        return CIRA_ERROR;
+#endif
+    if (!is_bgr) {
+        memcpy(canvas, rgb_data, bytes);
     }
 
-    *out_data = g_jpeg_buffer.data();
-    *out_size = g_jpeg_buffer.size();
+    annotate_frame(ctx, cam, canvas, width, height, is_bgr);
 
-    pthread_mutex_unlock(&g_jpeg_mutex);
-    return CIRA_OK;
+    return timed_encode(backend, canvas, is_bgr, width, height, quality, out_data, out_size);
 }
 
-} /* extern "C" */
-
-#else /* CIRA_OPENCV_ENABLED */
-
-extern "C" {
-
-int jpeg_encode(const uint8_t* rgb_data, int width, int height,
-                int quality, uint8_t** out_data, size_t* out_size) {
-    (void)rgb_data; (void)width; (void)height; (void)quality;
-    (void)out_data; (void)out_size;
-    return CIRA_ERROR;
-}
+/**
+ * Copy an RGB frame with detection annotations drawn on it.
+ *
+ * @param ctx Context (labels, and detections when cam is NULL)
+ * @param cam Camera whose detections to draw, or NULL
+ * @param rgb_data RGB pixel data
+ * @param width Frame width
+ * @param height Frame height
+ * @param out Receives width*height*3 bytes of RGB
+ * @return CIRA_OK on success
+ */
+int frame_annotate(cira_ctx* ctx, cira_camera_t* cam, const uint8_t* rgb_data,
+                   int width, int height, uint8_t* out) {
+    if (!ctx || !rgb_data || !out || width <= 0 || height <= 0) {
+        return CIRA_ERROR_INPUT;
+    }
 
-int jpeg_encode_annotated(cira_ctx* ctx, const uint8_t* rgb_data, int width, int height,
-                          int quality, uint8_t** out_data, size_t* out_size) {
-    (void)ctx; (void)rgb_data; (void)width; (void)height; (void)quality;
-    (void)out_data; (void)out_size;
-    return CIRA_ERROR;
+    memcpy(out, rgb_data, (size_t)width * height * 3);
+    annotate_frame(ctx, cam, out, width, height, 0);
+    return CIRA_OK;
 }
 
 } /* extern "C" */
 
-#endif /* CIRA_OPENCV_ENABLED */
 #endif /* CIRA_STREAMING_ENABLED */
@@ -0,0 +1,128 @@
+/**
+ * CiRA Runtime - JPEG Encoder: CUDA nvJPEG
+ *
+ * Encodes on the GPU (discrete cards; the hardware encoder path on Jetson
+ * Orin). The library handle is shared; each thread owns a CUDA stream,
+ * encoder state and parameters, a device frame buffer and the host output
+ * buffer, all kept for the thread's lifetime. Frames go to the device in
+ * one copy and come back as the compressed bitstream.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cira.h"
+#include "jpeg_encoder.h"
+
+#if defined(CIRA_STREAMING_ENABLED) && defined(CIRA_NVJPEG_ENABLED)
+
+#include <stdio.h>
+#include <vector>
+#include <cuda_runtime_api.h>
+#include <nvjpeg.h>
+
+/* Created by the probe, kept for the process lifetime */
+static nvjpegHandle_t g_nvjpeg = nullptr;
+
+/* Per-thread encoder, released when the thread exits */
+struct nvjpeg_state_t {
+    bool ready = false;
+    bool failed = false;
+    cudaStream_t stream = nullptr;
+    nvjpegEncoderState_t state = nullptr;
+    nvjpegEncoderParams_t params = nullptr;
+    int quality = -1;
+    uint8_t* device = nullptr;
+    size_t device_size = 0;
+    std::vector<uint8_t> out;
+
+    ~nvjpeg_state_t() {
+        if (device) cudaFree(device);
+        if (params) nvjpegEncoderParamsDestroy(params);
+        if (state) nvjpegEncoderStateDestroy(state);
+        if (stream) cudaStreamDestroy(stream);
+    }
+};
+
+static thread_local nvjpeg_state_t t_nvjpeg;
+
+static int nvjpeg_probe(void) {
+    int devices = 0;
+    if (cudaGetDeviceCount(&devices) != cudaSuccess || devices == 0) return 0;
+    return nvjpegCreateSimple(&g_nvjpeg) == NVJPEG_STATUS_SUCCESS;
+}
+
+static bool nvjpeg_prepare(nvjpeg_state_t& st) {
+    if (st.ready) return true;
+    if (st.failed) return false;
+
+    st.failed = true;
+    if (cudaStreamCreateWithFlags(&st.stream, cudaStreamNonBlocking) != cudaSuccess) return false;
+    if (nvjpegEncoderStateCreate(g_nvjpeg, &st.state, st.stream) != NVJPEG_STATUS_SUCCESS) return false;
+    if (nvjpegEncoderParamsCreate(g_nvjpeg, &st.params, st.stream) != NVJPEG_STATUS_SUCCESS) return false;
+    if (nvjpegEncoderParamsSetSamplingFactors(st.params, NVJPEG_CSS_420, st.stream) !=
+        NVJPEG_STATUS_SUCCESS) {
+        return false;
+    }
+    st.failed = false;
+    st.ready = true;
+    return true;
+}
+
+static int nvjpeg_encode(const uint8_t* pixels, int bgr, int width, int height, int quality,
+                         uint8_t** out_data, size_t* out_size) {
+    nvjpeg_state_t& st = t_nvjpeg;
+    if (!g_nvjpeg || !nvjpeg_prepare(st)) {
+        fprintf(stderr, "nvJPEG: failed to create encoder state\n");
+        return CIRA_ERROR;
+    }
+
+    if (quality != st.quality) {
+        if (nvjpegEncoderParamsSetQuality(st.params, quality, st.stream) != NVJPEG_STATUS_SUCCESS) {
+            return CIRA_ERROR_INPUT;
+        }
+        st.quality = quality;
+    }
+
+    size_t bytes = (size_t)width * height * 3;
+    if (bytes > st.device_size) {
+        if (st.device) cudaFree(st.device);
+        st.device = nullptr;
+        st.device_size = 0;
+        if (cudaMalloc(reinterpret_cast<void**>(&st.device), bytes) != cudaSuccess) {
+            return CIRA_ERROR_MEMORY;
+        }
+        st.device_size = bytes;
+    }
+    if (cudaMemcpyAsync(st.device, pixels, bytes, cudaMemcpyHostToDevice, st.stream) != cudaSuccess) {
+        return CIRA_ERROR;
+    }
+
+    nvjpegImage_t image = {};
+    image.channel[0] = st.device;
+    image.pitch[0] = (size_t)width * 3;
+    if (nvjpegEncodeImage(g_nvjpeg, st.state, st.params, &image,
+                          bgr ? NVJPEG_INPUT_BGRI : NVJPEG_INPUT_RGBI,
+                          width, height, st.stream) != NVJPEG_STATUS_SUCCESS) {
+        return CIRA_ERROR;
+    }
+
+    /* Size first, then the bitstream itself */
+    size_t length = 0;
+    if (nvjpegEncodeRetrieveBitstream(g_nvjpeg, st.state, nullptr, &length, st.stream) !=
+        NVJPEG_STATUS_SUCCESS) {
+        return CIRA_ERROR;
+    }
+    if (st.out.size() < length) st.out.resize(length);
+    if (nvjpegEncodeRetrieveBitstream(g_nvjpeg, st.state, st.out.data(), &length, st.stream) !=
+        NVJPEG_STATUS_SUCCESS || cudaStreamSynchronize(st.stream) != cudaSuccess) {
+        return CIRA_ERROR;
+    }
+
+    *out_data = st.out.data();
+    *out_size = length;
+    return CIRA_OK;
+}
+
+extern "C" const jpeg_backend_t jpeg_backend_nvjpeg = { "nvjpeg", nvjpeg_probe, nvjpeg_encode };
+
+#endif /* CIRA_STREAMING_ENABLED && CIRA_NVJPEG_ENABLED */
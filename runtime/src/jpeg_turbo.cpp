@@ -0,0 +1,73 @@
+/**
+ * CiRA Runtime - JPEG Encoder: libjpeg-turbo
+ *
+ * TurboJPEG takes RGB (or BGR) pixels directly, so frames are encoded
+ * without a colour conversion pass. Each thread keeps its compressor and
+ * a worst-case output buffer for its lifetime, so encoding neither
+ * allocates nor shares state between threads.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cira.h"
+#include "jpeg_encoder.h"
+
+#if defined(CIRA_STREAMING_ENABLED) && defined(CIRA_TURBOJPEG_ENABLED)
+
+#include <stdio.h>
+#include <turbojpeg.h>
+
+/* Per-thread compressor, released when the thread exits */
+struct turbo_state_t {
+    tjhandle handle = nullptr;
+    unsigned char* buf = nullptr;
+    unsigned long capacity = 0;
+
+    ~turbo_state_t() {
+        if (buf) tjFree(buf);
+        if (handle) tjDestroy(handle);
+    }
+};
+
+static thread_local turbo_state_t t_turbo;
+
+static int turbo_probe(void) {
+    tjhandle handle = tjInitCompress();
+    if (!handle) return 0;
+    tjDestroy(handle);
+    return 1;
+}
+
+static int turbo_encode(const uint8_t* pixels, int bgr, int width, int height, int quality,
+                        uint8_t** out_data, size_t* out_size) {
+    turbo_state_t& st = t_turbo;
+    if (!st.handle) {
+        st.handle = tjInitCompress();
+        if (!st.handle) return CIRA_ERROR;
+    }
+
+    /* Worst-case size, so the compressor never reallocates our buffer */
+    unsigned long need = tjBufSize(width, height, TJSAMP_420);
+    if (need > st.capacity) {
+        if (st.buf) tjFree(st.buf);
+        st.buf = tjAlloc(static_cast<int>(need));
+        st.capacity = st.buf ? need : 0;
+        if (!st.buf) return CIRA_ERROR_MEMORY;
+    }
+
+    unsigned char* jpeg = st.buf;
+    unsigned long size = st.capacity;
+    if (tjCompress2(st.handle, pixels, width, width * 3, height, bgr ? TJPF_BGR : TJPF_RGB,
+                    &jpeg, &size, TJSAMP_420, quality, TJFLAG_NOREALLOC | TJFLAG_FASTDCT) != 0) {
+        fprintf(stderr, "TurboJPEG encode failed: %s\n", tjGetErrorStr2(st.handle));
+        return CIRA_ERROR;
+    }
+
+    *out_data = jpeg;
+    *out_size = size;
+    return CIRA_OK;
+}
+
+extern "C" const jpeg_backend_t jpeg_backend_turbo = { "turbo", turbo_probe, turbo_encode };
+
+#endif /* CIRA_STREAMING_ENABLED && CIRA_TURBOJPEG_ENABLED */
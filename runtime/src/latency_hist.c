@@ -0,0 +1,138 @@
+/**
+ * CiRA Runtime - Latency Histogram
+ *
+ * Values are microseconds. The first 32 buckets hold 0-31 us exactly;
+ * above that, the range [2^e, 2^(e+1)) is split into 16 buckets of width
+ * 2^(e-4), up to 2^32 us (longer values go to the last bucket). Every
+ * counter is a relaxed atomic: a value is one add to its bucket, one add
+ * to the sum and, rarely, a compare-exchange on the max.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "latency_hist.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#define HIST_SUB_BITS   5
+#define HIST_SUB        (1 << HIST_SUB_BITS)        /* Exact buckets below 2^5 us */
+#define HIST_HALF       (HIST_SUB / 2)              /* Buckets per power of two above */
+#define HIST_MAX_EXP    31                          /* Highest power of two tracked */
+#define HIST_BUCKETS    (HIST_SUB + (HIST_MAX_EXP - HIST_SUB_BITS + 1) * HIST_HALF)
+
+struct latency_hist {
+    atomic_uint_fast64_t buckets[HIST_BUCKETS];
+    atomic_uint_fast64_t sum_us;
+    atomic_uint_fast64_t max_us;
+};
+
+latency_hist_t* latency_hist_create(void) {
+    latency_hist_t* h = (latency_hist_t*)malloc(sizeof(latency_hist_t));
+    if (!h) return NULL;
+
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        atomic_init(&h->buckets[i], 0);
+    }
+    atomic_init(&h->sum_us, 0);
+    atomic_init(&h->max_us, 0);
+    return h;
+}
+
+void latency_hist_destroy(latency_hist_t* h) {
+    free(h);
+}
+
+/* Index of the highest set bit (v > 0) */
+static int highest_bit(uint64_t v) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(v);
+#else
+    int e = 0;
+    while (v >>= 1) e++;
+    return e;
+#endif
+}
+
+static int bucket_of(uint64_t us) {
+    if (us < HIST_SUB) return (int)us;
+
+    int e = highest_bit(us);
+    if (e > HIST_MAX_EXP) return HIST_BUCKETS - 1;
+    int shift = e - (HIST_SUB_BITS - 1);
+    return shift * HIST_HALF + (int)(us >> shift);
+}
+
+/* Midpoint of a bucket, microseconds */
+static double bucket_value(int i) {
+    if (i < HIST_SUB) return (double)i;
+
+    int shift = i / HIST_HALF - 1;
+    uint64_t low = (uint64_t)(HIST_HALF + i % HIST_HALF) << shift;
+    return (double)low + (double)((uint64_t)1 << shift) * 0.5;
+}
+
+void latency_hist_record(latency_hist_t* h, double ms) {
+    if (!h) return;
+
+    uint64_t us = ms > 0.0 ? (uint64_t)(ms * 1000.0 + 0.5) : 0;
+    atomic_fetch_add_explicit(&h->buckets[bucket_of(us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_us, us, memory_order_relaxed);
+
+    uint_fast64_t max = atomic_load_explicit(&h->max_us, memory_order_relaxed);
+    while (us > max &&
+           !atomic_compare_exchange_weak_explicit(&h->max_us, &max, us,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/* Copy the buckets once so every quantile reads the same counts */
+static uint64_t snapshot(const latency_hist_t* h, uint64_t* counts) {
+    uint64_t total = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        counts[i] = atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        total += counts[i];
+    }
+    return total;
+}
+
+static double quantile_of(const uint64_t* counts, uint64_t total, double max_ms, double q) {
+    if (total == 0) return 0.0;
+
+    uint64_t rank = (uint64_t)(q * (double)total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            double ms = bucket_value(i) / 1000.0;
+            return ms < max_ms ? ms : max_ms;
+        }
+    }
+    return max_ms;
+}
+
+double latency_hist_quantile(const latency_hist_t* h, double q) {
+    if (!h) return 0.0;
+
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total = snapshot(h, counts);
+    double max_ms = atomic_load_explicit(&h->max_us, memory_order_relaxed) / 1000.0;
+    return quantile_of(counts, total, max_ms, q);
+}
+
+void latency_hist_summary(const latency_hist_t* h, latency_summary_t* out) {
+    out->count = 0;
+    out->sum_ms = out->max_ms = 0.0;
+    out->p50_ms = out->p90_ms = out->p99_ms = 0.0;
+    if (!h) return;
+
+    uint64_t counts[HIST_BUCKETS];
+    out->count = snapshot(h, counts);
+    out->sum_ms = atomic_load_explicit(&h->sum_us, memory_order_relaxed) / 1000.0;
+    out->max_ms = atomic_load_explicit(&h->max_us, memory_order_relaxed) / 1000.0;
+    out->p50_ms = quantile_of(counts, out->count, out->max_ms, 0.50);
+    out->p90_ms = quantile_of(counts, out->count, out->max_ms, 0.90);
+    out->p99_ms = quantile_of(counts, out->count, out->max_ms, 0.99);
+}
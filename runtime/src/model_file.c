@@ -0,0 +1,174 @@
+/**
+ * CiRA Runtime - Model Files
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "model_file.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+int model_file_map(const char* path, model_file_t* file) {
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+
+    /* Private and writable: a backend that touches weights in place gets
+     * copy-on-write pages, never a fault or a changed file */
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return -1;
+
+    /* Loaders walk the whole file front to back */
+    madvise(data, (size_t)st.st_size, MADV_WILLNEED);
+
+    file->data = (const uint8_t*)data;
+    file->size = (size_t)st.st_size;
+    file->mapped = 1;
+    return 0;
+#else
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(f);
+        return -1;
+    }
+
+    uint8_t* data = (uint8_t*)malloc((size_t)size);
+    if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    file->data = data;
+    file->size = (size_t)size;
+    return 0;
+#endif
+}
+
+void model_file_unmap(model_file_t* file) {
+    if (!file->data) return;
+
+#ifndef _WIN32
+    if (file->mapped) {
+        munmap((void*)file->data, file->size);
+    } else
+#endif
+    {
+        free((void*)file->data);
+    }
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+}
+
+#define HASH_K1 0x9E3779B97F4A7C15ull
+#define HASH_K2 0xC2B2AE3D27D4EB4Full
+
+static uint64_t hash_mix(uint64_t h, uint64_t w) {
+    h ^= w * HASH_K1;
+    h = (h << 31) | (h >> 33);
+    return h * HASH_K2;
+}
+
+static uint64_t hash_bytes(uint64_t h, const uint8_t* p, size_t n) {
+    /* A word at a time, so hashing a model costs a small part of loading it */
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = hash_mix(h, w);
+    }
+    uint64_t tail = 0;
+    if (n) memcpy(&tail, p, n);
+    h = hash_mix(h, tail);
+
+    h ^= h >> 33;
+    h *= HASH_K1;
+    h ^= h >> 29;
+    return h;
+}
+
+uint64_t model_file_hash(const model_file_t* file) {
+    return hash_bytes((uint64_t)file->size, file->data, file->size);
+}
+
+#ifndef _WIN32
+
+/* mkdir -p */
+static int make_dirs(char* path) {
+    for (char* p = path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        int ok = mkdir(path, 0755) == 0 || errno == EEXIST;
+        *p = '/';
+        if (!ok) return -1;
+    }
+    return (mkdir(path, 0755) == 0 || errno == EEXIST) ? 0 : -1;
+}
+
+int model_cache_path(const char* cache_dir, uint64_t model_hash, const char* hw_tag,
+                     const char* ext, char* out, size_t out_size) {
+    char dir[512];
+
+    if (cache_dir && strcmp(cache_dir, "off") == 0) return 0;
+
+    if (cache_dir && cache_dir[0]) {
+        snprintf(dir, sizeof(dir), "%s", cache_dir);
+    } else {
+        const char* xdg = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        if (xdg && xdg[0]) {
+            snprintf(dir, sizeof(dir), "%s/cira", xdg);
+        } else if (home && home[0]) {
+            snprintf(dir, sizeof(dir), "%s/.cache/cira", home);
+        } else {
+            return 0;
+        }
+    }
+
+    if (make_dirs(dir) != 0) {
+        fprintf(stderr, "Model cache: cannot create %s: %s\n", dir, strerror(errno));
+        return 0;
+    }
+
+    uint64_t hw = hash_bytes(0, (const uint8_t*)hw_tag, strlen(hw_tag));
+    int n = snprintf(out, out_size, "%s/%016llx-%08x%s", dir,
+                     (unsigned long long)model_hash, (unsigned)(hw & 0xFFFFFFFFu), ext);
+    return n > 0 && (size_t)n < out_size;
+}
+
+#else /* _WIN32 */
+
+/* No cache directory convention here: caching is off */
+int model_cache_path(const char* cache_dir, uint64_t model_hash, const char* hw_tag,
+                     const char* ext, char* out, size_t out_size) {
+    (void)cache_dir; (void)model_hash; (void)hw_tag; (void)ext; (void)out; (void)out_size;
+    return 0;
+}
+
+#endif /* _WIN32 */
@@ -6,7 +6,10 @@
  * for mobile platforms, but also works on desktop (Windows, Linux, macOS).
  *
  * Key features:
- * - Zero-copy design for minimal memory overhead
+ * - Zero-copy design for minimal memory overhead (weights are read in
+ *   place from the memory-mapped .bin)
+ * - Per-model pool allocators, so steady-state frames reuse blob memory
+ * - Batch workers started once at load, each with its own preprocess plan
  * - Vulkan GPU acceleration when available
  * - CPU fallback for universal compatibility
  * - Supports YOLO detection models exported from CiRA CORE
@@ -20,13 +23,18 @@
  */
 
 #include "cira_internal.h"
+#include "preprocess.h"
+#include "model_file.h"
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <dirent.h>
+#include <pthread.h>
 #include <sys/stat.h>
 
 #ifdef CIRA_NCNN_ENABLED
@@ -35,28 +43,6 @@
 #include <ncnn/layer.h>
 #include <ncnn/cpu.h>
 
-/* DFL (Distribution Focal Loss) decoding for YOLOv8 raw output
- * Takes 16 distribution values, applies softmax, returns weighted sum
- */
-static float dfl_decode(const float* dfl_vals, int reg_max = 16) {
-    /* Find max for numerical stability */
-    float max_val = dfl_vals[0];
-    for (int i = 1; i < reg_max; i++) {
-        if (dfl_vals[i] > max_val) max_val = dfl_vals[i];
-    }
-
-    /* Softmax and weighted sum in one pass */
-    float sum_exp = 0.0f;
-    float weighted_sum = 0.0f;
-    for (int i = 0; i < reg_max; i++) {
-        float exp_val = expf(dfl_vals[i] - max_val);
-        sum_exp += exp_val;
-        weighted_sum += exp_val * i;
-    }
-
-    return weighted_sum / sum_exp;
-}
-
 #if defined(CIRA_VULKAN_ENABLED) && NCNN_VULKAN
 #include <ncnn/gpu.h>
 #endif
@@ -64,9 +50,54 @@ static float dfl_decode(const float* dfl_vals, int reg_max = 16) {
 /* Maximum output layers to store */
 #define NCNN_MAX_OUTPUT_LAYERS 8
 
+/* Per-extractor working memory. An extractor runs on one thread at a time
+ * (the single-image path, or one batch worker), so its blob pool needs no
+ * lock. The vectors keep their capacity between frames. */
+struct ncnn_worker_t {
+    ncnn::UnlockedPoolAllocator blob_pool;
+    preprocess_plan_t plan;                     /* Built on the worker's first image */
+    bool plan_ready = false;
+    std::vector<float> flat_output;             /* De-padded output for the decoder */
+    std::vector<yolo_detection_t> detections;   /* Single-image path results */
+};
+
+/* One batch: worker k runs images k, k + stride, ... */
+struct ncnn_batch_t {
+    cira_ctx* ctx;
+    const uint8_t** images;
+    int count;
+    int w;
+    int h;
+    int stride;                                 /* Workers taking part */
+    int num_threads;                            /* Threads per extractor */
+    std::vector<yolo_detection_t>* detections;  /* One per image */
+    int* results;                               /* One per image */
+    const char** errors;                        /* One per image */
+};
+
+struct ncnn_model_t;
+
+/* Persistent thread running batch worker `index` (>= 1) */
+struct ncnn_batch_thread_t {
+    ncnn_model_t* model;
+    int index;
+    pthread_t thread;
+};
+
 /* Internal NCNN model structure */
 struct ncnn_model_t {
+    /* Allocators live as long as the model and are cleared after net.clear(),
+     * once no blob can still reference them */
+    std::unique_ptr<ncnn_worker_t[]> workers;   /* One per batch worker, [0] for ncnn_predict */
+    int num_workers;
+    ncnn::PoolAllocator workspace_pool;         /* Layer scratch, shared by concurrent workers */
+#if defined(CIRA_VULKAN_ENABLED) && NCNN_VULKAN
+    ncnn::VkBlobAllocator* blob_vkallocator;    /* Blob and workspace memory on the GPU */
+    ncnn::VkStagingAllocator* staging_vkallocator;
+#endif
+
     ncnn::Net net;
+    model_file_t weights;                       /* Mapped .bin the net's weights point into */
     int input_w;
     int input_h;
     int num_classes;
@@ -78,9 +109,37 @@ struct ncnn_model_t {
     /* YOLO output layer names (stored from network at load time) */
     char output_layers[NCNN_MAX_OUTPUT_LAYERS][64];
     int num_output_layers;
-    int active_output_idx;  /* Index of the layer that works for extraction */
+    std::atomic<int> active_output_idx;  /* Layer that works for extraction (shared by batch workers) */
+
+    /* Batch workers 1..num_workers-1 run on threads started at load;
+     * worker 0 is the calling thread */
+    std::unique_ptr<ncnn_batch_thread_t[]> batch_threads;
+    int num_batch_threads;
+    pthread_mutex_t batch_mutex;
+    pthread_cond_t batch_start;     /* New batch posted, or shutdown */
+    pthread_cond_t batch_done;      /* A thread finished its share */
+    ncnn_batch_t batch;             /* Batch in progress (batch_mutex) */
+    uint64_t batch_generation;      /* Bumped per posted batch */
+    int batch_pending;              /* Threads still running the batch */
+    bool batch_shutdown;
+    uint64_t batches;               /* Batches run; summary printed on the first */
 };
 
+/* The worker's preprocess plan, rebuilt only if the input size changes */
+static preprocess_plan_t* worker_plan(ncnn_worker_t& worker, int w, int h) {
+    if (worker.plan_ready && (worker.plan.dst_w != w || worker.plan.dst_h != h)) {
+        preprocess_free(&worker.plan);
+        worker.plan_ready = false;
+    }
+    if (!worker.plan_ready) {
+        if (preprocess_init(&worker.plan, w, h, PREPROCESS_NCHW, 0, 0) != CIRA_OK) {
+            return nullptr;
+        }
+        worker.plan_ready = true;
+    }
+    return &worker.plan;
+}
+
 /* Helper: Check if path is a directory */
 static int is_dir(const char* path) {
     struct stat st;
@@ -110,6 +169,92 @@ static int find_file_ext(const char* dir, const char* ext, char* out, size_t out
     return 0;
 }
 
+/* Create the model's allocators once the network is loaded */
+static int create_allocators(ncnn_model_t* model) {
+    model->num_workers = model->use_vulkan ? 1 : std::max(1, (int)model->net.opt.num_threads);
+    model->workers.reset(new (std::nothrow) ncnn_worker_t[model->num_workers]);
+    if (!model->workers) return CIRA_ERROR_MEMORY;
+
+    for (int i = 0; i < model->num_workers; i++) {
+        model->workers[i].detections.reserve(CIRA_MAX_DETECTIONS * 4);
+    }
+
+#if defined(CIRA_VULKAN_ENABLED) && NCNN_VULKAN
+    if (model->use_vulkan) {
+        const ncnn::VulkanDevice* vkdev = ncnn::get_gpu_device();
+        model->blob_vkallocator = new (std::nothrow) ncnn::VkBlobAllocator(vkdev);
+        model->staging_vkallocator = new (std::nothrow) ncnn::VkStagingAllocator(vkdev);
+        if (!model->blob_vkallocator || !model->staging_vkallocator) return CIRA_ERROR_MEMORY;
+    }
+#endif
+    return CIRA_OK;
+}
+
+static void* ncnn_batch_thread(void* arg);
+
+/* Start threads for batch workers 1..num_workers-1. A thread that fails
+ * to start just lowers the batch parallelism. */
+static void start_batch_threads(ncnn_model_t* model) {
+    int wanted = model->num_workers - 1;
+    if (wanted <= 0) return;
+
+    model->batch_threads.reset(new (std::nothrow) ncnn_batch_thread_t[wanted]);
+    if (!model->batch_threads) return;
+
+    for (int i = 0; i < wanted; i++) {
+        ncnn_batch_thread_t* t = &model->batch_threads[i];
+        t->model = model;
+        t->index = i + 1;
+        if (pthread_create(&t->thread, nullptr, ncnn_batch_thread, t) != 0) break;
+        model->num_batch_threads++;
+    }
+}
+
+/* Stop the batch threads; the net and workers stay untouched */
+static void stop_batch_threads(ncnn_model_t* model) {
+    pthread_mutex_lock(&model->batch_mutex);
+    model->batch_shutdown = true;
+    pthread_cond_broadcast(&model->batch_start);
+    pthread_mutex_unlock(&model->batch_mutex);
+
+    for (int i = 0; i < model->num_batch_threads; i++) {
+        pthread_join(model->batch_threads[i].thread, nullptr);
+    }
+    model->num_batch_threads = 0;
+}
+
+/* Release the network, then the memory its extractors were given */
+static void destroy_model(ncnn_model_t* model) {
+    stop_batch_threads(model);
+    pthread_mutex_destroy(&model->batch_mutex);
+    pthread_cond_destroy(&model->batch_start);
+    pthread_cond_destroy(&model->batch_done);
+
+    model->net.clear();
+    model_file_unmap(&model->weights);
+
+    if (model->workers) {
+        for (int i = 0; i < model->num_workers; i++) {
+            model->workers[i].blob_pool.clear();
+            if (model->workers[i].plan_ready) preprocess_free(&model->workers[i].plan);
+        }
+    }
+    model->workspace_pool.clear();
+
+#if defined(CIRA_VULKAN_ENABLED) && NCNN_VULKAN
+    if (model->blob_vkallocator) {
+        model->blob_vkallocator->clear();
+        delete model->blob_vkallocator;
+    }
+    if (model->staging_vkallocator) {
+        model->staging_vkallocator->clear();
+        delete model->staging_vkallocator;
+    }
+#endif
+
+    delete model;
+}
+
 /**
  * Load an NCNN model from a directory.
  *
@@ -148,6 +293,19 @@ extern "C" int ncnn_load(cira_ctx* ctx, const char* model_path) {
 
     /* Initialize NCNN options */
     model->use_vulkan = false;
+    model->num_workers = 0;
+    model->num_batch_threads = 0;
+    model->batch_generation = 0;
+    model->batch_pending = 0;
+    model->batch_shutdown = false;
+    model->batches = 0;
+    pthread_mutex_init(&model->batch_mutex, nullptr);
+    pthread_cond_init(&model->batch_start, nullptr);
+    pthread_cond_init(&model->batch_done, nullptr);
+#if defined(CIRA_VULKAN_ENABLED) && NCNN_VULKAN
+    model->blob_vkallocator = nullptr;
+    model->staging_vkallocator = nullptr;
+#endif
 
 #if defined(CIRA_VULKAN_ENABLED) && NCNN_VULKAN
     /* Try to initialize Vulkan */
@@ -165,33 +323,83 @@ extern "C" int ncnn_load(cira_ctx* ctx, const char* model_path) {
 
     /* Set NCNN options for optimal performance */
     model->net.opt.lightmode = true;
-    model->net.opt.num_threads = ncnn::get_big_cpu_count();
+    /* One thread per inference CPU when cpu.* pins inference, else the
+     * big cores. The OpenMP team of this (pinned) thread gets the same
+     * mask; teams of the inference threads inherit theirs when created. */
+    cpu_mask_t inference_mask = ctx->cpu_masks[CPU_CLASS_INFERENCE];
+    if (inference_mask) {
+        model->net.opt.num_threads = cpu_mask_count(inference_mask);
+        ncnn::CpuSet cpus;
+        cpus.disable_all();
+        for (int c = 0; c < CPU_AFFINITY_MAX_CPUS; c++) {
+            if (inference_mask & ((cpu_mask_t)1 << c)) cpus.enable(c);
+        }
+        ncnn::set_cpu_thread_affinity(cpus);
+    } else {
+        model->net.opt.num_threads = ncnn::get_big_cpu_count();
+    }
 
-    /* Enable FP16 for better performance on supported hardware */
+    /* Precision from the manifest. By default fp16 storage (half the
+     * weight and blob bandwidth) with fp32 arithmetic for detection
+     * accuracy; "fp16" also computes in half where the CPU or GPU can,
+     * "fp32" keeps everything single precision, and "int8" runs the int8
+     * layers of an ncnn2int8-quantized model on packed int8 kernels. */
     model->net.opt.use_fp16_packed = true;
     model->net.opt.use_fp16_storage = true;
-    model->net.opt.use_fp16_arithmetic = false;  /* Keep false for detection accuracy */
+    model->net.opt.use_fp16_arithmetic = false;
+    switch (ctx->precision) {
+        case CIRA_PRECISION_FP32:
+            model->net.opt.use_fp16_packed = false;
+            model->net.opt.use_fp16_storage = false;
+            model->net.opt.use_bf16_storage = false;
+            model->net.opt.use_int8_inference = false;
+            break;
+        case CIRA_PRECISION_FP16:
+            model->net.opt.use_fp16_arithmetic = true;
+            break;
+        case CIRA_PRECISION_INT8:
+            model->net.opt.use_int8_inference = true;
+            model->net.opt.use_int8_packed = true;
+            model->net.opt.use_int8_storage = true;
+            model->net.opt.use_int8_arithmetic = true;
+            break;
+        default:
+            break;
+    }
 
     fprintf(stderr, "Loading NCNN model:\n");
     fprintf(stderr, "  Param:  %s\n", param_path);
     fprintf(stderr, "  Bin:    %s\n", bin_path);
     fprintf(stderr, "  Threads: %d\n", model->net.opt.num_threads);
+    fprintf(stderr, "  Precision: %s\n", cira_precision_name(ctx->precision));
 
     /* Load network */
     int ret = model->net.load_param(param_path);
     if (ret != 0) {
         cira_set_error(ctx, "Failed to load NCNN param file: %s (error %d)", param_path, ret);
-        delete model;
+        destroy_model(model);
         return CIRA_ERROR_MODEL;
     }
 
-    ret = model->net.load_model(bin_path);
+    /* Weights straight from the page cache; the mapping lives as long as
+     * the net. Read the file into the heap if it cannot be mapped. */
+    if (model_file_map(bin_path, &model->weights) == 0) {
+        ret = model->net.load_model(model->weights.data) > 0 ? 0 : -1;
+    } else {
+        ret = model->net.load_model(bin_path);
+    }
     if (ret != 0) {
         cira_set_error(ctx, "Failed to load NCNN bin file: %s (error %d)", bin_path, ret);
-        delete model;
+        destroy_model(model);
         return CIRA_ERROR_MODEL;
     }
 
+    if (create_allocators(model) != CIRA_OK) {
+        cira_set_error(ctx, "Failed to allocate NCNN allocators");
+        destroy_model(model);
+        return CIRA_ERROR_MEMORY;
+    }
+
     /* Get input dimensions from network */
     /* NCNN doesn't expose this directly, so we use manifest values or defaults */
     /* ctx->input_w/h may already be set from cira_model.json manifest by cira_load() */
@@ -258,6 +466,9 @@ extern "C" int ncnn_load(cira_ctx* ctx, const char* model_path) {
     }
     fprintf(stderr, "\n");
 
+    start_batch_threads(model);
+    fprintf(stderr, "  Batch workers: %d\n", model->num_batch_threads + 1);
+
     /* Store model handle in context */
     ctx->model_handle = model;
 
@@ -273,52 +484,64 @@ extern "C" void ncnn_unload(cira_ctx* ctx) {
 
     ncnn_model_t* model = static_cast<ncnn_model_t*>(ctx->model_handle);
 
-    model->net.clear();
-    delete model;
+    destroy_model(model);
     ctx->model_handle = nullptr;
 
     fprintf(stderr, "NCNN model unloaded\n");
 }
 
+/* Debug output, suppressed on batch worker threads */
+#define NCNN_LOG(...) do { if (verbose) fprintf(stderr, __VA_ARGS__); } while (0)
+
 /**
- * Run YOLO inference on an image using NCNN.
+ * Run the network on one image and decode its YOLO output.
+ * Only reads ctx settings, so several calls may run concurrently on one
+ * model (each with its own extractor and worker).
  *
- * @param ctx Context with loaded NCNN model
- * @param data RGB image data (packed HWC, row-major)
- * @param w Image width
- * @param h Image height
- * @param channels Number of channels (must be 3)
+ * The extractor is created per image because it caches every blob it
+ * computes; its blob memory comes from the worker's pool, so steady-state
+ * frames reuse the previous frame's blocks.
+ *
+ * @param worker      Working memory, used by one call at a time
+ * @param num_threads Threads for this extractor
+ * @param detections  Output: detections in pixels of the original image
+ *                    (or normalized, for pre-decoded outputs)
+ * @param error       Output: error message on failure
+ * @param verbose     Print debug information
+ * @param timing      Output: stage times, or NULL
  * @return CIRA_OK on success
  */
-extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
-    if (!ctx || !ctx->model_handle || !data) {
-        return CIRA_ERROR_INPUT;
-    }
-
-    if (channels != 3) {
-        cira_set_error(ctx, "Only 3-channel images supported");
-        return CIRA_ERROR_INPUT;
-    }
-
-    ncnn_model_t* model = static_cast<ncnn_model_t*>(ctx->model_handle);
-
-    /* Clear previous detections */
-    cira_clear_detections(ctx);
+static int ncnn_infer(cira_ctx* ctx, ncnn_model_t* model, ncnn_worker_t& worker,
+                      const uint8_t* data, int w, int h,
+                      int num_threads, std::vector<yolo_detection_t>& detections,
+                      const char** error, bool verbose, cira_predict_timing_t* timing) {
+    double t0 = cira_time_ms();
 
-    /* Create NCNN Mat from RGB data */
+    /* Resize, normalize to 0-1 and split into planes in one pass */
     /* Darknet models are trained on RGB, darknet2ncnn preserves channel order */
-    ncnn::Mat in = ncnn::Mat::from_pixels_resize(
-        data, ncnn::Mat::PIXEL_RGB,
-        w, h,
-        model->input_w, model->input_h
-    );
-
-    /* Normalize to 0-1 range (YOLO standard) */
-    const float norm_vals[3] = {1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f};
-    in.substract_mean_normalize(nullptr, norm_vals);
+    ncnn::Mat in;
+    in.create(model->input_w, model->input_h, 3, 4u, &worker.blob_pool);
+    preprocess_plan_t* plan = worker_plan(worker, model->input_w, model->input_h);
+    if (in.empty() || !plan) {
+        *error = "Failed to allocate NCNN input";
+        return CIRA_ERROR_MEMORY;
+    }
+    plan->plane_stride = in.cstep;
+    preprocess_run(plan, data, w, h, (float*)in.data);
+    double t1 = cira_time_ms();
 
-    /* Create extractor */
+    /* Create extractor on the model's allocators */
     ncnn::Extractor ex = model->net.create_extractor();
+    ex.set_num_threads(num_threads);
+    ex.set_blob_allocator(&worker.blob_pool);
+    ex.set_workspace_allocator(&model->workspace_pool);
+#if defined(CIRA_VULKAN_ENABLED) && NCNN_VULKAN
+    if (model->use_vulkan) {
+        ex.set_blob_vkallocator(model->blob_vkallocator);
+        ex.set_workspace_vkallocator(model->blob_vkallocator);
+        ex.set_staging_vkallocator(model->staging_vkallocator);
+    }
+#endif
 
     /* Set input using stored input layer name */
     ex.input(model->input_layer, in);
@@ -344,10 +567,10 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
         int ret2 = ex.extract("out2", out2);
 
         if (ret0 == 0 && ret1 == 0 && ret2 == 0) {
-            fprintf(stderr, "NCNN: YOLOv11 multi-scale outputs detected:\n");
-            fprintf(stderr, "  out0: w=%d, h=%d, c=%d\n", out0.w, out0.h, out0.c);
-            fprintf(stderr, "  out1: w=%d, h=%d, c=%d\n", out1.w, out1.h, out1.c);
-            fprintf(stderr, "  out2: w=%d, h=%d, c=%d\n", out2.w, out2.h, out2.c);
+            NCNN_LOG("NCNN: YOLOv11 multi-scale outputs detected:\n");
+            NCNN_LOG("  out0: w=%d, h=%d, c=%d\n", out0.w, out0.h, out0.c);
+            NCNN_LOG("  out1: w=%d, h=%d, c=%d\n", out1.w, out1.h, out1.c);
+            NCNN_LOG("  out2: w=%d, h=%d, c=%d\n", out2.w, out2.h, out2.c);
 
             /* YOLOv11 outputs have shape: [c=grid_h, h=grid_w, w=144]
              * where 144 = 64 DFL + 80 classes
@@ -394,17 +617,17 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
                 }
             }
 
-            fprintf(stderr, "NCNN: Scale order after sorting:\n");
+            NCNN_LOG("NCNN: Scale order after sorting:\n");
             for (int i = 0; i < 3; i++) {
-                fprintf(stderr, "  Scale %d: %d boxes (%dx%d grid), stride=%d\n",
+                NCNN_LOG("  Scale %d: %d boxes (%dx%d grid), stride=%d\n",
                         i, scales[i].boxes, scales[i].grid_size, scales[i].grid_size, scales[i].stride);
             }
 
-            fprintf(stderr, "NCNN: Boxes per scale: %d + %d + %d = %d total\n",
+            NCNN_LOG("NCNN: Boxes per scale: %d + %d + %d = %d total\n",
                     scales[0].boxes, scales[1].boxes, scales[2].boxes, total_boxes);
 
             /* Create combined output: [c=1, h=total_boxes, w=144] */
-            out.create(box_width, total_boxes, 1);
+            out.create(box_width, total_boxes, 1, 4u, &worker.blob_pool);
             if (!out.empty()) {
                 float* dst = (float*)out.data;
 
@@ -420,20 +643,20 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
 
                 ret = 0;
                 is_multi_output = true;
-                fprintf(stderr, "NCNN: Combined output: w=%d, h=%d, c=%d (%d total boxes)\n",
+                NCNN_LOG("NCNN: Combined output: w=%d, h=%d, c=%d (%d total boxes)\n",
                         out.w, out.h, out.c, total_boxes);
 
                 /* Debug: print first few class scores to verify sigmoid */
                 if (out.h > 0) {
                     const float* first_box = (const float*)out.data;
-                    fprintf(stderr, "NCNN: First box class scores (64-73): ");
+                    NCNN_LOG("NCNN: First box class scores (64-73): ");
                     for (int c = 0; c < 10; c++) {
-                        fprintf(stderr, "%.3f ", first_box[64 + c]);
+                        NCNN_LOG("%.3f ", first_box[64 + c]);
                     }
-                    fprintf(stderr, "\n");
+                    NCNN_LOG("\n");
                 }
             } else {
-                cira_set_error(ctx, "Failed to allocate combined output tensor");
+                *error = "Failed to allocate combined output tensor";
                 return CIRA_ERROR_MEMORY;
             }
         }
@@ -442,8 +665,9 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
     /* Single output layer fallback */
     if (!is_multi_output) {
         /* If we already found a working output layer, use it directly */
-        if (model->active_output_idx >= 0 && model->active_output_idx < model->num_output_layers) {
-            ret = ex.extract(model->output_layers[model->active_output_idx], out);
+        int active = model->active_output_idx;
+        if (active >= 0 && active < model->num_output_layers) {
+            ret = ex.extract(model->output_layers[active], out);
             if (ret == 0 && (out.w > 0 || out.h > 0 || out.c > 0)) {
                 /* Still working, use it */
             } else {
@@ -458,7 +682,7 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
                 ret = ex.extract(model->output_layers[i], out);
                 if (ret == 0 && (out.w > 0 || out.h > 0 || out.c > 0)) {
                     model->active_output_idx = i;
-                    fprintf(stderr, "NCNN: Using output layer '%s' (w=%d, h=%d, c=%d)\n",
+                    NCNN_LOG("NCNN: Using output layer '%s' (w=%d, h=%d, c=%d)\n",
                             model->output_layers[i], out.w, out.h, out.c);
                     break;
                 }
@@ -467,20 +691,23 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
     }
 
     if (ret != 0 || (out.w == 0 && out.h == 0 && out.c == 0)) {
-        cira_set_error(ctx, "Failed to extract NCNN output (no valid output layer found)");
+        *error = "Failed to extract NCNN output (no valid output layer found)";
         return CIRA_ERROR;
     }
 
+    /* The network runs inside extract() */
+    double t2 = cira_time_ms();
+
     /* Parse YOLO output using unified decoder */
-    fprintf(stderr, "NCNN output: w=%d, h=%d, c=%d (YOLO version: %s)\n",
+    NCNN_LOG("NCNN output: w=%d, h=%d, c=%d (YOLO version: %s)\n",
             out.w, out.h, out.c, yolo_version_name(ctx->yolo_version));
 
-    std::vector<yolo_detection_t> detections;
     float conf_thresh = ctx->confidence_threshold;
     int num_classes = model->num_classes;
 
     /* Detect output format and use unified decoder when possible */
     bool use_unified_decoder = false;
+    yolo_version_t version = ctx->yolo_version;
     int64_t output_shape[4] = {1, 0, 0, 0};
     int num_dims = 3;
 
@@ -512,160 +739,26 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
     /* Check for YOLOv8 DFL format: [c=1, h=num_boxes, w=64+classes] (raw Distribution Focal Loss) */
     /* 64 = 4 coords * 16 DFL bins, followed by class scores */
     else if (out.c == 1 && out.h > 1000 && out.w == 64 + num_classes) {
-        fprintf(stderr, "NCNN: Detected YOLOv8 DFL format (h=%d boxes, w=%d = 64 DFL + %d classes)\n",
+        NCNN_LOG("NCNN: Detected YOLOv8 DFL format (h=%d boxes, w=%d = 64 DFL + %d classes)\n",
                 out.h, out.w, num_classes);
 
-        /* YOLOv8 anchor-free detection with DFL
-         * Output shape: [num_boxes, 64 + num_classes]
-         * - First 64 values: DFL for bbox (4 * 16 bins for left, top, right, bottom)
-         * - Remaining values: class scores (raw logits)
-         *
-         * Decode steps:
-         * 1. Apply DFL to get 4 distance values (dist_left, dist_top, dist_right, dist_bottom)
-         * 2. Convert distances to bbox: x1 = cx - dist_left, y1 = cy - dist_top, etc.
-         * 3. Apply sigmoid to class scores and find max
-         */
-
-        /* YOLOv8/v11 uses 3 scales with 8400 total boxes for 640 input
-         * Dynamically compute grid sizes and strides from actual box count
-         */
-        int total_boxes = out.h;
-
-        /* Standard YOLOv8/v11 ratios: 64:16:4 = 6400:1600:400 for 640 input */
-        /* Grid sizes are sqrt of box counts, strides are input_w / grid_size */
-        int grid_sizes[3];
-        int strides[3];
-        int expected_boxes[3];
-
-        /* Compute based on input size */
-        int base_grid = model->input_w / 8;  /* Largest grid at stride 8 */
-        grid_sizes[0] = base_grid;           /* 80 for 640 input */
-        grid_sizes[1] = base_grid / 2;       /* 40 for 640 input */
-        grid_sizes[2] = base_grid / 4;       /* 20 for 640 input */
-
-        strides[0] = 8;
-        strides[1] = 16;
-        strides[2] = 32;
-
-        expected_boxes[0] = grid_sizes[0] * grid_sizes[0];
-        expected_boxes[1] = grid_sizes[1] * grid_sizes[1];
-        expected_boxes[2] = grid_sizes[2] * grid_sizes[2];
-
-        int expected_total = expected_boxes[0] + expected_boxes[1] + expected_boxes[2];
-
-        fprintf(stderr, "NCNN: DFL decode - input=%dx%d, total_boxes=%d (expected %d)\n",
-                model->input_w, model->input_h, total_boxes, expected_total);
-        fprintf(stderr, "NCNN: Grid sizes: %d, %d, %d, Strides: %d, %d, %d\n",
-                grid_sizes[0], grid_sizes[1], grid_sizes[2],
-                strides[0], strides[1], strides[2]);
-
-        int scale_factor = 1;  /* Already computed in grid sizes */
-
-        /* Check if class scores need sigmoid (YOLOv11 NCNN exports have convsigmoid layers) */
-        /* Sample first box to detect if values are already probabilities */
-        bool needs_sigmoid = false;
-        if (out.h > 0) {
-            const float* sample = (const float*)out.data;
-            for (int c = 0; c < num_classes && c < 10; c++) {
-                float val = sample[64 + c];
-                if (val < 0.0f || val > 1.0f) {
-                    needs_sigmoid = true;
-                    break;
-                }
-            }
-        }
-        fprintf(stderr, "NCNN: Class scores need sigmoid: %s\n", needs_sigmoid ? "yes" : "no (already probabilities)");
-
-        int box_idx = 0;
-        for (int scale = 0; scale < 3 && box_idx < out.h; scale++) {
-            int grid_h = grid_sizes[scale] * scale_factor;
-            int grid_w = grid_sizes[scale] * scale_factor;
-            int stride = strides[scale];
-
-            for (int gy = 0; gy < grid_h && box_idx < out.h; gy++) {
-                for (int gx = 0; gx < grid_w && box_idx < out.h; gx++) {
-                    const float* row = (const float*)out.data + box_idx * out.w;
-
-                    /* Find best class score */
-                    int best_class = 0;
-                    float best_score = 0.0f;
-                    for (int c = 0; c < num_classes; c++) {
-                        float score = row[64 + c];
-                        if (needs_sigmoid) {
-                            score = 1.0f / (1.0f + expf(-score));  /* sigmoid */
-                        }
-                        if (score > best_score) {
-                            best_score = score;
-                            best_class = c;
-                        }
-                    }
-
-                    if (best_score > conf_thresh) {
-                        /* Decode DFL to get distances */
-                        float dist_left = dfl_decode(row + 0);
-                        float dist_top = dfl_decode(row + 16);
-                        float dist_right = dfl_decode(row + 32);
-                        float dist_bottom = dfl_decode(row + 48);
-
-                        /* Anchor point is center of grid cell */
-                        float cx = (gx + 0.5f) * stride;
-                        float cy = (gy + 0.5f) * stride;
-
-                        /* Convert distances to bbox coordinates */
-                        float x1 = cx - dist_left * stride;
-                        float y1 = cy - dist_top * stride;
-                        float x2 = cx + dist_right * stride;
-                        float y2 = cy + dist_bottom * stride;
-
-                        /* Clamp to image bounds */
-                        x1 = fmaxf(0.0f, fminf(x1, (float)model->input_w));
-                        y1 = fmaxf(0.0f, fminf(y1, (float)model->input_h));
-                        x2 = fmaxf(0.0f, fminf(x2, (float)model->input_w));
-                        y2 = fmaxf(0.0f, fminf(y2, (float)model->input_h));
-
-                        /* Scale to original image size */
-                        float scale_x = (float)w / model->input_w;
-                        float scale_y = (float)h / model->input_h;
-
-                        yolo_detection_t det;
-                        det.x1 = x1 * scale_x;
-                        det.y1 = y1 * scale_y;
-                        det.x2 = x2 * scale_x;
-                        det.y2 = y2 * scale_y;
-                        det.score = best_score;
-                        det.class_id = best_class;
-
-                        detections.push_back(det);
-                    }
-
-                    box_idx++;
-                }
-            }
-        }
-
-        fprintf(stderr, "NCNN: DFL decoded %zu candidates (before NMS, threshold=%.2f)\n",
-                detections.size(), conf_thresh);
-
-        /* Debug: show score distribution of first few detections */
-        if (detections.size() > 0) {
-            fprintf(stderr, "NCNN: Sample detection scores: ");
-            for (size_t i = 0; i < detections.size() && i < 10; i++) {
-                fprintf(stderr, "%.3f ", detections[i].score);
-            }
-            fprintf(stderr, "\n");
-        }
+        /* Rows of 4 x 16 DFL bins then class scores, decoded by the shared decoder */
+        output_shape[1] = out.h;
+        output_shape[2] = out.w;
+        version = YOLO_VERSION_V8;
+        use_unified_decoder = true;
     }
     /* Check for YOLOv8/v11 transposed format: [1, 4+C, num_boxes] */
     /* NCNN Mat: c=1, h=4+classes, w=num_boxes (e.g., 8400) */
     else if (out.c == 1 && out.h == 4 + num_classes && out.w > 1000) {
-        fprintf(stderr, "NCNN: Detected YOLOv8/v11 transposed format\n");
+        NCNN_LOG("NCNN: Detected YOLOv8/v11 transposed format\n");
         output_shape[1] = out.h;  /* 4+classes */
         output_shape[2] = out.w;  /* num_boxes */
         use_unified_decoder = true;
     }
     /* Check for YOLOv8/v11 alternative: c=4+classes, h=num_boxes, w=1 */
     else if (out.w == 1 && out.c == 4 + num_classes && out.h > 1000) {
-        fprintf(stderr, "NCNN: Detected YOLOv8/v11 format (c=%d, h=%d)\n", out.c, out.h);
+        NCNN_LOG("NCNN: Detected YOLOv8/v11 format (c=%d, h=%d)\n", out.c, out.h);
         /* Need to reshape: treat as [1, c, h] */
         output_shape[1] = out.c;
         output_shape[2] = out.h;
@@ -673,7 +766,7 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
     }
     /* Check for YOLOv5/v7 format: [num_boxes, 5+classes] */
     else if (out.h > 1000 && out.w == 5 + num_classes) {
-        fprintf(stderr, "NCNN: Detected YOLOv5/v7 format\n");
+        NCNN_LOG("NCNN: Detected YOLOv5/v7 format\n");
         output_shape[1] = out.h;
         output_shape[2] = out.w;
         use_unified_decoder = true;
@@ -730,26 +823,46 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
     /* Use unified decoder for YOLOv5/v7/v8/v11 formats */
     if (use_unified_decoder) {
         yolo_decode_config_t decode_config;
-        decode_config.version = ctx->yolo_version;
+        decode_config.version = version;
         decode_config.input_w = model->input_w;
         decode_config.input_h = model->input_h;
         decode_config.num_classes = num_classes;
         decode_config.conf_threshold = conf_thresh;
         decode_config.nms_threshold = ctx->nms_threshold;
         decode_config.max_detections = CIRA_MAX_DETECTIONS;
+        decode_config.verbose = verbose;
+
+        /* Channels are padded to cstep; flatten only when that leaves gaps */
+        const float* output_data = static_cast<const float*>(out.data);
+        std::vector<float>& flat_output = worker.flat_output;
+        if (out.c > 1 && out.cstep != (size_t)out.w * out.h) {
+            flat_output.resize((size_t)out.w * out.h * out.c);
+            for (int q = 0; q < out.c; q++) {
+                memcpy(flat_output.data() + (size_t)q * out.w * out.h, out.channel(q),
+                       (size_t)out.w * out.h * sizeof(float));
+            }
+            output_data = flat_output.data();
+        }
 
-        /* Flatten NCNN Mat to contiguous array */
-        std::vector<float> flat_output(out.total());
-        memcpy(flat_output.data(), out.data, out.total() * sizeof(float));
-
-        detections.resize(CIRA_MAX_DETECTIONS);
-        int count = yolo_decode(flat_output.data(), output_shape, num_dims,
-                               &decode_config, detections.data(), CIRA_MAX_DETECTIONS);
+        /* Room for candidates beyond the final count so NMS sees the best ones */
+        detections.resize(CIRA_MAX_DETECTIONS * 4);
+        int count = yolo_decode(output_data, output_shape, num_dims,
+                               &decode_config, detections.data(), (int)detections.size());
         if (count > 0) {
             detections.resize(count);
         } else {
             detections.clear();
         }
+
+        /* Decoder works in model input pixels; scale to the original image */
+        float scale_x = static_cast<float>(w) / model->input_w;
+        float scale_y = static_cast<float>(h) / model->input_h;
+        for (auto& det : detections) {
+            det.x1 *= scale_x;
+            det.y1 *= scale_y;
+            det.x2 *= scale_x;
+            det.y2 *= scale_y;
+        }
     }
 
     /* Apply NMS for non-unified decoder paths */
@@ -759,6 +872,19 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
         detections.resize(count);
     }
 
+    if (timing) {
+        timing->preprocess_ms = t1 - t0;
+        timing->inference_ms = t2 - t1;
+        timing->decode_ms = cira_time_ms() - t2;
+    }
+    return CIRA_OK;
+}
+
+#undef NCNN_LOG
+
+/* Add decoded detections to ctx, normalized to the image size */
+static void add_detections(cira_ctx* ctx, const std::vector<yolo_detection_t>& detections,
+                           int w, int h) {
     /* Convert to cira format */
     for (const auto& det : detections) {
         float norm_x, norm_y, norm_w, norm_h;
@@ -796,11 +922,182 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
             break;
         }
     }
+}
+
+/**
+ * Run YOLO inference on an image using NCNN.
+ *
+ * @param ctx Context with loaded NCNN model
+ * @param data RGB image data (packed HWC, row-major)
+ * @param w Image width
+ * @param h Image height
+ * @param channels Number of channels (must be 3)
+ * @return CIRA_OK on success
+ */
+extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
+    if (!ctx || !ctx->model_handle || !data) {
+        return CIRA_ERROR_INPUT;
+    }
+
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel images supported");
+        return CIRA_ERROR_INPUT;
+    }
+
+    ncnn_model_t* model = static_cast<ncnn_model_t*>(ctx->model_handle);
+
+    /* Clear previous detections */
+    cira_clear_detections(ctx);
+
+    /* Reused buffers: count the frames that had to grow them */
+    ncnn_worker_t& worker = model->workers[0];
+    std::vector<yolo_detection_t>& detections = worker.detections;
+    size_t det_capacity = detections.capacity();
+    size_t flat_capacity = worker.flat_output.capacity();
+    detections.clear();
+
+    const char* error = nullptr;
+    int ret = ncnn_infer(ctx, model, worker, data, w, h, model->net.opt.num_threads,
+                         detections, &error, true, &ctx->predict_timing);
+    if (detections.capacity() != det_capacity || worker.flat_output.capacity() != flat_capacity) {
+        ctx->predict_allocations++;
+    }
+    if (ret != CIRA_OK) {
+        cira_set_error(ctx, "%s", error);
+        return ret;
+    }
+
+    add_detections(ctx, detections, w, h);
 
     fprintf(stderr, "NCNN inference: %d detections\n", ctx->num_detections);
     return CIRA_OK;
 }
 
+/* Run batch worker `index`'s share of the images on its own extractor */
+static void run_batch_share(ncnn_model_t* model, const ncnn_batch_t* batch, int index) {
+    for (int i = index; i < batch->count; i += batch->stride) {
+        batch->results[i] = ncnn_infer(batch->ctx, model, model->workers[index], batch->images[i],
+                                       batch->w, batch->h, batch->num_threads,
+                                       batch->detections[i], &batch->errors[i], false, nullptr);
+    }
+}
+
+/* Persistent batch thread: waits for a batch it takes part in, runs its share */
+static void* ncnn_batch_thread(void* arg) {
+    ncnn_batch_thread_t* self = static_cast<ncnn_batch_thread_t*>(arg);
+    ncnn_model_t* model = self->model;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&model->batch_mutex);
+    for (;;) {
+        while (!model->batch_shutdown && model->batch_generation == seen) {
+            pthread_cond_wait(&model->batch_start, &model->batch_mutex);
+        }
+        if (model->batch_shutdown) break;
+        seen = model->batch_generation;
+        if (self->index >= model->batch.stride) continue;  /* Not needed for this batch */
+
+        ncnn_batch_t batch = model->batch;
+        pthread_mutex_unlock(&model->batch_mutex);
+        run_batch_share(model, &batch, self->index);
+        pthread_mutex_lock(&model->batch_mutex);
+
+        if (--model->batch_pending == 0) {
+            pthread_cond_signal(&model->batch_done);
+        }
+    }
+    pthread_mutex_unlock(&model->batch_mutex);
+    return nullptr;
+}
+
+/**
+ * Run YOLO inference on a batch of images using NCNN.
+ *
+ * NCNN networks have no batch dimension, so the batch is spread over
+ * concurrent extractors on the shared net: one worker per core (up to the
+ * batch size), with the net's threads split evenly between them. This
+ * keeps all cores busy on small models where one multi-threaded extractor
+ * cannot. Worker 0 is the calling thread, the others are the threads
+ * started at load. With Vulkan the GPU serializes work, so
+ * the batch runs on a single extractor. Results are stored per image with
+ * cira_batch_store().
+ *
+ * @param ctx Context with loaded NCNN model
+ * @param images RGB images (packed HWC, all w x h)
+ * @param count Number of images
+ * @return CIRA_OK on success
+ */
+extern "C" int ncnn_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                                  int w, int h, int channels) {
+    if (!ctx || !ctx->model_handle || !images || count <= 0) {
+        return CIRA_ERROR_INPUT;
+    }
+
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel images supported");
+        return CIRA_ERROR_INPUT;
+    }
+
+    ncnn_model_t* model = static_cast<ncnn_model_t*>(ctx->model_handle);
+
+    int total_threads = model->net.opt.num_threads > 0 ? model->net.opt.num_threads : 1;
+    int num_workers = std::min(count, std::min(total_threads, model->num_batch_threads + 1));
+    int threads_per_worker = std::max(1, total_threads / num_workers);
+
+    std::vector<std::vector<yolo_detection_t>> detections(count);
+    std::vector<int> results(count, CIRA_ERROR);
+    std::vector<const char*> errors(count, nullptr);
+
+    ncnn_batch_t batch;
+    batch.ctx = ctx;
+    batch.images = images;
+    batch.count = count;
+    batch.w = w;
+    batch.h = h;
+    batch.stride = num_workers;
+    batch.num_threads = threads_per_worker;
+    batch.detections = detections.data();
+    batch.results = results.data();
+    batch.errors = errors.data();
+
+    /* Post the batch to the threads of workers 1..num_workers-1 */
+    if (num_workers > 1) {
+        pthread_mutex_lock(&model->batch_mutex);
+        model->batch = batch;
+        model->batch_pending = num_workers - 1;
+        model->batch_generation++;
+        pthread_cond_broadcast(&model->batch_start);
+        pthread_mutex_unlock(&model->batch_mutex);
+    }
+
+    run_batch_share(model, &batch, 0);
+
+    if (num_workers > 1) {
+        pthread_mutex_lock(&model->batch_mutex);
+        while (model->batch_pending > 0) {
+            pthread_cond_wait(&model->batch_done, &model->batch_mutex);
+        }
+        pthread_mutex_unlock(&model->batch_mutex);
+    }
+
+    /* Store results in image order */
+    for (int i = 0; i < count; i++) {
+        if (results[i] != CIRA_OK) {
+            cira_set_error(ctx, "%s", errors[i] ? errors[i] : "NCNN inference failed");
+            return results[i];
+        }
+        cira_clear_detections(ctx);
+        add_detections(ctx, detections[i], w, h);
+        cira_batch_store(ctx, w, h);
+    }
+
+    if (model->batches++ == 0) {
+        fprintf(stderr, "NCNN batch inference: %d images (%d workers x %d threads)\n",
+                count, num_workers, threads_per_worker);
+    }
+    return CIRA_OK;
+}
+
 #else /* CIRA_NCNN_ENABLED */
 
 /* Stubs when NCNN is not enabled */
@@ -823,4 +1120,15 @@ extern "C" int ncnn_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, in
     return CIRA_ERROR_MODEL;
 }
 
+extern "C" int ncnn_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                                  int w, int h, int channels) {
+    (void)images;
+    (void)count;
+    (void)w;
+    (void)h;
+    (void)channels;
+    cira_set_error(ctx, "NCNN support not enabled in this build");
+    return CIRA_ERROR_MODEL;
+}
+
 #endif /* CIRA_NCNN_ENABLED */
@@ -9,17 +9,27 @@
  * - Format B: [1, num_detections, 7] - [batch_id, class_id, score, x1, y1, x2, y2]
  * - Format C: [1, num_detections, 5+num_classes] - [cx, cy, w, h, obj_conf, class_probs...]
  *
+ * Sessions run on the first execution provider of the model's list
+ * (onnx_providers.h) that this ONNX Runtime build has and that accepts
+ * the model; CPU is the last resort.
+ *
  * (c) CiRA Robotics / KMITL 2026
  */
 
 #include "cira.h"
 #include "cira_internal.h"
+#include "preprocess.h"
+#include "model_file.h"
+#include "onnx_providers.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 #ifdef CIRA_ONNX_ENABLED
 
@@ -31,6 +41,18 @@
 /* ONNX Runtime globals */
 static const OrtApi* g_ort = NULL;
 
+/* Pre-NMS candidate buffer size */
+#define ONNX_MAX_CANDIDATES (CIRA_MAX_DETECTIONS * 4)
+
+/* Output tensor as seen by the decoder */
+typedef struct {
+    void* data;
+    int64_t shape[6];
+    size_t num_dims;
+    ONNXTensorElementDataType type;
+    size_t elements;
+} onnx_output_t;
+
 /* Internal ONNX model structure */
 typedef struct {
     OrtEnv* env;
@@ -50,28 +72,30 @@ typedef struct {
     int input_c;
     int num_classes;
     int is_nhwc;              /* 1 if input is NHWC, 0 if NCHW */
+    int batch_size;           /* Fixed batch size, 0 if the batch dim is dynamic */
     ONNXTensorElementDataType input_type;  /* ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT or _FLOAT16 */
-} onnx_model_t;
 
-/* Convert float32 to float16 (IEEE 754 half-precision) */
-static uint16_t float_to_half(float value) {
-    uint32_t f = *(uint32_t*)&value;
-    uint32_t sign = (f >> 16) & 0x8000;
-    int32_t exponent = ((f >> 23) & 0xff) - 127 + 15;
-    uint32_t mantissa = f & 0x7fffff;
-
-    if (exponent <= 0) {
-        if (exponent < -10) return (uint16_t)sign;
-        mantissa = (mantissa | 0x800000) >> (1 - exponent);
-        return (uint16_t)(sign | (mantissa >> 13));
-    } else if (exponent == 0xff - 127 + 15) {
-        if (mantissa == 0) return (uint16_t)(sign | 0x7c00);  /* Inf */
-        return (uint16_t)(sign | 0x7c00 | (mantissa >> 13));  /* NaN */
-    } else if (exponent > 30) {
-        return (uint16_t)(sign | 0x7c00);  /* Overflow to Inf */
-    }
-    return (uint16_t)(sign | (exponent << 10) | (mantissa >> 13));
-}
+    /* Single-image path, allocated and bound once at load */
+    OrtIoBinding* binding;
+    preprocess_plan_t plan;   /* Resize/normalize into the input tensor */
+    OrtValue* input_value;    /* Wraps input_buf */
+    void* input_buf;          /* float, or uint16_t for float16 models */
+    OrtValue* output_values[4];
+    onnx_output_t output_info[4];  /* Preallocated outputs (data owned) */
+    int outputs_bound;        /* 1 if every output is preallocated */
+    yolo_detection_t* det_buf;     /* ONNX_MAX_CANDIDATES entries */
+    float* convert_buf;       /* float16 -> float32 output conversion */
+    size_t convert_capacity;  /* Bytes */
+    uint64_t frames;          /* Frames run; debug output on the first */
+
+    /* Batch path input tensor (grown on demand, kept between calls) */
+    void* batch_buf;
+    size_t batch_capacity;
+
+    /* Cached optimized graph the session reads its weights from (kept
+     * mapped for the session's lifetime) */
+    model_file_t cached_graph;
+} onnx_model_t;
 
 /* ============================================
  * Helper Functions
@@ -106,44 +130,6 @@ static int find_file_ext(const char* dir, const char* ext, char* out, size_t out
     return 0;
 }
 
-/* Bilinear interpolation resize (pure C, no OpenCV) */
-static void bilinear_resize(const uint8_t* src, int src_w, int src_h,
-                            uint8_t* dst, int dst_w, int dst_h, int channels) {
-    float x_ratio = (float)(src_w - 1) / (dst_w - 1);
-    float y_ratio = (float)(src_h - 1) / (dst_h - 1);
-
-    for (int y = 0; y < dst_h; y++) {
-        float fy = y * y_ratio;
-        int y_low = (int)fy;
-        int y_high = y_low + 1;
-        if (y_high >= src_h) y_high = src_h - 1;
-        float y_lerp = fy - y_low;
-
-        for (int x = 0; x < dst_w; x++) {
-            float fx = x * x_ratio;
-            int x_low = (int)fx;
-            int x_high = x_low + 1;
-            if (x_high >= src_w) x_high = src_w - 1;
-            float x_lerp = fx - x_low;
-
-            for (int c = 0; c < channels; c++) {
-                /* Get four corners */
-                float c00 = src[(y_low * src_w + x_low) * channels + c];
-                float c10 = src[(y_low * src_w + x_high) * channels + c];
-                float c01 = src[(y_high * src_w + x_low) * channels + c];
-                float c11 = src[(y_high * src_w + x_high) * channels + c];
-
-                /* Bilinear interpolation */
-                float top = c00 * (1.0f - x_lerp) + c10 * x_lerp;
-                float bottom = c01 * (1.0f - x_lerp) + c11 * x_lerp;
-                float value = top * (1.0f - y_lerp) + bottom * y_lerp;
-
-                dst[(y * dst_w + x) * channels + c] = (uint8_t)(value + 0.5f);
-            }
-        }
-    }
-}
-
 /* Clamp value to range */
 static float clamp_f(float v, float lo, float hi) {
     if (v < lo) return lo;
@@ -151,6 +137,486 @@ static float clamp_f(float v, float lo, float hi) {
     return v;
 }
 
+/* Log and release a failed ORT status; returns 1 if the call succeeded */
+static int ort_ok(OrtStatus* status, const char* what) {
+    if (!status) return 1;
+    fprintf(stderr, "ONNX: %s failed: %s\n", what, g_ort->GetErrorMessage(status));
+    g_ort->ReleaseStatus(status);
+    return 0;
+}
+
+/* Grow a predict-path buffer. Each growth counts as a predict allocation. */
+static int grow_buffer(cira_ctx* ctx, void** buf, size_t* capacity, size_t need) {
+    if (need <= *capacity) return 1;
+    void* p = realloc(*buf, need);
+    if (!p) return 0;
+    *buf = p;
+    *capacity = need;
+    ctx->predict_allocations++;
+    return 1;
+}
+
+/* Read shape, type and data of an ORT-allocated output tensor */
+static int describe_output(OrtValue* value, onnx_output_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->type = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+
+    if (!ort_ok(g_ort->GetTensorMutableData(value, &out->data), "GetTensorMutableData")) {
+        return 0;
+    }
+
+    OrtTensorTypeAndShapeInfo* info = NULL;
+    ORT_IGNORE(g_ort->GetTensorTypeAndShape(value, &info));
+    if (info) {
+        ORT_IGNORE(g_ort->GetDimensionsCount(info, &out->num_dims));
+        if (out->num_dims <= 6) {
+            ORT_IGNORE(g_ort->GetDimensions(info, out->shape, out->num_dims));
+        } else {
+            out->num_dims = 0;
+        }
+        ORT_IGNORE(g_ort->GetTensorElementType(info, &out->type));
+        ORT_IGNORE(g_ort->GetTensorShapeElementCount(info, &out->elements));
+        g_ort->ReleaseTensorTypeAndShapeInfo(info);
+    }
+    return 1;
+}
+
+/* NCHW or NHWC shape for a batch of the model input */
+static void input_shape_for(onnx_model_t* model, int batch, int64_t shape[4]) {
+    shape[0] = batch;
+    if (model->is_nhwc) {
+        shape[1] = model->input_h;
+        shape[2] = model->input_w;
+        shape[3] = model->input_c;
+    } else {
+        shape[1] = model->input_c;
+        shape[2] = model->input_h;
+        shape[3] = model->input_w;
+    }
+}
+
+/* Bytes per input tensor element */
+static size_t input_elem_size(const onnx_model_t* model) {
+    return model->input_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 ? sizeof(uint16_t)
+                                                                      : sizeof(float);
+}
+
+/**
+ * Allocate the single-image path once and bind it to the session.
+ *
+ * The input tensor wraps model->input_buf, which the preprocessing plan
+ * fills directly in the model's element type. Outputs with a
+ * fully known shape (a dynamic batch dim counts as 1) get their own
+ * buffers bound in place, so RunWithBinding writes straight into them. An
+ * output with other dynamic dims is bound to the CPU allocator instead and
+ * allocated by ORT on each run.
+ */
+static int prepare_buffers(onnx_model_t* model, int letterbox) {
+    size_t item_size = (size_t)model->input_c * model->input_h * model->input_w;
+    int fp16_input = model->input_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+
+    if (model->input_c != 3) {
+        fprintf(stderr, "ONNX: only 3-channel inputs supported (model has %d)\n", model->input_c);
+        return CIRA_ERROR_MODEL;
+    }
+
+    int prep = preprocess_init(&model->plan, model->input_w, model->input_h,
+                               model->is_nhwc ? PREPROCESS_NHWC : PREPROCESS_NCHW,
+                               fp16_input, letterbox);
+    if (prep != CIRA_OK) return prep;
+
+    model->input_buf = malloc(item_size * input_elem_size(model));
+    model->det_buf = (yolo_detection_t*)malloc(ONNX_MAX_CANDIDATES * sizeof(yolo_detection_t));
+    if (!model->input_buf || !model->det_buf) {
+        return CIRA_ERROR_MEMORY;
+    }
+
+    int64_t shape[4];
+    input_shape_for(model, 1, shape);
+    OrtStatus* status = g_ort->CreateTensorWithDataAsOrtValue(model->memory_info,
+        model->input_buf, item_size * input_elem_size(model), shape, 4,
+        model->input_type, &model->input_value);
+    if (!ort_ok(status, "CreateTensorWithDataAsOrtValue(input)") ||
+        !ort_ok(g_ort->CreateIoBinding(model->session, &model->binding), "CreateIoBinding") ||
+        !ort_ok(g_ort->BindInput(model->binding, model->input_name, model->input_value), "BindInput")) {
+        return CIRA_ERROR;
+    }
+
+    model->outputs_bound = 1;
+    size_t convert_elements = 0;
+
+    for (size_t i = 0; i < model->num_outputs; i++) {
+        onnx_output_t* out = &model->output_info[i];
+        memset(out, 0, sizeof(*out));
+        out->type = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+
+        int fixed = 0;
+        OrtTypeInfo* type_info = NULL;
+        if (ort_ok(g_ort->SessionGetOutputTypeInfo(model->session, i, &type_info), "SessionGetOutputTypeInfo")) {
+            const OrtTensorTypeAndShapeInfo* tensor_info = NULL;
+            ORT_IGNORE(g_ort->CastTypeInfoToTensorInfo(type_info, &tensor_info));
+            if (tensor_info) {
+                ORT_IGNORE(g_ort->GetDimensionsCount(tensor_info, &out->num_dims));
+                ORT_IGNORE(g_ort->GetTensorElementType(tensor_info, &out->type));
+                if (out->num_dims > 0 && out->num_dims <= 6) {
+                    ORT_IGNORE(g_ort->GetDimensions(tensor_info, out->shape, out->num_dims));
+                    fixed = out->type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT ||
+                            out->type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+                    out->elements = 1;
+                    for (size_t d = 0; d < out->num_dims; d++) {
+                        if (d == 0 && out->shape[0] <= 0) out->shape[0] = 1;
+                        if (out->shape[d] <= 0) fixed = 0;
+                        out->elements *= (size_t)(out->shape[d] > 0 ? out->shape[d] : 1);
+                    }
+                }
+            }
+            g_ort->ReleaseTypeInfo(type_info);
+        }
+
+        if (fixed) {
+            int fp16 = out->type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+            size_t bytes = out->elements * (fp16 ? sizeof(uint16_t) : sizeof(float));
+            out->data = malloc(bytes);
+            if (!out->data) return CIRA_ERROR_MEMORY;
+            if (!ort_ok(g_ort->CreateTensorWithDataAsOrtValue(model->memory_info, out->data, bytes,
+                            out->shape, out->num_dims, out->type, &model->output_values[i]),
+                        "CreateTensorWithDataAsOrtValue(output)") ||
+                !ort_ok(g_ort->BindOutput(model->binding, model->output_names[i],
+                                          model->output_values[i]), "BindOutput")) {
+                return CIRA_ERROR;
+            }
+            if (fp16 && out->elements > convert_elements) convert_elements = out->elements;
+        } else {
+            if (!ort_ok(g_ort->BindOutputToDevice(model->binding, model->output_names[i],
+                                                  model->memory_info), "BindOutputToDevice")) {
+                return CIRA_ERROR;
+            }
+            model->outputs_bound = 0;
+        }
+    }
+
+    if (convert_elements > 0) {
+        model->convert_buf = (float*)malloc(convert_elements * sizeof(float));
+        if (!model->convert_buf) return CIRA_ERROR_MEMORY;
+        model->convert_capacity = convert_elements * sizeof(float);
+    }
+
+    fprintf(stderr, "  Outputs bound: %s\n",
+            model->outputs_bound ? "preallocated (zero-allocation predict)"
+                                 : "dynamic shape (ORT allocates outputs per run)");
+    return CIRA_OK;
+}
+
+/* Free everything prepare_buffers() allocated */
+static void free_buffers(onnx_model_t* model) {
+    if (model->binding) g_ort->ReleaseIoBinding(model->binding);
+    if (model->input_value) g_ort->ReleaseValue(model->input_value);
+    for (size_t i = 0; i < 4; i++) {
+        if (model->output_values[i]) g_ort->ReleaseValue(model->output_values[i]);
+        free(model->output_info[i].data);
+    }
+    preprocess_free(&model->plan);
+    free(model->input_buf);
+    free(model->det_buf);
+    free(model->convert_buf);
+    free(model->batch_buf);
+}
+
+void onnx_unload(cira_ctx* ctx);
+
+/* CPU architecture, for the model cache key */
+#if defined(__x86_64__) || defined(_M_X64)
+#define ONNX_CPU_ARCH "x86_64"
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ONNX_CPU_ARCH "aarch64"
+#elif defined(__arm__)
+#define ONNX_CPU_ARCH "arm"
+#else
+#define ONNX_CPU_ARCH "other"
+#endif
+
+/**
+ * Open a session on a cached optimized graph (ORT format). The graph is
+ * already optimized, so the session skips graph optimization, and its
+ * initializers point into the mapping instead of being copied. A cache
+ * entry ORT cannot open (e.g. written by another ORT version) is removed.
+ *
+ * @return 1 if model->session was created
+ */
+static int session_from_cache(onnx_model_t* model, const char* cache_path) {
+    if (model_file_map(cache_path, &model->cached_graph) != 0) return 0;
+
+    OrtSessionOptions* options = NULL;
+    int ok = ort_ok(g_ort->CloneSessionOptions(model->session_options, &options),
+                    "CloneSessionOptions");
+    if (ok) {
+        ORT_IGNORE(g_ort->SetSessionGraphOptimizationLevel(options, ORT_DISABLE_ALL));
+        ORT_IGNORE(g_ort->AddSessionConfigEntry(options, "session.load_model_format", "ORT"));
+        ORT_IGNORE(g_ort->AddSessionConfigEntry(options, "session.use_ort_model_bytes_directly", "1"));
+        ORT_IGNORE(g_ort->AddSessionConfigEntry(options, "session.use_ort_model_bytes_for_initializers", "1"));
+        ok = ort_ok(g_ort->CreateSessionFromArray(model->env, model->cached_graph.data,
+                                                  model->cached_graph.size, options,
+                                                  &model->session),
+                    "session from cached graph");
+        g_ort->ReleaseSessionOptions(options);
+    }
+
+    if (!ok) {
+        model_file_unmap(&model->cached_graph);
+        remove(cache_path);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Open a session on a mapped .onnx file, saving the optimized graph to
+ * cache_path (if not NULL) for the next load. The cache file is written
+ * under a temporary name and renamed, so a crash mid-write leaves no
+ * truncated entry.
+ *
+ * @return 1 if model->session was created
+ */
+static int session_from_model(onnx_model_t* model, const model_file_t* source,
+                              const char* cache_path) {
+#ifndef _WIN32
+    if (cache_path) {
+        char tmp_path[1100];
+        snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", cache_path, (long)getpid());
+
+        OrtSessionOptions* options = NULL;
+        if (ort_ok(g_ort->CloneSessionOptions(model->session_options, &options),
+                   "CloneSessionOptions")) {
+            ORT_IGNORE(g_ort->SetOptimizedModelFilePath(options, tmp_path));
+            ORT_IGNORE(g_ort->AddSessionConfigEntry(options, "session.save_model_format", "ORT"));
+            int ok = ort_ok(g_ort->CreateSessionFromArray(model->env, source->data, source->size,
+                                                          options, &model->session),
+                            "session from model (saving optimized graph)");
+            g_ort->ReleaseSessionOptions(options);
+
+            if (ok) {
+                if (rename(tmp_path, cache_path) == 0) {
+                    fprintf(stderr, "ONNX: optimized graph cached at %s\n", cache_path);
+                } else {
+                    remove(tmp_path);
+                }
+                return 1;
+            }
+            remove(tmp_path);
+        }
+        /* Cache not writable, say: load without saving */
+    }
+#else
+    (void)cache_path;
+#endif
+
+    return ort_ok(g_ort->CreateSessionFromArray(model->env, source->data, source->size,
+                                                model->session_options, &model->session),
+                  "session from model");
+}
+
+/**
+ * Open a session by path, for models that only load that way (external
+ * initializers next to the .onnx).
+ *
+ * @return 1 if model->session was created
+ */
+static int session_from_path(onnx_model_t* model, const char* path) {
+#ifdef _WIN32
+    /* Windows needs wide string path */
+    wchar_t wide_path[1024];
+    size_t converted = 0;
+    mbstowcs_s(&converted, wide_path, sizeof(wide_path)/sizeof(wchar_t), path, _TRUNCATE);
+    return ort_ok(g_ort->CreateSession(model->env, wide_path, model->session_options,
+                                       &model->session),
+                  "session from path");
+#else
+    return ort_ok(g_ort->CreateSession(model->env, path, model->session_options,
+                                       &model->session),
+                  "session from path");
+#endif
+}
+
+/* ONNX Runtime's names of the providers, in onnx_ep_t order */
+static const char* const ORT_PROVIDER_NAMES[ONNX_EP_COUNT] = {
+    "CPUExecutionProvider", "CUDAExecutionProvider", "TensorrtExecutionProvider",
+    "OpenVINOExecutionProvider", "XnnpackExecutionProvider"
+};
+
+/* 1 if this ONNX Runtime build has the provider (or cannot tell) */
+static int provider_built_in(onnx_ep_t ep) {
+    char** names = NULL;
+    int count = 0;
+    if (ep == ONNX_EP_CPU) return 1;
+    if (!ort_ok(g_ort->GetAvailableProviders(&names, &count), "GetAvailableProviders")) return 1;
+
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(names[i], ORT_PROVIDER_NAMES[ep]) == 0) found = 1;
+    }
+    ORT_IGNORE(g_ort->ReleaseAvailableProviders(names, count));
+    return found;
+}
+
+/**
+ * Append a provider and its options to options. TensorRT builds engines
+ * into trt_cache_dir (if not NULL) unless the spec sets
+ * trt_engine_cache_enable; XNNPACK gets a thread per inference CPU
+ * unless the spec sets intra_op_num_threads.
+ *
+ * @return 1 if appended (cpu needs no appending)
+ */
+static int append_provider(OrtSessionOptions* options, const onnx_provider_t* p,
+                           const char* trt_cache_dir, int threads) {
+    const char* keys[ONNX_PROVIDER_MAX_OPTIONS + 2];
+    const char* values[ONNX_PROVIDER_MAX_OPTIONS + 2];
+    char thread_count[16];
+    size_t n = 0;
+    int ok = 0;
+
+    for (int i = 0; i < p->num_options; i++) {
+        keys[n] = p->keys[i];
+        values[n++] = p->values[i];
+    }
+
+    switch (p->ep) {
+    case ONNX_EP_CPU:
+        ok = 1;
+        break;
+
+    case ONNX_EP_CUDA: {
+        OrtCUDAProviderOptionsV2* cuda = NULL;
+        ok = ort_ok(g_ort->CreateCUDAProviderOptions(&cuda), "CreateCUDAProviderOptions") &&
+             ort_ok(g_ort->UpdateCUDAProviderOptions(cuda, keys, values, n), "cuda options") &&
+             ort_ok(g_ort->SessionOptionsAppendExecutionProvider_CUDA_V2(options, cuda),
+                    "append cuda");
+        if (cuda) g_ort->ReleaseCUDAProviderOptions(cuda);
+        break;
+    }
+
+    case ONNX_EP_TENSORRT: {
+        /* Engine builds take minutes on a Jetson: keep them */
+        if (trt_cache_dir && !onnx_provider_option(p, "trt_engine_cache_enable")) {
+            keys[n] = "trt_engine_cache_enable";
+            values[n++] = "1";
+            if (!onnx_provider_option(p, "trt_engine_cache_path")) {
+                keys[n] = "trt_engine_cache_path";
+                values[n++] = trt_cache_dir;
+            }
+        }
+        OrtTensorRTProviderOptionsV2* trt = NULL;
+        ok = ort_ok(g_ort->CreateTensorRTProviderOptions(&trt), "CreateTensorRTProviderOptions") &&
+             ort_ok(g_ort->UpdateTensorRTProviderOptions(trt, keys, values, n), "tensorrt options") &&
+             ort_ok(g_ort->SessionOptionsAppendExecutionProvider_TensorRT_V2(options, trt),
+                    "append tensorrt");
+        if (trt) g_ort->ReleaseTensorRTProviderOptions(trt);
+        break;
+    }
+
+    case ONNX_EP_OPENVINO: {
+#if ORT_API_VERSION >= 17
+        ok = ort_ok(g_ort->SessionOptionsAppendExecutionProvider_OpenVINO_V2(options, keys,
+                                                                             values, n),
+                    "append openvino");
+#else
+        /* Older releases take a struct: only its stable fields are set */
+        OrtOpenVINOProviderOptions ov;
+        memset(&ov, 0, sizeof(ov));
+        ov.device_type = onnx_provider_option(p, "device_type");
+        const char* ov_threads = onnx_provider_option(p, "num_of_threads");
+        if (ov_threads) ov.num_of_threads = (size_t)atoi(ov_threads);
+        if (p->num_options > (ov.device_type != NULL) + (ov_threads != NULL)) {
+            fprintf(stderr, "ONNX: this ONNX Runtime passes only device_type and "
+                    "num_of_threads to openvino\n");
+        }
+        ok = ort_ok(g_ort->SessionOptionsAppendExecutionProvider_OpenVINO(options, &ov),
+                    "append openvino");
+#endif
+        break;
+    }
+
+    case ONNX_EP_XNNPACK:
+        if (!onnx_provider_option(p, "intra_op_num_threads")) {
+            snprintf(thread_count, sizeof(thread_count), "%d", threads);
+            keys[n] = "intra_op_num_threads";
+            values[n++] = thread_count;
+        }
+        ok = ort_ok(g_ort->SessionOptionsAppendExecutionProvider(options, "XNNPACK", keys,
+                                                                 values, n),
+                    "append xnnpack");
+        break;
+
+    default:
+        break;
+    }
+    return ok;
+}
+
+/**
+ * Session options for providers[first] onwards: every provider this ONNX
+ * Runtime accepts is appended, in order (ORT gives each node to the first
+ * provider that can run it). The session takes the optimization level,
+ * arena and threading of the first one appended, the provider that runs
+ * the model.
+ *
+ * @param primary Receives the index of that provider
+ * @return Options, NULL if ORT cannot create any
+ */
+static OrtSessionOptions* provider_session_options(cira_ctx* ctx,
+                                                   const onnx_provider_list_t* list,
+                                                   int first, const char* trt_cache_dir,
+                                                   int* primary) {
+    static const GraphOptimizationLevel levels[] = {
+        ORT_DISABLE_ALL, ORT_ENABLE_BASIC, ORT_ENABLE_EXTENDED, ORT_ENABLE_ALL
+    };
+
+    OrtSessionOptions* options = NULL;
+    if (!ort_ok(g_ort->CreateSessionOptions(&options), "CreateSessionOptions")) return NULL;
+
+    /* One intra-op thread per inference CPU when cpu.* pins inference (the
+     * pool is created on this thread, pinned by cira_load, and inherits
+     * its CPUs), else ORT's default of one per core */
+    int inference_cpus = cpu_mask_count(ctx->cpu_masks[CPU_CLASS_INFERENCE]);
+
+    *primary = list->count - 1;
+    for (int i = first; i < list->count; i++) {
+        const onnx_provider_t* p = &list->providers[i];
+        int threads = inference_cpus ? inference_cpus : cpu_topology()->num_cpus;
+        if (!provider_built_in(p->ep)) {
+            fprintf(stderr, "ONNX: %s provider not in this ONNX Runtime build, skipped\n",
+                    onnx_provider_name(p->ep));
+            continue;
+        }
+        if (!append_provider(options, p, trt_cache_dir, threads)) {
+            fprintf(stderr, "ONNX: %s provider unavailable, skipped\n", onnx_provider_name(p->ep));
+            continue;
+        }
+        if (i < *primary) *primary = i;
+    }
+
+    /* Ignore returns - non-critical. Extended level (the default) is also
+     * what fuses the QuantizeLinear/DequantizeLinear pairs of an int8 QDQ
+     * model into quantized kernels. */
+    const onnx_provider_t* p = &list->providers[*primary];
+    ORT_IGNORE(g_ort->SetSessionGraphOptimizationLevel(options, levels[p->opt_level]));
+    if (p->arena) {
+        ORT_IGNORE(g_ort->EnableCpuMemArena(options));
+    } else {
+        ORT_IGNORE(g_ort->DisableCpuMemArena(options));
+    }
+
+    /* XNNPACK runs its own pool: ORT's would only spin against it. Nodes
+     * run sequentially, so the inter-op pool would only idle. */
+    if (p->ep == ONNX_EP_XNNPACK) {
+        ORT_IGNORE(g_ort->SetIntraOpNumThreads(options, 1));
+        ORT_IGNORE(g_ort->AddSessionConfigEntry(options, "session.intra_op.allow_spinning", "0"));
+    } else {
+        ORT_IGNORE(g_ort->SetIntraOpNumThreads(options, inference_cpus));
+    }
+    ORT_IGNORE(g_ort->SetInterOpNumThreads(options, 1));
+    return options;
+}
+
 /**
  * Initialize ONNX Runtime (call once)
  */
@@ -197,6 +663,7 @@ int onnx_load(cira_ctx* ctx, const char* model_path) {
         cira_set_error(ctx, "Failed to allocate ONNX model structure");
         return CIRA_ERROR_MEMORY;
     }
+    model->batch_size = 1;
 
     OrtStatus* status = NULL;
 
@@ -210,45 +677,90 @@ int onnx_load(cira_ctx* ctx, const char* model_path) {
         return CIRA_ERROR;
     }
 
-    /* Create session options */
-    status = g_ort->CreateSessionOptions(&model->session_options);
-    if (status != NULL) {
-        fprintf(stderr, "Failed to create session options: %s\n",
-                g_ort->GetErrorMessage(status));
-        g_ort->ReleaseStatus(status);
-        g_ort->ReleaseEnv(model->env);
-        free(model);
-        return CIRA_ERROR;
+    /* Providers: the onnx.providers option, else the manifest's, else
+     * cpu. Both were validated when set. */
+    const char* spec = ctx->onnx_providers[0] ? ctx->onnx_providers : ctx->model_providers;
+    onnx_provider_list_t providers;
+    if (onnx_providers_parse(spec, &providers, NULL, 0) != 0) {
+        onnx_providers_parse("", &providers, NULL, 0);
     }
 
-    /* Set optimization level (ignore return - non-critical) */
-    ORT_IGNORE(g_ort->SetSessionGraphOptimizationLevel(model->session_options,
-                                                        ORT_ENABLE_EXTENDED));
+    double t_session = cira_time_ms();
+    model_file_t source;
+    int mapped = model_file_map(actual_path, &source) == 0;
+
+    /* TensorRT engines live in the model cache too */
+    char trt_cache_dir[1024];
+    int trt_cached = 0;
+    for (int i = 0; mapped && i < providers.count; i++) {
+        if (providers.providers[i].ep != ONNX_EP_TENSORRT) continue;
+        char hw_tag[128];
+        snprintf(hw_tag, sizeof(hw_tag), "onnx:%s:%s:tensorrt",
+                 OrtGetApiBase()->GetVersionString(), ONNX_CPU_ARCH);
+        trt_cached = model_cache_path(ctx->model_cache_dir, model_file_hash(&source), hw_tag,
+                                      ".trt", trt_cache_dir, sizeof(trt_cache_dir));
+    }
 
-    /* Set number of threads (ignore return - non-critical) */
-    ORT_IGNORE(g_ort->SetIntraOpNumThreads(model->session_options, 0));
+    /* Try the list from the top; a provider that appends but cannot build
+     * a session for this model (unsupported ops, out of device memory)
+     * hands over to the ones after it */
+    int from_cache = 0;
+    onnx_ep_t ep = ONNX_EP_CPU;
+    for (int first = 0; first < providers.count; first++) {
+        int primary = 0;
+        model->session_options = provider_session_options(ctx, &providers, first,
+                                                          trt_cached ? trt_cache_dir : NULL,
+                                                          &primary);
+        if (!model->session_options) break;
+        ep = providers.providers[primary].ep;
+
+        /* CPU sessions open from the cached optimized graph when there is
+         * one, else from the mapped model (caching its optimized graph).
+         * The other providers compile their part of the graph for the
+         * device when the session is created, which an ORT-format graph
+         * cannot hold, so they open the model itself. Models that only
+         * load by path fall back to CreateSession. */
+        if (mapped && ep == ONNX_EP_CPU) {
+            char hw_tag[128];
+            char cache_path[1024];
+            snprintf(hw_tag, sizeof(hw_tag), "onnx:%s:%s:cpu:%s",
+                     OrtGetApiBase()->GetVersionString(), ONNX_CPU_ARCH,
+                     onnx_opt_level_name(providers.providers[primary].opt_level));
+            int cached = model_cache_path(ctx->model_cache_dir, model_file_hash(&source), hw_tag,
+                                          ".ort", cache_path, sizeof(cache_path));
+
+            from_cache = cached && session_from_cache(model, cache_path);
+            if (!from_cache) {
+                session_from_model(model, &source, cached ? cache_path : NULL);
+            }
+        } else if (mapped) {
+            session_from_model(model, &source, NULL);
+        }
+        if (!model->session) {
+            session_from_path(model, actual_path);
+        }
+        if (model->session) break;
 
-    /* Create session */
-#ifdef _WIN32
-    /* Windows needs wide string path */
-    wchar_t wide_path[1024];
-    size_t converted = 0;
-    mbstowcs_s(&converted, wide_path, sizeof(wide_path)/sizeof(wchar_t), actual_path, _TRUNCATE);
-    status = g_ort->CreateSession(model->env, wide_path,
-                                   model->session_options, &model->session);
-#else
-    status = g_ort->CreateSession(model->env, actual_path,
-                                   model->session_options, &model->session);
-#endif
-    if (status != NULL) {
-        fprintf(stderr, "Failed to create ONNX session: %s\n",
-                g_ort->GetErrorMessage(status));
-        g_ort->ReleaseStatus(status);
         g_ort->ReleaseSessionOptions(model->session_options);
+        model->session_options = NULL;
+        if (ep == ONNX_EP_CPU) break;
+        fprintf(stderr, "ONNX: no session on %s, trying the next provider\n",
+                onnx_provider_name(ep));
+        first = primary;
+    }
+    if (mapped) model_file_unmap(&source);
+
+    if (!model->session) {
+        fprintf(stderr, "Failed to create ONNX session\n");
+        if (model->session_options) g_ort->ReleaseSessionOptions(model->session_options);
         g_ort->ReleaseEnv(model->env);
         free(model);
         return CIRA_ERROR_MODEL;
     }
+    snprintf(ctx->execution_provider, sizeof(ctx->execution_provider), "%s",
+             onnx_provider_name(ep));
+    fprintf(stderr, "ONNX: session ready on %s in %.0f ms%s\n", ctx->execution_provider,
+            cira_time_ms() - t_session, from_cache ? " (cached graph)" : "");
 
     /* Create memory info for CPU */
     status = g_ort->CreateCpuMemoryInfo(OrtArenaAllocator, OrtMemTypeDefault,
@@ -258,6 +770,7 @@ int onnx_load(cira_ctx* ctx, const char* model_path) {
                 g_ort->GetErrorMessage(status));
         g_ort->ReleaseStatus(status);
         g_ort->ReleaseSession(model->session);
+        model_file_unmap(&model->cached_graph);
         g_ort->ReleaseSessionOptions(model->session_options);
         g_ort->ReleaseEnv(model->env);
         free(model);
@@ -300,6 +813,9 @@ int onnx_load(cira_ctx* ctx, const char* model_path) {
             /* Handle dynamic batch dimension (-1) */
             if (model->input_shape[0] <= 0) {
                 model->input_shape[0] = 1;
+                model->batch_size = 0;
+            } else {
+                model->batch_size = (int)model->input_shape[0];
             }
 
             /* Detect NHWC vs NCHW format:
@@ -335,6 +851,17 @@ int onnx_load(cira_ctx* ctx, const char* model_path) {
         g_ort->ReleaseTypeInfo(input_type_info);
     }
 
+    /* Quantized models keep a float input (QDQ); the preprocessor writes
+     * float32 or float16 only */
+    if (model->input_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT &&
+        model->input_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+        cira_set_error(ctx, "ONNX input must be float32 or float16 (got element type %d)",
+                       (int)model->input_type);
+        ctx->model_handle = model;
+        onnx_unload(ctx);
+        return CIRA_ERROR_MODEL;
+    }
+
     /* Check number of outputs */
     ORT_IGNORE(g_ort->SessionGetOutputCount(model->session, &model->num_outputs));
     if (model->num_outputs > 4) model->num_outputs = 4;  /* Limit to 4 */
@@ -374,6 +901,11 @@ int onnx_load(cira_ctx* ctx, const char* model_path) {
         }
         fprintf(stderr, "]\n");
 
+        /* A dynamic input batch only helps if the outputs follow it */
+        if (model->batch_size == 0 && model->output_dims > 0 && out_shape[0] > 0) {
+            model->batch_size = (int)out_shape[0];
+        }
+
         /* Try to infer num_classes from output shape */
         if (model->output_dims == 3 && out_shape[2] > 6) {
             /* Format C: [1, N, 5+num_classes] */
@@ -390,11 +922,28 @@ int onnx_load(cira_ctx* ctx, const char* model_path) {
         model->num_classes = 80;  /* Default to COCO classes */
     }
 
+    /* Allocate and bind the predict-path buffers once */
+    int prep = prepare_buffers(model, ctx->letterbox == 1);
+    if (prep != CIRA_OK) {
+        cira_set_error(ctx, "Failed to prepare ONNX inference buffers");
+        ctx->model_handle = model;
+        onnx_unload(ctx);
+        return prep;
+    }
+
     fprintf(stderr, "ONNX model loaded successfully\n");
     fprintf(stderr, "  Input: %s (%dx%d)\n", model->input_name,
             model->input_w, model->input_h);
     fprintf(stderr, "  Outputs: %zu\n", model->num_outputs);
+    if (model->batch_size > 0) {
+        fprintf(stderr, "  Batch: %d (fixed)\n", model->batch_size);
+    } else {
+        fprintf(stderr, "  Batch: dynamic\n");
+    }
     fprintf(stderr, "  Classes: %d\n", model->num_classes);
+    fprintf(stderr, "  Provider: %s\n", ctx->execution_provider);
+    fprintf(stderr, "  Precision: %s (%s input)\n", cira_precision_name(ctx->precision),
+            model->input_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 ? "float16" : "float32");
 
     /* Store model in context */
     ctx->model_handle = model;
@@ -413,6 +962,9 @@ void onnx_unload(cira_ctx* ctx) {
 
     onnx_model_t* model = (onnx_model_t*)ctx->model_handle;
 
+    /* Binding and bound tensors go before the session they belong to */
+    free_buffers(model);
+
     /* Free allocated names using default allocator */
     OrtAllocator* allocator = NULL;
     ORT_IGNORE(g_ort->GetAllocatorWithDefaultOptions(&allocator));
@@ -427,6 +979,7 @@ void onnx_unload(cira_ctx* ctx) {
     }
     if (model->memory_info) g_ort->ReleaseMemoryInfo(model->memory_info);
     if (model->session) g_ort->ReleaseSession(model->session);
+    model_file_unmap(&model->cached_graph);
     if (model->session_options) g_ort->ReleaseSessionOptions(model->session_options);
     if (model->env) g_ort->ReleaseEnv(model->env);
 
@@ -436,171 +989,75 @@ void onnx_unload(cira_ctx* ctx) {
     fprintf(stderr, "ONNX model unloaded\n");
 }
 
-/**
- * Run ONNX inference on an image.
- *
- * @param ctx Context with loaded ONNX model
- * @param data RGB image data (packed HWC, row-major)
- * @param w Image width
- * @param h Image height
- * @param channels Number of channels (must be 3)
- * @return CIRA_OK on success
- */
-int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
-    if (!ctx || !ctx->model_handle || !data) {
-        cira_set_error(ctx, "Invalid parameters to onnx_predict");
-        return CIRA_ERROR_INPUT;
-    }
-
-    if (channels != 3) {
-        cira_set_error(ctx, "Only 3-channel RGB images supported");
-        return CIRA_ERROR_INPUT;
-    }
-
-    onnx_model_t* model = (onnx_model_t*)ctx->model_handle;
-
-    /* Clear previous detections */
-    cira_clear_detections(ctx);
-
-    OrtStatus* status = NULL;
-
-    /* Step 1: Resize image to model input size */
-    int input_size = model->input_w * model->input_h * channels;
-    uint8_t* resized = (uint8_t*)malloc(input_size);
-    if (!resized) {
-        cira_set_error(ctx, "Failed to allocate resize buffer");
-        return CIRA_ERROR_MEMORY;
-    }
-
-    if (w == model->input_w && h == model->input_h) {
-        memcpy(resized, data, input_size);
-    } else {
-        bilinear_resize(data, w, h, resized, model->input_w, model->input_h, channels);
-    }
+/* Print output layout hints (first frame of the single-image path only) */
+static void debug_output(size_t out_idx, const float* output_data, const int64_t* output_shape,
+                         size_t num_dims, ONNXTensorElementDataType output_type) {
+    const char* type_name = "float32";
+    if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) type_name = "float16";
+    else if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE) type_name = "float64";
 
-    /* Step 2: Convert to float32 and normalize to 0-1 */
-    /* Handle both NCHW (PyTorch style) and NHWC (TensorFlow style) formats */
-    size_t tensor_size = 1 * model->input_c * model->input_h * model->input_w;
-    float* input_tensor_data = (float*)malloc(tensor_size * sizeof(float));
-    if (!input_tensor_data) {
-        free(resized);
-        cira_set_error(ctx, "Failed to allocate input tensor");
-        return CIRA_ERROR_MEMORY;
+    fprintf(stderr, "ONNX output[%zu]: dims=%zu, type=%s, shape=[", out_idx, num_dims, type_name);
+    for (size_t i = 0; i < num_dims && i < 6; i++) {
+        fprintf(stderr, "%lld%s", (long long)output_shape[i], i < num_dims - 1 ? ", " : "");
     }
-
-    if (model->is_nhwc) {
-        /* NHWC format: keep HWC layout, just normalize */
-        for (int y = 0; y < model->input_h; y++) {
-            for (int x = 0; x < model->input_w; x++) {
-                for (int c = 0; c < model->input_c; c++) {
-                    int idx = (y * model->input_w + x) * channels + c;
-                    input_tensor_data[idx] = resized[idx] / 255.0f;
-                }
+    fprintf(stderr, "]\n");
+
+    /* Debug: print first few raw values to verify data access */
+    if (num_dims == 3 && output_shape[1] > 0 && output_shape[2] > 0) {
+        int dim1 = (int)output_shape[1];
+        int dim2 = (int)output_shape[2];
+
+        /* Check if data looks transposed by reading both ways */
+        fprintf(stderr, "  If [1,%d,%d] (row-major, box=row): ", dim1, dim2);
+        fprintf(stderr, "box[0] = [%.2f, %.2f, %.2f, %.2f, obj=%.4f]\n",
+                output_data[0], output_data[1], output_data[2], output_data[3], output_data[4]);
+
+        fprintf(stderr, "  If [1,%d,%d] (transposed, box=col): ", dim1, dim2);
+        fprintf(stderr, "box[0] = [%.2f, %.2f, %.2f, %.2f, obj=%.4f]\n",
+                output_data[0 * dim1 + 0], output_data[1 * dim1 + 0],
+                output_data[2 * dim1 + 0], output_data[3 * dim1 + 0],
+                output_data[4 * dim1 + 0]);
+
+        /* Sample more boxes to find non-zero objectness */
+        fprintf(stderr, "  Searching for non-zero obj values...\n");
+        int found_count = 0;
+        for (int i = 0; i < dim1 && found_count < 5; i++) {
+            float obj_rowmajor = output_data[i * dim2 + 4];
+            if (obj_rowmajor != 0.0f) {
+                fprintf(stderr, "    box[%d] row-major obj=%.4f\n", i, obj_rowmajor);
+                found_count++;
             }
         }
-    } else {
-        /* NCHW format: convert HWC -> CHW */
-        for (int c = 0; c < model->input_c; c++) {
-            for (int y = 0; y < model->input_h; y++) {
-                for (int x = 0; x < model->input_w; x++) {
-                    int src_idx = (y * model->input_w + x) * channels + c;
-                    int dst_idx = c * model->input_h * model->input_w + y * model->input_w + x;
-                    input_tensor_data[dst_idx] = resized[src_idx] / 255.0f;
+        if (found_count == 0) {
+            fprintf(stderr, "    No non-zero obj in row-major format, trying transposed...\n");
+            for (int i = 0; i < dim2 && found_count < 5; i++) {
+                float obj_transposed = output_data[4 * dim2 + i];
+                if (obj_transposed != 0.0f) {
+                    fprintf(stderr, "    box[%d] transposed obj=%.4f\n", i, obj_transposed);
+                    found_count++;
                 }
             }
         }
     }
+}
 
-    free(resized);
-
-    /* Step 3: Create input tensor with correct shape and type */
-    int64_t input_shape[4];
-    if (model->is_nhwc) {
-        input_shape[0] = 1;
-        input_shape[1] = model->input_h;
-        input_shape[2] = model->input_w;
-        input_shape[3] = model->input_c;
-    } else {
-        input_shape[0] = 1;
-        input_shape[1] = model->input_c;
-        input_shape[2] = model->input_h;
-        input_shape[3] = model->input_w;
-    }
-    OrtValue* input_tensor = NULL;
-    void* tensor_data_to_free = input_tensor_data;
-
-    /* Convert to float16 if model expects it */
-    if (model->input_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
-        uint16_t* fp16_data = (uint16_t*)malloc(tensor_size * sizeof(uint16_t));
-        if (!fp16_data) {
-            free(input_tensor_data);
-            cira_set_error(ctx, "Failed to allocate float16 buffer");
-            return CIRA_ERROR_MEMORY;
-        }
-        for (size_t i = 0; i < tensor_size; i++) {
-            fp16_data[i] = float_to_half(input_tensor_data[i]);
-        }
-        free(input_tensor_data);
-        tensor_data_to_free = fp16_data;
-
-        status = g_ort->CreateTensorWithDataAsOrtValue(
-            model->memory_info,
-            fp16_data, tensor_size * sizeof(uint16_t),
-            input_shape, 4,
-            ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16,
-            &input_tensor);
-    } else {
-        status = g_ort->CreateTensorWithDataAsOrtValue(
-            model->memory_info,
-            input_tensor_data, tensor_size * sizeof(float),
-            input_shape, 4,
-            ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT,
-            &input_tensor);
-    }
-
-    if (status != NULL) {
-        fprintf(stderr, "Failed to create input tensor: %s\n",
-                g_ort->GetErrorMessage(status));
-        g_ort->ReleaseStatus(status);
-        free(tensor_data_to_free);
-        return CIRA_ERROR;
-    }
-
-    /* Step 4: Run inference with all outputs */
-    const char* input_names[] = { model->input_name };
-    const char* out_names[4];
-    for (size_t i = 0; i < model->num_outputs && i < 4; i++) {
-        out_names[i] = model->output_names[i];
-    }
-
-    OrtValue* output_tensors[4] = {NULL, NULL, NULL, NULL};
-
-    status = g_ort->Run(model->session, NULL,
-                        input_names, (const OrtValue* const*)&input_tensor, 1,
-                        out_names, model->num_outputs, output_tensors);
-
-    g_ort->ReleaseValue(input_tensor);
-    free(tensor_data_to_free);
-
-    if (status != NULL) {
-        fprintf(stderr, "ONNX inference failed: %s\n",
-                g_ort->GetErrorMessage(status));
-        g_ort->ReleaseStatus(status);
-        return CIRA_ERROR;
-    }
+/**
+ * Decode batch item `item` of a run's outputs into ctx->detections.
+ * Each output is sliced along its batch dimension and decoded as [1, ...].
+ *
+ * @param outputs Output tensors of the run
+ * @param batch   Batch size the session was run with
+ * @param verbose Print per-output debug information
+ * @return CIRA_OK on success
+ */
+static int decode_outputs(cira_ctx* ctx, onnx_model_t* model, const onnx_output_t* outputs,
+                          int item, int batch, int verbose) {
+    cira_clear_detections(ctx);
 
-    /* Step 5: Process all output tensors using unified YOLO decoder */
-    int max_dets_buffer = CIRA_MAX_DETECTIONS * 4;  /* Pre-NMS buffer */
-    yolo_detection_t* detections = (yolo_detection_t*)malloc(max_dets_buffer * sizeof(yolo_detection_t));
+    yolo_detection_t* detections = model->det_buf;
+    const preprocess_geom_t* geom = &model->plan.geom;
     int total_detections = 0;
 
-    if (!detections) {
-        for (size_t i = 0; i < model->num_outputs; i++) {
-            if (output_tensors[i]) g_ort->ReleaseValue(output_tensors[i]);
-        }
-        return CIRA_ERROR_MEMORY;
-    }
-
     /* Setup decoder config */
     yolo_decode_config_t decode_config;
     decode_config.version = ctx->yolo_version;
@@ -610,190 +1067,94 @@ int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels)
     decode_config.conf_threshold = ctx->confidence_threshold;
     decode_config.nms_threshold = ctx->nms_threshold;
     decode_config.max_detections = CIRA_MAX_DETECTIONS;
+    decode_config.verbose = verbose;
 
-    fprintf(stderr, "YOLO decoder: version=%s, input=%dx%d, classes=%d\n",
-            yolo_version_name(decode_config.version),
-            decode_config.input_w, decode_config.input_h, decode_config.num_classes);
+    if (verbose) {
+        fprintf(stderr, "YOLO decoder: version=%s, input=%dx%d, classes=%d\n",
+                yolo_version_name(decode_config.version),
+                decode_config.input_w, decode_config.input_h, decode_config.num_classes);
+    }
 
     /* Process each output scale */
     for (size_t out_idx = 0; out_idx < model->num_outputs; out_idx++) {
-        if (!output_tensors[out_idx]) continue;
-
-        void* raw_output_data;
-        status = g_ort->GetTensorMutableData(output_tensors[out_idx], &raw_output_data);
-        if (status != NULL) {
-            g_ort->ReleaseStatus(status);
-            continue;
-        }
-
-        /* Get output shape and type */
-        OrtTensorTypeAndShapeInfo* output_info = NULL;
-        ORT_IGNORE(g_ort->GetTensorTypeAndShape(output_tensors[out_idx], &output_info));
-
-        size_t num_dims = 0;
-        int64_t output_shape[6] = {0};
-        ONNXTensorElementDataType output_type = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
-        size_t total_elements = 0;
-
-        if (output_info) {
-            ORT_IGNORE(g_ort->GetDimensionsCount(output_info, &num_dims));
-            if (num_dims <= 6) {
-                ORT_IGNORE(g_ort->GetDimensions(output_info, output_shape, num_dims));
+        const onnx_output_t* out = &outputs[out_idx];
+        if (!out->data) continue;
+
+        int64_t output_shape[6];
+        memcpy(output_shape, out->shape, sizeof(output_shape));
+        size_t total_elements = out->elements;
+
+        /* Slice out this item: [batch, ...] -> [1, ...] */
+        size_t offset = 0;
+        if (batch > 1) {
+            if (out->num_dims == 0 || output_shape[0] != batch) {
+                cira_set_error(ctx, "ONNX output %zu has batch dim %lld, expected %d",
+                               out_idx, (long long)(out->num_dims ? output_shape[0] : 0), batch);
+                return CIRA_ERROR_MODEL;
             }
-            ORT_IGNORE(g_ort->GetTensorElementType(output_info, &output_type));
-            ORT_IGNORE(g_ort->GetTensorShapeElementCount(output_info, &total_elements));
-            g_ort->ReleaseTensorTypeAndShapeInfo(output_info);
+            total_elements /= (size_t)batch;
+            offset = (size_t)item * total_elements;
+            output_shape[0] = 1;
         }
 
         /* Convert float16 to float32 if needed */
-        float* output_data = NULL;
-        float* converted_buffer = NULL;
-
-        if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
-            fprintf(stderr, "ONNX output is float16, converting to float32...\n");
-            converted_buffer = (float*)malloc(total_elements * sizeof(float));
-            if (converted_buffer) {
-                uint16_t* fp16_data = (uint16_t*)raw_output_data;
-                for (size_t i = 0; i < total_elements; i++) {
-                    /* Convert float16 to float32 */
-                    uint16_t h = fp16_data[i];
-                    uint32_t sign = (h & 0x8000) << 16;
-                    uint32_t exponent = (h >> 10) & 0x1F;
-                    uint32_t mantissa = h & 0x3FF;
-
-                    if (exponent == 0) {
-                        /* Denormalized or zero */
-                        if (mantissa == 0) {
-                            converted_buffer[i] = sign ? -0.0f : 0.0f;
-                        } else {
-                            /* Denormalized - convert to normalized float32 */
-                            exponent = 1;
-                            while ((mantissa & 0x400) == 0) {
-                                mantissa <<= 1;
-                                exponent--;
-                            }
-                            mantissa &= 0x3FF;
-                            uint32_t f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
-                            converted_buffer[i] = *(float*)&f;
-                        }
-                    } else if (exponent == 31) {
-                        /* Inf or NaN */
-                        uint32_t f = sign | 0x7F800000 | (mantissa << 13);
-                        converted_buffer[i] = *(float*)&f;
-                    } else {
-                        /* Normalized */
-                        uint32_t f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
-                        converted_buffer[i] = *(float*)&f;
-                    }
-                }
-                output_data = converted_buffer;
+        const float* output_data;
+        if (out->type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+            if (verbose) fprintf(stderr, "ONNX output is float16, converting to float32...\n");
+            if (!grow_buffer(ctx, (void**)&model->convert_buf, &model->convert_capacity,
+                             total_elements * sizeof(float))) {
+                continue;
             }
+            preprocess_half_to_float((const uint16_t*)out->data + offset, model->convert_buf,
+                                     total_elements);
+            output_data = model->convert_buf;
         } else {
-            output_data = (float*)raw_output_data;
-        }
-
-        if (!output_data) {
-            if (converted_buffer) free(converted_buffer);
-            continue;
-        }
-
-        /* Debug output */
-        const char* type_name = "float32";
-        if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) type_name = "float16";
-        else if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE) type_name = "float64";
-
-        fprintf(stderr, "ONNX output[%zu]: dims=%zu, type=%s, shape=[", out_idx, num_dims, type_name);
-        for (size_t i = 0; i < num_dims && i < 6; i++) {
-            fprintf(stderr, "%lld%s", (long long)output_shape[i], i < num_dims - 1 ? ", " : "");
+            output_data = (const float*)out->data + offset;
         }
-        fprintf(stderr, "]\n");
 
-        /* Debug: print first few raw values to verify data access */
-        if (num_dims == 3 && output_shape[1] > 0 && output_shape[2] > 0) {
-            int dim1 = (int)output_shape[1];
-            int dim2 = (int)output_shape[2];
-
-            /* Check if data looks transposed by reading both ways */
-            fprintf(stderr, "  If [1,%d,%d] (row-major, box=row): ", dim1, dim2);
-            fprintf(stderr, "box[0] = [%.2f, %.2f, %.2f, %.2f, obj=%.4f]\n",
-                    output_data[0], output_data[1], output_data[2], output_data[3], output_data[4]);
-
-            fprintf(stderr, "  If [1,%d,%d] (transposed, box=col): ", dim1, dim2);
-            fprintf(stderr, "box[0] = [%.2f, %.2f, %.2f, %.2f, obj=%.4f]\n",
-                    output_data[0 * dim1 + 0], output_data[1 * dim1 + 0],
-                    output_data[2 * dim1 + 0], output_data[3 * dim1 + 0],
-                    output_data[4 * dim1 + 0]);
-
-            /* Sample more boxes to find non-zero objectness */
-            fprintf(stderr, "  Searching for non-zero obj values...\n");
-            int found_count = 0;
-            for (int i = 0; i < dim1 && found_count < 5; i++) {
-                float obj_rowmajor = output_data[i * dim2 + 4];
-                if (obj_rowmajor != 0.0f) {
-                    fprintf(stderr, "    box[%d] row-major obj=%.4f\n", i, obj_rowmajor);
-                    found_count++;
-                }
-            }
-            if (found_count == 0) {
-                fprintf(stderr, "    No non-zero obj in row-major format, trying transposed...\n");
-                for (int i = 0; i < dim2 && found_count < 5; i++) {
-                    float obj_transposed = output_data[4 * dim2 + i];
-                    if (obj_transposed != 0.0f) {
-                        fprintf(stderr, "    box[%d] transposed obj=%.4f\n", i, obj_transposed);
-                        found_count++;
-                    }
-                }
-            }
+        if (verbose) {
+            debug_output(out_idx, output_data, output_shape, out->num_dims, out->type);
         }
 
         /* Decode this output scale */
-        int space_left = max_dets_buffer - total_detections;
+        int space_left = ONNX_MAX_CANDIDATES - total_detections;
         if (space_left <= 0) break;
 
-        int count = yolo_decode(output_data, output_shape, (int)num_dims,
+        int count = yolo_decode(output_data, output_shape, (int)out->num_dims,
                                &decode_config,
                                detections + total_detections, space_left);
 
         if (count > 0) {
-            fprintf(stderr, "  Scale %zu: %d detections\n", out_idx, count);
+            if (verbose) fprintf(stderr, "  Scale %zu: %d detections\n", out_idx, count);
             total_detections += count;
         }
-
-        /* Free converted buffer if we allocated one */
-        if (converted_buffer) {
-            free(converted_buffer);
-            converted_buffer = NULL;
-        }
-    }
-
-    /* Release all output tensors */
-    for (size_t i = 0; i < model->num_outputs; i++) {
-        if (output_tensors[i]) g_ort->ReleaseValue(output_tensors[i]);
     }
 
-    /* Step 6: Cross-scale NMS (decoder applies per-call NMS, this catches cross-scale overlaps) */
+    /* Cross-scale NMS (decoder applies per-call NMS, this catches cross-scale overlaps) */
     if (ctx->nms_threshold > 0 && total_detections > 1) {
         total_detections = yolo_nms(detections, total_detections, ctx->nms_threshold);
     }
 
-    /* Step 7: Add detections to context (convert to normalized x,y,w,h format) */
-    fprintf(stderr, "ONNX: Converting %d detections (input_w=%d, input_h=%d)\n",
-            total_detections, model->input_w, model->input_h);
+    /* Add detections to context (convert to normalized x,y,w,h format) */
+    if (verbose) {
+        fprintf(stderr, "ONNX: Converting %d detections (input_w=%d, input_h=%d)\n",
+                total_detections, model->input_w, model->input_h);
+    }
 
     for (int i = 0; i < total_detections; i++) {
         /* Debug: show raw pixel coords */
-        if (i < 3) {
+        if (verbose && i < 3) {
             fprintf(stderr, "  Det[%d] raw: x1=%.1f y1=%.1f x2=%.1f y2=%.1f score=%.2f class=%d\n",
                     i, detections[i].x1, detections[i].y1,
                     detections[i].x2, detections[i].y2,
                     detections[i].score, detections[i].class_id);
         }
 
-        /* Normalize pixel coords to 0-1 */
-        float x1 = detections[i].x1 / model->input_w;
-        float y1 = detections[i].y1 / model->input_h;
-        float x2 = detections[i].x2 / model->input_w;
-        float y2 = detections[i].y2 / model->input_h;
+        /* Normalize pixel coords to 0-1 of the source image (undo letterbox) */
+        float x1 = (detections[i].x1 - geom->pad_x) / geom->new_w;
+        float y1 = (detections[i].y1 - geom->pad_y) / geom->new_h;
+        float x2 = (detections[i].x2 - geom->pad_x) / geom->new_w;
+        float y2 = (detections[i].y2 - geom->pad_y) / geom->new_h;
 
         /* Clamp to valid range */
         x1 = clamp_f(x1, 0.0f, 1.0f);
@@ -806,7 +1167,7 @@ int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels)
         float bh = y2 - y1;
 
         /* Debug: show normalized coords */
-        if (i < 3) {
+        if (verbose && i < 3) {
             fprintf(stderr, "  Det[%d] norm: x=%.3f y=%.3f w=%.3f h=%.3f\n",
                     i, x1, y1, bw, bh);
         }
@@ -817,12 +1178,230 @@ int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels)
         }
     }
 
-    free(detections);
+    return CIRA_OK;
+}
+
+/**
+ * Run ONNX inference on an image.
+ *
+ * Steady state performs no heap allocation: the image is preprocessed into
+ * the preallocated input tensor and the session runs through the IoBinding
+ * set up at load, writing into preallocated outputs (see prepare_buffers).
+ *
+ * @param ctx Context with loaded ONNX model
+ * @param data RGB image data (packed HWC, row-major)
+ * @param w Image width
+ * @param h Image height
+ * @param channels Number of channels (must be 3)
+ * @return CIRA_OK on success
+ */
+int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
+    if (!ctx || !ctx->model_handle || !data) {
+        cira_set_error(ctx, "Invalid parameters to onnx_predict");
+        return CIRA_ERROR_INPUT;
+    }
+
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel RGB images supported");
+        return CIRA_ERROR_INPUT;
+    }
+
+    onnx_model_t* model = (onnx_model_t*)ctx->model_handle;
+    int verbose = model->frames == 0;
+
+    /* Clear previous detections */
+    cira_clear_detections(ctx);
+
+    /* Step 1: Resize and normalize into the bound input tensor */
+    double t0 = cira_time_ms();
+    preprocess_run(&model->plan, data, w, h, model->input_buf);
+
+    /* Step 2: Run inference through the binding */
+    double t1 = cira_time_ms();
+    OrtStatus* status = g_ort->RunWithBinding(model->session, NULL, model->binding);
+    if (status != NULL) {
+        fprintf(stderr, "ONNX inference failed: %s\n", g_ort->GetErrorMessage(status));
+        g_ort->ReleaseStatus(status);
+        return CIRA_ERROR;
+    }
+    double t2 = cira_time_ms();
+
+    /* Step 3: Decode all output scales, NMS, add to context */
+    int result;
+    if (model->outputs_bound) {
+        result = decode_outputs(ctx, model, model->output_info, 0, 1, verbose);
+    } else {
+        /* Dynamic output shapes: ORT allocated the outputs for this run */
+        OrtAllocator* allocator = NULL;
+        OrtValue** values = NULL;
+        size_t num_values = 0;
+        ORT_IGNORE(g_ort->GetAllocatorWithDefaultOptions(&allocator));
+        if (!ort_ok(g_ort->GetBoundOutputValues(model->binding, allocator, &values, &num_values),
+                    "GetBoundOutputValues")) {
+            return CIRA_ERROR;
+        }
+        ctx->predict_allocations += 1 + num_values;
+
+        onnx_output_t outputs[4];
+        memset(outputs, 0, sizeof(outputs));
+        for (size_t i = 0; i < num_values && i < 4; i++) {
+            describe_output(values[i], &outputs[i]);
+        }
+        result = decode_outputs(ctx, model, outputs, 0, 1, verbose);
+
+        for (size_t i = 0; i < num_values; i++) {
+            g_ort->ReleaseValue(values[i]);
+        }
+        allocator->Free(allocator, values);
+    }
+
+    ctx->predict_timing.preprocess_ms = t1 - t0;
+    ctx->predict_timing.inference_ms = t2 - t1;
+    ctx->predict_timing.decode_ms = cira_time_ms() - t2;
+
+    model->frames++;
+    if (verbose && result == CIRA_OK) {
+        fprintf(stderr, "ONNX inference: %d detections\n", ctx->num_detections);
+    }
+    return result;
+}
+
+/**
+ * Run the session on a [batch, ...] input tensor in the model's element
+ * type (batch path).
+ *
+ * @param outputs Output: one ORT-allocated tensor per model output
+ * @return CIRA_OK on success
+ */
+static int run_session(cira_ctx* ctx, onnx_model_t* model, void* input, int batch,
+                       OrtValue** outputs) {
+    size_t tensor_size = (size_t)batch * model->input_c * model->input_h * model->input_w;
+
+    int64_t input_shape[4];
+    input_shape_for(model, batch, input_shape);
+    OrtValue* input_tensor = NULL;
+
+    OrtStatus* status = g_ort->CreateTensorWithDataAsOrtValue(
+        model->memory_info,
+        input, tensor_size * input_elem_size(model),
+        input_shape, 4,
+        model->input_type,
+        &input_tensor);
+
+    if (status != NULL) {
+        fprintf(stderr, "Failed to create input tensor: %s\n",
+                g_ort->GetErrorMessage(status));
+        g_ort->ReleaseStatus(status);
+        return CIRA_ERROR;
+    }
+
+    /* Run inference with all outputs */
+    const char* input_names[] = { model->input_name };
+    const char* out_names[4];
+    for (size_t i = 0; i < model->num_outputs && i < 4; i++) {
+        out_names[i] = model->output_names[i];
+        outputs[i] = NULL;
+    }
+
+    status = g_ort->Run(model->session, NULL,
+                        input_names, (const OrtValue* const*)&input_tensor, 1,
+                        out_names, model->num_outputs, outputs);
+
+    g_ort->ReleaseValue(input_tensor);
+
+    /* Input wrapper plus ORT-allocated outputs */
+    ctx->predict_allocations += 1 + model->num_outputs;
+
+    if (status != NULL) {
+        fprintf(stderr, "ONNX inference failed: %s\n",
+                g_ort->GetErrorMessage(status));
+        g_ort->ReleaseStatus(status);
+        for (size_t i = 0; i < model->num_outputs; i++) {
+            if (outputs[i]) g_ort->ReleaseValue(outputs[i]);
+        }
+        return CIRA_ERROR;
+    }
 
-    fprintf(stderr, "ONNX inference: %d detections\n", ctx->num_detections);
     return CIRA_OK;
 }
 
+/**
+ * Run ONNX inference on a batch of images.
+ *
+ * Images are preprocessed into one contiguous [N, C, H, W] (or NHWC) tensor
+ * (in the model's element type) and run with a single session call. Models with a dynamic batch dimension
+ * take the whole batch; fixed-batch models run in chunks of their batch
+ * size, with the last chunk zero-padded. The batch tensor is kept and only
+ * grows; outputs are allocated by ORT per run. Results are stored per
+ * image with cira_batch_store().
+ *
+ * @param ctx Context with loaded ONNX model
+ * @param images RGB images (packed HWC, all w x h)
+ * @param count Number of images
+ * @return CIRA_OK on success
+ */
+int onnx_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                       int w, int h, int channels) {
+    if (!ctx || !ctx->model_handle || !images || count <= 0) {
+        cira_set_error(ctx, "Invalid parameters to onnx_predict_batch");
+        return CIRA_ERROR_INPUT;
+    }
+
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel RGB images supported");
+        return CIRA_ERROR_INPUT;
+    }
+
+    onnx_model_t* model = (onnx_model_t*)ctx->model_handle;
+
+    int chunk = model->batch_size > 0 ? model->batch_size : count;
+    size_t item_bytes = (size_t)model->input_c * model->input_h * model->input_w *
+                        input_elem_size(model);
+
+    if (!grow_buffer(ctx, &model->batch_buf, &model->batch_capacity,
+                     (size_t)chunk * item_bytes)) {
+        cira_set_error(ctx, "Failed to allocate batch input tensor");
+        return CIRA_ERROR_MEMORY;
+    }
+    uint8_t* input = (uint8_t*)model->batch_buf;
+
+    int result = CIRA_OK;
+    for (int start = 0; start < count && result == CIRA_OK; start += chunk) {
+        int n = count - start;
+        if (n > chunk) n = chunk;
+
+        for (int b = 0; b < n; b++) {
+            preprocess_run(&model->plan, images[start + b], w, h, input + b * item_bytes);
+        }
+        if (n < chunk && model->batch_size > 0) {
+            memset(input + n * item_bytes, 0, (chunk - n) * item_bytes);
+        }
+
+        int run_batch = model->batch_size > 0 ? model->batch_size : n;
+        OrtValue* output_tensors[4] = {NULL, NULL, NULL, NULL};
+        result = run_session(ctx, model, input, run_batch, output_tensors);
+        if (result != CIRA_OK) break;
+
+        onnx_output_t outputs[4];
+        memset(outputs, 0, sizeof(outputs));
+        for (size_t i = 0; i < model->num_outputs; i++) {
+            if (output_tensors[i]) describe_output(output_tensors[i], &outputs[i]);
+        }
+
+        for (int b = 0; b < n; b++) {
+            result = decode_outputs(ctx, model, outputs, b, run_batch, 0);
+            if (result != CIRA_OK) break;
+            cira_batch_store(ctx, w, h);
+        }
+
+        for (size_t i = 0; i < model->num_outputs; i++) {
+            if (output_tensors[i]) g_ort->ReleaseValue(output_tensors[i]);
+        }
+    }
+
+    return result;
+}
+
 #else /* CIRA_ONNX_ENABLED */
 
 /* Stubs when ONNX is not enabled */
@@ -845,4 +1424,15 @@ int onnx_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels)
     return CIRA_ERROR_MODEL;
 }
 
+int onnx_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                       int w, int h, int channels) {
+    (void)images;
+    (void)count;
+    (void)w;
+    (void)h;
+    (void)channels;
+    cira_set_error(ctx, "ONNX support not enabled in this build");
+    return CIRA_ERROR_MODEL;
+}
+
 #endif /* CIRA_ONNX_ENABLED */
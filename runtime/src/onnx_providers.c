@@ -0,0 +1,240 @@
+/**
+ * CiRA Runtime - ONNX Execution Providers
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "onnx_providers.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+
+static const char* const EP_NAMES[ONNX_EP_COUNT] = {
+    "cpu", "cuda", "tensorrt", "openvino", "xnnpack"
+};
+
+static const char* const OPT_NAMES[] = { "disable", "basic", "extended", "all" };
+
+const char* onnx_provider_name(onnx_ep_t ep) {
+    return (ep >= 0 && ep < ONNX_EP_COUNT) ? EP_NAMES[ep] : "unknown";
+}
+
+const char* onnx_opt_level_name(onnx_opt_level_t level) {
+    return (level >= ONNX_OPT_DISABLE && level <= ONNX_OPT_ALL) ? OPT_NAMES[level] : "unknown";
+}
+
+static onnx_opt_level_t default_opt_level(onnx_ep_t ep) {
+    return ep == ONNX_EP_OPENVINO ? ONNX_OPT_DISABLE : ONNX_OPT_EXTENDED;
+}
+
+static int default_arena(onnx_ep_t ep) {
+    return ep == ONNX_EP_OPENVINO ? 0 : 1;
+}
+
+static void init_provider(onnx_provider_t* p, onnx_ep_t ep) {
+    memset(p, 0, sizeof(*p));
+    p->ep = ep;
+    p->opt_level = default_opt_level(ep);
+    p->arena = default_arena(ep);
+}
+
+static int fail(char* err, size_t err_size, const char* fmt, ...) {
+    if (err && err_size > 0) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(err, err_size, fmt, args);
+        va_end(args);
+    }
+    return -1;
+}
+
+/* Trim [*begin, *end) of surrounding whitespace */
+static void trim(const char** begin, const char** end) {
+    while (*begin < *end && isspace((unsigned char)**begin)) (*begin)++;
+    while (*end > *begin && isspace((unsigned char)(*end)[-1])) (*end)--;
+}
+
+/* Copy [begin, end) into out if it fits */
+static int copy_span(const char* begin, const char* end, char* out, size_t out_size) {
+    size_t n = (size_t)(end - begin);
+    if (n == 0 || n >= out_size) return -1;
+    memcpy(out, begin, n);
+    out[n] = '\0';
+    return 0;
+}
+
+/* One "key=value" of a provider's options */
+static int parse_option(onnx_provider_t* p, const char* begin, const char* end,
+                        char* err, size_t err_size) {
+    const char* eq = memchr(begin, '=', (size_t)(end - begin));
+    if (!eq) {
+        return fail(err, err_size, "%s: option '%.*s' needs key=value",
+                    onnx_provider_name(p->ep), (int)(end - begin), begin);
+    }
+    const char* key_end = eq;
+    const char* value_begin = eq + 1;
+    trim(&begin, &key_end);
+    trim(&value_begin, &end);
+
+    char key[ONNX_PROVIDER_KEY_LEN];
+    char value[ONNX_PROVIDER_VALUE_LEN];
+    if (copy_span(begin, key_end, key, sizeof(key)) != 0 ||
+        copy_span(value_begin, end, value, sizeof(value)) != 0) {
+        return fail(err, err_size, "%s: option keys must be 1-%d and values 1-%d characters",
+                    onnx_provider_name(p->ep), ONNX_PROVIDER_KEY_LEN - 1,
+                    ONNX_PROVIDER_VALUE_LEN - 1);
+    }
+
+    if (strcmp(key, "opt") == 0) {
+        for (int i = ONNX_OPT_DISABLE; i <= ONNX_OPT_ALL; i++) {
+            if (strcmp(value, OPT_NAMES[i]) == 0) {
+                p->opt_level = (onnx_opt_level_t)i;
+                return 0;
+            }
+        }
+        return fail(err, err_size, "%s: opt must be disable, basic, extended or all",
+                    onnx_provider_name(p->ep));
+    }
+    if (strcmp(key, "arena") == 0) {
+        if (strcmp(value, "0") != 0 && strcmp(value, "1") != 0) {
+            return fail(err, err_size, "%s: arena must be 0 or 1", onnx_provider_name(p->ep));
+        }
+        p->arena = value[0] == '1';
+        return 0;
+    }
+
+    if (onnx_provider_option(p, key)) {
+        return fail(err, err_size, "%s: option %s given twice", onnx_provider_name(p->ep), key);
+    }
+    if (p->num_options >= ONNX_PROVIDER_MAX_OPTIONS) {
+        return fail(err, err_size, "%s: at most %d options", onnx_provider_name(p->ep),
+                    ONNX_PROVIDER_MAX_OPTIONS);
+    }
+    strcpy(p->keys[p->num_options], key);
+    strcpy(p->values[p->num_options], value);
+    p->num_options++;
+    return 0;
+}
+
+/* One "name" or "name(options)" */
+static int parse_provider(onnx_provider_list_t* list, const char* begin, const char* end,
+                          char* err, size_t err_size) {
+    const char* paren = memchr(begin, '(', (size_t)(end - begin));
+    const char* name_end = paren ? paren : end;
+    const char* name = begin;
+    trim(&name, &name_end);
+
+    int ep = -1;
+    for (int i = 0; i < ONNX_EP_COUNT; i++) {
+        if ((size_t)(name_end - name) == strlen(EP_NAMES[i]) &&
+            strncmp(name, EP_NAMES[i], (size_t)(name_end - name)) == 0) {
+            ep = i;
+        }
+    }
+    if (ep < 0) {
+        return fail(err, err_size,
+                    "unknown execution provider '%.*s' (cpu, cuda, tensorrt, openvino, xnnpack)",
+                    (int)(name_end - name), name);
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (list->providers[i].ep == (onnx_ep_t)ep) {
+            return fail(err, err_size, "execution provider %s given twice", EP_NAMES[ep]);
+        }
+    }
+    if (list->count > 0 && list->providers[list->count - 1].ep == ONNX_EP_CPU) {
+        return fail(err, err_size, "cpu must be the last execution provider");
+    }
+
+    onnx_provider_t* p = &list->providers[list->count];
+    init_provider(p, (onnx_ep_t)ep);
+
+    if (paren) {
+        const char* close = end;
+        while (close > paren && close[-1] != ')') close--;
+        const char* tail = close;
+        trim(&tail, &end);
+        if (close == paren || tail != end) {
+            return fail(err, err_size, "%s: options must be closed by ')'", EP_NAMES[ep]);
+        }
+        const char* opt = paren + 1;
+        const char* opts_end = close - 1;
+        while (opt < opts_end) {
+            const char* comma = memchr(opt, ',', (size_t)(opts_end - opt));
+            const char* opt_end = comma ? comma : opts_end;
+            const char* b = opt;
+            const char* e = opt_end;
+            trim(&b, &e);
+            if (b < e && parse_option(p, b, e, err, err_size) != 0) return -1;
+            opt = comma ? comma + 1 : opts_end;
+        }
+    }
+
+    list->count++;
+    return 0;
+}
+
+int onnx_providers_parse(const char* spec, onnx_provider_list_t* list,
+                         char* err, size_t err_size) {
+    memset(list, 0, sizeof(*list));
+    if (err && err_size > 0) err[0] = '\0';
+
+    const char* s = spec ? spec : "";
+    while (*s) {
+        const char* semi = strchr(s, ';');
+        const char* end = semi ? semi : s + strlen(s);
+        const char* b = s;
+        const char* e = end;
+        trim(&b, &e);
+        /* Repeats are rejected, so the list cannot overflow */
+        if (b < e && parse_provider(list, b, e, err, err_size) != 0) {
+            memset(list, 0, sizeof(*list));
+            return -1;
+        }
+        s = semi ? semi + 1 : end;
+    }
+
+    /* CPU runs whatever the others leave */
+    if (list->count == 0 || list->providers[list->count - 1].ep != ONNX_EP_CPU) {
+        init_provider(&list->providers[list->count++], ONNX_EP_CPU);
+    }
+    return 0;
+}
+
+const char* onnx_provider_option(const onnx_provider_t* provider, const char* key) {
+    for (int i = 0; i < provider->num_options; i++) {
+        if (strcmp(provider->keys[i], key) == 0) return provider->values[i];
+    }
+    return NULL;
+}
+
+void onnx_providers_format(const onnx_provider_list_t* list, char* out, size_t out_size) {
+    size_t len = 0;
+    if (out_size == 0) return;
+    out[0] = '\0';
+
+#define APPEND(...) do { \
+    if (len < out_size) { \
+        int _n = snprintf(out + len, out_size - len, __VA_ARGS__); \
+        if (_n > 0) len += (size_t)_n; \
+    } \
+} while (0)
+
+    for (int i = 0; i < list->count; i++) {
+        const onnx_provider_t* p = &list->providers[i];
+        APPEND("%s%s", i ? ";" : "", onnx_provider_name(p->ep));
+
+        int n = 0;
+        if (p->opt_level != default_opt_level(p->ep)) {
+            APPEND("%sopt=%s", n++ ? "," : "(", onnx_opt_level_name(p->opt_level));
+        }
+        if (p->arena != default_arena(p->ep)) {
+            APPEND("%sarena=%d", n++ ? "," : "(", p->arena);
+        }
+        for (int k = 0; k < p->num_options; k++) {
+            APPEND("%s%s=%s", n++ ? "," : "(", p->keys[k], p->values[k]);
+        }
+        if (n) APPEND(")");
+    }
+#undef APPEND
+}
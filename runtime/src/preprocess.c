@@ -0,0 +1,525 @@
+/**
+ * CiRA Runtime - Image Preprocessing
+ *
+ * Separable bilinear resize with pixel-center sampling (same mapping as
+ * cv::resize and the TensorRT GPU kernel). Each source row is resampled
+ * horizontally once into a normalized float row, laid out like the
+ * destination (planar per channel for NCHW, interleaved for NHWC). Each
+ * destination row is then a vertical blend of two cached rows, written
+ * straight into the tensor as fp32 or fp16. The blend, the fp16 store and
+ * the no-resize row conversion are the vectorized parts, as is the fp16 to
+ * fp32 conversion backends use on half precision outputs.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "preprocess.h"
+#include "cira.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PREPROCESS_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define PREPROCESS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define INV_255 (1.0f / 255.0f)
+
+uint16_t preprocess_float_to_half(float value) {
+    uint32_t f;
+    memcpy(&f, &value, sizeof(f));
+    uint32_t sign = (f >> 16) & 0x8000;
+    f &= 0x7fffffff;
+
+    if (f >= 0x47800000) {
+        /* Too large for half: Inf, or NaN stays NaN */
+        return (uint16_t)(sign | (f > 0x7f800000 ? 0x7e00 : 0x7c00));
+    }
+    if (f < 0x38800000) {
+        /* Half subnormal or zero: let float addition do the rounding */
+        float v;
+        memcpy(&v, &f, sizeof(v));
+        v += 0.5f;
+        uint32_t u;
+        memcpy(&u, &v, sizeof(u));
+        return (uint16_t)(sign | (u - 0x3f000000));
+    }
+
+    /* Rebias exponent and round mantissa to nearest even */
+    uint32_t odd = (f >> 13) & 1;
+    f += ((uint32_t)(15 - 127) << 23) + 0xfff + odd;
+    return (uint16_t)(sign | (f >> 13));
+}
+
+static float half_to_float_scalar(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t f;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            f = sign;
+        } else {
+            /* Subnormal: normalize */
+            exponent = 1;
+            while ((mantissa & 0x400) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            mantissa &= 0x3ff;
+            f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 31) {
+        f = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    memcpy(&value, &f, sizeof(value));
+    return value;
+}
+
+/* ============================================
+ * Row kernels: scalar
+ * ============================================ */
+
+static void blend_f32_scalar(const float* a, const float* b, float w, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = a[i] + (b[i] - a[i]) * w;
+    }
+}
+
+static void blend_f16_scalar(const float* a, const float* b, float w, uint16_t* out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = preprocess_float_to_half(a[i] + (b[i] - a[i]) * w);
+    }
+}
+
+static void convert_u8_scalar(const uint8_t* src, float* out, int n) {
+    for (int i = 0; i < n; i++) {
+        out[i] = src[i] * INV_255;
+    }
+}
+
+static void half_row_scalar(const uint16_t* src, float* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = half_to_float_scalar(src[i]);
+    }
+}
+
+/* ============================================
+ * Row kernels: AVX2 / FMA / F16C (x86)
+ * ============================================ */
+
+#ifdef PREPROCESS_AVX2
+
+__attribute__((target("avx2,fma")))
+static void blend_f32_avx2(const float* a, const float* b, float w, float* out, int n) {
+    __m256 vw = _mm256_set1_ps(w);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(_mm256_sub_ps(vb, va), vw, va));
+    }
+    blend_f32_scalar(a + i, b + i, w, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static void blend_f16_avx2(const float* a, const float* b, float w, uint16_t* out, int n) {
+    __m256 vw = _mm256_set1_ps(w);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        __m256 v = _mm256_fmadd_ps(_mm256_sub_ps(vb, va), vw, va);
+        _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+    blend_f16_scalar(a + i, b + i, w, out + i, n - i);
+}
+
+__attribute__((target("avx2,f16c")))
+static void half_row_avx2(const uint16_t* src, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+    half_row_scalar(src + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void convert_u8_avx2(const uint8_t* src, float* out, int n) {
+    __m256 k = _mm256_set1_ps(INV_255);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i bytes = _mm_loadl_epi64((const __m128i*)(src + i));
+        __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(v, k));
+    }
+    convert_u8_scalar(src + i, out + i, n - i);
+}
+
+static int cpu_has_avx2(void) {
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                 __builtin_cpu_supports("f16c");
+    }
+    return cached;
+}
+
+#endif /* PREPROCESS_AVX2 */
+
+/* ============================================
+ * Row kernels: NEON (aarch64)
+ * ============================================ */
+
+#ifdef PREPROCESS_NEON
+
+static void blend_f32_neon(const float* a, const float* b, float w, float* out, int n) {
+    float32x4_t vw = vdupq_n_f32(w);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t va = vld1q_f32(a + i);
+        float32x4_t vb = vld1q_f32(b + i);
+        vst1q_f32(out + i, vfmaq_f32(va, vsubq_f32(vb, va), vw));
+    }
+    blend_f32_scalar(a + i, b + i, w, out + i, n - i);
+}
+
+static void blend_f16_neon(const float* a, const float* b, float w, uint16_t* out, int n) {
+    float32x4_t vw = vdupq_n_f32(w);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t va = vld1q_f32(a + i);
+        float32x4_t vb = vld1q_f32(b + i);
+        float16x4_t h = vcvt_f16_f32(vfmaq_f32(va, vsubq_f32(vb, va), vw));
+        vst1_u16(out + i, vreinterpret_u16_f16(h));
+    }
+    blend_f16_scalar(a + i, b + i, w, out + i, n - i);
+}
+
+static void half_row_neon(const uint16_t* src, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float16x4_t h = vreinterpret_f16_u16(vld1_u16(src + i));
+        vst1q_f32(out + i, vcvt_f32_f16(h));
+    }
+    half_row_scalar(src + i, out + i, n - i);
+}
+
+static inline void store_u8x16(uint8x16_t v, float* out) {
+    uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+    vst1q_f32(out + 0, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), INV_255));
+    vst1q_f32(out + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), INV_255));
+    vst1q_f32(out + 8, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), INV_255));
+    vst1q_f32(out + 12, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), INV_255));
+}
+
+static void convert_u8_neon(const uint8_t* src, float* out, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        store_u8x16(vld1q_u8(src + i), out + i);
+    }
+    convert_u8_scalar(src + i, out + i, n - i);
+}
+
+/* Packed RGB -> three float planes, 16 pixels per step */
+static int deinterleave_neon(const uint8_t* src, float* r, float* g, float* b, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x3_t px = vld3q_u8(src + i * 3);
+        store_u8x16(px.val[0], r + i);
+        store_u8x16(px.val[1], g + i);
+        store_u8x16(px.val[2], b + i);
+    }
+    return i;
+}
+
+#endif /* PREPROCESS_NEON */
+
+/* ============================================
+ * Dispatch
+ * ============================================ */
+
+const char* preprocess_simd_name(void) {
+#if defined(PREPROCESS_AVX2)
+    return cpu_has_avx2() ? "avx2" : "scalar";
+#elif defined(PREPROCESS_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+void preprocess_half_to_float(const uint16_t* src, float* dst, size_t n) {
+#if defined(PREPROCESS_AVX2)
+    if (cpu_has_avx2()) { half_row_avx2(src, dst, n); return; }
+#elif defined(PREPROCESS_NEON)
+    half_row_neon(src, dst, n);
+    return;
+#endif
+    half_row_scalar(src, dst, n);
+}
+
+static void blend_row(const preprocess_plan_t* plan, const float* a, const float* b, float w,
+                      void* out, int n) {
+    if (plan->fp16) {
+#if defined(PREPROCESS_AVX2)
+        if (plan->use_simd) { blend_f16_avx2(a, b, w, (uint16_t*)out, n); return; }
+#elif defined(PREPROCESS_NEON)
+        if (plan->use_simd) { blend_f16_neon(a, b, w, (uint16_t*)out, n); return; }
+#endif
+        blend_f16_scalar(a, b, w, (uint16_t*)out, n);
+    } else {
+#if defined(PREPROCESS_AVX2)
+        if (plan->use_simd) { blend_f32_avx2(a, b, w, (float*)out, n); return; }
+#elif defined(PREPROCESS_NEON)
+        if (plan->use_simd) { blend_f32_neon(a, b, w, (float*)out, n); return; }
+#endif
+        blend_f32_scalar(a, b, w, (float*)out, n);
+    }
+}
+
+static void convert_u8(const preprocess_plan_t* plan, const uint8_t* src, float* out, int n) {
+#if defined(PREPROCESS_AVX2)
+    if (plan->use_simd) { convert_u8_avx2(src, out, n); return; }
+#elif defined(PREPROCESS_NEON)
+    if (plan->use_simd) { convert_u8_neon(src, out, n); return; }
+#endif
+    (void)plan;
+    convert_u8_scalar(src, out, n);
+}
+
+/* ============================================
+ * Plan
+ * ============================================ */
+
+int preprocess_init(preprocess_plan_t* plan, int dst_w, int dst_h, int layout,
+                    int fp16, int letterbox) {
+    memset(plan, 0, sizeof(*plan));
+    if (dst_w <= 0 || dst_h <= 0) return CIRA_ERROR_INPUT;
+
+    plan->dst_w = dst_w;
+    plan->dst_h = dst_h;
+    plan->layout = layout;
+    plan->fp16 = fp16;
+    plan->letterbox = letterbox;
+    plan->order = PREPROCESS_RGB;
+#if defined(PREPROCESS_AVX2)
+    plan->use_simd = cpu_has_avx2();
+#elif defined(PREPROCESS_NEON)
+    plan->use_simd = 1;
+#endif
+
+    /* The resized image is never wider than the destination */
+    plan->x_lo = (int*)malloc((size_t)dst_w * sizeof(int));
+    plan->x_hi = (int*)malloc((size_t)dst_w * sizeof(int));
+    plan->x_wt = (float*)malloc((size_t)dst_w * sizeof(float));
+    plan->rows[0] = (float*)malloc((size_t)dst_w * 3 * sizeof(float));
+    plan->rows[1] = (float*)malloc((size_t)dst_w * 3 * sizeof(float));
+    if (!plan->x_lo || !plan->x_hi || !plan->x_wt || !plan->rows[0] || !plan->rows[1]) {
+        preprocess_free(plan);
+        return CIRA_ERROR_MEMORY;
+    }
+    return CIRA_OK;
+}
+
+void preprocess_free(preprocess_plan_t* plan) {
+    if (!plan) return;
+    free(plan->x_lo);
+    free(plan->x_hi);
+    free(plan->x_wt);
+    free(plan->rows[0]);
+    free(plan->rows[1]);
+    plan->x_lo = plan->x_hi = NULL;
+    plan->x_wt = plan->rows[0] = plan->rows[1] = NULL;
+}
+
+/* Geometry and column tables for a source size */
+static void build_tables(preprocess_plan_t* plan, int src_w, int src_h) {
+    preprocess_geom_t* g = &plan->geom;
+    int new_w = plan->dst_w;
+    int new_h = plan->dst_h;
+
+    if (plan->letterbox) {
+        float sx = (float)plan->dst_w / src_w;
+        float sy = (float)plan->dst_h / src_h;
+        float scale = sx < sy ? sx : sy;
+        new_w = (int)lroundf(src_w * scale);
+        new_h = (int)lroundf(src_h * scale);
+        if (new_w < 1) new_w = 1;
+        if (new_h < 1) new_h = 1;
+        if (new_w > plan->dst_w) new_w = plan->dst_w;
+        if (new_h > plan->dst_h) new_h = plan->dst_h;
+    }
+
+    g->new_w = new_w;
+    g->new_h = new_h;
+    g->scale_x = (float)new_w / src_w;
+    g->scale_y = (float)new_h / src_h;
+    g->pad_x = (plan->dst_w - new_w) / 2;
+    g->pad_y = (plan->dst_h - new_h) / 2;
+
+    float inv = (float)src_w / new_w;
+    for (int x = 0; x < new_w; x++) {
+        float fx = (x + 0.5f) * inv - 0.5f;
+        if (fx < 0.0f) fx = 0.0f;
+        if (fx > src_w - 1) fx = (float)(src_w - 1);
+        int lo = (int)fx;
+        plan->x_lo[x] = lo;
+        plan->x_hi[x] = lo + 1 < src_w ? lo + 1 : src_w - 1;
+        plan->x_wt[x] = fx - lo;
+    }
+
+    plan->src_w = src_w;
+    plan->src_h = src_h;
+}
+
+/* Resample one source row horizontally into a normalized row */
+static void resample_row(const preprocess_plan_t* plan, const uint8_t* srow, float* out) {
+    int new_w = plan->geom.new_w;
+    int bgr = plan->order == PREPROCESS_BGR;
+
+    if (new_w == plan->src_w) {
+        /* No horizontal resize: plain conversion */
+        if (plan->layout == PREPROCESS_NHWC && !bgr) {
+            convert_u8(plan, srow, out, new_w * 3);
+            return;
+        }
+        int start = 0;
+        float* r = out;
+        float* g = out + new_w;
+        float* b = out + 2 * new_w;
+        if (plan->layout == PREPROCESS_NCHW) {
+            if (bgr) { float* t = r; r = b; b = t; }
+#ifdef PREPROCESS_NEON
+            if (plan->use_simd) start = deinterleave_neon(srow, r, g, b, new_w);
+#endif
+            for (int x = start; x < new_w; x++) {
+                r[x] = srow[x * 3 + 0] * INV_255;
+                g[x] = srow[x * 3 + 1] * INV_255;
+                b[x] = srow[x * 3 + 2] * INV_255;
+            }
+        } else {
+            for (int x = 0; x < new_w; x++) {
+                out[x * 3 + 0] = srow[x * 3 + 2] * INV_255;
+                out[x * 3 + 1] = srow[x * 3 + 1] * INV_255;
+                out[x * 3 + 2] = srow[x * 3 + 0] * INV_255;
+            }
+        }
+        return;
+    }
+
+    int c0 = bgr ? 2 : 0;
+    int c2 = bgr ? 0 : 2;
+    size_t cs = plan->layout == PREPROCESS_NCHW ? (size_t)new_w : 1;
+    size_t xs = plan->layout == PREPROCESS_NCHW ? 1 : 3;
+
+    for (int x = 0; x < new_w; x++) {
+        const uint8_t* p0 = srow + plan->x_lo[x] * 3;
+        const uint8_t* p1 = srow + plan->x_hi[x] * 3;
+        float w = plan->x_wt[x];
+        float* o = out + x * xs;
+        o[0] = (p0[c0] + (p1[c0] - p0[c0]) * w) * INV_255;
+        o[cs] = (p0[1] + (p1[1] - p0[1]) * w) * INV_255;
+        o[2 * cs] = (p0[c2] + (p1[c2] - p0[c2]) * w) * INV_255;
+    }
+}
+
+/* Cached horizontally resampled row for source row y */
+static const float* get_row(preprocess_plan_t* plan, const uint8_t* src, int y, int keep) {
+    for (int i = 0; i < 2; i++) {
+        if (plan->row_y[i] == y) return plan->rows[i];
+    }
+    int i = plan->row_y[0] == keep ? 1 : 0;
+    resample_row(plan, src + (size_t)y * plan->src_w * 3, plan->rows[i]);
+    plan->row_y[i] = y;
+    return plan->rows[i];
+}
+
+static void fill_pad(const preprocess_plan_t* plan, void* out, size_t n) {
+    if (n == 0) return;
+    if (plan->fp16) {
+        uint16_t v = preprocess_float_to_half(PREPROCESS_PAD_VALUE);
+        uint16_t* o = (uint16_t*)out;
+        for (size_t i = 0; i < n; i++) o[i] = v;
+    } else {
+        float* o = (float*)out;
+        for (size_t i = 0; i < n; i++) o[i] = PREPROCESS_PAD_VALUE;
+    }
+}
+
+int preprocess_run(preprocess_plan_t* plan, const uint8_t* src, int src_w, int src_h,
+                   void* dst) {
+    if (!plan || !plan->x_lo || !src || !dst || src_w <= 0 || src_h <= 0) {
+        return CIRA_ERROR_INPUT;
+    }
+
+    if (src_w != plan->src_w || src_h != plan->src_h) {
+        build_tables(plan, src_w, src_h);
+    }
+
+    /* New image: nothing cached */
+    plan->row_y[0] = plan->row_y[1] = -1;
+
+    const preprocess_geom_t* g = &plan->geom;
+    size_t elem = plan->fp16 ? sizeof(uint16_t) : sizeof(float);
+    size_t plane = plan->plane_stride ? plan->plane_stride : (size_t)plan->dst_w * plan->dst_h;
+    int nchw = plan->layout == PREPROCESS_NCHW;
+    size_t right = (size_t)(plan->dst_w - g->pad_x - g->new_w);
+    float inv = (float)src_h / g->new_h;
+
+    for (int y = 0; y < plan->dst_h; y++) {
+        int iy = y - g->pad_y;
+
+        if (iy < 0 || iy >= g->new_h) {
+            if (nchw) {
+                for (int c = 0; c < 3; c++) {
+                    fill_pad(plan, (uint8_t*)dst + (c * plane + (size_t)y * plan->dst_w) * elem,
+                             (size_t)plan->dst_w);
+                }
+            } else {
+                fill_pad(plan, (uint8_t*)dst + (size_t)y * plan->dst_w * 3 * elem,
+                         (size_t)plan->dst_w * 3);
+            }
+            continue;
+        }
+
+        float fy = (iy + 0.5f) * inv - 0.5f;
+        if (fy < 0.0f) fy = 0.0f;
+        if (fy > src_h - 1) fy = (float)(src_h - 1);
+        int y0 = (int)fy;
+        float wy = fy - y0;
+        int y1 = (wy > 0.0f && y0 + 1 < src_h) ? y0 + 1 : y0;
+
+        const float* a = get_row(plan, src, y0, y1);
+        const float* b = y1 == y0 ? a : get_row(plan, src, y1, y0);
+
+        if (nchw) {
+            for (int c = 0; c < 3; c++) {
+                uint8_t* row = (uint8_t*)dst + (c * plane + (size_t)y * plan->dst_w) * elem;
+                fill_pad(plan, row, (size_t)g->pad_x);
+                blend_row(plan, a + c * g->new_w, b + c * g->new_w, wy,
+                          row + (size_t)g->pad_x * elem, g->new_w);
+                fill_pad(plan, row + (size_t)(g->pad_x + g->new_w) * elem, right);
+            }
+        } else {
+            uint8_t* row = (uint8_t*)dst + (size_t)y * plan->dst_w * 3 * elem;
+            fill_pad(plan, row, (size_t)g->pad_x * 3);
+            blend_row(plan, a, b, wy, row + (size_t)g->pad_x * 3 * elem, g->new_w * 3);
+            fill_pad(plan, row + (size_t)(g->pad_x + g->new_w) * 3 * elem, right * 3);
+        }
+    }
+
+    return CIRA_OK;
+}
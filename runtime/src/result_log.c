@@ -0,0 +1,415 @@
+/**
+ * CiRA Runtime - Result History
+ *
+ * Result i (counting appends from 0) lives in slot i % capacity of every
+ * result column, and detection j in slot j % det_capacity of the
+ * detection columns. Positions are 64-bit counters that never wrap, so
+ * "is this result's first box still in the detection ring" is a plain
+ * comparison.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "result_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* The segment layout is read by other processes */
+_Static_assert(sizeof(result_log_file_header_t) == 64, "result log header must be 64 bytes");
+_Static_assert(sizeof(result_log_record_t) == 40, "result log record must be 40 bytes");
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Longest segment path */
+#define RESULT_LOG_PATH_MAX 512
+
+struct result_log {
+    /* Result columns */
+    int capacity;
+    uint64_t head;                  /* Results appended */
+    uint64_t tail;                  /* Oldest result held */
+    int64_t max_age_ms;             /* 0 = no age limit */
+    uint64_t* sequence;
+    uint64_t* frame_sequence;
+    int64_t* timestamp_ms;
+    uint64_t* first_detection;      /* Detection position of the first box */
+    int16_t* camera;
+    uint16_t* width;
+    uint16_t* height;
+    uint16_t* detection_count;
+
+    /* Detection columns */
+    int det_capacity;
+    uint64_t det_head;              /* Detections appended */
+    float* x;
+    float* y;
+    float* w;
+    float* h;
+    float* confidence;
+    int16_t* label_id;
+
+    /* Segment file, NULL map without one */
+    char path[RESULT_LOG_PATH_MAX];
+    uint8_t* map;
+    size_t map_size;
+    result_log_file_header_t* file;
+};
+
+int64_t result_log_now_ms(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+result_log_t* result_log_create(int max_results, int max_age_sec) {
+    if (max_results < RESULT_LOG_MIN_RESULTS) max_results = RESULT_LOG_MIN_RESULTS;
+    if (max_results > RESULT_LOG_MAX_RESULTS) max_results = RESULT_LOG_MAX_RESULTS;
+
+    result_log_t* log = (result_log_t*)calloc(1, sizeof(result_log_t));
+    if (!log) return NULL;
+
+    size_t n = (size_t)max_results;
+    log->capacity = max_results;
+    log->max_age_ms = max_age_sec > 0 ? (int64_t)max_age_sec * 1000 : 0;
+    log->sequence = (uint64_t*)malloc(n * sizeof(uint64_t));
+    log->frame_sequence = (uint64_t*)malloc(n * sizeof(uint64_t));
+    log->timestamp_ms = (int64_t*)malloc(n * sizeof(int64_t));
+    log->first_detection = (uint64_t*)malloc(n * sizeof(uint64_t));
+    log->camera = (int16_t*)malloc(n * sizeof(int16_t));
+    log->width = (uint16_t*)malloc(n * sizeof(uint16_t));
+    log->height = (uint16_t*)malloc(n * sizeof(uint16_t));
+    log->detection_count = (uint16_t*)malloc(n * sizeof(uint16_t));
+
+    /* Room for at least one full result, whatever the average */
+    size_t d = n * RESULT_LOG_DETECTIONS_PER_RESULT;
+    if (d < CIRA_RESULT_MAX_RECORDS) d = CIRA_RESULT_MAX_RECORDS;
+    log->det_capacity = (int)d;
+    log->x = (float*)malloc(d * sizeof(float));
+    log->y = (float*)malloc(d * sizeof(float));
+    log->w = (float*)malloc(d * sizeof(float));
+    log->h = (float*)malloc(d * sizeof(float));
+    log->confidence = (float*)malloc(d * sizeof(float));
+    log->label_id = (int16_t*)malloc(d * sizeof(int16_t));
+
+    if (!log->sequence || !log->frame_sequence || !log->timestamp_ms ||
+        !log->first_detection || !log->camera || !log->width || !log->height ||
+        !log->detection_count || !log->x || !log->y || !log->w || !log->h ||
+        !log->confidence || !log->label_id) {
+        result_log_destroy(log);
+        return NULL;
+    }
+    return log;
+}
+
+#ifndef _WIN32
+
+/* Move a segment aside to <path>.1, replacing the previous one */
+static void segment_rotate_file(const char* path) {
+    char old[RESULT_LOG_PATH_MAX + 2];
+    snprintf(old, sizeof(old), "%s.1", path);
+    rename(path, old);
+}
+
+/* Create and map a fresh segment at log->path */
+static int segment_create(result_log_t* log) {
+    int fd = open(log->path, O_CREAT | O_TRUNC | O_RDWR, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Result log: cannot create %s\n", log->path);
+        return CIRA_ERROR_FILE;
+    }
+    if (ftruncate(fd, (off_t)log->map_size) != 0) {
+        fprintf(stderr, "Result log: cannot size %s to %zu bytes\n", log->path, log->map_size);
+        close(fd);
+        return CIRA_ERROR_FILE;
+    }
+    void* base = mmap(NULL, log->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Result log: cannot map %s\n", log->path);
+        return CIRA_ERROR_FILE;
+    }
+
+    /* ftruncate zero-fills: no records until write_offset moves */
+    log->map = (uint8_t*)base;
+    log->file = (result_log_file_header_t*)base;
+    log->file->version = RESULT_LOG_VERSION;
+    log->file->header_size = sizeof(result_log_file_header_t);
+    log->file->record_size = sizeof(result_log_record_t);
+    log->file->detection_size = sizeof(cira_result_record_t);
+    log->file->writer_pid = (uint32_t)getpid();
+    log->file->segment_size = log->map_size;
+    log->file->created_ms = result_log_now_ms();
+    __atomic_store_n(&log->file->write_offset, (uint64_t)sizeof(result_log_file_header_t),
+                     __ATOMIC_RELEASE);
+    __atomic_store_n(&log->file->magic, RESULT_LOG_MAGIC, __ATOMIC_RELEASE);
+    return CIRA_OK;
+}
+
+static void segment_close(result_log_t* log) {
+    if (!log->map) return;
+    munmap(log->map, log->map_size);
+    log->map = NULL;
+    log->file = NULL;
+}
+
+int result_log_open_segment(result_log_t* log, const char* path, size_t size) {
+    if (!log || !path || !path[0] || strlen(path) >= sizeof(log->path)) return CIRA_ERROR_FILE;
+    if (size < RESULT_LOG_MIN_SEGMENT) size = RESULT_LOG_MIN_SEGMENT;
+    if (size > RESULT_LOG_MAX_SEGMENT) size = RESULT_LOG_MAX_SEGMENT;
+
+    segment_close(log);
+    strcpy(log->path, path);
+    log->map_size = size;
+
+    /* Sequences restart with the process: keep the last run's records aside */
+    struct stat st;
+    if (stat(path, &st) == 0 && st.st_size > 0) {
+        segment_rotate_file(path);
+    }
+
+    int result = segment_create(log);
+    if (result == CIRA_OK) {
+        fprintf(stderr, "Result log: %s, %.1f MB segments\n", path, size / (1024.0 * 1024.0));
+    }
+    return result;
+}
+
+/* Append one record, starting a new segment when this one is full */
+static void segment_append(result_log_t* log, const result_log_record_t* rec,
+                           const cira_result_record_t* dets) {
+    size_t need = sizeof(*rec) + (size_t)rec->detection_count * sizeof(cira_result_record_t);
+    uint64_t offset = log->file->write_offset;
+
+    if (offset + need > log->map_size) {
+        segment_close(log);
+        segment_rotate_file(log->path);
+        if (segment_create(log) != CIRA_OK) {
+            fprintf(stderr, "Result log: segment file disabled\n");
+            return;
+        }
+        offset = log->file->write_offset;
+    }
+
+    memcpy(log->map + offset, rec, sizeof(*rec));
+    if (rec->detection_count > 0) {
+        memcpy(log->map + offset + sizeof(*rec), dets,
+               (size_t)rec->detection_count * sizeof(cira_result_record_t));
+    }
+    __atomic_store_n(&log->file->write_offset, offset + need, __ATOMIC_RELEASE);
+}
+
+#else
+
+int result_log_open_segment(result_log_t* log, const char* path, size_t size) {
+    (void)log;
+    (void)path;
+    (void)size;
+    fprintf(stderr, "Result log: segment files are not supported on this platform\n");
+    return CIRA_ERROR_FILE;
+}
+
+static void segment_close(result_log_t* log) {
+    (void)log;
+}
+
+static void segment_append(result_log_t* log, const result_log_record_t* rec,
+                           const cira_result_record_t* dets) {
+    (void)log;
+    (void)rec;
+    (void)dets;
+}
+
+#endif /* _WIN32 */
+
+void result_log_destroy(result_log_t* log) {
+    if (!log) return;
+    segment_close(log);
+    free(log->sequence);
+    free(log->frame_sequence);
+    free(log->timestamp_ms);
+    free(log->first_detection);
+    free(log->camera);
+    free(log->width);
+    free(log->height);
+    free(log->detection_count);
+    free(log->x);
+    free(log->y);
+    free(log->w);
+    free(log->h);
+    free(log->confidence);
+    free(log->label_id);
+    free(log);
+}
+
+void result_log_append(result_log_t* log, uint64_t sequence, int64_t timestamp_ms,
+                       int camera, uint64_t frame_sequence, int width, int height,
+                       const cira_result_record_t* dets, int count) {
+    if (!log) return;
+    if (count < 0 || !dets) count = 0;
+    if (count > CIRA_RESULT_MAX_RECORDS) count = CIRA_RESULT_MAX_RECORDS;
+
+    /* Drop the oldest results: the slot, boxes the new ones overwrite, age */
+    uint64_t det_end = log->det_head + (uint64_t)count;
+    if (log->head - log->tail == (uint64_t)log->capacity) {
+        log->tail++;
+    }
+    while (log->tail < log->head &&
+           log->first_detection[log->tail % log->capacity] + (uint64_t)log->det_capacity < det_end) {
+        log->tail++;
+    }
+    if (log->max_age_ms > 0) {
+        while (log->tail < log->head &&
+               log->timestamp_ms[log->tail % log->capacity] < timestamp_ms - log->max_age_ms) {
+            log->tail++;
+        }
+    }
+
+    size_t slot = (size_t)(log->head % log->capacity);
+    log->sequence[slot] = sequence;
+    log->frame_sequence[slot] = frame_sequence;
+    log->timestamp_ms[slot] = timestamp_ms;
+    log->first_detection[slot] = log->det_head;
+    log->camera[slot] = (int16_t)camera;
+    log->width[slot] = (uint16_t)width;
+    log->height[slot] = (uint16_t)height;
+    log->detection_count[slot] = (uint16_t)count;
+
+    for (int i = 0; i < count; i++) {
+        size_t d = (size_t)((log->det_head + i) % log->det_capacity);
+        log->x[d] = dets[i].x;
+        log->y[d] = dets[i].y;
+        log->w[d] = dets[i].w;
+        log->h[d] = dets[i].h;
+        log->confidence[d] = dets[i].confidence;
+        log->label_id[d] = (int16_t)dets[i].label_id;
+    }
+    log->head++;
+    log->det_head = det_end;
+
+    if (log->map) {
+        result_log_record_t rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.sequence = sequence;
+        rec.frame_sequence = frame_sequence;
+        rec.timestamp_ms = timestamp_ms;
+        rec.camera = camera;
+        rec.width = (uint16_t)width;
+        rec.height = (uint16_t)height;
+        rec.detection_count = (uint32_t)count;
+        segment_append(log, &rec, dets);
+    }
+}
+
+/* First position in [lo, head) whose sequence is above since */
+static uint64_t find_sequence(const result_log_t* log, uint64_t lo, uint64_t since) {
+    uint64_t hi = log->head;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (log->sequence[mid % log->capacity] <= since) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* First position in [lo, head) stored at or after from_ms (the clock only
+ * steps back on a time change, which at worst returns a few extra results) */
+static uint64_t find_time(const result_log_t* log, uint64_t lo, int64_t from_ms) {
+    uint64_t hi = log->head;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (log->timestamp_ms[mid % log->capacity] < from_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int result_log_range(const result_log_t* log, uint64_t since, int64_t from_ms,
+                     int camera, int limit, result_range_t* out) {
+    if (!out) return CIRA_ERROR_INPUT;
+    memset(out, 0, sizeof(*out));
+    if (!log || log->tail == log->head || limit <= 0) return CIRA_OK;
+
+    out->oldest = log->sequence[log->tail % log->capacity];
+    out->latest = log->sequence[(log->head - 1) % log->capacity];
+
+    uint64_t start = find_sequence(log, log->tail, since);
+    if (from_ms > 0) start = find_time(log, start, from_ms);
+
+    /* Size the copy first */
+    int count = 0;
+    size_t boxes = 0;
+    uint64_t pos = start;
+    for (; pos < log->head; pos++) {
+        size_t slot = (size_t)(pos % log->capacity);
+        if (camera >= 0 && log->camera[slot] != camera) continue;
+        if (count == limit) {
+            out->more = 1;
+            break;
+        }
+        count++;
+        boxes += log->detection_count[slot];
+    }
+    if (count == 0) return CIRA_OK;
+
+    out->entries = (result_log_entry_t*)malloc((size_t)count * sizeof(result_log_entry_t));
+    out->detections = (cira_result_record_t*)malloc((boxes ? boxes : 1) * sizeof(cira_result_record_t));
+    if (!out->entries || !out->detections) {
+        result_range_free(out);
+        return CIRA_ERROR_MEMORY;
+    }
+
+    uint64_t end = pos;
+    for (pos = start; pos < end; pos++) {
+        size_t slot = (size_t)(pos % log->capacity);
+        if (camera >= 0 && log->camera[slot] != camera) continue;
+
+        result_log_entry_t* e = &out->entries[out->count++];
+        e->sequence = log->sequence[slot];
+        e->frame_sequence = log->frame_sequence[slot];
+        e->timestamp_ms = log->timestamp_ms[slot];
+        e->camera = log->camera[slot];
+        e->width = log->width[slot];
+        e->height = log->height[slot];
+        e->first_detection = out->num_detections;
+        e->detection_count = log->detection_count[slot];
+
+        uint64_t first = log->first_detection[slot];
+        for (int i = 0; i < e->detection_count; i++) {
+            size_t d = (size_t)((first + i) % log->det_capacity);
+            cira_result_record_t* r = &out->detections[out->num_detections++];
+            r->x = log->x[d];
+            r->y = log->y[d];
+            r->w = log->w[d];
+            r->h = log->h[d];
+            r->confidence = log->confidence[d];
+            r->label_id = log->label_id[d];
+        }
+    }
+    return CIRA_OK;
+}
+
+void result_range_free(result_range_t* range) {
+    if (!range) return;
+    free(range->entries);
+    free(range->detections);
+    range->entries = NULL;
+    range->detections = NULL;
+    range->count = 0;
+    range->num_detections = 0;
+}
+
+int result_log_count(const result_log_t* log) {
+    return log ? (int)(log->head - log->tail) : 0;
+}
+
+uint64_t result_log_segment_bytes(const result_log_t* log) {
+    if (!log || !log->file) return 0;
+    return log->file->write_offset;
+}
@@ -6,13 +6,53 @@
  * - GET /snapshot - Single JPEG image
  * - GET /stream/raw - Raw MJPEG stream
  * - GET /stream/annotated - MJPEG stream with annotations
+ * - GET /stream/video - Annotated H.264/H.265 as fragmented MP4
  * - GET /api/results - Latest inference results as JSON
+ * - GET /api/results/stream - Server-sent events: every new result, plus stats
+ * - GET /api/results/range - Recent results after a sequence, from the history
+ * - POST /api/inference/image - Infer an uploaded or device image
+ * - POST /api/inference/batch - Infer device images, results streamed as NDJSON
+ *
+ * With several cameras on the context, /snapshot, /stream/raw,
+ * /stream/annotated, /stream/video and /api/results take ?camera=N;
+ * without it they
+ * serve camera 0 (or the last image sent through the API when no camera
+ * runs). /api/stats and /api/cameras report every running camera.
+ *
+ * By default the server runs libmicrohttpd's epoll (or poll) loop on a
+ * small thread pool ("server.mode"/"server.threads" options). MJPEG
+ * clients that are waiting for the next frame are suspended and resumed
+ * by the frame store's commit notification, so idle viewers cost no
+ * thread and no polling. "server.mode" "threads" restores one thread per
+ * connection, blocking on the frame store between frames.
+ *
+ * /stream/video carries one shared encoder's output per camera
+ * (video_encoder.h): the init segment, then a fragment per frame from
+ * the next keyframe on. Browsers play it through Media Source
+ * Extensions; the stream ends when the encoder restarts with new
+ * parameters, and the client reconnects.
+ *
+ * /api/inference/batch streams an image batch (image_batch.h) the same
+ * way: the connection is suspended until the next result line is ready.
+ * /api/inference/image suspends its connection after queueing the image
+ * and is resumed by the request's completion callback.
+ *
+ * With the "frame_ring" option the camera pipelines publish every frame
+ * into a shared-memory ring (frame_ring.h) instead of the rate-limited
+ * frame file, and /frame/latest serves the JPEG cache directly.
  *
  * (c) CiRA Robotics / KMITL 2026
  */
 
 #include "cira.h"
 #include "cira_internal.h"
+#include "frame_queue.h"
+#include "jpeg_cache.h"
+#include "jpeg_encoder.h"
+#include "frame_ring.h"
+#include "image_batch.h"
+#include "image_decoder.h"
+#include "result_log.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -27,25 +67,22 @@
 
 #ifdef _WIN32
 #include <windows.h>
-#define usleep(x) Sleep((x) / 1000)
 #define strcasecmp _stricmp
 #else
 #include <unistd.h>
 #include <strings.h>
 #endif
 
-/* JPEG encoder functions (from jpeg_encoder.cpp) */
-extern int jpeg_encode(const uint8_t* rgb_data, int width, int height,
-                       int quality, uint8_t** out_data, size_t* out_size);
-extern int jpeg_encode_annotated(cira_ctx* ctx, const uint8_t* rgb_data,
-                                  int width, int height, int quality,
-                                  uint8_t** out_data, size_t* out_size);
-
 /* Content types */
 #define CT_JSON "application/json"
 #define CT_JPEG "image/jpeg"
 #define CT_MJPEG "multipart/x-mixed-replace; boundary=frame"
 #define CT_TEXT "text/plain"
+#define CT_SSE "text/event-stream"
+#define CT_BINARY "application/octet-stream"
+#define CT_METRICS "text/plain; version=0.0.4"
+#define CT_MP4 "video/mp4"
+#define CT_NDJSON "application/x-ndjson"
 
 /* MJPEG boundary */
 #define MJPEG_BOUNDARY "--frame\r\nContent-Type: image/jpeg\r\n\r\n"
@@ -53,12 +90,53 @@ extern int jpeg_encode_annotated(cira_ctx* ctx, const uint8_t* rgb_data,
 /* Maximum response buffer size */
 #define MAX_RESPONSE_SIZE 65536
 
+/* Largest POST body accepted (images uploaded to /api/inference/image) */
+#define MAX_POST_SIZE (32 * 1024 * 1024)
+
+typedef struct stream_ctx stream_ctx_t;
+typedef struct sse_event sse_event_t;
+typedef struct sse_client sse_client_t;
+typedef struct inference_wait inference_wait_t;
+
+/* Server-sent events kept for subscribers that fall behind */
+#define SSE_HISTORY 64
+
+/* Counters in a stats event: context totals plus four per camera */
+#define SSE_MAX_COUNTERS (8 + CIRA_MAX_CAMERAS * 5)
+
+/* One stats counter, kept formatted so deltas compare the sent text */
+typedef struct {
+    char key[32];
+    char value[24];
+} sse_counter_t;
+
 /* Server state */
 typedef struct {
     struct MHD_Daemon* daemon;
     cira_ctx* ctx;
     int port;
     int running;
+    int event_mode;                 /* 1: event loop + pool, streams suspend between frames */
+    int threads;                    /* Pool size in event mode */
+    pthread_mutex_t waiter_mutex;   /* Guards the waiter lists and the stream counts */
+    stream_ctx_t* waiters;          /* Suspended MJPEG and video streams */
+    inference_wait_t* inference_waiters;  /* Suspended /api/inference/image requests */
+    int streams;                    /* Open MJPEG and video streams */
+    int parked;                     /* Streams currently suspended */
+
+    /* Server-sent results (/api/results/stream) */
+    pthread_mutex_t sse_mutex;      /* Guards everything below and event refcounts */
+    pthread_cond_t sse_cond;        /* Thread mode: a new event was published */
+    sse_event_t* sse_history[SSE_HISTORY];  /* Event n lives in slot n % SSE_HISTORY */
+    uint64_t sse_last_id;           /* Newest event, 0 if none */
+    uint64_t sse_events;            /* Events published */
+    sse_client_t* sse_waiters;      /* Suspended subscribers (event mode) */
+    int sse_clients;                /* Open subscribers */
+    int sse_stats_clients;          /* Subscribers that asked for stats */
+    int sse_parked;                 /* Subscribers currently suspended */
+    double sse_stats_ms;            /* When the last stats event was built */
+    sse_counter_t sse_counters[SSE_MAX_COUNTERS];  /* Values of the last stats event */
+    int sse_num_counters;
 } server_state_t;
 
 /* Global server state (one per context) */
@@ -90,39 +168,15 @@ static const char* get_temp_dir(void) {
     return g_temp_dir;
 }
 
+/* JPEG qualities per consumer (each is a separate cache variant) */
+#define FRAME_FILE_QUALITY 85
+#define SNAPSHOT_QUALITY 90
+
 /**
- * Write current frame to temp file atomically.
+ * Write encoded JPEG to the frame file atomically.
  * Uses write-to-temp + rename pattern for atomic updates.
- *
- * @param ctx Context with frame data
- * @param annotated 1 for annotated frame, 0 for raw
- * @return CIRA_OK on success
  */
-int cira_write_frame_file(cira_ctx* ctx, int annotated) {
-    if (!ctx) return CIRA_ERROR_INPUT;
-
-    /* Get frame data */
-    int w, h;
-    const uint8_t* frame = cira_get_frame(ctx, &w, &h);
-    if (!frame || w <= 0 || h <= 0) {
-        return CIRA_ERROR;  /* No frame available */
-    }
-
-    /* Encode to JPEG */
-    uint8_t* jpeg;
-    size_t jpeg_size;
-    int ret;
-
-    if (annotated) {
-        ret = jpeg_encode_annotated(ctx, frame, w, h, 85, &jpeg, &jpeg_size);
-    } else {
-        ret = jpeg_encode(frame, w, h, 85, &jpeg, &jpeg_size);
-    }
-
-    if (ret != CIRA_OK || !jpeg || jpeg_size == 0) {
-        return CIRA_ERROR;
-    }
-
+static int write_jpeg_file(cira_ctx* ctx, const uint8_t* jpeg, size_t jpeg_size) {
     /* Build temp file path */
     char temp_path[512];
     char final_path[512];
@@ -169,6 +223,145 @@ int cira_write_frame_file(cira_ctx* ctx, int annotated) {
     return CIRA_OK;
 }
 
+/**
+ * Write a frame store slot to the frame file (encoded via the JPEG cache).
+ *
+ * @param ctx Context
+ * @param cam Camera whose detections annotate the frame (NULL for context results)
+ * @param slot Referenced slot of the context frame store
+ * @param annotated 1 for annotated frame, 0 for raw
+ * @return CIRA_OK on success
+ */
+int cira_write_frame_file_slot(cira_ctx* ctx, cira_camera_t* cam, frame_slot_t* slot,
+                               int annotated) {
+    if (!ctx || !slot) return CIRA_ERROR_INPUT;
+
+    jpeg_buf_t* jb = jpeg_cache_get(ctx->jpeg_cache, ctx, cam, slot, annotated,
+                                    FRAME_FILE_QUALITY);
+    if (!jb) return CIRA_ERROR;
+
+    size_t jpeg_size;
+    const uint8_t* jpeg = jpeg_buf_data(jb, &jpeg_size);
+    int ret = write_jpeg_file(ctx, jpeg, jpeg_size);
+
+    jpeg_buf_release(jb);
+    return ret;
+}
+
+/**
+ * Write current frame to temp file atomically.
+ *
+ * @param ctx Context with frame data
+ * @param annotated 1 for annotated frame, 0 for raw
+ * @return CIRA_OK on success
+ */
+int cira_write_frame_file(cira_ctx* ctx, int annotated) {
+    if (!ctx) return CIRA_ERROR_INPUT;
+
+    frame_slot_t* slot = frame_store_acquire(ctx->frame_store);
+    if (!slot) {
+        return CIRA_ERROR;  /* No frame available */
+    }
+
+    cira_camera_t* cam = ctx->cameras[0].running ? &ctx->cameras[0] : NULL;
+    int ret = cira_write_frame_file_slot(ctx, cam, slot, annotated);
+    frame_store_release(slot);
+    return ret;
+}
+
+/**
+ * Write a caller-owned RGB frame to the frame file.
+ * Used by the camera publish stage for frames that did not get a frame
+ * store slot (these bypass the JPEG cache).
+ */
+int cira_write_frame_file_rgb(cira_ctx* ctx, cira_camera_t* cam, const uint8_t* frame,
+                              int w, int h, int annotated) {
+    if (!ctx || !frame || w <= 0 || h <= 0) return CIRA_ERROR_INPUT;
+
+    /* Encode to JPEG */
+    uint8_t* jpeg;
+    size_t jpeg_size;
+    int ret;
+
+    if (annotated) {
+        ret = jpeg_encode_annotated(ctx, cam, frame, w, h, FRAME_FILE_QUALITY, &jpeg, &jpeg_size);
+    } else {
+        ret = jpeg_encode(frame, w, h, FRAME_FILE_QUALITY, &jpeg, &jpeg_size);
+    }
+
+    if (ret != CIRA_OK || !jpeg || jpeg_size == 0) {
+        return CIRA_ERROR;
+    }
+
+    return write_jpeg_file(ctx, jpeg, jpeg_size);
+}
+
+/**
+ * Publish a camera frame and its latest detections to the frame ring.
+ * Called by the camera publish stage for every frame while the ring is on.
+ *
+ * @param ctx Context owning the ring
+ * @param cam Camera the frame came from
+ * @param slot Referenced slot of the camera's frame store, or NULL
+ * @param rgb Caller-owned RGB frame, used when slot is NULL
+ * @param w Width of rgb
+ * @param h Height of rgb
+ * @return CIRA_OK on success
+ */
+int cira_publish_frame_ring(cira_ctx* ctx, cira_camera_t* cam, frame_slot_t* slot,
+                            const uint8_t* rgb, int w, int h) {
+    if (!ctx || !ctx->frame_ring || !cam) return CIRA_ERROR_INPUT;
+
+    frame_ring_detection_t dets[CIRA_MAX_DETECTIONS];
+    pthread_mutex_lock(&ctx->result_mutex);
+    int count = cam->num_detections;
+    for (int i = 0; i < count; i++) {
+        const cira_detection_t* d = &cam->detections[i];
+        dets[i].x = d->x;
+        dets[i].y = d->y;
+        dets[i].w = d->w;
+        dets[i].h = d->h;
+        dets[i].confidence = d->confidence;
+        dets[i].label_id = d->label_id;
+    }
+    pthread_mutex_unlock(&ctx->result_mutex);
+
+    if (slot) {
+        rgb = frame_slot_data(slot, &w, &h, NULL);
+    }
+    if (!rgb || w <= 0 || h <= 0) return CIRA_ERROR_INPUT;
+
+    const void* data = rgb;
+    size_t size = (size_t)w * h * 3;
+    jpeg_buf_t* jb = NULL;
+
+    if (ctx->frame_ring_format == FRAME_RING_FORMAT_JPEG) {
+        if (slot) {
+            /* Shares the encode with any viewer asking for the same variant */
+            jb = jpeg_cache_get(cam->jpeg_cache, ctx, cam, slot, 1, FRAME_FILE_QUALITY);
+            if (!jb) return CIRA_ERROR;
+            data = jpeg_buf_data(jb, &size);
+        } else {
+            uint8_t* jpeg;
+            if (jpeg_encode_annotated(ctx, cam, rgb, w, h, FRAME_FILE_QUALITY,
+                                      &jpeg, &size) != CIRA_OK || !jpeg) {
+                return CIRA_ERROR;
+            }
+            data = jpeg;
+        }
+    }
+
+    uint64_t seq = frame_ring_publish(ctx->frame_ring, cam->index, ctx->frame_ring_format,
+                                      w, h, data, size, dets, count);
+    if (jb) jpeg_buf_release(jb);
+
+    if (seq == 0) {
+        ctx->frame_ring_oversize++;
+        return CIRA_ERROR;
+    }
+    return CIRA_OK;
+}
+
 /* Set models directory for model listing */
 void server_set_models_dir(const char* dir) {
     if (dir) {
@@ -176,18 +369,174 @@ void server_set_models_dir(const char* dir) {
     }
 }
 
-/* MJPEG streaming context */
+/* Frames and annotations a request reads from */
 typedef struct {
+    int camera;             /* ?camera=N, or -1 for the default source */
+    frame_store_t* store;
+    jpeg_cache_t* cache;
+} frame_source_t;
+
+/**
+ * Resolve ?camera=N. Without it, the context store: camera 0's frames, or
+ * the last image sent through the API when camera 0 is not running.
+ *
+ * @return 1 on success, 0 for a bad camera number or one never started
+ */
+static int get_frame_source(struct MHD_Connection* conn, cira_ctx* ctx, frame_source_t* src) {
+    const char* arg = MHD_lookup_connection_value(conn, MHD_GET_ARGUMENT_KIND, "camera");
+
+    src->camera = -1;
+    src->store = ctx->frame_store;
+    src->cache = ctx->jpeg_cache;
+    if (!arg) return 1;
+
+    char* end;
+    long camera = strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || camera < 0 || camera >= CIRA_MAX_CAMERAS) return 0;
+    if (!ctx->cameras[camera].frame_store) return 0;
+
+    src->camera = (int)camera;
+    src->store = ctx->cameras[camera].frame_store;
+    src->cache = ctx->cameras[camera].jpeg_cache;
+    return 1;
+}
+
+/* Camera whose detections annotate the source (NULL for context results) */
+static cira_camera_t* source_camera(cira_ctx* ctx, const frame_source_t* src) {
+    if (src->camera >= 0) return &ctx->cameras[src->camera];
+    return ctx->cameras[0].running ? &ctx->cameras[0] : NULL;
+}
+
+/* 404 for an unknown ?camera=N */
+static int handle_bad_camera(struct MHD_Connection* conn) {
+    const char* error = "{\"error\":\"Unknown camera\"}";
+    struct MHD_Response* response = MHD_create_response_from_buffer(
+        strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+    MHD_add_response_header(response, "Content-Type", CT_JSON);
+    MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+    int ret = MHD_queue_response(conn, MHD_HTTP_NOT_FOUND, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
+/* JSON reply with CORS, copied */
+static int send_json(struct MHD_Connection* conn, unsigned int status, const char* json) {
+    struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+        strlen(json), (void*)json, MHD_RESPMEM_MUST_COPY);
+    MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
+    MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+    int ret = MHD_queue_response(conn, status, mhd_response);
+    MHD_destroy_response(mhd_response);
+    return ret;
+}
+
+/* MJPEG stream quality */
+#define STREAM_QUALITY 80
+
+/* Longest a thread-per-connection stream blocks before re-checking the server */
+#define STREAM_WAIT_MS 100
+
+/* MJPEG streaming context */
+struct stream_ctx {
     cira_ctx* ctx;
+    struct MHD_Connection* conn;
+    frame_source_t src;     /* Camera being streamed */
     int annotated;          /* 1 for annotated, 0 for raw */
     int frame_sent;         /* Number of frames sent */
     int header_sent;        /* Boundary header sent for current frame */
-    uint8_t* jpeg_data;     /* Current JPEG data */
+    jpeg_buf_t* jpeg;       /* Current JPEG (shared with other clients via the cache) */
+    const uint8_t* jpeg_data;
     size_t jpeg_size;       /* Current JPEG size */
     size_t jpeg_offset;     /* Bytes sent from current frame */
-} stream_ctx_t;
+    uint64_t last_seq;      /* Sequence of the last frame sent */
+    int suspended;          /* On the server's waiter list (event mode) */
+    stream_ctx_t* next_waiter;
+
+    /* /stream/video only */
+    video_encoder_t* video; /* Encoder streamed (NULL for MJPEG) */
+    video_segment_t* segment;   /* Segment being sent */
+    uint64_t generation;    /* Init segment sent, 0 before it */
+    uint64_t cursor;        /* Last fragment sent or skipped */
+    int started;            /* A keyframe went out */
+
+    /* /api/inference/batch only */
+    image_batch_t* batch;   /* Batch whose result lines are streamed */
+};
+
+/* Drop the current JPEG reference */
+static void stream_release_jpeg(stream_ctx_t* sctx) {
+    if (sctx->jpeg) {
+        jpeg_buf_release(sctx->jpeg);
+        sctx->jpeg = NULL;
+    }
+    sctx->jpeg_data = NULL;
+    sctx->jpeg_size = 0;
+    sctx->jpeg_offset = 0;
+}
 
-/* MJPEG stream callback for libmicrohttpd */
+/* Resume suspended streams of one frame store, video encoder or image
+ * batch (all if NULL). Caller holds waiter_mutex. */
+static void resume_waiters(server_state_t* srv, const void* source) {
+    stream_ctx_t** pp = &srv->waiters;
+    while (*pp) {
+        stream_ctx_t* w = *pp;
+        const void* waits_on = w->batch ? (const void*)w->batch
+                             : w->video ? (const void*)w->video : (const void*)w->src.store;
+        if (source && waits_on != source) {
+            pp = &w->next_waiter;
+            continue;
+        }
+        *pp = w->next_waiter;
+        w->next_waiter = NULL;
+        w->suspended = 0;
+        srv->parked--;
+        MHD_resume_connection(w->conn);
+    }
+}
+
+/* Frame store commit callback: wake the streams parked on that store */
+static void stream_notify(void* arg, frame_store_t* store, uint64_t seq) {
+    server_state_t* srv = (server_state_t*)arg;
+    (void)seq;
+    pthread_mutex_lock(&srv->waiter_mutex);
+    resume_waiters(srv, store);
+    pthread_mutex_unlock(&srv->waiter_mutex);
+}
+
+/* Video encoder callback: wake the streams parked on that encoder */
+static void video_notify(void* arg, video_encoder_t* enc) {
+    server_state_t* srv = (server_state_t*)arg;
+    pthread_mutex_lock(&srv->waiter_mutex);
+    resume_waiters(srv, enc);
+    pthread_mutex_unlock(&srv->waiter_mutex);
+}
+
+/*
+ * No new frame for this client yet. In event mode the connection is
+ * suspended until the store publishes, freeing the pool thread for other
+ * connections; otherwise this connection's own thread blocks on the store.
+ */
+static void stream_wait_frame(stream_ctx_t* sctx) {
+    server_state_t* srv = g_server;
+    if (!srv || !srv->event_mode) {
+        frame_store_wait(sctx->src.store, sctx->last_seq, STREAM_WAIT_MS);
+        return;
+    }
+
+    pthread_mutex_lock(&srv->waiter_mutex);
+    /* Re-check under the lock the notify callback takes: no lost wakeups */
+    if (srv->running && frame_store_sequence(sctx->src.store) == sctx->last_seq) {
+        sctx->next_waiter = srv->waiters;
+        srv->waiters = sctx;
+        sctx->suspended = 1;
+        srv->parked++;
+        MHD_suspend_connection(sctx->conn);
+    }
+    pthread_mutex_unlock(&srv->waiter_mutex);
+}
+
+/* MJPEG stream callback for libmicrohttpd.
+ * Returns 0 only after stream_wait_frame(), so event mode never spins. */
 static ssize_t stream_callback(void* cls, uint64_t pos, char* buf, size_t max) {
     (void)pos;
     stream_ctx_t* sctx = (stream_ctx_t*)cls;
@@ -202,53 +551,48 @@ static ssize_t stream_callback(void* cls, uint64_t pos, char* buf, size_t max) {
     }
 
     /* If we haven't sent a frame yet, or finished the current frame */
-    if (sctx->jpeg_data == NULL || sctx->jpeg_offset >= sctx->jpeg_size) {
-        /* Free previous frame data if any */
-        if (sctx->jpeg_data) {
-            free(sctx->jpeg_data);
-            sctx->jpeg_data = NULL;
+    if (sctx->jpeg == NULL || sctx->jpeg_offset >= sctx->jpeg_size) {
+        stream_release_jpeg(sctx);
+
+        /* Get new frame (refcounted - cannot be overwritten while encoding) */
+        frame_slot_t* slot = frame_store_acquire(sctx->src.store);
+        if (!slot) {
+            /* No frame published yet */
+            stream_wait_frame(sctx);
+            return 0;
         }
 
-        /* Get new frame */
-        int w, h;
-        const uint8_t* frame = cira_get_frame(sctx->ctx, &w, &h);
-
-        if (!frame || w <= 0 || h <= 0) {
-            /* No frame available, wait a bit and return empty */
-            usleep(10000);  /* 10ms */
+        uint64_t seq;
+        frame_slot_data(slot, NULL, NULL, &seq);
+        if (seq == sctx->last_seq) {
+            /* Already sent this frame - wait for the next capture */
+            frame_store_release(slot);
+            stream_wait_frame(sctx);
             return 0;
         }
 
-        /* Encode frame to JPEG (returns pointer to shared internal buffer) */
-        uint8_t* jpeg_ptr;
-        size_t jpeg_size;
-        int ret;
-
-        if (sctx->annotated) {
-            ret = jpeg_encode_annotated(sctx->ctx, frame, w, h, 80, &jpeg_ptr, &jpeg_size);
-            /* Fallback to raw encoding if annotated fails */
-            if (ret != CIRA_OK || !jpeg_ptr || jpeg_size == 0) {
-                ret = jpeg_encode(frame, w, h, 80, &jpeg_ptr, &jpeg_size);
-            }
-        } else {
-            ret = jpeg_encode(frame, w, h, 80, &jpeg_ptr, &jpeg_size);
+        /* Encoded at most once per frame, shared by every client */
+        cira_camera_t* cam = source_camera(sctx->ctx, &sctx->src);
+        jpeg_buf_t* jb = jpeg_cache_get(sctx->src.cache, sctx->ctx, cam, slot,
+                                        sctx->annotated, STREAM_QUALITY);
+        /* Fallback to raw encoding if annotated fails */
+        if (!jb && sctx->annotated) {
+            jb = jpeg_cache_get(sctx->src.cache, sctx->ctx, cam, slot, 0, STREAM_QUALITY);
         }
+        frame_store_release(slot);
 
-        if (ret != CIRA_OK || !jpeg_ptr || jpeg_size == 0) {
-            usleep(10000);
+        if (!jb) {
+            /* Skip this frame and wait for the next one */
+            sctx->last_seq = seq;
+            stream_wait_frame(sctx);
             return 0;
         }
 
-        /* Copy JPEG data to our own buffer (encoder uses shared buffer) */
-        sctx->jpeg_data = (uint8_t*)malloc(jpeg_size);
-        if (!sctx->jpeg_data) {
-            usleep(10000);
-            return 0;
-        }
-        memcpy(sctx->jpeg_data, jpeg_ptr, jpeg_size);
-        sctx->jpeg_size = jpeg_size;
+        sctx->jpeg = jb;
+        sctx->jpeg_data = jpeg_buf_data(jb, &sctx->jpeg_size);
         sctx->jpeg_offset = 0;
         sctx->header_sent = 0;
+        sctx->last_seq = seq;
     }
 
     size_t written = 0;
@@ -286,27 +630,474 @@ static ssize_t stream_callback(void* cls, uint64_t pos, char* buf, size_t max) {
         buf[written++] = '\r';
         buf[written++] = '\n';
         sctx->frame_sent++;
-        /* Free current frame and mark for next frame */
-        free(sctx->jpeg_data);
-        sctx->jpeg_data = NULL;
+        /* Release current frame and mark for next frame */
+        stream_release_jpeg(sctx);
     }
 
     return (ssize_t)written;
 }
 
+/* No fragment after the cursor yet: as stream_wait_frame(), on the encoder */
+static void video_wait_fragment(stream_ctx_t* sctx) {
+    server_state_t* srv = g_server;
+    if (!srv || !srv->event_mode) {
+        video_encoder_wait(sctx->video, sctx->cursor, STREAM_WAIT_MS);
+        return;
+    }
+
+    pthread_mutex_lock(&srv->waiter_mutex);
+    if (srv->running && video_encoder_sequence(sctx->video) == sctx->cursor) {
+        sctx->next_waiter = srv->waiters;
+        srv->waiters = sctx;
+        sctx->suspended = 1;
+        srv->parked++;
+        MHD_suspend_connection(sctx->conn);
+    }
+    pthread_mutex_unlock(&srv->waiter_mutex);
+}
+
+/* Fragmented MP4 stream callback: the init segment, then fragments from a
+ * keyframe on. Returns 0 only after video_wait_fragment(). */
+static ssize_t video_callback(void* cls, uint64_t pos, char* buf, size_t max) {
+    (void)pos;
+    stream_ctx_t* sctx = (stream_ctx_t*)cls;
+
+    if (!sctx || !sctx->video) {
+        return MHD_CONTENT_READER_END_WITH_ERROR;
+    }
+    if (!g_server || !g_server->running) {
+        return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+
+    while (!sctx->segment) {
+        video_segment_t* seg;
+        if (sctx->generation == 0) {
+            seg = video_encoder_init_segment(sctx->video);
+            if (!seg) {
+                video_wait_fragment(sctx);
+                return 0;
+            }
+            sctx->generation = video_segment_generation(seg);
+        } else {
+            seg = video_encoder_next(sctx->video, &sctx->cursor, !sctx->started);
+            if (!seg) {
+                video_wait_fragment(sctx);
+                return 0;
+            }
+            uint64_t generation = video_segment_generation(seg);
+            if (generation < sctx->generation) {
+                /* Published before the init segment we sent */
+                video_segment_release(seg);
+                continue;
+            }
+            if (generation > sctx->generation) {
+                /* Encoder restarted: the client reconnects for the new init segment */
+                video_segment_release(seg);
+                return MHD_CONTENT_READER_END_OF_STREAM;
+            }
+            sctx->started = 1;
+        }
+        sctx->segment = seg;
+        sctx->jpeg_data = video_segment_data(seg, &sctx->jpeg_size);
+        sctx->jpeg_offset = 0;
+    }
+
+    size_t remaining = sctx->jpeg_size - sctx->jpeg_offset;
+    size_t to_send = remaining < max ? remaining : max;
+    memcpy(buf, sctx->jpeg_data + sctx->jpeg_offset, to_send);
+    sctx->jpeg_offset += to_send;
+
+    if (sctx->jpeg_offset >= sctx->jpeg_size) {
+        video_segment_release(sctx->segment);
+        sctx->segment = NULL;
+        sctx->frame_sent++;
+    }
+    return (ssize_t)to_send;
+}
+
 /* Cleanup callback for stream context */
 static void stream_free_callback(void* cls) {
     stream_ctx_t* sctx = (stream_ctx_t*)cls;
     if (sctx) {
-        /* Free the copied JPEG data if any */
-        if (sctx->jpeg_data) {
-            free(sctx->jpeg_data);
-            sctx->jpeg_data = NULL;
+        server_state_t* srv = g_server;
+        if (srv) {
+            pthread_mutex_lock(&srv->waiter_mutex);
+            if (sctx->suspended) {
+                stream_ctx_t** pp = &srv->waiters;
+                while (*pp && *pp != sctx) pp = &(*pp)->next_waiter;
+                if (*pp) *pp = sctx->next_waiter;
+                srv->parked--;
+            }
+            srv->streams--;
+            pthread_mutex_unlock(&srv->waiter_mutex);
+        }
+        stream_release_jpeg(sctx);
+        if (sctx->video) {
+            video_segment_release(sctx->segment);
+            video_encoder_unsubscribe(sctx->video);
         }
+        /* Off the waiter list, so its notifies find nothing to resume */
+        image_batch_destroy(sctx->batch);
         free(sctx);
     }
 }
 
+/* === Server-sent results (/api/results/stream) === */
+
+/* Stats events are pushed at most this often */
+#define SSE_STATS_INTERVAL_MS 1000
+
+/* Room for the event framing around a result JSON */
+#define SSE_RESULT_HEADROOM 160
+
+/* Sent first so browsers reconnect quickly after a server restart */
+static const char SSE_PREAMBLE[] = "retry: 1000\n\n";
+
+/*
+ * One serialized event, shared by every subscriber. Stats events carry a
+ * second rendering right after the first with only the counters that
+ * changed since the previous stats event.
+ */
+struct sse_event {
+    int refs;               /* History slot + subscribers sending it (sse_mutex) */
+    uint64_t id;            /* SSE "id:" field */
+    int camera;             /* Result camera, -1 for API predictions */
+    int stats;              /* 1 for stats events */
+    size_t size;            /* Bytes of the full event at data */
+    size_t delta_size;      /* Stats only: bytes of the delta at data + size, 0 if no change */
+    char data[];
+};
+
+/* Subscriber of /api/results/stream */
+struct sse_client {
+    struct MHD_Connection* conn;
+    int camera;             /* Results of this camera only, -1 for all */
+    int stats;              /* Also receive stats events */
+    int delta;              /* After the first, stats as changed counters only */
+    int stats_sent;         /* A full stats event went out */
+    uint64_t last_id;       /* Last event taken */
+    sse_event_t* event;     /* Event being sent (NULL for the preamble) */
+    const char* data;       /* Bytes being sent, NULL between events */
+    size_t size;
+    size_t offset;
+    int suspended;          /* On sse_waiters (event mode) */
+    sse_client_t* next_waiter;
+};
+
+static double sse_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* Drop a reference (caller holds sse_mutex) */
+static void sse_unref_locked(sse_event_t* ev) {
+    if (ev && --ev->refs == 0) {
+        free(ev);
+    }
+}
+
+/* Resume every suspended subscriber (caller holds sse_mutex) */
+static void sse_resume_locked(server_state_t* srv) {
+    while (srv->sse_waiters) {
+        sse_client_t* c = srv->sse_waiters;
+        srv->sse_waiters = c->next_waiter;
+        c->next_waiter = NULL;
+        c->suspended = 0;
+        srv->sse_parked--;
+        MHD_resume_connection(c->conn);
+    }
+}
+
+/* Make ev the newest event and wake subscribers (caller holds sse_mutex).
+ * ev->id must be sse_last_id + 1; the history takes the caller's reference. */
+static void sse_publish_locked(server_state_t* srv, sse_event_t* ev) {
+    sse_event_t** slot = &srv->sse_history[ev->id % SSE_HISTORY];
+    sse_unref_locked(*slot);
+    *slot = ev;
+    srv->sse_last_id = ev->id;
+    srv->sse_events++;
+
+    sse_resume_locked(srv);
+    pthread_cond_broadcast(&srv->sse_cond);
+}
+
+static void sse_counter_u64(sse_counter_t* c, int* n, const char* key, uint64_t value) {
+    if (*n >= SSE_MAX_COUNTERS) return;
+    snprintf(c[*n].key, sizeof(c[*n].key), "%s", key);
+    snprintf(c[*n].value, sizeof(c[*n].value), "%llu", (unsigned long long)value);
+    (*n)++;
+}
+
+static void sse_counter_f1(sse_counter_t* c, int* n, const char* key, float value) {
+    if (*n >= SSE_MAX_COUNTERS) return;
+    snprintf(c[*n].key, sizeof(c[*n].key), "%s", key);
+    snprintf(c[*n].value, sizeof(c[*n].value), "%.1f", value);
+    (*n)++;
+}
+
+/* Snapshot the live counters (caller holds result_mutex) */
+static int sse_collect_stats(cira_ctx* ctx, sse_counter_t* c) {
+    int n = 0;
+    float inference_fps = 0.0f;
+    char key[32];
+
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        const cira_camera_t* cam = &ctx->cameras[i];
+        if (!cam->running) continue;
+        inference_fps += cam->inference_fps;
+        snprintf(key, sizeof(key), "cameras.%d.fps", i);
+        sse_counter_f1(c, &n, key, cam->current_fps);
+        snprintf(key, sizeof(key), "cameras.%d.inference_fps", i);
+        sse_counter_f1(c, &n, key, cam->inference_fps);
+        snprintf(key, sizeof(key), "cameras.%d.frames", i);
+        sse_counter_u64(c, &n, key, cam->total_frames);
+        snprintf(key, sizeof(key), "cameras.%d.detections", i);
+        sse_counter_u64(c, &n, key, cam->total_detections);
+        snprintf(key, sizeof(key), "cameras.%d.gate_skipped", i);
+        sse_counter_u64(c, &n, key, cam->gate_skipped);
+    }
+
+    sse_counter_u64(c, &n, "total_frames", ctx->total_frames);
+    sse_counter_u64(c, &n, "total_detections", ctx->total_detections);
+    sse_counter_f1(c, &n, "fps", cira_get_fps(ctx));
+    sse_counter_f1(c, &n, "inference_fps", inference_fps);
+    sse_counter_u64(c, &n, "frames_skipped", ctx->skipped_frames);
+    sse_counter_u64(c, &n, "predict_allocations", ctx->predict_allocations);
+    sse_counter_u64(c, &n, "model_reloads", ctx->reload_count);
+    sse_counter_u64(c, &n, "uptime_sec", (uint64_t)(time(NULL) - ctx->start_time));
+    return n;
+}
+
+/* Render counters as one event; with prev, only those that differ from it */
+static size_t sse_render_stats(char* out, size_t cap, uint64_t id, const char* name,
+                               const sse_counter_t* c, int n,
+                               const sse_counter_t* prev, int prev_n) {
+    char* p = out;
+    char* end = out + cap;
+    int count = 0;
+
+    p += snprintf(p, end - p, "id: %llu\nevent: %s\ndata: {", (unsigned long long)id, name);
+    for (int i = 0; i < n; i++) {
+        if (prev) {
+            int same = 0;
+            for (int j = 0; j < prev_n; j++) {
+                if (strcmp(prev[j].key, c[i].key) == 0) {
+                    same = strcmp(prev[j].value, c[i].value) == 0;
+                    break;
+                }
+            }
+            if (same) continue;
+        }
+        p += snprintf(p, end - p, "%s\"%s\":%s", count ? "," : "", c[i].key, c[i].value);
+        count++;
+    }
+    p += snprintf(p, end - p, "}\n\n");
+
+    return (prev && count == 0) ? 0 : (size_t)(p - out);
+}
+
+/* Publish a stats event (caller holds result_mutex and sse_mutex) */
+static void sse_publish_stats_locked(server_state_t* srv, cira_ctx* ctx) {
+    sse_counter_t counters[SSE_MAX_COUNTERS];
+    int n = sse_collect_stats(ctx, counters);
+
+    /* Key and value are quoted or bounded: 64 bytes per counter is plenty */
+    size_t cap = 64 + (size_t)n * 64;
+    sse_event_t* ev = (sse_event_t*)malloc(sizeof(sse_event_t) + 2 * cap);
+    if (!ev) return;
+
+    ev->refs = 1;
+    ev->id = srv->sse_last_id + 1;
+    ev->camera = -1;
+    ev->stats = 1;
+    ev->size = sse_render_stats(ev->data, cap, ev->id, "stats", counters, n, NULL, 0);
+    ev->delta_size = sse_render_stats(ev->data + ev->size, cap, ev->id, "stats_delta",
+                                      counters, n, srv->sse_counters, srv->sse_num_counters);
+
+    memcpy(srv->sse_counters, counters, (size_t)n * sizeof(sse_counter_t));
+    srv->sse_num_counters = n;
+    sse_publish_locked(srv, ev);
+}
+
+/*
+ * Result notification from the core (result_mutex held): serialize the
+ * new result once and hand the same buffer to every subscriber.
+ */
+static void sse_result_notify(void* arg, cira_ctx* ctx, cira_camera_t* cam, uint64_t frame_seq) {
+    server_state_t* srv = (server_state_t*)arg;
+
+    pthread_mutex_lock(&srv->sse_mutex);
+    if (srv->sse_clients == 0) {
+        pthread_mutex_unlock(&srv->sse_mutex);
+        return;
+    }
+
+    /* Builds the JSON now if nobody has read this result yet */
+    const char* json = cira_result_json_locked(ctx, cam ? cam->index : -1);
+    size_t len = strlen(json);
+    sse_event_t* ev = (sse_event_t*)malloc(sizeof(sse_event_t) + len + SSE_RESULT_HEADROOM);
+    if (ev && len > 1 && json[0] == '{') {
+        ev->refs = 1;
+        ev->id = srv->sse_last_id + 1;
+        ev->camera = cam ? cam->index : -1;
+        ev->stats = 0;
+        ev->delta_size = 0;
+
+        /* Tag the result JSON in place of its opening brace */
+        int n = snprintf(ev->data, SSE_RESULT_HEADROOM,
+            "id: %llu\nevent: result\ndata: {\"camera\":%d,\"frame_sequence\":%llu,"
+            "\"result_sequence\":%llu,",
+            (unsigned long long)ev->id, ev->camera, (unsigned long long)frame_seq,
+            (unsigned long long)ctx->result_sequence);
+        memcpy(ev->data + n, json + 1, len - 1);
+        memcpy(ev->data + n + len - 1, "\n\n", 2);
+        ev->size = (size_t)n + len + 1;
+        sse_publish_locked(srv, ev);
+    } else {
+        free(ev);
+    }
+
+    double now = sse_now_ms();
+    if (srv->sse_stats_clients > 0 && now - srv->sse_stats_ms >= SSE_STATS_INTERVAL_MS) {
+        srv->sse_stats_ms = now;
+        sse_publish_stats_locked(srv, ctx);
+    }
+    pthread_mutex_unlock(&srv->sse_mutex);
+}
+
+/*
+ * Take the next event this subscriber wants (caller holds sse_mutex).
+ * Subscribers more than SSE_HISTORY events behind skip to the oldest kept.
+ */
+static int sse_take_locked(server_state_t* srv, sse_client_t* c) {
+    while (c->last_id < srv->sse_last_id) {
+        uint64_t id = c->last_id + 1;
+        if (srv->sse_last_id - id >= SSE_HISTORY) {
+            id = srv->sse_last_id - SSE_HISTORY + 1;
+        }
+        c->last_id = id;
+
+        sse_event_t* ev = srv->sse_history[id % SSE_HISTORY];
+        if (!ev || ev->id != id) continue;
+
+        if (ev->stats) {
+            if (!c->stats) continue;
+            if (c->delta && c->stats_sent) {
+                if (ev->delta_size == 0) continue;  /* Nothing changed */
+                c->data = ev->data + ev->size;
+                c->size = ev->delta_size;
+            } else {
+                c->data = ev->data;
+                c->size = ev->size;
+            }
+            c->stats_sent = 1;
+        } else {
+            if (c->camera >= 0 && ev->camera != c->camera) continue;
+            c->data = ev->data;
+            c->size = ev->size;
+        }
+
+        ev->refs++;
+        c->event = ev;
+        c->offset = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/* No event for this subscriber: park it (event mode) or block briefly */
+static void sse_wait_locked(server_state_t* srv, sse_client_t* c) {
+    if (srv->event_mode) {
+        c->next_waiter = srv->sse_waiters;
+        srv->sse_waiters = c;
+        c->suspended = 1;
+        srv->sse_parked++;
+        MHD_suspend_connection(c->conn);
+        return;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += (long)STREAM_WAIT_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&srv->sse_cond, &srv->sse_mutex, &deadline);
+}
+
+/* SSE content reader. Returns 0 only after sse_wait_locked(), as for MJPEG. */
+static ssize_t sse_callback(void* cls, uint64_t pos, char* buf, size_t max) {
+    (void)pos;
+    sse_client_t* c = (sse_client_t*)cls;
+    server_state_t* srv = g_server;
+
+    if (!srv || !srv->running) {
+        return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+
+    if (!c->data) {
+        pthread_mutex_lock(&srv->sse_mutex);
+        int ready = srv->running && sse_take_locked(srv, c);
+        if (!ready && srv->running) {
+            sse_wait_locked(srv, c);
+        }
+        pthread_mutex_unlock(&srv->sse_mutex);
+        if (!ready) {
+            return 0;
+        }
+    }
+
+    size_t n = c->size - c->offset;
+    if (n > max) n = max;
+    memcpy(buf, c->data + c->offset, n);
+    c->offset += n;
+
+    if (c->offset >= c->size) {
+        if (c->event) {
+            pthread_mutex_lock(&srv->sse_mutex);
+            sse_unref_locked(c->event);
+            pthread_mutex_unlock(&srv->sse_mutex);
+            c->event = NULL;
+        }
+        c->data = NULL;
+    }
+
+    return (ssize_t)n;
+}
+
+static void sse_free_callback(void* cls) {
+    sse_client_t* c = (sse_client_t*)cls;
+    if (!c) return;
+
+    server_state_t* srv = g_server;
+    if (srv) {
+        pthread_mutex_lock(&srv->sse_mutex);
+        if (c->suspended) {
+            sse_client_t** pp = &srv->sse_waiters;
+            while (*pp && *pp != c) pp = &(*pp)->next_waiter;
+            if (*pp) *pp = c->next_waiter;
+            srv->sse_parked--;
+        }
+        sse_unref_locked(c->event);
+        srv->sse_clients--;
+        if (c->stats) srv->sse_stats_clients--;
+        pthread_mutex_unlock(&srv->sse_mutex);
+    }
+    free(c);
+}
+
+/* Release the event history (server stopping, no subscribers left) */
+static void sse_clear(server_state_t* srv) {
+    pthread_mutex_lock(&srv->sse_mutex);
+    for (int i = 0; i < SSE_HISTORY; i++) {
+        sse_unref_locked(srv->sse_history[i]);
+        srv->sse_history[i] = NULL;
+    }
+    pthread_mutex_unlock(&srv->sse_mutex);
+}
+
 /* Helper: Get current timestamp as string */
 static void get_timestamp(char* buf, size_t size) {
     time_t now = time(NULL);
@@ -437,6 +1228,7 @@ static int handle_health(struct MHD_Connection* conn, cira_ctx* ctx) {
         "\"memory_usage\":%.1f,"
         "\"model_loaded\":%s,"
         "\"model_name\":\"%s\","
+        "\"execution_provider\":\"%s\","
         "\"camera_running\":%s,"
         "\"detections\":%d,"
         "\"defects_total\":%llu,"
@@ -451,6 +1243,7 @@ static int handle_health(struct MHD_Connection* conn, cira_ctx* ctx) {
         get_memory_usage(),
         cira_status(ctx) == CIRA_STATUS_READY ? "true" : "false",
         model_name,
+        ctx->execution_provider,
         g_server && g_server->ctx ? "true" : "false",
         cira_result_count(ctx),
         (unsigned long long)ctx->total_detections,
@@ -459,7 +1252,77 @@ static int handle_health(struct MHD_Connection* conn, cira_ctx* ctx) {
 
     struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
         strlen(response), response, MHD_RESPMEM_MUST_COPY);
-
+
+    MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
+    MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+
+    int ret = MHD_queue_response(conn, MHD_HTTP_OK, mhd_response);
+    MHD_destroy_response(mhd_response);
+
+    return ret;
+}
+
+/**
+ * Handle /api/results endpoint.
+ * ?format=bin returns the cira_result_raw() layout instead of JSON.
+ */
+static int handle_results(struct MHD_Connection* conn, cira_ctx* ctx) {
+    frame_source_t src;
+    if (!get_frame_source(conn, ctx, &src)) {
+        return handle_bad_camera(conn);
+    }
+
+    const char* format = MHD_lookup_connection_value(conn, MHD_GET_ARGUMENT_KIND, "format");
+    int binary = format && strcmp(format, "bin") == 0;
+
+    /* Copy under the lock: the scheduler rewrites it every frame */
+    struct MHD_Response* response;
+    char seq[24];
+    pthread_mutex_lock(&ctx->result_mutex);
+    snprintf(seq, sizeof(seq), "%llu", (unsigned long long)ctx->result_sequence);
+    if (binary) {
+        uint8_t raw[CIRA_RESULT_RAW_MAX];
+        int n = cira_result_raw_locked(ctx, src.camera, raw, (int)sizeof(raw));
+        response = MHD_create_response_from_buffer(
+            n > 0 ? (size_t)n : 0, raw, MHD_RESPMEM_MUST_COPY);
+    } else {
+        const char* json = cira_result_json_locked(ctx, src.camera);
+        response = MHD_create_response_from_buffer(
+            strlen(json), (void*)json, MHD_RESPMEM_MUST_COPY);
+    }
+    pthread_mutex_unlock(&ctx->result_mutex);
+
+    MHD_add_response_header(response, "Content-Type", binary ? CT_BINARY : CT_JSON);
+    MHD_add_response_header(response, "X-Result-Sequence", seq);
+    MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+
+    int ret = MHD_queue_response(conn, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+
+    return ret;
+}
+
+/**
+ * Handle /api/labels endpoint - label names by label_id, for consumers of
+ * binary results.
+ */
+static int handle_labels(struct MHD_Connection* conn, cira_ctx* ctx) {
+    char response[MAX_RESPONSE_SIZE];
+    char* p = response;
+    char* end = response + sizeof(response);
+
+    /* Labels change with the model; hot swaps hold result_mutex */
+    pthread_mutex_lock(&ctx->result_mutex);
+    int count = ctx->num_labels;
+    p += snprintf(p, end - p, "{\"labels\":[");
+    for (int i = 0; i < count && p < end - 128; i++) {
+        p += snprintf(p, end - p, "%s\"%s\"", i ? "," : "", ctx->labels[i]);
+    }
+    pthread_mutex_unlock(&ctx->result_mutex);
+    snprintf(p, end - p, "],\"count\":%d}", count);
+
+    struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+        strlen(response), response, MHD_RESPMEM_MUST_COPY);
     MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
     MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
 
@@ -469,17 +1332,83 @@ static int handle_health(struct MHD_Connection* conn, cira_ctx* ctx) {
     return ret;
 }
 
+/* True if a query flag is present and not "0"/"false" */
+static int query_flag(struct MHD_Connection* conn, const char* key) {
+    const char* v = MHD_lookup_connection_value(conn, MHD_GET_ARGUMENT_KIND, key);
+    return v && strcmp(v, "0") != 0 && strcmp(v, "false") != 0;
+}
+
 /**
- * Handle /api/results endpoint.
+ * Handle GET /api/results/stream - server-sent events.
+ *
+ * Every stored result is pushed once as an "result" event (the
+ * /api/results JSON tagged with camera, frame_sequence and
+ * result_sequence). ?camera=N keeps one camera's results, ?stats=1 adds a
+ * "stats" event at most once a second, and ?delta=1 sends stats after the
+ * first as "stats_delta" events holding only the counters that changed.
+ * A reconnecting client's Last-Event-ID resumes from the event history.
  */
-static int handle_results(struct MHD_Connection* conn, cira_ctx* ctx) {
-    const char* json = cira_result_json(ctx);
-    size_t len = strlen(json);
+static int handle_results_stream(struct MHD_Connection* conn, cira_ctx* ctx) {
+    (void)ctx;
+    server_state_t* srv = g_server;
+    if (!srv) return MHD_NO;
+
+    int camera = -1;
+    const char* arg = MHD_lookup_connection_value(conn, MHD_GET_ARGUMENT_KIND, "camera");
+    if (arg) {
+        char* end;
+        long n = strtol(arg, &end, 10);
+        if (end == arg || *end != '\0' || n < 0 || n >= CIRA_MAX_CAMERAS) {
+            return handle_bad_camera(conn);
+        }
+        camera = (int)n;
+    }
 
-    struct MHD_Response* response = MHD_create_response_from_buffer(
-        len, (void*)json, MHD_RESPMEM_MUST_COPY);
+    sse_client_t* c = (sse_client_t*)calloc(1, sizeof(sse_client_t));
+    if (!c) {
+        const char* error = "{\"error\":\"Memory allocation failed\"}";
+        struct MHD_Response* response = MHD_create_response_from_buffer(
+            strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(response, "Content-Type", CT_JSON);
+        int ret = MHD_queue_response(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
 
-    MHD_add_response_header(response, "Content-Type", CT_JSON);
+    c->conn = conn;
+    c->camera = camera;
+    c->delta = query_flag(conn, "delta");
+    c->stats = c->delta || query_flag(conn, "stats");
+    c->data = SSE_PREAMBLE;
+    c->size = sizeof(SSE_PREAMBLE) - 1;
+
+    struct MHD_Response* response = MHD_create_response_from_callback(
+        MHD_SIZE_UNKNOWN, 16384, sse_callback, c, sse_free_callback);
+    if (!response) {
+        free(c);
+        return MHD_NO;
+    }
+
+    const char* last = MHD_lookup_connection_value(conn, MHD_HEADER_KIND, "Last-Event-ID");
+    pthread_mutex_lock(&srv->sse_mutex);
+    c->last_id = srv->sse_last_id;
+    if (last) {
+        /* Resume after the client's last event if it is still in the history */
+        unsigned long long id = strtoull(last, NULL, 10);
+        if (id < srv->sse_last_id && srv->sse_last_id - id < SSE_HISTORY) {
+            c->last_id = id;
+        }
+    }
+    srv->sse_clients++;
+    if (c->stats) {
+        srv->sse_stats_clients++;
+        srv->sse_stats_ms = 0.0;  /* Publish stats with the next result */
+    }
+    pthread_mutex_unlock(&srv->sse_mutex);
+
+    MHD_add_response_header(response, "Content-Type", CT_SSE);
+    MHD_add_response_header(response, "Cache-Control", "no-cache, no-store");
+    MHD_add_response_header(response, "X-Accel-Buffering", "no");
     MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
 
     int ret = MHD_queue_response(conn, MHD_HTTP_OK, response);
@@ -488,6 +1417,146 @@ static int handle_results(struct MHD_Connection* conn, cira_ctx* ctx) {
     return ret;
 }
 
+/* /api/results/range: results per response by default, and at most */
+#define RANGE_DEFAULT_LIMIT 1000
+#define RANGE_MAX_LIMIT 10000
+
+/* Upper bounds of one result's JSON and one detection's (64-byte label) */
+#define RANGE_RESULT_JSON 224
+#define RANGE_DETECTION_JSON 192
+
+/* Unsigned query argument, def if absent; 0 if malformed */
+static int query_u64(struct MHD_Connection* conn, const char* key, unsigned long long def,
+                     unsigned long long* out) {
+    const char* v = MHD_lookup_connection_value(conn, MHD_GET_ARGUMENT_KIND, key);
+    *out = def;
+    if (!v) return 1;
+    char* end;
+    *out = strtoull(v, &end, 10);
+    return end != v && *end == '\0' && v[0] != '-';
+}
+
+/**
+ * Handle GET /api/results/range - stored results after a sequence.
+ *
+ * Returns every result of the history (result_log.h) with a
+ * result_sequence above ?since=N (default 0), oldest first, in one
+ * response: a client that saw result N on /api/results or
+ * /api/results/stream catches up without gaps. ?from_ms=T keeps results
+ * stored at or after T (Unix milliseconds), ?camera=N one camera's, and
+ * ?limit=N caps the count; "more" says to ask again with since=next.
+ * "gap" is true when results after since have already left the history.
+ */
+static int handle_results_range(struct MHD_Connection* conn, cira_ctx* ctx) {
+    unsigned long long since, from_ms, limit, camera_arg;
+    if (!query_u64(conn, "since", 0, &since) || !query_u64(conn, "from_ms", 0, &from_ms) ||
+        !query_u64(conn, "limit", RANGE_DEFAULT_LIMIT, &limit) ||
+        !query_u64(conn, "camera", 0, &camera_arg)) {
+        return send_json(conn, MHD_HTTP_BAD_REQUEST,
+                         "{\"error\":\"since, from_ms, limit and camera must be unsigned integers\"}");
+    }
+    if (limit < 1) limit = 1;
+    if (limit > RANGE_MAX_LIMIT) limit = RANGE_MAX_LIMIT;
+
+    int camera = -1;
+    if (MHD_lookup_connection_value(conn, MHD_GET_ARGUMENT_KIND, "camera")) {
+        if (camera_arg >= CIRA_MAX_CAMERAS) return handle_bad_camera(conn);
+        camera = (int)camera_arg;
+    }
+
+    /* Copy under the lock, with the labels the boxes refer to, and format outside it */
+    result_range_t range;
+    int num_labels, enabled;
+    pthread_mutex_lock(&ctx->result_mutex);
+    enabled = ctx->result_history > 0;
+    int result = result_log_range(ctx->result_log, (uint64_t)since, (int64_t)from_ms,
+                                  camera, (int)limit, &range);
+    if (range.oldest == 0 && ctx->result_sequence > 0 && enabled) {
+        /* Nothing held yet (history just reset): everything so far is gone */
+        range.latest = ctx->result_sequence;
+    }
+    num_labels = ctx->num_labels;
+    char (*names)[CIRA_MAX_LABEL_LEN] = (char (*)[CIRA_MAX_LABEL_LEN])malloc(
+        (size_t)(num_labels > 0 ? num_labels : 1) * CIRA_MAX_LABEL_LEN);
+    if (names) memcpy(names, ctx->labels, (size_t)num_labels * CIRA_MAX_LABEL_LEN);
+    pthread_mutex_unlock(&ctx->result_mutex);
+
+    size_t cap = 512 + (size_t)range.count * RANGE_RESULT_JSON +
+                 (size_t)range.num_detections * RANGE_DETECTION_JSON;
+    char* response = (result == CIRA_OK && names) ? (char*)malloc(cap) : NULL;
+    if (!response) {
+        free(names);
+        result_range_free(&range);
+        return send_json(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, "{\"error\":\"Out of memory\"}");
+    }
+
+    uint64_t next = range.count > 0 ? range.entries[range.count - 1].sequence : (uint64_t)since;
+    int gap = range.oldest > 0 ? (uint64_t)since + 1 < range.oldest
+                               : range.latest > (uint64_t)since;
+    char* p = response;
+    char* end = response + cap;
+    p += snprintf(p, end - p,
+        "{\"enabled\":%s,\"since\":%llu,\"oldest\":%llu,\"latest\":%llu,\"gap\":%s,"
+        "\"more\":%s,\"next\":%llu,\"count\":%d,\"results\":[",
+        enabled ? "true" : "false", since, (unsigned long long)range.oldest,
+        (unsigned long long)range.latest, gap ? "true" : "false",
+        range.more ? "true" : "false", (unsigned long long)next, range.count);
+
+    for (int i = 0; i < range.count; i++) {
+        const result_log_entry_t* e = &range.entries[i];
+        p += snprintf(p, end - p,
+            "%s{\"result_sequence\":%llu,\"frame_sequence\":%llu,\"camera\":%d,"
+            "\"timestamp_ms\":%lld,\"width\":%d,\"height\":%d,\"count\":%d,\"detections\":[",
+            i > 0 ? "," : "", (unsigned long long)e->sequence,
+            (unsigned long long)e->frame_sequence, e->camera, (long long)e->timestamp_ms,
+            e->width, e->height, e->detection_count);
+        for (int j = 0; j < e->detection_count; j++) {
+            const cira_result_record_t* d = &range.detections[e->first_detection + j];
+            const char* label = d->label_id >= 0 && d->label_id < num_labels
+                ? names[d->label_id] : "unknown";
+            p += snprintf(p, end - p,
+                "%s{\"label\":\"%s\",\"confidence\":%.3f,\"bbox\":[%d,%d,%d,%d]}",
+                j > 0 ? "," : "", label, d->confidence,
+                (int)(d->x * e->width), (int)(d->y * e->height),
+                (int)(d->w * e->width), (int)(d->h * e->height));
+        }
+        p += snprintf(p, end - p, "]}");
+    }
+    snprintf(p, end - p, "]}");
+    free(names);
+    result_range_free(&range);
+
+    struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+        strlen(response), response, MHD_RESPMEM_MUST_FREE);
+    MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
+    MHD_add_response_header(mhd_response, "Cache-Control", "no-cache, no-store");
+    MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+    int ret = MHD_queue_response(conn, MHD_HTTP_OK, mhd_response);
+    MHD_destroy_response(mhd_response);
+    return ret;
+}
+
+/* Append a camera's pipeline stage stats as a JSON array */
+static char* append_stages_json(char* p, char* end, const cira_camera_t* cam) {
+    p += snprintf(p, end - p, "[");
+    for (int i = 0; i < CIRA_PIPELINE_STAGES && p < end - 256; i++) {
+        const cira_stage_stats_t* st = &cam->stage_stats[i];
+        p += snprintf(p, end - p,
+            "%s{\"name\":\"%s\",\"fps\":%.1f,\"busy_ms\":%.2f,\"frames\":%llu,"
+            "\"dropped\":%llu,\"queue_depth\":%d,\"queue_capacity\":%d}",
+            i > 0 ? "," : "",
+            st->name ? st->name : "",
+            st->fps,
+            st->busy_ms,
+            (unsigned long long)st->frames,
+            (unsigned long long)st->dropped,
+            st->queue_depth,
+            st->queue_capacity);
+    }
+    p += snprintf(p, end - p, "]");
+    return p;
+}
+
 /**
  * Handle /api/stats endpoint - cumulative statistics since startup.
  */
@@ -534,6 +1603,128 @@ static int handle_stats(struct MHD_Connection* conn, cira_ctx* ctx) {
         model_name = "TensorRT";
     }
 
+    /* Build camera 0 pipeline stage stats (single-camera view) */
+    char pipeline[2048];
+    p = pipeline;
+    end = pipeline + sizeof(pipeline);
+    p += snprintf(p, end - p,
+        "{\"running\":%s,\"queue_depth\":%d,\"drop_policy\":\"%s\",\"stages\":",
+        ctx->cameras[0].running ? "true" : "false",
+        ctx->pipeline_queue_depth,
+        ctx->pipeline_drop_policy == FRAME_QUEUE_DROP_NEWEST ? "drop_newest" : "drop_oldest");
+    p = append_stages_json(p, end - 2, &ctx->cameras[0]);
+    snprintf(p, end - p, "}");
+
+    /* Build per-camera stats; inference_fps is the shared model's total */
+    char cameras[CIRA_MAX_CAMERAS * 2048];
+    float inference_fps = 0.0f;
+    int first_camera = 1;
+    p = cameras;
+    end = cameras + sizeof(cameras);
+    p += snprintf(p, end - p, "[");
+    for (int i = 0; i < CIRA_MAX_CAMERAS && p < end - 2048; i++) {
+        const cira_camera_t* cam = &ctx->cameras[i];
+        if (!cam->running) continue;
+        inference_fps += cam->inference_fps;
+        video_encoder_stats_t video;
+        video_encoder_stats(cam->video, &video);
+        p += snprintf(p, end - p,
+            "%s{\"camera\":%d,\"device_id\":%d,\"capture\":\"%s\",\"capture_format\":\"%s\","
+            "\"fps\":%.1f,\"inference_fps\":%.1f,"
+            "\"frames\":%llu,\"detections\":%llu,"
+            "\"gate\":{\"inferred\":%llu,\"skipped\":%llu,\"motion\":%.1f,\"rois\":%d},"
+            "\"tracker\":{\"tracks\":%d,\"predicted\":%llu},"
+            "\"video\":{\"running\":%s,\"encoder\":\"%s\",\"codec\":\"%s\","
+            "\"width\":%d,\"height\":%d,\"viewers\":%d,\"frames\":%llu,"
+            "\"keyframes\":%llu,\"bytes\":%llu,\"dropped\":%llu},"
+            "\"stages\":",
+            first_camera ? "" : ",",
+            cam->index,
+            cam->device_id,
+            cam->capture_backend ? cam->capture_backend : "",
+            cam->capture_format ? cam->capture_format : "",
+            cam->current_fps,
+            cam->inference_fps,
+            (unsigned long long)cam->total_frames,
+            (unsigned long long)cam->total_detections,
+            (unsigned long long)cam->gate_passed,
+            (unsigned long long)cam->gate_skipped,
+            cam->motion_score,
+            cam->num_rois,
+            cam->active_tracks,
+            (unsigned long long)cam->tracked_frames,
+            video.running ? "true" : "false",
+            video.backend,
+            video.codec,
+            video.width,
+            video.height,
+            video.viewers,
+            (unsigned long long)video.frames,
+            (unsigned long long)video.keyframes,
+            (unsigned long long)video.bytes,
+            (unsigned long long)video.dropped);
+        p = append_stages_json(p, end - 2, cam);
+        p += snprintf(p, end - p, "}");
+        first_camera = 0;
+    }
+    snprintf(p, end - p, "]");
+
+    uint64_t jpeg_hits, jpeg_encodes;
+    jpeg_cache_stats(ctx->jpeg_cache, &jpeg_hits, &jpeg_encodes);
+
+    /* HTTP server (this handler runs inside it, so g_server is set) */
+    const char* http_mode = "threads";
+    int http_threads = 0, http_streams = 0, http_parked = 0;
+    if (g_server) {
+        pthread_mutex_lock(&g_server->waiter_mutex);
+        if (g_server->event_mode) {
+            http_mode = "event";
+            http_threads = g_server->threads;
+        }
+        http_streams = g_server->streams;
+        http_parked = g_server->parked;
+        pthread_mutex_unlock(&g_server->waiter_mutex);
+    }
+
+    /* Result subscribers */
+    int sse_clients = 0, sse_parked = 0;
+    uint64_t sse_events = 0;
+    if (g_server) {
+        pthread_mutex_lock(&g_server->sse_mutex);
+        sse_clients = g_server->sse_clients;
+        sse_parked = g_server->sse_parked;
+        sse_events = g_server->sse_events;
+        pthread_mutex_unlock(&g_server->sse_mutex);
+    }
+
+    char frame_ring[256] = "null";
+    if (ctx->frame_ring) {
+        snprintf(frame_ring, sizeof(frame_ring),
+                 "{\"name\":\"%s\",\"format\":\"%s\",\"frames\":%llu,\"oversize\":%llu}",
+                 frame_ring_name(ctx->frame_ring),
+                 ctx->frame_ring_format == FRAME_RING_FORMAT_JPEG ? "jpeg" : "rgb",
+                 (unsigned long long)frame_ring_sequence(ctx->frame_ring),
+                 (unsigned long long)ctx->frame_ring_oversize);
+    }
+
+    /* CPU set of each thread class, "" where not pinned */
+    char cpu_affinity[CPU_CLASSES * 200 + 16];
+    size_t cpu_len = (size_t)snprintf(cpu_affinity, sizeof(cpu_affinity), "{");
+    for (int i = 0; i < CPU_CLASSES; i++) {
+        char cpus[192];
+        cpu_mask_format(ctx->cpu_masks[i], cpus, sizeof(cpus));
+        cpu_len += (size_t)snprintf(cpu_affinity + cpu_len, sizeof(cpu_affinity) - cpu_len,
+                                    "%s\"%s\":\"%s\"", i ? "," : "",
+                                    cpu_class_name((cpu_class_t)i), cpus);
+    }
+    snprintf(cpu_affinity + cpu_len, sizeof(cpu_affinity) - cpu_len, "}");
+
+    pthread_mutex_lock(&ctx->async_mutex);
+    int async_queued = ctx->async_queued;
+    uint64_t async_completed = ctx->async_completed;
+    uint64_t async_rejected = ctx->async_rejected;
+    pthread_mutex_unlock(&ctx->async_mutex);
+
     /* Build full response */
     snprintf(response, sizeof(response),
         "{"
@@ -541,20 +1732,68 @@ static int handle_stats(struct MHD_Connection* conn, cira_ctx* ctx) {
         "\"total_frames\":%llu,"
         "\"by_label\":%s,"
         "\"fps\":%.1f,"
+        "\"inference_fps\":%.1f,"
+        "\"pipeline\":%s,"
+        "\"cameras\":%s,"
+        "\"scheduler\":{\"mode\":\"%s\",\"running\":%s,\"calls\":%llu,\"frames\":%llu},"
+        "\"jpeg_cache\":{\"hits\":%llu,\"encodes\":%llu,\"encoder\":\"%s\"},"
+        "\"http\":{\"mode\":\"%s\",\"threads\":%d,\"streams\":%d,\"parked\":%d},"
+        "\"results_stream\":{\"clients\":%d,\"parked\":%d,\"events\":%llu},"
+        "\"frame_ring\":%s,"
+        "\"predict_allocations\":%llu,"
+        "\"cpu_affinity\":%s,"
+        "\"async_predict\":{\"queued\":%d,\"completed\":%llu,\"rejected\":%llu},"
+        "\"model_reload\":{\"loading\":%s,\"count\":%llu,\"failures\":%llu,"
+            "\"last_ms\":%.1f,\"last_warmup_ms\":%.1f,\"last_swap_us\":%.1f,"
+            "\"frames_dropped\":%llu},"
+        "\"frames_skipped\":%llu,"
         "\"uptime_sec\":%ld,"
         "\"timestamp\":\"%s\","
         "\"model_loaded\":%s,"
         "\"model_name\":\"%s\","
+        "\"model_precision\":\"%s\","
         "\"model_path\":\"%s\""
         "}",
         (unsigned long long)ctx->total_detections,
         (unsigned long long)ctx->total_frames,
         by_label,
         cira_get_fps(ctx),
+        inference_fps,
+        pipeline,
+        cameras,
+        ctx->camera_schedule == CIRA_SCHEDULE_ROUND_ROBIN ? "round_robin" : "batch",
+        ctx->camera_scheduler ? "true" : "false",
+        (unsigned long long)ctx->scheduler_calls,
+        (unsigned long long)ctx->scheduler_frames,
+        (unsigned long long)jpeg_hits,
+        (unsigned long long)jpeg_encodes,
+        jpeg_encoder_name(),
+        http_mode,
+        http_threads,
+        http_streams,
+        http_parked,
+        sse_clients,
+        sse_parked,
+        (unsigned long long)sse_events,
+        frame_ring,
+        (unsigned long long)ctx->predict_allocations,
+        cpu_affinity,
+        async_queued,
+        (unsigned long long)async_completed,
+        (unsigned long long)async_rejected,
+        ctx->model_swapping ? "true" : "false",
+        (unsigned long long)ctx->reload_count,
+        (unsigned long long)ctx->reload_failures,
+        ctx->reload_ms,
+        ctx->reload_warmup_ms,
+        ctx->reload_swap_us,
+        (unsigned long long)ctx->reload_dropped_frames,
+        (unsigned long long)ctx->skipped_frames,
         uptime_sec,
         timestamp,
         ctx->format != CIRA_FORMAT_UNKNOWN ? "true" : "false",
         model_name,
+        cira_precision_name(ctx->precision),
         ctx->model_path
     );
 
@@ -570,15 +1809,195 @@ static int handle_stats(struct MHD_Connection* conn, cira_ctx* ctx) {
     return ret;
 }
 
+/* Prometheus exposition buffer: camera series plus context-wide ones */
+#define METRICS_RESPONSE_SIZE (CIRA_MAX_CAMERAS * 8192 + 16384)
+
+/* Append a HELP/TYPE header */
+static char* metrics_header(char* p, char* end, const char* name, const char* type,
+                            const char* help) {
+    if (p >= end) return p;
+    p += snprintf(p, end - p, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    return p;
+}
+
+/* Append one histogram as a Prometheus summary in seconds (labels: "" or "k=\"v\",...") */
+static char* metrics_summary(char* p, char* end, const char* name, const char* labels,
+                             const latency_hist_t* hist) {
+    if (!hist || p >= end - 512) return p;
+
+    latency_summary_t sum;
+    latency_hist_summary(hist, &sum);
+    const char* sep = labels[0] ? "," : "";
+    char braced[128] = "";
+    if (labels[0]) snprintf(braced, sizeof(braced), "{%s}", labels);
+    p += snprintf(p, end - p,
+        "%s{%s%squantile=\"0.5\"} %.6f\n"
+        "%s{%s%squantile=\"0.9\"} %.6f\n"
+        "%s{%s%squantile=\"0.99\"} %.6f\n"
+        "%s_sum%s %.6f\n"
+        "%s_count%s %llu\n",
+        name, labels, sep, sum.p50_ms / 1000.0,
+        name, labels, sep, sum.p90_ms / 1000.0,
+        name, labels, sep, sum.p99_ms / 1000.0,
+        name, braced, sum.sum_ms / 1000.0,
+        name, braced, (unsigned long long)sum.count);
+    return p;
+}
+
+/**
+ * Handle /metrics endpoint - Prometheus text format.
+ *
+ * Per-stage latency (p50/p90/p99, seconds) of every camera that has run,
+ * capture-to-result latency, backend predict stages, result JSON and
+ * JPEG encode, plus queue depths and dropped/skipped frame counters.
+ */
+static int handle_metrics(struct MHD_Connection* conn, cira_ctx* ctx) {
+    char* response = (char*)malloc(METRICS_RESPONSE_SIZE);
+    if (!response) {
+        const char* error = "{\"error\":\"Out of memory\"}";
+        struct MHD_Response* err = MHD_create_response_from_buffer(
+            strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(err, "Content-Type", CT_JSON);
+        int ret = MHD_queue_response(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, err);
+        MHD_destroy_response(err);
+        return ret;
+    }
+    char* p = response;
+    char* end = response + METRICS_RESPONSE_SIZE;
+    char labels[96];
+
+    p = metrics_header(p, end, "cira_stage_latency_seconds", "summary",
+        "Camera pipeline stage time per frame (capture: driver to user space, or the read)");
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        const cira_camera_t* cam = &ctx->cameras[i];
+        for (int st = 0; st < CIRA_PIPELINE_STAGES; st++) {
+            snprintf(labels, sizeof(labels), "camera=\"%d\",stage=\"%s\"", i,
+                     cam->stage_stats[st].name ? cam->stage_stats[st].name : "");
+            p = metrics_summary(p, end, "cira_stage_latency_seconds", labels, cam->latency[st]);
+        }
+    }
+
+    p = metrics_header(p, end, "cira_result_latency_seconds", "summary",
+        "Sensor timestamp to stored result, per camera");
+    for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+        snprintf(labels, sizeof(labels), "camera=\"%d\"", i);
+        p = metrics_summary(p, end, "cira_result_latency_seconds", labels,
+                            ctx->cameras[i].latency[CIRA_LATENCY_RESULT]);
+    }
+
+    p = metrics_header(p, end, "cira_predict_stage_seconds", "summary",
+        "Backend time per single-image predict, by stage");
+    static const char* const predict_stages[] = { "preprocess", "inference", "decode" };
+    for (int i = 0; i < 3; i++) {
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", predict_stages[i]);
+        p = metrics_summary(p, end, "cira_predict_stage_seconds", labels,
+                            ctx->latency[CIRA_LATENCY_PREDICT_PREPROCESS + i]);
+    }
+
+    p = metrics_header(p, end, "cira_result_json_seconds", "summary",
+        "Result JSON build time");
+    p = metrics_summary(p, end, "cira_result_json_seconds", "",
+                        ctx->latency[CIRA_LATENCY_RESULT_JSON]);
+
+    p = metrics_header(p, end, "cira_jpeg_encode_seconds", "summary",
+        "JPEG encode time per frame (streams, snapshots, frame file)");
+    p = metrics_summary(p, end, "cira_jpeg_encode_seconds", "", jpeg_encoder_latency());
+
+    /* Queues and counters of cameras that have run */
+    static const char* const camera_series[][3] = {
+        { "cira_queue_depth", "gauge", "Frames waiting in a stage's input queue" },
+        { "cira_queue_capacity", "gauge", "Capacity of a stage's input queue" },
+        { "cira_stage_frames_total", "counter", "Frames processed by a stage since camera start" },
+        { "cira_stage_dropped_total", "counter", "Frames dropped at a stage's full input queue" },
+    };
+    for (int m = 0; m < 4; m++) {
+        p = metrics_header(p, end, camera_series[m][0], camera_series[m][1], camera_series[m][2]);
+        for (int i = 0; i < CIRA_MAX_CAMERAS && p < end - 1024; i++) {
+            const cira_camera_t* cam = &ctx->cameras[i];
+            if (!cam->latency[0]) continue;
+            /* The capture stage has no input queue */
+            for (int st = m < 2 ? 1 : 0; st < CIRA_PIPELINE_STAGES; st++) {
+                const cira_stage_stats_t* ss = &cam->stage_stats[st];
+                unsigned long long v = m == 0 ? (unsigned long long)ss->queue_depth
+                                     : m == 1 ? (unsigned long long)ss->queue_capacity
+                                     : m == 2 ? (unsigned long long)ss->frames
+                                     : (unsigned long long)ss->dropped;
+                p += snprintf(p, end - p, "%s{camera=\"%d\",stage=\"%s\"} %llu\n",
+                              camera_series[m][0], i, ss->name ? ss->name : "", v);
+            }
+        }
+    }
+
+    p = metrics_header(p, end, "cira_gate_skipped_total", "counter",
+        "Frames the motion gate kept from inference");
+    for (int i = 0; i < CIRA_MAX_CAMERAS && p < end - 256; i++) {
+        const cira_camera_t* cam = &ctx->cameras[i];
+        if (!cam->latency[0]) continue;
+        p += snprintf(p, end - p, "cira_gate_skipped_total{camera=\"%d\"} %llu\n",
+                      i, (unsigned long long)cam->gate_skipped);
+    }
+
+    p = metrics_header(p, end, "cira_camera_fps", "gauge", "Capture frames per second");
+    for (int i = 0; i < CIRA_MAX_CAMERAS && p < end - 256; i++) {
+        const cira_camera_t* cam = &ctx->cameras[i];
+        if (!cam->latency[0]) continue;
+        p += snprintf(p, end - p, "cira_camera_fps{camera=\"%d\"} %.2f\n", i, cam->current_fps);
+    }
+
+    if (p < end - 2048) {
+        p = metrics_header(p, end, "cira_frames_total", "counter", "Frames inferred");
+        p += snprintf(p, end - p, "cira_frames_total %llu\n",
+                      (unsigned long long)ctx->total_frames);
+        p = metrics_header(p, end, "cira_frames_skipped_total", "counter",
+            "Camera frames published without inference (no model, or a load in progress)");
+        p += snprintf(p, end - p, "cira_frames_skipped_total %llu\n",
+                      (unsigned long long)ctx->skipped_frames);
+        p = metrics_header(p, end, "cira_detections_total", "counter", "Detections since startup");
+        p += snprintf(p, end - p, "cira_detections_total %llu\n",
+                      (unsigned long long)ctx->total_detections);
+        pthread_mutex_lock(&ctx->async_mutex);
+        int async_queued = ctx->async_queued;
+        uint64_t async_completed = ctx->async_completed;
+        pthread_mutex_unlock(&ctx->async_mutex);
+        p = metrics_header(p, end, "cira_async_queue_depth", "gauge",
+            "cira_predict_image_async requests waiting");
+        p += snprintf(p, end - p, "cira_async_queue_depth %d\n", async_queued);
+        p = metrics_header(p, end, "cira_async_completed_total", "counter",
+            "cira_predict_image_async requests completed");
+        p += snprintf(p, end - p, "cira_async_completed_total %llu\n",
+                      (unsigned long long)async_completed);
+        p = metrics_header(p, end, "cira_model_reloads_total", "counter", "Successful model loads");
+        p += snprintf(p, end - p, "cira_model_reloads_total %llu\n",
+                      (unsigned long long)ctx->reload_count);
+        p = metrics_header(p, end, "cira_uptime_seconds", "gauge", "Seconds since startup");
+        p += snprintf(p, end - p, "cira_uptime_seconds %ld\n", (long)(time(NULL) - ctx->start_time));
+    }
+
+    struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+        strlen(response), response, MHD_RESPMEM_MUST_FREE);
+
+    MHD_add_response_header(mhd_response, "Content-Type", CT_METRICS);
+    MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+
+    int ret = MHD_queue_response(conn, MHD_HTTP_OK, mhd_response);
+    MHD_destroy_response(mhd_response);
+
+    return ret;
+}
+
 /**
  * Handle /snapshot endpoint.
  */
 static int handle_snapshot(struct MHD_Connection* conn, cira_ctx* ctx) {
+    frame_source_t src;
+    if (!get_frame_source(conn, ctx, &src)) {
+        return handle_bad_camera(conn);
+    }
+
     /* Get latest frame */
-    int w, h;
-    const uint8_t* frame = cira_get_frame(ctx, &w, &h);
+    frame_slot_t* slot = frame_store_acquire(src.store);
 
-    if (!frame || w <= 0 || h <= 0) {
+    if (!slot) {
         const char* error = "{\"error\":\"No frame available\"}";
         struct MHD_Response* response = MHD_create_response_from_buffer(
             strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
@@ -589,12 +2008,12 @@ static int handle_snapshot(struct MHD_Connection* conn, cira_ctx* ctx) {
         return ret;
     }
 
-    /* Encode to JPEG with annotations */
-    uint8_t* jpeg;
-    size_t jpeg_size;
-    int enc_ret = jpeg_encode_annotated(ctx, frame, w, h, 90, &jpeg, &jpeg_size);
+    /* Encode to JPEG with annotations (shared with concurrent snapshots) */
+    jpeg_buf_t* jb = jpeg_cache_get(src.cache, ctx, source_camera(ctx, &src), slot, 1,
+                                    SNAPSHOT_QUALITY);
+    frame_store_release(slot);
 
-    if (enc_ret != CIRA_OK || !jpeg || jpeg_size == 0) {
+    if (!jb) {
         const char* error = "{\"error\":\"JPEG encoding failed\"}";
         struct MHD_Response* response = MHD_create_response_from_buffer(
             strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
@@ -604,9 +2023,15 @@ static int handle_snapshot(struct MHD_Connection* conn, cira_ctx* ctx) {
         return ret;
     }
 
-    /* Return JPEG image */
-    struct MHD_Response* response = MHD_create_response_from_buffer(
-        jpeg_size, jpeg, MHD_RESPMEM_MUST_COPY);
+    /* Return JPEG image without copying (reference dropped when MHD is done) */
+    size_t jpeg_size;
+    const uint8_t* jpeg = jpeg_buf_data(jb, &jpeg_size);
+    struct MHD_Response* response = MHD_create_response_from_buffer_with_free_callback(
+        jpeg_size, (void*)jpeg, jpeg_buf_release_data);
+    if (!response) {
+        jpeg_buf_release(jb);
+        return MHD_NO;
+    }
 
     MHD_add_response_header(response, "Content-Type", CT_JPEG);
     MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
@@ -622,6 +2047,11 @@ static int handle_snapshot(struct MHD_Connection* conn, cira_ctx* ctx) {
  * Handle /stream/annotated endpoint (MJPEG).
  */
 static int handle_stream(struct MHD_Connection* conn, cira_ctx* ctx, int annotated) {
+    frame_source_t src;
+    if (!get_frame_source(conn, ctx, &src)) {
+        return handle_bad_camera(conn);
+    }
+
     /* Allocate streaming context */
     stream_ctx_t* sctx = (stream_ctx_t*)calloc(1, sizeof(stream_ctx_t));
     if (!sctx) {
@@ -635,6 +2065,8 @@ static int handle_stream(struct MHD_Connection* conn, cira_ctx* ctx, int annotat
     }
 
     sctx->ctx = ctx;
+    sctx->conn = conn;
+    sctx->src = src;
     sctx->annotated = annotated;
     sctx->frame_sent = 0;
     sctx->header_sent = 0;
@@ -662,6 +2094,17 @@ static int handle_stream(struct MHD_Connection* conn, cira_ctx* ctx, int annotat
         return ret;
     }
 
+    /* Count the stream; in event mode, wake it on new frames of its store */
+    server_state_t* srv = g_server;
+    if (srv) {
+        pthread_mutex_lock(&srv->waiter_mutex);
+        srv->streams++;
+        pthread_mutex_unlock(&srv->waiter_mutex);
+        if (srv->event_mode) {
+            frame_store_set_notify(src.store, stream_notify, srv);
+        }
+    }
+
     /* Set MJPEG headers */
     MHD_add_response_header(response, "Content-Type", CT_MJPEG);
     MHD_add_response_header(response, "Cache-Control", "no-cache, no-store, must-revalidate");
@@ -675,6 +2118,82 @@ static int handle_stream(struct MHD_Connection* conn, cira_ctx* ctx, int annotat
     return ret;
 }
 
+/**
+ * Handle /stream/video endpoint (fragmented MP4).
+ */
+static int handle_stream_video(struct MHD_Connection* conn, cira_ctx* ctx) {
+    frame_source_t src;
+    if (!get_frame_source(conn, ctx, &src)) {
+        return handle_bad_camera(conn);
+    }
+    /* The context store has no encoder: serve camera 0 */
+    video_encoder_t* video = ctx->cameras[src.camera >= 0 ? src.camera : 0].video;
+    if (!video || ctx->video_config.codec == VIDEO_CODEC_OFF) {
+        const char* error = "{\"error\":\"No video stream (camera not started or video.codec off)\"}";
+        struct MHD_Response* response = MHD_create_response_from_buffer(
+            strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(response, "Content-Type", CT_JSON);
+        MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+        int ret = MHD_queue_response(conn, MHD_HTTP_NOT_FOUND, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
+
+    stream_ctx_t* sctx = (stream_ctx_t*)calloc(1, sizeof(stream_ctx_t));
+    if (!sctx) {
+        const char* error = "{\"error\":\"Memory allocation failed\"}";
+        struct MHD_Response* response = MHD_create_response_from_buffer(
+            strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(response, "Content-Type", CT_JSON);
+        int ret = MHD_queue_response(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
+
+    sctx->ctx = ctx;
+    sctx->conn = conn;
+    sctx->src = src;
+    sctx->video = video;
+
+    struct MHD_Response* response = MHD_create_response_from_callback(
+        MHD_SIZE_UNKNOWN, 32768, video_callback, sctx, stream_free_callback);
+    if (!response) {
+        free(sctx);
+        const char* error = "{\"error\":\"Failed to create response\"}";
+        struct MHD_Response* err_response = MHD_create_response_from_buffer(
+            strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(err_response, "Content-Type", CT_JSON);
+        int ret = MHD_queue_response(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, err_response);
+        MHD_destroy_response(err_response);
+        return ret;
+    }
+
+    /* Counted in only now, so the free callback always has a viewer to drop;
+     * subscribing makes the publish stage encode and asks for a keyframe */
+    sctx->cursor = video_encoder_subscribe(video);
+
+    server_state_t* srv = g_server;
+    if (srv) {
+        pthread_mutex_lock(&srv->waiter_mutex);
+        srv->streams++;
+        pthread_mutex_unlock(&srv->waiter_mutex);
+        if (srv->event_mode) {
+            video_encoder_set_notify(video, video_notify, srv);
+        }
+    }
+
+    MHD_add_response_header(response, "Content-Type", CT_MP4);
+    MHD_add_response_header(response, "Cache-Control", "no-cache, no-store, must-revalidate");
+    MHD_add_response_header(response, "Pragma", "no-cache");
+    MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+    MHD_add_response_header(response, "Connection", "close");
+
+    int ret = MHD_queue_response(conn, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+
+    return ret;
+}
+
 /* HTML template for web UI - built incrementally to avoid overlength string warnings */
 static char g_html_template[16384];
 static int g_html_initialized = 0;
@@ -780,29 +2299,34 @@ static void init_html_template(void) {
         "}catch(e){msg.className='msg err';msg.textContent='Error: '+e.message;}"
         "btn.disabled=false;btn.textContent='Load Model';setTimeout(()=>msg.textContent='',5000);}");
 
-    /* Part 9: JavaScript - update function */
+    /* Part 9: JavaScript - stats (pushed deltas, model state polled slowly) */
     p += snprintf(p, end - p,
-        "async function u(){try{const[r,s]=await Promise.all(["
-        "fetch('/api/results').then(x=>x.json()),"
-        "fetch('/api/stats').then(x=>x.json())]);"
-        "document.getElementById('dc').textContent=r.count||0;"
-        "document.getElementById('fv').textContent=s.fps?s.fps.toFixed(1):'0';"
-        "document.getElementById('fps').textContent=(s.fps?s.fps.toFixed(1):'0')+' FPS';"
-        "document.getElementById('td').textContent=s.total_detections||0;"
-        "document.getElementById('ut').textContent=s.uptime_sec+'s';"
+        "const st={};function sh(){"
+        "const f=st.fps!==undefined?st.fps.toFixed(1):'0';"
+        "document.getElementById('fv').textContent=f;"
+        "document.getElementById('fps').textContent=f+' FPS';"
+        "document.getElementById('td').textContent=st.total_detections||0;"
+        "document.getElementById('ut').textContent=(st.uptime_sec||0)+'s';}"
+        "async function u(){try{const s=await fetch('/api/stats').then(x=>x.json());"
+        "Object.assign(st,{fps:s.fps,total_detections:s.total_detections,uptime_sec:s.uptime_sec});sh();"
         "document.getElementById('dot').className='dot'+(s.model_loaded?'':' off');"
-        "document.getElementById('mn').textContent=s.model_loaded?(s.model_name||'Loaded'):'Not loaded';");
+        "document.getElementById('mn').textContent=s.model_loaded?(s.model_name||'Loaded'):'Not loaded';"
+        "}catch(e){}}");
 
-    /* Part 10: JavaScript - detection list and init */
+    /* Part 10: JavaScript - result push, detection list and init */
     p += snprintf(p, end - p,
+        "const es=new EventSource('/api/results/stream?camera=0&delta=1');"
+        "es.addEventListener('stats',e=>{Object.assign(st,JSON.parse(e.data));sh();});"
+        "es.addEventListener('stats_delta',e=>{Object.assign(st,JSON.parse(e.data));sh();});"
+        "es.addEventListener('result',e=>{const r=JSON.parse(e.data);"
+        "document.getElementById('dc').textContent=r.count||0;"
         "var l=document.getElementById('det');"
         "if(r.detections&&r.detections.length>0){"
         "l.innerHTML=r.detections.slice(0,10).map(d=>"
         "'<div class=\"di\"><span class=\"lb\">'+d.label+'</span>'+"
         "'<span class=\"cf\">'+(d.confidence*100).toFixed(1)+'%%</span></div>').join('');"
-        "}else{l.innerHTML='<p style=\"color:#666;text-align:center\">No detections</p>';}}"
-        "catch(e){}}"
-        "loadModels();setInterval(u,500);u();</script></body></html>");
+        "}else{l.innerHTML='<p style=\"color:#666;text-align:center\">No detections</p>';}});"
+        "loadModels();setInterval(u,5000);u();</script></body></html>");
 
     g_html_initialized = 1;
 }
@@ -889,8 +2413,59 @@ static int handle_models_list(struct MHD_Connection* conn, cira_ctx* ctx) {
     return ret;
 }
 
+/* Integer field of a flat JSON body; returns fallback if absent */
+static int json_body_int(const char* data, size_t size, const char* key, int fallback) {
+    if (!data || size == 0) return fallback;
+
+    char quoted[64];
+    snprintf(quoted, sizeof(quoted), "\"%s\"", key);
+    const char* p = strstr(data, quoted);
+    if (!p) return fallback;
+    p = strchr(p + strlen(quoted), ':');
+    return p ? atoi(p + 1) : fallback;
+}
+
+/* String field of a flat JSON body into out (no escapes); returns 0 if absent */
+static int json_body_str(const char* data, size_t size, const char* key, char* out, size_t out_size) {
+    if (!data || size == 0 || out_size == 0) return 0;
+
+    char quoted[64];
+    snprintf(quoted, sizeof(quoted), "\"%s\"", key);
+    const char* p = strstr(data, quoted);
+    if (!p) return 0;
+    p = strchr(p + strlen(quoted), ':');
+    if (!p) return 0;
+    p = strchr(p, '"');
+    if (!p) return 0;
+    const char* q = strchr(++p, '"');
+    if (!q) return 0;
+
+    size_t len = (size_t)(q - p);
+    if (len >= out_size) len = out_size - 1;
+    memcpy(out, p, len);
+    out[len] = '\0';
+    return 1;
+}
+
+/* Boolean field of a flat JSON body; returns fallback if absent */
+static int json_body_bool(const char* data, size_t size, const char* key, int fallback) {
+    if (!data || size == 0) return fallback;
+
+    char quoted[64];
+    snprintf(quoted, sizeof(quoted), "\"%s\"", key);
+    const char* p = strstr(data, quoted);
+    if (!p) return fallback;
+    p = strchr(p + strlen(quoted), ':');
+    if (!p) return fallback;
+    while (*++p == ' ') {}
+    return strncmp(p, "true", 4) == 0 || *p == '1';
+}
+
 /**
  * Handle POST /api/model - Load a new model.
+ * The current model keeps serving until the new one is ready. With
+ * {"async":true} the load runs in the background and the request returns
+ * 202 at once; /api/stats "model_reload" reports when it finishes.
  */
 static int handle_model_load(struct MHD_Connection* conn, cira_ctx* ctx,
                              const char* upload_data, size_t upload_size) {
@@ -930,32 +2505,110 @@ static int handle_model_load(struct MHD_Connection* conn, cira_ctx* ctx,
         return ret;
     }
 
-    fprintf(stderr, "Loading model: %s\n", model_path);
+    fprintf(stderr, "Loading model: %s\n", model_path);
+
+    if (json_body_bool(upload_data, upload_size, "async", 0)) {
+        int started = cira_load_async(ctx, model_path);
+        if (started == CIRA_OK) {
+            snprintf(response, sizeof(response),
+                    "{\"success\":true,\"loading\":true,\"model\":\"%.500s\"}", model_path);
+        } else {
+            const char* err = cira_error(ctx);
+            snprintf(response, sizeof(response),
+                    "{\"success\":false,\"error\":\"%.500s\"}",
+                    err ? err : "Failed to start model load");
+        }
+
+        struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+            strlen(response), response, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
+        MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+        int ret = MHD_queue_response(conn, started == CIRA_OK ? MHD_HTTP_ACCEPTED : MHD_HTTP_CONFLICT,
+                                     mhd_response);
+        MHD_destroy_response(mhd_response);
+        return ret;
+    }
+
+    /* Load the new model (the current one serves until it is swapped in) */
+    int result = cira_load(ctx, model_path);
+
+    if (result == CIRA_OK) {
+        snprintf(response, sizeof(response),
+                "{\"success\":true,\"model\":\"%.500s\",\"format\":\"%s\"}",
+                model_path, cira_format_name(ctx->format));
+    } else {
+        const char* err = cira_error(ctx);
+        snprintf(response, sizeof(response),
+                "{\"success\":false,\"error\":\"%.500s\"}",
+                err ? err : "Failed to load model");
+    }
+
+    struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
+        strlen(response), response, MHD_RESPMEM_MUST_COPY);
+
+    MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
+    MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+
+    int ret = MHD_queue_response(conn, result == CIRA_OK ? MHD_HTTP_OK : MHD_HTTP_BAD_REQUEST, mhd_response);
+    MHD_destroy_response(mhd_response);
+
+    return ret;
+}
+
+/**
+ * Serve /frame/latest from the JPEG cache. Used while the frame ring is
+ * on, since the publish stage then no longer writes the frame file.
+ */
+static int handle_frame_latest_cached(struct MHD_Connection* conn, cira_ctx* ctx) {
+    frame_slot_t* slot = frame_store_acquire(ctx->frame_store);
+    if (!slot) {
+        const char* error = "{\"error\":\"No frame available\"}";
+        struct MHD_Response* response = MHD_create_response_from_buffer(
+            strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(response, "Content-Type", CT_JSON);
+        MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+        int ret = MHD_queue_response(conn, MHD_HTTP_SERVICE_UNAVAILABLE, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
+
+    uint64_t seq;
+    frame_slot_data(slot, NULL, NULL, &seq);
+    cira_camera_t* cam = ctx->cameras[0].running ? &ctx->cameras[0] : NULL;
+    jpeg_buf_t* jb = jpeg_cache_get(ctx->jpeg_cache, ctx, cam, slot, 1, FRAME_FILE_QUALITY);
+    frame_store_release(slot);
 
-    /* Load the new model */
-    int result = cira_load(ctx, model_path);
+    if (!jb) {
+        const char* error = "{\"error\":\"Failed to generate frame\"}";
+        struct MHD_Response* response = MHD_create_response_from_buffer(
+            strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
+        MHD_add_response_header(response, "Content-Type", CT_JSON);
+        MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+        int ret = MHD_queue_response(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
 
-    if (result == CIRA_OK) {
-        const char* fmt = ctx->format == CIRA_FORMAT_ONNX ? "onnx" :
-                          ctx->format == CIRA_FORMAT_NCNN ? "ncnn" : "unknown";
-        snprintf(response, sizeof(response),
-                "{\"success\":true,\"model\":\"%.500s\",\"format\":\"%s\"}",
-                model_path, fmt);
-    } else {
-        const char* err = cira_error(ctx);
-        snprintf(response, sizeof(response),
-                "{\"success\":false,\"error\":\"%.500s\"}",
-                err ? err : "Failed to load model");
+    size_t jpeg_size;
+    const uint8_t* jpeg = jpeg_buf_data(jb, &jpeg_size);
+    struct MHD_Response* response = MHD_create_response_from_buffer_with_free_callback(
+        jpeg_size, (void*)jpeg, jpeg_buf_release_data);
+    if (!response) {
+        jpeg_buf_release(jb);
+        return MHD_NO;
     }
 
-    struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
-        strlen(response), response, MHD_RESPMEM_MUST_COPY);
+    MHD_add_response_header(response, "Content-Type", CT_JPEG);
+    MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
+    MHD_add_response_header(response, "Access-Control-Expose-Headers", "X-Frame-Sequence");
+    MHD_add_response_header(response, "Cache-Control", "no-cache, no-store");
 
-    MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
-    MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+    char seq_str[32];
+    snprintf(seq_str, sizeof(seq_str), "%llu", (unsigned long long)seq);
+    MHD_add_response_header(response, "X-Frame-Sequence", seq_str);
 
-    int ret = MHD_queue_response(conn, result == CIRA_OK ? MHD_HTTP_OK : MHD_HTTP_BAD_REQUEST, mhd_response);
-    MHD_destroy_response(mhd_response);
+    int ret = MHD_queue_response(conn, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
 
     return ret;
 }
@@ -965,6 +2618,10 @@ static int handle_model_load(struct MHD_Connection* conn, cira_ctx* ctx,
  * This is a file-based alternative to MJPEG streaming for better cross-platform stability.
  */
 static int handle_frame_latest(struct MHD_Connection* conn, cira_ctx* ctx) {
+    if (ctx->frame_ring) {
+        return handle_frame_latest_cached(conn, ctx);
+    }
+
     pthread_mutex_lock(&ctx->frame_file_mutex);
 
     /* Check if we have a frame file */
@@ -972,9 +2629,7 @@ static int handle_frame_latest(struct MHD_Connection* conn, cira_ctx* ctx) {
         pthread_mutex_unlock(&ctx->frame_file_mutex);
 
         /* No frame file yet - try to generate one */
-        int w, h;
-        const uint8_t* frame = cira_get_frame(ctx, &w, &h);
-        if (!frame || w <= 0 || h <= 0) {
+        if (frame_store_sequence(ctx->frame_store) == 0) {
             const char* error = "{\"error\":\"No frame available\"}";
             struct MHD_Response* response = MHD_create_response_from_buffer(
                 strlen(error), (void*)error, MHD_RESPMEM_MUST_COPY);
@@ -1141,9 +2796,20 @@ static int handle_cameras_list(struct MHD_Connection* conn, cira_ctx* ctx) {
         current_camera = ctx->current_camera;
     }
 
-    p += snprintf(p, end - p, "],\"count\":%d,\"current\":%d,\"running\":%s}",
+    p += snprintf(p, end - p, "],\"count\":%d,\"current\":%d,\"running\":%s,\"active\":[",
                  count, current_camera, camera_running ? "true" : "false");
 
+    /* Running cameras of this context (camera number -> device) */
+    int active = 0;
+    for (int i = 0; ctx && i < CIRA_MAX_CAMERAS && p < end - 128; i++) {
+        const cira_camera_t* cam = &ctx->cameras[i];
+        if (!cam->running) continue;
+        p += snprintf(p, end - p, "%s{\"camera\":%d,\"device_id\":%d,\"fps\":%.1f}",
+                     active > 0 ? "," : "", cam->index, cam->device_id, cam->current_fps);
+        active++;
+    }
+    p += snprintf(p, end - p, "],\"max_cameras\":%d}", CIRA_MAX_CAMERAS);
+
     struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
         strlen(response), response, MHD_RESPMEM_MUST_COPY);
 
@@ -1232,7 +2898,7 @@ static int handle_node_detail(struct MHD_Connection* conn, cira_ctx* ctx, const
         "}",
         timestamp,
         port,
-        ctx ? ctx->current_fps : 0.0f,
+        ctx ? cira_get_fps(ctx) : 0.0f,
         get_temperature(),
         get_cpu_usage(),
         get_memory_usage(),
@@ -1303,7 +2969,7 @@ static int handle_nodes_list(struct MHD_Connection* conn, cira_ctx* ctx) {
         "}",
         port,
         "now",
-        ctx ? ctx->current_fps : 0.0f,
+        ctx ? cira_get_fps(ctx) : 0.0f,
         0.0f,  /* inference time not tracked in ctx */
         (ctx && ctx->model_handle) ? "loaded" : "none",
         (ctx && ctx->camera_running) ? "true" : "false"
@@ -1483,18 +3149,39 @@ static int handle_files_list(struct MHD_Connection* conn, cira_ctx* ctx) {
 static int handle_frame_info(struct MHD_Connection* conn, cira_ctx* ctx) {
     char response[1024];
 
-    pthread_mutex_lock(&ctx->frame_file_mutex);
-    snprintf(response, sizeof(response),
-        "{"
-        "\"sequence\":%llu,"
-        "\"path\":\"%s\","
-        "\"available\":%s"
-        "}",
-        (unsigned long long)ctx->frame_sequence,
-        ctx->frame_file_path,
-        ctx->frame_file_path[0] != '\0' ? "true" : "false"
-    );
-    pthread_mutex_unlock(&ctx->frame_file_mutex);
+    if (ctx->frame_ring) {
+        /* Frames go to the shared-memory ring instead of the file */
+        uint64_t seq = frame_store_sequence(ctx->frame_store);
+        snprintf(response, sizeof(response),
+            "{"
+            "\"sequence\":%llu,"
+            "\"path\":\"\","
+            "\"available\":%s,"
+            "\"ring\":\"%s\","
+            "\"ring_format\":\"%s\","
+            "\"ring_sequence\":%llu"
+            "}",
+            (unsigned long long)seq,
+            seq > 0 ? "true" : "false",
+            frame_ring_name(ctx->frame_ring),
+            ctx->frame_ring_format == FRAME_RING_FORMAT_JPEG ? "jpeg" : "rgb",
+            (unsigned long long)frame_ring_sequence(ctx->frame_ring)
+        );
+    } else {
+        pthread_mutex_lock(&ctx->frame_file_mutex);
+        snprintf(response, sizeof(response),
+            "{"
+            "\"sequence\":%llu,"
+            "\"path\":\"%s\","
+            "\"available\":%s,"
+            "\"ring\":null"
+            "}",
+            (unsigned long long)ctx->frame_sequence,
+            ctx->frame_file_path,
+            ctx->frame_file_path[0] != '\0' ? "true" : "false"
+        );
+        pthread_mutex_unlock(&ctx->frame_file_mutex);
+    }
 
     struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
         strlen(response), response, MHD_RESPMEM_MUST_COPY);
@@ -1509,8 +3196,8 @@ static int handle_frame_info(struct MHD_Connection* conn, cira_ctx* ctx) {
 }
 
 /* Forward declarations for camera control */
-extern int camera_start(cira_ctx* ctx, int device_id);
-extern int camera_stop(cira_ctx* ctx);
+extern int camera_start(cira_ctx* ctx, int camera, int device_id);
+extern int camera_stop(cira_ctx* ctx, int camera);
 
 /**
  * Handle POST /api/camera/start - start camera capture.
@@ -1519,30 +3206,33 @@ static int handle_camera_start(struct MHD_Connection* conn, cira_ctx* ctx,
                                const char* upload_data, size_t upload_size) {
     char response[1024];
 
-    /* Parse device_id from POST data (simple JSON: {"device_id": 0}) */
-    int device_id = 0;
-
-    if (upload_data && upload_size > 0) {
-        const char* dev_key = strstr(upload_data, "\"device_id\"");
-        if (dev_key) {
-            dev_key = strchr(dev_key + 11, ':');
-            if (dev_key) {
-                device_id = atoi(dev_key + 1);
-            }
-        }
+    /* Parse POST data (simple JSON: {"device_id": 0, "camera": 0, "source": "rtsp://..."}) */
+    int device_id = json_body_int(upload_data, upload_size, "device_id", 0);
+    int camera = json_body_int(upload_data, upload_size, "camera", 0);
+
+    /* A source given here replaces camera.N.source for this and later starts */
+    char source[CIRA_CAMERA_SOURCE_LEN];
+    int result = CIRA_OK;
+    if (json_body_str(upload_data, upload_size, "source", source, sizeof(source))) {
+        char key[32];
+        snprintf(key, sizeof(key), "camera.%d.source", camera);
+        result = cira_set_option(ctx, key, source);
     }
 
-    fprintf(stderr, "Starting camera %d...\n", device_id);
+    fprintf(stderr, "Starting camera %d (device %d)...\n", camera, device_id);
 
-    int result = camera_start(ctx, device_id);
+    if (result == CIRA_OK) {
+        result = camera_start(ctx, camera, device_id);
+    }
 
     if (result == CIRA_OK) {
         snprintf(response, sizeof(response),
-                "{\"success\":true,\"device_id\":%d,\"message\":\"Camera started\"}",
-                device_id);
+                "{\"success\":true,\"camera\":%d,\"device_id\":%d,\"message\":\"Camera started\"}",
+                camera, device_id);
     } else {
         snprintf(response, sizeof(response),
-                "{\"success\":false,\"error\":\"Failed to start camera %d\"}", device_id);
+                "{\"success\":false,\"error\":\"Failed to start camera %d (device %d)\"}",
+                camera, device_id);
     }
 
     struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
@@ -1558,14 +3248,17 @@ static int handle_camera_start(struct MHD_Connection* conn, cira_ctx* ctx,
 }
 
 /**
- * Handle POST /api/camera/stop - stop camera capture.
+ * Handle POST /api/camera/stop - stop one camera ({"camera": N}) or all.
  */
-static int handle_camera_stop(struct MHD_Connection* conn, cira_ctx* ctx) {
+static int handle_camera_stop(struct MHD_Connection* conn, cira_ctx* ctx,
+                              const char* upload_data, size_t upload_size) {
     char response[512];
 
+    int camera = json_body_int(upload_data, upload_size, "camera", -1);
+
     fprintf(stderr, "Stopping camera...\n");
 
-    int result = camera_stop(ctx);
+    int result = camera_stop(ctx, camera);
 
     if (result == CIRA_OK) {
         snprintf(response, sizeof(response),
@@ -1587,117 +3280,449 @@ static int handle_camera_stop(struct MHD_Connection* conn, cira_ctx* ctx) {
     return ret;
 }
 
+/* Longest /api/inference/image waits for its result */
+#define INFERENCE_TIMEOUT_MS 30000
+
+/* {"success":false,"error":"..."} with the message escaped */
+static int send_inference_error(struct MHD_Connection* conn, unsigned int status, const char* error) {
+    char escaped[512];
+    char response[640];
+    image_json_escape(error, escaped, sizeof(escaped));
+    snprintf(response, sizeof(response), "{\"success\":false,\"error\":\"%s\"}", escaped);
+    return send_json(conn, status, response);
+}
+
+/* Reply for a finished image inference; CIRA_PENDING means it timed out */
+static int send_inference_result(struct MHD_Connection* conn, cira_ctx* ctx, cira_request* req,
+                                 int status, const decoded_image_t* img, double decode_ms,
+                                 double inference_ms) {
+    if (status != CIRA_OK) {
+        char err[64];
+        snprintf(err, sizeof(err), status == CIRA_PENDING ? "Inference timed out"
+                                                          : "Inference failed (%d)", status);
+        return send_inference_error(conn, status == CIRA_PENDING ? MHD_HTTP_GATEWAY_TIMEOUT
+                                                                 : MHD_HTTP_INTERNAL_SERVER_ERROR,
+                                    err);
+    }
+
+    char response[MAX_RESPONSE_SIZE];
+    char* p = response;
+    char* end = response + sizeof(response);
+    p += snprintf(p, end - p,
+        "{\"success\":true,\"width\":%d,\"height\":%d,\"decoded_width\":%d,\"decoded_height\":%d,"
+        "\"decode_ms\":%.2f,\"inference_time_ms\":%.2f,",
+        img->src_w, img->src_h, img->w, img->h, decode_ms, inference_ms);
+    p += image_result_members(ctx, req, img->src_w, img->src_h, p, end - p - 1);
+    *p++ = '}';
+    *p = '\0';
+
+    return send_json(conn, MHD_HTTP_OK, response);
+}
+
+/*
+ * An /api/inference/image request suspended on its cira_request (event
+ * mode). The connection and the request callback each hold a reference;
+ * the callback may run after the server is gone, so it only takes the
+ * wait's own mutex.
+ */
+struct inference_wait {
+    pthread_mutex_t mutex;      /* Guards refs, done, suspended, inference_ms */
+    int refs;
+    int done;                   /* Request completed */
+    int suspended;              /* Connection suspended until done */
+    struct MHD_Connection* conn;
+    cira_request* req;
+    decoded_image_t img;        /* Sizes only, pixels already freed */
+    double decode_ms;
+    double submit_ms;           /* When the request was queued */
+    double inference_ms;        /* Queued to completed */
+    inference_wait_t* next_waiter;  /* On the server's list (waiter_mutex) */
+};
+
+static void inference_wait_unref(inference_wait_t* w) {
+    pthread_mutex_lock(&w->mutex);
+    int last = --w->refs == 0;
+    pthread_mutex_unlock(&w->mutex);
+    if (last) {
+        pthread_mutex_destroy(&w->mutex);
+        free(w);
+    }
+}
+
+/* Request callback (predict worker): wake the suspended connection */
+static void inference_done(cira_request* req, void* user_data) {
+    (void)req;
+    inference_wait_t* w = (inference_wait_t*)user_data;
+    pthread_mutex_lock(&w->mutex);
+    w->done = 1;
+    w->inference_ms = cira_time_ms() - w->submit_ms;
+    if (w->suspended) {
+        w->suspended = 0;
+        MHD_resume_connection(w->conn);
+    }
+    pthread_mutex_unlock(&w->mutex);
+    inference_wait_unref(w);
+}
+
+/*
+ * Suspend the connection until the request completes. Checked under the
+ * wait's mutex, which the callback takes: no lost wakeup.
+ *
+ * @return 1 if suspended, 0 if already complete or the server is stopping
+ */
+static int inference_park(server_state_t* srv, inference_wait_t* w) {
+    int parked = 0;
+    pthread_mutex_lock(&srv->waiter_mutex);
+    pthread_mutex_lock(&w->mutex);
+    if (srv->running && !w->done) {
+        w->next_waiter = srv->inference_waiters;
+        srv->inference_waiters = w;
+        w->suspended = 1;
+        MHD_suspend_connection(w->conn);
+        parked = 1;
+    }
+    pthread_mutex_unlock(&w->mutex);
+    pthread_mutex_unlock(&srv->waiter_mutex);
+    return parked;
+}
+
+/* Resume every suspended image inference (caller holds waiter_mutex) */
+static void inference_resume_all(server_state_t* srv) {
+    while (srv->inference_waiters) {
+        inference_wait_t* w = srv->inference_waiters;
+        srv->inference_waiters = w->next_waiter;
+        w->next_waiter = NULL;
+        pthread_mutex_lock(&w->mutex);
+        if (w->suspended) {
+            w->suspended = 0;
+            MHD_resume_connection(w->conn);
+        }
+        pthread_mutex_unlock(&w->mutex);
+    }
+}
+
+/*
+ * Answer a resumed image inference. The deadline is enforced here: a
+ * result that took longer than INFERENCE_TIMEOUT_MS is a timeout, as for
+ * a blocking wait, and no result means the server is stopping.
+ */
+static int inference_reply(struct MHD_Connection* conn, cira_ctx* ctx, inference_wait_t* w) {
+    pthread_mutex_lock(&w->mutex);
+    int done = w->done;
+    double inference_ms = w->inference_ms;
+    pthread_mutex_unlock(&w->mutex);
+
+    if (!done) {
+        return send_inference_error(conn, MHD_HTTP_SERVICE_UNAVAILABLE, "Server stopping");
+    }
+    int status = inference_ms > INFERENCE_TIMEOUT_MS ? CIRA_PENDING : cira_request_status(w->req);
+    return send_inference_result(conn, ctx, w->req, status, &w->img, w->decode_ms, inference_ms);
+}
+
+/* Connection side done: off the server's list, drop the request and its reference */
+static void inference_wait_finish(inference_wait_t* w) {
+    server_state_t* srv = g_server;
+    if (srv) {
+        pthread_mutex_lock(&srv->waiter_mutex);
+        inference_wait_t** pp = &srv->inference_waiters;
+        while (*pp && *pp != w) pp = &(*pp)->next_waiter;
+        if (*pp) *pp = w->next_waiter;
+        pthread_mutex_unlock(&srv->waiter_mutex);
+    }
+    cira_request_release(w->req);
+    inference_wait_unref(w);
+}
+
 /**
  * Handle POST /api/inference/image - run inference on a single image.
- * Accepts either:
- * - {"path": "/path/to/image.jpg"} for device-local image
- * - Multipart form data with image upload (future)
+ * The body is either the image itself (JPEG or PNG, whatever the
+ * Content-Type) or {"path": "/path/to/image.jpg"} for an image on the
+ * device. The image is decoded at the reduced size the model needs and
+ * queued on the async predict path; boxes are in the image's own pixels.
+ * In event mode the connection is suspended until the request completes
+ * (*parked is set, and request_handler() answers when it is resumed).
  */
 static int handle_inference_image(struct MHD_Connection* conn, cira_ctx* ctx,
-                                  const char* upload_data, size_t upload_size) {
-    char response[MAX_RESPONSE_SIZE];
-
+                                  const char* upload_data, size_t upload_size,
+                                  inference_wait_t** parked) {
     /* Check if model is loaded */
     if (ctx->format == CIRA_FORMAT_UNKNOWN || ctx->model_handle == NULL) {
-        snprintf(response, sizeof(response),
-                "{\"success\":false,\"error\":\"No model loaded\"}");
+        return send_inference_error(conn, MHD_HTTP_BAD_REQUEST, "No model loaded");
+    }
 
-        struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
-            strlen(response), response, MHD_RESPMEM_MUST_COPY);
-        MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
-        MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
-        int ret = MHD_queue_response(conn, MHD_HTTP_BAD_REQUEST, mhd_response);
-        MHD_destroy_response(mhd_response);
+    decoded_image_t img;
+    char err[256] = "";
+    int result;
+    double t0 = cira_time_ms();
+
+    if (image_format_detect((const uint8_t*)upload_data, upload_size) != IMAGE_FORMAT_UNKNOWN) {
+        result = image_decode((const uint8_t*)upload_data, upload_size,
+                              ctx->input_w, ctx->input_h, &img, err, sizeof(err));
+    } else {
+        char image_path[512] = "";
+        json_body_str(upload_data, upload_size, "path", image_path, sizeof(image_path));
+        if (image_path[0] == '\0') {
+            return send_inference_error(conn, MHD_HTTP_BAD_REQUEST, "Missing image path or image data");
+        }
+
+        /* Security: Prevent path traversal */
+        if (strstr(image_path, "..") != NULL) {
+            return send_inference_error(conn, MHD_HTTP_BAD_REQUEST, "Invalid path");
+        }
+
+        struct stat st;
+        if (stat(image_path, &st) != 0) {
+            return send_inference_error(conn, MHD_HTTP_NOT_FOUND, "Image file not found");
+        }
+
+        fprintf(stderr, "Running inference on image: %s\n", image_path);
+        result = image_decode_file(image_path, ctx->input_w, ctx->input_h, &img, err, sizeof(err));
+    }
+
+    if (result != CIRA_OK) {
+        return send_inference_error(conn, result == CIRA_ERROR_INPUT ? MHD_HTTP_UNSUPPORTED_MEDIA_TYPE
+                                                                     : MHD_HTTP_INTERNAL_SERVER_ERROR,
+                                    err);
+    }
+    double decode_ms = cira_time_ms() - t0;
+
+    /* Event mode: the request callback resumes the connection instead of a pool thread waiting */
+    server_state_t* srv = g_server;
+    inference_wait_t* w = NULL;
+    if (srv && srv->event_mode) {
+        w = (inference_wait_t*)calloc(1, sizeof(inference_wait_t));
+        if (!w) {
+            image_free(&img);
+            return send_inference_error(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+        }
+        pthread_mutex_init(&w->mutex, NULL);
+        w->refs = 2;
+        w->conn = conn;
+    }
+
+    t0 = cira_time_ms();
+    if (w) w->submit_ms = t0;
+    cira_request* req = cira_predict_image_async(ctx, img.pixels, img.w, img.h, 3,
+                                                 w ? inference_done : NULL, w);
+    image_free(&img);
+    if (!req) {
+        if (w) {
+            pthread_mutex_destroy(&w->mutex);
+            free(w);
+        }
+        const char* error = cira_error(ctx);
+        return send_inference_error(conn, MHD_HTTP_SERVICE_UNAVAILABLE,
+                                    error && error[0] ? error : "Inference refused");
+    }
+
+    if (w) {
+        w->req = req;
+        w->img = img;
+        w->decode_ms = decode_ms;
+        if (inference_park(srv, w)) {
+            *parked = w;
+            return MHD_YES;
+        }
+        int ret = inference_reply(conn, ctx, w);
+        inference_wait_finish(w);
         return ret;
     }
 
-    /* Parse image path from POST data */
-    char image_path[512] = "";
+    int status = cira_request_wait(req, INFERENCE_TIMEOUT_MS);
+    int ret = send_inference_result(conn, ctx, req, status, &img, decode_ms, cira_time_ms() - t0);
+    cira_request_release(req);
+    return ret;
+}
 
-    if (upload_data && upload_size > 0) {
-        const char* path_key = strstr(upload_data, "\"path\"");
-        if (path_key) {
-            path_key = strchr(path_key + 6, '"');
-            if (path_key) {
-                path_key++;
-                const char* path_end = strchr(path_key, '"');
-                if (path_end) {
-                    size_t len = path_end - path_key;
-                    if (len >= sizeof(image_path)) len = sizeof(image_path) - 1;
-                    memcpy(image_path, path_key, len);
-                    image_path[len] = '\0';
-                }
+/*
+ * The "paths" array of a JSON body as malloc'd strings (\" and \\
+ * unescaped). Paths with ".." are refused.
+ *
+ * @return Paths (for image_batch_start()), or NULL if missing, empty,
+ *         invalid (*invalid set) or out of memory
+ */
+static char** json_body_paths(const char* data, size_t size, int* count, int* invalid) {
+    *count = 0;
+    *invalid = 0;
+    if (!data || size == 0) return NULL;
+
+    const char* p = strstr(data, "\"paths\"");
+    if (!p || !(p = strchr(p + 7, '['))) return NULL;
+    p++;
+
+    int n = 0, cap = 0;
+    char** paths = NULL;
+    for (;;) {
+        while (*p == ' ' || *p == ',' || *p == '\n' || *p == '\r' || *p == '\t') p++;
+        if (*p != '"' || n == IMAGE_BATCH_MAX_IMAGES) break;
+
+        const char* start = ++p;
+        size_t len = 0;
+        while (*p && *p != '"') {
+            if (*p == '\\' && p[1]) p++;
+            p++;
+            len++;
+        }
+        if (*p != '"') break;
+        p++;
+
+        char* path = (char*)malloc(len + 1);
+        if (!path) break;
+        const char* q = start;
+        for (size_t i = 0; i < len; i++) {
+            if (*q == '\\') q++;
+            path[i] = *q++;
+        }
+        path[len] = '\0';
+        if (strstr(path, "..") != NULL) {
+            free(path);
+            *invalid = 1;
+            break;
+        }
+
+        if (n == cap) {
+            cap = cap ? cap * 2 : 64;
+            char** grown = (char**)realloc(paths, cap * sizeof(char*));
+            if (!grown) {
+                free(path);
+                break;
             }
+            paths = grown;
         }
+        paths[n++] = path;
     }
 
-    if (image_path[0] == '\0') {
-        snprintf(response, sizeof(response),
-                "{\"success\":false,\"error\":\"Missing image path\"}");
-
-        struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
-            strlen(response), response, MHD_RESPMEM_MUST_COPY);
-        MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
-        MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
-        int ret = MHD_queue_response(conn, MHD_HTTP_BAD_REQUEST, mhd_response);
-        MHD_destroy_response(mhd_response);
-        return ret;
+    if (*invalid || n == 0) {
+        for (int i = 0; i < n; i++) free(paths[i]);
+        free(paths);
+        return NULL;
     }
+    *count = n;
+    return paths;
+}
 
-    /* Security: Prevent path traversal */
-    if (strstr(image_path, "..") != NULL) {
-        snprintf(response, sizeof(response),
-                "{\"success\":false,\"error\":\"Invalid path\"}");
+/* Image batch callback: wake the stream parked on that batch */
+static void batch_notify(void* arg, image_batch_t* batch) {
+    server_state_t* srv = (server_state_t*)arg;
+    pthread_mutex_lock(&srv->waiter_mutex);
+    resume_waiters(srv, batch);
+    pthread_mutex_unlock(&srv->waiter_mutex);
+}
 
-        struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
-            strlen(response), response, MHD_RESPMEM_MUST_COPY);
-        MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
-        MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
-        int ret = MHD_queue_response(conn, MHD_HTTP_BAD_REQUEST, mhd_response);
-        MHD_destroy_response(mhd_response);
-        return ret;
+/* No result line pending yet: as stream_wait_frame(), on the batch */
+static void batch_wait_output(stream_ctx_t* sctx) {
+    server_state_t* srv = g_server;
+    if (!srv || !srv->event_mode) {
+        image_batch_wait(sctx->batch, STREAM_WAIT_MS);
+        return;
     }
 
-    /* Check if file exists */
-    struct stat st;
-    if (stat(image_path, &st) != 0) {
-        snprintf(response, sizeof(response),
-                "{\"success\":false,\"error\":\"Image file not found\"}");
+    pthread_mutex_lock(&srv->waiter_mutex);
+    if (srv->running && !image_batch_readable(sctx->batch)) {
+        sctx->next_waiter = srv->waiters;
+        srv->waiters = sctx;
+        sctx->suspended = 1;
+        srv->parked++;
+        MHD_suspend_connection(sctx->conn);
+    }
+    pthread_mutex_unlock(&srv->waiter_mutex);
+}
 
-        struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
-            strlen(response), response, MHD_RESPMEM_MUST_COPY);
-        MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
-        MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
-        int ret = MHD_queue_response(conn, MHD_HTTP_NOT_FOUND, mhd_response);
-        MHD_destroy_response(mhd_response);
-        return ret;
+/* NDJSON stream of a batch's result lines. Returns 0 only after batch_wait_output(). */
+static ssize_t batch_callback(void* cls, uint64_t pos, char* buf, size_t max) {
+    (void)pos;
+    stream_ctx_t* sctx = (stream_ctx_t*)cls;
+
+    if (!sctx || !sctx->batch) {
+        return MHD_CONTENT_READER_END_WITH_ERROR;
+    }
+    if (!g_server || !g_server->running) {
+        return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+
+    int n = image_batch_read(sctx->batch, buf, max);
+    if (n < 0) {
+        return MHD_CONTENT_READER_END_OF_STREAM;
     }
+    if (n == 0) {
+        batch_wait_output(sctx);
+    }
+    return n;
+}
 
-    fprintf(stderr, "Running inference on image: %s\n", image_path);
+/**
+ * Handle POST /api/inference/batch - run inference on images stored on
+ * the device. Body: {"paths": ["/data/a.jpg", ...]} or
+ * {"dir": "/data/images", "limit": N} (JPEG and PNG files of the
+ * directory, by name), optionally "threads" for the decode threads.
+ * Streams one JSON line per image as it completes, then a summary line
+ * with "done":true. Closing the connection cancels the rest.
+ */
+static int handle_inference_batch(struct MHD_Connection* conn, cira_ctx* ctx,
+                                  const char* upload_data, size_t upload_size) {
+    if (ctx->format == CIRA_FORMAT_UNKNOWN || ctx->model_handle == NULL) {
+        return send_inference_error(conn, MHD_HTTP_BAD_REQUEST, "No model loaded");
+    }
 
-    /* Load and decode image using stb_image (include from jpeg_encoder.cpp) */
-    /* For now, we'll use OpenCV if available, or return an error */
-    /* TODO: Add direct image loading support */
+    char dir[1024];
+    char** paths;
+    int count = 0;
+    if (json_body_str(upload_data, upload_size, "dir", dir, sizeof(dir))) {
+        if (strstr(dir, "..") != NULL) {
+            return send_inference_error(conn, MHD_HTTP_BAD_REQUEST, "Invalid path");
+        }
+        paths = image_batch_list_dir(dir, json_body_int(upload_data, upload_size, "limit", 0), &count);
+        if (!paths) {
+            return send_inference_error(conn, MHD_HTTP_NOT_FOUND, "No JPEG or PNG images in directory");
+        }
+    } else {
+        int invalid;
+        paths = json_body_paths(upload_data, upload_size, &count, &invalid);
+        if (!paths) {
+            return send_inference_error(conn, MHD_HTTP_BAD_REQUEST,
+                                        invalid ? "Invalid path" : "Missing \"paths\" or \"dir\"");
+        }
+    }
 
-    /* Use cira_predict_image API - but we need to load the image first */
-    /* This requires OpenCV or stb_image integration */
+    stream_ctx_t* sctx = (stream_ctx_t*)calloc(1, sizeof(stream_ctx_t));
+    if (!sctx) {
+        for (int i = 0; i < count; i++) free(paths[i]);
+        free(paths);
+        return send_inference_error(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, "Memory allocation failed");
+    }
+    sctx->ctx = ctx;
+    sctx->conn = conn;
 
-    /* For now, store the path and let the frontend know it needs to upload */
-    /* In a full implementation, we'd load the image here and run inference */
+    server_state_t* srv = g_server;
+    int threads = json_body_int(upload_data, upload_size, "threads", 0);
+    sctx->batch = image_batch_start(ctx, paths, count, threads,
+                                    srv && srv->event_mode ? batch_notify : NULL, srv);
+    if (!sctx->batch) {
+        free(sctx);
+        return send_inference_error(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, "Failed to start the batch");
+    }
 
-    /* Placeholder response - indicates image inference is available but needs image data */
-    snprintf(response, sizeof(response),
-            "{\"success\":false,\"error\":\"Image loading not yet implemented. Use camera stream or upload via dashboard.\",\"path\":\"%s\"}",
-            image_path);
+    struct MHD_Response* response = MHD_create_response_from_callback(
+        MHD_SIZE_UNKNOWN, 32768, batch_callback, sctx, stream_free_callback);
+    if (!response) {
+        image_batch_destroy(sctx->batch);
+        free(sctx);
+        return send_inference_error(conn, MHD_HTTP_INTERNAL_SERVER_ERROR, "Failed to create response");
+    }
 
-    struct MHD_Response* mhd_response = MHD_create_response_from_buffer(
-        strlen(response), response, MHD_RESPMEM_MUST_COPY);
+    /* Counted in now: the free callback counts it out */
+    if (srv) {
+        pthread_mutex_lock(&srv->waiter_mutex);
+        srv->streams++;
+        pthread_mutex_unlock(&srv->waiter_mutex);
+    }
 
-    MHD_add_response_header(mhd_response, "Content-Type", CT_JSON);
-    MHD_add_response_header(mhd_response, "Access-Control-Allow-Origin", "*");
+    MHD_add_response_header(response, "Content-Type", CT_NDJSON);
+    MHD_add_response_header(response, "Cache-Control", "no-cache");
+    MHD_add_response_header(response, "Access-Control-Allow-Origin", "*");
 
-    int ret = MHD_queue_response(conn, MHD_HTTP_NOT_IMPLEMENTED, mhd_response);
-    MHD_destroy_response(mhd_response);
+    int ret = MHD_queue_response(conn, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
 
     return ret;
 }
@@ -1760,8 +3785,29 @@ typedef struct {
     char* data;
     size_t size;
     size_t capacity;
+    int too_large;      /* Body passed MAX_POST_SIZE and was dropped */
+    inference_wait_t* wait;     /* Suspended /api/inference/image */
 } post_ctx_t;
 
+static void post_ctx_free(post_ctx_t* pctx) {
+    if (pctx->wait) inference_wait_finish(pctx->wait);
+    free(pctx->data);
+    free(pctx);
+}
+
+/* MHD completion callback: free a POST context never finished (dropped
+ * upload, or a connection closed while suspended) */
+static void request_completed(void* cls, struct MHD_Connection* conn, void** con_cls,
+                              enum MHD_RequestTerminationCode toe) {
+    (void)cls;
+    (void)conn;
+    (void)toe;
+    if (*con_cls) {
+        post_ctx_free((post_ctx_t*)*con_cls);
+        *con_cls = NULL;
+    }
+}
+
 /**
  * Main request handler callback for MHD.
  */
@@ -1802,11 +3848,21 @@ static enum MHD_Result request_handler(
 
         /* Accumulate upload data */
         if (*upload_data_size > 0) {
+            if (pctx->too_large || pctx->size + *upload_data_size > MAX_POST_SIZE) {
+                pctx->too_large = 1;
+                *upload_data_size = 0;
+                return MHD_YES;
+            }
             if (pctx->size + *upload_data_size >= pctx->capacity) {
-                pctx->capacity = pctx->size + *upload_data_size + 1024;
-                char* new_data = (char*)realloc(pctx->data, pctx->capacity);
+                /* Doubling keeps multi-megabyte image uploads to a few reallocs */
+                size_t capacity = pctx->capacity * 2;
+                if (capacity < pctx->size + *upload_data_size + 1) {
+                    capacity = pctx->size + *upload_data_size + 1024;
+                }
+                char* new_data = (char*)realloc(pctx->data, capacity);
                 if (!new_data) return MHD_NO;
                 pctx->data = new_data;
+                pctx->capacity = capacity;
             }
             memcpy(pctx->data + pctx->size, upload_data, *upload_data_size);
             pctx->size += *upload_data_size;
@@ -1815,9 +3871,20 @@ static enum MHD_Result request_handler(
             return MHD_YES;
         }
 
+        /* Resumed: the suspended image inference completed (or the server is stopping) */
+        if (pctx->wait) {
+            int ret = inference_reply(conn, ctx, pctx->wait);
+            post_ctx_free(pctx);
+            *con_cls = NULL;
+            return ret;
+        }
+
         /* All data received - process request */
         int ret = MHD_NO;
-        if (strcmp(url, "/api/model") == 0) {
+        if (pctx->too_large) {
+            ret = send_json(conn, MHD_HTTP_PAYLOAD_TOO_LARGE,
+                            "{\"success\":false,\"error\":\"Request body too large\"}");
+        } else if (strcmp(url, "/api/model") == 0) {
             ret = handle_model_load(conn, ctx, pctx->data, pctx->size);
         } else if (strncmp(url, "/api/nodes/", 11) == 0 && strstr(url, "/model") != NULL) {
             /* Handle /api/nodes/:id/model - same as /api/model for standalone mode */
@@ -1825,16 +3892,24 @@ static enum MHD_Result request_handler(
         } else if (strcmp(url, "/api/camera/start") == 0) {
             ret = handle_camera_start(conn, ctx, pctx->data, pctx->size);
         } else if (strcmp(url, "/api/camera/stop") == 0) {
-            ret = handle_camera_stop(conn, ctx);
+            ret = handle_camera_stop(conn, ctx, pctx->data, pctx->size);
         } else if (strcmp(url, "/api/inference/image") == 0) {
-            ret = handle_inference_image(conn, ctx, pctx->data, pctx->size);
+            ret = handle_inference_image(conn, ctx, pctx->data, pctx->size, &pctx->wait);
+        } else if (strcmp(url, "/api/inference/batch") == 0) {
+            ret = handle_inference_batch(conn, ctx, pctx->data, pctx->size);
         } else {
             ret = handle_not_found(conn);
         }
 
+        /* Suspended: answered when resumed; the body is no longer needed */
+        if (pctx->wait) {
+            free(pctx->data);
+            pctx->data = NULL;
+            return ret;
+        }
+
         /* Clean up */
-        free(pctx->data);
-        free(pctx);
+        post_ctx_free(pctx);
         *con_cls = NULL;
 
         return ret;
@@ -1855,9 +3930,21 @@ static enum MHD_Result request_handler(
     if (strcmp(url, "/api/results") == 0) {
         return handle_results(conn, ctx);
     }
+    if (strcmp(url, "/api/results/stream") == 0) {
+        return handle_results_stream(conn, ctx);
+    }
+    if (strcmp(url, "/api/results/range") == 0) {
+        return handle_results_range(conn, ctx);
+    }
     if (strcmp(url, "/api/stats") == 0) {
         return handle_stats(conn, ctx);
     }
+    if (strcmp(url, "/metrics") == 0) {
+        return handle_metrics(conn, ctx);
+    }
+    if (strcmp(url, "/api/labels") == 0) {
+        return handle_labels(conn, ctx);
+    }
     if (strcmp(url, "/api/models") == 0) {
         return handle_models_list(conn, ctx);
     }
@@ -1963,6 +4050,9 @@ static enum MHD_Result request_handler(
     if (strcmp(url, "/stream/raw") == 0) {
         return handle_stream(conn, ctx, 0);  /* Raw */
     }
+    if (strcmp(url, "/stream/video") == 0) {
+        return handle_stream_video(conn, ctx);
+    }
     /* File-based frame transfer endpoints (cross-platform alternative to MJPEG) */
     if (strcmp(url, "/frame/latest") == 0) {
         return handle_frame_latest(conn, ctx);
@@ -1991,33 +4081,86 @@ int server_start(cira_ctx* ctx, int port) {
 
     g_server->ctx = ctx;
     g_server->port = port;
+    g_server->threads = ctx->server_threads;
+    pthread_mutex_init(&g_server->waiter_mutex, NULL);
+    pthread_mutex_init(&g_server->sse_mutex, NULL);
+    pthread_cond_init(&g_server->sse_cond, NULL);
+
+    /* Server threads (pool, listener, per-connection) inherit the HTTP CPUs */
+    cpu_mask_t caller_mask = cpu_affinity_get_self();
+    cira_pin_thread(ctx, CPU_CLASS_HTTP);
+
+    const char* mode = "threads";
+    if (ctx->server_mode == CIRA_SERVER_EVENT) {
+#if MHD_VERSION >= 0x00095700
+        /* Event loop on a thread pool; MJPEG streams suspend between frames */
+        int epoll = MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES;
+        unsigned int flags = (epoll ? MHD_USE_EPOLL_INTERNAL_THREAD : MHD_USE_POLL_INTERNAL_THREAD) |
+                             MHD_ALLOW_SUSPEND_RESUME;
+        g_server->event_mode = 1;
+        mode = epoll ? "epoll" : "poll";
+        g_server->daemon = MHD_start_daemon(
+            flags,
+            port,
+            NULL, NULL,                         /* Accept policy */
+            &request_handler, ctx,              /* Request handler */
+            MHD_OPTION_THREAD_POOL_SIZE, (unsigned int)g_server->threads,
+            MHD_OPTION_NOTIFY_COMPLETED, &request_completed, NULL,
+            MHD_OPTION_END
+        );
+#else
+        fprintf(stderr, "libmicrohttpd too old for the event server, using thread per connection\n");
+#endif
+    }
 
-    /* Start MHD daemon */
-    g_server->daemon = MHD_start_daemon(
-        MHD_USE_SELECT_INTERNALLY | MHD_USE_THREAD_PER_CONNECTION,
-        port,
-        NULL, NULL,                         /* Accept policy */
-        &request_handler, ctx,              /* Request handler */
-        MHD_OPTION_END
-    );
+    if (!g_server->event_mode) {
+        /* Start MHD daemon */
+        g_server->daemon = MHD_start_daemon(
+            MHD_USE_SELECT_INTERNALLY | MHD_USE_THREAD_PER_CONNECTION,
+            port,
+            NULL, NULL,                         /* Accept policy */
+            &request_handler, ctx,              /* Request handler */
+            MHD_OPTION_NOTIFY_COMPLETED, &request_completed, NULL,
+            MHD_OPTION_END
+        );
+    }
+    if (ctx->cpu_masks[CPU_CLASS_HTTP]) {
+        cpu_affinity_set_self(caller_mask);
+    }
 
     if (!g_server->daemon) {
         fprintf(stderr, "Failed to start HTTP server on port %d\n", port);
+        pthread_mutex_destroy(&g_server->waiter_mutex);
+        pthread_mutex_destroy(&g_server->sse_mutex);
+        pthread_cond_destroy(&g_server->sse_cond);
         free(g_server);
         g_server = NULL;
         return CIRA_ERROR;
     }
 
     g_server->running = 1;
+    ctx->server_port = port;
+
+    /* Push results to /api/results/stream subscribers as they are stored */
+    pthread_mutex_lock(&ctx->result_mutex);
+    ctx->result_notify = sse_result_notify;
+    ctx->result_notify_arg = g_server;
+    pthread_mutex_unlock(&ctx->result_mutex);
 
-    fprintf(stderr, "HTTP server started on port %d\n", port);
+    if (g_server->event_mode) {
+        fprintf(stderr, "HTTP server started on port %d (%s, %d threads)\n", port, mode, g_server->threads);
+    } else {
+        fprintf(stderr, "HTTP server started on port %d (thread per connection)\n", port);
+    }
     fprintf(stderr, "  Web UI:    http://localhost:%d/\n", port);
     fprintf(stderr, "  Health:    http://localhost:%d/health\n", port);
     fprintf(stderr, "  Snapshot:  http://localhost:%d/snapshot\n", port);
     fprintf(stderr, "  Stream:    http://localhost:%d/stream/annotated\n", port);
-    fprintf(stderr, "  Frame:     http://localhost:%d/frame/latest (file-based)\n", port);
-    fprintf(stderr, "  Results:   http://localhost:%d/api/results\n", port);
+    fprintf(stderr, "  Frame:     http://localhost:%d/frame/latest (%s)\n", port,
+            ctx->frame_ring_format >= 0 ? "frame ring" : "file-based");
+    fprintf(stderr, "  Results:   http://localhost:%d/api/results (push: /api/results/stream)\n", port);
     fprintf(stderr, "  Stats:     http://localhost:%d/api/stats\n", port);
+    fprintf(stderr, "  Metrics:   http://localhost:%d/metrics (Prometheus)\n", port);
 
     return CIRA_OK;
 }
@@ -2026,16 +4169,40 @@ int server_start(cira_ctx* ctx, int port) {
  * Stop HTTP streaming server.
  */
 int server_stop(cira_ctx* ctx) {
-    (void)ctx;
-
     if (!g_server || !g_server->running) return CIRA_OK;
 
+    /* Stop frame and result notifications, then let parked streams see the shutdown */
+    pthread_mutex_lock(&ctx->result_mutex);
+    ctx->result_notify = NULL;
+    ctx->result_notify_arg = NULL;
+    pthread_mutex_unlock(&ctx->result_mutex);
+    if (g_server->event_mode) {
+        frame_store_set_notify(ctx->frame_store, NULL, NULL);
+        for (int i = 0; i < CIRA_MAX_CAMERAS; i++) {
+            frame_store_set_notify(ctx->cameras[i].frame_store, NULL, NULL);
+            video_encoder_set_notify(ctx->cameras[i].video, NULL, NULL);
+        }
+    }
+    pthread_mutex_lock(&g_server->waiter_mutex);
+    g_server->running = 0;
+    resume_waiters(g_server, NULL);
+    inference_resume_all(g_server);
+    pthread_mutex_unlock(&g_server->waiter_mutex);
+
+    pthread_mutex_lock(&g_server->sse_mutex);
+    sse_resume_locked(g_server);
+    pthread_cond_broadcast(&g_server->sse_cond);
+    pthread_mutex_unlock(&g_server->sse_mutex);
+
     MHD_stop_daemon(g_server->daemon);
     g_server->daemon = NULL;
-    g_server->running = 0;
+    sse_clear(g_server);
 
     fprintf(stderr, "HTTP server stopped\n");
 
+    pthread_mutex_destroy(&g_server->waiter_mutex);
+    pthread_mutex_destroy(&g_server->sse_mutex);
+    pthread_cond_destroy(&g_server->sse_cond);
     free(g_server);
     g_server = NULL;
 
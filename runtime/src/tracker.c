@@ -0,0 +1,314 @@
+/**
+ * CiRA Runtime - Multi-Object Tracker
+ *
+ * Each coordinate of a track (centre x/y, width, height) has its own
+ * position/velocity Kalman filter, so a predict or update is a handful of
+ * scalar operations per coordinate instead of 8x8 matrix products. Noise
+ * scales with the box height, so small and large objects are tracked
+ * alike in normalized coordinates, and time steps come from frame
+ * timestamps, so an irregular frame rate does not skew velocities.
+ *
+ * Association collects the track/detection pairs that overlap enough,
+ * sorts them by IoU and takes them best first.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "tracker.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Live tracks per tracker */
+#define TRACKER_MAX_TRACKS CIRA_MAX_DETECTIONS
+
+/* Noise, as fractions of the box height (per second for the motion terms) */
+#define TRACKER_MEASURE_STD 0.05f   /* Detector box jitter */
+#define TRACKER_ACCEL_STD   1.0f    /* Unmodelled acceleration */
+#define TRACKER_INIT_VEL_STD 1.0f   /* Velocity of a new track */
+
+/* Longest step predicted at once (a stalled camera should not fling boxes) */
+#define TRACKER_MAX_DT 1.0f
+
+/* Coordinates: centre x, centre y, width, height */
+#define TRACK_DIMS 4
+
+typedef struct {
+    int id;
+    int label_id;
+    float confidence;           /* Of the last matched detection */
+    float pos[TRACK_DIMS];
+    float vel[TRACK_DIMS];      /* Per second */
+    float p00[TRACK_DIMS];      /* Covariance: position, cross term, velocity */
+    float p01[TRACK_DIMS];
+    float p11[TRACK_DIMS];
+    double time_ms;             /* Time the state refers to */
+    int hits;
+    int misses;                 /* Updates since the last match */
+} track_t;
+
+typedef struct {
+    int track;
+    int det;
+    float iou;
+} track_pair_t;
+
+struct tracker {
+    tracker_config_t config;
+    track_t tracks[TRACKER_MAX_TRACKS];
+    int count;
+    int next_id;
+
+    /* Scratch for tracker_update() */
+    uint8_t track_used[TRACKER_MAX_TRACKS];
+    uint8_t det_used[CIRA_MAX_DETECTIONS];
+    track_pair_t* pairs;
+    int pairs_capacity;
+};
+
+void tracker_default_config(tracker_config_t* config) {
+    config->high_threshold = 0.5f;
+    config->match_iou = 0.3f;
+    config->max_misses = 3;
+    config->min_hits = 2;
+}
+
+tracker_t* tracker_create(const tracker_config_t* config) {
+    tracker_t* t = (tracker_t*)calloc(1, sizeof(tracker_t));
+    if (!t) return NULL;
+
+    if (config) {
+        t->config = *config;
+    } else {
+        tracker_default_config(&t->config);
+    }
+    t->next_id = 1;
+    return t;
+}
+
+void tracker_destroy(tracker_t* tracker) {
+    if (!tracker) return;
+    free(tracker->pairs);
+    free(tracker);
+}
+
+void tracker_reset(tracker_t* tracker) {
+    tracker->count = 0;
+}
+
+int tracker_count(const tracker_t* tracker) {
+    return tracker->count;
+}
+
+/* Noise scale of a track: its height, bounded so tiny boxes still move */
+static float track_scale(const track_t* tr) {
+    return tr->pos[3] > 0.01f ? tr->pos[3] : 0.01f;
+}
+
+static void box_to_state(const cira_detection_t* det, float* z) {
+    z[0] = det->x + det->w * 0.5f;
+    z[1] = det->y + det->h * 0.5f;
+    z[2] = det->w;
+    z[3] = det->h;
+}
+
+static void track_init(track_t* tr, int id, const cira_detection_t* det, double time_ms) {
+    memset(tr, 0, sizeof(*tr));
+    tr->id = id;
+    tr->label_id = det->label_id;
+    tr->confidence = det->confidence;
+    tr->time_ms = time_ms;
+    tr->hits = 1;
+
+    box_to_state(det, tr->pos);
+    float s = track_scale(tr);
+    float r = TRACKER_MEASURE_STD * s;
+    float v = TRACKER_INIT_VEL_STD * s;
+    for (int d = 0; d < TRACK_DIMS; d++) {
+        tr->p00[d] = 4.0f * r * r;
+        tr->p11[d] = v * v;
+    }
+}
+
+/* Kalman predict to time_ms (earlier times, e.g. a late frame, are ignored) */
+static void track_predict(track_t* tr, double time_ms) {
+    float dt = (float)((time_ms - tr->time_ms) / 1000.0);
+    if (dt <= 0.0f) return;
+    if (dt > TRACKER_MAX_DT) dt = TRACKER_MAX_DT;
+    tr->time_ms = time_ms;
+
+    float a = TRACKER_ACCEL_STD * track_scale(tr);
+    float q = a * a;
+    for (int d = 0; d < TRACK_DIMS; d++) {
+        tr->pos[d] += tr->vel[d] * dt;
+        tr->p00[d] += dt * (2.0f * tr->p01[d] + dt * tr->p11[d]) + q * dt * dt * dt / 3.0f;
+        tr->p01[d] += dt * tr->p11[d] + q * dt * dt / 2.0f;
+        tr->p11[d] += q * dt;
+    }
+
+    /* Shrinking boxes must not turn inside out */
+    if (tr->pos[2] < 0.001f) tr->pos[2] = 0.001f;
+    if (tr->pos[3] < 0.001f) tr->pos[3] = 0.001f;
+}
+
+/* Kalman update with a matched detection */
+static void track_update(track_t* tr, const cira_detection_t* det) {
+    float z[TRACK_DIMS];
+    box_to_state(det, z);
+
+    float r = TRACKER_MEASURE_STD * track_scale(tr);
+    float rr = r * r;
+    for (int d = 0; d < TRACK_DIMS; d++) {
+        float y = z[d] - tr->pos[d];
+        float s = tr->p00[d] + rr;
+        float k0 = tr->p00[d] / s;
+        float k1 = tr->p01[d] / s;
+        tr->pos[d] += k0 * y;
+        tr->vel[d] += k1 * y;
+        tr->p11[d] -= k1 * tr->p01[d];
+        tr->p00[d] *= 1.0f - k0;
+        tr->p01[d] *= 1.0f - k0;
+    }
+
+    tr->label_id = det->label_id;
+    tr->confidence = det->confidence;
+    tr->hits++;
+    tr->misses = 0;
+}
+
+/* Current box of a track, clipped to the frame; 0 if it has left it */
+static int track_box(const track_t* tr, cira_detection_t* out) {
+    float x0 = tr->pos[0] - tr->pos[2] * 0.5f;
+    float y0 = tr->pos[1] - tr->pos[3] * 0.5f;
+    float x1 = x0 + tr->pos[2];
+    float y1 = y0 + tr->pos[3];
+    if (x0 < 0.0f) x0 = 0.0f;
+    if (y0 < 0.0f) y0 = 0.0f;
+    if (x1 > 1.0f) x1 = 1.0f;
+    if (y1 > 1.0f) y1 = 1.0f;
+    if (x1 <= x0 || y1 <= y0) return 0;
+
+    out->x = x0;
+    out->y = y0;
+    out->w = x1 - x0;
+    out->h = y1 - y0;
+    out->confidence = tr->confidence;
+    out->label_id = tr->label_id;
+    return 1;
+}
+
+static float box_iou(const cira_detection_t* a, const cira_detection_t* b) {
+    float x0 = a->x > b->x ? a->x : b->x;
+    float y0 = a->y > b->y ? a->y : b->y;
+    float x1 = (a->x + a->w) < (b->x + b->w) ? (a->x + a->w) : (b->x + b->w);
+    float y1 = (a->y + a->h) < (b->y + b->h) ? (a->y + a->h) : (b->y + b->h);
+    if (x1 <= x0 || y1 <= y0) return 0.0f;
+
+    float inter = (x1 - x0) * (y1 - y0);
+    return inter / (a->w * a->h + b->w * b->h - inter);
+}
+
+static int pair_cmp(const void* a, const void* b) {
+    float ia = ((const track_pair_t*)a)->iou;
+    float ib = ((const track_pair_t*)b)->iou;
+    return (ia < ib) - (ia > ib);
+}
+
+/* Match free tracks to free detections of one confidence band, best overlap first */
+static void associate(tracker_t* t, const cira_detection_t* dets, int count, int high) {
+    const tracker_config_t* cfg = &t->config;
+    int n = 0;
+
+    for (int i = 0; i < t->count; i++) {
+        if (t->track_used[i]) continue;
+
+        cira_detection_t box;
+        if (!track_box(&t->tracks[i], &box)) continue;
+
+        for (int j = 0; j < count; j++) {
+            if (t->det_used[j] || (dets[j].confidence >= cfg->high_threshold) != high) continue;
+            if (dets[j].label_id != t->tracks[i].label_id) continue;
+
+            float iou = box_iou(&box, &dets[j]);
+            if (iou < cfg->match_iou) continue;
+
+            if (n == t->pairs_capacity) {
+                int capacity = t->pairs_capacity ? t->pairs_capacity * 2 : 256;
+                track_pair_t* pairs = (track_pair_t*)realloc(t->pairs,
+                                                             capacity * sizeof(track_pair_t));
+                if (!pairs) break;
+                t->pairs = pairs;
+                t->pairs_capacity = capacity;
+            }
+            t->pairs[n].track = i;
+            t->pairs[n].det = j;
+            t->pairs[n].iou = iou;
+            n++;
+        }
+    }
+
+    if (n == 0) return;
+
+    qsort(t->pairs, n, sizeof(track_pair_t), pair_cmp);
+    for (int k = 0; k < n; k++) {
+        const track_pair_t* p = &t->pairs[k];
+        if (t->track_used[p->track] || t->det_used[p->det]) continue;
+        track_update(&t->tracks[p->track], &dets[p->det]);
+        t->track_used[p->track] = 1;
+        t->det_used[p->det] = 1;
+    }
+}
+
+/* Confirmed tracks that the last update matched */
+static int report(const tracker_t* t, cira_detection_t* out, int* ids, int max_out) {
+    int n = 0;
+    for (int i = 0; i < t->count && n < max_out; i++) {
+        const track_t* tr = &t->tracks[i];
+        if (tr->misses > 0 || tr->hits < t->config.min_hits) continue;
+        if (track_box(tr, &out[n])) {
+            ids[n++] = tr->id;
+        }
+    }
+    return n;
+}
+
+int tracker_update(tracker_t* tracker, const cira_detection_t* dets, int count, double time_ms,
+                   cira_detection_t* out, int* ids, int max_out) {
+    tracker_t* t = tracker;
+    if (count > CIRA_MAX_DETECTIONS) count = CIRA_MAX_DETECTIONS;
+
+    for (int i = 0; i < t->count; i++) {
+        track_predict(&t->tracks[i], time_ms);
+    }
+    memset(t->track_used, 0, sizeof(t->track_used));
+    memset(t->det_used, 0, sizeof(t->det_used));
+
+    /* Confident detections first, then the rest for tracks still unmatched */
+    associate(t, dets, count, 1);
+    associate(t, dets, count, 0);
+
+    /* Age out tracks that keep missing */
+    int kept = 0;
+    for (int i = 0; i < t->count; i++) {
+        track_t* tr = &t->tracks[i];
+        if (!t->track_used[i] && ++tr->misses > t->config.max_misses) continue;
+        if (kept != i) t->tracks[kept] = *tr;
+        kept++;
+    }
+    t->count = kept;
+
+    /* Unmatched confident detections start tracks */
+    for (int j = 0; j < count && t->count < TRACKER_MAX_TRACKS; j++) {
+        if (t->det_used[j] || dets[j].confidence < t->config.high_threshold) continue;
+        track_init(&t->tracks[t->count++], t->next_id++, &dets[j], time_ms);
+    }
+
+    return report(t, out, ids, max_out);
+}
+
+int tracker_predict(tracker_t* tracker, double time_ms, cira_detection_t* out, int* ids,
+                    int max_out) {
+    for (int i = 0; i < tracker->count; i++) {
+        track_predict(&tracker->tracks[i], time_ms);
+    }
+    return report(tracker, out, ids, max_out);
+}
@@ -1,151 +0,0 @@
-/**
- * CiRA Runtime - TensorRT Model Loader
- *
- * This file implements loading and inference for TensorRT engines.
- * TensorRT provides optimized inference on NVIDIA GPUs, especially
- * on Jetson devices.
- *
- * (c) CiRA Robotics / KMITL 2026
- */
-
-#include "cira.h"
-#include "cira_internal.h"
-#include <stdlib.h>
-#include <string.h>
-#include <stdio.h>
-
-#ifdef CIRA_TRT_ENABLED
-
-/* TensorRT C API is actually C++, so we need to wrap it */
-/* For now, provide stub implementation */
-
-/* Internal TensorRT model structure */
-typedef struct {
-    void* engine;           /* nvinfer1::ICudaEngine* */
-    void* context;          /* nvinfer1::IExecutionContext* */
-    void* runtime;          /* nvinfer1::IRuntime* */
-
-    /* GPU buffers */
-    void* input_buffer;
-    void* output_buffer;
-
-    /* Dimensions */
-    int input_w;
-    int input_h;
-    int input_c;
-    int num_classes;
-    size_t input_size;
-    size_t output_size;
-} trt_model_t;
-
-/**
- * Load a TensorRT engine.
- *
- * @param ctx Context handle
- * @param model_path Path to .engine or .trt file
- * @return CIRA_OK on success
- */
-int trt_load(cira_ctx* ctx, const char* model_path) {
-    (void)ctx;
-
-    fprintf(stderr, "Loading TensorRT engine: %s\n", model_path);
-
-    /* TODO: Implement TensorRT loading */
-    /*
-     * 1. Read engine file
-     * FILE* f = fopen(model_path, "rb");
-     * fseek(f, 0, SEEK_END);
-     * size_t size = ftell(f);
-     * fseek(f, 0, SEEK_SET);
-     * char* engine_data = malloc(size);
-     * fread(engine_data, 1, size, f);
-     * fclose(f);
-     *
-     * 2. Create runtime and deserialize engine
-     * nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(logger);
-     * nvinfer1::ICudaEngine* engine = runtime->deserializeCudaEngine(engine_data, size);
-     *
-     * 3. Create execution context
-     * nvinfer1::IExecutionContext* context = engine->createExecutionContext();
-     *
-     * 4. Get input/output dimensions
-     * 5. Allocate CUDA buffers
-     */
-
-    fprintf(stderr, "TensorRT loading not yet implemented\n");
-    return CIRA_ERROR_MODEL;
-}
-
-/**
- * Unload TensorRT engine.
- */
-void trt_unload(cira_ctx* ctx) {
-    (void)ctx;
-
-    /* TODO: Clean up TensorRT resources */
-    /*
-     * trt_model_t* model = (trt_model_t*)ctx->model_handle;
-     * if (model) {
-     *     cudaFree(model->input_buffer);
-     *     cudaFree(model->output_buffer);
-     *     model->context->destroy();
-     *     model->engine->destroy();
-     *     model->runtime->destroy();
-     *     free(model);
-     * }
-     */
-}
-
-/**
- * Run TensorRT inference on an image.
- */
-int trt_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
-    (void)ctx;
-    (void)data;
-    (void)w;
-    (void)h;
-    (void)channels;
-
-    /* TODO: Implement TensorRT inference */
-    /*
-     * 1. Preprocess image (resize, normalize, convert to NCHW)
-     * 2. Copy input to GPU
-     * cudaMemcpy(model->input_buffer, input_data, model->input_size, cudaMemcpyHostToDevice);
-     *
-     * 3. Run inference
-     * void* bindings[] = { model->input_buffer, model->output_buffer };
-     * model->context->executeV2(bindings);
-     *
-     * 4. Copy output from GPU
-     * cudaMemcpy(output_data, model->output_buffer, model->output_size, cudaMemcpyDeviceToHost);
-     *
-     * 5. Parse detections and store in ctx->detections
-     */
-
-    return CIRA_ERROR_MODEL;
-}
-
-#else /* CIRA_TRT_ENABLED */
-
-/* Stubs when TensorRT is not enabled */
-int trt_load(cira_ctx* ctx, const char* model_path) {
-    (void)ctx;
-    (void)model_path;
-    fprintf(stderr, "TensorRT support not enabled in this build\n");
-    return CIRA_ERROR_MODEL;
-}
-
-void trt_unload(cira_ctx* ctx) {
-    (void)ctx;
-}
-
-int trt_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
-    (void)ctx;
-    (void)data;
-    (void)w;
-    (void)h;
-    (void)channels;
-    return CIRA_ERROR_MODEL;
-}
-
-#endif /* CIRA_TRT_ENABLED */
@@ -0,0 +1,748 @@
+/**
+ * CiRA Runtime - TensorRT Model Loader
+ *
+ * This file implements loading and inference for TensorRT engines.
+ * TensorRT provides optimized inference on NVIDIA GPUs, especially
+ * on Jetson devices.
+ *
+ * Every buffer is allocated once at load: pinned host staging for the
+ * camera frame and the outputs, device buffers for the frame, the input
+ * tensor and the outputs. A frame is uploaded as raw RGB bytes, then
+ * letterboxed and normalized on the GPU (trt_preprocess.cu); upload,
+ * preprocess, execute and download are queued on the slot's own CUDA
+ * stream with a single synchronize at the end.
+ *
+ * The engine has two execution slots (context + stream + buffers). The
+ * batch path alternates between them so frame N+1 uploads and
+ * preprocesses while frame N executes; concurrent callers sharing the
+ * model each take a free slot. Each slot decodes into its own host
+ * scratch, so two slots can finish frames at the same time.
+ *
+ * Buffers are sized from the engine's binding shapes as resolved by the
+ * execution context. An engine built with a fixed batch > 1 gets the
+ * whole batch allocated; frames go into item 0 and only item 0 is
+ * decoded.
+ *
+ * Uses the name-based I/O tensor API (TensorRT 8.5+, including 10.x).
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cira.h"
+#include "cira_internal.h"
+#include "model_file.h"
+#include "preprocess.h"
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <new>
+#include <algorithm>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef CIRA_TRT_ENABLED
+
+#include <NvInfer.h>
+#include <cuda_runtime_api.h>
+
+/* Execution slots (double buffering) */
+#define TRT_NUM_SLOTS 2
+
+/* Maximum engine outputs */
+#define TRT_MAX_OUTPUTS 4
+
+/* Initial frame staging capacity (grown on demand) */
+#define TRT_DEFAULT_FRAME_BYTES (1920 * 1080 * 3)
+
+/* GPU preprocessing (trt_preprocess.cu) */
+extern "C" int trt_preprocess_launch(const uint8_t* src, int src_w, int src_h,
+                                     void* dst, int dst_w, int dst_h, int fp16,
+                                     float scale_x, float scale_y, int pad_x, int pad_y,
+                                     int new_w, int new_h, cudaStream_t stream);
+
+/* Forward TensorRT messages at warning level and above */
+class TrtLogger : public nvinfer1::ILogger {
+public:
+    void log(Severity severity, const char* msg) noexcept override {
+        if (severity <= Severity::kWARNING) {
+            fprintf(stderr, "TensorRT: %s\n", msg);
+        }
+    }
+};
+
+static TrtLogger g_logger;
+
+/* Per-slot execution state */
+struct trt_slot_t {
+    nvinfer1::IExecutionContext* context;
+    cudaStream_t stream;
+    bool busy;
+
+    /* Frame staging (pinned host + device, raw RGB) */
+    uint8_t* host_frame;
+    uint8_t* dev_frame;
+    size_t frame_capacity;
+
+    /* Engine I/O */
+    void* dev_input;
+    void* dev_outputs[TRT_MAX_OUTPUTS];
+    void* host_outputs[TRT_MAX_OUTPUTS];    /* Pinned */
+
+    /* Host decode scratch (float32 view of one output item) */
+    float* decode_buffer;
+
+    /* Geometry of the frame in flight (to undo the letterbox) */
+    int src_w;
+    int src_h;
+    float scale_x;
+    float scale_y;
+    int pad_x;
+    int pad_y;
+};
+
+/* Internal TensorRT model structure */
+struct trt_model_t {
+    nvinfer1::IRuntime* runtime;
+    nvinfer1::ICudaEngine* engine;
+
+    trt_slot_t slots[TRT_NUM_SLOTS];
+    pthread_mutex_t slot_mutex;
+    pthread_cond_t slot_cond;
+
+    /* Input tensor */
+    char input_name[128];
+    bool input_fp16;
+    int input_batch;            /* Fixed batch dim of the engine, 1 if dynamic */
+    size_t input_bytes;         /* Whole binding, every batch item */
+
+    /* Output tensors */
+    char output_names[TRT_MAX_OUTPUTS][128];
+    int64_t output_shapes[TRT_MAX_OUTPUTS][6];
+    int output_dims[TRT_MAX_OUTPUTS];
+    bool output_fp16[TRT_MAX_OUTPUTS];
+    size_t output_elements[TRT_MAX_OUTPUTS];   /* Whole binding, every batch item */
+    int num_outputs;
+
+    /* Dimensions */
+    int input_w;
+    int input_h;
+    int input_c;
+    int num_classes;
+    bool letterbox;
+};
+
+/* Log a CUDA error; returns true on failure */
+static bool cuda_failed(cudaError_t err, const char* what) {
+    if (err == cudaSuccess) return false;
+    fprintf(stderr, "TensorRT: %s failed: %s\n", what, cudaGetErrorString(err));
+    return true;
+}
+
+/* Check if path is a directory */
+static int is_dir(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    return S_ISDIR(st.st_mode);
+}
+
+/* Find file with extension in directory */
+static int find_file_ext(const char* dir, const char* ext, char* out, size_t out_size) {
+    DIR* d = opendir(dir);
+    if (!d) return 0;
+
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr) {
+        const char* name = entry->d_name;
+        size_t len = strlen(name);
+        size_t ext_len = strlen(ext);
+
+        if (len > ext_len && strcmp(name + len - ext_len, ext) == 0) {
+            snprintf(out, out_size, "%s/%s", dir, name);
+            closedir(d);
+            return 1;
+        }
+    }
+
+    closedir(d);
+    return 0;
+}
+
+static size_t element_size(nvinfer1::DataType type) {
+    return type == nvinfer1::DataType::kHALF ? 2 : 4;
+}
+
+/* Free a slot's buffers, context and stream */
+static void destroy_slot(trt_slot_t* slot) {
+    if (slot->host_frame) cudaFreeHost(slot->host_frame);
+    if (slot->dev_frame) cudaFree(slot->dev_frame);
+    if (slot->dev_input) cudaFree(slot->dev_input);
+    for (int i = 0; i < TRT_MAX_OUTPUTS; i++) {
+        if (slot->dev_outputs[i]) cudaFree(slot->dev_outputs[i]);
+        if (slot->host_outputs[i]) cudaFreeHost(slot->host_outputs[i]);
+    }
+    delete[] slot->decode_buffer;
+    if (slot->stream) cudaStreamDestroy(slot->stream);
+    delete slot->context;
+    memset(slot, 0, sizeof(*slot));
+}
+
+static void destroy_model(trt_model_t* model) {
+    for (int i = 0; i < TRT_NUM_SLOTS; i++) {
+        destroy_slot(&model->slots[i]);
+    }
+    delete model->engine;
+    delete model->runtime;
+    pthread_mutex_destroy(&model->slot_mutex);
+    pthread_cond_destroy(&model->slot_cond);
+    delete model;
+}
+
+/* Grow a slot's frame staging buffers (only when a frame exceeds them) */
+static bool reserve_frame(trt_slot_t* slot, size_t bytes) {
+    if (bytes <= slot->frame_capacity) return true;
+
+    if (slot->host_frame) cudaFreeHost(slot->host_frame);
+    if (slot->dev_frame) cudaFree(slot->dev_frame);
+    slot->host_frame = nullptr;
+    slot->dev_frame = nullptr;
+    slot->frame_capacity = 0;
+
+    if (cuda_failed(cudaMallocHost((void**)&slot->host_frame, bytes), "cudaMallocHost(frame)") ||
+        cuda_failed(cudaMalloc((void**)&slot->dev_frame, bytes), "cudaMalloc(frame)")) {
+        return false;
+    }
+    slot->frame_capacity = bytes;
+    return true;
+}
+
+/* Create a slot: execution context, stream, and all I/O buffers */
+static bool create_slot(trt_model_t* model, trt_slot_t* slot, int profile) {
+    slot->context = model->engine->createExecutionContext();
+    if (!slot->context) {
+        fprintf(stderr, "TensorRT: failed to create execution context\n");
+        return false;
+    }
+
+    if (cuda_failed(cudaStreamCreateWithFlags(&slot->stream, cudaStreamNonBlocking),
+                    "cudaStreamCreate")) {
+        return false;
+    }
+
+    /* Separate profiles let both contexts run dynamic-shape engines at once */
+    if (profile > 0) {
+        slot->context->setOptimizationProfileAsync(profile, slot->stream);
+    }
+
+    /* Fix dynamic input dims to the model input size */
+    nvinfer1::Dims in_dims = model->engine->getTensorShape(model->input_name);
+    bool dynamic = false;
+    for (int i = 0; i < in_dims.nbDims; i++) {
+        if (in_dims.d[i] < 0) dynamic = true;
+    }
+    if (dynamic) {
+        nvinfer1::Dims4 shape(model->input_batch, model->input_c, model->input_h, model->input_w);
+        if (!slot->context->setInputShape(model->input_name, shape)) {
+            fprintf(stderr, "TensorRT: failed to set input shape\n");
+            return false;
+        }
+    }
+
+    /* Output shapes as resolved for that input (the same for every slot) */
+    size_t max_item_elements = 0;
+    for (int i = 0; i < model->num_outputs; i++) {
+        nvinfer1::Dims dims = slot->context->getTensorShape(model->output_names[i]);
+        if (dims.nbDims < 1 || dims.nbDims > 6) {
+            fprintf(stderr, "TensorRT: unsupported rank %d for output '%s'\n",
+                    dims.nbDims, model->output_names[i]);
+            return false;
+        }
+        model->output_dims[i] = dims.nbDims;
+        model->output_elements[i] = 1;
+        for (int d = 0; d < dims.nbDims; d++) {
+            if (dims.d[d] < 0) {
+                fprintf(stderr, "TensorRT: output '%s' has an unresolved dimension\n",
+                        model->output_names[i]);
+                return false;
+            }
+            model->output_shapes[i][d] = dims.d[d];
+            model->output_elements[i] *= (size_t)dims.d[d];
+        }
+        if (model->input_batch > 1 && model->output_shapes[i][0] != model->input_batch) {
+            fprintf(stderr, "TensorRT: output '%s' has batch dim %lld, expected %d\n",
+                    model->output_names[i], (long long)model->output_shapes[i][0],
+                    model->input_batch);
+            return false;
+        }
+        max_item_elements = std::max(max_item_elements,
+                                     model->output_elements[i] / model->input_batch);
+    }
+
+    if (!reserve_frame(slot, TRT_DEFAULT_FRAME_BYTES)) return false;
+
+    /* Items past the first never get a frame; keep them zeroed */
+    if (cuda_failed(cudaMalloc(&slot->dev_input, model->input_bytes), "cudaMalloc(input)") ||
+        cuda_failed(cudaMemset(slot->dev_input, 0, model->input_bytes), "cudaMemset(input)")) {
+        return false;
+    }
+    slot->context->setTensorAddress(model->input_name, slot->dev_input);
+
+    for (int i = 0; i < model->num_outputs; i++) {
+        size_t bytes = model->output_elements[i] * (model->output_fp16[i] ? 2 : 4);
+        if (cuda_failed(cudaMalloc(&slot->dev_outputs[i], bytes), "cudaMalloc(output)") ||
+            cuda_failed(cudaMallocHost(&slot->host_outputs[i], bytes), "cudaMallocHost(output)")) {
+            return false;
+        }
+        slot->context->setTensorAddress(model->output_names[i], slot->dev_outputs[i]);
+    }
+
+    slot->decode_buffer = new (std::nothrow) float[max_item_elements];
+    if (!slot->decode_buffer) {
+        fprintf(stderr, "TensorRT: failed to allocate decode buffer\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Load a TensorRT engine.
+ *
+ * @param ctx Context handle
+ * @param model_path Path to .engine or .trt file, or directory containing one
+ * @return CIRA_OK on success
+ */
+extern "C" int trt_load(cira_ctx* ctx, const char* model_path) {
+    char engine_path[1024];
+    const char* actual_path = model_path;
+
+    /* If path is a directory, find the engine file inside */
+    if (is_dir(model_path)) {
+        if (!find_file_ext(model_path, ".engine", engine_path, sizeof(engine_path)) &&
+            !find_file_ext(model_path, ".trt", engine_path, sizeof(engine_path))) {
+            cira_set_error(ctx, "No .engine or .trt file found in directory: %s", model_path);
+            return CIRA_ERROR_FILE;
+        }
+        actual_path = engine_path;
+    }
+
+    fprintf(stderr, "Loading TensorRT engine: %s\n", actual_path);
+
+    /* Deserialize straight from the mapped file rather than a heap copy */
+    model_file_t engine_file;
+    if (model_file_map(actual_path, &engine_file) != 0) {
+        cira_set_error(ctx, "Failed to read TensorRT engine: %s", actual_path);
+        return CIRA_ERROR_FILE;
+    }
+
+    trt_model_t* model = new (std::nothrow) trt_model_t();
+    if (!model) {
+        model_file_unmap(&engine_file);
+        cira_set_error(ctx, "Failed to allocate TensorRT model structure");
+        return CIRA_ERROR_MEMORY;
+    }
+    pthread_mutex_init(&model->slot_mutex, nullptr);
+    pthread_cond_init(&model->slot_cond, nullptr);
+
+    model->runtime = nvinfer1::createInferRuntime(g_logger);
+    if (model->runtime) {
+        model->engine = model->runtime->deserializeCudaEngine(engine_file.data, engine_file.size);
+    }
+    model_file_unmap(&engine_file);
+    if (!model->engine) {
+        cira_set_error(ctx, "Failed to deserialize TensorRT engine: %s", actual_path);
+        destroy_model(model);
+        return CIRA_ERROR_MODEL;
+    }
+
+    /* Find the input and outputs */
+    int nb_tensors = model->engine->getNbIOTensors();
+    for (int i = 0; i < nb_tensors; i++) {
+        const char* name = model->engine->getIOTensorName(i);
+        nvinfer1::Dims dims = model->engine->getTensorShape(name);
+        nvinfer1::DataType type = model->engine->getTensorDataType(name);
+
+        if (model->engine->getTensorIOMode(name) == nvinfer1::TensorIOMode::kINPUT) {
+            if (model->input_name[0] != '\0') continue;  /* First input only */
+            if (dims.nbDims != 4) {
+                cira_set_error(ctx, "TensorRT input must be NCHW (got %d dims)", dims.nbDims);
+                destroy_model(model);
+                return CIRA_ERROR_MODEL;
+            }
+            snprintf(model->input_name, sizeof(model->input_name), "%s", name);
+            model->input_batch = dims.d[0] > 0 ? (int)dims.d[0] : 1;
+            model->input_c = dims.d[1] > 0 ? (int)dims.d[1] : 3;
+            model->input_h = dims.d[2] > 0 ? (int)dims.d[2] : (ctx->input_h > 0 ? ctx->input_h : 640);
+            model->input_w = dims.d[3] > 0 ? (int)dims.d[3] : (ctx->input_w > 0 ? ctx->input_w : 640);
+            model->input_fp16 = type == nvinfer1::DataType::kHALF;
+            if (type != nvinfer1::DataType::kFLOAT && type != nvinfer1::DataType::kHALF) {
+                cira_set_error(ctx, "TensorRT input must be float32 or float16");
+                destroy_model(model);
+                return CIRA_ERROR_MODEL;
+            }
+        } else if (model->num_outputs < TRT_MAX_OUTPUTS) {
+            int o = model->num_outputs;
+            if (type != nvinfer1::DataType::kFLOAT && type != nvinfer1::DataType::kHALF) {
+                fprintf(stderr, "TensorRT: skipping non-float output '%s'\n", name);
+                continue;
+            }
+            snprintf(model->output_names[o], sizeof(model->output_names[o]), "%s", name);
+            model->output_fp16[o] = type == nvinfer1::DataType::kHALF;
+            model->num_outputs++;  /* Shape resolved per context in create_slot() */
+        }
+    }
+
+    if (model->input_name[0] == '\0' || model->num_outputs == 0) {
+        cira_set_error(ctx, "TensorRT engine has no usable input/output tensors");
+        destroy_model(model);
+        return CIRA_ERROR_MODEL;
+    }
+    if (model->input_c != 3) {
+        cira_set_error(ctx, "TensorRT input must have 3 channels (got %d)", model->input_c);
+        destroy_model(model);
+        return CIRA_ERROR_MODEL;
+    }
+
+    model->input_bytes = (size_t)model->input_batch * model->input_c * model->input_h *
+                         model->input_w * (model->input_fp16 ? 2 : 4);
+
+    /* Letterbox unless the manifest says the model was trained stretched */
+    model->letterbox = ctx->letterbox != 0;
+
+    /* Two execution slots; with several optimization profiles each gets its own */
+    int nb_profiles = model->engine->getNbOptimizationProfiles();
+    for (int i = 0; i < TRT_NUM_SLOTS; i++) {
+        int profile = nb_profiles >= TRT_NUM_SLOTS ? i : 0;
+        if (!create_slot(model, &model->slots[i], profile)) {
+            cira_set_error(ctx, "Failed to create TensorRT execution slot %d", i);
+            destroy_model(model);
+            return CIRA_ERROR_MODEL;
+        }
+    }
+
+    /* Use labels already loaded by cira_load() if available */
+    model->num_classes = ctx->num_labels > 0 ? ctx->num_labels : 80;
+
+    fprintf(stderr, "TensorRT engine loaded successfully\n");
+    fprintf(stderr, "  Input: %s (%dx%d, batch %d, %s)\n", model->input_name,
+            model->input_w, model->input_h, model->input_batch,
+            model->input_fp16 ? "fp16" : "fp32");
+    for (int i = 0; i < model->num_outputs; i++) {
+        fprintf(stderr, "  Output[%d]: %s [", i, model->output_names[i]);
+        for (int d = 0; d < model->output_dims[i]; d++) {
+            fprintf(stderr, "%lld%s", (long long)model->output_shapes[i][d],
+                    d < model->output_dims[i] - 1 ? ", " : "");
+        }
+        fprintf(stderr, "]%s\n", model->output_fp16[i] ? " fp16" : "");
+    }
+    fprintf(stderr, "  Classes: %d\n", model->num_classes);
+    /* Fixed when the engine was built (INT8 engines are calibrated then);
+     * the manifest only declares it */
+    fprintf(stderr, "  Precision: %s\n", cira_precision_name(ctx->precision));
+    fprintf(stderr, "  Preprocess: %s\n", model->letterbox ? "letterbox" : "stretch");
+    fprintf(stderr, "  Execution slots: %d\n", TRT_NUM_SLOTS);
+
+    ctx->model_handle = model;
+    ctx->input_w = model->input_w;
+    ctx->input_h = model->input_h;
+    ctx->format = CIRA_FORMAT_TENSORRT;
+
+    return CIRA_OK;
+}
+
+/**
+ * Unload TensorRT engine.
+ */
+extern "C" void trt_unload(cira_ctx* ctx) {
+    if (!ctx || !ctx->model_handle) return;
+
+    trt_model_t* model = static_cast<trt_model_t*>(ctx->model_handle);
+    destroy_model(model);
+    ctx->model_handle = nullptr;
+
+    fprintf(stderr, "TensorRT engine unloaded\n");
+}
+
+/* Take a free slot, waiting if all are in use */
+static trt_slot_t* acquire_slot(trt_model_t* model) {
+    pthread_mutex_lock(&model->slot_mutex);
+    for (;;) {
+        for (int i = 0; i < TRT_NUM_SLOTS; i++) {
+            if (!model->slots[i].busy) {
+                model->slots[i].busy = true;
+                pthread_mutex_unlock(&model->slot_mutex);
+                return &model->slots[i];
+            }
+        }
+        pthread_cond_wait(&model->slot_cond, &model->slot_mutex);
+    }
+}
+
+/* Take every slot (batch path) */
+static void acquire_all_slots(trt_model_t* model) {
+    pthread_mutex_lock(&model->slot_mutex);
+    for (int i = 0; i < TRT_NUM_SLOTS; i++) {
+        while (model->slots[i].busy) {
+            pthread_cond_wait(&model->slot_cond, &model->slot_mutex);
+        }
+        model->slots[i].busy = true;
+    }
+    pthread_mutex_unlock(&model->slot_mutex);
+}
+
+static void release_slot(trt_model_t* model, trt_slot_t* slot) {
+    pthread_mutex_lock(&model->slot_mutex);
+    slot->busy = false;
+    pthread_cond_broadcast(&model->slot_cond);
+    pthread_mutex_unlock(&model->slot_mutex);
+}
+
+/**
+ * Queue one frame on a slot: stage, upload, preprocess, execute, download.
+ * Returns as soon as the work is queued; sync with finish_frame().
+ */
+static int submit_frame(trt_model_t* model, trt_slot_t* slot,
+                        const uint8_t* data, int w, int h) {
+    size_t frame_bytes = (size_t)w * h * 3;
+    if (!reserve_frame(slot, frame_bytes)) return CIRA_ERROR_MEMORY;
+
+    /* Resize geometry */
+    slot->src_w = w;
+    slot->src_h = h;
+    int new_w = model->input_w;
+    int new_h = model->input_h;
+    if (model->letterbox) {
+        float scale = std::min((float)model->input_w / w, (float)model->input_h / h);
+        /* Rounding may overshoot by one; the kernel must stay inside the input */
+        new_w = std::min(model->input_w, std::max(1, (int)lroundf(w * scale)));
+        new_h = std::min(model->input_h, std::max(1, (int)lroundf(h * scale)));
+    }
+    slot->scale_x = (float)new_w / w;
+    slot->scale_y = (float)new_h / h;
+    slot->pad_x = (model->input_w - new_w) / 2;
+    slot->pad_y = (model->input_h - new_h) / 2;
+
+    /* Pinned staging makes the upload a true async DMA */
+    memcpy(slot->host_frame, data, frame_bytes);
+    if (cuda_failed(cudaMemcpyAsync(slot->dev_frame, slot->host_frame, frame_bytes,
+                                    cudaMemcpyHostToDevice, slot->stream), "upload")) {
+        return CIRA_ERROR;
+    }
+
+    int err = trt_preprocess_launch(slot->dev_frame, w, h, slot->dev_input,
+                                    model->input_w, model->input_h, model->input_fp16 ? 1 : 0,
+                                    slot->scale_x, slot->scale_y, slot->pad_x, slot->pad_y,
+                                    new_w, new_h, slot->stream);
+    if (cuda_failed((cudaError_t)err, "preprocess kernel")) return CIRA_ERROR;
+
+    if (!slot->context->enqueueV3(slot->stream)) {
+        fprintf(stderr, "TensorRT: enqueueV3 failed\n");
+        return CIRA_ERROR;
+    }
+
+    for (int i = 0; i < model->num_outputs; i++) {
+        size_t bytes = model->output_elements[i] * (model->output_fp16[i] ? 2 : 4);
+        if (cuda_failed(cudaMemcpyAsync(slot->host_outputs[i], slot->dev_outputs[i], bytes,
+                                        cudaMemcpyDeviceToHost, slot->stream), "download")) {
+            return CIRA_ERROR;
+        }
+    }
+
+    return CIRA_OK;
+}
+
+/**
+ * Wait for a slot's frame and decode its outputs into ctx->detections
+ * (normalized to the original frame).
+ */
+static int finish_frame(cira_ctx* ctx, trt_model_t* model, trt_slot_t* slot) {
+    if (cuda_failed(cudaStreamSynchronize(slot->stream), "cudaStreamSynchronize")) {
+        cira_set_error(ctx, "TensorRT inference failed");
+        return CIRA_ERROR;
+    }
+
+    cira_clear_detections(ctx);
+
+    yolo_decode_config_t decode_config;
+    decode_config.version = ctx->yolo_version;
+    decode_config.input_w = model->input_w;
+    decode_config.input_h = model->input_h;
+    decode_config.num_classes = model->num_classes;
+    decode_config.conf_threshold = ctx->confidence_threshold;
+    decode_config.nms_threshold = ctx->nms_threshold;
+    decode_config.max_detections = CIRA_MAX_DETECTIONS;
+    decode_config.verbose = 0;
+
+    /* Pre-NMS buffer across all outputs */
+    const int max_dets_buffer = CIRA_MAX_DETECTIONS * 4;
+    yolo_detection_t detections[CIRA_MAX_DETECTIONS * 4];
+    int total_detections = 0;
+
+    for (int i = 0; i < model->num_outputs && total_detections < max_dets_buffer; i++) {
+        /* Item 0 of the batch: [batch, ...] -> [1, ...] */
+        int64_t shape[6];
+        memcpy(shape, model->output_shapes[i], sizeof(shape));
+        size_t elements = model->output_elements[i] / model->input_batch;
+        if (model->input_batch > 1) shape[0] = 1;
+
+        const float* output_data = static_cast<const float*>(slot->host_outputs[i]);
+        if (model->output_fp16[i]) {
+            preprocess_half_to_float(static_cast<const uint16_t*>(slot->host_outputs[i]),
+                                     slot->decode_buffer, elements);
+            output_data = slot->decode_buffer;
+        }
+
+        int count = yolo_decode(output_data, shape, model->output_dims[i],
+                                &decode_config, detections + total_detections,
+                                max_dets_buffer - total_detections);
+        if (count > 0) total_detections += count;
+    }
+
+    /* Cross-output NMS (the decoder already applies NMS per output) */
+    if (model->num_outputs > 1 && ctx->nms_threshold > 0 && total_detections > 1) {
+        total_detections = yolo_nms(detections, total_detections, ctx->nms_threshold);
+    }
+
+    /* Undo letterbox: model input pixels -> normalized original frame */
+    float inv_w = 1.0f / (slot->scale_x * slot->src_w);
+    float inv_h = 1.0f / (slot->scale_y * slot->src_h);
+    for (int i = 0; i < total_detections; i++) {
+        float x1 = std::max(0.0f, std::min(1.0f, (detections[i].x1 - slot->pad_x) * inv_w));
+        float y1 = std::max(0.0f, std::min(1.0f, (detections[i].y1 - slot->pad_y) * inv_h));
+        float x2 = std::max(0.0f, std::min(1.0f, (detections[i].x2 - slot->pad_x) * inv_w));
+        float y2 = std::max(0.0f, std::min(1.0f, (detections[i].y2 - slot->pad_y) * inv_h));
+
+        if (!cira_add_detection(ctx, x1, y1, x2 - x1, y2 - y1,
+                                detections[i].score, detections[i].class_id)) {
+            break;  /* Detection array full */
+        }
+    }
+
+    return CIRA_OK;
+}
+
+/**
+ * Run TensorRT inference on an image.
+ *
+ * @param ctx Context with loaded TensorRT engine
+ * @param data RGB image data (packed HWC, row-major)
+ * @param w Image width
+ * @param h Image height
+ * @param channels Number of channels (must be 3)
+ * @return CIRA_OK on success
+ */
+extern "C" int trt_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
+    if (!ctx || !ctx->model_handle || !data || w <= 0 || h <= 0) {
+        cira_set_error(ctx, "Invalid parameters to trt_predict");
+        return CIRA_ERROR_INPUT;
+    }
+
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel RGB images supported");
+        return CIRA_ERROR_INPUT;
+    }
+
+    trt_model_t* model = static_cast<trt_model_t*>(ctx->model_handle);
+    trt_slot_t* slot = acquire_slot(model);
+
+    /* The preprocess kernel runs on the stream, so its time counts as inference */
+    double t0 = cira_time_ms();
+    int result = submit_frame(model, slot, data, w, h);
+    if (result == CIRA_OK) {
+        double t1 = cira_time_ms();
+        cudaStreamSynchronize(slot->stream);
+        double t2 = cira_time_ms();
+        result = finish_frame(ctx, model, slot);
+        ctx->predict_timing.preprocess_ms = t1 - t0;
+        ctx->predict_timing.inference_ms = t2 - t1;
+        ctx->predict_timing.decode_ms = cira_time_ms() - t2;
+    } else {
+        cudaStreamSynchronize(slot->stream);
+        cira_set_error(ctx, "Failed to queue TensorRT inference");
+    }
+
+    release_slot(model, slot);
+    return result;
+}
+
+/**
+ * Run TensorRT inference on a batch of images, double-buffered: image i+1
+ * is queued on the other slot before waiting for image i, so its upload
+ * and preprocessing overlap image i's execution. Results are stored per
+ * image with cira_batch_store().
+ */
+extern "C" int trt_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                                 int w, int h, int channels) {
+    if (!ctx || !ctx->model_handle || !images || count <= 0 || w <= 0 || h <= 0) {
+        cira_set_error(ctx, "Invalid parameters to trt_predict_batch");
+        return CIRA_ERROR_INPUT;
+    }
+
+    if (channels != 3) {
+        cira_set_error(ctx, "Only 3-channel RGB images supported");
+        return CIRA_ERROR_INPUT;
+    }
+
+    trt_model_t* model = static_cast<trt_model_t*>(ctx->model_handle);
+    acquire_all_slots(model);
+
+    int result = submit_frame(model, &model->slots[0], images[0], w, h);
+    for (int i = 0; i < count && result == CIRA_OK; i++) {
+        trt_slot_t* slot = &model->slots[i % TRT_NUM_SLOTS];
+        if (i + 1 < count) {
+            result = submit_frame(model, &model->slots[(i + 1) % TRT_NUM_SLOTS],
+                                  images[i + 1], w, h);
+            if (result != CIRA_OK) break;
+        }
+        result = finish_frame(ctx, model, slot);
+        if (result == CIRA_OK) {
+            cira_batch_store(ctx, w, h);
+        }
+    }
+
+    for (int i = 0; i < TRT_NUM_SLOTS; i++) {
+        cudaStreamSynchronize(model->slots[i].stream);
+        release_slot(model, &model->slots[i]);
+    }
+
+    if (result != CIRA_OK && !cira_error(ctx)) {
+        cira_set_error(ctx, "TensorRT batch inference failed");
+    }
+    return result;
+}
+
+#else /* CIRA_TRT_ENABLED */
+
+/* Stubs when TensorRT is not enabled */
+extern "C" int trt_load(cira_ctx* ctx, const char* model_path) {
+    (void)model_path;
+    cira_set_error(ctx, "TensorRT support not enabled in this build");
+    return CIRA_ERROR_MODEL;
+}
+
+extern "C" void trt_unload(cira_ctx* ctx) {
+    (void)ctx;
+}
+
+extern "C" int trt_predict(cira_ctx* ctx, const uint8_t* data, int w, int h, int channels) {
+    (void)data;
+    (void)w;
+    (void)h;
+    (void)channels;
+    cira_set_error(ctx, "TensorRT support not enabled in this build");
+    return CIRA_ERROR_MODEL;
+}
+
+extern "C" int trt_predict_batch(cira_ctx* ctx, const uint8_t** images, int count,
+                                 int w, int h, int channels) {
+    (void)images;
+    (void)count;
+    (void)w;
+    (void)h;
+    (void)channels;
+    cira_set_error(ctx, "TensorRT support not enabled in this build");
+    return CIRA_ERROR_MODEL;
+}
+
+#endif /* CIRA_TRT_ENABLED */
@@ -0,0 +1,107 @@
+/**
+ * CiRA Runtime - TensorRT GPU Preprocessing
+ *
+ * Letterbox (or stretch) resize, RGB HWC uint8 -> planar NCHW, and 0-1
+ * normalization in a single kernel, so only the raw camera frame crosses
+ * the PCIe/unified-memory boundary. Each thread writes one output pixel
+ * for all three channels.
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include <cuda_runtime.h>
+#include <cuda_fp16.h>
+#include <stdint.h>
+
+template <typename T>
+__device__ inline T to_output(float v);
+
+template <>
+__device__ inline float to_output<float>(float v) { return v; }
+
+template <>
+__device__ inline __half to_output<__half>(float v) { return __float2half(v); }
+
+template <typename T>
+__global__ void letterbox_kernel(const uint8_t* __restrict__ src, int src_w, int src_h,
+                                 T* __restrict__ dst, int dst_w, int dst_h,
+                                 float scale_x, float scale_y, int pad_x, int pad_y,
+                                 int new_w, int new_h, float pad_value) {
+    int x = blockIdx.x * blockDim.x + threadIdx.x;
+    int y = blockIdx.y * blockDim.y + threadIdx.y;
+    if (x >= dst_w || y >= dst_h) return;
+
+    float r = pad_value, g = pad_value, b = pad_value;
+
+    int ix = x - pad_x;
+    int iy = y - pad_y;
+    if (ix >= 0 && iy >= 0 && ix < new_w && iy < new_h) {
+        /* Pixel-center bilinear sampling */
+        float fx = (ix + 0.5f) / scale_x - 0.5f;
+        float fy = (iy + 0.5f) / scale_y - 0.5f;
+        fx = fminf(fmaxf(fx, 0.0f), (float)(src_w - 1));
+        fy = fminf(fmaxf(fy, 0.0f), (float)(src_h - 1));
+
+        int x0 = (int)fx;
+        int y0 = (int)fy;
+        int x1 = min(x0 + 1, src_w - 1);
+        int y1 = min(y0 + 1, src_h - 1);
+        float ax = fx - x0;
+        float ay = fy - y0;
+
+        const uint8_t* p00 = src + (y0 * src_w + x0) * 3;
+        const uint8_t* p10 = src + (y0 * src_w + x1) * 3;
+        const uint8_t* p01 = src + (y1 * src_w + x0) * 3;
+        const uint8_t* p11 = src + (y1 * src_w + x1) * 3;
+
+        float w00 = (1.0f - ax) * (1.0f - ay);
+        float w10 = ax * (1.0f - ay);
+        float w01 = (1.0f - ax) * ay;
+        float w11 = ax * ay;
+
+        r = p00[0] * w00 + p10[0] * w10 + p01[0] * w01 + p11[0] * w11;
+        g = p00[1] * w00 + p10[1] * w10 + p01[1] * w01 + p11[1] * w11;
+        b = p00[2] * w00 + p10[2] * w10 + p01[2] * w01 + p11[2] * w11;
+    }
+
+    int plane = dst_w * dst_h;
+    int idx = y * dst_w + x;
+    const float norm = 1.0f / 255.0f;
+    dst[idx] = to_output<T>(r * norm);
+    dst[plane + idx] = to_output<T>(g * norm);
+    dst[2 * plane + idx] = to_output<T>(b * norm);
+}
+
+/**
+ * Launch the preprocessing kernel on a stream.
+ *
+ * @param src       Device RGB image (packed HWC)
+ * @param dst       Device input tensor [1, 3, dst_h, dst_w]
+ * @param fp16      Non-zero if dst is half precision
+ * @param scale_x   Horizontal scale from source to resized image
+ * @param scale_y   Vertical scale from source to resized image
+ * @param pad_x     Left padding in dst pixels
+ * @param pad_y     Top padding in dst pixels
+ * @param new_w     Resized image width inside dst
+ * @param new_h     Resized image height inside dst
+ * @return          cudaSuccess or the launch error
+ */
+extern "C" int trt_preprocess_launch(const uint8_t* src, int src_w, int src_h,
+                                     void* dst, int dst_w, int dst_h, int fp16,
+                                     float scale_x, float scale_y, int pad_x, int pad_y,
+                                     int new_w, int new_h, cudaStream_t stream) {
+    const float pad_value = 114.0f;  /* Ultralytics letterbox gray */
+    dim3 block(32, 8);
+    dim3 grid((dst_w + block.x - 1) / block.x, (dst_h + block.y - 1) / block.y);
+
+    if (fp16) {
+        letterbox_kernel<__half><<<grid, block, 0, stream>>>(
+            src, src_w, src_h, (__half*)dst, dst_w, dst_h,
+            scale_x, scale_y, pad_x, pad_y, new_w, new_h, pad_value);
+    } else {
+        letterbox_kernel<float><<<grid, block, 0, stream>>>(
+            src, src_w, src_h, (float*)dst, dst_w, dst_h,
+            scale_x, scale_y, pad_x, pad_y, new_w, new_h, pad_value);
+    }
+    return (int)cudaGetLastError();
+}
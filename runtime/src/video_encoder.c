@@ -0,0 +1,610 @@
+/**
+ * CiRA Runtime - Encoded Video Streams
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "video_encoder.h"
+#include "fmp4.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#ifdef CIRA_GSTREAMER_ENABLED
+#include <gst/gst.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/app/gstappsink.h>
+#endif
+
+/* Room for an init segment around its parameter sets */
+#define INIT_SEGMENT_SIZE (1024 + 3 * FMP4_MAX_PARAM_SET)
+
+/* Frames the encoder may have queued before new ones are dropped */
+#define MAX_QUEUED_FRAMES 2
+
+/* A backend that failed to start is retried after this long */
+#define RETRY_MS 10000.0
+
+/* Duration of a frame with no predecessor */
+#define DEFAULT_FRAME_MS 33.3
+
+struct video_segment {
+    _Atomic int refs;
+    uint64_t seq;               /* Fragment sequence, 0 for init segments */
+    uint64_t generation;
+    int keyframe;
+    size_t size;
+    uint8_t data[];
+};
+
+/* One encoder backend: GStreamer launch fragment from raw RGB to the encoder */
+typedef struct {
+    const char* name;
+    const char* h264_element;   /* Probed by factory name */
+    const char* h265_element;
+    /* Format arguments: element, bitrate (kbps; "%d000" for bps), gop */
+    const char* launch;
+} video_backend_t;
+
+/* Candidates in "auto" order */
+static const video_backend_t g_backends[] = {
+    { "nvenc", "nvv4l2h264enc", "nvv4l2h265enc",
+      "videoconvert ! video/x-raw,format=I420 ! nvvidconv ! video/x-raw(memory:NVMM),format=I420 ! "
+      "%s bitrate=%d000 iframeinterval=%d insert-sps-pps=true maxperf-enable=true" },
+    { "mpp", "mpph264enc", "mpph265enc",
+      "videoconvert ! video/x-raw,format=NV12 ! %s bps=%d000 gop=%d" },
+    { "v4l2", "v4l2h264enc", "v4l2h265enc",
+      "videoconvert ! video/x-raw,format=I420 ! "
+      "%s extra-controls=\"controls,video_bitrate=%d000,video_gop_size=%d,repeat_sequence_header=1\"" },
+    { "software", "x264enc", "x265enc",
+      "videoconvert ! video/x-raw,format=I420 ! "
+      "%s tune=zerolatency speed-preset=ultrafast bitrate=%d key-int-max=%d" },
+};
+
+#define NUM_BACKENDS ((int)(sizeof(g_backends) / sizeof(g_backends[0])))
+
+struct video_encoder {
+    pthread_mutex_t mutex;      /* Guards history, init, counters and notify */
+    pthread_cond_t cond;
+    video_segment_t* history[VIDEO_HISTORY];    /* Fragment n lives in slot n % VIDEO_HISTORY */
+    video_segment_t* init;      /* Current init segment, NULL before the first keyframe */
+    uint64_t generation;        /* Of init */
+    _Atomic uint64_t last_seq;  /* Newest fragment */
+    _Atomic int viewers;
+    _Atomic int force_keyframe; /* A viewer joined: ask for a keyframe with the next frame */
+    video_encoder_notify_fn notify_fn;
+    void* notify_arg;
+    video_encoder_stats_t stats;
+
+    /* Pipeline (the writer's thread) */
+    video_config_t config;      /* Config of the running pipeline */
+    int width, height;
+    int running;
+    double retry_ms;            /* Failed start: not before this time */
+    double base_ms;             /* Capture time of the first frame */
+    double last_ms;             /* Of the previous frame */
+#ifdef CIRA_GSTREAMER_ENABLED
+    GstElement* pipeline;
+    GstElement* src;
+    GstBuffer* frame;           /* Between begin_frame and end_frame */
+    GstMapInfo frame_map;
+#endif
+
+    /* Muxer (the pipeline's streaming thread) */
+    fmp4_track_t track;
+    int have_keyframe;          /* A keyframe went out in this generation */
+};
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* === Segments === */
+
+static video_segment_t* segment_ref(video_segment_t* seg) {
+    if (seg) atomic_fetch_add_explicit(&seg->refs, 1, memory_order_relaxed);
+    return seg;
+}
+
+void video_segment_release(video_segment_t* seg) {
+    if (seg && atomic_fetch_sub_explicit(&seg->refs, 1, memory_order_acq_rel) == 1) {
+        free(seg);
+    }
+}
+
+const uint8_t* video_segment_data(const video_segment_t* seg, size_t* size) {
+    if (size) *size = seg->size;
+    return seg->data;
+}
+
+uint64_t video_segment_generation(const video_segment_t* seg) {
+    return seg->generation;
+}
+
+/* === Encoder === */
+
+video_encoder_t* video_encoder_create(void) {
+    video_encoder_t* enc = (video_encoder_t*)calloc(1, sizeof(video_encoder_t));
+    if (!enc) return NULL;
+    pthread_mutex_init(&enc->mutex, NULL);
+    pthread_cond_init(&enc->cond, NULL);
+    atomic_init(&enc->last_seq, 0);
+    atomic_init(&enc->viewers, 0);
+    atomic_init(&enc->force_keyframe, 0);
+    enc->stats.backend = "";
+    return enc;
+}
+
+void video_encoder_destroy(video_encoder_t* enc) {
+    if (!enc) return;
+    video_encoder_stop(enc);
+    for (int i = 0; i < VIDEO_HISTORY; i++) {
+        video_segment_release(enc->history[i]);
+    }
+    video_segment_release(enc->init);
+    pthread_cond_destroy(&enc->cond);
+    pthread_mutex_destroy(&enc->mutex);
+    free(enc);
+}
+
+int video_backend_known(const char* name) {
+    if (strcmp(name, "auto") == 0) return 1;
+    for (int i = 0; i < NUM_BACKENDS; i++) {
+        if (strcmp(name, g_backends[i].name) == 0) return 1;
+    }
+    return 0;
+}
+
+int video_encoder_wanted(video_encoder_t* enc) {
+    return enc && atomic_load_explicit(&enc->viewers, memory_order_relaxed) > 0;
+}
+
+#ifdef CIRA_GSTREAMER_ENABLED
+
+static video_segment_t* segment_alloc(size_t capacity) {
+    video_segment_t* seg = (video_segment_t*)malloc(sizeof(video_segment_t) + capacity);
+    if (!seg) return NULL;
+    atomic_init(&seg->refs, 1);
+    seg->seq = 0;
+    seg->generation = 0;
+    seg->keyframe = 0;
+    seg->size = 0;
+    return seg;
+}
+
+/* Publish a fragment (the streaming thread) */
+static void publish_fragment(video_encoder_t* enc, video_segment_t* seg) {
+    pthread_mutex_lock(&enc->mutex);
+    video_segment_t** slot = &enc->history[seg->seq % VIDEO_HISTORY];
+    video_segment_release(*slot);
+    *slot = seg;
+    atomic_store_explicit(&enc->last_seq, seg->seq, memory_order_release);
+    enc->stats.frames++;
+    enc->stats.keyframes += seg->keyframe;
+    enc->stats.bytes += seg->size;
+
+    pthread_cond_broadcast(&enc->cond);
+    if (enc->notify_fn) {
+        enc->notify_fn(enc->notify_arg, enc);
+    }
+    pthread_mutex_unlock(&enc->mutex);
+}
+
+/* Start a new generation with a fresh init segment (the streaming thread) */
+static int publish_init(video_encoder_t* enc) {
+    video_segment_t* seg = segment_alloc(INIT_SEGMENT_SIZE);
+    if (!seg) return -1;
+    seg->size = fmp4_init_segment(&enc->track, seg->data, INIT_SEGMENT_SIZE);
+    if (seg->size == 0) {
+        video_segment_release(seg);
+        return -1;
+    }
+
+    pthread_mutex_lock(&enc->mutex);
+    seg->generation = ++enc->generation;
+    video_segment_release(enc->init);
+    enc->init = seg;
+    fmp4_codec_string(&enc->track, enc->stats.codec, sizeof(enc->stats.codec));
+    pthread_mutex_unlock(&enc->mutex);
+
+    enc->have_keyframe = 0;
+    fprintf(stderr, "Video stream: %s %dx%d\n", enc->stats.codec,
+            enc->track.width, enc->track.height);
+    return 0;
+}
+
+/* Mux one encoded access unit (the streaming thread) */
+static void mux_access_unit(video_encoder_t* enc, const uint8_t* au, size_t size,
+                            uint64_t pts_ticks, uint32_t duration_ticks) {
+    int keyframe = fmp4_is_keyframe(enc->track.codec, au, size);
+
+    /* Parameter sets come with keyframes; new ones need a new init segment */
+    if (fmp4_track_update(&enc->track, au, size) && fmp4_track_ready(&enc->track)) {
+        if (publish_init(enc) != 0) return;
+    }
+
+    /* Each generation starts decodable */
+    if (!enc->init || (!enc->have_keyframe && !keyframe)) return;
+
+    video_segment_t* seg = segment_alloc(fmp4_fragment_bound(size));
+    if (!seg) return;
+
+    seg->seq = atomic_load_explicit(&enc->last_seq, memory_order_relaxed) + 1;
+    seg->generation = enc->generation;
+    seg->keyframe = keyframe;
+    seg->size = fmp4_fragment(&enc->track, (uint32_t)seg->seq, pts_ticks, duration_ticks,
+                              keyframe, au, size, seg->data, fmp4_fragment_bound(size));
+    if (seg->size == 0) {
+        video_segment_release(seg);
+        return;
+    }
+
+    enc->have_keyframe = 1;
+    publish_fragment(enc, seg);
+}
+
+static pthread_once_t g_gst_once = PTHREAD_ONCE_INIT;
+static int g_gst_ok = 0;
+
+static void gst_setup(void) {
+    GError* err = NULL;
+    g_gst_ok = gst_init_check(NULL, NULL, &err) ? 1 : 0;
+    if (!g_gst_ok) {
+        fprintf(stderr, "Video stream: GStreamer unavailable: %s\n", err ? err->message : "?");
+        if (err) g_error_free(err);
+    }
+}
+
+static GstFlowReturn on_sample(GstAppSink* sink, gpointer data) {
+    video_encoder_t* enc = (video_encoder_t*)data;
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return GST_FLOW_OK;
+
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstMapInfo map;
+    if (buf && GST_BUFFER_PTS_IS_VALID(buf) && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        uint64_t pts = gst_util_uint64_scale(GST_BUFFER_PTS(buf), FMP4_TIMESCALE, GST_SECOND);
+        uint64_t duration = GST_BUFFER_DURATION_IS_VALID(buf)
+            ? gst_util_uint64_scale(GST_BUFFER_DURATION(buf), FMP4_TIMESCALE, GST_SECOND)
+            : (uint64_t)(DEFAULT_FRAME_MS * FMP4_TIMESCALE / 1000);
+        mux_access_unit(enc, map.data, map.size, pts, (uint32_t)duration);
+        gst_buffer_unmap(buf, &map);
+    }
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+static void pipeline_stop(video_encoder_t* enc) {
+    if (enc->frame) {
+        gst_buffer_unmap(enc->frame, &enc->frame_map);
+        gst_buffer_unref(enc->frame);
+        enc->frame = NULL;
+    }
+    if (enc->pipeline) {
+        /* Joins the streaming threads: no more on_sample calls after this */
+        gst_element_set_state(enc->pipeline, GST_STATE_NULL);
+        gst_object_unref(enc->src);
+        gst_object_unref(enc->pipeline);
+        enc->pipeline = NULL;
+        enc->src = NULL;
+    }
+}
+
+/* Build and start one backend's pipeline; 0 on success */
+static int pipeline_try(video_encoder_t* enc, const video_backend_t* backend) {
+    int h265 = enc->config.codec == VIDEO_CODEC_H265;
+    const char* element = h265 ? backend->h265_element : backend->h264_element;
+
+    GstElementFactory* factory = gst_element_factory_find(element);
+    if (!factory) return -1;
+    gst_object_unref(factory);
+
+    char encode[512];
+    snprintf(encode, sizeof(encode), backend->launch, element,
+             enc->config.bitrate_kbps, enc->config.gop);
+
+    char launch[1024];
+    size_t frame_bytes = (size_t)enc->width * enc->height * 3;
+    snprintf(launch, sizeof(launch),
+             "appsrc name=src is-live=true format=time block=false max-bytes=%zu "
+             "caps=\"video/x-raw,format=RGB,width=%d,height=%d,framerate=30/1\" ! %s ! "
+             "%s config-interval=-1 ! video/x-%s,stream-format=byte-stream,alignment=au ! "
+             "appsink name=sink sync=false max-buffers=16",
+             frame_bytes * (MAX_QUEUED_FRAMES + 1), enc->width, enc->height, encode,
+             h265 ? "h265parse" : "h264parse", h265 ? "h265" : "h264");
+
+    GError* err = NULL;
+    GstElement* pipeline = gst_parse_launch(launch, &err);
+    if (!pipeline || err) {
+        fprintf(stderr, "Video encoder %s: %s\n", backend->name, err ? err->message : "launch failed");
+        if (err) g_error_free(err);
+        if (pipeline) gst_object_unref(pipeline);
+        return -1;
+    }
+
+    GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    if (!src || !sink) {
+        if (src) gst_object_unref(src);
+        if (sink) gst_object_unref(sink);
+        gst_object_unref(pipeline);
+        return -1;
+    }
+
+    GstAppSinkCallbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.new_sample = on_sample;
+    gst_app_sink_set_callbacks(GST_APP_SINK(sink), &callbacks, enc, NULL);
+    gst_object_unref(sink);
+
+    fmp4_track_init(&enc->track, h265 ? FMP4_CODEC_H265 : FMP4_CODEC_H264,
+                    enc->width, enc->height);
+    enc->have_keyframe = 0;
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        fprintf(stderr, "Video encoder %s: cannot start\n", backend->name);
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(src);
+        gst_object_unref(pipeline);
+        return -1;
+    }
+
+    enc->pipeline = pipeline;
+    enc->src = src;
+    return 0;
+}
+
+static int pipeline_start(video_encoder_t* enc) {
+    pthread_once(&g_gst_once, gst_setup);
+    if (!g_gst_ok) return -1;
+
+    int any = strcmp(enc->config.backend, "auto") == 0;
+    for (int i = 0; i < NUM_BACKENDS; i++) {
+        if (!any && strcmp(enc->config.backend, g_backends[i].name) != 0) continue;
+        if (pipeline_try(enc, &g_backends[i]) == 0) {
+            pthread_mutex_lock(&enc->mutex);
+            enc->stats.backend = g_backends[i].name;
+            pthread_mutex_unlock(&enc->mutex);
+            fprintf(stderr, "Video encoder: %s (%s, %d kbps, keyframe every %d frames)\n",
+                    g_backends[i].name, enc->config.codec == VIDEO_CODEC_H265 ? "H.265" : "H.264",
+                    enc->config.bitrate_kbps, enc->config.gop);
+            return 0;
+        }
+    }
+    fprintf(stderr, "Video encoder: no usable %s backend\n",
+            enc->config.codec == VIDEO_CODEC_H265 ? "H.265" : "H.264");
+    return -1;
+}
+
+/* Ask the encoder for a keyframe ahead of the next frame (GstForceKeyUnit) */
+static void request_keyframe(video_encoder_t* enc) {
+    GstStructure* s = gst_structure_new("GstForceKeyUnit",
+        "timestamp", G_TYPE_UINT64, GST_CLOCK_TIME_NONE,
+        "stream-time", G_TYPE_UINT64, GST_CLOCK_TIME_NONE,
+        "running-time", G_TYPE_UINT64, GST_CLOCK_TIME_NONE,
+        "all-headers", G_TYPE_BOOLEAN, TRUE,
+        "count", G_TYPE_UINT, 0u,
+        NULL);
+    gst_element_send_event(enc->src, gst_event_new_custom(GST_EVENT_CUSTOM_DOWNSTREAM, s));
+}
+
+static uint8_t* pipeline_frame(video_encoder_t* enc) {
+    if (gst_app_src_get_current_level_bytes(GST_APP_SRC(enc->src)) >=
+        (guint64)enc->width * enc->height * 3 * MAX_QUEUED_FRAMES) {
+        return NULL;
+    }
+    size_t size = (size_t)enc->width * enc->height * 3;
+    enc->frame = gst_buffer_new_allocate(NULL, size, NULL);
+    if (!enc->frame) return NULL;
+    if (!gst_buffer_map(enc->frame, &enc->frame_map, GST_MAP_WRITE)) {
+        gst_buffer_unref(enc->frame);
+        enc->frame = NULL;
+        return NULL;
+    }
+    return enc->frame_map.data;
+}
+
+static void pipeline_push(video_encoder_t* enc, double pts_ms, double duration_ms) {
+    GstBuffer* buf = enc->frame;
+    enc->frame = NULL;
+    gst_buffer_unmap(buf, &enc->frame_map);
+    GST_BUFFER_PTS(buf) = (GstClockTime)(pts_ms * GST_MSECOND);
+    GST_BUFFER_DURATION(buf) = (GstClockTime)(duration_ms * GST_MSECOND);
+
+    if (atomic_exchange(&enc->force_keyframe, 0)) {
+        request_keyframe(enc);
+    }
+    gst_app_src_push_buffer(GST_APP_SRC(enc->src), buf);   /* Takes the buffer */
+}
+
+#else /* !CIRA_GSTREAMER_ENABLED */
+
+/* No encoder to drive: the pipeline never starts */
+static int pipeline_start(video_encoder_t* enc) {
+    (void)enc;
+    fprintf(stderr, "Video encoder: GStreamer not enabled in this build\n");
+    return -1;
+}
+
+static void pipeline_stop(video_encoder_t* enc) {
+    (void)enc;
+}
+
+static uint8_t* pipeline_frame(video_encoder_t* enc) {
+    (void)enc;
+    return NULL;
+}
+
+static void pipeline_push(video_encoder_t* enc, double pts_ms, double duration_ms) {
+    (void)enc; (void)pts_ms; (void)duration_ms;
+}
+
+#endif /* CIRA_GSTREAMER_ENABLED */
+
+static int config_equal(const video_config_t* a, const video_config_t* b) {
+    return a->codec == b->codec && a->bitrate_kbps == b->bitrate_kbps && a->gop == b->gop &&
+           strcmp(a->backend, b->backend) == 0;
+}
+
+uint8_t* video_encoder_begin_frame(video_encoder_t* enc, const video_config_t* config,
+                                   int w, int h) {
+    /* Encoders take even sizes only */
+    if (!enc || !config || config->codec == VIDEO_CODEC_OFF || w <= 0 || h <= 0 || (w | h) & 1) {
+        return NULL;
+    }
+
+    int changed = !config_equal(&enc->config, config) || enc->width != w || enc->height != h;
+    if (changed) {
+        video_encoder_stop(enc);
+        enc->config = *config;
+        enc->width = w;
+        enc->height = h;
+        enc->retry_ms = 0.0;
+    }
+
+    if (!enc->running) {
+        double now = now_ms();
+        if (now < enc->retry_ms) return NULL;
+        if (pipeline_start(enc) != 0) {
+            enc->retry_ms = now + RETRY_MS;
+            return NULL;
+        }
+        enc->running = 1;
+        enc->base_ms = -1.0;
+        atomic_store(&enc->force_keyframe, 0);
+        pthread_mutex_lock(&enc->mutex);
+        enc->stats.running = 1;
+        enc->stats.width = w;
+        enc->stats.height = h;
+        pthread_mutex_unlock(&enc->mutex);
+    }
+
+    uint8_t* frame = pipeline_frame(enc);
+    if (!frame) {
+        pthread_mutex_lock(&enc->mutex);
+        enc->stats.dropped++;
+        pthread_mutex_unlock(&enc->mutex);
+    }
+    return frame;
+}
+
+void video_encoder_end_frame(video_encoder_t* enc, double capture_ms) {
+    if (!enc || !enc->running) return;
+
+    /* Timestamps from capture time: gaps while nobody watched stay gaps */
+    if (enc->base_ms < 0.0) {
+        enc->base_ms = capture_ms;
+        enc->last_ms = capture_ms - DEFAULT_FRAME_MS;
+    }
+    if (capture_ms <= enc->last_ms) capture_ms = enc->last_ms + 1.0;
+    double duration = capture_ms - enc->last_ms;
+    if (duration > 1000.0) duration = DEFAULT_FRAME_MS;
+    enc->last_ms = capture_ms;
+
+    pipeline_push(enc, capture_ms - enc->base_ms, duration);
+}
+
+void video_encoder_stop(video_encoder_t* enc) {
+    if (!enc || !enc->running) return;
+    pipeline_stop(enc);
+    enc->running = 0;
+
+    /* New viewers wait for the next pipeline's init segment */
+    pthread_mutex_lock(&enc->mutex);
+    video_segment_release(enc->init);
+    enc->init = NULL;
+    enc->stats.running = 0;
+    enc->stats.backend = "";
+    pthread_mutex_unlock(&enc->mutex);
+}
+
+uint64_t video_encoder_subscribe(video_encoder_t* enc) {
+    atomic_fetch_add(&enc->viewers, 1);
+    atomic_store(&enc->force_keyframe, 1);
+    return atomic_load_explicit(&enc->last_seq, memory_order_acquire);
+}
+
+void video_encoder_unsubscribe(video_encoder_t* enc) {
+    atomic_fetch_sub(&enc->viewers, 1);
+}
+
+video_segment_t* video_encoder_init_segment(video_encoder_t* enc) {
+    pthread_mutex_lock(&enc->mutex);
+    video_segment_t* seg = segment_ref(enc->init);
+    pthread_mutex_unlock(&enc->mutex);
+    return seg;
+}
+
+video_segment_t* video_encoder_next(video_encoder_t* enc, uint64_t* cursor, int need_keyframe) {
+    video_segment_t* found = NULL;
+
+    pthread_mutex_lock(&enc->mutex);
+    uint64_t last = atomic_load_explicit(&enc->last_seq, memory_order_relaxed);
+    uint64_t seq = *cursor + 1;
+    uint64_t oldest = last >= VIDEO_HISTORY ? last - VIDEO_HISTORY + 1 : 1;
+    if (seq < oldest) {
+        /* Fell behind the history: resume at a keyframe */
+        seq = oldest;
+        need_keyframe = 1;
+    }
+
+    for (; seq <= last; seq++) {
+        video_segment_t* seg = enc->history[seq % VIDEO_HISTORY];
+        *cursor = seq;
+        if (seg && seg->seq == seq && (!need_keyframe || seg->keyframe)) {
+            found = segment_ref(seg);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&enc->mutex);
+    return found;
+}
+
+uint64_t video_encoder_sequence(video_encoder_t* enc) {
+    return atomic_load_explicit(&enc->last_seq, memory_order_acquire);
+}
+
+uint64_t video_encoder_wait(video_encoder_t* enc, uint64_t after_seq, int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&enc->mutex);
+    uint64_t seq;
+    while ((seq = atomic_load_explicit(&enc->last_seq, memory_order_relaxed)) == after_seq) {
+        if (pthread_cond_timedwait(&enc->cond, &enc->mutex, &deadline) == ETIMEDOUT) break;
+    }
+    pthread_mutex_unlock(&enc->mutex);
+    return seq;
+}
+
+void video_encoder_set_notify(video_encoder_t* enc, video_encoder_notify_fn fn, void* arg) {
+    if (!enc) return;
+    pthread_mutex_lock(&enc->mutex);
+    enc->notify_fn = fn;
+    enc->notify_arg = arg;
+    pthread_mutex_unlock(&enc->mutex);
+}
+
+void video_encoder_stats(video_encoder_t* enc, video_encoder_stats_t* stats) {
+    if (!enc) {
+        memset(stats, 0, sizeof(*stats));
+        stats->backend = "";
+        return;
+    }
+    pthread_mutex_lock(&enc->mutex);
+    *stats = enc->stats;
+    pthread_mutex_unlock(&enc->mutex);
+    stats->viewers = atomic_load_explicit(&enc->viewers, memory_order_relaxed);
+}
@@ -3,6 +3,13 @@
  *
  * Shared output parsing for YOLOv4/v5/v8/v10 across all backends.
  *
+ * Class scores are reduced to a per-anchor maximum with AVX2 (x86, picked
+ * at runtime) or NEON (aarch64) and compared against the threshold before
+ * any box is decoded. Candidates are kept as a bounded min-heap so a full
+ * buffer holds the best boxes rather than the first ones. NMS pops
+ * candidates from a max-heap (no full sort) and only compares each one
+ * with kept boxes of the same class in the grid cells it overlaps.
+ *
  * (c) CiRA Robotics / KMITL 2026
  */
 
@@ -13,11 +20,40 @@
 #include <stdio.h>
 #include <ctype.h>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define YOLO_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define YOLO_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Anchors reduced per class-max pass */
+#define YOLO_BLOCK 64
+
+/* Anchors sampled to tell logits from probabilities */
+#define YOLO_LOGIT_SAMPLE 1024
+
+/* NMS grid: cells per side, cells a kept box may index, index pool size */
+#define NMS_GRID 16
+#define NMS_MAX_CELLS 16
+#define NMS_POOL 8192
+
+/* Extra list for kept boxes spanning more than NMS_MAX_CELLS cells */
+#define NMS_WIDE (NMS_GRID * NMS_GRID)
+
 /* Sigmoid activation */
 static inline float sigmoid(float x) {
     return 1.0f / (1.0f + expf(-x));
 }
 
+/* Inverse sigmoid, for thresholding raw logits */
+static float logit(float p) {
+    if (p < 1e-6f) p = 1e-6f;
+    if (p > 1.0f - 1e-6f) p = 1.0f - 1e-6f;
+    return logf(p / (1.0f - p));
+}
+
 /* IoU calculation for NMS */
 static float iou(const yolo_detection_t* a, const yolo_detection_t* b) {
     float ix1 = fmaxf(a->x1, b->x1);
@@ -36,15 +72,250 @@ static float iou(const yolo_detection_t* a, const yolo_detection_t* b) {
     return (uni > 0) ? inter / uni : 0.0f;
 }
 
-/* Compare detections by score (descending) for qsort */
-static int cmp_score_desc(const void* a, const void* b) {
-    const yolo_detection_t* da = (const yolo_detection_t*)a;
-    const yolo_detection_t* db = (const yolo_detection_t*)b;
-    if (db->score > da->score) return 1;
-    if (db->score < da->score) return -1;
+/* DFL (Distribution Focal Loss): softmax over the bins, expected bin index */
+static float dfl_decode(const float* dfl_vals, int reg_max) {
+    /* Find max for numerical stability */
+    float max_val = dfl_vals[0];
+    for (int i = 1; i < reg_max; i++) {
+        if (dfl_vals[i] > max_val) max_val = dfl_vals[i];
+    }
+
+    /* Softmax and weighted sum in one pass */
+    float sum_exp = 0.0f;
+    float weighted_sum = 0.0f;
+    for (int i = 0; i < reg_max; i++) {
+        float exp_val = expf(dfl_vals[i] - max_val);
+        sum_exp += exp_val;
+        weighted_sum += exp_val * i;
+    }
+
+    return weighted_sum / sum_exp;
+}
+
+/* ============================================
+ * Class-max kernels
+ * ============================================ */
+
+/* Transposed layout: per-anchor max over class rows `stride` floats apart */
+static void col_max_scalar(const float* cls0, size_t stride, int num_classes, int n,
+                           float* best, int* best_cls) {
+    for (int i = 0; i < n; i++) {
+        best[i] = cls0[i];
+        best_cls[i] = 0;
+    }
+    for (int c = 1; c < num_classes; c++) {
+        const float* row = cls0 + c * stride;
+        for (int i = 0; i < n; i++) {
+            if (row[i] > best[i]) {
+                best[i] = row[i];
+                best_cls[i] = c;
+            }
+        }
+    }
+}
+
+/* Row layout: max over contiguous class scores */
+static float row_max_scalar(const float* p, int n) {
+    float m = p[0];
+    for (int i = 1; i < n; i++) {
+        if (p[i] > m) m = p[i];
+    }
+    return m;
+}
+
+#ifdef YOLO_AVX2
+
+__attribute__((target("avx2")))
+static void col_max_avx2(const float* cls0, size_t stride, int num_classes, int n,
+                         float* best, int* best_cls) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 m = _mm256_loadu_ps(cls0 + i);
+        __m256 id = _mm256_setzero_ps();
+        for (int c = 1; c < num_classes; c++) {
+            __m256 v = _mm256_loadu_ps(cls0 + c * stride + i);
+            __m256 gt = _mm256_cmp_ps(v, m, _CMP_GT_OQ);
+            m = _mm256_max_ps(m, v);
+            id = _mm256_blendv_ps(id, _mm256_set1_ps((float)c), gt);
+        }
+        _mm256_storeu_ps(best + i, m);
+        _mm256_storeu_si256((__m256i*)(best_cls + i), _mm256_cvttps_epi32(id));
+    }
+    if (i < n) {
+        col_max_scalar(cls0 + i, stride, num_classes, n - i, best + i, best_cls + i);
+    }
+}
+
+__attribute__((target("avx2")))
+static float row_max_avx2(const float* p, int n) {
+    if (n < 8) return row_max_scalar(p, n);
+    __m256 m = _mm256_loadu_ps(p);
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        m = _mm256_max_ps(m, _mm256_loadu_ps(p + i));
+    }
+    __m128 h = _mm_max_ps(_mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1));
+    h = _mm_max_ps(h, _mm_movehl_ps(h, h));
+    h = _mm_max_ss(h, _mm_shuffle_ps(h, h, 1));
+    float r = _mm_cvtss_f32(h);
+    for (; i < n; i++) {
+        if (p[i] > r) r = p[i];
+    }
+    return r;
+}
+
+static int use_simd(void) {
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2");
+    }
+    return cached;
+}
+
+#endif /* YOLO_AVX2 */
+
+#ifdef YOLO_NEON
+
+static void col_max_neon(const float* cls0, size_t stride, int num_classes, int n,
+                         float* best, int* best_cls) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t m = vld1q_f32(cls0 + i);
+        uint32x4_t id = vdupq_n_u32(0);
+        for (int c = 1; c < num_classes; c++) {
+            float32x4_t v = vld1q_f32(cls0 + c * stride + i);
+            uint32x4_t gt = vcgtq_f32(v, m);
+            m = vmaxq_f32(m, v);
+            id = vbslq_u32(gt, vdupq_n_u32((uint32_t)c), id);
+        }
+        vst1q_f32(best + i, m);
+        vst1q_s32(best_cls + i, vreinterpretq_s32_u32(id));
+    }
+    if (i < n) {
+        col_max_scalar(cls0 + i, stride, num_classes, n - i, best + i, best_cls + i);
+    }
+}
+
+static float row_max_neon(const float* p, int n) {
+    if (n < 4) return row_max_scalar(p, n);
+    float32x4_t m = vld1q_f32(p);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        m = vmaxq_f32(m, vld1q_f32(p + i));
+    }
+    float r = vmaxvq_f32(m);
+    for (; i < n; i++) {
+        if (p[i] > r) r = p[i];
+    }
+    return r;
+}
+
+#endif /* YOLO_NEON */
+
+static void col_max(const float* cls0, size_t stride, int num_classes, int n,
+                    float* best, int* best_cls) {
+#if defined(YOLO_AVX2)
+    if (use_simd()) { col_max_avx2(cls0, stride, num_classes, n, best, best_cls); return; }
+#elif defined(YOLO_NEON)
+    col_max_neon(cls0, stride, num_classes, n, best, best_cls);
+    return;
+#endif
+    col_max_scalar(cls0, stride, num_classes, n, best, best_cls);
+}
+
+static float row_max(const float* p, int n) {
+#if defined(YOLO_AVX2)
+    if (use_simd()) return row_max_avx2(p, n);
+#elif defined(YOLO_NEON)
+    return row_max_neon(p, n);
+#endif
+    return row_max_scalar(p, n);
+}
+
+/* First index holding the row maximum (matches a strict > scan) */
+static int row_argmax(const float* p, int n, float m) {
+    for (int i = 0; i < n; i++) {
+        if (p[i] == m) return i;
+    }
     return 0;
 }
 
+/* ============================================
+ * Candidate buffer and heaps
+ * ============================================ */
+
+static void sift_down_min(yolo_detection_t* d, int n, int i) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && d[l].score < d[m].score) m = l;
+        if (r < n && d[r].score < d[m].score) m = r;
+        if (m == i) return;
+        yolo_detection_t t = d[i]; d[i] = d[m]; d[m] = t;
+        i = m;
+    }
+}
+
+static void sift_down_max(yolo_detection_t* d, int n, int i) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && d[l].score > d[m].score) m = l;
+        if (r < n && d[r].score > d[m].score) m = r;
+        if (m == i) return;
+        yolo_detection_t t = d[i]; d[i] = d[m]; d[m] = t;
+        i = m;
+    }
+}
+
+/* Appends until full, then keeps the best `max` as a min-heap */
+typedef struct {
+    yolo_detection_t* dets;
+    int count;
+    int max;
+    int heaped;
+} cand_buf_t;
+
+static void cand_push(cand_buf_t* b, float x1, float y1, float x2, float y2,
+                      float score, int class_id) {
+    yolo_detection_t* d;
+    if (b->count < b->max) {
+        d = &b->dets[b->count++];
+    } else {
+        if (!b->heaped) {
+            for (int i = b->count / 2 - 1; i >= 0; i--) sift_down_min(b->dets, b->count, i);
+            b->heaped = 1;
+        }
+        if (score <= b->dets[0].score) return;
+        d = &b->dets[0];
+    }
+
+    d->x1 = x1;
+    d->y1 = y1;
+    d->x2 = x2;
+    d->y2 = y2;
+    d->score = score;
+    d->class_id = class_id;
+
+    if (b->heaped) sift_down_min(b->dets, b->count, 0);
+}
+
+/* Scale normalized (cx, cy, w, h) to pixels and push as corners */
+static void push_center_box(cand_buf_t* b, const yolo_decode_config_t* config,
+                            float cx, float cy, float w, float h, float score, int class_id) {
+    /* Check if normalized or pixel coords */
+    if (cx <= 1.0f && cy <= 1.0f && w <= 1.0f && h <= 1.0f) {
+        cx *= config->input_w;
+        cy *= config->input_h;
+        w *= config->input_w;
+        h *= config->input_h;
+    }
+    cand_push(b, cx - w * 0.5f, cy - h * 0.5f, cx + w * 0.5f, cy + h * 0.5f, score, class_id);
+}
+
+/* ============================================
+ * Decoders
+ * ============================================ */
+
 /**
  * Decode YOLOv4/v3 output (anchor-based, per-scale)
  * Shape: [1, num_boxes, 5+num_classes] per scale (3D pre-decoded)
@@ -54,8 +325,7 @@ static int cmp_score_desc(const void* a, const void* b) {
  *       Would require anchor-based decoding with sigmoid activations.
  */
 static int decode_yolov4(const float* output, const int64_t* shape, int num_dims,
-                         const yolo_decode_config_t* config,
-                         yolo_detection_t* dets, int max_dets) {
+                         const yolo_decode_config_t* config, cand_buf_t* out) {
     /* Currently only supports 3D pre-decoded output. 5D raw grid returns -1. */
     if (num_dims < 3) return -1;
 
@@ -68,33 +338,23 @@ static int decode_yolov4(const float* output, const int64_t* shape, int num_dims
         if (num_classes <= 0) return -1;
     }
 
-    int count = 0;
-    int checked = 0;
     float max_obj_seen = 0.0f;
 
-    for (int i = 0; i < num_boxes && count < max_dets; i++) {
-        const float* box = output + i * box_size;
+    for (int i = 0; i < num_boxes; i++) {
+        const float* box = output + (size_t)i * box_size;
 
-        /* Get objectness score */
+        /* Get objectness score (cheapest reject) */
         float obj = box[4];
         if (obj < 0.0f || obj > 1.0f) {
             obj = sigmoid(obj);  /* Raw logits - apply sigmoid */
         }
 
         if (obj > max_obj_seen) max_obj_seen = obj;
-        checked++;
-
         if (obj < config->conf_threshold) continue;
 
         /* Find best class */
-        int best_class = 0;
-        float best_prob = box[5];
-        for (int c = 1; c < num_classes; c++) {
-            if (box[5 + c] > best_prob) {
-                best_prob = box[5 + c];
-                best_class = c;
-            }
-        }
+        float best_prob = row_max(box + 5, num_classes);
+        int best_class = row_argmax(box + 5, num_classes, best_prob);
 
         /* Apply sigmoid if raw logits */
         if (best_prob < 0.0f || best_prob > 1.0f) {
@@ -105,32 +365,15 @@ static int decode_yolov4(const float* output, const int64_t* shape, int num_dims
         if (score < config->conf_threshold) continue;
 
         /* Decode box (cx, cy, w, h) -> (x1, y1, x2, y2) */
-        float cx = box[0];
-        float cy = box[1];
-        float w = box[2];
-        float h = box[3];
-
-        /* Check if normalized or pixel coords */
-        if (cx <= 1.0f && cy <= 1.0f && w <= 1.0f && h <= 1.0f) {
-            cx *= config->input_w;
-            cy *= config->input_h;
-            w *= config->input_w;
-            h *= config->input_h;
-        }
-
-        dets[count].x1 = cx - w * 0.5f;
-        dets[count].y1 = cy - h * 0.5f;
-        dets[count].x2 = cx + w * 0.5f;
-        dets[count].y2 = cy + h * 0.5f;
-        dets[count].score = score;
-        dets[count].class_id = best_class;
-        count++;
+        push_center_box(out, config, box[0], box[1], box[2], box[3], score, best_class);
     }
 
-    fprintf(stderr, "decode_yolov4: checked %d boxes, max_obj=%.4f, found %d detections\n",
-            checked, max_obj_seen, count);
+    if (config->verbose) {
+        fprintf(stderr, "decode_yolov4: checked %d boxes, max_obj=%.4f, found %d detections\n",
+                num_boxes, max_obj_seen, out->count);
+    }
 
-    return count;
+    return out->count;
 }
 
 /**
@@ -138,19 +381,30 @@ static int decode_yolov4(const float* output, const int64_t* shape, int num_dims
  * Shape: [1, 25200, 5+num_classes]
  */
 static int decode_yolov5(const float* output, const int64_t* shape, int num_dims,
-                         const yolo_decode_config_t* config,
-                         yolo_detection_t* dets, int max_dets) {
+                         const yolo_decode_config_t* config, cand_buf_t* out) {
     /* Same format as v4 but typically pre-decoded coordinates */
-    return decode_yolov4(output, shape, num_dims, config, dets, max_dets);
+    return decode_yolov4(output, shape, num_dims, config, out);
+}
+
+/* 1 if any sampled score lies outside [0,1], i.e. scores are raw logits */
+static int scores_are_logits(const float* scores, size_t step, int n) {
+    if (n > YOLO_LOGIT_SAMPLE) n = YOLO_LOGIT_SAMPLE;
+    for (int i = 0; i < n; i++) {
+        float v = scores[i * step];
+        if (v < 0.0f || v > 1.0f) return 1;
+    }
+    return 0;
 }
 
 /**
  * Decode YOLOv8/v9/v11 output (transposed, no objectness)
  * Shape: [1, 4+num_classes, 8400]
+ *
+ * Class rows are reduced YOLO_BLOCK anchors at a time; only anchors whose
+ * best raw score clears the threshold are decoded.
  */
 static int decode_yolov8(const float* output, const int64_t* shape, int num_dims,
-                         const yolo_decode_config_t* config,
-                         yolo_detection_t* dets, int max_dets) {
+                         const yolo_decode_config_t* config, cand_buf_t* out) {
     if (num_dims < 3) return -1;
 
     int channels = (int)shape[1];
@@ -159,50 +413,96 @@ static int decode_yolov8(const float* output, const int64_t* shape, int num_dims
 
     if (num_classes <= 0) return -1;
 
-    int count = 0;
-    for (int i = 0; i < num_boxes && count < max_dets; i++) {
-        /* Find best class (no objectness in v8+) */
-        int best_class = 0;
-        float best_score = output[4 * num_boxes + i];
-        for (int c = 1; c < num_classes; c++) {
-            float score = output[(4 + c) * num_boxes + i];
-            if (score > best_score) {
-                best_score = score;
-                best_class = c;
-            }
-        }
+    const float* cls0 = output + (size_t)4 * num_boxes;
+    int logits = scores_are_logits(cls0, 1, num_boxes);
+    float raw_threshold = logits ? logit(config->conf_threshold) : config->conf_threshold;
 
-        /* Apply sigmoid if raw logits */
-        if (best_score < 0.0f || best_score > 1.0f) {
-            best_score = sigmoid(best_score);
-        }
+    float best[YOLO_BLOCK];
+    int best_cls[YOLO_BLOCK];
+
+    for (int start = 0; start < num_boxes; start += YOLO_BLOCK) {
+        int n = num_boxes - start;
+        if (n > YOLO_BLOCK) n = YOLO_BLOCK;
 
-        if (best_score < config->conf_threshold) continue;
+        col_max(cls0 + start, (size_t)num_boxes, num_classes, n, best, best_cls);
 
-        /* Decode transposed box */
-        float cx = output[0 * num_boxes + i];
-        float cy = output[1 * num_boxes + i];
-        float w = output[2 * num_boxes + i];
-        float h = output[3 * num_boxes + i];
+        for (int k = 0; k < n; k++) {
+            if (best[k] < raw_threshold) continue;
 
-        /* Check if normalized or pixel coords */
-        if (cx <= 1.0f && cy <= 1.0f && w <= 1.0f && h <= 1.0f) {
-            cx *= config->input_w;
-            cy *= config->input_h;
-            w *= config->input_w;
-            h *= config->input_h;
+            float score = logits ? sigmoid(best[k]) : best[k];
+            if (score < config->conf_threshold) continue;
+
+            /* Decode transposed box */
+            int i = start + k;
+            push_center_box(out, config,
+                            output[0 * (size_t)num_boxes + i], output[1 * (size_t)num_boxes + i],
+                            output[2 * (size_t)num_boxes + i], output[3 * (size_t)num_boxes + i],
+                            score, best_cls[k]);
         }
+    }
+
+    return out->count;
+}
+
+/**
+ * Decode raw YOLOv8/v11 DFL output (NCNN exports)
+ * Shape: [1, num_boxes, 64+num_classes], one row per anchor at strides
+ * 8/16/32: 4 sides x 16 DFL bins, then class scores.
+ */
+static int decode_yolov8_dfl(const float* output, const int64_t* shape, int num_dims,
+                             const yolo_decode_config_t* config, cand_buf_t* out) {
+    if (num_dims < 3) return -1;
+
+    const int reg_max = 16;
+    int num_boxes = (int)shape[1];
+    int row_size = (int)shape[2];
+    int num_classes = row_size - 4 * reg_max;
+
+    if (num_classes <= 0) return -1;
+
+    int logits = scores_are_logits(output + 4 * reg_max, (size_t)row_size,
+                                   num_boxes < 64 ? num_boxes : 64);
+    float raw_threshold = logits ? logit(config->conf_threshold) : config->conf_threshold;
 
-        dets[count].x1 = cx - w * 0.5f;
-        dets[count].y1 = cy - h * 0.5f;
-        dets[count].x2 = cx + w * 0.5f;
-        dets[count].y2 = cy + h * 0.5f;
-        dets[count].score = best_score;
-        dets[count].class_id = best_class;
-        count++;
+    static const int strides[3] = {8, 16, 32};
+    int box_idx = 0;
+
+    for (int s = 0; s < 3 && box_idx < num_boxes; s++) {
+        int stride = strides[s];
+        int grid_w = config->input_w / stride;
+        int grid_h = config->input_h / stride;
+
+        for (int gy = 0; gy < grid_h && box_idx < num_boxes; gy++) {
+            for (int gx = 0; gx < grid_w && box_idx < num_boxes; gx++, box_idx++) {
+                const float* row = output + (size_t)box_idx * row_size;
+                const float* scores = row + 4 * reg_max;
+
+                float best = row_max(scores, num_classes);
+                if (best < raw_threshold) continue;
+
+                float score = logits ? sigmoid(best) : best;
+                if (score < config->conf_threshold) continue;
+
+                /* Anchor point is center of grid cell; DFL gives side distances */
+                float cx = (gx + 0.5f) * stride;
+                float cy = (gy + 0.5f) * stride;
+                float x1 = cx - dfl_decode(row + 0 * reg_max, reg_max) * stride;
+                float y1 = cy - dfl_decode(row + 1 * reg_max, reg_max) * stride;
+                float x2 = cx + dfl_decode(row + 2 * reg_max, reg_max) * stride;
+                float y2 = cy + dfl_decode(row + 3 * reg_max, reg_max) * stride;
+
+                /* Clamp to image bounds */
+                x1 = fmaxf(0.0f, fminf(x1, (float)config->input_w));
+                y1 = fmaxf(0.0f, fminf(y1, (float)config->input_h));
+                x2 = fmaxf(0.0f, fminf(x2, (float)config->input_w));
+                y2 = fmaxf(0.0f, fminf(y2, (float)config->input_h));
+
+                cand_push(out, x1, y1, x2, y2, score, row_argmax(scores, num_classes, best));
+            }
+        }
     }
 
-    return count;
+    return out->count;
 }
 
 /**
@@ -210,8 +510,7 @@ static int decode_yolov8(const float* output, const int64_t* shape, int num_dims
  * Shape: [1, 300, 6]
  */
 static int decode_yolov10(const float* output, const int64_t* shape, int num_dims,
-                          const yolo_decode_config_t* config,
-                          yolo_detection_t* dets, int max_dets) {
+                          const yolo_decode_config_t* config, cand_buf_t* out) {
     if (num_dims < 3) return -1;
 
     int num_boxes = (int)shape[1];
@@ -219,26 +518,23 @@ static int decode_yolov10(const float* output, const int64_t* shape, int num_dim
 
     if (box_size < 6) return -1;
 
-    int count = 0;
-    for (int i = 0; i < num_boxes && count < max_dets; i++) {
-        const float* box = output + i * box_size;
+    for (int i = 0; i < num_boxes; i++) {
+        const float* box = output + (size_t)i * box_size;
 
         float score = box[4];
         if (score < config->conf_threshold) continue;
 
-        int class_id = (int)box[5];
-
         /* YOLOv10 outputs corner coords directly */
-        dets[count].x1 = box[0];
-        dets[count].y1 = box[1];
-        dets[count].x2 = box[2];
-        dets[count].y2 = box[3];
-        dets[count].score = score;
-        dets[count].class_id = class_id;
-        count++;
+        cand_push(out, box[0], box[1], box[2], box[3], score, (int)box[5]);
     }
 
-    return count;
+    return out->count;
+}
+
+/* 1 if a [1, N, 64+C] output holds raw DFL rows */
+static int is_dfl_layout(const int64_t* shape, int num_dims, int num_classes) {
+    return num_dims >= 3 && num_classes > 0 &&
+           shape[2] == 64 + num_classes && shape[1] > shape[2];
 }
 
 /* Main decode function */
@@ -254,38 +550,43 @@ int yolo_decode(const float* output, const int64_t* output_shape, int num_dims,
         version = yolo_detect_version(output_shape, num_dims, config->num_classes);
     }
 
-    fprintf(stderr, "yolo_decode: detected version=%s, shape=[%lld,%lld,%lld], conf_thresh=%.2f\n",
-            yolo_version_name(version),
-            (long long)(num_dims > 0 ? output_shape[0] : 0),
-            (long long)(num_dims > 1 ? output_shape[1] : 0),
-            (long long)(num_dims > 2 ? output_shape[2] : 0),
-            config->conf_threshold);
+    if (config->verbose) {
+        fprintf(stderr, "yolo_decode: detected version=%s, shape=[%lld,%lld,%lld], conf_thresh=%.2f\n",
+                yolo_version_name(version),
+                (long long)(num_dims > 0 ? output_shape[0] : 0),
+                (long long)(num_dims > 1 ? output_shape[1] : 0),
+                (long long)(num_dims > 2 ? output_shape[2] : 0),
+                config->conf_threshold);
+    }
 
+    cand_buf_t out = { detections, 0, max_dets, 0 };
     int count = 0;
     switch (version) {
         case YOLO_VERSION_V4:
-            count = decode_yolov4(output, output_shape, num_dims, config, detections, max_dets);
+            count = decode_yolov4(output, output_shape, num_dims, config, &out);
             break;
         case YOLO_VERSION_V5:
-            count = decode_yolov5(output, output_shape, num_dims, config, detections, max_dets);
+            count = decode_yolov5(output, output_shape, num_dims, config, &out);
             break;
         case YOLO_VERSION_V8:
-            count = decode_yolov8(output, output_shape, num_dims, config, detections, max_dets);
+            count = is_dfl_layout(output_shape, num_dims, config->num_classes)
+                ? decode_yolov8_dfl(output, output_shape, num_dims, config, &out)
+                : decode_yolov8(output, output_shape, num_dims, config, &out);
             break;
         case YOLO_VERSION_V10:
-            count = decode_yolov10(output, output_shape, num_dims, config, detections, max_dets);
+            count = decode_yolov10(output, output_shape, num_dims, config, &out);
             break;
         default:
             /* Try v5 as fallback */
-            count = decode_yolov5(output, output_shape, num_dims, config, detections, max_dets);
+            count = decode_yolov5(output, output_shape, num_dims, config, &out);
             break;
     }
 
     if (count <= 0) return count;
 
-    /* Apply NMS (except for v10 which is NMS-free) */
+    /* Apply NMS (except for v10 which is NMS-free), stopping at max_detections */
     if (version != YOLO_VERSION_V10) {
-        count = yolo_nms(detections, count, config->nms_threshold);
+        return yolo_nms_topk(detections, count, config->nms_threshold, config->max_detections);
     }
 
     /* Limit to max_detections */
@@ -296,33 +597,132 @@ int yolo_decode(const float* output, const int64_t* output_shape, int num_dims,
     return count;
 }
 
-/* Non-Maximum Suppression */
+/* ============================================
+ * Non-Maximum Suppression
+ * ============================================ */
+
 int yolo_nms(yolo_detection_t* detections, int count, float nms_threshold) {
-    if (!detections || count <= 0) return 0;
+    return yolo_nms_topk(detections, count, nms_threshold, count);
+}
 
-    /* Sort by score descending */
-    qsort(detections, count, sizeof(yolo_detection_t), cmp_score_desc);
+/* Grid cell range covered by a box */
+static void cell_range(const yolo_detection_t* d, float min_x, float min_y, float inv_w,
+                       float inv_h, int* cx0, int* cy0, int* cx1, int* cy1) {
+    int v[4] = {
+        (int)((d->x1 - min_x) * inv_w), (int)((d->y1 - min_y) * inv_h),
+        (int)((d->x2 - min_x) * inv_w), (int)((d->y2 - min_y) * inv_h)
+    };
+    for (int i = 0; i < 4; i++) {
+        if (v[i] < 0) v[i] = 0;
+        if (v[i] >= NMS_GRID) v[i] = NMS_GRID - 1;
+    }
+    *cx0 = v[0];
+    *cy0 = v[1];
+    *cx1 = v[2];
+    *cy1 = v[3];
+}
 
-    /* Mark suppressed detections with negative score */
-    for (int i = 0; i < count; i++) {
-        if (detections[i].score < 0) continue;
+int yolo_nms_topk(yolo_detection_t* detections, int count, float nms_threshold, int max_keep) {
+    if (!detections || count <= 0) return 0;
+    if (max_keep <= 0 || max_keep > count) max_keep = count;
 
-        for (int j = i + 1; j < count; j++) {
-            if (detections[j].score < 0) continue;
-            if (detections[i].class_id != detections[j].class_id) continue;
+    yolo_detection_t* d = detections;
 
-            if (iou(&detections[i], &detections[j]) > nms_threshold) {
-                detections[j].score = -1.0f;  /* Mark as suppressed */
+    /* Grid over the extent of all candidates */
+    float min_x = d[0].x1, min_y = d[0].y1, max_x = d[0].x2, max_y = d[0].y2;
+    for (int i = 1; i < count; i++) {
+        if (d[i].x1 < min_x) min_x = d[i].x1;
+        if (d[i].y1 < min_y) min_y = d[i].y1;
+        if (d[i].x2 > max_x) max_x = d[i].x2;
+        if (d[i].y2 > max_y) max_y = d[i].y2;
+    }
+    float inv_w = (max_x > min_x) ? NMS_GRID / (max_x - min_x) : 0.0f;
+    float inv_h = (max_y > min_y) ? NMS_GRID / (max_y - min_y) : 0.0f;
+
+    /* Kept boxes indexed per cell; boxes spanning many cells go in list NMS_WIDE */
+    int heads[NMS_GRID * NMS_GRID + 1];
+    int node_next[NMS_POOL];
+    int node_box[NMS_POOL];
+    int num_nodes = 0;
+    int brute = 0;  /* Pool exhausted: compare against every kept box */
+    for (int i = 0; i <= NMS_WIDE; i++) heads[i] = -1;
+
+    /* Max-heap; popped candidates collect at the end in ascending order */
+    for (int i = count / 2 - 1; i >= 0; i--) sift_down_max(d, count, i);
+
+    int end = count;
+    int kept = 0;
+    while (end > 0 && kept < max_keep) {
+        yolo_detection_t t = d[0]; d[0] = d[end - 1]; d[end - 1] = t;
+        end--;
+        sift_down_max(d, end, 0);
+
+        yolo_detection_t* c = &d[end];
+        int cx0, cy0, cx1, cy1;
+        cell_range(c, min_x, min_y, inv_w, inv_h, &cx0, &cy0, &cx1, &cy1);
+
+        int suppressed = 0;
+        if (brute) {
+            for (int j = end + 1; j < count && !suppressed; j++) {
+                suppressed = d[j].score >= 0 && d[j].class_id == c->class_id &&
+                             iou(&d[j], c) > nms_threshold;
             }
+        } else {
+            for (int n = heads[NMS_WIDE]; n >= 0 && !suppressed; n = node_next[n]) {
+                const yolo_detection_t* o = &d[node_box[n]];
+                suppressed = o->class_id == c->class_id && iou(o, c) > nms_threshold;
+            }
+            for (int gy = cy0; gy <= cy1 && !suppressed; gy++) {
+                for (int gx = cx0; gx <= cx1 && !suppressed; gx++) {
+                    for (int n = heads[gy * NMS_GRID + gx]; n >= 0 && !suppressed; n = node_next[n]) {
+                        const yolo_detection_t* o = &d[node_box[n]];
+                        suppressed = o->class_id == c->class_id && iou(o, c) > nms_threshold;
+                    }
+                }
+            }
+        }
+
+        if (suppressed) {
+            c->score = -1.0f;  /* Mark as suppressed */
+            continue;
         }
+        kept++;
+
+        if (brute) continue;
+        int cells = (cx1 - cx0 + 1) * (cy1 - cy0 + 1);
+        if (cells > NMS_MAX_CELLS) {
+            if (num_nodes < NMS_POOL) {
+                node_box[num_nodes] = end;
+                node_next[num_nodes] = heads[NMS_WIDE];
+                heads[NMS_WIDE] = num_nodes++;
+            } else {
+                brute = 1;
+            }
+        } else if (num_nodes + cells <= NMS_POOL) {
+            for (int gy = cy0; gy <= cy1; gy++) {
+                for (int gx = cx0; gx <= cx1; gx++) {
+                    node_box[num_nodes] = end;
+                    node_next[num_nodes] = heads[gy * NMS_GRID + gx];
+                    heads[gy * NMS_GRID + gx] = num_nodes++;
+                }
+            }
+        } else {
+            brute = 1;
+        }
+    }
+
+    /* Processed tail [end, count) is ascending: reverse, move to front, compact */
+    for (int i = end, j = count - 1; i < j; i++, j--) {
+        yolo_detection_t t = d[i]; d[i] = d[j]; d[j] = t;
     }
+    int processed = count - end;
+    if (end > 0) memmove(d, d + end, (size_t)processed * sizeof(yolo_detection_t));
 
-    /* Compact array - remove suppressed */
     int out = 0;
-    for (int i = 0; i < count; i++) {
-        if (detections[i].score >= 0) {
+    for (int i = 0; i < processed; i++) {
+        if (d[i].score >= 0) {
             if (out != i) {
-                detections[out] = detections[i];
+                d[out] = d[i];
             }
             out++;
         }
@@ -397,6 +797,11 @@ yolo_version_t yolo_detect_version(const int64_t* output_shape, int num_dims, in
         return YOLO_VERSION_V8;
     }
 
+    /* YOLOv8/v11 raw DFL rows: [1, 8400, 64+C] (NCNN exports) */
+    if (num_classes > 0 && dim2 == 64 + num_classes && dim1 > 1000) {
+        return YOLO_VERSION_V8;
+    }
+
     /* YOLOv5/v7: [1, 25200, 5+C] - concatenated anchors */
     if (dim1 == 25200 || dim1 == 18900 || dim1 == 6300) {
         return YOLO_VERSION_V5;
@@ -0,0 +1,285 @@
+/**
+ * CiRA Runtime - Preprocessing Microbenchmark
+ *
+ * Times the previous scalar path (bilinear resize to uint8, then a
+ * normalize/transpose pass, then a float16 pass) against the fused
+ * preprocess_run() with SIMD disabled and enabled, and checks that the
+ * SIMD and scalar kernels agree. Also times the float16 output
+ * conversion against the per-element loop the loaders used, and checks
+ * it is exact for every half value.
+ *
+ * Usage:
+ *   ./bench_preprocess [iterations]
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cira.h"
+#include "preprocess.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+/* ============================================
+ * Previous scalar path (onnx_loader.c before preprocess.c)
+ * ============================================ */
+
+static void legacy_resize(const uint8_t* src, int src_w, int src_h,
+                          uint8_t* dst, int dst_w, int dst_h) {
+    float x_ratio = (float)(src_w - 1) / (dst_w - 1);
+    float y_ratio = (float)(src_h - 1) / (dst_h - 1);
+
+    for (int y = 0; y < dst_h; y++) {
+        float fy = y * y_ratio;
+        int y_low = (int)fy;
+        int y_high = y_low + 1;
+        if (y_high >= src_h) y_high = src_h - 1;
+        float y_lerp = fy - y_low;
+
+        for (int x = 0; x < dst_w; x++) {
+            float fx = x * x_ratio;
+            int x_low = (int)fx;
+            int x_high = x_low + 1;
+            if (x_high >= src_w) x_high = src_w - 1;
+            float x_lerp = fx - x_low;
+
+            for (int c = 0; c < 3; c++) {
+                float c00 = src[(y_low * src_w + x_low) * 3 + c];
+                float c10 = src[(y_low * src_w + x_high) * 3 + c];
+                float c01 = src[(y_high * src_w + x_low) * 3 + c];
+                float c11 = src[(y_high * src_w + x_high) * 3 + c];
+                float top = c00 * (1.0f - x_lerp) + c10 * x_lerp;
+                float bottom = c01 * (1.0f - x_lerp) + c11 * x_lerp;
+                float value = top * (1.0f - y_lerp) + bottom * y_lerp;
+                dst[(y * dst_w + x) * 3 + c] = (uint8_t)(value + 0.5f);
+            }
+        }
+    }
+}
+
+static void legacy_preprocess(const uint8_t* src, int src_w, int src_h, uint8_t* resized,
+                              float* dst, uint16_t* dst_fp16, int dst_w, int dst_h) {
+    const uint8_t* in = src;
+    if (src_w != dst_w || src_h != dst_h) {
+        legacy_resize(src, src_w, src_h, resized, dst_w, dst_h);
+        in = resized;
+    }
+
+    for (int c = 0; c < 3; c++) {
+        for (int y = 0; y < dst_h; y++) {
+            for (int x = 0; x < dst_w; x++) {
+                dst[c * dst_h * dst_w + y * dst_w + x] = in[(y * dst_w + x) * 3 + c] / 255.0f;
+            }
+        }
+    }
+
+    if (dst_fp16) {
+        size_t n = (size_t)3 * dst_w * dst_h;
+        for (size_t i = 0; i < n; i++) {
+            dst_fp16[i] = preprocess_float_to_half(dst[i]);
+        }
+    }
+}
+
+/* Per-element float16 -> float32 (onnx_loader.c / trt_loader.cpp before
+ * preprocess_half_to_float) */
+static float legacy_half_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    uint32_t f;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            f = sign;
+        } else {
+            exponent = 1;
+            while ((mantissa & 0x400) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            mantissa &= 0x3FF;
+            f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 31) {
+        f = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float out;
+    memcpy(&out, &f, sizeof(out));
+    return out;
+}
+
+/* ============================================
+ * Benchmark
+ * ============================================ */
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static uint8_t* create_test_image(int w, int h) {
+    uint8_t* data = (uint8_t*)malloc((size_t)w * h * 3);
+    if (!data) return NULL;
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < (size_t)w * h * 3; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (uint8_t)(seed >> 24);
+    }
+    return data;
+}
+
+typedef struct {
+    const char* name;
+    int src_w, src_h;
+    int dst_w, dst_h;
+    int layout;
+    int fp16;
+    int letterbox;
+} bench_case_t;
+
+static int run_case(const bench_case_t* bc, int iterations) {
+    size_t elems = (size_t)3 * bc->dst_w * bc->dst_h;
+    uint8_t* src = create_test_image(bc->src_w, bc->src_h);
+    uint8_t* resized = (uint8_t*)malloc((size_t)bc->dst_w * bc->dst_h * 3);
+    float* legacy = (float*)malloc(elems * sizeof(float));
+    uint16_t* legacy_fp16 = bc->fp16 ? (uint16_t*)malloc(elems * sizeof(uint16_t)) : NULL;
+    void* scalar_out = malloc(elems * sizeof(float));
+    void* simd_out = malloc(elems * sizeof(float));
+    preprocess_plan_t plan;
+
+    if (!src || !resized || !legacy || (bc->fp16 && !legacy_fp16) || !scalar_out || !simd_out ||
+        preprocess_init(&plan, bc->dst_w, bc->dst_h, bc->layout, bc->fp16, bc->letterbox) != CIRA_OK) {
+        printf("  %s: allocation failed\n", bc->name);
+        return 1;
+    }
+    int simd = plan.use_simd;
+
+    double t0 = now_ms();
+    for (int i = 0; i < iterations; i++) {
+        legacy_preprocess(src, bc->src_w, bc->src_h, resized, legacy, legacy_fp16,
+                          bc->dst_w, bc->dst_h);
+    }
+    double t_legacy = (now_ms() - t0) / iterations;
+
+    plan.use_simd = 0;
+    t0 = now_ms();
+    for (int i = 0; i < iterations; i++) {
+        preprocess_run(&plan, src, bc->src_w, bc->src_h, scalar_out);
+    }
+    double t_scalar = (now_ms() - t0) / iterations;
+
+    plan.use_simd = simd;
+    t0 = now_ms();
+    for (int i = 0; i < iterations; i++) {
+        preprocess_run(&plan, src, bc->src_w, bc->src_h, simd_out);
+    }
+    double t_simd = (now_ms() - t0) / iterations;
+
+    /* SIMD must match scalar (FMA may differ in the last float bit) */
+    double max_diff = 0.0;
+    for (size_t i = 0; i < elems; i++) {
+        double d = bc->fp16
+            ? fabs((double)((uint16_t*)scalar_out)[i] - ((uint16_t*)simd_out)[i])
+            : fabs((double)((float*)scalar_out)[i] - ((float*)simd_out)[i]);
+        if (d > max_diff) max_diff = d;
+    }
+    double tolerance = bc->fp16 ? 1.0 : 1e-5;
+    int ok = max_diff <= tolerance;
+
+    printf("  %-34s legacy %7.2f ms  fused %7.2f ms  %s %7.2f ms  (%.1fx)  diff %g %s\n",
+           bc->name, t_legacy, t_scalar, preprocess_simd_name(), t_simd,
+           t_simd > 0 ? t_legacy / t_simd : 0.0, max_diff, ok ? "OK" : "MISMATCH");
+
+    preprocess_free(&plan);
+    free(src);
+    free(resized);
+    free(legacy);
+    free(legacy_fp16);
+    free(scalar_out);
+    free(simd_out);
+    return ok ? 0 : 1;
+}
+
+/* float16 output conversion: timed on a YOLOv8 640 output, checked on all halves */
+static int run_half_case(int iterations) {
+    const size_t elems = (size_t)84 * 8400;
+    uint16_t* half = (uint16_t*)malloc(elems * sizeof(uint16_t));
+    float* legacy = (float*)malloc(elems * sizeof(float));
+    float* fast = (float*)malloc(elems * sizeof(float));
+    if (!half || !legacy || !fast) {
+        printf("  fp16 output: allocation failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < elems; i++) {
+        half[i] = preprocess_float_to_half((float)(i % 1000) * 0.37f - 20.0f);
+    }
+
+    double t0 = now_ms();
+    for (int it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < elems; i++) {
+            legacy[i] = legacy_half_to_float(half[i]);
+        }
+    }
+    double t_legacy = (now_ms() - t0) / iterations;
+
+    t0 = now_ms();
+    for (int it = 0; it < iterations; it++) {
+        preprocess_half_to_float(half, fast, elems);
+    }
+    double t_fast = (now_ms() - t0) / iterations;
+
+    /* Bit-exact on every half value (NaNs compared as NaN) */
+    int mismatches = 0;
+    for (size_t i = 0; i < elems && i < 65536; i++) {
+        half[i] = (uint16_t)i;
+    }
+    preprocess_half_to_float(half, fast, 65536);
+    for (uint32_t i = 0; i < 65536; i++) {
+        float want = legacy_half_to_float((uint16_t)i);
+        if (isnan(want) ? !isnan(fast[i]) : memcmp(&want, &fast[i], sizeof(float)) != 0) {
+            mismatches++;
+        }
+    }
+
+    printf("  %-34s legacy %7.2f ms  %s %7.2f ms  (%.1fx)  %s\n",
+           "fp16 output 84x8400 -> fp32", t_legacy, preprocess_simd_name(), t_fast,
+           t_fast > 0 ? t_legacy / t_fast : 0.0, mismatches ? "MISMATCH" : "OK");
+
+    free(half);
+    free(legacy);
+    free(fast);
+    return mismatches ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+    if (iterations <= 0) iterations = 1;
+
+    printf("CiRA Runtime - Preprocessing Benchmark\n");
+    printf("Version: %s, vector unit: %s, %d iterations\n\n",
+           cira_version(), preprocess_simd_name(), iterations);
+
+    const bench_case_t cases[] = {
+        { "1080p -> 640x640 stretch fp32",   1920, 1080, 640, 640, PREPROCESS_NCHW, 0, 0 },
+        { "1080p -> 640x640 letterbox fp32", 1920, 1080, 640, 640, PREPROCESS_NCHW, 0, 1 },
+        { "1080p -> 640x640 stretch fp16",   1920, 1080, 640, 640, PREPROCESS_NCHW, 1, 0 },
+        { "720p -> 416x416 stretch NHWC",    1280,  720, 416, 416, PREPROCESS_NHWC, 0, 0 },
+        { "640x640 -> 640x640 copy fp32",     640,  640, 640, 640, PREPROCESS_NCHW, 0, 0 },
+    };
+
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        failures += run_case(&cases[i], iterations);
+    }
+    failures += run_half_case(iterations);
+
+    printf("\n%s\n", failures ? "FAILED" : "All cases match");
+    return failures ? 1 : 0;
+}
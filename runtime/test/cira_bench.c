@@ -0,0 +1,486 @@
+/**
+ * CiRA Runtime - Inference Benchmark
+ *
+ * Loads each model given (a model, or a directory of models of any
+ * format this build supports) and times every stage of a prediction
+ * separately: model load, first (warm-up) inference, preprocess, network
+ * execution, decode/NMS, result JSON and JPEG encode. Frames come from a
+ * directory of binary PPM images or are synthesized. Reports p50/p95/p99
+ * latency per stage and throughput as JSON, for comparing backends on
+ * one device and runtime releases against each other.
+ *
+ * Usage:
+ *   ./cira_bench [options] <model_or_models_dir>
+ *     -n N        Timed iterations per model (default 100)
+ *     -w N        Warm-up iterations (default 10)
+ *     -i DIR      Cycle through the .ppm images in DIR instead of synthetic frames
+ *     -s WxH      Synthetic frame size (default 1280x720)
+ *     -q Q        JPEG quality (default 80)
+ *     -o KEY=VAL  Runtime option, as cira -o (repeatable)
+ *     -f FILE     Write the JSON report to FILE instead of stdout
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cira.h"
+#include "cira_internal.h"
+#ifdef CIRA_STREAMING_ENABLED
+#include "jpeg_encoder.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define BENCH_MAX_FRAMES 64
+#define BENCH_SYNTHETIC_FRAMES 8
+#define BENCH_MAX_OPTIONS 32
+
+/* Timed stages, in report order */
+enum {
+    STAGE_PREPROCESS = 0,
+    STAGE_INFERENCE,
+    STAGE_DECODE,
+    STAGE_PREDICT,      /* Whole cira_predict_image() call */
+    STAGE_JSON,
+    STAGE_JPEG,
+    NUM_STAGES
+};
+
+static const char* g_stage_names[NUM_STAGES] = {
+    "preprocess", "inference", "decode", "predict", "json", "jpeg"
+};
+
+typedef struct {
+    uint8_t* rgb;
+    int w, h;
+} bench_frame_t;
+
+typedef struct {
+    int iterations;
+    int warmup;
+    int quality;
+    const char* options[BENCH_MAX_OPTIONS];
+    int num_options;
+    bench_frame_t frames[BENCH_MAX_FRAMES];
+    int num_frames;
+    const char* source;
+} bench_config_t;
+
+/* ============================================
+ * Frames
+ * ============================================ */
+
+/* Skip whitespace and comments of a PPM header */
+static int ppm_skip(FILE* f) {
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(f)) != EOF && c != '\n') {}
+        } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            ungetc(c, f);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Binary PPM (P6, maxval 255) to packed RGB */
+static int load_ppm(const char* path, bench_frame_t* frame) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+
+    int w = 0, h = 0, maxval = 0;
+    char magic[3] = {0};
+    int ok = fread(magic, 1, 2, f) == 2 && strcmp(magic, "P6") == 0 &&
+             ppm_skip(f) && fscanf(f, "%d", &w) == 1 &&
+             ppm_skip(f) && fscanf(f, "%d", &h) == 1 &&
+             ppm_skip(f) && fscanf(f, "%d", &maxval) == 1 &&
+             fgetc(f) != EOF && w > 0 && h > 0 && w <= 16384 && h <= 16384 && maxval == 255;
+
+    if (ok) {
+        size_t bytes = (size_t)w * h * 3;
+        frame->rgb = (uint8_t*)malloc(bytes);
+        ok = frame->rgb && fread(frame->rgb, 1, bytes, f) == bytes;
+        if (!ok) {
+            free(frame->rgb);
+            frame->rgb = NULL;
+        }
+        frame->w = w;
+        frame->h = h;
+    }
+    fclose(f);
+    return ok;
+}
+
+static int has_suffix(const char* name, const char* suffix) {
+    size_t n = strlen(name), s = strlen(suffix);
+    return n > s && strcmp(name + n - s, suffix) == 0;
+}
+
+static int load_images(bench_config_t* cfg, const char* dir) {
+    struct dirent** entries = NULL;
+    int n = scandir(dir, &entries, NULL, alphasort);
+    if (n < 0) return 0;
+
+    for (int i = 0; i < n; i++) {
+        if (cfg->num_frames < BENCH_MAX_FRAMES && has_suffix(entries[i]->d_name, ".ppm")) {
+            char path[1024];
+            snprintf(path, sizeof(path), "%s/%s", dir, entries[i]->d_name);
+            if (load_ppm(path, &cfg->frames[cfg->num_frames])) {
+                cfg->num_frames++;
+            } else {
+                fprintf(stderr, "Skipping %s (not a binary 8-bit PPM)\n", path);
+            }
+        }
+        free(entries[i]);
+    }
+    free(entries);
+    return cfg->num_frames;
+}
+
+/* Gradient background with a few boxes that move between frames */
+static int make_synthetic(bench_config_t* cfg, int w, int h) {
+    for (int k = 0; k < BENCH_SYNTHETIC_FRAMES; k++) {
+        uint8_t* rgb = (uint8_t*)malloc((size_t)w * h * 3);
+        if (!rgb) return 0;
+
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                uint8_t* p = rgb + ((size_t)y * w + x) * 3;
+                p[0] = (uint8_t)(x * 255 / w);
+                p[1] = (uint8_t)(y * 255 / h);
+                p[2] = 96;
+            }
+        }
+        for (int b = 0; b < 4; b++) {
+            int bw = w / 8, bh = h / 6;
+            int bx = (w / 5) * b + (k * w / 64) % (w / 5);
+            int by = h / 4 + (b % 2) * h / 3;
+            for (int y = by; y < by + bh && y < h; y++) {
+                for (int x = bx; x < bx + bw && x < w; x++) {
+                    uint8_t* p = rgb + ((size_t)y * w + x) * 3;
+                    p[0] = (uint8_t)(40 * b);
+                    p[1] = 200;
+                    p[2] = (uint8_t)(255 - 40 * b);
+                }
+            }
+        }
+
+        cfg->frames[cfg->num_frames].rgb = rgb;
+        cfg->frames[cfg->num_frames].w = w;
+        cfg->frames[cfg->num_frames].h = h;
+        cfg->num_frames++;
+    }
+    return 1;
+}
+
+/* ============================================
+ * Statistics
+ * ============================================ */
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static double percentile(const double* sorted, int n, double p) {
+    int rank = (int)(p / 100.0 * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+static void print_stage(FILE* out, const char* name, double* samples, int n, int first) {
+    fprintf(out, "%s\"%s\":", first ? "" : ",", name);
+    if (n == 0) {
+        fprintf(out, "null");
+        return;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += samples[i];
+    qsort(samples, n, sizeof(double), cmp_double);
+    fprintf(out, "{\"mean_ms\":%.3f,\"p50_ms\":%.3f,\"p95_ms\":%.3f,\"p99_ms\":%.3f,"
+            "\"min_ms\":%.3f,\"max_ms\":%.3f}",
+            sum / n, percentile(samples, n, 50), percentile(samples, n, 95),
+            percentile(samples, n, 99), samples[0], samples[n - 1]);
+}
+
+/* JSON string body (paths only need quotes and backslashes escaped) */
+static void print_escaped(FILE* out, const char* s) {
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        if ((unsigned char)*s >= 0x20) fputc(*s, out);
+    }
+}
+
+/* ============================================
+ * Benchmark
+ * ============================================ */
+
+static void bench_model(const bench_config_t* cfg, const char* path, FILE* out, int first) {
+    fprintf(out, "%s\n    {\"path\":\"", first ? "" : ",");
+    print_escaped(out, path);
+    fprintf(out, "\",\"format\":\"%s\"", cira_format_name(cira_detect_format(path)));
+
+    cira_ctx* ctx = cira_create();
+    if (!ctx) {
+        fprintf(out, ",\"error\":\"out of memory\"}");
+        return;
+    }
+    for (int i = 0; i < cfg->num_options; i++) {
+        char key[128];
+        const char* eq = strchr(cfg->options[i], '=');
+        snprintf(key, sizeof(key), "%.*s", (int)(eq - cfg->options[i]), cfg->options[i]);
+        if (cira_set_option(ctx, key, eq + 1) != CIRA_OK) {
+            fprintf(stderr, "Option %s: %s\n", cfg->options[i], cira_error(ctx));
+        }
+    }
+
+    fprintf(stderr, "Benchmarking %s\n", path);
+    if (cira_load(ctx, path) != CIRA_OK) {
+        fprintf(out, ",\"error\":\"");
+        print_escaped(out, cira_error(ctx));
+        fprintf(out, "\"}");
+        cira_destroy(ctx);
+        return;
+    }
+
+    /* The load includes one warm-up inference on a gray frame */
+    fprintf(out, ",\"model\":\"");
+    print_escaped(out, ctx->model_name);
+    fprintf(out, "\",\"precision\":\"%s\"", cira_precision_name(ctx->precision));
+    fprintf(out, ",\"input\":[%d,%d],\"load_ms\":%.3f,\"first_inference_ms\":%.3f",
+            ctx->input_w, ctx->input_h, ctx->reload_ms - ctx->reload_warmup_ms,
+            ctx->reload_warmup_ms);
+
+    double t0 = cira_time_ms();
+    for (int i = 0; i < cfg->warmup; i++) {
+        const bench_frame_t* f = &cfg->frames[i % cfg->num_frames];
+        cira_predict_image(ctx, f->rgb, f->w, f->h, 3);
+    }
+    fprintf(out, ",\"warmup_ms\":%.3f", cira_time_ms() - t0);
+
+    double* samples[NUM_STAGES];
+    int counts[NUM_STAGES] = {0};
+    for (int s = 0; s < NUM_STAGES; s++) {
+        samples[s] = (double*)malloc(cfg->iterations * sizeof(double));
+        if (!samples[s]) {
+            fprintf(stderr, "Failed to allocate samples\n");
+            exit(1);
+        }
+    }
+
+    int errors = 0;
+    long detections = 0;
+    double busy = 0.0;
+    for (int i = 0; i < cfg->iterations; i++) {
+        const bench_frame_t* f = &cfg->frames[i % cfg->num_frames];
+
+        double ta = cira_time_ms();
+        memset(&ctx->predict_timing, 0, sizeof(ctx->predict_timing));
+        if (cira_predict_image(ctx, f->rgb, f->w, f->h, 3) != CIRA_OK) {
+            errors++;
+            continue;
+        }
+        double tb = cira_time_ms();
+
+        /* Results are formatted when first read */
+        cira_result_json(ctx);
+        double tc = cira_time_ms();
+
+        samples[STAGE_PREPROCESS][counts[STAGE_PREPROCESS]++] = ctx->predict_timing.preprocess_ms;
+        samples[STAGE_INFERENCE][counts[STAGE_INFERENCE]++] = ctx->predict_timing.inference_ms;
+        samples[STAGE_DECODE][counts[STAGE_DECODE]++] = ctx->predict_timing.decode_ms;
+        samples[STAGE_PREDICT][counts[STAGE_PREDICT]++] = tb - ta;
+        samples[STAGE_JSON][counts[STAGE_JSON]++] = tc - tb;
+        detections += cira_result_count(ctx);
+        busy += tc - ta;
+
+#ifdef CIRA_STREAMING_ENABLED
+        uint8_t* jpeg;
+        size_t jpeg_size;
+        if (jpeg_encode(f->rgb, f->w, f->h, cfg->quality, &jpeg, &jpeg_size) == CIRA_OK) {
+            double td = cira_time_ms();
+            samples[STAGE_JPEG][counts[STAGE_JPEG]++] = td - tc;
+            busy += td - tc;
+        }
+#endif
+    }
+
+    int timed = counts[STAGE_PREDICT];
+    fprintf(out, ",\"iterations\":%d,\"errors\":%d,\"detections_per_frame\":%.2f",
+            timed, errors, timed ? (double)detections / timed : 0.0);
+#ifdef CIRA_STREAMING_ENABLED
+    fprintf(out, ",\"jpeg_encoder\":\"%s\"", jpeg_encoder_name());
+#endif
+
+    fprintf(out, ",\n     \"stages\":{");
+    for (int s = 0; s < NUM_STAGES; s++) {
+        print_stage(out, g_stage_names[s], samples[s], counts[s], s == 0);
+    }
+    fprintf(out, "}");
+
+    /* Throughput: sequential frames per second, inference alone and end to end */
+    double predict_total = 0.0;
+    for (int i = 0; i < timed; i++) predict_total += samples[STAGE_PREDICT][i];
+    fprintf(out, ",\"predict_fps\":%.2f,\"throughput_fps\":%.2f}",
+            predict_total > 0.0 ? timed * 1000.0 / predict_total : 0.0,
+            busy > 0.0 ? timed * 1000.0 / busy : 0.0);
+
+    for (int s = 0; s < NUM_STAGES; s++) free(samples[s]);
+    cira_destroy(ctx);
+}
+
+static int is_dir(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+/* Entries of a models directory: model subdirectories and single-file models */
+static int is_model_entry(const char* path) {
+    if (is_dir(path)) return cira_detect_format(path) != CIRA_FORMAT_UNKNOWN;
+    return has_suffix(path, ".onnx") || has_suffix(path, ".engine") || has_suffix(path, ".trt");
+}
+
+/*
+ * A model, or every model of a directory; returns models run. A directory
+ * is a directory of models if it holds model subdirectories or several
+ * single-file models, otherwise a model directory (e.g. one .onnx with its
+ * labels and manifest).
+ */
+static int bench_path(const bench_config_t* cfg, const char* path, FILE* out) {
+    struct dirent** entries = NULL;
+    int n = is_dir(path) ? scandir(path, &entries, NULL, alphasort) : -1;
+
+    char (*children)[1024] = n > 0 ? malloc((size_t)n * sizeof(*children)) : NULL;
+    int num_children = 0, subdirs = 0;
+    for (int i = 0; i < n; i++) {
+        if (children && entries[i]->d_name[0] != '.') {
+            char* child = children[num_children];
+            snprintf(child, sizeof(children[0]), "%s/%s", path, entries[i]->d_name);
+            if (is_model_entry(child)) {
+                subdirs += is_dir(child);
+                num_children++;
+            }
+        }
+        free(entries[i]);
+    }
+    free(entries);
+
+    int models = 0;
+    if (subdirs > 0 || num_children > 1) {
+        for (int i = 0; i < num_children; i++) {
+            bench_model(cfg, children[i], out, models == 0);
+            models++;
+        }
+    } else if (!is_dir(path) || cira_detect_format(path) != CIRA_FORMAT_UNKNOWN) {
+        bench_model(cfg, path, out, 1);
+        models = 1;
+    }
+    free(children);
+    return models;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [options] <model_or_models_dir>\n"
+            "  -n N        Timed iterations per model (default 100)\n"
+            "  -w N        Warm-up iterations (default 10)\n"
+            "  -i DIR      Cycle through DIR/*.ppm instead of synthetic frames\n"
+            "  -s WxH      Synthetic frame size (default 1280x720)\n"
+            "  -q Q        JPEG quality (default 80)\n"
+            "  -o KEY=VAL  Runtime option (repeatable)\n"
+            "  -f FILE     Write the JSON report to FILE\n", prog);
+}
+
+int main(int argc, char** argv) {
+    static bench_config_t cfg;
+    cfg.iterations = 100;
+    cfg.warmup = 10;
+    cfg.quality = 80;
+    const char* images = NULL;
+    const char* report = NULL;
+    const char* path = NULL;
+    int w = 1280, h = 720;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (arg[0] != '-' || !arg[1]) {
+            path = arg;
+            continue;
+        }
+        if (!val || arg[2]) {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+        switch (arg[1]) {
+            case 'n': cfg.iterations = atoi(val); break;
+            case 'w': cfg.warmup = atoi(val); break;
+            case 'i': images = val; break;
+            case 'q': cfg.quality = atoi(val); break;
+            case 'f': report = val; break;
+            case 's':
+                if (sscanf(val, "%dx%d", &w, &h) != 2 || w < 16 || h < 16) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+            case 'o':
+                if (!strchr(val, '=') || cfg.num_options >= BENCH_MAX_OPTIONS) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                cfg.options[cfg.num_options++] = val;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (!path || cfg.iterations < 1 || cfg.warmup < 0 || cfg.quality < 1 || cfg.quality > 100) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (images) {
+        cfg.source = "images";
+        if (!load_images(&cfg, images)) {
+            fprintf(stderr, "No PPM images in %s\n", images);
+            return 1;
+        }
+    } else {
+        cfg.source = "synthetic";
+        if (!make_synthetic(&cfg, w, h)) {
+            fprintf(stderr, "Failed to allocate frames\n");
+            return 1;
+        }
+    }
+
+    FILE* out = report ? fopen(report, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", report);
+        return 1;
+    }
+
+    fprintf(out, "{\"runtime\":\"%s\",\"source\":\"%s\",\"frames\":%d,"
+            "\"frame_size\":[%d,%d],\"warmup\":%d,\"iterations\":%d,\"models\":[",
+            cira_version(), cfg.source, cfg.num_frames, cfg.frames[0].w, cfg.frames[0].h,
+            cfg.warmup, cfg.iterations);
+    int models = bench_path(&cfg, path, out);
+    fprintf(out, "\n]}\n");
+
+    if (out != stdout) fclose(out);
+    for (int i = 0; i < cfg.num_frames; i++) free(cfg.frames[i].rgb);
+
+    if (models == 0) {
+        fprintf(stderr, "No models found in %s\n", path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * CiRA Runtime - YUYV Conversion Test
+ *
+ * Checks capture_yuyv_to_rgb() against known BT.601 limited-range colours
+ * (black, white, gray, primaries, out-of-range clamping), then against a
+ * floating-point reference on random images with row padding and odd
+ * widths. Every output byte must be within 1 of the reference, and
+ * nothing may be written past the destination.
+ *
+ * Usage:
+ *   ./test_capture_yuyv
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "capture_v4l2.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+/* Guard bytes after each destination */
+#define GUARD 16
+#define GUARD_BYTE 0xA5
+
+/* One pixel pair: Y0 Y1 sharing U V, and the RGB expected for each */
+typedef struct {
+    uint8_t y0, u, y1, v;
+    uint8_t rgb0[3];
+    uint8_t rgb1[3];
+} known_pair_t;
+
+static const known_pair_t known[] = {
+    /* Black, white and mid gray */
+    { 16, 128, 16, 128,   { 0, 0, 0 },       { 0, 0, 0 } },
+    { 235, 128, 235, 128, { 255, 255, 255 }, { 255, 255, 255 } },
+    { 126, 128, 126, 128, { 128, 128, 128 }, { 128, 128, 128 } },
+    /* Primaries */
+    { 81, 90, 81, 240,    { 255, 0, 0 },     { 255, 0, 0 } },
+    { 145, 54, 145, 34,   { 0, 255, 1 },     { 0, 255, 1 } },
+    { 41, 240, 41, 110,   { 0, 0, 255 },     { 0, 0, 255 } },
+    /* Below black and above white clamp */
+    { 0, 128, 255, 128,   { 0, 0, 0 },       { 255, 255, 255 } },
+    /* Two different lumas share the pair's chroma */
+    { 16, 128, 235, 128,  { 0, 0, 0 },       { 255, 255, 255 } },
+};
+
+static uint8_t ref_clamp(float v) {
+    if (v < 0.0f) return 0;
+    if (v > 255.0f) return 255;
+    return (uint8_t)(v + 0.5f);
+}
+
+/* Floating-point BT.601 limited range */
+static void ref_pixel(int y, int u, int v, uint8_t* rgb) {
+    float c = 1.164383f * (y - 16);
+    float d = (float)(u - 128);
+    float e = (float)(v - 128);
+    rgb[0] = ref_clamp(c + 1.596027f * e);
+    rgb[1] = ref_clamp(c - 0.391762f * d - 0.812968f * e);
+    rgb[2] = ref_clamp(c + 2.017232f * d);
+}
+
+static int guard_intact(const uint8_t* guard) {
+    for (int i = 0; i < GUARD; i++) {
+        if (guard[i] != GUARD_BYTE) return 0;
+    }
+    return 1;
+}
+
+static int test_known(void) {
+    int pairs = (int)(sizeof(known) / sizeof(known[0]));
+    uint8_t src[sizeof(known) / sizeof(known[0]) * 4];
+    uint8_t dst[sizeof(known) / sizeof(known[0]) * 6];
+    for (int i = 0; i < pairs; i++) {
+        src[i * 4 + 0] = known[i].y0;
+        src[i * 4 + 1] = known[i].u;
+        src[i * 4 + 2] = known[i].y1;
+        src[i * 4 + 3] = known[i].v;
+    }
+
+    capture_yuyv_to_rgb(src, pairs * 4, pairs * 2, 1, dst);
+    for (int i = 0; i < pairs; i++) {
+        const uint8_t* d = dst + i * 6;
+        if (memcmp(d, known[i].rgb0, 3) != 0 || memcmp(d + 3, known[i].rgb1, 3) != 0) {
+            fprintf(stderr, "  pair %d: got %d,%d,%d %d,%d,%d\n", i,
+                    d[0], d[1], d[2], d[3], d[4], d[5]);
+        }
+        CHECK(memcmp(d, known[i].rgb0, 3) == 0);
+        CHECK(memcmp(d + 3, known[i].rgb1, 3) == 0);
+    }
+    return 0;
+}
+
+/* Odd width: the last pixel takes the first luma of a padded pair */
+static int test_odd_width_known(void) {
+    /* Width 3: white, black, then red from the padded second pair */
+    const uint8_t src[8] = { 235, 128, 16, 128,   81, 90, 0, 240 };
+    uint8_t dst[9 + GUARD];
+    memset(dst, GUARD_BYTE, sizeof(dst));
+
+    capture_yuyv_to_rgb(src, 8, 3, 1, dst);
+    const uint8_t expected[9] = { 255, 255, 255,  0, 0, 0,  255, 0, 0 };
+    CHECK(memcmp(dst, expected, 9) == 0);
+    CHECK(guard_intact(dst + 9));
+
+    /* Width 1 */
+    memset(dst, GUARD_BYTE, sizeof(dst));
+    capture_yuyv_to_rgb(src + 4, 4, 1, 1, dst);
+    CHECK(dst[0] == 255 && dst[1] == 0 && dst[2] == 0);
+    CHECK(guard_intact(dst + 3));
+    return 0;
+}
+
+/* Random images with padded rows against the float reference */
+static int test_random(int width, int height, int pad) {
+    int pairs = (width + 1) / 2;
+    int stride = pairs * 4 + pad;
+    uint8_t* src = (uint8_t*)malloc((size_t)stride * height);
+    uint8_t* dst = (uint8_t*)malloc((size_t)width * height * 3 + GUARD);
+    CHECK(src && dst);
+
+    for (int i = 0; i < stride * height; i++) {
+        src[i] = (uint8_t)(rand() & 0xff);
+    }
+    memset(dst, GUARD_BYTE, (size_t)width * height * 3 + GUARD);
+
+    capture_yuyv_to_rgb(src, stride, width, height, dst);
+
+    int worst = 0;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const uint8_t* s = src + (size_t)y * stride + (x / 2) * 4;
+            uint8_t ref[3];
+            ref_pixel((x & 1) ? s[2] : s[0], s[1], s[3], ref);
+            const uint8_t* d = dst + ((size_t)y * width + x) * 3;
+            for (int c = 0; c < 3; c++) {
+                int diff = abs((int)d[c] - (int)ref[c]);
+                if (diff > worst) worst = diff;
+            }
+        }
+    }
+    CHECK(worst <= 1);
+    CHECK(guard_intact(dst + (size_t)width * height * 3));
+
+    printf("  %dx%d (+%d pad): max diff %d\n", width, height, pad, worst);
+    free(src);
+    free(dst);
+    return 0;
+}
+
+int main(void) {
+    srand(1234);
+
+    if (test_known() != 0) return 1;
+    if (test_odd_width_known() != 0) return 1;
+
+    printf("Random images vs float reference:\n");
+    if (test_random(64, 48, 0) != 0) return 1;
+    if (test_random(640, 16, 128) != 0) return 1;
+    if (test_random(33, 7, 0) != 0) return 1;
+    if (test_random(101, 11, 12) != 0) return 1;
+    if (test_random(1, 5, 4) != 0) return 1;
+
+    printf("test_capture_yuyv: OK\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * CiRA Runtime - CPU Affinity Test
+ *
+ * Parses and formats CPU sets, builds topologies from synthetic
+ * capacities (big.LITTLE, uniform, tiny) and checks the default split
+ * between thread classes, then pins this thread and reads it back where
+ * the system supports pinning.
+ *
+ * Usage:
+ *   ./test_cpu_affinity
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cpu_affinity.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+int main(void) {
+    cpu_topology_t topo;
+    cpu_mask_t masks[CPU_CLASSES];
+    cpu_mask_t mask;
+    char text[64];
+
+    /* RK3588: four A55 (capacity 414) then four A76 (1024) */
+    int rk3588[8] = {414, 414, 414, 414, 1024, 1024, 1024, 1024};
+    cpu_topology_from_capacity(&topo, rk3588, 8);
+    CHECK(topo.num_cpus == 8);
+    CHECK(topo.all == 0xFF);
+    CHECK(topo.little == 0x0F);
+    CHECK(topo.big == 0xF0);
+
+    cpu_affinity_plan(&topo, masks);
+    CHECK(masks[CPU_CLASS_INFERENCE] == 0xF0);
+    CHECK(masks[CPU_CLASS_CAPTURE] == 0x0F);
+    CHECK(masks[CPU_CLASS_ENCODE] == 0x0F);
+    CHECK(masks[CPU_CLASS_HTTP] == 0x0F);
+
+    /* Parsing */
+    CHECK(cpu_mask_parse("0-3,6", &topo, &mask) == 0 && mask == 0x4F);
+    CHECK(cpu_mask_parse("7", &topo, &mask) == 0 && mask == 0x80);
+    CHECK(cpu_mask_parse("big", &topo, &mask) == 0 && mask == 0xF0);
+    CHECK(cpu_mask_parse("little", &topo, &mask) == 0 && mask == 0x0F);
+    CHECK(cpu_mask_parse("all", &topo, &mask) == 0 && mask == 0xFF);
+    CHECK(cpu_mask_parse("none", &topo, &mask) == 0 && mask == 0);
+    CHECK(cpu_mask_parse("", &topo, &mask) == 0 && mask == 0);
+    CHECK(cpu_mask_parse("8", &topo, &mask) != 0);
+    CHECK(cpu_mask_parse("3-1", &topo, &mask) != 0);
+    CHECK(cpu_mask_parse("0,", &topo, &mask) != 0);
+    CHECK(cpu_mask_parse("0-", &topo, &mask) != 0);
+    CHECK(cpu_mask_parse("-1", &topo, &mask) != 0);
+    CHECK(cpu_mask_parse("1 2", &topo, &mask) != 0);
+
+    /* Formatting */
+    cpu_mask_format(0x4F, text, sizeof(text));
+    CHECK(strcmp(text, "0-3,6") == 0);
+    cpu_mask_format(0xA5, text, sizeof(text));
+    CHECK(strcmp(text, "0,2,5,7") == 0);
+    cpu_mask_format(0, text, sizeof(text));
+    CHECK(strcmp(text, "") == 0);
+    cpu_mask_format(~(cpu_mask_t)0, text, sizeof(text));
+    CHECK(strcmp(text, "0-63") == 0);
+    CHECK(cpu_mask_count(0x4F) == 5);
+
+    /* Orin: twelve equal cores, two kept for the service threads */
+    int orin[12];
+    for (int i = 0; i < 12; i++) orin[i] = 2201600;
+    cpu_topology_from_capacity(&topo, orin, 12);
+    CHECK(topo.little == 0 && topo.big == 0xFFF);
+    CHECK(cpu_mask_parse("little", &topo, &mask) != 0);
+    cpu_affinity_plan(&topo, masks);
+    CHECK(masks[CPU_CLASS_INFERENCE] == 0xFFC);
+    CHECK(masks[CPU_CLASS_HTTP] == 0x003);
+
+    /* Four unknown (0) capacities: uniform, one core kept */
+    int unknown[4] = {0, 0, 0, 0};
+    cpu_topology_from_capacity(&topo, unknown, 4);
+    CHECK(topo.little == 0);
+    cpu_affinity_plan(&topo, masks);
+    CHECK(masks[CPU_CLASS_INFERENCE] == 0x0E);
+    CHECK(masks[CPU_CLASS_CAPTURE] == 0x01);
+
+    /* Two cores: nothing pinned */
+    cpu_topology_from_capacity(&topo, unknown, 2);
+    cpu_affinity_plan(&topo, masks);
+    for (int i = 0; i < CPU_CLASSES; i++) CHECK(masks[i] == 0);
+
+    /* This machine */
+    const cpu_topology_t* self = cpu_topology();
+    CHECK(self->num_cpus >= 1);
+    CHECK((self->big | self->little) == self->all);
+    CHECK((self->big & self->little) == 0);
+
+    /* Pin to one allowed CPU and back (skipped where pinning is a no-op) */
+    cpu_mask_t original = cpu_affinity_get_self();
+    if (original) {
+        cpu_mask_t one = original & (~original + 1);
+        CHECK(cpu_affinity_set_self(one) == 0);
+        CHECK(cpu_affinity_get_self() == one);
+        CHECK(cpu_affinity_set_self(0) == 0);
+        CHECK(cpu_affinity_get_self() == one);
+        CHECK(cpu_affinity_set_self(original) == 0);
+        CHECK(cpu_affinity_get_self() == original);
+    }
+
+    CHECK(strcmp(cpu_class_name(CPU_CLASS_INFERENCE), "inference") == 0);
+
+    printf("test_cpu_affinity: OK\n");
+    return 0;
+}
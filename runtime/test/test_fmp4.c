@@ -0,0 +1,208 @@
+/**
+ * CiRA Runtime - Fragmented MP4 Test
+ *
+ * Muxes synthetic H.264 and H.265 access units and checks the init
+ * segment (box layout, avcC / hvcC, codec strings, emulation prevention
+ * in the H.265 SPS) and the fragments (sample size and flags, data offset
+ * pointing at the length-prefixed NAL units, parameter sets left out).
+ *
+ * Usage:
+ *   ./test_fmp4
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "fmp4.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* Find a box by path ("moov/trak/mdia") inside data; NULL if absent or malformed */
+static const uint8_t* find_box(const uint8_t* data, size_t size, const char* path, size_t* box_size) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    while (p + 8 <= end) {
+        uint32_t n = be32(p);
+        if (n < 8 || n > (size_t)(end - p)) return NULL;
+        if (memcmp(p + 4, path, 4) == 0) {
+            if (path[4] == '\0') {
+                *box_size = n;
+                return p;
+            }
+            return find_box(p + 8, n - 8, path + 5, box_size);
+        }
+        p += n;
+    }
+    return NULL;
+}
+
+/* Boxes in data are well formed end to end */
+static int boxes_cover(const uint8_t* data, size_t size) {
+    size_t pos = 0;
+    while (pos + 8 <= size) {
+        uint32_t n = be32(data + pos);
+        if (n < 8 || n > size - pos) return 0;
+        pos += n;
+    }
+    return pos == size;
+}
+
+static const uint8_t H264_AUD[] = { 0x09, 0xF0 };
+static const uint8_t H264_SPS[] = { 0x67, 0x64, 0x00, 0x28, 0xAC, 0xD9, 0x40, 0x78 };
+static const uint8_t H264_PPS[] = { 0x68, 0xEB, 0xE3, 0xCB };
+static const uint8_t H264_IDR[] = { 0x65, 0x88, 0x84, 0x00, 0x33, 0xFF, 0x12 };
+static const uint8_t H264_P[] = { 0x41, 0x9A, 0x24, 0x6C };
+
+/* H.265 SPS with emulation prevention in the profile flags:
+ * compatibility 60 00 00 00, constraints 90 00 00 00 00 00, level 93 */
+static const uint8_t H265_VPS[] = { 0x40, 0x01, 0x0C, 0x01, 0xFF, 0xFF };
+static const uint8_t H265_SPS[] = { 0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00,
+                                    0x90, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x5D,
+                                    0xA0, 0x02, 0x80 };
+static const uint8_t H265_PPS[] = { 0x44, 0x01, 0xC1, 0x72 };
+static const uint8_t H265_IDR[] = { 0x26, 0x01, 0xAF, 0x12, 0x34 };   /* IDR_W_RADL */
+static const uint8_t H265_TRAIL[] = { 0x02, 0x01, 0xD0, 0x55 };        /* TRAIL_R */
+
+/* Append a NAL with a 4- or 3-byte start code */
+static size_t append_nal(uint8_t* au, size_t len, const uint8_t* nal, size_t size, int long_code) {
+    static const uint8_t code[4] = { 0, 0, 0, 1 };
+    size_t n = long_code ? 4 : 3;
+    memcpy(au + len, code + 4 - n, n);
+    memcpy(au + len + n, nal, size);
+    return len + n + size;
+}
+
+int main(void) {
+    uint8_t au[256];
+    uint8_t out[4096];
+    size_t len, n, box_size;
+    char codec[64];
+    fmp4_track_t track;
+
+    /* === H.264 === */
+    fmp4_track_init(&track, FMP4_CODEC_H264, 1280, 720);
+    CHECK(!fmp4_track_ready(&track));
+    CHECK(fmp4_init_segment(&track, out, sizeof(out)) == 0);
+
+    len = append_nal(au, 0, H264_AUD, sizeof(H264_AUD), 1);
+    len = append_nal(au, len, H264_SPS, sizeof(H264_SPS), 1);
+    len = append_nal(au, len, H264_PPS, sizeof(H264_PPS), 0);
+    len = append_nal(au, len, H264_IDR, sizeof(H264_IDR), 0);
+    CHECK(fmp4_is_keyframe(FMP4_CODEC_H264, au, len));
+    CHECK(fmp4_track_update(&track, au, len) == 1);
+    CHECK(fmp4_track_update(&track, au, len) == 0);
+    CHECK(fmp4_track_ready(&track));
+
+    fmp4_codec_string(&track, codec, sizeof(codec));
+    CHECK(strcmp(codec, "avc1.640028") == 0);
+
+    n = fmp4_init_segment(&track, out, sizeof(out));
+    CHECK(n > 0 && boxes_cover(out, n));
+    CHECK(find_box(out, n, "ftyp", &box_size) == out);
+    CHECK(find_box(out, n, "moov/mvex/trex", &box_size) != NULL);
+    const uint8_t* tkhd = find_box(out, n, "moov/trak/tkhd", &box_size);
+    CHECK(tkhd && be32(tkhd + box_size - 8) == 1280u << 16 && be32(tkhd + box_size - 4) == 720u << 16);
+    const uint8_t* avc1 = find_box(out, n, "moov/trak/mdia/minf/stbl/stsd", &box_size);
+    CHECK(avc1 != NULL);
+    avc1 += 16;     /* full box header + entry_count */
+    CHECK(memcmp(avc1 + 4, "avc1", 4) == 0);
+    const uint8_t* avcc = find_box(avc1 + 86, be32(avc1) - 86, "avcC", &box_size);
+    CHECK(avcc && avcc[8] == 1 && avcc[9] == 0x64 && avcc[11] == 0x28);
+    CHECK((avcc[13] & 0x1F) == 1 && avcc[14] == 0 && avcc[15] == sizeof(H264_SPS));
+    CHECK(memcmp(avcc + 16, H264_SPS, sizeof(H264_SPS)) == 0);
+    CHECK(box_size == 8 + 8 + sizeof(H264_SPS) + 3 + sizeof(H264_PPS) + 4);  /* High profile tail */
+    CHECK(fmp4_init_segment(&track, out, 100) == 0);
+
+    /* Keyframe fragment: parameter sets and AUD left out */
+    n = fmp4_fragment(&track, 1, 90000, 3000, 1, au, len, out, sizeof(out));
+    CHECK(n > 0 && n <= fmp4_fragment_bound(len) && boxes_cover(out, n));
+    const uint8_t* mfhd = find_box(out, n, "moof/mfhd", &box_size);
+    CHECK(mfhd && be32(mfhd + 12) == 1);
+    const uint8_t* tfdt = find_box(out, n, "moof/traf/tfdt", &box_size);
+    CHECK(tfdt && tfdt[8] == 1 && be32(tfdt + 12) == 0 && be32(tfdt + 16) == 90000);
+    const uint8_t* trun = find_box(out, n, "moof/traf/trun", &box_size);
+    CHECK(trun && be32(trun + 12) == 1);
+    uint32_t data_offset = be32(trun + 16);
+    CHECK(be32(trun + 20) == 3000);
+    CHECK(be32(trun + 24) == 4 + sizeof(H264_IDR));
+    CHECK(be32(trun + 28) == 0x02000000u);
+    const uint8_t* mdat = find_box(out, n, "mdat", &box_size);
+    CHECK(mdat && (size_t)(mdat - out) + 8 == data_offset);
+    CHECK(be32(out + data_offset) == sizeof(H264_IDR));
+    CHECK(memcmp(out + data_offset + 4, H264_IDR, sizeof(H264_IDR)) == 0);
+    CHECK(box_size == 8 + 4 + sizeof(H264_IDR));
+
+    /* Delta frame */
+    len = append_nal(au, 0, H264_P, sizeof(H264_P), 1);
+    CHECK(!fmp4_is_keyframe(FMP4_CODEC_H264, au, len));
+    CHECK(fmp4_track_update(&track, au, len) == 0);
+    n = fmp4_fragment(&track, 2, 93000, 3000, 0, au, len, out, sizeof(out));
+    trun = find_box(out, n, "moof/traf/trun", &box_size);
+    CHECK(n > 0 && trun && be32(trun + 28) == 0x01010000u);
+    CHECK(fmp4_fragment(&track, 2, 93000, 3000, 0, au, len, out, 40) == 0);
+
+    /* No picture data: no fragment */
+    len = append_nal(au, 0, H264_AUD, sizeof(H264_AUD), 1);
+    CHECK(fmp4_fragment(&track, 3, 96000, 3000, 0, au, len, out, sizeof(out)) == 0);
+
+    /* Changed parameter sets are reported */
+    uint8_t sps2[sizeof(H264_SPS)];
+    memcpy(sps2, H264_SPS, sizeof(sps2));
+    sps2[3] = 0x1F;
+    len = append_nal(au, 0, sps2, sizeof(sps2), 1);
+    CHECK(fmp4_track_update(&track, au, len) == 1);
+    fmp4_codec_string(&track, codec, sizeof(codec));
+    CHECK(strcmp(codec, "avc1.64001F") == 0);
+
+    /* === H.265 === */
+    fmp4_track_init(&track, FMP4_CODEC_H265, 1920, 1080);
+    len = append_nal(au, 0, H265_VPS, sizeof(H265_VPS), 1);
+    len = append_nal(au, len, H265_SPS, sizeof(H265_SPS), 1);
+    CHECK(fmp4_track_update(&track, au, len) == 1);
+    CHECK(!fmp4_track_ready(&track));       /* No PPS yet */
+    len = append_nal(au, len, H265_PPS, sizeof(H265_PPS), 1);
+    len = append_nal(au, len, H265_IDR, sizeof(H265_IDR), 1);
+    CHECK(fmp4_track_update(&track, au, len) == 1);
+    CHECK(fmp4_track_ready(&track));
+    CHECK(fmp4_is_keyframe(FMP4_CODEC_H265, au, len));
+
+    fmp4_codec_string(&track, codec, sizeof(codec));
+    CHECK(strcmp(codec, "hvc1.1.6.L93.90") == 0);
+
+    n = fmp4_init_segment(&track, out, sizeof(out));
+    CHECK(n > 0 && boxes_cover(out, n));
+    const uint8_t* hvc1 = find_box(out, n, "moov/trak/mdia/minf/stbl/stsd", &box_size);
+    CHECK(hvc1 != NULL);
+    hvc1 += 16;
+    CHECK(memcmp(hvc1 + 4, "hvc1", 4) == 0);
+    const uint8_t* hvcc = find_box(hvc1 + 86, be32(hvc1) - 86, "hvcC", &box_size);
+    CHECK(hvcc && hvcc[8] == 1 && hvcc[9] == 0x01);
+    CHECK(be32(hvcc + 10) == 0x60000000u);
+    CHECK(hvcc[14] == 0x90 && hvcc[15] == 0 && hvcc[19] == 0);
+    CHECK(hvcc[20] == 93);
+    CHECK((hvcc[29] & 0x03) == 3 && ((hvcc[29] >> 3) & 0x07) == 1 && (hvcc[29] & 0x04));
+    CHECK(hvcc[30] == 3);
+    CHECK(hvcc[31] == (0x80 | 32) && hvcc[34] == 0 && hvcc[35] == sizeof(H265_VPS));
+
+    n = fmp4_fragment(&track, 1, 0, 3000, 1, au, len, out, sizeof(out));
+    mdat = find_box(out, n, "mdat", &box_size);
+    CHECK(n > 0 && mdat && box_size == 8 + 4 + sizeof(H265_IDR));
+    CHECK(memcmp(mdat + 12, H265_IDR, sizeof(H265_IDR)) == 0);
+
+    len = append_nal(au, 0, H265_TRAIL, sizeof(H265_TRAIL), 0);
+    CHECK(!fmp4_is_keyframe(FMP4_CODEC_H265, au, len));
+    CHECK(fmp4_fragment(&track, 2, 3000, 3000, 0, au, len, out, sizeof(out)) > 0);
+
+    printf("test_fmp4: OK\n");
+    return 0;
+}
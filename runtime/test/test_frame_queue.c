@@ -0,0 +1,335 @@
+/**
+ * CiRA Runtime - Frame Queue Test
+ *
+ * Checks FIFO order and index wraparound, both full-queue policies (what
+ * push returns and hands back as dropped), depth and drop counters, and
+ * that frame_queue_wake() releases a blocked consumer.
+ *
+ * Then runs the camera pipeline's inference and publish hand-off on real
+ * queues: a preprocess thread marks frames no-infer (gate holds, tracker
+ * frames) or inferable and queues all of them for the scheduler, which
+ * infers some and passes everything on to publish. Every frame must be
+ * published or dropped exactly once, publish must see capture order and
+ * only inferable frames may be inferred.
+ *
+ * Usage:
+ *   ./test_frame_queue
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "frame_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define PIPELINE_FRAMES 100000
+
+/* Distinct non-NULL items */
+static int g_items[1024];
+#define ITEM(i) ((void*)&g_items[i])
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* Items come out in push order; empty pops return NULL */
+static int test_fifo(void) {
+    frame_queue_t* q = frame_queue_create(4, FRAME_QUEUE_DROP_OLDEST);
+    CHECK(q != NULL);
+    CHECK(frame_queue_capacity(q) == 4);
+    CHECK(frame_queue_pop(q) == NULL);
+    CHECK(frame_queue_push(q, NULL, NULL) == 0);
+
+    for (int i = 0; i < 4; i++) {
+        void* dropped = ITEM(0);
+        CHECK(frame_queue_push(q, ITEM(i), &dropped) == 1);
+        CHECK(dropped == NULL);
+        CHECK(frame_queue_depth(q) == i + 1);
+    }
+    for (int i = 0; i < 4; i++) {
+        CHECK(frame_queue_pop(q) == ITEM(i));
+    }
+    CHECK(frame_queue_pop(q) == NULL);
+    CHECK(frame_queue_depth(q) == 0);
+    CHECK(frame_queue_dropped(q) == 0);
+
+    /* Capacity is clamped to 1..FRAME_QUEUE_MAX_CAPACITY */
+    frame_queue_t* small = frame_queue_create(0, FRAME_QUEUE_DROP_OLDEST);
+    frame_queue_t* big = frame_queue_create(1000, FRAME_QUEUE_DROP_OLDEST);
+    CHECK(small && big);
+    CHECK(frame_queue_capacity(small) == 1);
+    CHECK(frame_queue_capacity(big) == FRAME_QUEUE_MAX_CAPACITY);
+    frame_queue_destroy(small);
+    frame_queue_destroy(big);
+
+    frame_queue_destroy(q);
+    return 0;
+}
+
+/* Indices run far past the ring size, with the queue at every fill level */
+static int test_wraparound(void) {
+    frame_queue_t* q = frame_queue_create(3, FRAME_QUEUE_DROP_NEWEST);
+    CHECK(q != NULL);
+
+    int next_push = 0;
+    int next_pop = 0;
+    for (int round = 0; round < 1000; round++) {
+        int fill = round % 4;   /* 0..3 items in flight */
+        for (int i = 0; i < fill; i++) {
+            CHECK(frame_queue_push(q, ITEM(next_push % 1024), NULL) == 1);
+            next_push++;
+        }
+        CHECK(frame_queue_depth(q) == fill);
+        for (int i = 0; i < fill; i++) {
+            CHECK(frame_queue_pop(q) == ITEM(next_pop % 1024));
+            next_pop++;
+        }
+        CHECK(frame_queue_pop(q) == NULL);
+    }
+    CHECK(frame_queue_dropped(q) == 0);
+
+    frame_queue_destroy(q);
+    return 0;
+}
+
+/* Full queue, drop_oldest: push succeeds and hands back the evicted head */
+static int test_drop_oldest(void) {
+    frame_queue_t* q = frame_queue_create(2, FRAME_QUEUE_DROP_OLDEST);
+    CHECK(q != NULL);
+
+    CHECK(frame_queue_push(q, ITEM(0), NULL) == 1);
+    CHECK(frame_queue_push(q, ITEM(1), NULL) == 1);
+    for (int i = 2; i < 10; i++) {
+        void* dropped = NULL;
+        CHECK(frame_queue_push(q, ITEM(i), &dropped) == 1);
+        CHECK(dropped == ITEM(i - 2));
+        CHECK(frame_queue_depth(q) == 2);
+        CHECK(frame_queue_dropped(q) == (uint64_t)(i - 1));
+    }
+
+    /* The newest two survive, in order */
+    CHECK(frame_queue_pop(q) == ITEM(8));
+    CHECK(frame_queue_pop(q) == ITEM(9));
+    CHECK(frame_queue_pop(q) == NULL);
+
+    frame_queue_destroy(q);
+    return 0;
+}
+
+/* Full queue, drop_newest: push fails and hands back the new item */
+static int test_drop_newest(void) {
+    frame_queue_t* q = frame_queue_create(2, FRAME_QUEUE_DROP_NEWEST);
+    CHECK(q != NULL);
+
+    CHECK(frame_queue_push(q, ITEM(0), NULL) == 1);
+    CHECK(frame_queue_push(q, ITEM(1), NULL) == 1);
+    for (int i = 2; i < 10; i++) {
+        void* dropped = NULL;
+        CHECK(frame_queue_push(q, ITEM(i), &dropped) == 0);
+        CHECK(dropped == ITEM(i));
+        CHECK(frame_queue_depth(q) == 2);
+    }
+    CHECK(frame_queue_dropped(q) == 8);
+
+    /* The oldest two survive; space frees up again after a pop */
+    CHECK(frame_queue_pop(q) == ITEM(0));
+    CHECK(frame_queue_push(q, ITEM(10), NULL) == 1);
+    CHECK(frame_queue_pop(q) == ITEM(1));
+    CHECK(frame_queue_pop(q) == ITEM(10));
+
+    frame_queue_destroy(q);
+    return 0;
+}
+
+typedef struct {
+    frame_queue_t* q;
+    void* item;
+    double waited_ms;
+} waiter_t;
+
+static void* waiter_thread(void* arg) {
+    waiter_t* w = (waiter_t*)arg;
+    double t0 = now_ms();
+    w->item = frame_queue_pop_wait(w->q, 10000);
+    w->waited_ms = now_ms() - t0;
+    return NULL;
+}
+
+/* pop_wait times out empty, returns a pushed item, and wake() ends the wait */
+static int test_wait(void) {
+    frame_queue_t* q = frame_queue_create(2, FRAME_QUEUE_DROP_OLDEST);
+    CHECK(q != NULL);
+
+    double t0 = now_ms();
+    CHECK(frame_queue_pop_wait(q, 20) == NULL);
+    CHECK(now_ms() - t0 >= 15.0);
+
+    /* Item pushed while the consumer is parked */
+    waiter_t w = { q, NULL, 0 };
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, waiter_thread, &w) == 0);
+    struct timespec pause = { 0, 20 * 1000000L };
+    nanosleep(&pause, NULL);
+    CHECK(frame_queue_push(q, ITEM(7), NULL) == 1);
+    pthread_join(thread, NULL);
+    CHECK(w.item == ITEM(7));
+    CHECK(w.waited_ms < 5000.0);
+
+    /* Shutdown wake with nothing queued */
+    w.item = ITEM(0);
+    CHECK(pthread_create(&thread, NULL, waiter_thread, &w) == 0);
+    nanosleep(&pause, NULL);
+    frame_queue_wake(q);
+    pthread_join(thread, NULL);
+    CHECK(w.item == NULL);
+    CHECK(w.waited_ms < 5000.0);
+
+    frame_queue_destroy(q);
+    return 0;
+}
+
+typedef struct {
+    int seq;
+    int no_infer;
+    int inferred;
+    _Atomic int finished;   /* Published or dropped, must end at exactly 1 */
+} test_frame_t;
+
+typedef struct {
+    test_frame_t* frames;
+    frame_queue_t* infer_q;
+    frame_queue_t* publish_q;
+    atomic_int preprocess_done;
+    atomic_int scheduler_done;
+    int published;
+    int out_of_order;
+    int bad_inference;
+} pipeline_t;
+
+static void finish(test_frame_t* f) {
+    atomic_fetch_add(&f->finished, 1);
+}
+
+/* Preprocess: 3 of 4 frames skip inference (gate holds and tracker
+ * frames alike), the sole producer of infer_q */
+static void* preprocess_thread(void* arg) {
+    pipeline_t* p = (pipeline_t*)arg;
+    for (int i = 0; i < PIPELINE_FRAMES; i++) {
+        test_frame_t* f = &p->frames[i];
+        f->seq = i;
+        f->no_infer = (i % 4) != 0;
+        for (volatile int spin = 0; spin < 1000; spin++) {}
+        void* dropped = NULL;
+        frame_queue_push(p->infer_q, f, &dropped);
+        if (dropped) finish((test_frame_t*)dropped);
+    }
+    atomic_store(&p->preprocess_done, 1);
+    return NULL;
+}
+
+/* Scheduler: the sole producer of publish_q, no-infer frames included */
+static void* scheduler_thread(void* arg) {
+    pipeline_t* p = (pipeline_t*)arg;
+    for (;;) {
+        int done = atomic_load(&p->preprocess_done);
+        test_frame_t* f = (test_frame_t*)frame_queue_pop_wait(p->infer_q, 10);
+        if (!f) {
+            if (done) break;
+            continue;
+        }
+        if (!f->no_infer) {
+            f->inferred = 1;
+            for (volatile int spin = 0; spin < 200; spin++) {}
+        }
+        void* dropped = NULL;
+        frame_queue_push(p->publish_q, f, &dropped);
+        if (dropped) finish((test_frame_t*)dropped);
+    }
+    atomic_store(&p->scheduler_done, 1);
+    return NULL;
+}
+
+static void* publish_thread(void* arg) {
+    pipeline_t* p = (pipeline_t*)arg;
+    int last = -1;
+    for (;;) {
+        int done = atomic_load(&p->scheduler_done);
+        test_frame_t* f = (test_frame_t*)frame_queue_pop_wait(p->publish_q, 10);
+        if (!f) {
+            if (done) break;
+            continue;
+        }
+        if (f->seq <= last) p->out_of_order++;
+        if (f->inferred == f->no_infer) p->bad_inference++;
+        last = f->seq;
+        p->published++;
+        finish(f);
+    }
+    return NULL;
+}
+
+/* Gate-skipped and inferred frames through one pipeline, both policies */
+static int test_pipeline(int policy) {
+    pipeline_t p;
+    memset(&p, 0, sizeof(p));
+    p.frames = (test_frame_t*)calloc(PIPELINE_FRAMES, sizeof(test_frame_t));
+    CHECK(p.frames != NULL);
+    p.infer_q = frame_queue_create(2, policy);
+    p.publish_q = frame_queue_create(2, policy);
+    CHECK(p.infer_q && p.publish_q);
+
+    pthread_t threads[3];
+    CHECK(pthread_create(&threads[0], NULL, publish_thread, &p) == 0);
+    CHECK(pthread_create(&threads[1], NULL, scheduler_thread, &p) == 0);
+    CHECK(pthread_create(&threads[2], NULL, preprocess_thread, &p) == 0);
+    for (int i = 2; i >= 0; i--) {
+        pthread_join(threads[i], NULL);
+    }
+
+    CHECK(frame_queue_depth(p.infer_q) == 0 && frame_queue_depth(p.publish_q) == 0);
+    int dropped = (int)(frame_queue_dropped(p.infer_q) + frame_queue_dropped(p.publish_q));
+    CHECK(p.published + dropped == PIPELINE_FRAMES);
+    CHECK(p.published > 0);
+    for (int i = 0; i < PIPELINE_FRAMES; i++) {
+        CHECK(atomic_load(&p.frames[i].finished) == 1);
+    }
+    CHECK(p.out_of_order == 0);
+    CHECK(p.bad_inference == 0);
+
+    printf("  %s: %d published, %d dropped\n",
+           policy == FRAME_QUEUE_DROP_NEWEST ? "drop_newest" : "drop_oldest",
+           p.published, dropped);
+
+    frame_queue_destroy(p.infer_q);
+    frame_queue_destroy(p.publish_q);
+    free(p.frames);
+    return 0;
+}
+
+int main(void) {
+    if (test_fifo() != 0) return 1;
+    if (test_wraparound() != 0) return 1;
+    if (test_drop_oldest() != 0) return 1;
+    if (test_drop_newest() != 0) return 1;
+    if (test_wait() != 0) return 1;
+
+    printf("Pipeline hand-off:\n");
+    if (test_pipeline(FRAME_QUEUE_DROP_OLDEST) != 0) return 1;
+    if (test_pipeline(FRAME_QUEUE_DROP_NEWEST) != 0) return 1;
+
+    printf("test_frame_queue: OK\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * CiRA Runtime - Frame Ring Test
+ *
+ * Creates a shared-memory frame ring, publishes frames from the writer
+ * mapping and reads them back through a separate read-only mapping, the
+ * way a same-host consumer would.
+ *
+ * Usage:
+ *   ./test_frame_ring
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "frame_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+int main(void) {
+    char name[64];
+    snprintf(name, sizeof(name), "cira-frames-test-%d", (int)getpid());
+
+    const int w = 64, h = 48;
+    const size_t size = (size_t)w * h * 3;
+
+    frame_ring_t* writer = frame_ring_create(name, 3, size);
+    CHECK(writer != NULL);
+    CHECK(frame_ring_sequence(writer) == 0);
+
+    frame_ring_t* reader = frame_ring_open(name);
+    CHECK(reader != NULL);
+
+    uint8_t* pixels = (uint8_t*)malloc(size);
+    uint8_t* buf = (uint8_t*)malloc(size);
+    frame_ring_frame_t* frame = (frame_ring_frame_t*)malloc(sizeof(frame_ring_frame_t));
+    CHECK(pixels && buf && frame);
+
+    /* Nothing published yet */
+    CHECK(frame_ring_read_latest(reader, -1, frame, buf, size) == 0);
+
+    /* Wrap the ring: five frames from two cameras into three slots */
+    for (int i = 1; i <= 5; i++) {
+        memset(pixels, i, size);
+        frame_ring_detection_t det = { 0.1f * i, 0.2f, 0.3f, 0.4f, 0.9f, i };
+        uint64_t seq = frame_ring_publish(writer, i % 2, FRAME_RING_FORMAT_RGB24, w, h,
+                                          pixels, size, &det, 1);
+        CHECK(seq == (uint64_t)i);
+    }
+    CHECK(frame_ring_sequence(reader) == 5);
+
+    /* Newest of any camera is frame 5 (camera 1) */
+    CHECK(frame_ring_read_latest(reader, -1, frame, buf, size) == 1);
+    CHECK(frame->seq == 5);
+    CHECK(frame->camera == 1);
+    CHECK(frame->format == FRAME_RING_FORMAT_RGB24);
+    CHECK(frame->width == w && frame->height == h);
+    CHECK(frame->payload_size == size);
+    CHECK(frame->detection_count == 1);
+    CHECK(frame->detections[0].label_id == 5);
+    CHECK(buf[0] == 5 && buf[size - 1] == 5);
+
+    /* Newest of camera 0 is frame 4 */
+    CHECK(frame_ring_read_latest(reader, 0, frame, buf, size) == 1);
+    CHECK(frame->seq == 4);
+    CHECK(buf[size / 2] == 4);
+
+    /* No frames from camera 2; too small a buffer fails */
+    CHECK(frame_ring_read_latest(reader, 2, frame, buf, size) == 0);
+    CHECK(frame_ring_read_latest(reader, -1, frame, buf, size - 1) == 0);
+
+    /* Payloads larger than a slot are rejected */
+    uint8_t* big = (uint8_t*)calloc(1, size + 1);
+    CHECK(big != NULL);
+    CHECK(frame_ring_publish(writer, 0, FRAME_RING_FORMAT_JPEG, w, h, big, size + 1, NULL, 0) == 0);
+    free(big);
+
+    frame_ring_destroy(reader);
+    frame_ring_destroy(writer);
+
+    /* The writer unlinks the object */
+    CHECK(frame_ring_open(name) == NULL);
+
+    free(frame);
+    free(buf);
+    free(pixels);
+
+    printf("frame ring OK\n");
+    return 0;
+}
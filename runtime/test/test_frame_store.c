@@ -0,0 +1,279 @@
+/**
+ * CiRA Runtime - Frame Store Test
+ *
+ * Checks the latest-frame store's reference counting: a slot held by a
+ * reader is never claimed for writing, the writer drops frames once every
+ * slot is held, release and cancel make slots claimable again, and
+ * keep_ref holds a slot for the writer. Sequence numbers and slot reuse
+ * are followed across many wraparounds of the slot array, then one writer
+ * and several readers run concurrently and every acquired frame must be
+ * whole (all bytes from the same commit).
+ *
+ * Usage:
+ *   ./test_frame_store
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "frame_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define STRESS_FRAMES 100000
+#define STRESS_READERS 3
+#define STRESS_W 32
+#define STRESS_H 16
+
+/* Write a w x h frame with every byte set to `fill` and publish it */
+static uint64_t publish(frame_store_t* store, int w, int h, uint8_t fill, int keep_ref,
+                        frame_slot_t** slot) {
+    frame_slot_t* s = NULL;
+    uint8_t* data = frame_store_begin_write(store, w, h, &s);
+    if (!data) return 0;
+    memset(data, fill, (size_t)w * h * 3);
+    if (slot) *slot = s;
+    return frame_store_commit(store, s, keep_ref);
+}
+
+/* Number of slots the writer can claim right now (claims are cancelled) */
+static int free_slots(frame_store_t* store) {
+    frame_slot_t* claimed[FRAME_STORE_MAX_SLOTS];
+    int n = 0;
+    while (n < FRAME_STORE_MAX_SLOTS && frame_store_begin_write(store, 4, 4, &claimed[n])) {
+        n++;
+    }
+    for (int i = 0; i < n; i++) {
+        frame_store_cancel(store, claimed[i]);
+    }
+    return n;
+}
+
+/* Publish, acquire and frame data */
+static int test_basic(void) {
+    frame_store_t* store = frame_store_create(3);
+    CHECK(store != NULL);
+    CHECK(frame_store_acquire(store) == NULL);
+    CHECK(frame_store_sequence(store) == 0);
+
+    frame_slot_t* none = (frame_slot_t*)1;
+    CHECK(frame_store_begin_write(store, 0, 4, &none) == NULL);
+    CHECK(none == NULL);
+
+    CHECK(publish(store, 8, 4, 0x11, 0, NULL) == 1);
+    CHECK(frame_store_sequence(store) == 1);
+
+    frame_slot_t* r = frame_store_acquire(store);
+    CHECK(r != NULL);
+    int w, h;
+    uint64_t seq;
+    const uint8_t* data = frame_slot_data(r, &w, &h, &seq);
+    CHECK(data != NULL && w == 8 && h == 4 && seq == 1);
+    CHECK(data[0] == 0x11 && data[8 * 4 * 3 - 1] == 0x11);
+    frame_store_release(r);
+
+    frame_store_destroy(store);
+    return 0;
+}
+
+/* Reader references pin slots; the writer drops once all are held */
+static int test_refcount(void) {
+    frame_store_t* store = frame_store_create(3);
+    CHECK(store != NULL);
+
+    /* Slot A held by r1, slot B by r2, slot C by the store (latest) */
+    CHECK(publish(store, 8, 8, 1, 0, NULL) == 1);
+    frame_slot_t* r1 = frame_store_acquire(store);
+    CHECK(publish(store, 8, 8, 2, 0, NULL) == 2);
+    frame_slot_t* r2 = frame_store_acquire(store);
+    CHECK(publish(store, 8, 8, 3, 0, NULL) == 3);
+    CHECK(r1 && r2 && r1 != r2);
+
+    /* Every slot is held: the frame is dropped and nothing changes */
+    frame_slot_t* s = NULL;
+    CHECK(frame_store_begin_write(store, 8, 8, &s) == NULL);
+    CHECK(s == NULL);
+    CHECK(frame_store_dropped(store) == 1);
+    CHECK(frame_store_sequence(store) == 3);
+
+    /* Held frames are untouched by later commits */
+    uint64_t seq;
+    CHECK(frame_slot_data(r1, NULL, NULL, &seq)[0] == 1 && seq == 1);
+    CHECK(frame_slot_data(r2, NULL, NULL, &seq)[0] == 2 && seq == 2);
+
+    /* Releasing r1 frees exactly its slot for the next write */
+    frame_store_release(r1);
+    CHECK(free_slots(store) == 1);
+    frame_slot_t* reused = NULL;
+    CHECK(publish(store, 8, 8, 4, 0, &reused) == 4);
+    CHECK(reused == r1);
+
+    /* Seq 3 lost its last reference when seq 4 replaced it */
+    CHECK(free_slots(store) == 1);
+    frame_store_release(r2);
+    CHECK(free_slots(store) == 2);
+
+    frame_store_destroy(store);
+    return 0;
+}
+
+/* Cancel returns a claimed slot; keep_ref holds one for the writer */
+static int test_cancel_and_keep_ref(void) {
+    frame_store_t* store = frame_store_create(3);
+    CHECK(store != NULL);
+
+    frame_slot_t* s = NULL;
+    CHECK(frame_store_begin_write(store, 8, 8, &s) != NULL);
+    CHECK(free_slots(store) == 2);
+    frame_store_cancel(store, s);
+    CHECK(free_slots(store) == 3);
+    CHECK(frame_store_sequence(store) == 0);
+    CHECK(frame_store_acquire(store) == NULL);
+
+    /* The writer's reference outlives the store's once the frame is replaced */
+    frame_slot_t* kept = NULL;
+    CHECK(publish(store, 8, 8, 9, 1, &kept) == 1);
+    CHECK(publish(store, 8, 8, 10, 0, NULL) == 2);
+    CHECK(free_slots(store) == 1);
+    uint64_t seq;
+    CHECK(frame_slot_data(kept, NULL, NULL, &seq)[0] == 9 && seq == 1);
+    frame_store_release(kept);
+    CHECK(free_slots(store) == 2);
+
+    frame_store_destroy(store);
+    return 0;
+}
+
+/* Many times around the slot array: sequence, reuse and growing frames */
+static int test_wraparound(void) {
+    frame_store_t* store = frame_store_create(3);
+    CHECK(store != NULL);
+
+    frame_slot_t* held = NULL;
+    for (int i = 1; i <= 1000; i++) {
+        /* Frame size changes now and then, so buffers are regrown */
+        int w = 8 + (i / 100) * 8;
+        CHECK(publish(store, w, 8, (uint8_t)i, 0, NULL) == (uint64_t)i);
+
+        frame_slot_t* r = frame_store_acquire(store);
+        CHECK(r != NULL);
+        int rw;
+        uint64_t seq;
+        const uint8_t* data = frame_slot_data(r, &rw, NULL, &seq);
+        CHECK(seq == (uint64_t)i && rw == w);
+        CHECK(data[0] == (uint8_t)i && data[(size_t)w * 8 * 3 - 1] == (uint8_t)i);
+
+        /* Keep one reader reference across a commit every other frame */
+        if (held) frame_store_release(held);
+        held = (i % 2) ? r : NULL;
+        if (!held) frame_store_release(r);
+    }
+    if (held) frame_store_release(held);
+
+    CHECK(frame_store_dropped(store) == 0);
+    CHECK(free_slots(store) == 2);
+
+    frame_store_destroy(store);
+    return 0;
+}
+
+typedef struct {
+    frame_store_t* store;
+    atomic_int done;
+    atomic_int torn;
+    atomic_int backwards;
+    atomic_int acquired;
+} stress_t;
+
+static void* stress_writer(void* arg) {
+    stress_t* t = (stress_t*)arg;
+    for (int i = 0; i < STRESS_FRAMES; i++) {
+        frame_slot_t* s = NULL;
+        uint8_t* data = frame_store_begin_write(t->store, STRESS_W, STRESS_H, &s);
+        if (!data) continue;  /* Every slot held, counted as dropped */
+        for (volatile int spin = 0; spin < 200; spin++) {}
+        uint64_t next = frame_store_sequence(t->store) + 1;
+        memset(data, (int)(next & 0xff), STRESS_W * STRESS_H * 3);
+        frame_store_commit(t->store, s, 0);
+    }
+    atomic_store(&t->done, 1);
+    return NULL;
+}
+
+static void* stress_reader(void* arg) {
+    stress_t* t = (stress_t*)arg;
+    uint64_t last = 0;
+    int acquired = 0;
+    while (!atomic_load(&t->done)) {
+        frame_slot_t* r = frame_store_acquire(t->store);
+        if (!r) continue;
+        uint64_t seq;
+        const uint8_t* data = frame_slot_data(r, NULL, NULL, &seq);
+        for (int i = 0; i < STRESS_W * STRESS_H * 3; i++) {
+            if (data[i] != (uint8_t)(seq & 0xff)) {
+                atomic_fetch_add(&t->torn, 1);
+                break;
+            }
+        }
+        if (seq < last) atomic_fetch_add(&t->backwards, 1);
+        last = seq;
+        acquired++;
+        frame_store_release(r);
+    }
+    atomic_fetch_add(&t->acquired, acquired);
+    return NULL;
+}
+
+/* One writer, several readers: no torn frames, no leaked references */
+static int test_concurrent(void) {
+    stress_t t;
+    memset(&t, 0, sizeof(t));
+    t.store = frame_store_create(4);
+    CHECK(t.store != NULL);
+
+    pthread_t readers[STRESS_READERS];
+    pthread_t writer;
+    for (int i = 0; i < STRESS_READERS; i++) {
+        CHECK(pthread_create(&readers[i], NULL, stress_reader, &t) == 0);
+    }
+    CHECK(pthread_create(&writer, NULL, stress_writer, &t) == 0);
+    pthread_join(writer, NULL);
+    for (int i = 0; i < STRESS_READERS; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    CHECK(atomic_load(&t.torn) == 0);
+    CHECK(atomic_load(&t.backwards) == 0);
+    CHECK(frame_store_sequence(t.store) + frame_store_dropped(t.store) == STRESS_FRAMES);
+    /* Only the published frame still holds a reference */
+    CHECK(free_slots(t.store) == 3);
+
+    printf("  %llu published, %llu dropped, %d reads\n",
+           (unsigned long long)frame_store_sequence(t.store),
+           (unsigned long long)frame_store_dropped(t.store), atomic_load(&t.acquired));
+
+    frame_store_destroy(t.store);
+    return 0;
+}
+
+int main(void) {
+    if (test_basic() != 0) return 1;
+    if (test_refcount() != 0) return 1;
+    if (test_cancel_and_keep_ref() != 0) return 1;
+    if (test_wraparound() != 0) return 1;
+
+    printf("Concurrent readers:\n");
+    if (test_concurrent() != 0) return 1;
+
+    printf("test_frame_store: OK\n");
+    return 0;
+}
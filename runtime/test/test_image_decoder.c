@@ -0,0 +1,230 @@
+/**
+ * CiRA Runtime - Image Decoder Test
+ *
+ * Encodes JPEG and PNG images in memory and checks decoding: format
+ * detection, the reduced JPEG scale picked for a target size and the
+ * pixels it produces, PNG transparency, corrupt and missing input. Also
+ * checks the batch directory listing and JSON escaping, and prints full
+ * versus reduced decode times of a 12 MP JPEG.
+ *
+ * Usage:
+ *   ./test_image_decoder
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "image_decoder.h"
+#include "image_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <jpeglib.h>
+#include <png.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+/* Quadrants: red, green / blue, white */
+static void fill_quadrants(uint8_t* rgb, int w, int h) {
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            uint8_t* p = rgb + ((size_t)y * w + x) * 3;
+            int right = x >= w / 2, bottom = y >= h / 2;
+            p[0] = (!bottom && !right) || (bottom && right) ? 255 : 0;
+            p[1] = (!bottom && right) || (bottom && right) ? 255 : 0;
+            p[2] = bottom ? 255 : 0;
+        }
+    }
+}
+
+static unsigned char* encode_jpeg(const uint8_t* rgb, int w, int h, unsigned long* size) {
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    unsigned char* out = NULL;
+    *size = 0;
+
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, &out, size);
+    cinfo.image_width = (JDIMENSION)w;
+    cinfo.image_height = (JDIMENSION)h;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 95, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = (JSAMPROW)(rgb + (size_t)cinfo.next_scanline * w * 3);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return out;
+}
+
+/* Colour at (x, y) within tolerance of JPEG loss */
+static int near(const decoded_image_t* img, int x, int y, int r, int g, int b) {
+    const uint8_t* p = img->pixels + ((size_t)y * img->w + x) * 3;
+    return abs(p[0] - r) < 24 && abs(p[1] - g) < 24 && abs(p[2] - b) < 24;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int write_file(const char* path, const void* data, size_t size) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+    size_t n = fwrite(data, 1, size, f);
+    fclose(f);
+    return n == size;
+}
+
+int main(void) {
+    decoded_image_t img;
+    char err[256];
+
+    /* Scale choice: smallest of 1/8, 1/4, 1/2, 1 that still covers the target */
+    CHECK(image_scale_eighths(4000, 3000, 640, 640) == 2);
+    CHECK(image_scale_eighths(4000, 3000, 0, 0) == 8);
+    CHECK(image_scale_eighths(1280, 720, 640, 640) == 8);
+    CHECK(image_scale_eighths(1280, 720, 640, 360) == 4);
+    CHECK(image_scale_eighths(801, 601, 200, 150) == 2);
+
+    /* JPEG, odd size: full and reduced decodes */
+    int w = 801, h = 601;
+    uint8_t* rgb = (uint8_t*)malloc((size_t)w * h * 3);
+    CHECK(rgb != NULL);
+    fill_quadrants(rgb, w, h);
+    unsigned long jpeg_size;
+    unsigned char* jpeg = encode_jpeg(rgb, w, h, &jpeg_size);
+    CHECK(jpeg != NULL && jpeg_size > 0);
+    CHECK(image_format_detect(jpeg, jpeg_size) == IMAGE_FORMAT_JPEG);
+    CHECK(image_format_supported(IMAGE_FORMAT_JPEG) && image_format_supported(IMAGE_FORMAT_PNG));
+
+    CHECK(image_decode(jpeg, jpeg_size, 0, 0, &img, err, sizeof(err)) == CIRA_OK);
+    CHECK(img.w == w && img.h == h && img.src_w == w && img.src_h == h);
+    CHECK(near(&img, 100, 100, 255, 0, 0) && near(&img, 700, 100, 0, 255, 0));
+    CHECK(near(&img, 100, 500, 0, 0, 255) && near(&img, 700, 500, 255, 255, 255));
+    image_free(&img);
+    CHECK(img.pixels == NULL);
+
+    CHECK(image_decode(jpeg, jpeg_size, 200, 150, &img, err, sizeof(err)) == CIRA_OK);
+    CHECK(img.w == 201 && img.h == 151 && img.src_w == w && img.src_h == h);
+    CHECK(near(&img, 25, 25, 255, 0, 0) && near(&img, 175, 25, 0, 255, 0));
+    CHECK(near(&img, 25, 125, 0, 0, 255) && near(&img, 175, 125, 255, 255, 255));
+    image_free(&img);
+
+    /* Corrupt JPEG: a message, no pixels */
+    unsigned char bad[64];
+    memcpy(bad, jpeg, 3);
+    memset(bad + 3, 0x5A, sizeof(bad) - 3);
+    CHECK(image_decode(bad, sizeof(bad), 0, 0, &img, err, sizeof(err)) == CIRA_ERROR_INPUT);
+    CHECK(img.pixels == NULL && strncmp(err, "Invalid JPEG", 12) == 0);
+
+    /* Not an image */
+    CHECK(image_decode((const uint8_t*)"{\"path\":1}", 10, 0, 0, &img, err, sizeof(err)) == CIRA_ERROR_INPUT);
+    CHECK(image_format_detect(NULL, 0) == IMAGE_FORMAT_UNKNOWN);
+
+    /* PNG with transparency: transparent pixels come out black */
+    png_image pimg;
+    memset(&pimg, 0, sizeof(pimg));
+    pimg.version = PNG_IMAGE_VERSION;
+    pimg.width = 4;
+    pimg.height = 2;
+    pimg.format = PNG_FORMAT_RGBA;
+    uint8_t rgba[4 * 2 * 4];
+    for (int i = 0; i < 8; i++) {
+        rgba[i * 4 + 0] = 10;
+        rgba[i * 4 + 1] = 200;
+        rgba[i * 4 + 2] = 30;
+        rgba[i * 4 + 3] = i == 5 ? 0 : 255;
+    }
+    png_alloc_size_t png_size = 0;
+    CHECK(png_image_write_to_memory(&pimg, NULL, &png_size, 0, rgba, 0, NULL));
+    uint8_t* png = (uint8_t*)malloc(png_size);
+    CHECK(png && png_image_write_to_memory(&pimg, png, &png_size, 0, rgba, 0, NULL));
+    CHECK(image_format_detect(png, png_size) == IMAGE_FORMAT_PNG);
+    CHECK(image_decode(png, png_size, 640, 640, &img, err, sizeof(err)) == CIRA_OK);
+    CHECK(img.w == 4 && img.h == 2 && img.format == IMAGE_FORMAT_PNG);
+    CHECK(img.pixels[0] == 10 && img.pixels[1] == 200 && img.pixels[2] == 30);
+    CHECK(img.pixels[15] == 0 && img.pixels[16] == 0 && img.pixels[17] == 0);
+    image_free(&img);
+
+    /* Files and the batch directory listing */
+    char dir[] = "/tmp/cira_decode_XXXXXX";
+    CHECK(mkdtemp(dir) != NULL);
+    char path[512];
+    snprintf(path, sizeof(path), "%s/b.jpg", dir);
+    CHECK(write_file(path, jpeg, jpeg_size));
+    snprintf(path, sizeof(path), "%s/a.PNG", dir);
+    CHECK(write_file(path, png, png_size));
+    snprintf(path, sizeof(path), "%s/notes.txt", dir);
+    CHECK(write_file(path, "x", 1));
+
+    snprintf(path, sizeof(path), "%s/b.jpg", dir);
+    CHECK(image_decode_file(path, 400, 300, &img, err, sizeof(err)) == CIRA_OK);
+    CHECK(img.w == 401 && img.h == 301);
+    image_free(&img);
+    snprintf(path, sizeof(path), "%s/missing.jpg", dir);
+    CHECK(image_decode_file(path, 0, 0, &img, err, sizeof(err)) == CIRA_ERROR_FILE);
+
+    int count = 0;
+    char** paths = image_batch_list_dir(dir, 0, &count);
+    CHECK(paths != NULL && count == 2);
+    CHECK(strstr(paths[0], "/a.PNG") && strstr(paths[1], "/b.jpg"));
+    for (int i = 0; i < count; i++) free(paths[i]);
+    free(paths);
+    paths = image_batch_list_dir(dir, 1, &count);
+    CHECK(paths != NULL && count == 1);
+    free(paths[0]);
+    free(paths);
+
+    const char* names[] = { "a.PNG", "b.jpg", "notes.txt" };
+    for (int i = 0; i < 3; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+    CHECK(image_batch_list_dir(dir, 0, &count) == NULL && count == 0);
+
+    char escaped[64];
+    image_json_escape("a\"b\\c\n", escaped, sizeof(escaped));
+    CHECK(strcmp(escaped, "a\\\"b\\\\c\\u000a") == 0);
+
+    /* Decode time of a 12 MP photo, full size and for a 640x640 model */
+    free(jpeg);
+    free(rgb);
+    w = 4000;
+    h = 3000;
+    rgb = (uint8_t*)malloc((size_t)w * h * 3);
+    CHECK(rgb != NULL);
+    fill_quadrants(rgb, w, h);
+    jpeg = encode_jpeg(rgb, w, h, &jpeg_size);
+    CHECK(jpeg != NULL);
+
+    double t0 = now_ms();
+    CHECK(image_decode(jpeg, jpeg_size, 0, 0, &img, err, sizeof(err)) == CIRA_OK);
+    double full_ms = now_ms() - t0;
+    image_free(&img);
+    t0 = now_ms();
+    CHECK(image_decode(jpeg, jpeg_size, 640, 640, &img, err, sizeof(err)) == CIRA_OK);
+    double reduced_ms = now_ms() - t0;
+    CHECK(img.w == 1000 && img.h == 750);
+    image_free(&img);
+
+    free(jpeg);
+    free(rgb);
+    free(png);
+    printf("test_image_decoder: OK (12 MP JPEG: %.1f ms full, %.1f ms at 1/4 for 640x640)\n",
+           full_ms, reduced_ms);
+    return 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * CiRA Runtime - JPEG Cache Test
+ *
+ * Checks the encode-once cache: a variant is keyed by frame sequence,
+ * annotated and quality, so repeating a request is a hit and changing any
+ * key part encodes again. Concurrent requests for one new variant encode
+ * it once and share the buffer. A buffer a caller still holds stays valid
+ * after the cache evicts it, and can be released through its data pointer.
+ * Needs a JPEG encoder backend (streaming builds with OpenCV or
+ * libjpeg-turbo).
+ *
+ * Usage:
+ *   ./test_jpeg_cache
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cira.h"
+#include "jpeg_cache.h"
+#include "frame_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define FRAME_W 64
+#define FRAME_H 48
+#define GETTERS 8
+
+/* Publish a gradient frame and take a reference to it */
+static frame_slot_t* publish_frame(frame_store_t* store, int shade) {
+    frame_slot_t* s = NULL;
+    uint8_t* data = frame_store_begin_write(store, FRAME_W, FRAME_H, &s);
+    if (!data) return NULL;
+    for (int i = 0; i < FRAME_W * FRAME_H * 3; i++) {
+        data[i] = (uint8_t)(i + shade);
+    }
+    frame_store_commit(store, s, 0);
+    return frame_store_acquire(store);
+}
+
+/* Buffer holds a JPEG (SOI marker) encoded from `seq` */
+static int is_jpeg_of(const jpeg_buf_t* buf, uint64_t seq) {
+    size_t size;
+    const uint8_t* data = jpeg_buf_data(buf, &size);
+    return data && size > 2 && data[0] == 0xFF && data[1] == 0xD8 &&
+           jpeg_buf_sequence(buf) == seq;
+}
+
+static uint64_t encodes_of(jpeg_cache_t* cache) {
+    uint64_t encodes;
+    jpeg_cache_stats(cache, NULL, &encodes);
+    return encodes;
+}
+
+/* Hits and encodes per key part */
+static int test_keying(jpeg_cache_t* cache, cira_ctx* ctx, frame_store_t* store) {
+    frame_slot_t* slot = publish_frame(store, 0);
+    CHECK(slot != NULL);
+    uint64_t seq;
+    frame_slot_data(slot, NULL, NULL, &seq);
+
+    jpeg_buf_t* raw = jpeg_cache_get(cache, ctx, NULL, slot, 0, 80);
+    CHECK(raw != NULL && is_jpeg_of(raw, seq));
+    uint64_t hits, encodes;
+    jpeg_cache_stats(cache, &hits, &encodes);
+    CHECK(hits == 0 && encodes == 1);
+
+    /* Same variant: the same buffer, no new encode */
+    jpeg_buf_t* again = jpeg_cache_get(cache, ctx, NULL, slot, 0, 80);
+    CHECK(again == raw);
+    jpeg_cache_stats(cache, &hits, &encodes);
+    CHECK(hits == 1 && encodes == 1);
+
+    /* Annotated and another quality are separate variants */
+    jpeg_buf_t* annotated = jpeg_cache_get(cache, ctx, NULL, slot, 1, 80);
+    jpeg_buf_t* low = jpeg_cache_get(cache, ctx, NULL, slot, 0, 30);
+    CHECK(annotated && low);
+    CHECK(annotated != raw && low != raw && low != annotated);
+    CHECK(is_jpeg_of(annotated, seq) && is_jpeg_of(low, seq));
+    CHECK(encodes_of(cache) == 3);
+
+    /* A new frame is a new key even at the same settings */
+    frame_slot_t* next = publish_frame(store, 1);
+    CHECK(next != NULL);
+    jpeg_buf_t* newer = jpeg_cache_get(cache, ctx, NULL, next, 0, 80);
+    CHECK(newer && newer != raw && is_jpeg_of(newer, seq + 1));
+    CHECK(encodes_of(cache) == 4);
+
+    /* No frame, no buffer */
+    CHECK(jpeg_cache_get(cache, ctx, NULL, NULL, 0, 80) == NULL);
+
+    jpeg_buf_release(raw);
+    jpeg_buf_release(again);
+    jpeg_buf_release(annotated);
+    jpeg_buf_release(low);
+    jpeg_buf_release(newer);
+    frame_store_release(slot);
+    frame_store_release(next);
+    return 0;
+}
+
+typedef struct {
+    jpeg_cache_t* cache;
+    cira_ctx* ctx;
+    frame_slot_t* slot;
+    atomic_int ready;
+    atomic_int go;
+    jpeg_buf_t* bufs[GETTERS];
+} getters_t;
+
+typedef struct {
+    getters_t* g;
+    int index;
+} getter_arg_t;
+
+static void* getter_thread(void* arg) {
+    getter_arg_t* a = (getter_arg_t*)arg;
+    getters_t* g = a->g;
+    atomic_fetch_add(&g->ready, 1);
+    while (!atomic_load(&g->go)) {}
+    g->bufs[a->index] = jpeg_cache_get(g->cache, g->ctx, NULL, g->slot, 0, 90);
+    return NULL;
+}
+
+/* Concurrent requests for a new variant share one encode */
+static int test_concurrent(jpeg_cache_t* cache, cira_ctx* ctx, frame_store_t* store) {
+    getters_t g;
+    memset(&g, 0, sizeof(g));
+    g.cache = cache;
+    g.ctx = ctx;
+    g.slot = publish_frame(store, 2);
+    CHECK(g.slot != NULL);
+
+    uint64_t before = encodes_of(cache);
+    pthread_t threads[GETTERS];
+    getter_arg_t args[GETTERS];
+    for (int i = 0; i < GETTERS; i++) {
+        args[i].g = &g;
+        args[i].index = i;
+        CHECK(pthread_create(&threads[i], NULL, getter_thread, &args[i]) == 0);
+    }
+    while (atomic_load(&g.ready) < GETTERS) {}
+    atomic_store(&g.go, 1);
+    for (int i = 0; i < GETTERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    CHECK(encodes_of(cache) == before + 1);
+    for (int i = 0; i < GETTERS; i++) {
+        CHECK(g.bufs[i] == g.bufs[0]);
+    }
+    CHECK(g.bufs[0] != NULL);
+
+    for (int i = 0; i < GETTERS; i++) {
+        jpeg_buf_release(g.bufs[i]);
+    }
+    frame_store_release(g.slot);
+    return 0;
+}
+
+/* A held buffer outlives its eviction; the variant is encoded again */
+static int test_eviction(jpeg_cache_t* cache, cira_ctx* ctx, frame_store_t* store) {
+    frame_slot_t* first = publish_frame(store, 3);
+    CHECK(first != NULL);
+    uint64_t first_seq;
+    frame_slot_data(first, NULL, NULL, &first_seq);
+
+    jpeg_buf_t* held = jpeg_cache_get(cache, ctx, NULL, first, 0, 80);
+    CHECK(held != NULL);
+    size_t held_size;
+    const uint8_t* held_data = jpeg_buf_data(held, &held_size);
+    uint8_t* copy = (uint8_t*)malloc(held_size);
+    CHECK(copy != NULL);
+    memcpy(copy, held_data, held_size);
+
+    /* Newer frames push every entry of the first one out */
+    for (int i = 0; i < JPEG_CACHE_ENTRIES; i++) {
+        frame_slot_t* s = publish_frame(store, 4 + i);
+        CHECK(s != NULL);
+        jpeg_buf_t* b = jpeg_cache_get(cache, ctx, NULL, s, 0, 80);
+        CHECK(b != NULL);
+        jpeg_buf_release(b);
+        frame_store_release(s);
+    }
+
+    /* Still intact for its holder */
+    CHECK(is_jpeg_of(held, first_seq));
+    CHECK(memcmp(jpeg_buf_data(held, NULL), copy, held_size) == 0);
+
+    /* Asking again encodes anew rather than returning the evicted buffer */
+    uint64_t before = encodes_of(cache);
+    jpeg_buf_t* again = jpeg_cache_get(cache, ctx, NULL, first, 0, 80);
+    CHECK(again != NULL && again != held && is_jpeg_of(again, first_seq));
+    CHECK(encodes_of(cache) == before + 1);
+
+    /* Release through the data pointer, as the HTTP server does */
+    jpeg_buf_release_data((void*)held_data);
+    jpeg_buf_release(again);
+    free(copy);
+    frame_store_release(first);
+    return 0;
+}
+
+int main(void) {
+    cira_ctx* ctx = cira_create();
+    frame_store_t* store = frame_store_create(4);
+    jpeg_cache_t* cache = jpeg_cache_create();
+    CHECK(ctx && store && cache);
+
+    if (test_keying(cache, ctx, store) != 0) return 1;
+    if (test_concurrent(cache, ctx, store) != 0) return 1;
+    if (test_eviction(cache, ctx, store) != 0) return 1;
+
+    uint64_t hits, encodes;
+    jpeg_cache_stats(cache, &hits, &encodes);
+    printf("  %llu hits, %llu encodes\n", (unsigned long long)hits, (unsigned long long)encodes);
+
+    jpeg_cache_destroy(cache);
+    frame_store_destroy(store);
+    cira_destroy(ctx);
+
+    printf("test_jpeg_cache: OK\n");
+    return 0;
+}
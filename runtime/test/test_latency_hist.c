@@ -0,0 +1,105 @@
+/**
+ * CiRA Runtime - Latency Histogram Test
+ *
+ * Checks quantiles of known distributions against the histogram's error
+ * bound, and that values recorded from several threads at once are all
+ * counted.
+ *
+ * Usage:
+ *   ./test_latency_hist
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "latency_hist.h"
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+/* Within the bucket resolution (1/32 either side) plus rounding to 1 us */
+static int close_to(double got, double want) {
+    return fabs(got - want) <= want * 0.035 + 0.001;
+}
+
+#define THREADS 4
+#define PER_THREAD 100000
+
+static void* record_thread(void* arg) {
+    latency_hist_t* h = (latency_hist_t*)arg;
+    for (int i = 0; i < PER_THREAD; i++) {
+        latency_hist_record(h, 2.0);
+    }
+    return NULL;
+}
+
+int main(void) {
+    latency_summary_t sum;
+
+    /* Empty */
+    latency_hist_t* h = latency_hist_create();
+    CHECK(h != NULL);
+    latency_hist_summary(h, &sum);
+    CHECK(sum.count == 0 && sum.p99_ms == 0.0);
+
+    /* Uniform 1..1000 ms */
+    for (int i = 1; i <= 1000; i++) {
+        latency_hist_record(h, (double)i);
+    }
+    latency_hist_summary(h, &sum);
+    CHECK(sum.count == 1000);
+    CHECK(fabs(sum.sum_ms - 500500.0) < 1.0);
+    CHECK(sum.max_ms == 1000.0);
+    CHECK(close_to(sum.p50_ms, 500.0));
+    CHECK(close_to(sum.p90_ms, 900.0));
+    CHECK(close_to(sum.p99_ms, 990.0));
+    CHECK(close_to(latency_hist_quantile(h, 0.25), 250.0));
+    latency_hist_destroy(h);
+
+    /* Microseconds are exact, and nothing reads above the max */
+    h = latency_hist_create();
+    latency_hist_record(h, 0.004);
+    latency_hist_record(h, 0.004);
+    latency_hist_record(h, 0.020);
+    latency_hist_record(h, -1.0);
+    CHECK(latency_hist_quantile(h, 0.5) == 0.004);
+    CHECK(latency_hist_quantile(h, 1.0) == 0.020);
+    CHECK(latency_hist_quantile(h, 0.0) == 0.0);
+    latency_hist_destroy(h);
+
+    /* Out of range values land in the last bucket */
+    h = latency_hist_create();
+    latency_hist_record(h, 1e9);
+    latency_hist_summary(h, &sum);
+    CHECK(sum.count == 1 && sum.p50_ms > 3.6e6);
+    latency_hist_destroy(h);
+
+    /* Concurrent writers */
+    h = latency_hist_create();
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        CHECK(pthread_create(&threads[i], NULL, record_thread, h) == 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    latency_hist_summary(h, &sum);
+    CHECK(sum.count == (uint64_t)THREADS * PER_THREAD);
+    CHECK(fabs(sum.sum_ms - 2.0 * THREADS * PER_THREAD) < 1.0);
+    CHECK(close_to(sum.p50_ms, 2.0));
+    latency_hist_destroy(h);
+
+    /* NULL records and summarizes nothing */
+    latency_hist_record(NULL, 1.0);
+    latency_hist_summary(NULL, &sum);
+    CHECK(sum.count == 0);
+
+    printf("test_latency_hist: OK\n");
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * CiRA Runtime - Model File Test
+ *
+ * Maps a file and checks its bytes, that the content hash follows the
+ * contents, and that cache paths are created under the configured or
+ * default directory, keyed by model hash and hardware tag.
+ *
+ * Usage:
+ *   ./test_model_file
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "model_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static int write_file(const char* path, const void* data, size_t size) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return -1;
+    size_t n = fwrite(data, 1, size, f);
+    fclose(f);
+    return n == size ? 0 : -1;
+}
+
+static int is_dir(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+int main(void) {
+    char dir[256];
+    char path[300];
+    snprintf(dir, sizeof(dir), "/tmp/cira-model-file-test-%d", (int)getpid());
+    CHECK(mkdir(dir, 0755) == 0);
+    snprintf(path, sizeof(path), "%s/model.bin", dir);
+
+    uint8_t data[1003];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7);
+    }
+    CHECK(write_file(path, data, sizeof(data)) == 0);
+
+    /* Mapping */
+    model_file_t file;
+    CHECK(model_file_map(path, &file) == 0);
+    CHECK(file.size == sizeof(data));
+    CHECK(memcmp(file.data, data, sizeof(data)) == 0);
+    uint64_t hash = model_file_hash(&file);
+    CHECK(hash == model_file_hash(&file));
+    model_file_unmap(&file);
+    CHECK(file.data == NULL);
+    model_file_unmap(&file);
+
+    /* A change anywhere, including the unaligned tail, changes the hash */
+    data[1001] ^= 1;
+    CHECK(write_file(path, data, sizeof(data)) == 0);
+    CHECK(model_file_map(path, &file) == 0);
+    CHECK(model_file_hash(&file) != hash);
+    model_file_unmap(&file);
+
+    /* Missing and empty files do not map */
+    char missing[320];
+    snprintf(missing, sizeof(missing), "%s/missing.bin", dir);
+    CHECK(model_file_map(missing, &file) != 0);
+    CHECK(write_file(path, data, 0) == 0);
+    CHECK(model_file_map(path, &file) != 0);
+    remove(path);
+
+    /* Cache paths: nested directory created, keyed by hash and hardware */
+    char cache_dir[300];
+    char a[512], b[512], c[512];
+    snprintf(cache_dir, sizeof(cache_dir), "%s/cache/nested", dir);
+    CHECK(model_cache_path(cache_dir, 0x1234, "onnx:1.17:x86_64", ".ort", a, sizeof(a)) == 1);
+    CHECK(is_dir(cache_dir));
+    CHECK(strncmp(a, cache_dir, strlen(cache_dir)) == 0);
+    CHECK(strstr(a, "0000000000001234-") != NULL);
+    CHECK(strcmp(a + strlen(a) - 4, ".ort") == 0);
+    CHECK(model_cache_path(cache_dir, 0x1234, "onnx:1.18:x86_64", ".ort", b, sizeof(b)) == 1);
+    CHECK(strcmp(a, b) != 0);
+    CHECK(model_cache_path(cache_dir, 0x1234, "onnx:1.17:x86_64", ".ort", c, sizeof(c)) == 1);
+    CHECK(strcmp(a, c) == 0);
+
+    /* Default directory and "off" */
+    char xdg[300];
+    snprintf(xdg, sizeof(xdg), "%s/xdg", dir);
+    CHECK(setenv("XDG_CACHE_HOME", xdg, 1) == 0);
+    CHECK(model_cache_path("", 1, "tag", ".ort", a, sizeof(a)) == 1);
+    CHECK(strncmp(a, xdg, strlen(xdg)) == 0 && strstr(a, "/cira/") != NULL);
+    CHECK(model_cache_path("off", 1, "tag", ".ort", a, sizeof(a)) == 0);
+
+    /* Clean up */
+    char cmd[400];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dir);
+    CHECK(system(cmd) == 0);
+
+    printf("test_model_file: OK\n");
+    return 0;
+}
@@ -98,10 +98,36 @@ int main(int argc, char* argv[]) {
 
     printf("\nJSON Result:\n%s\n", cira_result_json(ctx));
 
+    /* Run batch inference (same image, results should match) */
+    const uint8_t* batch[4] = { image, image, image, image };
+    printf("\nRunning batch inference (4 images)...\n");
+    result = cira_predict_batch(ctx, batch, 4, w, h, 3);
+    if (result != CIRA_OK) {
+        fprintf(stderr, "Batch inference failed: %d\n", result);
+        const char* err = cira_error(ctx);
+        if (err) fprintf(stderr, "Error: %s\n", err);
+        free(image);
+        cira_destroy(ctx);
+        return 1;
+    }
+
+    int mismatches = cira_batch_count(ctx) == 4 ? 0 : 1;
+    for (int i = 0; i < cira_batch_count(ctx); i++) {
+        int batch_count = cira_batch_result_count(ctx, i);
+        printf("  Image %d: %d detections%s\n", i, batch_count,
+               batch_count == count ? "" : " (MISMATCH)");
+        if (batch_count != count) mismatches++;
+    }
+
     /* Cleanup */
     free(image);
     cira_destroy(ctx);
 
+    if (mismatches) {
+        fprintf(stderr, "FAIL: batch results differ from single-image inference\n");
+        return 1;
+    }
+
     printf("\nTest completed!\n");
     return 0;
 }
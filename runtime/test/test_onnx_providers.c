@@ -0,0 +1,83 @@
+/**
+ * CiRA Runtime - ONNX Execution Provider Spec Test
+ *
+ * Parses provider specs (defaults, per-provider options, the implicit
+ * cpu fallback), rejects malformed ones and formats lists back.
+ *
+ * Usage:
+ *   ./test_onnx_providers
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "onnx_providers.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+int main(void) {
+    onnx_provider_list_t list;
+    char err[256];
+    char text[512];
+
+    /* Empty: cpu alone, extended optimization, arena on */
+    CHECK(onnx_providers_parse("", &list, err, sizeof(err)) == 0);
+    CHECK(list.count == 1 && list.providers[0].ep == ONNX_EP_CPU);
+    CHECK(list.providers[0].opt_level == ONNX_OPT_EXTENDED && list.providers[0].arena == 1);
+    CHECK(onnx_providers_parse(NULL, &list, NULL, 0) == 0 && list.count == 1);
+
+    /* Priority order, options, cpu appended */
+    CHECK(onnx_providers_parse(" tensorrt(trt_fp16_enable=1, trt_max_workspace_size = 1073741824) ;"
+                               "cuda(device_id=0,opt=all)", &list, err, sizeof(err)) == 0);
+    CHECK(list.count == 3);
+    CHECK(list.providers[0].ep == ONNX_EP_TENSORRT && list.providers[0].num_options == 2);
+    CHECK(strcmp(onnx_provider_option(&list.providers[0], "trt_fp16_enable"), "1") == 0);
+    CHECK(strcmp(onnx_provider_option(&list.providers[0], "trt_max_workspace_size"),
+                 "1073741824") == 0);
+    CHECK(onnx_provider_option(&list.providers[0], "device_id") == NULL);
+    CHECK(list.providers[1].ep == ONNX_EP_CUDA && list.providers[1].num_options == 1);
+    CHECK(list.providers[1].opt_level == ONNX_OPT_ALL);
+    CHECK(list.providers[2].ep == ONNX_EP_CPU);
+
+    onnx_providers_format(&list, text, sizeof(text));
+    CHECK(strcmp(text, "tensorrt(trt_fp16_enable=1,trt_max_workspace_size=1073741824);"
+                       "cuda(opt=all,device_id=0);cpu") == 0);
+
+    /* OpenVINO optimizes and allocates itself; runtime options override */
+    CHECK(onnx_providers_parse("openvino(device_type=GPU);xnnpack;cpu(arena=0,opt=basic)",
+                               &list, err, sizeof(err)) == 0);
+    CHECK(list.count == 3);
+    CHECK(list.providers[0].opt_level == ONNX_OPT_DISABLE && list.providers[0].arena == 0);
+    CHECK(list.providers[1].ep == ONNX_EP_XNNPACK && list.providers[1].arena == 1);
+    CHECK(list.providers[2].arena == 0 && list.providers[2].opt_level == ONNX_OPT_BASIC);
+    onnx_providers_format(&list, text, sizeof(text));
+    CHECK(strcmp(text, "openvino(device_type=GPU);xnnpack;cpu(opt=basic,arena=0)") == 0);
+
+    /* Rejected */
+    CHECK(onnx_providers_parse("directml", &list, err, sizeof(err)) == -1);
+    CHECK(strstr(err, "directml") != NULL);
+    CHECK(list.count == 0);
+    CHECK(onnx_providers_parse("cuda;cuda", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cpu;cuda", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cuda(device_id)", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cuda(device_id=0", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cuda(device_id=0) x", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cuda(device_id=0,device_id=1)", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cuda(opt=fast)", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cuda(arena=yes)", &list, err, sizeof(err)) == -1);
+    CHECK(onnx_providers_parse("cuda(a=1,b=1,c=1,d=1,e=1,f=1,g=1,h=1,i=1)",
+                               &list, err, sizeof(err)) == -1);
+
+    /* Names */
+    CHECK(strcmp(onnx_provider_name(ONNX_EP_TENSORRT), "tensorrt") == 0);
+    CHECK(strcmp(onnx_opt_level_name(ONNX_OPT_EXTENDED), "extended") == 0);
+
+    printf("test_onnx_providers: OK\n");
+    return 0;
+}
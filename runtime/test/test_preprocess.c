@@ -0,0 +1,253 @@
+/**
+ * CiRA Runtime - Preprocessing Correctness Test
+ *
+ * Checks preprocess_run() against a double precision reference letterbox
+ * and bilinear resize (half-pixel centers, edge clamp). Every image pixel
+ * must be within 1 LSB (of 255) of the reference and every pad element
+ * exactly 114/255, for the scalar kernels and for the vector unit the CPU
+ * has (AVX2 or NEON). Covers odd source sizes, up- and downscaling,
+ * stretch, no-resize rows, NCHW and NHWC, RGB and BGR, fp16 output, and
+ * one plan reused across source size changes (geometry rebuild).
+ *
+ * Usage:
+ *   ./test_preprocess
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "cira.h"
+#include "preprocess.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+typedef struct {
+    int src_w, src_h;
+    int dst_w, dst_h;
+    int layout;
+    int fp16;
+    int letterbox;
+    int order;
+} pp_case_t;
+
+static uint8_t* random_image(int w, int h) {
+    uint8_t* img = (uint8_t*)malloc((size_t)w * h * 3);
+    if (!img) return NULL;
+    for (size_t i = 0; i < (size_t)w * h * 3; i++) img[i] = (uint8_t)(rand() & 0xff);
+    return img;
+}
+
+/* Letterbox geometry: fit inside the destination, centered */
+static void ref_geom(const pp_case_t* c, int* new_w, int* new_h, int* pad_x, int* pad_y) {
+    *new_w = c->dst_w;
+    *new_h = c->dst_h;
+    if (c->letterbox) {
+        float sx = (float)c->dst_w / c->src_w;
+        float sy = (float)c->dst_h / c->src_h;
+        float scale = sx < sy ? sx : sy;
+        *new_w = (int)lroundf(c->src_w * scale);
+        *new_h = (int)lroundf(c->src_h * scale);
+        if (*new_w < 1) *new_w = 1;
+        if (*new_h < 1) *new_h = 1;
+        if (*new_w > c->dst_w) *new_w = c->dst_w;
+        if (*new_h > c->dst_h) *new_h = c->dst_h;
+    }
+    *pad_x = (c->dst_w - *new_w) / 2;
+    *pad_y = (c->dst_h - *new_h) / 2;
+}
+
+/* Source coordinate of a resized pixel center, clamped to the image */
+static double ref_coord(int i, int src, int dst, int* lo, int* hi) {
+    double f = (i + 0.5) * src / dst - 0.5;
+    if (f < 0.0) f = 0.0;
+    if (f > src - 1) f = src - 1;
+    *lo = (int)f;
+    *hi = *lo + 1 < src ? *lo + 1 : src - 1;
+    return f - *lo;
+}
+
+/* Bilinear sample of channel ch, 0-255 */
+static double ref_sample(const uint8_t* img, int w, int h, int new_w, int new_h,
+                         int ix, int iy, int ch) {
+    int x0, x1, y0, y1;
+    double wx = ref_coord(ix, w, new_w, &x0, &x1);
+    double wy = ref_coord(iy, h, new_h, &y0, &y1);
+    const uint8_t* r0 = img + (size_t)y0 * w * 3;
+    const uint8_t* r1 = img + (size_t)y1 * w * 3;
+    double top = r0[x0 * 3 + ch] + (r0[x1 * 3 + ch] - r0[x0 * 3 + ch]) * wx;
+    double bot = r1[x0 * 3 + ch] + (r1[x1 * 3 + ch] - r1[x0 * 3 + ch]) * wx;
+    return top + (bot - top) * wy;
+}
+
+static float out_value(const void* dst, int fp16, size_t i) {
+    if (fp16) {
+        float v;
+        preprocess_half_to_float((const uint16_t*)dst + i, &v, 1);
+        return v;
+    }
+    return ((const float*)dst)[i];
+}
+
+/* Compare one run against the reference; worst image error in LSB */
+static int check_output(const pp_case_t* c, const preprocess_plan_t* plan, const uint8_t* img,
+                        const void* dst, double* worst) {
+    int new_w, new_h, pad_x, pad_y;
+    ref_geom(c, &new_w, &new_h, &pad_x, &pad_y);
+    CHECK(plan->geom.new_w == new_w && plan->geom.new_h == new_h);
+    CHECK(plan->geom.pad_x == pad_x && plan->geom.pad_y == pad_y);
+
+    float pad = PREPROCESS_PAD_VALUE;
+    if (c->fp16) {
+        uint16_t h = preprocess_float_to_half(PREPROCESS_PAD_VALUE);
+        preprocess_half_to_float(&h, &pad, 1);
+    }
+
+    size_t plane = (size_t)c->dst_w * c->dst_h;
+    for (int y = 0; y < c->dst_h; y++) {
+        for (int x = 0; x < c->dst_w; x++) {
+            int ix = x - pad_x;
+            int iy = y - pad_y;
+            int inside = ix >= 0 && ix < new_w && iy >= 0 && iy < new_h;
+            for (int ch = 0; ch < 3; ch++) {
+                size_t i = c->layout == PREPROCESS_NCHW ? ch * plane + (size_t)y * c->dst_w + x
+                                                        : ((size_t)y * c->dst_w + x) * 3 + ch;
+                float v = out_value(dst, c->fp16, i);
+                if (!inside) {
+                    if (v != pad) fprintf(stderr, "  pad (%d,%d,%d) = %f\n", x, y, ch, v);
+                    CHECK(v == pad);
+                    continue;
+                }
+                int src_ch = c->order == PREPROCESS_BGR ? 2 - ch : ch;
+                double ref = ref_sample(img, c->src_w, c->src_h, new_w, new_h, ix, iy, src_ch);
+                double diff = fabs(v * 255.0 - ref);
+                if (diff > *worst) *worst = diff;
+                if (diff > 1.0) {
+                    fprintf(stderr, "  (%d,%d,%d): got %f, reference %f\n", x, y, ch,
+                            v * 255.0, ref);
+                }
+                CHECK(diff <= 1.0);
+            }
+        }
+    }
+    return 0;
+}
+
+/* Destination poisoned first so unwritten elements show up */
+static void* alloc_dst(const pp_case_t* c) {
+    size_t n = (size_t)c->dst_w * c->dst_h * 3;
+    size_t bytes = n * (c->fp16 ? sizeof(uint16_t) : sizeof(float));
+    void* dst = malloc(bytes);
+    if (dst) memset(dst, 0xFF, bytes);  /* NaN in both formats */
+    return dst;
+}
+
+/* One case, scalar and then the vector unit if the CPU has one */
+static int run_case(const pp_case_t* c) {
+    uint8_t* img = random_image(c->src_w, c->src_h);
+    CHECK(img != NULL);
+
+    preprocess_plan_t plan;
+    CHECK(preprocess_init(&plan, c->dst_w, c->dst_h, c->layout, c->fp16, c->letterbox) == CIRA_OK);
+    int simd = plan.use_simd;
+    plan.order = c->order;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1 && !simd) break;
+        plan.use_simd = pass;
+        void* dst = alloc_dst(c);
+        CHECK(dst != NULL);
+        CHECK(preprocess_run(&plan, img, c->src_w, c->src_h, dst) == CIRA_OK);
+        double worst = 0.0;
+        if (check_output(c, &plan, img, dst, &worst) != 0) return 1;
+        printf("  %4dx%-4d -> %3dx%-3d %s %s%s%s %-6s: max diff %.3f\n",
+               c->src_w, c->src_h, c->dst_w, c->dst_h,
+               c->layout == PREPROCESS_NCHW ? "NCHW" : "NHWC",
+               c->letterbox ? "letterbox" : "stretch",
+               c->order == PREPROCESS_BGR ? " bgr" : "", c->fp16 ? " fp16" : "",
+               pass ? preprocess_simd_name() : "scalar", worst);
+        free(dst);
+    }
+
+    preprocess_free(&plan);
+    free(img);
+    return 0;
+}
+
+/* One plan across source size changes: tables rebuilt each time */
+static int test_size_changes(int layout, int fp16) {
+    static const int sizes[][2] = {
+        { 640, 480 }, { 333, 517 }, { 640, 480 }, { 97, 1001 }, { 1001, 97 }, { 320, 320 },
+    };
+    preprocess_plan_t plan;
+    CHECK(preprocess_init(&plan, 320, 320, layout, fp16, 1) == CIRA_OK);
+    int simd = plan.use_simd;
+
+    double worst = 0.0;
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+        pp_case_t c = { sizes[i][0], sizes[i][1], 320, 320, layout, fp16, 1, PREPROCESS_RGB };
+        uint8_t* img = random_image(c.src_w, c.src_h);
+        void* dst = alloc_dst(&c);
+        CHECK(img && dst);
+
+        /* Alternate kernels so each sees a rebuilt plan */
+        plan.use_simd = simd && (i % 2);
+        CHECK(preprocess_run(&plan, img, c.src_w, c.src_h, dst) == CIRA_OK);
+        CHECK(plan.src_w == c.src_w && plan.src_h == c.src_h);
+        if (check_output(&c, &plan, img, dst, &worst) != 0) return 1;
+
+        free(dst);
+        free(img);
+    }
+    printf("  size changes %s%s: max diff %.3f\n",
+           layout == PREPROCESS_NCHW ? "NCHW" : "NHWC", fp16 ? " fp16" : "", worst);
+
+    preprocess_free(&plan);
+    return 0;
+}
+
+int main(void) {
+    srand(77);
+
+    static const pp_case_t cases[] = {
+        /* Downscale, pad top and bottom */
+        { 640, 480, 320, 320, PREPROCESS_NCHW, 0, 1, PREPROCESS_RGB },
+        { 640, 480, 320, 320, PREPROCESS_NHWC, 0, 1, PREPROCESS_BGR },
+        /* Odd sizes, pad left and right */
+        { 333, 517, 320, 320, PREPROCESS_NHWC, 0, 1, PREPROCESS_RGB },
+        { 333, 517, 320, 320, PREPROCESS_NCHW, 1, 1, PREPROCESS_BGR },
+        { 1921, 1079, 640, 384, PREPROCESS_NCHW, 0, 1, PREPROCESS_RGB },
+        /* Upscale */
+        { 101, 37, 416, 416, PREPROCESS_NCHW, 1, 1, PREPROCESS_RGB },
+        { 7, 5, 64, 48, PREPROCESS_NHWC, 0, 0, PREPROCESS_RGB },
+        { 1, 1, 33, 17, PREPROCESS_NHWC, 0, 1, PREPROCESS_RGB },
+        /* Source width already the destination: rows converted, not resampled */
+        { 320, 240, 320, 320, PREPROCESS_NHWC, 0, 1, PREPROCESS_RGB },
+        { 320, 240, 320, 320, PREPROCESS_NHWC, 0, 1, PREPROCESS_BGR },
+        { 320, 240, 320, 320, PREPROCESS_NCHW, 0, 1, PREPROCESS_BGR },
+        { 320, 240, 320, 320, PREPROCESS_NCHW, 1, 1, PREPROCESS_RGB },
+        /* Stretch */
+        { 333, 517, 224, 224, PREPROCESS_NCHW, 0, 0, PREPROCESS_RGB },
+        { 333, 517, 224, 224, PREPROCESS_NHWC, 1, 0, PREPROCESS_BGR },
+    };
+
+    printf("Reference letterbox/bilinear (vector unit: %s):\n", preprocess_simd_name());
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+        if (run_case(&cases[i]) != 0) return 1;
+    }
+
+    printf("Geometry rebuild:\n");
+    if (test_size_changes(PREPROCESS_NCHW, 0) != 0) return 1;
+    if (test_size_changes(PREPROCESS_NHWC, 0) != 0) return 1;
+    if (test_size_changes(PREPROCESS_NCHW, 1) != 0) return 1;
+
+    printf("test_preprocess: OK\n");
+    return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * CiRA Runtime - Result History Test
+ *
+ * Fills a result history past its limits (result slots, detection slots,
+ * age) and checks what range queries return, then appends to a segment
+ * file and reads the records back from the file, across a rotation.
+ *
+ * Usage:
+ *   ./test_result_log
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "result_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+static cira_result_record_t dets[CIRA_RESULT_MAX_RECORDS];
+
+/* Detections of result seq: seq % 4 boxes tagged with seq */
+static int make_dets(uint64_t seq) {
+    int n = (int)(seq % 4);
+    for (int i = 0; i < n; i++) {
+        dets[i].x = 0.1f * i;
+        dets[i].y = 0.25f;
+        dets[i].w = 0.5f;
+        dets[i].h = 0.5f;
+        dets[i].confidence = (float)seq / 1000.0f;
+        dets[i].label_id = i;
+    }
+    return n;
+}
+
+#ifndef _WIN32
+/* Map a segment file read-only, as another process would */
+static const uint8_t* map_file(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    fstat(fd, &st);
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    *size = (size_t)st.st_size;
+    return base == MAP_FAILED ? NULL : (const uint8_t*)base;
+}
+#endif
+
+int main(void) {
+    result_range_t range;
+
+    /* Result slots: the oldest results make room */
+    result_log_t* log = result_log_create(64, 0);
+    CHECK(log != NULL);
+    CHECK(result_log_range(log, 0, 0, -1, 100, &range) == CIRA_OK);
+    CHECK(range.count == 0 && range.oldest == 0 && range.latest == 0);
+
+    for (uint64_t seq = 1; seq <= 100; seq++) {
+        result_log_append(log, seq, 1000 + (int64_t)seq * 10, (int)(seq % 2), seq * 3,
+                          640, 480, dets, make_dets(seq));
+    }
+    CHECK(result_log_count(log) == 64);
+
+    CHECK(result_log_range(log, 0, 0, -1, 1000, &range) == CIRA_OK);
+    CHECK(range.count == 64 && !range.more);
+    CHECK(range.oldest == 37 && range.latest == 100);
+    for (int i = 0; i < range.count; i++) {
+        const result_log_entry_t* e = &range.entries[i];
+        CHECK(e->sequence == 37 + (uint64_t)i);
+        CHECK(e->frame_sequence == e->sequence * 3 && e->camera == (int)(e->sequence % 2));
+        CHECK(e->timestamp_ms == 1000 + (int64_t)e->sequence * 10);
+        CHECK(e->width == 640 && e->height == 480);
+        CHECK(e->detection_count == (int)(e->sequence % 4));
+        for (int j = 0; j < e->detection_count; j++) {
+            const cira_result_record_t* d = &range.detections[e->first_detection + j];
+            CHECK(d->label_id == j && d->confidence == (float)e->sequence / 1000.0f);
+        }
+    }
+    result_range_free(&range);
+    CHECK(range.entries == NULL && range.count == 0);
+
+    /* since, limit, camera, from_ms */
+    CHECK(result_log_range(log, 90, 0, -1, 1000, &range) == CIRA_OK);
+    CHECK(range.count == 10 && range.entries[0].sequence == 91);
+    result_range_free(&range);
+    CHECK(result_log_range(log, 90, 0, -1, 4, &range) == CIRA_OK);
+    CHECK(range.count == 4 && range.more && range.entries[3].sequence == 94);
+    result_range_free(&range);
+    CHECK(result_log_range(log, 90, 0, 1, 1000, &range) == CIRA_OK);
+    CHECK(range.count == 5 && range.entries[0].sequence == 91 && range.entries[4].sequence == 99);
+    result_range_free(&range);
+    CHECK(result_log_range(log, 0, 1000 + 95 * 10, -1, 1000, &range) == CIRA_OK);
+    CHECK(range.count == 6 && range.entries[0].sequence == 95);
+    result_range_free(&range);
+    CHECK(result_log_range(log, 100, 0, -1, 1000, &range) == CIRA_OK);
+    CHECK(range.count == 0 && range.latest == 100 && !range.more);
+    result_range_free(&range);
+    result_log_destroy(log);
+
+    /* Detection slots: full results displace older ones before the result ring wraps */
+    log = result_log_create(64, 0);
+    CHECK(log != NULL);
+    for (int i = 0; i < CIRA_RESULT_MAX_RECORDS; i++) {
+        dets[i].label_id = i;
+        dets[i].confidence = 0.5f;
+    }
+    for (uint64_t seq = 1; seq <= 3; seq++) {
+        result_log_append(log, seq, 0, 0, seq, 100, 100, dets, CIRA_RESULT_MAX_RECORDS);
+    }
+    CHECK(result_log_count(log) == 64 * RESULT_LOG_DETECTIONS_PER_RESULT / CIRA_RESULT_MAX_RECORDS);
+    CHECK(result_log_range(log, 0, 0, -1, 1000, &range) == CIRA_OK);
+    CHECK(range.oldest == 2 && range.latest == 3);
+    CHECK(range.num_detections == 2 * CIRA_RESULT_MAX_RECORDS);
+    CHECK(range.detections[CIRA_RESULT_MAX_RECORDS + 7].label_id == 7);
+    result_range_free(&range);
+    result_log_destroy(log);
+
+    /* Age: results older than max_age_sec leave with the next append */
+    log = result_log_create(64, 1);
+    CHECK(log != NULL);
+    result_log_append(log, 1, 10000, 0, 1, 100, 100, NULL, 0);
+    result_log_append(log, 2, 10500, 0, 2, 100, 100, NULL, 0);
+    result_log_append(log, 3, 11200, 0, 3, 100, 100, NULL, 0);
+    CHECK(result_log_count(log) == 2);
+    result_log_destroy(log);
+
+#ifndef _WIN32
+    /* Segment file: records readable while written, rotation, previous run kept */
+    char path[128];
+    char old[140];
+    snprintf(path, sizeof(path), "/tmp/cira_results_test_%d.log", (int)getpid());
+    snprintf(old, sizeof(old), "%s.1", path);
+    unlink(path);
+    unlink(old);
+
+    log = result_log_create(64, 0);
+    CHECK(log != NULL);
+    CHECK(result_log_open_segment(log, path, 0) == CIRA_OK);
+    CHECK(result_log_segment_bytes(log) == sizeof(result_log_file_header_t));
+    int n = make_dets(7);
+    result_log_append(log, 7, 1234, 2, 70, 1920, 1080, dets, n);
+    CHECK(result_log_segment_bytes(log) ==
+          sizeof(result_log_file_header_t) + sizeof(result_log_record_t) +
+          (size_t)n * sizeof(cira_result_record_t));
+
+    size_t size;
+    const uint8_t* map = map_file(path, &size);
+    CHECK(map != NULL && size == RESULT_LOG_MIN_SEGMENT);
+    const result_log_file_header_t* hdr = (const result_log_file_header_t*)map;
+    CHECK(hdr->magic == RESULT_LOG_MAGIC && hdr->version == RESULT_LOG_VERSION);
+    CHECK(hdr->record_size == sizeof(result_log_record_t));
+    CHECK(hdr->write_offset == result_log_segment_bytes(log));
+    const result_log_record_t* rec = (const result_log_record_t*)(map + hdr->header_size);
+    CHECK(rec->sequence == 7 && rec->frame_sequence == 70 && rec->timestamp_ms == 1234);
+    CHECK(rec->camera == 2 && rec->width == 1920 && rec->height == 1080);
+    CHECK(rec->detection_count == (uint32_t)n);
+    const cira_result_record_t* box = (const cira_result_record_t*)(rec + 1);
+    CHECK(box[2].label_id == 2 && box[2].y == 0.25f);
+    munmap((void*)map, size);
+
+    /* A full segment moves to <path>.1 */
+    for (int i = 0; i < CIRA_RESULT_MAX_RECORDS; i++) dets[i].label_id = i;
+    size_t record = sizeof(result_log_record_t) + CIRA_RESULT_MAX_RECORDS * sizeof(cira_result_record_t);
+    uint64_t fit = (RESULT_LOG_MIN_SEGMENT - sizeof(result_log_file_header_t)) / record;
+    for (uint64_t seq = 8; seq <= 8 + fit; seq++) {
+        result_log_append(log, seq, 0, 0, seq, 100, 100, dets, CIRA_RESULT_MAX_RECORDS);
+    }
+    CHECK(access(old, F_OK) == 0);
+    CHECK(result_log_segment_bytes(log) == sizeof(result_log_file_header_t) + record);
+    map = map_file(path, &size);
+    CHECK(map != NULL);
+    rec = (const result_log_record_t*)(map + sizeof(result_log_file_header_t));
+    CHECK(rec->sequence == 8 + fit);
+    munmap((void*)map, size);
+    result_log_destroy(log);
+
+    /* Reopening keeps the last run's segment aside */
+    log = result_log_create(64, 0);
+    CHECK(log != NULL);
+    CHECK(result_log_open_segment(log, path, 0) == CIRA_OK);
+    CHECK(result_log_segment_bytes(log) == sizeof(result_log_file_header_t));
+    map = map_file(old, &size);
+    CHECK(map != NULL);
+    rec = (const result_log_record_t*)(map + sizeof(result_log_file_header_t));
+    CHECK(rec->sequence == 8 + fit);
+    munmap((void*)map, size);
+    result_log_destroy(log);
+    unlink(path);
+    unlink(old);
+#endif
+
+    printf("test_result_log: OK\n");
+    return 0;
+}
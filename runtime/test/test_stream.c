@@ -5,10 +5,11 @@
  * Can start without a model and load one later via the API or dashboard.
  *
  * Usage:
- *   ./test_stream [model_path] [-p port] [-m models_dir]
+ *   ./test_stream [model_path] [-p port] [-m models_dir] [-o key=value]
  *   ./test_stream -m D:/models         # Start with models dropdown
  *   ./test_stream -m D:/models -p 8080 # Start with models on custom port
  *   ./test_stream ./models/yolo        # Start with model preloaded
+ *   ./test_stream -o pipeline.queue_depth=4  # Set a runtime option
  *
  * Then visit:
  *   http://localhost:8080/health
@@ -50,6 +51,8 @@ int main(int argc, char* argv[]) {
     int port = 8080;
     const char* model_path = NULL;
     const char* models_dir = NULL;
+    const char* options[16];
+    int num_options = 0;
 
     /* Parse arguments */
     for (int i = 1; i < argc; i++) {
@@ -65,11 +68,17 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc) {
                 models_dir = argv[++i];
             }
+        } else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--option") == 0) {
+            if (i + 1 < argc && num_options < 16) {
+                options[num_options++] = argv[++i];
+            }
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            printf("Usage: %s [model_path] [-p port] [-m models_dir]\n", argv[0]);
+            printf("Usage: %s [model_path] [-p port] [-m models_dir] [-o key=value]\n", argv[0]);
             printf("  model_path       Path to model directory (optional, can load later via API)\n");
             printf("  -p, --port       HTTP server port (default: 8080)\n");
             printf("  -m, --models-dir Directory containing models for dropdown selection\n");
+            printf("  -o, --option     Runtime option, e.g. pipeline.queue_depth=2,\n");
+            printf("                   pipeline.drop_policy=drop_oldest|drop_newest\n");
             printf("\nExample:\n");
             printf("  %s -p 8080                         # Start without model\n", argv[0]);
             printf("  %s -m D:/models -p 8080            # Start with models directory\n", argv[0]);
@@ -99,6 +108,26 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    /* Apply runtime options */
+    for (int i = 0; i < num_options; i++) {
+        char key[128];
+        const char* eq = strchr(options[i], '=');
+        size_t key_len = eq ? (size_t)(eq - options[i]) : 0;
+        if (!eq || key_len == 0 || key_len >= sizeof(key)) {
+            fprintf(stderr, "Invalid option (expected key=value): %s\n", options[i]);
+            cira_destroy(ctx);
+            return 1;
+        }
+        memcpy(key, options[i], key_len);
+        key[key_len] = '\0';
+        if (cira_set_option(ctx, key, eq + 1) != CIRA_OK) {
+            fprintf(stderr, "Failed to set option: %s\n", cira_error(ctx));
+            cira_destroy(ctx);
+            return 1;
+        }
+        printf("Option: %s=%s\n", key, eq + 1);
+    }
+
     /* Load model if specified */
     if (model_path) {
         printf("Loading model from: %s\n", model_path);
@@ -0,0 +1,121 @@
+/**
+ * CiRA Runtime - Tracker Test
+ *
+ * Moves two objects across a synthetic scene and checks that tracks are
+ * confirmed on the second match, keep their IDs, follow the objects
+ * between detector runs and are dropped once the objects disappear.
+ *
+ * Usage:
+ *   ./test_tracker
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "tracker.h"
+#include <stdio.h>
+#include <math.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+/* Object i at time t (ms): moving right at 0.2 frame widths per second */
+static cira_detection_t object(int i, double t) {
+    cira_detection_t d;
+    d.x = 0.1f + 0.2f * (float)(t / 1000.0);
+    d.y = i == 0 ? 0.1f : 0.6f;
+    d.w = 0.1f;
+    d.h = 0.2f;
+    d.confidence = 0.9f;
+    d.label_id = i;
+    return d;
+}
+
+static int find(const int* ids, int n, int id) {
+    for (int i = 0; i < n; i++) {
+        if (ids[i] == id) return i;
+    }
+    return -1;
+}
+
+int main(void) {
+    tracker_t* t = tracker_create(NULL);
+    CHECK(t != NULL);
+
+    cira_detection_t dets[2], out[8];
+    int ids[8];
+    int first_ids[2] = {0, 0};
+
+    /* Detector every 4th frame at 30 FPS, tracker predictions in between */
+    const double frame_ms = 1000.0 / 30.0;
+    for (int frame = 0; frame < 60; frame++) {
+        double now = frame * frame_ms;
+        int n;
+        if (frame % 4 == 0) {
+            dets[0] = object(0, now);
+            dets[1] = object(1, now);
+            n = tracker_update(t, dets, 2, now, out, ids, 8);
+            if (frame == 0) {
+                /* Not confirmed until the second match */
+                CHECK(n == 0);
+                continue;
+            }
+        } else {
+            n = tracker_predict(t, now, out, ids, 8);
+            if (frame < 4) {
+                CHECK(n == 0);
+                continue;
+            }
+        }
+
+        CHECK(n == 2);
+        CHECK(tracker_count(t) == 2);
+        for (int i = 0; i < 2; i++) {
+            int k = out[0].label_id == i ? 0 : 1;
+            CHECK(out[k].label_id == i);
+            if (!first_ids[i]) first_ids[i] = ids[k];
+            CHECK(ids[k] == first_ids[i]);
+
+            /* Predicted boxes stay on the object */
+            cira_detection_t truth = object(i, now);
+            CHECK(fabsf(out[k].x - truth.x) < 0.02f);
+            CHECK(fabsf(out[k].y - truth.y) < 0.02f);
+        }
+    }
+    CHECK(first_ids[0] != first_ids[1]);
+
+    /* A weak detection keeps a track alive but does not start one */
+    double now = 60 * frame_ms;
+    dets[0] = object(0, now);
+    dets[0].confidence = 0.3f;
+    dets[1] = object(1, now);
+    dets[1].x = 0.8f;
+    dets[1].y = 0.0f;
+    dets[1].confidence = 0.3f;
+    int n = tracker_update(t, dets, 2, now, out, ids, 8);
+    CHECK(n == 1);
+    CHECK(ids[0] == first_ids[0]);
+    CHECK(tracker_count(t) == 2);
+
+    /* Objects gone: tracks stop reporting at once and age out */
+    for (int k = 1; k <= 4; k++) {
+        n = tracker_update(t, NULL, 0, now + k * 4 * frame_ms, out, ids, 8);
+        CHECK(n == 0);
+    }
+    CHECK(tracker_count(t) == 0);
+
+    /* New objects get new IDs */
+    now += 20 * frame_ms;
+    dets[0] = object(0, now);
+    tracker_update(t, dets, 1, now, out, ids, 8);
+    n = tracker_update(t, dets, 1, now + frame_ms, out, ids, 8);
+    CHECK(n == 1);
+    CHECK(find(first_ids, 2, ids[0]) < 0);
+
+    tracker_destroy(t);
+    printf("test_tracker: OK\n");
+    return 0;
+}
@@ -0,0 +1,314 @@
+/**
+ * CiRA Runtime - YOLO NMS Test
+ *
+ * Checks the grid-indexed NMS in yolo_nms() / yolo_nms_topk() against a
+ * brute-force O(n^2) greedy NMS on random boxes. With distinct scores the
+ * survivors must match exactly and in order: small and large boxes mixed,
+ * boxes spanning many grid cells or more than the per-box cell limit, all
+ * boxes identical, and more kept boxes than the cell index pool holds (the
+ * brute-force fallback). Top-K must return the first K survivors, and
+ * equal scores must give the same survivors as the reference, whatever
+ * order ties are popped in.
+ *
+ * Usage:
+ *   ./test_yolo_nms
+ *
+ * (c) CiRA Robotics / KMITL 2026
+ */
+
+#include "yolo_decoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+/* Cell index pool size in yolo_decoder.c */
+#define NMS_POOL 8192
+
+static float frand(float lo, float hi) {
+    return lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+}
+
+static float ref_iou(const yolo_detection_t* a, const yolo_detection_t* b) {
+    float ix1 = a->x1 > b->x1 ? a->x1 : b->x1;
+    float iy1 = a->y1 > b->y1 ? a->y1 : b->y1;
+    float ix2 = a->x2 < b->x2 ? a->x2 : b->x2;
+    float iy2 = a->y2 < b->y2 ? a->y2 : b->y2;
+    float iw = ix2 - ix1 > 0.0f ? ix2 - ix1 : 0.0f;
+    float ih = iy2 - iy1 > 0.0f ? iy2 - iy1 : 0.0f;
+    float inter = iw * ih;
+    float uni = (a->x2 - a->x1) * (a->y2 - a->y1) + (b->x2 - b->x1) * (b->y2 - b->y1) - inter;
+    return (uni > 0) ? inter / uni : 0.0f;
+}
+
+/* Score descending; ties by box so the order is total */
+static int cmp_desc(const void* pa, const void* pb) {
+    const yolo_detection_t* a = (const yolo_detection_t*)pa;
+    const yolo_detection_t* b = (const yolo_detection_t*)pb;
+    if (a->score != b->score) return a->score < b->score ? 1 : -1;
+    if (a->class_id != b->class_id) return a->class_id - b->class_id;
+    if (a->x1 != b->x1) return a->x1 < b->x1 ? -1 : 1;
+    if (a->y1 != b->y1) return a->y1 < b->y1 ? -1 : 1;
+    if (a->x2 != b->x2) return a->x2 < b->x2 ? -1 : 1;
+    if (a->y2 != b->y2) return a->y2 < b->y2 ? -1 : 1;
+    return 0;
+}
+
+/* Baseline greedy NMS: sort, then test each box against every kept box */
+static int ref_nms(yolo_detection_t* d, int count, float thr) {
+    qsort(d, count, sizeof(yolo_detection_t), cmp_desc);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        int suppressed = 0;
+        for (int k = 0; k < kept && !suppressed; k++) {
+            suppressed = d[k].class_id == d[i].class_id && ref_iou(&d[k], &d[i]) > thr;
+        }
+        if (!suppressed) d[kept++] = d[i];
+    }
+    return kept;
+}
+
+static int same_det(const yolo_detection_t* a, const yolo_detection_t* b) {
+    return a->x1 == b->x1 && a->y1 == b->y1 && a->x2 == b->x2 && a->y2 == b->y2 &&
+           a->score == b->score && a->class_id == b->class_id;
+}
+
+/* Distinct scores: a random permutation of count levels */
+static void distinct_scores(yolo_detection_t* d, int count) {
+    for (int i = 0; i < count; i++) d[i].score = (float)(i + 1) / (float)(count + 1);
+    for (int i = count - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        float t = d[i].score; d[i].score = d[j].score; d[j].score = t;
+    }
+}
+
+static void random_box(yolo_detection_t* d, float extent, float min_size, float max_size,
+                       int classes) {
+    float w = frand(min_size, max_size);
+    float h = frand(min_size, max_size);
+    d->x1 = frand(0.0f, extent - w);
+    d->y1 = frand(0.0f, extent - h);
+    d->x2 = d->x1 + w;
+    d->y2 = d->y1 + h;
+    d->class_id = rand() % classes;
+}
+
+/* Grid NMS with max_keep against the first max_keep reference survivors */
+static int compare(const yolo_detection_t* dets, int count, float thr, int max_keep,
+                   int* survivors) {
+    size_t bytes = (size_t)count * sizeof(yolo_detection_t);
+    yolo_detection_t* got = (yolo_detection_t*)malloc(bytes);
+    yolo_detection_t* ref = (yolo_detection_t*)malloc(bytes);
+    CHECK(got && ref);
+    memcpy(got, dets, bytes);
+    memcpy(ref, dets, bytes);
+
+    int n = max_keep == count ? yolo_nms(got, count, thr)
+                              : yolo_nms_topk(got, count, thr, max_keep);
+    int expected = ref_nms(ref, count, thr);
+    if (max_keep > 0 && max_keep < expected) expected = max_keep;
+
+    if (n != expected) fprintf(stderr, "  kept %d, reference %d\n", n, expected);
+    CHECK(n == expected);
+    for (int i = 0; i < n; i++) {
+        if (!same_det(&got[i], &ref[i])) fprintf(stderr, "  survivor %d differs\n", i);
+        CHECK(same_det(&got[i], &ref[i]));
+    }
+    if (survivors) *survivors = n;
+
+    free(got);
+    free(ref);
+    return 0;
+}
+
+/* Small to frame-sized boxes, many spanning several cells or the wide list */
+static int test_random_mix(void) {
+    static const float thresholds[] = { 0.3f, 0.45f, 0.7f };
+    yolo_detection_t d[400];
+    int total = 0;
+    for (int trial = 0; trial < 150; trial++) {
+        int count = 50 + rand() % 350;
+        float max_size = (trial % 3 == 0) ? 640.0f : (trial % 3 == 1) ? 200.0f : 40.0f;
+        for (int i = 0; i < count; i++) {
+            random_box(&d[i], 640.0f, 1.0f, max_size, 1 + trial % 4);
+        }
+        distinct_scores(d, count);
+        int kept;
+        if (compare(d, count, thresholds[trial % 3], count, &kept) != 0) return 1;
+        total += kept;
+    }
+    printf("  random mix: %d survivors over 150 trials\n", total);
+    return 0;
+}
+
+/* Clustered jittered copies: heavy suppression across cell borders */
+static int test_clusters(void) {
+    yolo_detection_t d[600];
+    for (int trial = 0; trial < 50; trial++) {
+        int count = 0;
+        while (count < 600) {
+            yolo_detection_t base;
+            random_box(&base, 1280.0f, 20.0f, 500.0f, 3);
+            for (int k = 0; k < 12 && count < 600; k++) {
+                float jx = frand(-15.0f, 15.0f), jy = frand(-15.0f, 15.0f);
+                d[count] = base;
+                d[count].x1 += jx;
+                d[count].x2 += jx + frand(-10.0f, 10.0f);
+                d[count].y1 += jy;
+                d[count].y2 += jy + frand(-10.0f, 10.0f);
+                count++;
+            }
+        }
+        distinct_scores(d, count);
+        if (compare(d, count, 0.5f, count, NULL) != 0) return 1;
+    }
+    return 0;
+}
+
+/* Every box the same: zero-size grid extent */
+static int test_identical(void) {
+    yolo_detection_t d[64];
+    for (int i = 0; i < 64; i++) {
+        d[i].x1 = 10.0f; d[i].y1 = 20.0f; d[i].x2 = 110.0f; d[i].y2 = 70.0f;
+        d[i].class_id = i % 2;
+    }
+    distinct_scores(d, 64);
+    int kept;
+    if (compare(d, 64, 0.5f, 64, &kept) != 0) return 1;
+    CHECK(kept == 2);
+    return 0;
+}
+
+/* More kept boxes than the cell index pool holds: brute-force fallback */
+static int test_pool_fallback(void) {
+    const int count = 14000;
+    yolo_detection_t* d = (yolo_detection_t*)malloc((size_t)count * sizeof(yolo_detection_t));
+    CHECK(d != NULL);
+    for (int i = 0; i < count; i++) {
+        if (i % 4 == 3) {
+            /* Jittered copy of the previous box, suppressed or not by score */
+            d[i] = d[i - 1];
+            d[i].x1 += frand(-1.0f, 1.0f);
+            d[i].x2 += frand(-1.0f, 1.0f);
+        } else if (i % 97 == 0) {
+            random_box(&d[i], 4000.0f, 300.0f, 2000.0f, 8);
+        } else {
+            random_box(&d[i], 4000.0f, 2.0f, 12.0f, 8);
+        }
+    }
+    distinct_scores(d, count);
+
+    int kept;
+    if (compare(d, count, 0.5f, count, &kept) != 0) return 1;
+    CHECK(kept > NMS_POOL);
+
+    /* Truncated after the fallback started */
+    if (compare(d, count, 0.5f, NMS_POOL + 500, NULL) != 0) return 1;
+    printf("  pool fallback: %d of %d kept\n", kept, count);
+    free(d);
+    return 0;
+}
+
+/* Top-K: the first K survivors; K past the count or <= 0 keeps all */
+static int test_topk(void) {
+    yolo_detection_t d[300];
+    for (int i = 0; i < 300; i++) random_box(&d[i], 640.0f, 5.0f, 150.0f, 3);
+    distinct_scores(d, 300);
+
+    int all;
+    if (compare(d, 300, 0.5f, 300, &all) != 0) return 1;
+    CHECK(all > 20);
+    static const int ks[] = { 1, 2, 10 };
+    for (int i = 0; i < 3; i++) {
+        if (compare(d, 300, 0.5f, ks[i], NULL) != 0) return 1;
+    }
+    if (compare(d, 300, 0.5f, all - 1, NULL) != 0) return 1;
+    if (compare(d, 300, 0.5f, all, NULL) != 0) return 1;
+
+    /* Out-of-range max_keep means no limit */
+    yolo_detection_t copy[300];
+    memcpy(copy, d, sizeof(d));
+    CHECK(yolo_nms_topk(copy, 300, 0.5f, 1000) == all);
+    memcpy(copy, d, sizeof(d));
+    CHECK(yolo_nms_topk(copy, 300, 0.5f, 0) == all);
+    memcpy(copy, d, sizeof(d));
+    CHECK(yolo_nms_topk(copy, 300, 0.5f, -1) == all);
+
+    CHECK(yolo_nms(NULL, 10, 0.5f) == 0);
+    CHECK(yolo_nms(copy, 0, 0.5f) == 0);
+    return 0;
+}
+
+/*
+ * A few score levels shared by many boxes. Boxes of one class and one level
+ * never overlap above the threshold, so the survivors do not depend on how
+ * ties are ordered; they are compared as sets per level.
+ */
+static int test_equal_scores(void) {
+    enum { COUNT = 400, LEVELS = 4 };
+    const float thr = 0.4f;
+    yolo_detection_t d[COUNT];
+    for (int i = 0; i < COUNT; i++) {
+        int ok;
+        do {
+            random_box(&d[i], 800.0f, 10.0f, 120.0f, 2);
+            d[i].score = (float)(1 + rand() % LEVELS) / LEVELS;
+            ok = 1;
+            for (int j = 0; j < i && ok; j++) {
+                ok = !(d[j].score == d[i].score && d[j].class_id == d[i].class_id &&
+                       ref_iou(&d[j], &d[i]) > thr);
+            }
+        } while (!ok);
+    }
+
+    yolo_detection_t ref[COUNT];
+    memcpy(ref, d, sizeof(d));
+    int expected = ref_nms(ref, COUNT, thr);
+
+    /* K larger than the candidate count, then truncated inside a tie */
+    static const int ks[] = { COUNT + 50, 0, 7 };
+    for (int t = 0; t < 3; t++) {
+        yolo_detection_t got[COUNT];
+        memcpy(got, d, sizeof(d));
+        int n = yolo_nms_topk(got, COUNT, thr, ks[t]);
+        int want = (ks[t] > 0 && ks[t] < expected) ? ks[t] : expected;
+        CHECK(n == want);
+
+        /* Same score sequence, and every survivor is a reference survivor */
+        for (int i = 0; i < n; i++) {
+            CHECK(got[i].score == ref[i].score);
+            int found = 0;
+            for (int j = 0; j < expected && !found; j++) found = same_det(&got[i], &ref[j]);
+            CHECK(found);
+        }
+
+        /* Whole set: sorted with ties broken by box, identical to the reference */
+        if (n == expected) {
+            qsort(got, n, sizeof(yolo_detection_t), cmp_desc);
+            for (int i = 0; i < n; i++) CHECK(same_det(&got[i], &ref[i]));
+        }
+    }
+    printf("  equal scores: %d of %d kept in %d levels\n", expected, COUNT, LEVELS);
+    return 0;
+}
+
+int main(void) {
+    srand(4242);
+
+    printf("Grid NMS vs brute-force reference:\n");
+    if (test_random_mix() != 0) return 1;
+    if (test_clusters() != 0) return 1;
+    if (test_identical() != 0) return 1;
+    if (test_pool_fallback() != 0) return 1;
+    if (test_topk() != 0) return 1;
+    if (test_equal_scores() != 0) return 1;
+
+    printf("test_yolo_nms: OK\n");
+    return 0;
+}
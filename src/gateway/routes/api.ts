@@ -1,5 +1,6 @@
 import { FastifyInstance, FastifyRequest, FastifyReply } from 'fastify';
 import { NodeManager } from '../../nodes/manager.js';
+import { FRAME_FORMAT_JPEG, getFrameRingReader, isLocalHost } from '../../nodes/frame-ring.js';
 import { NodeConfig, NodeConfigSchema } from '../../utils/config-schema.js';
 import { RuleEngine, SavedRule } from '../../services/rule-engine.js';
 import { StatsCollector } from '../../services/stats-collector.js';
@@ -277,6 +278,15 @@ export async function registerApiRoutes(
         });
       }
 
+      // Same-host runtime publishing annotated JPEGs: read the frame ring
+      if (annotated && node.runtime.frameRing && isLocalHost(node.host)) {
+        const frame = getFrameRingReader(node.runtime.frameRing).readLatest(0);
+        if (frame && frame.format === FRAME_FORMAT_JPEG) {
+          reply.header('X-Frame-Sequence', String(frame.seq));
+          return reply.type('image/jpeg').send(Buffer.from(frame.payload));
+        }
+      }
+
       try {
         // Proxy snapshot from the node's runtime
         const endpoint = annotated ? '/snapshot?annotated=true' : '/snapshot';
@@ -0,0 +1,249 @@
+import fs from 'fs';
+import { createLogger } from '../utils/logger.js';
+
+const logger = createLogger('frame-ring');
+
+// Layout of the runtime's shared-memory frame ring (runtime/include/frame_ring.h)
+const RING_MAGIC = 0x46524943; // "CIRF"
+const RING_VERSION = 1;
+const HEADER_SIZE = 64;
+const SLOT_HEADER_SIZE = 64;
+const DETECTION_SIZE = 24;
+const MAX_DETECTIONS = 256;
+const PAYLOAD_OFFSET = SLOT_HEADER_SIZE + MAX_DETECTIONS * DETECTION_SIZE;
+const READ_RETRIES = 8;
+const REOPEN_CHECK_MS = 1000;
+
+export const FRAME_FORMAT_RGB24 = 0;
+export const FRAME_FORMAT_JPEG = 1;
+
+export interface RingDetection {
+  x: number;
+  y: number;
+  w: number;
+  h: number;
+  confidence: number;
+  labelId: number;
+}
+
+export interface RingFrame {
+  seq: number;
+  timestampUs: number;
+  camera: number;
+  format: number;
+  width: number;
+  height: number;
+  detections: RingDetection[];
+  // View into the reader's buffer; valid until the next read
+  payload: Buffer;
+}
+
+interface RingHeader {
+  slotCount: number;
+  slotSize: number;
+  payloadCapacity: number;
+  headerSize: number;
+}
+
+/**
+ * Read-only consumer of a runtime frame ring on the same host.
+ *
+ * Node has no mmap without a native addon, so the ring file under /dev/shm
+ * is read with positioned reads into buffers allocated once per ring. A
+ * frame costs a few small preads plus one for the payload and no
+ * allocation; the seqlock in each slot is checked the same way the C
+ * reader does.
+ */
+export class FrameRingReader {
+  private fd: number | null = null;
+  private layout: RingHeader | null = null;
+  private ino = 0;
+  private lastCheck = 0;
+  private lastOpenAttempt = 0;
+  private readonly header = Buffer.alloc(HEADER_SIZE);
+  private readonly slot = Buffer.alloc(PAYLOAD_OFFSET);
+  private readonly lock = Buffer.alloc(8);
+  private payload = Buffer.alloc(0);
+
+  constructor(private readonly name: string) {}
+
+  get path(): string {
+    return `/dev/shm/${this.name}`;
+  }
+
+  /**
+   * Newest frame of a camera (or of any camera when camera is -1).
+   * Returns null if the ring does not exist or holds no matching frame.
+   */
+  readLatest(camera = -1): RingFrame | null {
+    if (!this.ensureOpen()) {
+      return null;
+    }
+
+    const fd = this.fd as number;
+    const layout = this.layout as RingHeader;
+
+    for (let attempt = 0; attempt < READ_RETRIES; attempt++) {
+      fs.readSync(fd, this.header, 0, HEADER_SIZE, 0);
+      const writeSeq = Number(this.header.readBigUInt64LE(32));
+      if (writeSeq === 0) {
+        return null;
+      }
+
+      // Walk back from the newest frame to the first one from this camera
+      let retry = false;
+      for (let k = 0; k < layout.slotCount && writeSeq - k >= 1; k++) {
+        const want = writeSeq - k;
+        const offset = layout.headerSize + ((want - 1) % layout.slotCount) * layout.slotSize;
+
+        fs.readSync(fd, this.slot, 0, PAYLOAD_OFFSET, offset);
+        const lock = this.slot.readBigUInt64LE(0);
+        if ((lock & 1n) !== 0n || Number(this.slot.readBigUInt64LE(8)) !== want) {
+          retry = true; // Being rewritten, or already overwritten
+          break;
+        }
+
+        const slotCamera = this.slot.readUInt32LE(24);
+        if (camera >= 0 && slotCamera !== camera) {
+          continue;
+        }
+
+        const payloadSize = this.slot.readUInt32LE(40);
+        if (payloadSize > layout.payloadCapacity) {
+          retry = true;
+          break;
+        }
+        fs.readSync(fd, this.payload, 0, payloadSize, offset + PAYLOAD_OFFSET);
+
+        // Accept the copy only if the writer did not touch the slot meanwhile
+        fs.readSync(fd, this.lock, 0, 8, offset);
+        if (this.lock.readBigUInt64LE(0) !== lock) {
+          retry = true;
+          break;
+        }
+
+        const count = Math.min(this.slot.readUInt32LE(44), MAX_DETECTIONS);
+        const detections: RingDetection[] = [];
+        for (let i = 0; i < count; i++) {
+          const d = SLOT_HEADER_SIZE + i * DETECTION_SIZE;
+          detections.push({
+            x: this.slot.readFloatLE(d),
+            y: this.slot.readFloatLE(d + 4),
+            w: this.slot.readFloatLE(d + 8),
+            h: this.slot.readFloatLE(d + 12),
+            confidence: this.slot.readFloatLE(d + 16),
+            labelId: this.slot.readInt32LE(d + 20),
+          });
+        }
+
+        return {
+          seq: want,
+          timestampUs: Number(this.slot.readBigUInt64LE(16)),
+          camera: slotCamera,
+          format: this.slot.readUInt32LE(28),
+          width: this.slot.readUInt32LE(32),
+          height: this.slot.readUInt32LE(36),
+          detections,
+          payload: this.payload.subarray(0, payloadSize),
+        };
+      }
+
+      if (!retry) {
+        return null; // No frame from this camera in the ring
+      }
+    }
+
+    return null;
+  }
+
+  close(): void {
+    if (this.fd !== null) {
+      fs.closeSync(this.fd);
+    }
+    this.fd = null;
+    this.layout = null;
+  }
+
+  private ensureOpen(): boolean {
+    const now = Date.now();
+
+    // A restarted runtime replaces the object; follow it to the new one
+    if (this.fd !== null && now - this.lastCheck >= REOPEN_CHECK_MS) {
+      this.lastCheck = now;
+      try {
+        if (fs.statSync(this.path).ino !== this.ino) {
+          this.close();
+          this.lastOpenAttempt = 0;
+        }
+      } catch {
+        this.close();
+        return false;
+      }
+    }
+
+    if (this.fd !== null) {
+      return true;
+    }
+    if (now - this.lastOpenAttempt < REOPEN_CHECK_MS) {
+      return false;
+    }
+    this.lastOpenAttempt = now;
+    this.lastCheck = now;
+
+    let fd: number;
+    try {
+      fd = fs.openSync(this.path, 'r');
+    } catch {
+      return false;
+    }
+
+    fs.readSync(fd, this.header, 0, HEADER_SIZE, 0);
+    if (
+      this.header.readUInt32LE(0) !== RING_MAGIC ||
+      this.header.readUInt32LE(4) !== RING_VERSION
+    ) {
+      fs.closeSync(fd);
+      logger.warn({ path: this.path }, 'Not a frame ring (or incompatible version)');
+      return false;
+    }
+
+    this.layout = {
+      headerSize: this.header.readUInt32LE(8),
+      slotCount: this.header.readUInt32LE(12),
+      slotSize: Number(this.header.readBigUInt64LE(16)),
+      payloadCapacity: Number(this.header.readBigUInt64LE(24)),
+    };
+    if (this.payload.length < this.layout.payloadCapacity) {
+      this.payload = Buffer.alloc(this.layout.payloadCapacity);
+    }
+    this.ino = fs.fstatSync(fd).ino;
+    this.fd = fd;
+
+    logger.info(
+      { path: this.path, slots: this.layout.slotCount, capacity: this.layout.payloadCapacity },
+      'Opened frame ring'
+    );
+    return true;
+  }
+}
+
+const readers = new Map<string, FrameRingReader>();
+
+/**
+ * Shared reader for a ring name (one set of buffers per ring).
+ */
+export function getFrameRingReader(name: string): FrameRingReader {
+  let reader = readers.get(name);
+  if (!reader) {
+    reader = new FrameRingReader(name);
+    readers.set(name, reader);
+  }
+  return reader;
+}
+
+/**
+ * True if the host refers to this machine, where the ring can be read.
+ */
+export function isLocalHost(host: string): boolean {
+  return host === 'localhost' || host === '127.0.0.1' || host === '::1';
+}
@@ -99,6 +99,9 @@ export const NodeSshConfigSchema = z.object({
 export const NodeRuntimeConfigSchema = z.object({
   port: z.number().int().default(8080),
   config: z.string().default('/home/cira/.cira/model_config.json'),
+  // Shared-memory frame ring of a runtime on this host (its "frame_ring.name",
+  // "cira-frames-<port>" by default); snapshots are read from it instead of HTTP
+  frameRing: z.string().optional(),
 });
 
 export const NodeCameraConfigSchema = z.object({